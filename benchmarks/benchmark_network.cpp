@@ -0,0 +1,95 @@
+#include "benchmark_network.hpp"
+
+#include "isobus/isobus/can_NAME_filter.hpp"
+#include "isobus/isobus/can_network_manager.hpp"
+#include "loopback_can_sink.hpp"
+
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace
+{
+	constexpr std::uint8_t SENDER_ADDRESS = 0x1C;
+	constexpr std::uint8_t RECEIVER_ADDRESS = 0x1D;
+	constexpr std::uint32_t SENDER_IDENTITY = 1;
+	constexpr std::uint32_t RECEIVER_IDENTITY = 2;
+	constexpr std::uint32_t MAX_IDLE_UPDATES = 16;
+
+	isobus::NAME make_name(std::uint32_t identityNumber)
+	{
+		isobus::NAME retVal(0);
+		retVal.set_arbitrary_address_capable(true);
+		retVal.set_industry_group(1);
+		retVal.set_function_code(138);
+		retVal.set_identity_number(identityNumber);
+		retVal.set_manufacturer_code(69);
+		return retVal;
+	}
+
+	bool get_network_ready(const BenchmarkNetwork &network)
+	{
+		return ((network.sender->get_address_valid()) &&
+		        (network.receiver->get_address_valid()) &&
+		        (network.receiverPartner->get_address_valid()) &&
+		        (network.senderPartner->get_address_valid()));
+	}
+}
+
+BenchmarkNetwork &get_benchmark_network()
+{
+	static BenchmarkNetwork network;
+
+	if (nullptr == network.sender)
+	{
+		const std::vector<isobus::NAMEFilter> receiverFilter = { isobus::NAMEFilter(isobus::NAME::NAMEParameters::IdentityNumber, RECEIVER_IDENTITY) };
+		const std::vector<isobus::NAMEFilter> senderFilter = { isobus::NAMEFilter(isobus::NAME::NAMEParameters::IdentityNumber, SENDER_IDENTITY) };
+
+		network.sender = std::make_shared<isobus::InternalControlFunction>(make_name(SENDER_IDENTITY), SENDER_ADDRESS, 0);
+		network.receiver = std::make_shared<isobus::InternalControlFunction>(make_name(RECEIVER_IDENTITY), RECEIVER_ADDRESS, 1);
+		network.receiverPartner = std::make_shared<isobus::PartneredControlFunction>(0, receiverFilter);
+		network.senderPartner = std::make_shared<isobus::PartneredControlFunction>(1, senderFilter);
+
+		// Address claiming has to wait out its timers, so this takes a moment in real time
+		const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+		while ((!get_network_ready(network)) &&
+		       (std::chrono::steady_clock::now() < deadline))
+		{
+			isobus::CANNetworkManager::CANNetwork.update();
+			process_loopback_frames();
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+
+		if (!get_network_ready(network))
+		{
+			throw std::runtime_error("Benchmark network failed to claim addresses");
+		}
+
+		// The address tables only catch up with the last claims on the next updates
+		const bool settled = false;
+		run_network_until(settled);
+	}
+	return network;
+}
+
+void run_network_until(const bool &condition)
+{
+	std::uint32_t idleUpdates = 0;
+
+	// Some protocols only send on the update after the one that received a frame, so allow a few quiet updates
+	while ((!condition) &&
+	       (idleUpdates < MAX_IDLE_UPDATES))
+	{
+		isobus::CANNetworkManager::CANNetwork.update();
+
+		if (0 == process_loopback_frames())
+		{
+			idleUpdates++;
+		}
+		else
+		{
+			idleUpdates = 0;
+		}
+	}
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "isobus/isobus/can_internal_control_function.hpp"
+#include "isobus/isobus/can_partnered_control_function.hpp"
+
+#include <memory>
+
+/// Two nodes that see each other through the loopback sink
+struct BenchmarkNetwork
+{
+	std::shared_ptr<isobus::InternalControlFunction> sender; ///< Sends from port 0
+	std::shared_ptr<isobus::InternalControlFunction> receiver; ///< Receives on port 1
+	std::shared_ptr<isobus::PartneredControlFunction> receiverPartner; ///< The receiver, as seen from port 0
+	std::shared_ptr<isobus::PartneredControlFunction> senderPartner; ///< The sender, as seen from port 1
+};
+
+/// Returns the benchmark network, creating it and claiming its addresses on the first call
+BenchmarkNetwork &get_benchmark_network();
+
+/// Updates the stack and loops frames back until nothing is sent, or the condition is true
+void run_network_until(const bool &condition);
@@ -0,0 +1,34 @@
+#include <benchmark/benchmark.h>
+
+#include "benchmark_network.hpp"
+#include "isobus/isobus/isobus_diagnostic_protocol.hpp"
+
+#include <vector>
+
+using namespace isobus;
+
+static void DiagnosticMessage1Encode(benchmark::State &state)
+{
+	BenchmarkNetwork &network = get_benchmark_network();
+	std::vector<std::uint8_t> payload;
+
+	DiagnosticProtocol::assign_diagnostic_protocol_to_internal_control_function(network.sender);
+	DiagnosticProtocol *diagnosticProtocol = DiagnosticProtocol::get_diagnostic_protocol_by_internal_control_function(network.sender);
+
+	diagnosticProtocol->set_j1939_mode(true);
+	for (std::int64_t i = 0; i < state.range(0); i++)
+	{
+		const DiagnosticProtocol::DiagnosticTroubleCode dtc(static_cast<std::uint32_t>(1000 + i),
+		                                                     DiagnosticProtocol::FailureModeIdentifier::DataErratic,
+		                                                     DiagnosticProtocol::LampStatus::AmberWarningLampSolid);
+		diagnosticProtocol->set_diagnostic_trouble_code_active(dtc, true);
+	}
+
+	for (auto _ : state)
+	{
+		benchmark::DoNotOptimize(diagnosticProtocol->encode_diagnostic_message_1(payload));
+	}
+	DiagnosticProtocol::deassign_diagnostic_protocol_to_internal_control_function(network.sender);
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(DiagnosticMessage1Encode)->Arg(0)->Arg(1)->Arg(16)->Arg(128);
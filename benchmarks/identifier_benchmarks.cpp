@@ -0,0 +1,91 @@
+#include <benchmark/benchmark.h>
+
+#include "isobus/isobus/can_NAME.hpp"
+#include "isobus/isobus/can_NAME_filter.hpp"
+#include "isobus/isobus/can_identifier.hpp"
+
+#include <vector>
+
+using namespace isobus;
+
+static void CANIdentifierEncode(benchmark::State &state)
+{
+	// Alternate between a destination specific and a broadcast PGN
+	const std::uint32_t parameterGroupNumbers[] = { 0xEF00, 0xFEF1 };
+	std::uint32_t i = 0;
+
+	for (auto _ : state)
+	{
+		CANIdentifier identifier(CANIdentifier::Type::Extended,
+		                         parameterGroupNumbers[i & 1],
+		                         CANIdentifier::CANPriority::PriorityDefault6,
+		                         0x1D,
+		                         0x1C);
+		benchmark::DoNotOptimize(identifier.get_identifier());
+		i++;
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(CANIdentifierEncode);
+
+static void CANIdentifierDecode(benchmark::State &state)
+{
+	const std::uint32_t rawIdentifiers[] = { 0x18EF1D1C, 0x18FEF11C };
+	std::uint32_t i = 0;
+
+	for (auto _ : state)
+	{
+		CANIdentifier identifier(rawIdentifiers[i & 1]);
+		benchmark::DoNotOptimize(identifier.get_parameter_group_number());
+		benchmark::DoNotOptimize(identifier.get_priority());
+		benchmark::DoNotOptimize(identifier.get_destination_address());
+		benchmark::DoNotOptimize(identifier.get_source_address());
+		i++;
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(CANIdentifierDecode);
+
+static void NAMEFilterMatch(benchmark::State &state)
+{
+	NAME testName(0);
+	std::vector<NAMEFilter> filters;
+
+	testName.set_arbitrary_address_capable(true);
+	testName.set_industry_group(2);
+	testName.set_device_class(4);
+	testName.set_function_code(29);
+	testName.set_identity_number(123456);
+	testName.set_ecu_instance(1);
+	testName.set_function_instance(0);
+	testName.set_device_class_instance(0);
+	testName.set_manufacturer_code(1407);
+
+	const NAMEFilter availableFilters[] = { NAMEFilter(NAME::NAMEParameters::FunctionCode, 29),
+		                                      NAMEFilter(NAME::NAMEParameters::IndustryGroup, 2),
+		                                      NAMEFilter(NAME::NAMEParameters::DeviceClass, 4),
+		                                      NAMEFilter(NAME::NAMEParameters::ManufacturerCode, 1407),
+		                                      NAMEFilter(NAME::NAMEParameters::IdentityNumber, 123456),
+		                                      NAMEFilter(NAME::NAMEParameters::EcuInstance, 1),
+		                                      NAMEFilter(NAME::NAMEParameters::FunctionInstance, 0),
+		                                      NAMEFilter(NAME::NAMEParameters::DeviceClassInstance, 0),
+		                                      NAMEFilter(NAME::NAMEParameters::ArbitraryAddressCapable, 1) };
+
+	for (std::int64_t i = 0; i < state.range(0); i++)
+	{
+		filters.push_back(availableFilters[i]);
+	}
+
+	for (auto _ : state)
+	{
+		bool matches = true;
+
+		for (auto &filter : filters)
+		{
+			matches = (matches && filter.check_name_matches_filter(testName));
+		}
+		benchmark::DoNotOptimize(matches);
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(NAMEFilterMatch)->Arg(1)->Arg(4)->Arg(9);
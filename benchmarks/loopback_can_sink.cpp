@@ -0,0 +1,56 @@
+#include "loopback_can_sink.hpp"
+
+#include "isobus/isobus/can_hardware_abstraction.hpp"
+#include "isobus/isobus/can_network_manager.hpp"
+
+#include <vector>
+
+namespace
+{
+	std::vector<isobus::HardwareInterfaceCANFrame> pendingFrames;
+	std::vector<isobus::HardwareInterfaceCANFrame> receivingFrames;
+	std::uint64_t numberSentFrames = 0;
+	bool loopbackEnabled = true;
+}
+
+// Replaces the hardware integration library, so the benchmarks run without any CAN hardware
+bool isobus::send_can_message_to_hardware(HardwareInterfaceCANFrame frame)
+{
+	numberSentFrames++;
+
+	if (loopbackEnabled)
+	{
+		frame.channel ^= 1;
+		pendingFrames.push_back(frame);
+	}
+	return true;
+}
+
+void set_loopback_enabled(bool enabled)
+{
+	loopbackEnabled = enabled;
+}
+
+std::uint32_t process_loopback_frames()
+{
+	// Frames sent while these are received go in the other buffer, to be received next time
+	receivingFrames.swap(pendingFrames);
+	for (auto &frame : receivingFrames)
+	{
+		isobus::CANNetworkManager::can_lib_process_rx_message(frame, nullptr);
+	}
+
+	const std::uint32_t retVal = static_cast<std::uint32_t>(receivingFrames.size());
+	receivingFrames.clear();
+	return retVal;
+}
+
+void clear_loopback_frames()
+{
+	pendingFrames.clear();
+}
+
+std::uint64_t get_number_sent_frames()
+{
+	return numberSentFrames;
+}
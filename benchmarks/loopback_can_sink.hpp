@@ -0,0 +1,18 @@
+#pragma once
+
+#include "isobus/isobus/can_frame.hpp"
+
+#include <cstdint>
+
+/// Frames the stack sends are counted, and when looping back is enabled they are queued to be
+/// received on the other port of a pair (0 and 1, 2 and 3), like two nodes wired to the same bus.
+void set_loopback_enabled(bool enabled);
+
+/// Receives every queued frame on its paired port. Returns the number of frames received.
+std::uint32_t process_loopback_frames();
+
+/// Drops any frames still waiting to be looped back
+void clear_loopback_frames();
+
+/// Returns the number of frames the stack has sent since the program started
+std::uint64_t get_number_sent_frames();
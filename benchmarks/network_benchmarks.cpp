@@ -0,0 +1,80 @@
+#include <benchmark/benchmark.h>
+
+#include "benchmark_network.hpp"
+#include "isobus/isobus/can_network_manager.hpp"
+#include "loopback_can_sink.hpp"
+
+#include <vector>
+
+using namespace isobus;
+
+static void SendSingleFrame(benchmark::State &state)
+{
+	BenchmarkNetwork &network = get_benchmark_network();
+	const std::uint8_t data[CAN_DATA_LENGTH] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+	const std::uint64_t initialSentFrames = get_number_sent_frames();
+
+	// Only the encoding and the hand off to the frame sink are measured
+	set_loopback_enabled(false);
+	for (auto _ : state)
+	{
+		benchmark::DoNotOptimize(CANNetworkManager::CANNetwork.send_can_message(0xEF00,
+		                                                                        data,
+		                                                                        CAN_DATA_LENGTH,
+		                                                                        network.sender.get(),
+		                                                                        network.receiverPartner.get()));
+	}
+	set_loopback_enabled(true);
+
+	if ((get_number_sent_frames() - initialSentFrames) != static_cast<std::uint64_t>(state.iterations()))
+	{
+		state.SkipWithError("Not every frame was sent");
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(SendSingleFrame);
+
+static void count_received_message(CANMessage *, void *parentPointer)
+{
+	(*static_cast<std::uint64_t *>(parentPointer))++;
+}
+
+static void ReceiveAndDispatch(benchmark::State &state)
+{
+	constexpr std::uint32_t BROADCAST_PGN = 0xFF10;
+	BenchmarkNetwork &network = get_benchmark_network();
+	std::vector<HardwareInterfaceCANFrame> frames(static_cast<std::size_t>(state.range(0)));
+	std::uint64_t numberReceived = 0;
+
+	for (auto &frame : frames)
+	{
+		frame.timestamp_us = 0;
+		frame.identifier = CANIdentifier(CANIdentifier::Type::Extended, BROADCAST_PGN, CANIdentifier::CANPriority::PriorityDefault6, 0xFF, network.sender->get_address()).get_identifier();
+		frame.channel = 1;
+		frame.dataLength = CAN_DATA_LENGTH;
+		frame.isExtendedFrame = true;
+		for (std::uint8_t i = 0; i < CAN_DATA_LENGTH; i++)
+		{
+			frame.data[i] = i;
+		}
+	}
+
+	CANNetworkManager::CANNetwork.add_global_parameter_group_number_callback(BROADCAST_PGN, count_received_message, &numberReceived);
+	for (auto _ : state)
+	{
+		for (auto &frame : frames)
+		{
+			CANNetworkManager::can_lib_process_rx_message(frame, nullptr);
+		}
+		CANNetworkManager::CANNetwork.update();
+	}
+	CANNetworkManager::CANNetwork.remove_global_parameter_group_number_callback(BROADCAST_PGN, count_received_message, &numberReceived);
+	clear_loopback_frames();
+
+	if (numberReceived != (static_cast<std::uint64_t>(state.iterations()) * frames.size()))
+	{
+		state.SkipWithError("Not every frame was dispatched");
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(ReceiveAndDispatch)->Arg(1)->Arg(16)->Arg(64);
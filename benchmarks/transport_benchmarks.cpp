@@ -0,0 +1,235 @@
+#include <benchmark/benchmark.h>
+
+#include "benchmark_network.hpp"
+#include "isobus/isobus/can_general_parameter_group_numbers.hpp"
+#include "isobus/isobus/can_network_manager.hpp"
+#include "isobus/isobus/nmea2000_fast_packet_protocol.hpp"
+#include "loopback_can_sink.hpp"
+
+#include <vector>
+
+using namespace isobus;
+
+namespace
+{
+	constexpr std::uint32_t PROPRIETARY_A_PGN = 0xEF00; ///< Destination specific, so it uses TP or ETP connection mode
+	constexpr std::uint32_t BROADCAST_PGN = 0xFF20; ///< Broadcast, so it uses TP BAM
+	constexpr std::uint32_t FAST_PACKET_PGN = 0x1FF00; ///< A proprietary NMEA 2000 fast packet PGN
+
+	/// Tracks one message going through the loopback, from both ends
+	struct TransferState
+	{
+		std::vector<std::uint8_t> expectedData; ///< The payload the receiver should end up with
+		bool received; ///< The receiver got the whole message
+		bool sent; ///< The sender's session has ended
+		bool done; ///< Both ends are finished, so the next message can start
+		bool failed; ///< Something went wrong with the transfer
+	};
+
+	TransferState currentTransfer;
+
+	void on_message_received(CANMessage *message, void *parentPointer)
+	{
+		TransferState *transfer = static_cast<TransferState *>(parentPointer);
+
+		transfer->received = true;
+		transfer->failed = (transfer->failed || (message->get_data() != transfer->expectedData));
+		transfer->done = transfer->sent;
+	}
+
+	void on_message_sent(std::uint32_t, std::uint32_t, InternalControlFunction *, ControlFunction *, bool successful, void *parentPointer)
+	{
+		TransferState *transfer = static_cast<TransferState *>(parentPointer);
+
+		transfer->sent = true;
+		transfer->failed = (transfer->failed || (!successful));
+		transfer->done = transfer->received;
+	}
+
+	/// Makes a payload with a prime period, so data stored at the wrong offset doesn't match it by chance
+	std::vector<std::uint8_t> make_payload(std::size_t length)
+	{
+		std::vector<std::uint8_t> retVal(length);
+
+		for (std::size_t i = 0; i < length; i++)
+		{
+			retVal[i] = static_cast<std::uint8_t>(i % 251);
+		}
+		return retVal;
+	}
+
+	bool send_destination_specific(const std::vector<std::uint8_t> &data)
+	{
+		BenchmarkNetwork &network = get_benchmark_network();
+
+		return CANNetworkManager::CANNetwork.send_can_message(PROPRIETARY_A_PGN,
+		                                                      data.data(),
+		                                                      static_cast<std::uint32_t>(data.size()),
+		                                                      network.sender.get(),
+		                                                      network.receiverPartner.get(),
+		                                                      CANIdentifier::CANPriority::PriorityLowest7,
+		                                                      on_message_sent,
+		                                                      &currentTransfer);
+	}
+
+	bool send_fast_packet(const std::vector<std::uint8_t> &data)
+	{
+		return FastPacketProtocol::Protocol.send_multipacket_message(FAST_PACKET_PGN,
+		                                                             data.data(),
+		                                                             static_cast<std::uint8_t>(data.size()),
+		                                                             get_benchmark_network().sender.get(),
+		                                                             nullptr,
+		                                                             CANIdentifier::CANPriority::PriorityLowest7,
+		                                                             on_message_sent,
+		                                                             &currentTransfer);
+	}
+
+	/// Sends messages of one size over the loopback and waits for each to be reassembled
+	void run_transfers(benchmark::State &state, bool (*send)(const std::vector<std::uint8_t> &))
+	{
+		const std::vector<std::uint8_t> data = make_payload(static_cast<std::size_t>(state.range(0)));
+
+		currentTransfer.expectedData = data;
+		currentTransfer.failed = false;
+
+		for (auto _ : state)
+		{
+			currentTransfer.received = false;
+			currentTransfer.sent = false;
+			currentTransfer.done = false;
+
+			if (send(data))
+			{
+				run_network_until(currentTransfer.done);
+			}
+
+			if (!currentTransfer.done)
+			{
+				state.SkipWithError("Transfer did not complete");
+				break;
+			}
+			else if (currentTransfer.failed)
+			{
+				state.SkipWithError("Transfer failed or the received data did not match");
+				break;
+			}
+		}
+		state.SetBytesProcessed(state.iterations() * state.range(0));
+	}
+
+	/// Encodes the frames of a BAM session from the sender, as they would arrive on the receiver's port
+	std::vector<HardwareInterfaceCANFrame> make_broadcast_frames(std::uint8_t sourceAddress, const std::vector<std::uint8_t> &data)
+	{
+		const std::uint16_t length = static_cast<std::uint16_t>(data.size());
+		const std::uint8_t numberOfPackets = static_cast<std::uint8_t>((length + 6) / 7);
+		std::vector<HardwareInterfaceCANFrame> retVal(numberOfPackets + 1);
+
+		for (auto &frame : retVal)
+		{
+			frame.timestamp_us = 0;
+			frame.channel = 1;
+			frame.dataLength = CAN_DATA_LENGTH;
+			frame.isExtendedFrame = true;
+		}
+
+		retVal[0].identifier = CANIdentifier(CANIdentifier::Type::Extended,
+		                                     static_cast<std::uint32_t>(CANLibParameterGroupNumber::TransportProtocolCommand),
+		                                     CANIdentifier::CANPriority::PriorityLowest7,
+		                                     0xFF,
+		                                     sourceAddress)
+		                         .get_identifier();
+		retVal[0].data[0] = 0x20;
+		retVal[0].data[1] = static_cast<std::uint8_t>(length & 0xFF);
+		retVal[0].data[2] = static_cast<std::uint8_t>(length >> 8);
+		retVal[0].data[3] = numberOfPackets;
+		retVal[0].data[4] = 0xFF;
+		retVal[0].data[5] = static_cast<std::uint8_t>(BROADCAST_PGN & 0xFF);
+		retVal[0].data[6] = static_cast<std::uint8_t>((BROADCAST_PGN >> 8) & 0xFF);
+		retVal[0].data[7] = static_cast<std::uint8_t>((BROADCAST_PGN >> 16) & 0xFF);
+
+		for (std::uint16_t i = 1; i <= numberOfPackets; i++)
+		{
+			retVal[i].identifier = CANIdentifier(CANIdentifier::Type::Extended,
+			                                     static_cast<std::uint32_t>(CANLibParameterGroupNumber::TransportProtocolData),
+			                                     CANIdentifier::CANPriority::PriorityLowest7,
+			                                     0xFF,
+			                                     sourceAddress)
+			                         .get_identifier();
+			retVal[i].data[0] = static_cast<std::uint8_t>(i);
+			for (std::uint8_t j = 1; j < CAN_DATA_LENGTH; j++)
+			{
+				const std::uint32_t dataIndex = ((i - 1) * 7) + j - 1;
+
+				retVal[i].data[j] = ((dataIndex < length) ? data[dataIndex] : 0xFF);
+			}
+		}
+		return retVal;
+	}
+}
+
+static void TransportProtocolTransfer(benchmark::State &state)
+{
+	BenchmarkNetwork &network = get_benchmark_network();
+
+	network.senderPartner->add_parameter_group_number_callback(PROPRIETARY_A_PGN, on_message_received, &currentTransfer);
+	run_transfers(state, send_destination_specific);
+	network.senderPartner->remove_parameter_group_number_callback(PROPRIETARY_A_PGN, on_message_received, &currentTransfer);
+}
+BENCHMARK(TransportProtocolTransfer)->Arg(9)->Arg(100)->Arg(1785);
+
+static void ExtendedTransportProtocolTransfer(benchmark::State &state)
+{
+	BenchmarkNetwork &network = get_benchmark_network();
+
+	network.senderPartner->add_parameter_group_number_callback(PROPRIETARY_A_PGN, on_message_received, &currentTransfer);
+	run_transfers(state, send_destination_specific);
+	network.senderPartner->remove_parameter_group_number_callback(PROPRIETARY_A_PGN, on_message_received, &currentTransfer);
+}
+BENCHMARK(ExtendedTransportProtocolTransfer)->Arg(1786)->Arg(16384)->Arg(65536);
+
+static void FastPacketTransfer(benchmark::State &state)
+{
+	get_benchmark_network();
+	FastPacketProtocol::Protocol.register_multipacket_message_callback(FAST_PACKET_PGN, on_message_received, &currentTransfer);
+	run_transfers(state, send_fast_packet);
+	FastPacketProtocol::Protocol.remove_multipacket_message_callback(FAST_PACKET_PGN, on_message_received, &currentTransfer);
+}
+BENCHMARK(FastPacketTransfer)->Arg(9)->Arg(100)->Arg(223);
+
+static void BroadcastReassembly(benchmark::State &state)
+{
+	BenchmarkNetwork &network = get_benchmark_network();
+	const std::vector<std::uint8_t> data = make_payload(static_cast<std::size_t>(state.range(0)));
+	std::vector<HardwareInterfaceCANFrame> frames = make_broadcast_frames(network.sender->get_address(), data);
+
+	// BAM senders have to wait between frames, so only the receiving end is measured
+	currentTransfer.expectedData = data;
+	currentTransfer.failed = false;
+	CANNetworkManager::CANNetwork.add_global_parameter_group_number_callback(BROADCAST_PGN, on_message_received, &currentTransfer);
+
+	for (auto _ : state)
+	{
+		currentTransfer.received = false;
+
+		for (auto &frame : frames)
+		{
+			CANNetworkManager::can_lib_process_rx_message(frame, nullptr);
+		}
+		CANNetworkManager::CANNetwork.update();
+
+		if (!currentTransfer.received)
+		{
+			state.SkipWithError("Message was not reassembled");
+			break;
+		}
+		else if (currentTransfer.failed)
+		{
+			state.SkipWithError("Received data did not match");
+			break;
+		}
+	}
+	CANNetworkManager::CANNetwork.remove_global_parameter_group_number_callback(BROADCAST_PGN, on_message_received, &currentTransfer);
+	clear_loopback_frames();
+	state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BroadcastReassembly)->Arg(9)->Arg(100)->Arg(1785);
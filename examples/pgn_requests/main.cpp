@@ -10,8 +10,6 @@
 #include <memory>
 
 static std::shared_ptr<isobus::InternalControlFunction> TestInternalECU = nullptr;
-static std::uint32_t propARepetitionRate_ms = 0xFFFFFFFF;
-static isobus::ControlFunction *repetitionRateRequestor = nullptr;
 static SocketCANInterface canDriver("can0");
 
 using namespace std;
@@ -65,34 +63,15 @@ bool example_proprietary_a_pgn_request_handler(std::uint32_t parameterGroupNumbe
 	return retVal;
 }
 
-bool example_proprietary_a_request_for_repetition_rate_handler(std::uint32_t parameterGroupNumber,
-                                                               isobus::ControlFunction *requestingControlFunction,
-                                                               std::uint32_t repetitionRate,
-                                                               void *)
+bool example_proprietary_a_periodic_transmit_handler(std::uint32_t parameterGroupNumber,
+                                                     isobus::ControlFunction *destinationControlFunction,
+                                                     void *)
 {
-	bool retVal;
-
-	if (static_cast<std::uint32_t>(isobus::CANLibParameterGroupNumber::ProprietaryA) == parameterGroupNumber)
-	{
-		retVal = true;
-
-		// Put whatever logic you want to in here so that you can begin to handle the request.
-		// The CAN stack provides this easy way to receive requests for repetition rate, but
-		// your application must handle the actual processing and sending of those messages at the requested rate
-		// since the stack has no idea what your application actually does with most PGNs.
-
-		// In this example, I'll handle it by saving the repetition rate in a global variable and have
-		// main() service it at the desired rate.
-		repetitionRateRequestor = requestingControlFunction;
-		propARepetitionRate_ms = repetitionRate;
-	}
-	else
-	{
-		// If any other PGN is requested, since this callback doesn't handle it, return false.
-		// Returning false will tell the stack to keep looking for another callback (if any exist) to handle this PGN
-		retVal = false;
-	}
-	return retVal;
+	// The stack calls this whenever PROPA is due. It will be due at the default rate we registered,
+	// and additionally at any rate that someone requested with a request for repetition rate.
+	// The destination is the control function that requested the rate, or nullptr for the default broadcast.
+	std::uint8_t buffer[isobus::CAN_DATA_LENGTH] = { 0 };
+	return isobus::CANNetworkManager::CANNetwork.send_can_message(parameterGroupNumber, buffer, isobus::CAN_DATA_LENGTH, TestInternalECU.get(), destinationControlFunction);
 }
 
 void setup()
@@ -149,14 +128,11 @@ int main()
 		// Now, if you send a PGN request for EF00 to our internal control function, the stack will acknowledge it. Other requests will be NACK'ed (negative acknowledged)
 		// NOTE the device you send from MUST have address claimed.
 
-		// Now we'll set up a callback to handle requests for repetition rate for the PROPA PGN
-		pgnRequestProtocol->register_request_for_repetition_rate_callback(static_cast<std::uint32_t>(isobus::CANLibParameterGroupNumber::ProprietaryA), example_proprietary_a_request_for_repetition_rate_handler, nullptr);
-
-		// Now we'll get a callback when someone requests a repetition rate for PROPA.
-		// The application (not the stack) must handle these requests, as the CAN stack does not know what data to send when responding.
-		// It's entirely application defined!
-		// So we'll handle that below in the `while(true)` loop as an example.
-		// You do not need to handle every PGN. Only ones you care about. ISOBUS allows you to ignore any and all requests for repetition rate if you want with no reponse needed.
+		// Now we'll let the stack own the timing of PROPA. We'll broadcast it once per second by default,
+		// and the stack will automatically honour requests for repetition rate for it by calling our callback at the requested rate.
+		// The application only has to know what data to send, not when to send it.
+		// You do not need to schedule every PGN. Only ones you care about. ISOBUS allows you to ignore any and all requests for repetition rate if you want with no reponse needed.
+		pgnRequestProtocol->register_periodic_transmission(static_cast<std::uint32_t>(isobus::CANLibParameterGroupNumber::ProprietaryA), 1000, example_proprietary_a_periodic_transmit_handler, nullptr);
 
 		// This is how you would request a PGN from someone else. In this example, we request it from the broadcast address.
 		// Generally you'd want to replace nullptr with your partner control function as its a little nicer than just asking everyone on the bus for a PGN
@@ -165,17 +141,8 @@ int main()
 
 	while (true)
 	{
-		if (0xFFFFFFFF != propARepetitionRate_ms)
-		{
-			// If someone has requested a repetition rate for PROPA, service it here (in the application layer)
-			std::uint8_t buffer[isobus::CAN_DATA_LENGTH] = { 0 };
-			isobus::CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(isobus::CANLibParameterGroupNumber::ProprietaryA), buffer, isobus::CAN_DATA_LENGTH, TestInternalECU.get(), repetitionRateRequestor);
-			std::this_thread::sleep_for(std::chrono::milliseconds(propARepetitionRate_ms));
-		}
-		else
-		{
-			std::this_thread::sleep_for(std::chrono::milliseconds(5)); // Do nothing. Wait time is arbitrary.
-		}
+		// The stack services PROPA's timing for us, so there's nothing to do here
+		std::this_thread::sleep_for(std::chrono::milliseconds(5)); // Wait time is arbitrary.
 	}
 
 	cleanup();
@@ -16,7 +16,7 @@ static std::shared_ptr<isobus::PartneredControlFunction> TestPartnerVT = nullptr
 static std::shared_ptr<isobus::VirtualTerminalClient> TestVirtualTerminalClient = nullptr;
 std::vector<isobus::NAMEFilter> vtNameFilters;
 const isobus::NAMEFilter testFilter(isobus::NAME::NAMEParameters::FunctionCode, static_cast<std::uint8_t>(isobus::NAME::Function::VirtualTerminal));
-static std::vector<std::uint8_t> testPool;
+static isobus::MappedIOPFile testPool;
 static SocketCANInterface canDriver("can0");
 
 using namespace std;
@@ -116,9 +116,7 @@ void setup()
 	TestDeviceNAME.set_manufacturer_code(64);
 	vtNameFilters.push_back(testFilter);
 
-	testPool = isobus::IOPFileInterface::read_iop_file("VT3TestPool.iop");
-
-	if (0 != testPool.size())
+	if (testPool.open("VT3TestPool.iop"))
 	{
 		std::cout << "Loaded object pool from VT3TestPool.iop" << std::endl;
 	}
@@ -130,7 +128,7 @@ void setup()
 	TestInternalECU = std::make_shared<isobus::InternalControlFunction>(TestDeviceNAME, 0x1C, 0);
 	TestPartnerVT = std::make_shared<isobus ::PartneredControlFunction>(0, vtNameFilters);
 	TestVirtualTerminalClient = std::make_shared<isobus::VirtualTerminalClient>(TestPartnerVT, TestInternalECU);
-	TestVirtualTerminalClient->set_object_pool(0, isobus::VirtualTerminalClient::VTVersion::Version3, testPool.data(), testPool.size());
+	TestVirtualTerminalClient->set_object_pool(0, isobus::VirtualTerminalClient::VTVersion::Version3, testPool.get_data(), testPool.get_size());
 	TestVirtualTerminalClient->RegisterVTButtonEventCallback(handleVTButton);
 	TestVirtualTerminalClient->RegisterVTSoftKeyEventCallback(handleVTButton);
 	TestVirtualTerminalClient->initialize(true);
@@ -0,0 +1,108 @@
+//================================================================================================
+/// @file can_bus_log_file.hpp
+///
+/// @brief Reads the binary bus logs written by `CANBusLogger`, using their index to jump to a
+/// time or to only the blocks that have a PGN, for offline analysis.
+/// @author Adrian Del Grosso
+///
+/// @copyright 2022 Adrian Del Grosso
+//================================================================================================
+#ifndef CAN_BUS_LOG_FILE_HPP
+#define CAN_BUS_LOG_FILE_HPP
+
+#include "isobus/hardware_integration/can_bus_log_format.hpp"
+#include "isobus/isobus/can_frame.hpp"
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+//================================================================================================
+/// @class CANBusLogFile
+///
+/// @brief Reads frames from one file written by `CANBusLogger`
+/// @details Only the index is read when the file is opened, and then one block at a time as
+/// frames are read, so files much larger than memory can be read. If the file wasn't closed,
+/// the index is rebuilt from the block headers, and a partly written last block is ignored.
+///
+/// Frames are read in the order they were logged. `seek_to_time` and the PGN filter use the
+/// index to skip whole blocks, then skip the frames in the remaining blocks that don't match.
+//================================================================================================
+class CANBusLogFile
+{
+public:
+	/// @brief Constructor for a reader with no file open
+	CANBusLogFile();
+
+	/// @brief Deleted copy constructor, as the reader owns its file
+	CANBusLogFile(const CANBusLogFile &) = delete;
+
+	/// @brief Deleted assignment operator, as the reader owns its file
+	CANBusLogFile &operator=(const CANBusLogFile &) = delete;
+
+	/// @brief Opens a log file and reads its index
+	/// @param[in] fileName The path of the log to read
+	/// @returns `true` if the file is a bus log that can be read, otherwise `false`
+	bool open(const std::string &fileName);
+
+	/// @brief Closes the file
+	void close();
+
+	/// @brief Reads the next frame that matches the filter
+	/// @param[out] canFrame The frame that was read
+	/// @param[out] transmitted `true` if the frame was sent by the logging device, `false` if it was received
+	/// @returns `true` if a frame was read, `false` at the end of the file or if a block is corrupt
+	bool read_frame(isobus::HardwareInterfaceCANFrame &canFrame, bool &transmitted);
+
+	/// @brief Moves to the first frame at or after a time
+	/// @param[in] timestamp_us The time to move to, in the same time base as the frames
+	/// @returns `true` if there are frames at or after the time, otherwise `false`
+	bool seek_to_time(std::uint64_t timestamp_us);
+
+	/// @brief Moves back to the first frame in the file
+	void rewind();
+
+	/// @brief Only reads extended frames with a PGN from now on
+	/// @param[in] parameterGroupNumber The PGN to read
+	void set_parameter_group_number_filter(std::uint32_t parameterGroupNumber);
+
+	/// @brief Reads all frames again from now on
+	void clear_parameter_group_number_filter();
+
+	/// @brief Returns the index of the file
+	/// @returns The blocks in the file
+	const std::vector<CANBusLogFormat::BlockInfo> &get_blocks() const;
+
+	/// @brief Returns the position of the file in a set of rotated files
+	/// @returns The sequence number from the file header
+	std::uint32_t get_sequence_number() const;
+
+	/// @brief Returns if the file has an index, which means it was closed by the logger
+	/// @returns `true` if the index was read from the file, `false` if it had to be rebuilt
+	bool get_was_closed() const;
+
+private:
+	/// @brief Rebuilds the index of a file that wasn't closed by reading each block header
+	/// @param[in] fileSize_bytes The size of the file
+	void scan_blocks(std::uint64_t fileSize_bytes);
+
+	/// @brief Reads and decodes a block
+	/// @param[in] blockIndex The block to read
+	/// @returns `true` if the block was read, otherwise `false`
+	bool load_block(std::size_t blockIndex);
+
+	std::ifstream logFile; ///< The file being read
+	std::vector<CANBusLogFormat::BlockInfo> blocks; ///< The index of the file
+	std::vector<CANBusLogFormat::LoggedFrame> blockFrames; ///< The frames of the block being read
+	std::vector<std::uint8_t> readBuffer; ///< Reused to read a block
+	std::size_t nextBlock; ///< The block to read once the frames of the current one are used up
+	std::size_t nextFrame; ///< The next frame in `blockFrames` to read
+	std::uint64_t minimumTimestamp_us; ///< Frames before this time are skipped, from `seek_to_time`
+	std::uint32_t filterParameterGroupNumber; ///< The PGN to read, when `filterEnabled` is set
+	std::uint32_t sequenceNumber; ///< The position of the file in a set of rotated files
+	bool filterEnabled; ///< Stores if only frames with `filterParameterGroupNumber` are read
+	bool wasClosed; ///< Stores if the index was read from the file
+};
+
+#endif // CAN_BUS_LOG_FILE_HPP
@@ -0,0 +1,195 @@
+//================================================================================================
+/// @file can_bus_log_format.hpp
+///
+/// @brief Defines the compact binary bus log format written by `CANBusLogger` and read by
+/// `CANBusLogFile`, and encodes and decodes its blocks of frames.
+/// @author Adrian Del Grosso
+///
+/// @copyright 2022 Adrian Del Grosso
+//================================================================================================
+#ifndef CAN_BUS_LOG_FORMAT_HPP
+#define CAN_BUS_LOG_FORMAT_HPP
+
+#include "isobus/isobus/can_frame.hpp"
+
+#include <cstdint>
+#include <vector>
+
+//================================================================================================
+/// @class CANBusLogFormat
+///
+/// @brief The layout of a binary bus log file
+/// @details A file is a 16 byte file header, then blocks of frames, then an index of the blocks
+/// and a 16 byte footer. Every number is little endian.
+///
+/// Each block is a 64 byte block header followed by its encoded frames. The header has the
+/// time range of the block and a bitmap of the PGNs in it, so blocks can be skipped without
+/// decoding them. The index at the end of the file is the file offset of each block followed by
+/// a copy of its header, so a reader can find a time or PGN without reading the whole file.
+/// The footer is the file offset of the index, the number of blocks, and `INDEX_MAGIC`.
+/// A file that wasn't closed, like after a power loss, has no index, but the block headers
+/// can still be scanned to rebuild it.
+///
+/// Frames are compressed by the block encoder without any external library: each frame is the
+/// zig-zag varint difference between its timestamp and the one before, a flags byte, and either
+/// a one byte reference to a channel and identifier seen earlier in the block or the channel and
+/// identifier themselves. Then there's a byte with a bit for each data byte that changed since
+/// the last frame with that channel and identifier, followed by only the changed bytes.
+/// Periodic ISOBUS traffic usually compresses to 3 to 6 bytes a frame. Each block starts from
+/// scratch, so any block can be decoded on its own.
+//================================================================================================
+class CANBusLogFormat
+{
+public:
+	/// @brief A frame in a log, and if it was sent or received
+	class LoggedFrame
+	{
+	public:
+		/// @brief Constructor for an empty received frame
+		LoggedFrame();
+
+		isobus::HardwareInterfaceCANFrame frame; ///< The frame
+		bool transmitted; ///< `true` if the frame was sent by this device, `false` if it was received
+	};
+
+	/// @brief Information about a block of frames, which is both its header and its index entry
+	class BlockInfo
+	{
+	public:
+		/// @brief Constructor for an empty block
+		BlockInfo();
+
+		/// @brief Adds a frame to the time range and PGN bitmap of the block
+		/// @param[in] canFrame The frame to add
+		void add_frame(const isobus::HardwareInterfaceCANFrame &canFrame);
+
+		/// @brief Checks the PGN bitmap for a PGN
+		/// @param[in] parameterGroupNumber The PGN to look for
+		/// @returns `false` if the block has no frames with the PGN, `true` if it might have some
+		bool get_may_contain_parameter_group_number(std::uint32_t parameterGroupNumber) const;
+
+		std::uint64_t fileOffset; ///< Where the block header starts in the file. Only stored in the index.
+		std::uint32_t payloadSize; ///< The number of bytes of encoded frames after the block header
+		std::uint32_t numberOfFrames; ///< The number of frames in the block
+		std::uint64_t baseTimestamp_us; ///< The timestamp of the first frame, which the first time difference is from
+		std::uint64_t minimumTimestamp_us; ///< The earliest timestamp in the block
+		std::uint64_t maximumTimestamp_us; ///< The latest timestamp in the block
+		std::uint8_t parameterGroupNumberBitmap[32]; ///< A bit for each hash of the PGNs of the extended frames in the block
+	};
+
+	/// @brief Builds up the encoded frames of one block
+	class BlockEncoder
+	{
+	public:
+		/// @brief Constructor for an empty block
+		BlockEncoder();
+
+		/// @brief Adds a frame to the block
+		/// @param[in] loggedFrame The frame to add
+		/// @returns `true` if the frame was added, `false` if the block is full and should be written first
+		bool add_frame(const LoggedFrame &loggedFrame);
+
+		/// @brief Empties the block so a new one can be built
+		void reset();
+
+		/// @brief Returns the information for the header of the block
+		/// @returns The block information, without its file offset
+		const BlockInfo &get_info() const;
+
+		/// @brief Returns the encoded frames
+		/// @returns The encoded frames, which go after the block header
+		const std::vector<std::uint8_t> &get_payload() const;
+
+	private:
+		/// @brief The last data sent with a channel and identifier
+		struct DictionaryEntry
+		{
+			std::uint32_t key; ///< The identifier with `EXTENDED_IDENTIFIER_FLAG` when it's extended
+			std::uint8_t channel; ///< The channel
+			std::uint8_t data[8]; ///< The last data, which the next frame's changes are from
+		};
+
+		BlockInfo info; ///< The header information of the block
+		std::vector<std::uint8_t> payload; ///< The encoded frames
+		std::vector<DictionaryEntry> dictionary; ///< The channels and identifiers in the block so far
+		std::uint64_t lastTimestamp_us; ///< The timestamp of the last frame added
+	};
+
+	/// @brief Decodes the frames of a block
+	/// @param[in] info The header of the block
+	/// @param[in] payload The encoded frames of the block
+	/// @param[out] frames The frames in the block, in the order they were logged
+	/// @returns `true` if the whole block was decoded, `false` if it's corrupt
+	static bool decode_block(const BlockInfo &info, const std::vector<std::uint8_t> &payload, std::vector<LoggedFrame> &frames);
+
+	/// @brief Adds a file header to a buffer
+	/// @param[in] sequenceNumber The position of the file in a set of rotated files
+	/// @param[out] buffer The buffer to add to
+	static void append_file_header(std::uint32_t sequenceNumber, std::vector<std::uint8_t> &buffer);
+
+	/// @brief Reads a file header
+	/// @param[in] buffer The `FILE_HEADER_SIZE` bytes of the header
+	/// @param[out] sequenceNumber The position of the file in a set of rotated files
+	/// @returns `true` if the header is for a version of the format that can be read, otherwise `false`
+	static bool parse_file_header(const std::uint8_t *buffer, std::uint32_t &sequenceNumber);
+
+	/// @brief Adds a block header to a buffer
+	/// @param[in] info The block to add the header of
+	/// @param[out] buffer The buffer to add to
+	static void append_block_header(const BlockInfo &info, std::vector<std::uint8_t> &buffer);
+
+	/// @brief Reads a block header
+	/// @param[in] buffer The `BLOCK_HEADER_SIZE` bytes of the header
+	/// @param[out] info The block, without its file offset
+	static void parse_block_header(const std::uint8_t *buffer, BlockInfo &info);
+
+	/// @brief Adds an index entry, which is a block's file offset and header, to a buffer
+	/// @param[in] info The block to add the index entry of
+	/// @param[out] buffer The buffer to add to
+	static void append_index_entry(const BlockInfo &info, std::vector<std::uint8_t> &buffer);
+
+	/// @brief Reads an index entry
+	/// @param[in] buffer The `INDEX_ENTRY_SIZE` bytes of the entry
+	/// @param[out] info The block, including its file offset
+	static void parse_index_entry(const std::uint8_t *buffer, BlockInfo &info);
+
+	/// @brief Adds a file footer to a buffer
+	/// @param[in] indexOffset Where the index starts in the file
+	/// @param[in] numberOfBlocks The number of blocks in the index
+	/// @param[out] buffer The buffer to add to
+	static void append_file_footer(std::uint64_t indexOffset, std::uint32_t numberOfBlocks, std::vector<std::uint8_t> &buffer);
+
+	/// @brief Reads a file footer
+	/// @param[in] buffer The `FILE_FOOTER_SIZE` bytes of the footer
+	/// @param[out] indexOffset Where the index starts in the file
+	/// @param[out] numberOfBlocks The number of blocks in the index
+	/// @returns `true` if the footer is valid, `false` if the file wasn't closed
+	static bool parse_file_footer(const std::uint8_t *buffer, std::uint64_t &indexOffset, std::uint32_t &numberOfBlocks);
+
+	/// @brief Works out the PGN of an extended identifier
+	/// @param[in] identifier The 29 bit identifier
+	/// @returns The PGN in the identifier
+	static std::uint32_t get_parameter_group_number(std::uint32_t identifier);
+
+	static constexpr std::uint16_t FILE_VERSION = 1; ///< The version of the format that is written
+	static constexpr std::uint32_t FILE_HEADER_SIZE = 16; ///< The size of the file header in bytes
+	static constexpr std::uint32_t BLOCK_HEADER_SIZE = 64; ///< The size of a block header in bytes
+	static constexpr std::uint32_t INDEX_ENTRY_SIZE = 72; ///< The size of an index entry, which is a file offset and a block header
+	static constexpr std::uint32_t FILE_FOOTER_SIZE = 16; ///< The size of the file footer in bytes
+	static constexpr std::uint32_t MAXIMUM_FRAMES_PER_BLOCK = 4096; ///< The most frames in a block
+	static constexpr std::uint32_t MAXIMUM_IDENTIFIERS_PER_BLOCK = 256; ///< The most channel and identifier pairs in a block, so they can be referred to with one byte
+	static constexpr std::uint32_t INDEX_MAGIC = 0x58444E49; ///< "INDX", the last 4 bytes of a file that was closed
+
+private:
+	static constexpr std::uint32_t EXTENDED_IDENTIFIER_FLAG = 0x80000000; ///< Marks an identifier as extended in the encoded frames
+	static constexpr std::uint8_t FLAG_DATA_LENGTH_MASK = 0x0F; ///< The bits of a frame's flags that have its data length
+	static constexpr std::uint8_t FLAG_TRANSMITTED = 0x10; ///< The flag for a frame that was sent by this device
+	static constexpr std::uint8_t FLAG_NEW_IDENTIFIER = 0x20; ///< The flag for a frame with a channel and identifier not seen before in the block
+
+	/// @brief Works out which bit of the PGN bitmap a PGN uses
+	/// @param[in] parameterGroupNumber The PGN
+	/// @returns The bit number, from 0 to 255
+	static std::uint8_t get_parameter_group_number_bit(std::uint32_t parameterGroupNumber);
+};
+
+#endif // CAN_BUS_LOG_FORMAT_HPP
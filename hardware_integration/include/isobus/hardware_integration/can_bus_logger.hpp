@@ -0,0 +1,184 @@
+//================================================================================================
+/// @file can_bus_logger.hpp
+///
+/// @brief Logs every frame sent and received by the hardware interface to compact, indexed,
+/// rotating binary files, from its own thread so the CAN thread never waits on the disk.
+/// @author Adrian Del Grosso
+///
+/// @copyright 2022 Adrian Del Grosso
+//================================================================================================
+#ifndef CAN_BUS_LOGGER_HPP
+#define CAN_BUS_LOGGER_HPP
+
+#include "isobus/hardware_integration/can_bus_log_format.hpp"
+#include "isobus/isobus/can_frame.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+//================================================================================================
+/// @class CANBusLogger
+///
+/// @brief Writes bus traffic to files in the format described by `CANBusLogFormat`
+/// @details When started, the logger adds raw Rx and Tx callbacks to the `CANHardwareInterface`,
+/// which only copy each frame into a lock-free queue. A writer thread takes frames off the queue,
+/// compresses them into blocks, and writes each block when it's full or has been open for
+/// `BLOCK_FLUSH_INTERVAL_MS`. If the queue fills up because the disk can't keep up, frames are
+/// dropped and counted rather than slowing down the stack.
+///
+/// Files are named from a prefix and a sequence number, like `gateway_0000.canlog`, and a new file
+/// is started when the current one reaches its size or age limit. Use `CANBusLogFile` to read them.
+//================================================================================================
+class CANBusLogger
+{
+public:
+	/// @brief Constructor for a stopped logger
+	/// @param[in] queueSize How many frames can wait for the writer thread, rounded up to a power of 2
+	explicit CANBusLogger(std::size_t queueSize = DEFAULT_QUEUE_SIZE);
+
+	/// @brief Destructor, which stops the logger and finishes the current file
+	~CANBusLogger();
+
+	/// @brief Deleted copy constructor, as the logger owns its thread and file
+	CANBusLogger(const CANBusLogger &) = delete;
+
+	/// @brief Deleted assignment operator, as the logger owns its thread and file
+	CANBusLogger &operator=(const CANBusLogger &) = delete;
+
+	/// @brief Opens the first log file, starts the writer thread, and starts logging the hardware interface's frames
+	/// @param[in] filePrefix The path and start of the name of the log files
+	/// @returns `true` if logging started, `false` if the logger was already running or the file couldn't be opened
+	bool start(const std::string &filePrefix);
+
+	/// @brief Stops logging, writes the frames still queued, and finishes the current file
+	void stop();
+
+	/// @brief Returns if the logger is running
+	/// @returns `true` if the logger has been started and not stopped, otherwise `false`
+	bool get_is_running() const;
+
+	/// @brief Queues a frame to be logged. Can be called from any thread, and never blocks.
+	/// @param[in] canFrame The frame to log
+	/// @param[in] transmitted `true` if the frame was sent by this device, `false` if it was received
+	/// @returns `true` if the frame was queued, `false` if the logger isn't running or the queue is full
+	bool log_frame(const isobus::HardwareInterfaceCANFrame &canFrame, bool transmitted);
+
+	/// @brief Sets the size at which a new file is started. Takes effect at the next block.
+	/// @param[in] maximumSize_bytes The largest a file should get, or 0 for no limit
+	void set_maximum_file_size(std::uint64_t maximumSize_bytes);
+
+	/// @brief Sets the age at which a new file is started. Takes effect at the next block.
+	/// @param[in] maximumDuration_ms The longest a file should be written to, or 0 for no limit
+	void set_maximum_file_duration(std::uint32_t maximumDuration_ms);
+
+	/// @brief Returns the names of the files written since the logger was started, oldest first
+	/// @returns The names of the files, the last of which is still being written if the logger is running
+	std::vector<std::string> get_file_names() const;
+
+	/// @brief Returns the number of frames written to files since the logger was started
+	/// @returns The number of frames written
+	std::uint64_t get_number_logged_frames() const;
+
+	/// @brief Returns the number of frames dropped because the queue was full
+	/// @returns The number of frames dropped since the logger was started
+	std::uint64_t get_number_dropped_frames() const;
+
+	/// @brief Returns the number of times writing to a file failed
+	/// @returns The number of failed writes since the logger was started
+	std::uint32_t get_number_write_errors() const;
+
+	static constexpr std::size_t DEFAULT_QUEUE_SIZE = 16384; ///< The default number of frames that can wait for the writer thread
+	static constexpr std::uint64_t DEFAULT_MAXIMUM_FILE_SIZE = 64 * 1024 * 1024; ///< The default size at which a new file is started
+	static constexpr std::uint32_t BLOCK_FLUSH_INTERVAL_MS = 1000; ///< The longest a partly full block waits before it's written
+	static constexpr std::uint32_t WRITER_IDLE_SLEEP_MS = 2; ///< How long the writer thread sleeps when the queue is empty
+
+private:
+	/// @brief A bounded queue that any number of threads can add to and take from without locking
+	/// @details Each cell has a sequence number that says whether it's ready to be written or
+	/// read for the current lap of the ring, so threads only contend on the head and tail positions.
+	class FrameQueue
+	{
+	public:
+		/// @brief Constructor for an empty queue
+		/// @param[in] size The number of cells, rounded up to a power of 2
+		explicit FrameQueue(std::size_t size);
+
+		/// @brief Adds a frame to the queue
+		/// @param[in] loggedFrame The frame to add
+		/// @returns `true` if the frame was added, `false` if the queue is full
+		bool push(const CANBusLogFormat::LoggedFrame &loggedFrame);
+
+		/// @brief Takes the oldest frame off the queue
+		/// @param[out] loggedFrame The frame
+		/// @returns `true` if a frame was taken, `false` if the queue is empty
+		bool pop(CANBusLogFormat::LoggedFrame &loggedFrame);
+
+	private:
+		/// @brief A slot in the queue
+		struct Cell
+		{
+			std::atomic<std::size_t> sequence; ///< The position this cell is ready to be written at, or that plus 1 once it holds a frame
+			CANBusLogFormat::LoggedFrame loggedFrame; ///< The frame in the cell
+		};
+
+		std::unique_ptr<Cell[]> cells; ///< The ring of cells
+		std::size_t mask; ///< The number of cells minus 1, to wrap positions onto cells
+		std::atomic<std::size_t> enqueuePosition; ///< The next position to write to
+		std::atomic<std::size_t> dequeuePosition; ///< The next position to read from
+	};
+
+	/// @brief The raw Rx callback given to the hardware interface
+	/// @param[in] rxFrame The frame that was received
+	/// @param[in] parentPointer The logger
+	static void process_rx_frame(isobus::HardwareInterfaceCANFrame &rxFrame, void *parentPointer);
+
+	/// @brief The raw Tx callback given to the hardware interface
+	/// @param[in] txFrame The frame that was sent
+	/// @param[in] parentPointer The logger
+	static void process_tx_frame(isobus::HardwareInterfaceCANFrame &txFrame, void *parentPointer);
+
+	/// @brief The writer thread executes this function
+	void writer_thread_function();
+
+	/// @brief Opens the next file in the sequence and writes its header
+	/// @returns `true` if the file was opened, otherwise `false`
+	bool open_next_file();
+
+	/// @brief Writes the index and footer of the current file, and closes it
+	void close_file();
+
+	/// @brief Writes the block being built to the current file and starts a new block
+	void write_block();
+
+	/// @brief Writes bytes to the current file, counting any failure
+	/// @param[in] buffer The bytes to write
+	void write_buffer(const std::vector<std::uint8_t> &buffer);
+
+	FrameQueue queue; ///< Frames waiting for the writer thread
+	CANBusLogFormat::BlockEncoder encoder; ///< The block being built by the writer thread
+	std::vector<CANBusLogFormat::BlockInfo> fileIndex; ///< The blocks in the current file
+	std::vector<std::uint8_t> writeBuffer; ///< Reused by the writer thread to write a block in one go
+	std::ofstream logFile; ///< The file being written
+	std::string prefix; ///< The path and start of the name of the log files
+	std::vector<std::string> fileNames; ///< The files written since the logger was started
+	mutable std::mutex fileNamesMutex; ///< Protects `fileNames`, which the writer thread adds to
+	std::thread *writerThread; ///< The thread that writes the files
+	std::uint64_t fileSize_bytes; ///< The size of the current file
+	std::uint32_t fileOpenedTimestamp_ms; ///< When the current file was opened
+	std::uint32_t blockStartedTimestamp_ms; ///< When the first frame was added to the block being built
+	std::uint32_t nextSequenceNumber; ///< The sequence number of the next file
+	std::atomic<std::uint64_t> maximumFileSize_bytes; ///< The size at which a new file is started, or 0 for no limit
+	std::atomic<std::uint32_t> maximumFileDuration_ms; ///< The age at which a new file is started, or 0 for no limit
+	std::atomic<std::uint64_t> loggedFrames; ///< The number of frames written to files
+	std::atomic<std::uint64_t> droppedFrames; ///< The number of frames dropped because the queue was full
+	std::atomic<std::uint32_t> writeErrors; ///< The number of failed writes
+	std::atomic_bool running; ///< Stores if the logger is accepting frames
+};
+
+#endif // CAN_BUS_LOGGER_HPP
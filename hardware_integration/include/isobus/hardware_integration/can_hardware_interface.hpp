@@ -9,6 +9,7 @@
 #ifndef CAN_HARDWARE_INTERFACE_HPP
 #define CAN_HARDWARE_INTERFACE_HPP
 
+#include <atomic>
 #include <condition_variable>
 #include <cstdint>
 #include <cstring>
@@ -18,6 +19,7 @@
 #include <vector>
 
 #include "isobus/hardware_integration/can_hardware_plugin.hpp"
+#include "isobus/isobus/can_bus_load.hpp"
 #include "isobus/isobus/can_frame.hpp"
 #include "isobus/isobus/can_hardware_abstraction.hpp"
 
@@ -49,7 +51,7 @@ public:
 		void *parent; ///< Context variable, the owner of the callback
 	};
 
-	/// @brief A class to store information about Rx callbacks
+	/// @brief A class to store information about Rx and Tx callbacks
 	class RawCanMessageCallbackInfo
 	{
 	public:
@@ -64,6 +66,24 @@ public:
 		void *parent; ///< Context variable, the owner of the callback
 	};
 
+	/// @brief A snapshot of the counters for one CAN channel
+	class ChannelStatistics
+	{
+	public:
+		/// @brief Constructs a `ChannelStatistics`, with every counter at 0
+		ChannelStatistics();
+
+		std::uint64_t receivedFrames; ///< The number of frames read from the driver
+		std::uint64_t receivedBytes; ///< The number of data bytes in the frames read from the driver
+		std::uint64_t transmittedFrames; ///< The number of frames the driver accepted for sending
+		std::uint64_t transmittedBytes; ///< The number of data bytes in the frames the driver accepted for sending
+		std::uint32_t transmitFailures; ///< The number of times the driver didn't accept a frame, which is then tried again later
+		std::uint32_t droppedFrames; ///< The number of received frames the driver reports it dropped, like socket CAN receive queue overflows
+		std::uint32_t receiveQueueHighWaterMark; ///< The most frames that have waited in the Rx queue for the stack at once
+		std::uint32_t transmitQueueHighWaterMark; ///< The most frames that have waited in the Tx queue for the driver at once
+		float busLoadPercent; ///< An estimate of how busy the bus was over the last second, from the frames we sent and received, as worked out by `isobus::CANBusLoad`
+	};
+
 	static CANHardwareInterface CAN_HARDWARE_INTERFACE; ///< Static singleton instance of this class
 
 	/// @brief Returns the number of configured CAN channels that the class is managing
@@ -111,6 +131,19 @@ public:
 	/// @returns `true` if the callback was removed, `false` if no callback matched the two parameters
 	static bool remove_raw_can_message_rx_callback(void (*callback)(isobus::HardwareInterfaceCANFrame &rxFrame, void *parentPointer), void *parentPointer);
 
+	/// @brief Adds a Tx callback. The added callback will be called any time the driver accepts a CAN message for sending.
+	/// @details The frame is timestamped with `SystemTiming` when the driver accepts it.
+	/// @param[in] callback The callback to add
+	/// @param[in] parentPointer Generic context variable, usually a pointer to the owner class for this callback
+	/// @returns `true` if the callback was added, `false` if it was already in the list
+	static bool add_raw_can_message_tx_callback(void (*callback)(isobus::HardwareInterfaceCANFrame &txFrame, void *parentPointer), void *parentPointer);
+
+	/// @brief Removes a Tx callback
+	/// @param[in] callback The callback to remove
+	/// @param[in] parentPointer Generic context variable, usually a pointer to the owner class for this callback
+	/// @returns `true` if the callback was removed, `false` if no callback matched the two parameters
+	static bool remove_raw_can_message_tx_callback(void (*callback)(isobus::HardwareInterfaceCANFrame &txFrame, void *parentPointer), void *parentPointer);
+
 	/// @brief Adds a periodic udpate callback
 	/// @param[in] callback The callback to add
 	/// @param[in] parentPointer Generic context variable, usually a pointer to the owner class for this callback
@@ -123,6 +156,25 @@ public:
 	/// @returns `true` if the callback was removed, `false` if no callback matched the two parameters
 	static bool remove_can_lib_update_callback(void (*callback)(), void *parentPointer);
 
+	/// @brief Gets a snapshot of the counters for a CAN channel
+	/// @details The counters are kept with atomics, so this doesn't slow down the threads that update them.
+	/// @param[in] aCANChannel The channel to get the counters of
+	/// @param[out] statistics The counters for the channel
+	/// @returns `true` if the channel exists, otherwise `false`
+	static bool get_channel_statistics(std::uint8_t aCANChannel, ChannelStatistics &statistics);
+
+	/// @brief Sets the counters for a CAN channel back to 0
+	/// @param[in] aCANChannel The channel to reset the counters of
+	/// @returns `true` if the channel exists, otherwise `false`
+	static bool reset_channel_statistics(std::uint8_t aCANChannel);
+
+	/// @brief Sets the bit rate of a CAN channel, which is used to estimate its bus load
+	/// @details The bit rate is 250 kbit/s unless this is called, as that's what ISO 11783 uses.
+	/// @param[in] aCANChannel The channel to set the bit rate of
+	/// @param[in] bitRate The bit rate of the bus in bits per second
+	/// @returns `true` if the bit rate was set, otherwise `false`
+	static bool set_channel_bit_rate(std::uint8_t aCANChannel, std::uint32_t bitRate);
+
 private:
 	/// @brief Private constructor, prevents more of these classes from being needlessly created
 	CANHardwareInterface();
@@ -130,6 +182,13 @@ private:
 	/// @brief Private destructor
 	~CANHardwareInterface();
 
+	/// @brief A received frame waiting in a channel's Rx queue
+	struct ReceivedFrame
+	{
+		isobus::HardwareInterfaceCANFrame frame; ///< The frame
+		std::uint64_t queuedTimestamp_us; ///< When the frame was read from the driver, from `CANLatencyProfiler::get_timestamp_us`
+	};
+
 	/// @brief Stores the Tx/Rx queues, mutexes, and driver needed to run a single CAN channel
 	struct CanHardware
 	{
@@ -137,16 +196,42 @@ private:
 		std::deque<isobus::HardwareInterfaceCANFrame> messagesToBeTransmitted; ///< Tx message queue for a CAN channel
 
 		std::mutex receivedMessagesMutex; ///< Mutex to protect the Rx queue
-		std::deque<isobus::HardwareInterfaceCANFrame> receivedMessages; ///< Rx message queue for a CAN channel
+		std::deque<ReceivedFrame> receivedMessages; ///< Rx message queue for a CAN channel
 
 		std::thread *receiveMessageThread; ///< Thread to manage getting messages from a CAN channel
 
 		CANHardwarePlugin *frameHandler; ///< The CAN driver to use for a CAN channel
+
+		std::atomic<std::uint64_t> receivedFrames; ///< The number of frames read from the driver
+		std::atomic<std::uint64_t> receivedBytes; ///< The number of data bytes in the frames read from the driver
+		std::atomic<std::uint64_t> transmittedFrames; ///< The number of frames the driver accepted for sending
+		std::atomic<std::uint64_t> transmittedBytes; ///< The number of data bytes in the frames the driver accepted for sending
+		std::atomic<std::uint32_t> transmitFailures; ///< The number of times the driver didn't accept a frame
+		std::atomic<std::uint32_t> droppedFramesAtReset; ///< The driver's dropped frame count when the statistics were last reset
+		std::atomic<std::uint32_t> receiveQueueHighWaterMark; ///< The most frames that have waited in the Rx queue at once
+		std::atomic<std::uint32_t> transmitQueueHighWaterMark; ///< The most frames that have waited in the Tx queue at once
+		isobus::CANBusLoad busLoad; ///< The load estimate of the bus, from the frames sent and received on it
 	};
 
 	/// @brief A hard-coded update interval for the CAN stack. Mostly arbitrary
 	static const std::uint32_t CANLIB_UPDATE_RATE = 4;
 
+	/// @brief Sets all the counters of a CAN channel back to 0
+	/// @param[in] channel The channel to reset the counters of
+	static void clear_statistics(CanHardware &channel);
+
+	/// @brief Counts a frame that was sent or received on a CAN channel
+	/// @param[in] frameCount The frame counter to add the frame to
+	/// @param[in] byteCount The byte counter to add the frame's data to
+	/// @param[in] channel The channel the frame was on
+	/// @param[in] frame The frame to count
+	static void count_frame(std::atomic<std::uint64_t> &frameCount, std::atomic<std::uint64_t> &byteCount, CanHardware &channel, const isobus::HardwareInterfaceCANFrame &frame);
+
+	/// @brief Raises a high-water mark if a queue is now longer than it
+	/// @param[in] highWaterMark The high-water mark to update
+	/// @param[in] queueSize The current length of the queue
+	static void update_high_water_mark(std::atomic<std::uint32_t> &highWaterMark, std::size_t queueSize);
+
 	/// @brief The main CAN thread executes this function. Does most of the work of this class
 	static void can_thread_function();
 
@@ -173,11 +258,13 @@ private:
 
 	static std::vector<CanHardware *> hardwareChannels; ///< A list of all CAN channel's metadata
 	static std::vector<RawCanMessageCallbackInfo> rxCallbacks; ///< A list of all registered Rx callbacks
+	static std::vector<RawCanMessageCallbackInfo> txCallbacks; ///< A list of all registered Tx callbacks
 	static std::vector<CanLibUpdateCallbackInfo> canLibUpdateCallbacks; ///< A list of all registered periodic update callbacks
 
 	static std::mutex hardwareChannelsMutex; ///< Mutex to protect `hardwareChannels`
 	static std::mutex threadMutex; ///< A mutex for the main CAN thread
 	static std::mutex rxCallbackMutex; ///< A mutex for protecting the `rxCallbacks`
+	static std::mutex txCallbackMutex; ///< A mutex for protecting the `txCallbacks`
 	static std::mutex canLibNeedsUpdateMutex; ///< A mutex for protecting the `canLibNeedsUpdate` variable
 	static std::mutex canLibUpdateCallbacksMutex; ///< A mutex for protecting the `canLibUpdateCallbacks`
 	static std::condition_variable threadConditionVariable; ///< A condition variable to allow for signaling the CAN thread from `updateCANLibPeriodicThread`
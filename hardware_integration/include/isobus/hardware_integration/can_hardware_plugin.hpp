@@ -11,6 +11,8 @@
 
 #include "isobus/isobus/can_frame.hpp"
 
+#include <cstdint>
+
 //================================================================================================
 /// @class CANHardwarePlugin
 ///
@@ -40,6 +42,14 @@ public:
 	/// @param[in] canFrame The frame to write to the bus
 	/// @returns `true` if the frame was written, otherwise `false`
 	virtual bool write_frame(const isobus::HardwareInterfaceCANFrame &canFrame) = 0;
+
+	/// @brief Returns how many received frames were dropped before they could be read
+	/// @details Drivers that can't tell don't need to override this. The count starts over when the driver is opened.
+	/// @returns The number of frames dropped by the driver, the OS, or the hardware
+	virtual std::uint32_t get_number_dropped_frames() const
+	{
+		return 0;
+	}
 };
 
 #endif // CAN_HARDEWARE_PLUGIN_HPP
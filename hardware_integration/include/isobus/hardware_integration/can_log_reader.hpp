@@ -0,0 +1,128 @@
+//================================================================================================
+/// @file can_log_reader.hpp
+///
+/// @brief Reads CAN frames from recorded bus logs, so that recorded traffic can be fed back
+/// into the stack. Supports logs from Linux candump and Vector ASC logs.
+/// @author Adrian Del Grosso
+///
+/// @copyright 2022 Adrian Del Grosso
+//================================================================================================
+#ifndef CAN_LOG_READER_HPP
+#define CAN_LOG_READER_HPP
+
+#include "isobus/isobus/can_frame.hpp"
+
+#include <cstdint>
+#include <fstream>
+#include <istream>
+#include <string>
+#include <vector>
+
+//================================================================================================
+/// @class CANLogReader
+///
+/// @brief Reads frames one at a time from a candump or Vector ASC log
+/// @details The log is read line by line, so logs much larger than memory can be read.
+/// Lines that aren't classic CAN frames, like headers, comments, error frames and CAN FD frames,
+/// are skipped and counted.
+///
+/// candump logs can be the `-l` log file format, like `(1436509052.249713) can0 18EF1C1D#0102`,
+/// or the printed format with or without timestamps, like `can0  18EF1C1D   [2]  01 02`.
+/// Each interface name is given a channel in the order the names first appear in the log.
+///
+/// ASC channels are numbered from 1, so ASC channel 1 becomes channel 0. Both absolute and
+/// relative timestamps are supported, and identifiers and data can be in hex or decimal.
+//================================================================================================
+class CANLogReader
+{
+public:
+	/// @brief The formats of log that can be read
+	enum class Format
+	{
+		Automatic, ///< Work out the format from the log's contents
+		Candump, ///< A log from Linux `candump`
+		VectorASC ///< A Vector ASCII log, like CANalyzer or CANoe make
+	};
+
+	/// @brief Constructor for a CANLogReader with no log open
+	CANLogReader();
+
+	/// @brief Deleted copy constructor, as the reader owns its file
+	CANLogReader(const CANLogReader &) = delete;
+
+	/// @brief Deleted assignment operator, as the reader owns its file
+	CANLogReader &operator=(const CANLogReader &) = delete;
+
+	/// @brief Opens a log file
+	/// @param[in] fileName The path of the log to read
+	/// @param[in] logFormat The format of the log, or `Automatic` to work it out
+	/// @returns `true` if the file was opened, otherwise `false`
+	bool open(const std::string &fileName, Format logFormat = Format::Automatic);
+
+	/// @brief Reads a log from a stream that the caller keeps alive, like a string stream
+	/// @param[in] logStream The stream to read the log from
+	/// @param[in] logFormat The format of the log, or `Automatic` to work it out
+	void open(std::istream &logStream, Format logFormat = Format::Automatic);
+
+	/// @brief Stops reading the log, and closes the file if there is one
+	void close();
+
+	/// @brief Reads the next frame from the log
+	/// @param[out] canFrame The frame that was read. Its timestamp is the time in the log in microseconds.
+	/// @returns `true` if a frame was read, `false` at the end of the log
+	bool read_frame(isobus::HardwareInterfaceCANFrame &canFrame);
+
+	/// @brief Returns the format of the log
+	/// @returns The format of the log, which is `Automatic` until the format has been worked out
+	Format get_format() const;
+
+	/// @brief Returns the number of lines that weren't frames
+	/// @returns The number of lines skipped since the log was opened
+	std::uint32_t get_number_skipped_lines() const;
+
+	/// @brief Returns the candump interface names in channel order
+	/// @returns The interface names, where the index is the channel. Empty for ASC logs.
+	const std::vector<std::string> &get_channel_names() const;
+
+private:
+	/// @brief Parses a line from a candump log
+	/// @param[in] line The line to parse
+	/// @param[out] canFrame The frame on the line
+	/// @returns `true` if the line was a classic CAN frame, otherwise `false`
+	bool parse_candump_line(const std::string &line, isobus::HardwareInterfaceCANFrame &canFrame);
+
+	/// @brief Parses a line from an ASC log, including header lines that change how frames are read
+	/// @param[in] line The line to parse
+	/// @param[out] canFrame The frame on the line
+	/// @returns `true` if the line was a classic CAN frame, otherwise `false`
+	bool parse_asc_line(const std::string &line, isobus::HardwareInterfaceCANFrame &canFrame);
+
+	/// @brief Works out the format of a log from one of its lines
+	/// @param[in] line A line from the log that isn't empty
+	/// @returns The format the line looks like, or `Automatic` if it can't tell
+	static Format detect_format(const std::string &line);
+
+	/// @brief Parses an unsigned number
+	/// @param[in] text The text of the number
+	/// @param[in] base The base of the number, 10 or 16
+	/// @param[out] value The value of the number
+	/// @returns `true` if all of the text was a number that fit in 32 bits, otherwise `false`
+	static bool parse_number(const std::string &text, std::uint8_t base, std::uint32_t &value);
+
+	/// @brief Parses a time in seconds with a fractional part, like `1436509052.249713`
+	/// @param[in] text The text of the time
+	/// @param[out] timestamp_us The time in microseconds
+	/// @returns `true` if the text was a time, otherwise `false`
+	static bool parse_seconds(const std::string &text, std::uint64_t &timestamp_us);
+
+	std::ifstream logFile; ///< The log file, when a file was opened
+	std::istream *input; ///< The stream frames are read from
+	std::vector<std::string> channelNames; ///< The candump interface names, in channel order
+	std::uint64_t lastTimestamp_us; ///< The timestamp of the last frame, for logs with relative timestamps
+	std::uint32_t numberSkippedLines; ///< The number of lines that weren't frames
+	Format format; ///< The format of the log
+	bool ascHexadecimal; ///< Stores if the ASC log's identifiers and data are in hex, which is the default
+	bool ascRelativeTimestamps; ///< Stores if the ASC log's timestamps are relative to the frame before
+};
+
+#endif // CAN_LOG_READER_HPP
@@ -0,0 +1,64 @@
+//================================================================================================
+/// @file can_log_replay.hpp
+///
+/// @brief Feeds the frames from a recorded bus log through the CAN network manager, either at
+/// the pace they were recorded or as fast as possible, and measures how long each stage of
+/// processing takes. Useful for profiling the stack with realistic traffic.
+/// @author Adrian Del Grosso
+///
+/// @copyright 2022 Adrian Del Grosso
+//================================================================================================
+#ifndef CAN_LOG_REPLAY_HPP
+#define CAN_LOG_REPLAY_HPP
+
+#include "isobus/hardware_integration/can_log_reader.hpp"
+
+#include <cstdint>
+
+//================================================================================================
+/// @class CANLogReplay
+///
+/// @brief Replays a log into `CANNetworkManager::CANNetwork`
+/// @details Each frame is passed to `can_lib_process_rx_message` as if the hardware layer had
+/// just received it, and then the network manager is updated so that the protocols and callbacks
+/// process it. Nothing else should be updating the network manager during a replay.
+/// Frames on channels the stack doesn't support are skipped.
+//================================================================================================
+class CANLogReplay
+{
+public:
+	/// @brief How fast to replay the frames
+	enum class Timing
+	{
+		Recorded, ///< Inject each frame at the time it was recorded, relative to the first frame
+		AsFastAsPossible ///< Inject the next frame as soon as the last one was processed
+	};
+
+	/// @brief What happened during a replay, and how long each stage took
+	class Statistics
+	{
+	public:
+		/// @brief Constructor for empty statistics
+		Statistics();
+
+		std::uint64_t numberOfFrames; ///< The number of frames given to the stack
+		std::uint64_t numberSkippedFrames; ///< The number of frames on channels the stack doesn't support
+		std::uint64_t readTime_us; ///< Time spent reading and parsing the log
+		std::uint64_t receiveTime_us; ///< Time spent in `can_lib_process_rx_message`
+		std::uint64_t updateTime_us; ///< Time spent in the network manager update after each frame
+		std::uint64_t elapsedTime_us; ///< The wall clock time the whole replay took
+		std::uint64_t logDuration_us; ///< The time between the first and last frame in the log
+	};
+
+	/// @brief Replays the rest of a log into the network manager
+	/// @param[in] reader The reader of the log, which should already be open
+	/// @param[in] timing How fast to replay the frames
+	/// @param[out] statistics What happened during the replay
+	/// @returns `true` if at least one frame was replayed, otherwise `false`
+	static bool replay(CANLogReader &reader, Timing timing, Statistics &statistics);
+
+private:
+	static constexpr std::uint64_t MAXIMUM_WAIT_US = 1000; ///< The longest to sleep at once while waiting for a frame's time, so the stack keeps getting updated
+};
+
+#endif // CAN_LOG_REPLAY_HPP
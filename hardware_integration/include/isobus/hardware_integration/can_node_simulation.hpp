@@ -0,0 +1,188 @@
+//================================================================================================
+/// @file can_node_simulation.hpp
+///
+/// @brief Generates the traffic of many scripted ECUs on a virtual CAN bus from one thread,
+/// so the stack can be tested against a busy network without any hardware.
+/// @author Adrian Del Grosso
+///
+/// @copyright 2022 Adrian Del Grosso
+//================================================================================================
+#ifndef CAN_NODE_SIMULATION_HPP
+#define CAN_NODE_SIMULATION_HPP
+
+#include "isobus/hardware_integration/virtual_can_plugin.hpp"
+#include "isobus/isobus/can_frame.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+//================================================================================================
+/// @class CANNodeSimulation
+///
+/// @brief A traffic generator that plays a set of scripted ECUs on a `VirtualCANPlugin` bus
+/// @details The nodes are not instances of the stack. Each one only sends its address claim,
+/// answers requests, and sends a fixed list of periodic messages, which is enough to put the
+/// stack under the load of a large implement network. All nodes are driven by one thread, so
+/// dozens of them are cheap, and each has its own `VirtualCANPlugin` so the stack sees their
+/// frames as coming from separate ECUs.
+///
+/// The address claim is a minimal model that generates claim traffic, not a full ISO 11783-5
+/// implementation. A node only ever claims its preferred address. If an ECU with a lower NAME
+/// claims it, the node sends a cannot claim and stops sending its periodic messages.
+//================================================================================================
+class CANNodeSimulation
+{
+public:
+	/// @brief The address claim state of a simulated node
+	enum class AddressState : std::uint8_t
+	{
+		NotStarted = 0, ///< The simulation hasn't been started
+		WaitingForClaim = 1, ///< The node has sent its claim and is waiting to see if another node contends it
+		Claimed = 2, ///< The node owns its address
+		CannotClaim = 3 ///< The node lost its address to a node with a lower NAME
+	};
+
+	/// @brief Constructor for a simulation with no nodes
+	/// @param[in] busName The name of the virtual bus the nodes are on, like "vcan0"
+	explicit CANNodeSimulation(const std::string &busName);
+
+	/// @brief Destructor, which stops the simulation
+	~CANNodeSimulation();
+
+	/// @brief Deleted copy constructor, as the simulation owns its thread and nodes
+	CANNodeSimulation(const CANNodeSimulation &) = delete;
+
+	/// @brief Deleted assignment operator, as the simulation owns its thread and nodes
+	CANNodeSimulation &operator=(const CANNodeSimulation &) = delete;
+
+	/// @brief Adds a node to the simulation. Nodes can only be added while it's stopped.
+	/// @param[in] NAME The 64 bit NAME the node claims its address with
+	/// @param[in] preferredAddress The address the node claims
+	/// @returns `true` if the node was added, `false` if the simulation is running or the address isn't valid
+	bool add_node(std::uint64_t NAME, std::uint8_t preferredAddress);
+
+	/// @brief Adds a message that a node broadcasts once its address is claimed. Only allowed while the simulation is stopped.
+	/// @param[in] nodeIndex The node, in the order nodes were added
+	/// @param[in] parameterGroupNumber The PGN of the message
+	/// @param[in] priority The priority of the message, from 0 (highest) to 7
+	/// @param[in] data The data of the message, up to 8 bytes
+	/// @param[in] interval_ms How often the message is sent
+	/// @returns `true` if the message was added, otherwise `false`
+	bool add_periodic_message(std::size_t nodeIndex, std::uint32_t parameterGroupNumber, std::uint8_t priority, const std::vector<std::uint8_t> &data, std::uint32_t interval_ms);
+
+	/// @brief Connects every node to the bus, sends their address claims, and starts the simulation thread
+	/// @returns `true` if the simulation started, `false` if it was already running
+	bool start();
+
+	/// @brief Stops the simulation thread and disconnects every node from the bus
+	void stop();
+
+	/// @brief Returns if the simulation is running
+	/// @returns `true` if the simulation has been started and not stopped, otherwise `false`
+	bool get_is_running() const;
+
+	/// @brief Returns the number of nodes in the simulation
+	/// @returns The number of nodes that have been added
+	std::size_t get_number_nodes() const;
+
+	/// @brief Returns the address claim state of a node
+	/// @param[in] nodeIndex The node, in the order nodes were added
+	/// @returns The state of the node, or `NotStarted` if there is no node with that index
+	AddressState get_address_state(std::size_t nodeIndex) const;
+
+	/// @brief Returns the address a node is using
+	/// @param[in] nodeIndex The node, in the order nodes were added
+	/// @returns The address the node has claimed or is claiming, or the NULL address if it has none
+	std::uint8_t get_address(std::size_t nodeIndex) const;
+
+	/// @brief Returns the number of frames the nodes have sent since the simulation was started
+	/// @returns The number of frames sent by all nodes
+	std::uint64_t get_number_transmitted_frames() const;
+
+	/// @brief Returns the number of frames the nodes have received since the simulation was started
+	/// @returns The number of frames received by all nodes, which counts a frame once for each node that got it
+	std::uint64_t get_number_received_frames() const;
+
+	static constexpr std::uint32_t ADDRESS_CLAIM_WAIT_MS = 250; ///< How long a node waits for its claim to be contended before using its address
+	static constexpr std::uint32_t IDLE_SLEEP_MS = 1; ///< How long the simulation thread sleeps when no node had anything to do
+
+private:
+	/// @brief A message a node sends periodically
+	struct PeriodicMessage
+	{
+		std::uint32_t parameterGroupNumber; ///< The PGN of the message
+		std::uint32_t interval_ms; ///< How often the message is sent
+		std::uint32_t lastSentTimestamp_ms; ///< When the message was last sent
+		std::uint8_t data[8]; ///< The data of the message
+		std::uint8_t dataLength; ///< The number of bytes in `data`
+		std::uint8_t priority; ///< The priority of the message
+	};
+
+	/// @brief One simulated ECU
+	struct Node
+	{
+		/// @brief Constructor for a node that hasn't been started
+		/// @param[in] busName The name of the bus the node is on
+		/// @param[in] nodeNAME The NAME the node claims its address with
+		/// @param[in] preferredAddress The address the node claims
+		Node(const std::string &busName, std::uint64_t nodeNAME, std::uint8_t preferredAddress);
+
+		VirtualCANPlugin plugin; ///< The node's connection to the bus
+		std::vector<PeriodicMessage> periodicMessages; ///< The messages the node sends once it has an address
+		const std::uint64_t NAME; ///< The NAME the node claims its address with
+		const std::uint8_t claimedAddress; ///< The address the node claims
+		std::uint32_t claimTimestamp_ms; ///< When the node last sent its claim
+		std::atomic<AddressState> state; ///< The address claim state of the node
+	};
+
+	/// @brief The simulation thread executes this function
+	void simulation_thread_function();
+
+	/// @brief Reacts to a frame a node received
+	/// @param[in] node The node that received the frame
+	/// @param[in] frame The frame
+	void process_frame(Node &node, const isobus::HardwareInterfaceCANFrame &frame);
+
+	/// @brief Finishes a node's address claim and sends its periodic messages when they're due
+	/// @param[in] node The node to update
+	/// @returns `true` if the node sent anything, otherwise `false`
+	bool update_node(Node &node);
+
+	/// @brief Sends a node's address claim, or its cannot claim if it lost its address
+	/// @param[in] node The node
+	void send_address_claim(Node &node);
+
+	/// @brief Sends a message from a node
+	/// @param[in] node The node sending the message
+	/// @param[in] message The message to send
+	/// @param[in] destinationAddress The address to send a destination specific PGN to
+	void send_message(Node &node, const PeriodicMessage &message, std::uint8_t destinationAddress);
+
+	/// @brief Sends a frame from a node
+	/// @param[in] node The node sending the frame
+	/// @param[in] identifier The extended identifier of the frame
+	/// @param[in] data The data of the frame
+	/// @param[in] dataLength The number of bytes in `data`
+	void send_frame(Node &node, std::uint32_t identifier, const std::uint8_t *data, std::uint8_t dataLength);
+
+	/// @brief Builds the identifier of a frame
+	/// @param[in] priority The priority of the frame, from 0 (highest) to 7
+	/// @param[in] parameterGroupNumber The PGN of the frame
+	/// @param[in] destinationAddress The destination, which is only used for destination specific PGNs
+	/// @param[in] sourceAddress The source address of the frame
+	/// @returns The 29 bit identifier
+	static std::uint32_t build_identifier(std::uint8_t priority, std::uint32_t parameterGroupNumber, std::uint8_t destinationAddress, std::uint8_t sourceAddress);
+
+	const std::string bus; ///< The name of the virtual bus
+	std::vector<std::unique_ptr<Node>> nodes; ///< The simulated nodes
+	std::thread *simulationThread; ///< The thread that runs the nodes
+	std::atomic<std::uint64_t> transmittedFrames; ///< The number of frames sent by all nodes
+	std::atomic<std::uint64_t> receivedFrames; ///< The number of frames received by all nodes
+	std::atomic_bool running; ///< Stores if the simulation thread should keep running
+};
+
+#endif // CAN_NODE_SIMULATION_HPP
@@ -10,6 +10,8 @@
 #ifndef SOCKET_CAN_INTERFACE_HPP
 #define SOCKET_CAN_INTERFACE_HPP
 
+#include <atomic>
+#include <cstdint>
 #include <string>
 
 #include "isobus/hardware_integration/can_hardware_plugin.hpp"
@@ -55,9 +57,14 @@ public:
 	/// @returns `true` if the frame was written, otherwise `false`
 	bool write_frame(const isobus::HardwareInterfaceCANFrame &canFrame) override;
 
+	/// @brief Returns how many frames the kernel dropped because the socket's receive queue was full
+	/// @returns The number of frames dropped since the socket was opened
+	std::uint32_t get_number_dropped_frames() const override;
+
 private:
 	struct sockaddr_can *pCANDevice; ///< The structure for CAN sockets
 	const std::string name; ///< The device name
+	std::atomic<std::uint32_t> droppedFrames; ///< The kernel's dropped frame count, from the last frame read
 	int fileDescriptor; ///< File descriptor for the socket
 };
 
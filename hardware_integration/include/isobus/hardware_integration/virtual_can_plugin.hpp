@@ -0,0 +1,128 @@
+//================================================================================================
+/// @file virtual_can_plugin.hpp
+///
+/// @brief A CAN driver for a bus that only exists in memory, so that several channels or nodes
+/// in one process can talk to each other without any CAN hardware or kernel modules.
+/// @author Adrian Del Grosso
+///
+/// @copyright 2022 Adrian Del Grosso
+//================================================================================================
+#ifndef VIRTUAL_CAN_PLUGIN_HPP
+#define VIRTUAL_CAN_PLUGIN_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+
+#include "isobus/hardware_integration/can_hardware_plugin.hpp"
+#include "isobus/isobus/can_frame.hpp"
+
+//================================================================================================
+/// @class VirtualCANPlugin
+///
+/// @brief A CAN Driver for a virtual bus inside the process
+/// @details Every plugin that is opened with the same bus name is a node on the same bus, and
+/// receives the frames written by all of the other nodes, like a `vcan` device would.
+/// Assign one to each CANHardwareInterface channel you want connected, or read and write frames
+/// on a plugin directly to act as some other node on the bus.
+///
+/// By default frames are delivered as soon as they're written. A bit rate can be set for a bus
+/// to emulate how long each frame takes to send. Each node then sends its frames in the order
+/// they were written, and when several nodes have a frame waiting for the bus, the one with the
+/// lowest identifier wins arbitration and goes first. A fixed latency and random frame loss can
+/// also be added. Frame loss is drawn from a seeded generator, so a test sees the same losses on
+/// every run with the same sequence of frames.
+//================================================================================================
+class VirtualCANPlugin : public CANHardwarePlugin
+{
+public:
+	/// @brief Constructor for the virtual CAN driver
+	/// @param[in] busName The name of the bus to join, like "vcan0"
+	explicit VirtualCANPlugin(const std::string busName);
+
+	/// @brief The destructor for VirtualCANPlugin
+	~VirtualCANPlugin();
+
+	/// @brief Deleted copy constructor, as a node can only be on the bus once
+	VirtualCANPlugin(const VirtualCANPlugin &) = delete;
+
+	/// @brief Deleted assignment operator, as a node can only be on the bus once
+	VirtualCANPlugin &operator=(const VirtualCANPlugin &) = delete;
+
+	/// @brief Returns if the node is connected to its bus
+	/// @returns `true` if connected, `false` if not connected
+	bool get_is_valid() const override;
+
+	/// @brief Returns the name of the bus the driver is using
+	/// @returns The name of the bus, such as "vcan0"
+	std::string get_bus_name() const;
+
+	/// @brief Disconnects from the bus, and discards any frames that weren't sent or read yet
+	void close() override;
+
+	/// @brief Connects to the bus
+	void open() override;
+
+	/// @brief Returns a frame from the bus, waiting up to 100ms for one, or `false` if no frame can be read.
+	/// @param[in, out] canFrame The CAN frame that was read
+	/// @returns `true` if a CAN frame was read, otherwise `false`
+	bool read_frame(isobus::HardwareInterfaceCANFrame &canFrame) override;
+
+	/// @brief Returns a frame from the bus if one can be read right now, without waiting
+	/// @details Useful for driving many nodes from one thread, where a blocking read on one node would stall the rest.
+	/// @param[in, out] canFrame The CAN frame that was read
+	/// @returns `true` if a CAN frame was read, otherwise `false`
+	bool poll_frame(isobus::HardwareInterfaceCANFrame &canFrame);
+
+	/// @brief Writes a frame to the bus. The frame is queued if the bus is emulating a bit rate.
+	/// @param[in] canFrame The frame to write to the bus
+	/// @returns `true` if the frame was written, otherwise `false`
+	bool write_frame(const isobus::HardwareInterfaceCANFrame &canFrame) override;
+
+	/// @brief Returns how many frames this node missed because of the bus's frame loss
+	/// @returns The number of frames lost since the node was opened
+	std::uint32_t get_number_dropped_frames() const override;
+
+	/// @brief Sets the bit rate a bus emulates
+	/// @param[in] busName The name of the bus to configure
+	/// @param[in] bitRate The bit rate in bits per second, like 250000, or 0 to deliver frames right away
+	static void set_bus_bit_rate(const std::string &busName, std::uint32_t bitRate);
+
+	/// @brief Sets a delay between a frame finishing on a bus and it being available to read
+	/// @param[in] busName The name of the bus to configure
+	/// @param[in] latency_us The delay in microseconds
+	static void set_bus_latency(const std::string &busName, std::uint32_t latency_us);
+
+	/// @brief Sets the chance that each node misses a frame sent on a bus
+	/// @param[in] busName The name of the bus to configure
+	/// @param[in] lossProbability The chance of losing each frame, from 0 (none) to 1 (all)
+	/// @param[in] seed The seed for the random losses, so that runs can be repeated
+	static void set_bus_frame_loss(const std::string &busName, float lossProbability, std::uint32_t seed);
+
+private:
+	class Bus;
+
+	/// @brief Returns the bus with the given name, creating it the first time it's used
+	/// @param[in] busName The name of the bus
+	/// @returns The bus with that name
+	static std::shared_ptr<Bus> get_bus(const std::string &busName);
+
+	/// @brief Returns a frame from the bus, waiting up to a timeout for one
+	/// @param[in, out] canFrame The CAN frame that was read
+	/// @param[in] timeout_us How long to wait for a frame in microseconds, or 0 to not wait
+	/// @returns `true` if a CAN frame was read, otherwise `false`
+	bool wait_for_frame(isobus::HardwareInterfaceCANFrame &canFrame, std::uint32_t timeout_us);
+
+	static constexpr std::uint32_t READ_TIMEOUT_MS = 100; ///< How long read_frame waits for a frame, which matches socket CAN
+
+	const std::string name; ///< The name of the bus
+	const std::shared_ptr<Bus> bus; ///< The bus this node is on
+	std::deque<isobus::HardwareInterfaceCANFrame> transmitFrames; ///< Frames waiting to be sent, stamped with when they were written
+	std::deque<isobus::HardwareInterfaceCANFrame> receivedFrames; ///< Frames sent by other nodes, stamped with when they can be read
+	std::atomic<std::uint32_t> droppedFrames; ///< Frames sent by other nodes that this node lost
+	bool connected; ///< Tells if the node is on the bus
+};
+
+#endif // VIRTUAL_CAN_PLUGIN_HPP
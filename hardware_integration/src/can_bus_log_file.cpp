@@ -0,0 +1,239 @@
+//================================================================================================
+/// @file can_bus_log_file.cpp
+///
+/// @brief Reads the binary bus logs written by `CANBusLogger`, using their index to jump to a
+/// time or to only the blocks that have a PGN, for offline analysis.
+/// @author Adrian Del Grosso
+///
+/// @copyright 2022 Adrian Del Grosso
+//================================================================================================
+#include "isobus/hardware_integration/can_bus_log_file.hpp"
+
+CANBusLogFile::CANBusLogFile() :
+  nextBlock(0),
+  nextFrame(0),
+  minimumTimestamp_us(0),
+  filterParameterGroupNumber(0),
+  sequenceNumber(0),
+  filterEnabled(false),
+  wasClosed(false)
+{
+}
+
+bool CANBusLogFile::open(const std::string &fileName)
+{
+	std::uint8_t header[CANBusLogFormat::FILE_HEADER_SIZE];
+	bool retVal = false;
+
+	close();
+	logFile.open(fileName, std::ios::in | std::ios::binary);
+
+	if ((logFile.is_open()) &&
+	    (logFile.read(reinterpret_cast<char *>(header), sizeof(header))) &&
+	    (CANBusLogFormat::parse_file_header(header, sequenceNumber)))
+	{
+		std::uint8_t footer[CANBusLogFormat::FILE_FOOTER_SIZE];
+		std::uint64_t fileSize_bytes;
+		std::uint64_t indexOffset = 0;
+		std::uint32_t numberOfBlocks = 0;
+
+		logFile.seekg(0, std::ios::end);
+		fileSize_bytes = static_cast<std::uint64_t>(logFile.tellg());
+
+		if (fileSize_bytes >= (CANBusLogFormat::FILE_HEADER_SIZE + CANBusLogFormat::FILE_FOOTER_SIZE))
+		{
+			logFile.seekg(static_cast<std::streamoff>(fileSize_bytes - CANBusLogFormat::FILE_FOOTER_SIZE));
+			wasClosed = ((logFile.read(reinterpret_cast<char *>(footer), sizeof(footer))) &&
+			             (CANBusLogFormat::parse_file_footer(footer, indexOffset, numberOfBlocks)) &&
+			             (indexOffset + (static_cast<std::uint64_t>(numberOfBlocks) * CANBusLogFormat::INDEX_ENTRY_SIZE) + CANBusLogFormat::FILE_FOOTER_SIZE == fileSize_bytes));
+		}
+
+		if (wasClosed)
+		{
+			readBuffer.resize(static_cast<std::size_t>(numberOfBlocks) * CANBusLogFormat::INDEX_ENTRY_SIZE);
+			logFile.seekg(static_cast<std::streamoff>(indexOffset));
+			wasClosed = static_cast<bool>(logFile.read(reinterpret_cast<char *>(readBuffer.data()), static_cast<std::streamsize>(readBuffer.size())));
+
+			for (std::uint32_t i = 0; (i < numberOfBlocks) && (wasClosed); i++)
+			{
+				CANBusLogFormat::BlockInfo info;
+
+				CANBusLogFormat::parse_index_entry(&readBuffer[i * CANBusLogFormat::INDEX_ENTRY_SIZE], info);
+				blocks.push_back(info);
+			}
+		}
+
+		if (!wasClosed)
+		{
+			logFile.clear();
+			blocks.clear();
+			scan_blocks(fileSize_bytes);
+		}
+		logFile.clear();
+		retVal = true;
+	}
+
+	if (!retVal)
+	{
+		close();
+	}
+	return retVal;
+}
+
+void CANBusLogFile::close()
+{
+	if (logFile.is_open())
+	{
+		logFile.close();
+	}
+	logFile.clear();
+	blocks.clear();
+	blockFrames.clear();
+	sequenceNumber = 0;
+	wasClosed = false;
+	rewind();
+}
+
+bool CANBusLogFile::read_frame(isobus::HardwareInterfaceCANFrame &canFrame, bool &transmitted)
+{
+	bool retVal = false;
+	bool endOfFile = false;
+
+	while ((!retVal) && (!endOfFile))
+	{
+		if (nextFrame < blockFrames.size())
+		{
+			const CANBusLogFormat::LoggedFrame &loggedFrame = blockFrames[nextFrame];
+
+			nextFrame++;
+			if ((loggedFrame.frame.timestamp_us >= minimumTimestamp_us) &&
+			    ((!filterEnabled) ||
+			     ((loggedFrame.frame.isExtendedFrame) &&
+			      (filterParameterGroupNumber == CANBusLogFormat::get_parameter_group_number(loggedFrame.frame.identifier)))))
+			{
+				canFrame = loggedFrame.frame;
+				transmitted = loggedFrame.transmitted;
+				retVal = true;
+			}
+		}
+		else
+		{
+			// Skip the blocks the index says can't have a matching frame
+			while ((nextBlock < blocks.size()) &&
+			       ((blocks[nextBlock].maximumTimestamp_us < minimumTimestamp_us) ||
+			        ((filterEnabled) && (!blocks[nextBlock].get_may_contain_parameter_group_number(filterParameterGroupNumber)))))
+			{
+				nextBlock++;
+			}
+
+			endOfFile = ((nextBlock >= blocks.size()) ||
+			             (!load_block(nextBlock)));
+			nextBlock++;
+		}
+	}
+	return retVal;
+}
+
+bool CANBusLogFile::seek_to_time(std::uint64_t timestamp_us)
+{
+	bool retVal = false;
+
+	rewind();
+	minimumTimestamp_us = timestamp_us;
+
+	for (const CANBusLogFormat::BlockInfo &info : blocks)
+	{
+		if (info.maximumTimestamp_us >= timestamp_us)
+		{
+			retVal = true;
+			break;
+		}
+	}
+	return retVal;
+}
+
+void CANBusLogFile::rewind()
+{
+	blockFrames.clear();
+	nextBlock = 0;
+	nextFrame = 0;
+	minimumTimestamp_us = 0;
+}
+
+void CANBusLogFile::set_parameter_group_number_filter(std::uint32_t parameterGroupNumber)
+{
+	filterParameterGroupNumber = parameterGroupNumber;
+	filterEnabled = true;
+}
+
+void CANBusLogFile::clear_parameter_group_number_filter()
+{
+	filterEnabled = false;
+}
+
+const std::vector<CANBusLogFormat::BlockInfo> &CANBusLogFile::get_blocks() const
+{
+	return blocks;
+}
+
+std::uint32_t CANBusLogFile::get_sequence_number() const
+{
+	return sequenceNumber;
+}
+
+bool CANBusLogFile::get_was_closed() const
+{
+	return wasClosed;
+}
+
+void CANBusLogFile::scan_blocks(std::uint64_t fileSize_bytes)
+{
+	std::uint8_t header[CANBusLogFormat::BLOCK_HEADER_SIZE];
+	std::uint64_t position = CANBusLogFormat::FILE_HEADER_SIZE;
+	bool keepScanning = true;
+
+	while ((keepScanning) &&
+	       (position + CANBusLogFormat::BLOCK_HEADER_SIZE <= fileSize_bytes))
+	{
+		CANBusLogFormat::BlockInfo info;
+
+		logFile.seekg(static_cast<std::streamoff>(position));
+		keepScanning = static_cast<bool>(logFile.read(reinterpret_cast<char *>(header), sizeof(header)));
+
+		if (keepScanning)
+		{
+			CANBusLogFormat::parse_block_header(header, info);
+			info.fileOffset = position;
+
+			// A block that was only partly written before the file stopped being written is ignored
+			keepScanning = ((0 != info.numberOfFrames) &&
+			                (position + CANBusLogFormat::BLOCK_HEADER_SIZE + info.payloadSize <= fileSize_bytes));
+
+			if (keepScanning)
+			{
+				blocks.push_back(info);
+				position += CANBusLogFormat::BLOCK_HEADER_SIZE + info.payloadSize;
+			}
+		}
+	}
+}
+
+bool CANBusLogFile::load_block(std::size_t blockIndex)
+{
+	const CANBusLogFormat::BlockInfo &info = blocks[blockIndex];
+	bool retVal;
+
+	blockFrames.clear();
+	nextFrame = 0;
+	readBuffer.resize(info.payloadSize);
+	logFile.clear();
+	logFile.seekg(static_cast<std::streamoff>(info.fileOffset + CANBusLogFormat::BLOCK_HEADER_SIZE));
+	retVal = ((logFile.read(reinterpret_cast<char *>(readBuffer.data()), static_cast<std::streamsize>(readBuffer.size()))) &&
+	          (CANBusLogFormat::decode_block(info, readBuffer, blockFrames)));
+
+	if (!retVal)
+	{
+		blockFrames.clear();
+	}
+	return retVal;
+}
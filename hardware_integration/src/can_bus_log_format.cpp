@@ -0,0 +1,427 @@
+//================================================================================================
+/// @file can_bus_log_format.cpp
+///
+/// @brief Defines the compact binary bus log format written by `CANBusLogger` and read by
+/// `CANBusLogFile`, and encodes and decodes its blocks of frames.
+/// @author Adrian Del Grosso
+///
+/// @copyright 2022 Adrian Del Grosso
+//================================================================================================
+#include "isobus/hardware_integration/can_bus_log_format.hpp"
+
+#include "isobus/isobus/can_identifier.hpp"
+
+#include <cstring>
+#include <limits>
+
+namespace
+{
+	const std::uint8_t FILE_MAGIC[8] = { 'I', 'S', 'O', 'B', 'U', 'S', 'L', 'G' }; ///< The first 8 bytes of a log file
+
+	/// @brief Adds a little endian number to a buffer
+	/// @param[in] value The number to add
+	/// @param[in] numberOfBytes How many bytes of the number to add
+	/// @param[out] buffer The buffer to add to
+	void append_little_endian(std::uint64_t value, std::uint8_t numberOfBytes, std::vector<std::uint8_t> &buffer)
+	{
+		for (std::uint8_t i = 0; i < numberOfBytes; i++)
+		{
+			buffer.push_back(static_cast<std::uint8_t>(value >> (8 * i)));
+		}
+	}
+
+	/// @brief Reads a little endian number from a buffer
+	/// @param[in] buffer Where the number starts
+	/// @param[in] numberOfBytes How many bytes the number is
+	/// @returns The number
+	std::uint64_t read_little_endian(const std::uint8_t *buffer, std::uint8_t numberOfBytes)
+	{
+		std::uint64_t retVal = 0;
+
+		for (std::uint8_t i = 0; i < numberOfBytes; i++)
+		{
+			retVal |= (static_cast<std::uint64_t>(buffer[i]) << (8 * i));
+		}
+		return retVal;
+	}
+
+	/// @brief Adds a varint, which is 7 bits per byte with the top bit set on all but the last byte
+	/// @param[in] value The number to add
+	/// @param[out] buffer The buffer to add to
+	void append_varint(std::uint64_t value, std::vector<std::uint8_t> &buffer)
+	{
+		while (value >= 0x80)
+		{
+			buffer.push_back(static_cast<std::uint8_t>(value | 0x80));
+			value >>= 7;
+		}
+		buffer.push_back(static_cast<std::uint8_t>(value));
+	}
+
+	/// @brief Reads a varint
+	/// @param[in] buffer The buffer to read from
+	/// @param[in,out] position Where the varint starts, which is moved to after it
+	/// @param[out] value The number
+	/// @returns `true` if a whole varint was read, otherwise `false`
+	bool read_varint(const std::vector<std::uint8_t> &buffer, std::size_t &position, std::uint64_t &value)
+	{
+		bool retVal = false;
+		std::uint8_t shift = 0;
+
+		value = 0;
+		while ((position < buffer.size()) && (shift < 64) && (!retVal))
+		{
+			value |= (static_cast<std::uint64_t>(buffer[position] & 0x7F) << shift);
+			retVal = (0 == (buffer[position] & 0x80));
+			shift += 7;
+			position++;
+		}
+		return retVal;
+	}
+} // namespace
+
+constexpr std::uint16_t CANBusLogFormat::FILE_VERSION;
+constexpr std::uint32_t CANBusLogFormat::FILE_HEADER_SIZE;
+constexpr std::uint32_t CANBusLogFormat::BLOCK_HEADER_SIZE;
+constexpr std::uint32_t CANBusLogFormat::INDEX_ENTRY_SIZE;
+constexpr std::uint32_t CANBusLogFormat::FILE_FOOTER_SIZE;
+constexpr std::uint32_t CANBusLogFormat::MAXIMUM_FRAMES_PER_BLOCK;
+constexpr std::uint32_t CANBusLogFormat::MAXIMUM_IDENTIFIERS_PER_BLOCK;
+constexpr std::uint32_t CANBusLogFormat::INDEX_MAGIC;
+
+CANBusLogFormat::LoggedFrame::LoggedFrame() :
+  frame(),
+  transmitted(false)
+{
+}
+
+CANBusLogFormat::BlockInfo::BlockInfo() :
+  fileOffset(0),
+  payloadSize(0),
+  numberOfFrames(0),
+  baseTimestamp_us(0),
+  minimumTimestamp_us(std::numeric_limits<std::uint64_t>::max()),
+  maximumTimestamp_us(0)
+{
+	memset(parameterGroupNumberBitmap, 0, sizeof(parameterGroupNumberBitmap));
+}
+
+void CANBusLogFormat::BlockInfo::add_frame(const isobus::HardwareInterfaceCANFrame &canFrame)
+{
+	if (0 == numberOfFrames)
+	{
+		baseTimestamp_us = canFrame.timestamp_us;
+	}
+	if (canFrame.timestamp_us < minimumTimestamp_us)
+	{
+		minimumTimestamp_us = canFrame.timestamp_us;
+	}
+	if (canFrame.timestamp_us > maximumTimestamp_us)
+	{
+		maximumTimestamp_us = canFrame.timestamp_us;
+	}
+	if (canFrame.isExtendedFrame)
+	{
+		const std::uint8_t bit = get_parameter_group_number_bit(get_parameter_group_number(canFrame.identifier));
+
+		parameterGroupNumberBitmap[bit / 8] |= static_cast<std::uint8_t>(1 << (bit % 8));
+	}
+	numberOfFrames++;
+}
+
+bool CANBusLogFormat::BlockInfo::get_may_contain_parameter_group_number(std::uint32_t parameterGroupNumber) const
+{
+	const std::uint8_t bit = get_parameter_group_number_bit(parameterGroupNumber);
+
+	return (0 != (parameterGroupNumberBitmap[bit / 8] & (1 << (bit % 8))));
+}
+
+CANBusLogFormat::BlockEncoder::BlockEncoder() :
+  lastTimestamp_us(0)
+{
+}
+
+bool CANBusLogFormat::BlockEncoder::add_frame(const LoggedFrame &loggedFrame)
+{
+	const isobus::HardwareInterfaceCANFrame &canFrame = loggedFrame.frame;
+	const std::uint32_t key = canFrame.isExtendedFrame ? (canFrame.identifier | EXTENDED_IDENTIFIER_FLAG) : canFrame.identifier;
+	const std::uint8_t dataLength = (canFrame.dataLength > 8) ? 8 : canFrame.dataLength;
+	std::size_t dictionaryIndex = 0;
+	bool retVal = true;
+
+	while ((dictionaryIndex < dictionary.size()) &&
+	       ((dictionary[dictionaryIndex].key != key) || (dictionary[dictionaryIndex].channel != canFrame.channel)))
+	{
+		dictionaryIndex++;
+	}
+
+	if ((info.numberOfFrames >= MAXIMUM_FRAMES_PER_BLOCK) ||
+	    ((dictionaryIndex == dictionary.size()) && (dictionary.size() >= MAXIMUM_IDENTIFIERS_PER_BLOCK)))
+	{
+		retVal = false;
+	}
+	else
+	{
+		// Zig-zag the time difference, as frames from different channels can be slightly out of order
+		const std::int64_t timeDifference = static_cast<std::int64_t>(canFrame.timestamp_us - ((0 == info.numberOfFrames) ? canFrame.timestamp_us : lastTimestamp_us));
+		std::uint8_t flags = dataLength;
+		std::uint8_t changedBytes = 0;
+
+		append_varint((static_cast<std::uint64_t>(timeDifference) << 1) ^ static_cast<std::uint64_t>(timeDifference >> 63), payload);
+
+		if (loggedFrame.transmitted)
+		{
+			flags |= FLAG_TRANSMITTED;
+		}
+
+		if (dictionaryIndex == dictionary.size())
+		{
+			DictionaryEntry newEntry;
+
+			newEntry.key = key;
+			newEntry.channel = canFrame.channel;
+			memset(newEntry.data, 0, sizeof(newEntry.data));
+			dictionary.push_back(newEntry);
+
+			payload.push_back(flags | FLAG_NEW_IDENTIFIER);
+			payload.push_back(canFrame.channel);
+			append_little_endian(key, 4, payload);
+		}
+		else
+		{
+			payload.push_back(flags);
+			payload.push_back(static_cast<std::uint8_t>(dictionaryIndex));
+		}
+
+		if (0 != dataLength)
+		{
+			DictionaryEntry &entry = dictionary[dictionaryIndex];
+
+			for (std::uint8_t i = 0; i < dataLength; i++)
+			{
+				if (entry.data[i] != canFrame.data[i])
+				{
+					changedBytes |= static_cast<std::uint8_t>(1 << i);
+				}
+			}
+			payload.push_back(changedBytes);
+
+			for (std::uint8_t i = 0; i < dataLength; i++)
+			{
+				if (0 != (changedBytes & (1 << i)))
+				{
+					payload.push_back(canFrame.data[i]);
+					entry.data[i] = canFrame.data[i];
+				}
+			}
+		}
+
+		info.add_frame(canFrame);
+		info.payloadSize = static_cast<std::uint32_t>(payload.size());
+		lastTimestamp_us = canFrame.timestamp_us;
+	}
+	return retVal;
+}
+
+void CANBusLogFormat::BlockEncoder::reset()
+{
+	info = BlockInfo();
+	payload.clear();
+	dictionary.clear();
+	lastTimestamp_us = 0;
+}
+
+const CANBusLogFormat::BlockInfo &CANBusLogFormat::BlockEncoder::get_info() const
+{
+	return info;
+}
+
+const std::vector<std::uint8_t> &CANBusLogFormat::BlockEncoder::get_payload() const
+{
+	return payload;
+}
+
+bool CANBusLogFormat::decode_block(const BlockInfo &info, const std::vector<std::uint8_t> &payload, std::vector<LoggedFrame> &frames)
+{
+	struct DecodedEntry
+	{
+		std::uint32_t key;
+		std::uint8_t channel;
+		std::uint8_t data[8];
+	};
+	std::vector<DecodedEntry> dictionary;
+	std::uint64_t lastTimestamp_us = info.baseTimestamp_us;
+	std::size_t position = 0;
+	bool retVal = true;
+
+	frames.clear();
+	frames.reserve(info.numberOfFrames);
+
+	for (std::uint32_t i = 0; (i < info.numberOfFrames) && (retVal); i++)
+	{
+		LoggedFrame loggedFrame;
+		std::uint64_t zigZagDifference;
+		std::uint8_t flags = 0;
+		std::size_t dictionaryIndex = 0;
+
+		retVal = ((read_varint(payload, position, zigZagDifference)) &&
+		          (position < payload.size()));
+
+		if (retVal)
+		{
+			const std::int64_t timeDifference = static_cast<std::int64_t>(zigZagDifference >> 1) ^ -static_cast<std::int64_t>(zigZagDifference & 1);
+
+			lastTimestamp_us += static_cast<std::uint64_t>(timeDifference);
+			flags = payload[position];
+			position++;
+
+			if (0 != (flags & FLAG_NEW_IDENTIFIER))
+			{
+				retVal = (position + 5 <= payload.size());
+
+				if (retVal)
+				{
+					DecodedEntry newEntry;
+
+					newEntry.channel = payload[position];
+					newEntry.key = static_cast<std::uint32_t>(read_little_endian(&payload[position + 1], 4));
+					memset(newEntry.data, 0, sizeof(newEntry.data));
+					dictionaryIndex = dictionary.size();
+					dictionary.push_back(newEntry);
+					position += 5;
+				}
+			}
+			else
+			{
+				retVal = ((position < payload.size()) &&
+				          (payload[position] < dictionary.size()));
+
+				if (retVal)
+				{
+					dictionaryIndex = payload[position];
+					position++;
+				}
+			}
+		}
+
+		if (retVal)
+		{
+			DecodedEntry &entry = dictionary[dictionaryIndex];
+			const std::uint8_t dataLength = (flags & FLAG_DATA_LENGTH_MASK);
+
+			retVal = (dataLength <= 8);
+
+			if ((retVal) && (0 != dataLength))
+			{
+				retVal = (position < payload.size());
+
+				if (retVal)
+				{
+					const std::uint8_t changedBytes = payload[position];
+					position++;
+
+					for (std::uint8_t j = 0; (j < dataLength) && (retVal); j++)
+					{
+						if (0 != (changedBytes & (1 << j)))
+						{
+							retVal = (position < payload.size());
+
+							if (retVal)
+							{
+								entry.data[j] = payload[position];
+								position++;
+							}
+						}
+					}
+				}
+			}
+
+			if (retVal)
+			{
+				loggedFrame.frame.timestamp_us = lastTimestamp_us;
+				loggedFrame.frame.identifier = (entry.key & ~EXTENDED_IDENTIFIER_FLAG);
+				loggedFrame.frame.isExtendedFrame = (0 != (entry.key & EXTENDED_IDENTIFIER_FLAG));
+				loggedFrame.frame.channel = entry.channel;
+				loggedFrame.frame.dataLength = dataLength;
+				memcpy(loggedFrame.frame.data, entry.data, sizeof(loggedFrame.frame.data));
+				loggedFrame.transmitted = (0 != (flags & FLAG_TRANSMITTED));
+				frames.push_back(loggedFrame);
+			}
+		}
+	}
+	return retVal;
+}
+
+void CANBusLogFormat::append_file_header(std::uint32_t sequenceNumber, std::vector<std::uint8_t> &buffer)
+{
+	buffer.insert(buffer.end(), FILE_MAGIC, FILE_MAGIC + sizeof(FILE_MAGIC));
+	append_little_endian(FILE_VERSION, 2, buffer);
+	append_little_endian(0, 2, buffer);
+	append_little_endian(sequenceNumber, 4, buffer);
+}
+
+bool CANBusLogFormat::parse_file_header(const std::uint8_t *buffer, std::uint32_t &sequenceNumber)
+{
+	bool retVal = ((0 == memcmp(buffer, FILE_MAGIC, sizeof(FILE_MAGIC))) &&
+	               (FILE_VERSION == read_little_endian(&buffer[8], 2)));
+
+	sequenceNumber = static_cast<std::uint32_t>(read_little_endian(&buffer[12], 4));
+	return retVal;
+}
+
+void CANBusLogFormat::append_block_header(const BlockInfo &info, std::vector<std::uint8_t> &buffer)
+{
+	append_little_endian(info.payloadSize, 4, buffer);
+	append_little_endian(info.numberOfFrames, 4, buffer);
+	append_little_endian(info.baseTimestamp_us, 8, buffer);
+	append_little_endian(info.minimumTimestamp_us, 8, buffer);
+	append_little_endian(info.maximumTimestamp_us, 8, buffer);
+	buffer.insert(buffer.end(), info.parameterGroupNumberBitmap, info.parameterGroupNumberBitmap + sizeof(info.parameterGroupNumberBitmap));
+}
+
+void CANBusLogFormat::parse_block_header(const std::uint8_t *buffer, BlockInfo &info)
+{
+	info.payloadSize = static_cast<std::uint32_t>(read_little_endian(&buffer[0], 4));
+	info.numberOfFrames = static_cast<std::uint32_t>(read_little_endian(&buffer[4], 4));
+	info.baseTimestamp_us = read_little_endian(&buffer[8], 8);
+	info.minimumTimestamp_us = read_little_endian(&buffer[16], 8);
+	info.maximumTimestamp_us = read_little_endian(&buffer[24], 8);
+	memcpy(info.parameterGroupNumberBitmap, &buffer[32], sizeof(info.parameterGroupNumberBitmap));
+}
+
+void CANBusLogFormat::append_index_entry(const BlockInfo &info, std::vector<std::uint8_t> &buffer)
+{
+	append_little_endian(info.fileOffset, 8, buffer);
+	append_block_header(info, buffer);
+}
+
+void CANBusLogFormat::parse_index_entry(const std::uint8_t *buffer, BlockInfo &info)
+{
+	info.fileOffset = read_little_endian(buffer, 8);
+	parse_block_header(&buffer[8], info);
+}
+
+void CANBusLogFormat::append_file_footer(std::uint64_t indexOffset, std::uint32_t numberOfBlocks, std::vector<std::uint8_t> &buffer)
+{
+	append_little_endian(indexOffset, 8, buffer);
+	append_little_endian(numberOfBlocks, 4, buffer);
+	append_little_endian(INDEX_MAGIC, 4, buffer);
+}
+
+bool CANBusLogFormat::parse_file_footer(const std::uint8_t *buffer, std::uint64_t &indexOffset, std::uint32_t &numberOfBlocks)
+{
+	indexOffset = read_little_endian(&buffer[0], 8);
+	numberOfBlocks = static_cast<std::uint32_t>(read_little_endian(&buffer[8], 4));
+	return (INDEX_MAGIC == read_little_endian(&buffer[12], 4));
+}
+
+std::uint32_t CANBusLogFormat::get_parameter_group_number(std::uint32_t identifier)
+{
+	return isobus::CANIdentifier(identifier).get_parameter_group_number();
+}
+
+std::uint8_t CANBusLogFormat::get_parameter_group_number_bit(std::uint32_t parameterGroupNumber)
+{
+	// Folds all 18 bits of the PGN in, so PGNs that only differ in their upper bits use different bits
+	return static_cast<std::uint8_t>(parameterGroupNumber ^ (parameterGroupNumber >> 8) ^ (parameterGroupNumber >> 16));
+}
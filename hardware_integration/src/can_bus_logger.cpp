@@ -0,0 +1,391 @@
+//================================================================================================
+/// @file can_bus_logger.cpp
+///
+/// @brief Logs every frame sent and received by the hardware interface to compact, indexed,
+/// rotating binary files, from its own thread so the CAN thread never waits on the disk.
+/// @author Adrian Del Grosso
+///
+/// @copyright 2022 Adrian Del Grosso
+//================================================================================================
+#include "isobus/hardware_integration/can_bus_logger.hpp"
+
+#include "isobus/hardware_integration/can_hardware_interface.hpp"
+#include "isobus/utility/system_timing.hpp"
+
+#include <chrono>
+#include <iomanip>
+#include <sstream>
+
+constexpr std::size_t CANBusLogger::DEFAULT_QUEUE_SIZE;
+constexpr std::uint64_t CANBusLogger::DEFAULT_MAXIMUM_FILE_SIZE;
+constexpr std::uint32_t CANBusLogger::BLOCK_FLUSH_INTERVAL_MS;
+constexpr std::uint32_t CANBusLogger::WRITER_IDLE_SLEEP_MS;
+
+CANBusLogger::FrameQueue::FrameQueue(std::size_t size) :
+  mask(1),
+  enqueuePosition(0),
+  dequeuePosition(0)
+{
+	std::size_t numberOfCells = 2;
+
+	while (numberOfCells < size)
+	{
+		numberOfCells <<= 1;
+	}
+	cells.reset(new Cell[numberOfCells]);
+	mask = numberOfCells - 1;
+
+	for (std::size_t i = 0; i < numberOfCells; i++)
+	{
+		cells[i].sequence.store(i, std::memory_order_relaxed);
+	}
+}
+
+bool CANBusLogger::FrameQueue::push(const CANBusLogFormat::LoggedFrame &loggedFrame)
+{
+	std::size_t position = enqueuePosition.load(std::memory_order_relaxed);
+	Cell *cell = nullptr;
+	bool retVal = false;
+
+	while (nullptr == cell)
+	{
+		Cell &candidate = cells[position & mask];
+		const std::size_t sequence = candidate.sequence.load(std::memory_order_acquire);
+		const std::intptr_t difference = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position);
+
+		if (0 == difference)
+		{
+			// The cell is free for this lap, so try to claim the position
+			if (enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+			{
+				cell = &candidate;
+			}
+		}
+		else if (difference < 0)
+		{
+			// The cell still has last lap's frame in it, so the queue is full
+			break;
+		}
+		else
+		{
+			position = enqueuePosition.load(std::memory_order_relaxed);
+		}
+	}
+
+	if (nullptr != cell)
+	{
+		cell->loggedFrame = loggedFrame;
+		cell->sequence.store(position + 1, std::memory_order_release);
+		retVal = true;
+	}
+	return retVal;
+}
+
+bool CANBusLogger::FrameQueue::pop(CANBusLogFormat::LoggedFrame &loggedFrame)
+{
+	std::size_t position = dequeuePosition.load(std::memory_order_relaxed);
+	Cell *cell = nullptr;
+	bool retVal = false;
+
+	while (nullptr == cell)
+	{
+		Cell &candidate = cells[position & mask];
+		const std::size_t sequence = candidate.sequence.load(std::memory_order_acquire);
+		const std::intptr_t difference = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position + 1);
+
+		if (0 == difference)
+		{
+			if (dequeuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+			{
+				cell = &candidate;
+			}
+		}
+		else if (difference < 0)
+		{
+			// Nothing has been written to the cell this lap, so the queue is empty
+			break;
+		}
+		else
+		{
+			position = dequeuePosition.load(std::memory_order_relaxed);
+		}
+	}
+
+	if (nullptr != cell)
+	{
+		loggedFrame = cell->loggedFrame;
+		// Free the cell for the next lap of the ring
+		cell->sequence.store(position + mask + 1, std::memory_order_release);
+		retVal = true;
+	}
+	return retVal;
+}
+
+CANBusLogger::CANBusLogger(std::size_t queueSize) :
+  queue(queueSize),
+  writerThread(nullptr),
+  fileSize_bytes(0),
+  fileOpenedTimestamp_ms(0),
+  blockStartedTimestamp_ms(0),
+  nextSequenceNumber(0),
+  maximumFileSize_bytes(DEFAULT_MAXIMUM_FILE_SIZE),
+  maximumFileDuration_ms(0),
+  loggedFrames(0),
+  droppedFrames(0),
+  writeErrors(0),
+  running(false)
+{
+}
+
+CANBusLogger::~CANBusLogger()
+{
+	stop();
+}
+
+bool CANBusLogger::start(const std::string &filePrefix)
+{
+	bool retVal = false;
+
+	if ((!running) && (nullptr == writerThread))
+	{
+		prefix = filePrefix;
+		nextSequenceNumber = 0;
+		loggedFrames = 0;
+		droppedFrames = 0;
+		writeErrors = 0;
+		encoder.reset();
+		{
+			const std::lock_guard<std::mutex> lock(fileNamesMutex);
+			fileNames.clear();
+		}
+
+		if (open_next_file())
+		{
+			running = true;
+			writerThread = new std::thread([this]() { writer_thread_function(); });
+			CANHardwareInterface::add_raw_can_message_rx_callback(process_rx_frame, this);
+			CANHardwareInterface::add_raw_can_message_tx_callback(process_tx_frame, this);
+			retVal = true;
+		}
+	}
+	return retVal;
+}
+
+void CANBusLogger::stop()
+{
+	// Once the callbacks are removed, the CAN thread can't be in the middle of logging a frame
+	CANHardwareInterface::remove_raw_can_message_rx_callback(process_rx_frame, this);
+	CANHardwareInterface::remove_raw_can_message_tx_callback(process_tx_frame, this);
+	running = false;
+
+	if (nullptr != writerThread)
+	{
+		writerThread->join();
+		delete writerThread;
+		writerThread = nullptr;
+	}
+}
+
+bool CANBusLogger::get_is_running() const
+{
+	return running;
+}
+
+bool CANBusLogger::log_frame(const isobus::HardwareInterfaceCANFrame &canFrame, bool transmitted)
+{
+	bool retVal = false;
+
+	if (running)
+	{
+		CANBusLogFormat::LoggedFrame loggedFrame;
+
+		loggedFrame.frame = canFrame;
+		loggedFrame.transmitted = transmitted;
+		retVal = queue.push(loggedFrame);
+
+		if (!retVal)
+		{
+			droppedFrames.fetch_add(1, std::memory_order_relaxed);
+		}
+	}
+	return retVal;
+}
+
+void CANBusLogger::set_maximum_file_size(std::uint64_t maximumSize_bytes)
+{
+	maximumFileSize_bytes = maximumSize_bytes;
+}
+
+void CANBusLogger::set_maximum_file_duration(std::uint32_t maximumDuration_ms)
+{
+	maximumFileDuration_ms = maximumDuration_ms;
+}
+
+std::vector<std::string> CANBusLogger::get_file_names() const
+{
+	const std::lock_guard<std::mutex> lock(fileNamesMutex);
+	return fileNames;
+}
+
+std::uint64_t CANBusLogger::get_number_logged_frames() const
+{
+	return loggedFrames;
+}
+
+std::uint64_t CANBusLogger::get_number_dropped_frames() const
+{
+	return droppedFrames;
+}
+
+std::uint32_t CANBusLogger::get_number_write_errors() const
+{
+	return writeErrors;
+}
+
+void CANBusLogger::process_rx_frame(isobus::HardwareInterfaceCANFrame &rxFrame, void *parentPointer)
+{
+	if (nullptr != parentPointer)
+	{
+		static_cast<CANBusLogger *>(parentPointer)->log_frame(rxFrame, false);
+	}
+}
+
+void CANBusLogger::process_tx_frame(isobus::HardwareInterfaceCANFrame &txFrame, void *parentPointer)
+{
+	if (nullptr != parentPointer)
+	{
+		static_cast<CANBusLogger *>(parentPointer)->log_frame(txFrame, true);
+	}
+}
+
+void CANBusLogger::writer_thread_function()
+{
+	CANBusLogFormat::LoggedFrame loggedFrame;
+	bool keepWriting = true;
+
+	while (keepWriting)
+	{
+		if (queue.pop(loggedFrame))
+		{
+			if (!encoder.add_frame(loggedFrame))
+			{
+				write_block();
+				encoder.add_frame(loggedFrame);
+			}
+
+			if (1 == encoder.get_info().numberOfFrames)
+			{
+				blockStartedTimestamp_ms = isobus::SystemTiming::get_timestamp_ms();
+			}
+		}
+		else if (!running)
+		{
+			// Stopped, and everything that was queued has been taken
+			keepWriting = false;
+		}
+		else
+		{
+			if ((0 != encoder.get_info().numberOfFrames) &&
+			    (isobus::SystemTiming::time_expired_ms(blockStartedTimestamp_ms, BLOCK_FLUSH_INTERVAL_MS)))
+			{
+				write_block();
+			}
+			std::this_thread::sleep_for(std::chrono::milliseconds(WRITER_IDLE_SLEEP_MS));
+		}
+	}
+	write_block();
+	close_file();
+}
+
+bool CANBusLogger::open_next_file()
+{
+	std::ostringstream fileName;
+	bool retVal;
+
+	fileName << prefix << '_' << std::setw(4) << std::setfill('0') << nextSequenceNumber << ".canlog";
+	logFile.clear();
+	logFile.open(fileName.str(), std::ios::out | std::ios::binary | std::ios::trunc);
+	retVal = logFile.is_open();
+
+	if (retVal)
+	{
+		{
+			const std::lock_guard<std::mutex> lock(fileNamesMutex);
+			fileNames.push_back(fileName.str());
+		}
+		fileIndex.clear();
+		fileSize_bytes = 0;
+		fileOpenedTimestamp_ms = isobus::SystemTiming::get_timestamp_ms();
+
+		writeBuffer.clear();
+		CANBusLogFormat::append_file_header(nextSequenceNumber, writeBuffer);
+		write_buffer(writeBuffer);
+		nextSequenceNumber++;
+	}
+	else
+	{
+		writeErrors.fetch_add(1, std::memory_order_relaxed);
+	}
+	return retVal;
+}
+
+void CANBusLogger::close_file()
+{
+	if (logFile.is_open())
+	{
+		const std::uint64_t indexOffset = fileSize_bytes;
+
+		writeBuffer.clear();
+		for (const CANBusLogFormat::BlockInfo &info : fileIndex)
+		{
+			CANBusLogFormat::append_index_entry(info, writeBuffer);
+		}
+		CANBusLogFormat::append_file_footer(indexOffset, static_cast<std::uint32_t>(fileIndex.size()), writeBuffer);
+		write_buffer(writeBuffer);
+		logFile.close();
+	}
+}
+
+void CANBusLogger::write_block()
+{
+	if ((0 != encoder.get_info().numberOfFrames) &&
+	    (logFile.is_open()))
+	{
+		CANBusLogFormat::BlockInfo info = encoder.get_info();
+		const std::uint64_t maximumSize_bytes = maximumFileSize_bytes;
+		const std::uint32_t maximumDuration_ms = maximumFileDuration_ms;
+
+		info.fileOffset = fileSize_bytes;
+		writeBuffer.clear();
+		CANBusLogFormat::append_block_header(info, writeBuffer);
+		writeBuffer.insert(writeBuffer.end(), encoder.get_payload().begin(), encoder.get_payload().end());
+		write_buffer(writeBuffer);
+		fileIndex.push_back(info);
+		loggedFrames.fetch_add(info.numberOfFrames, std::memory_order_relaxed);
+
+		if (((0 != maximumSize_bytes) && (fileSize_bytes >= maximumSize_bytes)) ||
+		    ((0 != maximumDuration_ms) && (isobus::SystemTiming::time_expired_ms(fileOpenedTimestamp_ms, maximumDuration_ms))))
+		{
+			close_file();
+			open_next_file();
+		}
+	}
+	encoder.reset();
+}
+
+void CANBusLogger::write_buffer(const std::vector<std::uint8_t> &buffer)
+{
+	logFile.write(reinterpret_cast<const char *>(buffer.data()), static_cast<std::streamsize>(buffer.size()));
+	// Flushed so that a file that's never closed still has every block that was written
+	logFile.flush();
+
+	if (logFile.good())
+	{
+		fileSize_bytes += buffer.size();
+	}
+	else
+	{
+		writeErrors.fetch_add(1, std::memory_order_relaxed);
+		logFile.clear();
+	}
+}
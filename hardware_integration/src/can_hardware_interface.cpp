@@ -8,19 +8,24 @@
 /// @copyright 2022 Adrian Del Grosso
 //================================================================================================
 #include "isobus/hardware_integration/can_hardware_interface.hpp"
+#include "isobus/isobus/can_bus_load.hpp"
+#include "isobus/isobus/can_latency_profiler.hpp"
 #include "isobus/utility/system_timing.hpp"
 
 #include <algorithm>
+#include <limits>
 
 std::thread *CANHardwareInterface::can_thread = nullptr;
 std::thread *CANHardwareInterface::updateCANLibPeriodicThread = nullptr;
 std::condition_variable CANHardwareInterface::threadConditionVariable;
 std::vector<CANHardwareInterface::CanHardware *> CANHardwareInterface::hardwareChannels;
 std::vector<CANHardwareInterface::RawCanMessageCallbackInfo> CANHardwareInterface::rxCallbacks;
+std::vector<CANHardwareInterface::RawCanMessageCallbackInfo> CANHardwareInterface::txCallbacks;
 std::vector<CANHardwareInterface::CanLibUpdateCallbackInfo> CANHardwareInterface::canLibUpdateCallbacks;
 std::mutex CANHardwareInterface::hardwareChannelsMutex;
 std::mutex CANHardwareInterface::threadMutex;
 std::mutex CANHardwareInterface::rxCallbackMutex;
+std::mutex CANHardwareInterface::txCallbackMutex;
 std::mutex CANHardwareInterface::canLibNeedsUpdateMutex;
 std::mutex CANHardwareInterface::canLibUpdateCallbacksMutex;
 bool CANHardwareInterface::threadsStarted = false;
@@ -54,6 +59,19 @@ bool CANHardwareInterface::CanLibUpdateCallbackInfo::operator==(const CanLibUpda
 	return ((obj.callback == this->callback) && (obj.parent == this->parent));
 }
 
+CANHardwareInterface::ChannelStatistics::ChannelStatistics() :
+  receivedFrames(0),
+  receivedBytes(0),
+  transmittedFrames(0),
+  transmittedBytes(0),
+  transmitFailures(0),
+  droppedFrames(0),
+  receiveQueueHighWaterMark(0),
+  transmitQueueHighWaterMark(0),
+  busLoadPercent(0.0f)
+{
+}
+
 CANHardwareInterface::CANHardwareInterface()
 {
 }
@@ -103,6 +121,7 @@ bool CANHardwareInterface::set_number_of_can_channels(uint8_t aValue)
 				pCANHardware = new CanHardware();
 				pCANHardware->receiveMessageThread = nullptr;
 				pCANHardware->frameHandler = nullptr;
+				clear_statistics(*pCANHardware);
 
 				hardwareChannels.push_back(pCANHardware);
 			}
@@ -229,6 +248,12 @@ bool CANHardwareInterface::stop()
 		rxCallbackMutex.unlock();
 	}
 
+	if (txCallbackMutex.try_lock())
+	{
+		txCallbacks.clear();
+		txCallbackMutex.unlock();
+	}
+
 	if (canLibUpdateCallbacksMutex.try_lock())
 	{
 		for (std::uint32_t i = 0; i < canLibUpdateCallbacks.size(); i++)
@@ -250,6 +275,9 @@ bool CANHardwareInterface::transmit_can_message(isobus::HardwareInterfaceCANFram
 	{
 		hardwareChannels[lChannel]->messagesToBeTransmittedMutex.lock();
 		hardwareChannels[lChannel]->messagesToBeTransmitted.push_back(packet);
+		// Tx frames have no timestamp of their own, so it holds when the frame was queued until it's written
+		hardwareChannels[lChannel]->messagesToBeTransmitted.back().timestamp_us = isobus::CANLatencyProfiler::get_timestamp_us();
+		update_high_water_mark(hardwareChannels[lChannel]->transmitQueueHighWaterMark, hardwareChannels[lChannel]->messagesToBeTransmitted.size());
 		hardwareChannels[lChannel]->messagesToBeTransmittedMutex.unlock();
 
 		threadConditionVariable.notify_all();
@@ -307,6 +335,43 @@ bool CANHardwareInterface::remove_raw_can_message_rx_callback(void (*callback)(i
 	return retVal;
 }
 
+bool CANHardwareInterface::add_raw_can_message_tx_callback(void (*callback)(isobus::HardwareInterfaceCANFrame &txFrame, void *parentPointer), void *parent)
+{
+	bool retVal = false;
+	RawCanMessageCallbackInfo callbackInfo;
+
+	callbackInfo.callback = callback;
+	callbackInfo.parent = parent;
+
+	const std::lock_guard<std::mutex> lock(txCallbackMutex);
+
+	if ((nullptr != callback) && (txCallbacks.end() == find(txCallbacks.begin(), txCallbacks.end(), callbackInfo)))
+	{
+		txCallbacks.push_back(callbackInfo);
+		retVal = true;
+	}
+	return retVal;
+}
+
+bool CANHardwareInterface::remove_raw_can_message_tx_callback(void (*callback)(isobus::HardwareInterfaceCANFrame &txFrame, void *parentPointer), void *parent)
+{
+	bool retVal = false;
+	RawCanMessageCallbackInfo callbackInfo;
+
+	callbackInfo.callback = callback;
+	callbackInfo.parent = parent;
+
+	const std::lock_guard<std::mutex> lock(txCallbackMutex);
+	std::vector<RawCanMessageCallbackInfo>::iterator callbackLocation = std::find(txCallbacks.begin(), txCallbacks.end(), callbackInfo);
+
+	if ((nullptr != callback) && (txCallbacks.end() != callbackLocation))
+	{
+		txCallbacks.erase(callbackLocation);
+		retVal = true;
+	}
+	return retVal;
+}
+
 bool CANHardwareInterface::add_can_lib_update_callback(void (*callback)(), void *parentPointer)
 {
 	bool retVal = false;
@@ -380,14 +445,17 @@ void CANHardwareInterface::can_thread_function()
 
 				while (processNextMessage)
 				{
-					isobus::HardwareInterfaceCANFrame tempCanFrame;
+					ReceivedFrame receivedFrame;
 
 					pCANHardware->receivedMessagesMutex.lock();
-					tempCanFrame = pCANHardware->receivedMessages.front();
+					receivedFrame = pCANHardware->receivedMessages.front();
 					pCANHardware->receivedMessages.pop_front();
 					processNextMessage = (!pCANHardware->receivedMessages.empty());
 					pCANHardware->receivedMessagesMutex.unlock();
 
+					isobus::HardwareInterfaceCANFrame &tempCanFrame = receivedFrame.frame;
+					isobus::CANLatencyProfiler::record_frame_latency(isobus::CANLatencyProfiler::Stage::ChannelQueue, tempCanFrame.identifier, tempCanFrame.isExtendedFrame, receivedFrame.queuedTimestamp_us);
+
 					rxCallbackMutex.lock();
 					for (std::uint32_t j = 0; j < rxCallbacks.size(); j++)
 					{
@@ -435,9 +503,26 @@ void CANHardwareInterface::can_thread_function()
 						if (transmit_can_message_from_buffer(packet))
 						{
 							pCANHardware->messagesToBeTransmitted.pop_front();
+							count_frame(pCANHardware->transmittedFrames, pCANHardware->transmittedBytes, *pCANHardware, packet);
+							isobus::CANLatencyProfiler::record_frame_latency(isobus::CANLatencyProfiler::Stage::TransmitQueue, packet.identifier, packet.isExtendedFrame, packet.timestamp_us);
+
+							txCallbackMutex.lock();
+							if (!txCallbacks.empty())
+							{
+								packet.timestamp_us = isobus::SystemTiming::get_timestamp_us();
+								for (std::uint32_t k = 0; k < txCallbacks.size(); k++)
+								{
+									if (nullptr != txCallbacks[k].callback)
+									{
+										txCallbacks[k].callback(packet, txCallbacks[k].parent);
+									}
+								}
+							}
+							txCallbackMutex.unlock();
 						}
 						else
 						{
+							pCANHardware->transmitFailures.fetch_add(1, std::memory_order_relaxed);
 							break;
 						}
 						// Todo, notify CAN lib that we sent, or did not send, each packet
@@ -471,8 +556,14 @@ void CANHardwareInterface::receive_message_thread_function(uint8_t aCANChannel)
 				{
 					tempCanFrame.channel = aCANChannel;
 					pCANHardware->receivedMessagesMutex.lock();
-					pCANHardware->receivedMessages.push_back(tempCanFrame);
+					ReceivedFrame receivedFrame;
+
+					receivedFrame.frame = tempCanFrame;
+					receivedFrame.queuedTimestamp_us = isobus::CANLatencyProfiler::get_timestamp_us();
+					pCANHardware->receivedMessages.push_back(receivedFrame);
+					update_high_water_mark(pCANHardware->receiveQueueHighWaterMark, pCANHardware->receivedMessages.size());
 					pCANHardware->receivedMessagesMutex.unlock();
+					count_frame(pCANHardware->receivedFrames, pCANHardware->receivedBytes, *pCANHardware, tempCanFrame);
 					threadConditionVariable.notify_all();
 				}
 			}
@@ -507,6 +598,110 @@ void CANHardwareInterface::update_can_lib_periodic_function()
 	}
 }
 
+bool CANHardwareInterface::get_channel_statistics(std::uint8_t aCANChannel, ChannelStatistics &statistics)
+{
+	const std::lock_guard<std::mutex> lock(hardwareChannelsMutex);
+	bool retVal = false;
+
+	if (aCANChannel < hardwareChannels.size())
+	{
+		const CanHardware &channel = *hardwareChannels[aCANChannel];
+
+		statistics.receivedFrames = channel.receivedFrames.load(std::memory_order_relaxed);
+		statistics.receivedBytes = channel.receivedBytes.load(std::memory_order_relaxed);
+		statistics.transmittedFrames = channel.transmittedFrames.load(std::memory_order_relaxed);
+		statistics.transmittedBytes = channel.transmittedBytes.load(std::memory_order_relaxed);
+		statistics.transmitFailures = channel.transmitFailures.load(std::memory_order_relaxed);
+		statistics.receiveQueueHighWaterMark = channel.receiveQueueHighWaterMark.load(std::memory_order_relaxed);
+		statistics.transmitQueueHighWaterMark = channel.transmitQueueHighWaterMark.load(std::memory_order_relaxed);
+		statistics.droppedFrames = 0;
+		statistics.busLoadPercent = channel.busLoad.get_bus_load();
+
+		if (nullptr != channel.frameHandler)
+		{
+			const std::uint32_t droppedFrames = channel.frameHandler->get_number_dropped_frames();
+			const std::uint32_t droppedFramesAtReset = channel.droppedFramesAtReset.load(std::memory_order_relaxed);
+
+			// The driver's count starts over when it's opened, which might have been after the reset
+			if (droppedFrames >= droppedFramesAtReset)
+			{
+				statistics.droppedFrames = (droppedFrames - droppedFramesAtReset);
+			}
+			else
+			{
+				statistics.droppedFrames = droppedFrames;
+			}
+		}
+		retVal = true;
+	}
+	return retVal;
+}
+
+bool CANHardwareInterface::reset_channel_statistics(std::uint8_t aCANChannel)
+{
+	const std::lock_guard<std::mutex> lock(hardwareChannelsMutex);
+	bool retVal = false;
+
+	if (aCANChannel < hardwareChannels.size())
+	{
+		clear_statistics(*hardwareChannels[aCANChannel]);
+		retVal = true;
+	}
+	return retVal;
+}
+
+bool CANHardwareInterface::set_channel_bit_rate(std::uint8_t aCANChannel, std::uint32_t bitRate)
+{
+	const std::lock_guard<std::mutex> lock(hardwareChannelsMutex);
+	bool retVal = false;
+
+	if ((aCANChannel < hardwareChannels.size()) &&
+	    (0 != bitRate))
+	{
+		hardwareChannels[aCANChannel]->busLoad.set_bit_rate(bitRate);
+		retVal = true;
+	}
+	return retVal;
+}
+
+void CANHardwareInterface::clear_statistics(CanHardware &channel)
+{
+	std::uint32_t droppedFrames = 0;
+
+	if (nullptr != channel.frameHandler)
+	{
+		droppedFrames = channel.frameHandler->get_number_dropped_frames();
+	}
+	channel.receivedFrames.store(0, std::memory_order_relaxed);
+	channel.receivedBytes.store(0, std::memory_order_relaxed);
+	channel.transmittedFrames.store(0, std::memory_order_relaxed);
+	channel.transmittedBytes.store(0, std::memory_order_relaxed);
+	channel.transmitFailures.store(0, std::memory_order_relaxed);
+	channel.droppedFramesAtReset.store(droppedFrames, std::memory_order_relaxed);
+	channel.receiveQueueHighWaterMark.store(0, std::memory_order_relaxed);
+	channel.transmitQueueHighWaterMark.store(0, std::memory_order_relaxed);
+	channel.busLoad.reset();
+}
+
+void CANHardwareInterface::count_frame(std::atomic<std::uint64_t> &frameCount, std::atomic<std::uint64_t> &byteCount, CanHardware &channel, const isobus::HardwareInterfaceCANFrame &frame)
+{
+	frameCount.fetch_add(1, std::memory_order_relaxed);
+	byteCount.fetch_add(frame.dataLength, std::memory_order_relaxed);
+	channel.busLoad.add_frame_bits(isobus::CANBusLoad::get_frame_bit_length(frame));
+}
+
+void CANHardwareInterface::update_high_water_mark(std::atomic<std::uint32_t> &highWaterMark, std::size_t queueSize)
+{
+	const std::uint32_t size = static_cast<std::uint32_t>(std::min<std::size_t>(queueSize, std::numeric_limits<std::uint32_t>::max()));
+	std::uint32_t currentHighWaterMark = highWaterMark.load(std::memory_order_relaxed);
+
+	while ((size > currentHighWaterMark) &&
+	       (!highWaterMark.compare_exchange_weak(currentHighWaterMark, size, std::memory_order_relaxed)))
+	{
+		// currentHighWaterMark was updated by the failed exchange, so just try again
+	}
+}
+
 void CANHardwareInterface::set_can_lib_needs_update()
 {
 	canLibNeedsUpdateMutex.lock();
@@ -0,0 +1,422 @@
+//================================================================================================
+/// @file can_log_reader.cpp
+///
+/// @brief Reads CAN frames from recorded bus logs, so that recorded traffic can be fed back
+/// into the stack. Supports logs from Linux candump and Vector ASC logs.
+/// @author Adrian Del Grosso
+///
+/// @copyright 2022 Adrian Del Grosso
+//================================================================================================
+#include "isobus/hardware_integration/can_log_reader.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <limits>
+#include <sstream>
+
+namespace
+{
+	constexpr std::uint8_t MAXIMUM_DATA_LENGTH = 8; ///< Classic CAN frames carry up to 8 bytes
+	constexpr std::uint32_t STANDARD_IDENTIFIER_MASK = 0x7FF; ///< The largest 11 bit identifier
+	constexpr std::uint32_t EXTENDED_IDENTIFIER_MASK = 0x1FFFFFFF; ///< The largest 29 bit identifier
+
+	/// @brief Splits a line into the words between whitespace
+	/// @param[in] line The line to split
+	/// @returns The words in the line
+	std::vector<std::string> split_words(const std::string &line)
+	{
+		std::istringstream lineStream(line);
+		std::vector<std::string> retVal;
+		std::string word;
+
+		while (lineStream >> word)
+		{
+			retVal.push_back(word);
+		}
+		return retVal;
+	}
+
+	/// @brief Returns a copy of some text in lower case
+	/// @param[in] text The text to convert
+	/// @returns The text in lower case
+	std::string to_lower(std::string text)
+	{
+		std::transform(text.begin(), text.end(), text.begin(), [](char character) { return static_cast<char>(std::tolower(static_cast<unsigned char>(character))); });
+		return text;
+	}
+
+	/// @brief Returns if some text starts with a prefix
+	/// @param[in] text The text to check
+	/// @param[in] prefix The prefix to look for
+	/// @returns `true` if the text starts with the prefix, otherwise `false`
+	bool starts_with(const std::string &text, const char *prefix)
+	{
+		return (0 == text.compare(0, std::strlen(prefix), prefix));
+	}
+}
+
+CANLogReader::CANLogReader() :
+  input(nullptr),
+  lastTimestamp_us(0),
+  numberSkippedLines(0),
+  format(Format::Automatic),
+  ascHexadecimal(true),
+  ascRelativeTimestamps(false)
+{
+}
+
+bool CANLogReader::open(const std::string &fileName, Format logFormat)
+{
+	bool retVal = false;
+
+	close();
+	logFile.open(fileName, std::ios::in);
+
+	if (logFile.is_open())
+	{
+		open(logFile, logFormat);
+		retVal = true;
+	}
+	return retVal;
+}
+
+void CANLogReader::open(std::istream &logStream, Format logFormat)
+{
+	if (&logStream != &logFile)
+	{
+		close();
+	}
+	input = &logStream;
+	format = logFormat;
+	channelNames.clear();
+	lastTimestamp_us = 0;
+	numberSkippedLines = 0;
+	ascHexadecimal = true;
+	ascRelativeTimestamps = false;
+}
+
+void CANLogReader::close()
+{
+	input = nullptr;
+
+	if (logFile.is_open())
+	{
+		logFile.close();
+	}
+	logFile.clear();
+}
+
+bool CANLogReader::read_frame(isobus::HardwareInterfaceCANFrame &canFrame)
+{
+	bool retVal = false;
+	std::string line;
+
+	while ((!retVal) &&
+	       (nullptr != input) &&
+	       (std::getline(*input, line)))
+	{
+		// Logs saved on Windows end their lines with a carriage return
+		if ((!line.empty()) && ('\r' == line.back()))
+		{
+			line.pop_back();
+		}
+
+		if (line.find_first_not_of(" \t") != std::string::npos)
+		{
+			if (Format::Automatic == format)
+			{
+				format = detect_format(line);
+			}
+
+			switch (format)
+			{
+				case Format::Candump:
+				{
+					retVal = parse_candump_line(line, canFrame);
+				}
+				break;
+
+				case Format::VectorASC:
+				{
+					retVal = parse_asc_line(line, canFrame);
+				}
+				break;
+
+				default:
+					break;
+			}
+
+			if (!retVal)
+			{
+				numberSkippedLines++;
+			}
+		}
+	}
+	return retVal;
+}
+
+CANLogReader::Format CANLogReader::get_format() const
+{
+	return format;
+}
+
+std::uint32_t CANLogReader::get_number_skipped_lines() const
+{
+	return numberSkippedLines;
+}
+
+const std::vector<std::string> &CANLogReader::get_channel_names() const
+{
+	return channelNames;
+}
+
+bool CANLogReader::parse_candump_line(const std::string &line, isobus::HardwareInterfaceCANFrame &canFrame)
+{
+	const std::vector<std::string> words = split_words(line);
+	std::size_t wordIndex = 0;
+	std::uint64_t timestamp_us = 0;
+	std::string identifierText;
+	std::vector<std::string> dataBytes;
+	bool retVal = false;
+
+	// The timestamp is optional, and looks like (1436509052.249713)
+	if ((wordIndex < words.size()) &&
+	    ('(' == words[wordIndex].front()) &&
+	    (')' == words[wordIndex].back()) &&
+	    (parse_seconds(words[wordIndex].substr(1, words[wordIndex].size() - 2), timestamp_us)))
+	{
+		wordIndex++;
+	}
+
+	if ((wordIndex + 1) < words.size())
+	{
+		const std::string &interfaceName = words[wordIndex];
+		const std::string &frameText = words[wordIndex + 1];
+		const std::size_t separator = frameText.find('#');
+
+		if (std::string::npos != separator)
+		{
+			// The log file format, like 18EF1C1D#0102. CAN FD frames use ## and remote frames #R, which are skipped.
+			const std::string dataText = frameText.substr(separator + 1);
+
+			identifierText = frameText.substr(0, separator);
+			if ((0 == (dataText.size() % 2)) &&
+			    (dataText.size() <= (2 * MAXIMUM_DATA_LENGTH)) &&
+			    (std::string::npos == dataText.find_first_of("#Rr")))
+			{
+				for (std::size_t i = 0; i < dataText.size(); i += 2)
+				{
+					dataBytes.push_back(dataText.substr(i, 2));
+				}
+				retVal = true;
+			}
+		}
+		else
+		{
+			// The printed format, like 18EF1C1D   [2]  01 02, maybe with other columns before the identifier
+			for (std::size_t i = wordIndex + 2; (!retVal) && (i < words.size()); i++)
+			{
+				std::uint32_t dataLength;
+
+				if ((words[i].size() > 2) &&
+				    ('[' == words[i].front()) &&
+				    (']' == words[i].back()) &&
+				    (parse_number(words[i].substr(1, words[i].size() - 2), 10, dataLength)) &&
+				    (dataLength <= MAXIMUM_DATA_LENGTH) &&
+				    ((i + dataLength) < words.size()))
+				{
+					identifierText = words[i - 1];
+					dataBytes.assign(words.begin() + static_cast<std::ptrdiff_t>(i + 1), words.begin() + static_cast<std::ptrdiff_t>(i + 1 + dataLength));
+					retVal = true;
+				}
+			}
+		}
+
+		if (retVal)
+		{
+			std::uint32_t identifier = 0;
+
+			retVal = parse_number(identifierText, 16, identifier);
+			canFrame.isExtendedFrame = (identifierText.size() > 3);
+			retVal = retVal && (identifier <= (canFrame.isExtendedFrame ? EXTENDED_IDENTIFIER_MASK : STANDARD_IDENTIFIER_MASK));
+
+			for (std::size_t i = 0; (retVal) && (i < dataBytes.size()); i++)
+			{
+				std::uint32_t dataByte = 0;
+
+				retVal = (parse_number(dataBytes[i], 16, dataByte)) && (dataByte <= std::numeric_limits<std::uint8_t>::max());
+				canFrame.data[i] = static_cast<std::uint8_t>(dataByte);
+			}
+
+			if (retVal)
+			{
+				auto channelName = std::find(channelNames.begin(), channelNames.end(), interfaceName);
+
+				if (channelNames.end() == channelName)
+				{
+					channelNames.push_back(interfaceName);
+					channelName = channelNames.end() - 1;
+				}
+				canFrame.timestamp_us = timestamp_us;
+				canFrame.identifier = identifier;
+				canFrame.channel = static_cast<std::uint8_t>(channelName - channelNames.begin());
+				canFrame.dataLength = static_cast<std::uint8_t>(dataBytes.size());
+				lastTimestamp_us = timestamp_us;
+			}
+		}
+	}
+	return retVal;
+}
+
+bool CANLogReader::parse_asc_line(const std::string &line, isobus::HardwareInterfaceCANFrame &canFrame)
+{
+	const std::vector<std::string> words = split_words(line);
+	bool retVal = false;
+
+	if ((3 <= words.size()) && ("base" == to_lower(words[0])))
+	{
+		// Like "base hex  timestamps absolute"
+		ascHexadecimal = ("dec" != to_lower(words[1]));
+		ascRelativeTimestamps = ("relative" == to_lower(words[words.size() - 1]));
+	}
+	else if (6 <= words.size())
+	{
+		// Like "0.001234 1  18EF1C1Dx       Rx   d 8 01 02 03 04 05 06 07 08"
+		const std::uint8_t base = ascHexadecimal ? 16 : 10;
+		std::string identifierText = words[2];
+		std::uint64_t timestamp_us = 0;
+		std::uint32_t channel = 0;
+		std::uint32_t identifier = 0;
+		std::uint32_t dataLength = 0;
+
+		canFrame.isExtendedFrame = ((!identifierText.empty()) && ('x' == std::tolower(static_cast<unsigned char>(identifierText.back()))));
+		if (canFrame.isExtendedFrame)
+		{
+			identifierText.pop_back();
+		}
+
+		retVal = ((parse_seconds(words[0], timestamp_us)) &&
+		          (parse_number(words[1], 10, channel)) &&
+		          (0 != channel) &&
+		          (channel <= std::numeric_limits<std::uint8_t>::max()) &&
+		          (parse_number(identifierText, base, identifier)) &&
+		          (identifier <= (canFrame.isExtendedFrame ? EXTENDED_IDENTIFIER_MASK : STANDARD_IDENTIFIER_MASK)) &&
+		          (("rx" == to_lower(words[3])) || ("tx" == to_lower(words[3]))) &&
+		          ("d" == to_lower(words[4])) &&
+		          (parse_number(words[5], 16, dataLength)) &&
+		          (dataLength <= MAXIMUM_DATA_LENGTH) &&
+		          ((6 + dataLength) <= words.size()));
+
+		for (std::uint32_t i = 0; (retVal) && (i < dataLength); i++)
+		{
+			std::uint32_t dataByte = 0;
+
+			retVal = (parse_number(words[6 + i], base, dataByte)) && (dataByte <= std::numeric_limits<std::uint8_t>::max());
+			canFrame.data[i] = static_cast<std::uint8_t>(dataByte);
+		}
+
+		if (retVal)
+		{
+			if (ascRelativeTimestamps)
+			{
+				timestamp_us += lastTimestamp_us;
+			}
+			canFrame.timestamp_us = timestamp_us;
+			canFrame.identifier = identifier;
+			canFrame.channel = static_cast<std::uint8_t>(channel - 1);
+			canFrame.dataLength = static_cast<std::uint8_t>(dataLength);
+			lastTimestamp_us = timestamp_us;
+		}
+	}
+	return retVal;
+}
+
+CANLogReader::Format CANLogReader::detect_format(const std::string &line)
+{
+	const std::string lowerCaseLine = to_lower(line.substr(line.find_first_not_of(" \t")));
+	const std::vector<std::string> words = split_words(lowerCaseLine);
+	std::uint64_t timestamp_us;
+	std::uint32_t channel;
+	Format retVal = Format::Automatic;
+
+	if ((starts_with(lowerCaseLine, "date ")) ||
+	    (starts_with(lowerCaseLine, "base ")) ||
+	    (starts_with(lowerCaseLine, "begin triggerblock")) ||
+	    (starts_with(lowerCaseLine, "internal events")) ||
+	    (starts_with(lowerCaseLine, "no internal events")))
+	{
+		retVal = Format::VectorASC;
+	}
+	else if (('(' == lowerCaseLine.front()) ||
+	         (std::string::npos != lowerCaseLine.find('#')) ||
+	         (std::string::npos != lowerCaseLine.find('[')))
+	{
+		retVal = Format::Candump;
+	}
+	else if ((2 <= words.size()) &&
+	         (parse_seconds(words[0], timestamp_us)) &&
+	         (parse_number(words[1], 10, channel)))
+	{
+		retVal = Format::VectorASC;
+	}
+	return retVal;
+}
+
+bool CANLogReader::parse_number(const std::string &text, std::uint8_t base, std::uint32_t &value)
+{
+	std::uint64_t result = 0;
+	bool retVal = (!text.empty());
+
+	for (std::size_t i = 0; (retVal) && (i < text.size()); i++)
+	{
+		const char character = static_cast<char>(std::tolower(static_cast<unsigned char>(text[i])));
+		std::uint8_t digit = base;
+
+		if ((character >= '0') && (character <= '9'))
+		{
+			digit = static_cast<std::uint8_t>(character - '0');
+		}
+		else if ((character >= 'a') && (character <= 'f'))
+		{
+			digit = static_cast<std::uint8_t>(10 + (character - 'a'));
+		}
+		result = (result * base) + digit;
+		retVal = ((digit < base) && (result <= std::numeric_limits<std::uint32_t>::max()));
+	}
+
+	if (retVal)
+	{
+		value = static_cast<std::uint32_t>(result);
+	}
+	return retVal;
+}
+
+bool CANLogReader::parse_seconds(const std::string &text, std::uint64_t &timestamp_us)
+{
+	constexpr std::uint8_t MICROSECOND_DIGITS = 6;
+	const std::size_t decimalPoint = text.find('.');
+	const std::string secondsText = text.substr(0, decimalPoint);
+	std::string fractionText;
+	std::uint32_t seconds = 0;
+	std::uint32_t microseconds = 0;
+	bool retVal;
+
+	if (std::string::npos != decimalPoint)
+	{
+		// Only microseconds are kept, so longer fractions are cut off and shorter ones are padded
+		fractionText = text.substr(decimalPoint + 1, MICROSECOND_DIGITS);
+		fractionText.append(MICROSECOND_DIGITS - fractionText.size(), '0');
+	}
+
+	retVal = ((parse_number(secondsText, 10, seconds)) &&
+	          ((std::string::npos == decimalPoint) ||
+	           ((parse_number(fractionText, 10, microseconds)) &&
+	            (std::string::npos == text.find_first_not_of("0123456789", decimalPoint + 1)))));
+
+	if (retVal)
+	{
+		timestamp_us = (static_cast<std::uint64_t>(seconds) * 1000000) + microseconds;
+	}
+	return retVal;
+}
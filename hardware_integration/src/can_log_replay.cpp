@@ -0,0 +1,96 @@
+//================================================================================================
+/// @file can_log_replay.cpp
+///
+/// @brief Feeds the frames from a recorded bus log through the CAN network manager, either at
+/// the pace they were recorded or as fast as possible, and measures how long each stage of
+/// processing takes. Useful for profiling the stack with realistic traffic.
+/// @author Adrian Del Grosso
+///
+/// @copyright 2022 Adrian Del Grosso
+//================================================================================================
+#include "isobus/hardware_integration/can_log_replay.hpp"
+
+#include "isobus/isobus/can_constants.hpp"
+#include "isobus/isobus/can_network_manager.hpp"
+#include "isobus/utility/system_timing.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+CANLogReplay::Statistics::Statistics() :
+  numberOfFrames(0),
+  numberSkippedFrames(0),
+  readTime_us(0),
+  receiveTime_us(0),
+  updateTime_us(0),
+  elapsedTime_us(0),
+  logDuration_us(0)
+{
+}
+
+bool CANLogReplay::replay(CANLogReader &reader, Timing timing, Statistics &statistics)
+{
+	const std::uint64_t replayStart_us = isobus::SystemTiming::get_timestamp_us();
+	isobus::HardwareInterfaceCANFrame frame;
+	std::uint64_t firstFrameTimestamp_us = 0;
+	std::uint64_t stageStart_us;
+	bool readFrame;
+
+	statistics = Statistics();
+
+	// The network manager drops frames until it has been updated once
+	isobus::CANNetworkManager::CANNetwork.update();
+
+	stageStart_us = isobus::SystemTiming::get_timestamp_us();
+	readFrame = reader.read_frame(frame);
+	statistics.readTime_us += isobus::SystemTiming::get_time_elapsed_us(stageStart_us);
+
+	if (readFrame)
+	{
+		firstFrameTimestamp_us = frame.timestamp_us;
+	}
+
+	while (readFrame)
+	{
+		const std::uint64_t logOffset_us = (frame.timestamp_us > firstFrameTimestamp_us) ? (frame.timestamp_us - firstFrameTimestamp_us) : 0;
+
+		statistics.logDuration_us = std::max(statistics.logDuration_us, logOffset_us);
+
+		if (Timing::Recorded == timing)
+		{
+			// Keep the stack's timers running while waiting for the frame's turn
+			while (!isobus::SystemTiming::time_expired_us(replayStart_us, logOffset_us))
+			{
+				const std::uint64_t remaining_us = logOffset_us - isobus::SystemTiming::get_time_elapsed_us(replayStart_us);
+
+				isobus::CANNetworkManager::CANNetwork.update();
+				std::this_thread::sleep_for(std::chrono::microseconds(std::min(remaining_us, static_cast<std::uint64_t>(MAXIMUM_WAIT_US))));
+			}
+		}
+
+		if (frame.channel < isobus::CAN_PORT_MAXIMUM)
+		{
+			// Stamp the frame like the hardware layer would when it's received
+			frame.timestamp_us = isobus::SystemTiming::get_timestamp_us();
+			stageStart_us = frame.timestamp_us;
+			isobus::CANNetworkManager::CANNetwork.can_lib_process_rx_message(frame, nullptr);
+			statistics.receiveTime_us += isobus::SystemTiming::get_time_elapsed_us(stageStart_us);
+
+			stageStart_us = isobus::SystemTiming::get_timestamp_us();
+			isobus::CANNetworkManager::CANNetwork.update();
+			statistics.updateTime_us += isobus::SystemTiming::get_time_elapsed_us(stageStart_us);
+			statistics.numberOfFrames++;
+		}
+		else
+		{
+			statistics.numberSkippedFrames++;
+		}
+
+		stageStart_us = isobus::SystemTiming::get_timestamp_us();
+		readFrame = reader.read_frame(frame);
+		statistics.readTime_us += isobus::SystemTiming::get_time_elapsed_us(stageStart_us);
+	}
+	statistics.elapsedTime_us = isobus::SystemTiming::get_time_elapsed_us(replayStart_us);
+	return (0 != statistics.numberOfFrames);
+}
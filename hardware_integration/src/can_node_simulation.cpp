@@ -0,0 +1,366 @@
+//================================================================================================
+/// @file can_node_simulation.cpp
+///
+/// @brief Generates the traffic of many scripted ECUs on a virtual CAN bus from one thread,
+/// so the stack can be tested against a busy network without any hardware.
+/// @author Adrian Del Grosso
+///
+/// @copyright 2022 Adrian Del Grosso
+//================================================================================================
+#include "isobus/hardware_integration/can_node_simulation.hpp"
+#include "isobus/isobus/can_general_parameter_group_numbers.hpp"
+#include "isobus/isobus/can_identifier.hpp"
+#include "isobus/utility/system_timing.hpp"
+
+#include <chrono>
+
+constexpr std::uint32_t CANNodeSimulation::ADDRESS_CLAIM_WAIT_MS;
+constexpr std::uint32_t CANNodeSimulation::IDLE_SLEEP_MS;
+
+CANNodeSimulation::Node::Node(const std::string &busName, std::uint64_t nodeNAME, std::uint8_t preferredAddress) :
+  plugin(busName),
+  NAME(nodeNAME),
+  claimedAddress(preferredAddress),
+  claimTimestamp_ms(0),
+  state(AddressState::NotStarted)
+{
+}
+
+CANNodeSimulation::CANNodeSimulation(const std::string &busName) :
+  bus(busName),
+  simulationThread(nullptr),
+  transmittedFrames(0),
+  receivedFrames(0),
+  running(false)
+{
+}
+
+CANNodeSimulation::~CANNodeSimulation()
+{
+	stop();
+}
+
+bool CANNodeSimulation::add_node(std::uint64_t NAME, std::uint8_t preferredAddress)
+{
+	bool retVal = false;
+
+	if ((!running) &&
+	    (preferredAddress < isobus::CANIdentifier::NULL_ADDRESS))
+	{
+		nodes.emplace_back(new Node(bus, NAME, preferredAddress));
+		retVal = true;
+	}
+	return retVal;
+}
+
+bool CANNodeSimulation::add_periodic_message(std::size_t nodeIndex, std::uint32_t parameterGroupNumber, std::uint8_t priority, const std::vector<std::uint8_t> &data, std::uint32_t interval_ms)
+{
+	bool retVal = false;
+
+	if ((!running) &&
+	    (nodeIndex < nodes.size()) &&
+	    (data.size() <= 8) &&
+	    (priority <= 7) &&
+	    (0 != interval_ms))
+	{
+		PeriodicMessage message;
+
+		message.parameterGroupNumber = parameterGroupNumber;
+		message.interval_ms = interval_ms;
+		message.lastSentTimestamp_ms = 0;
+		message.dataLength = static_cast<std::uint8_t>(data.size());
+		message.priority = priority;
+		for (std::uint8_t i = 0; i < message.dataLength; i++)
+		{
+			message.data[i] = data[i];
+		}
+		nodes[nodeIndex]->periodicMessages.push_back(message);
+		retVal = true;
+	}
+	return retVal;
+}
+
+bool CANNodeSimulation::start()
+{
+	bool retVal = false;
+
+	if (!running)
+	{
+		transmittedFrames.store(0, std::memory_order_relaxed);
+		receivedFrames.store(0, std::memory_order_relaxed);
+
+		// Every node joins the bus before any of them claims, so they all see each other's claims
+		for (auto &node : nodes)
+		{
+			node->plugin.open();
+		}
+		for (auto &node : nodes)
+		{
+			node->state = AddressState::WaitingForClaim;
+			send_address_claim(*node);
+		}
+		running = true;
+		simulationThread = new std::thread([this]() { simulation_thread_function(); });
+		retVal = true;
+	}
+	return retVal;
+}
+
+void CANNodeSimulation::stop()
+{
+	running = false;
+
+	if (nullptr != simulationThread)
+	{
+		simulationThread->join();
+		delete simulationThread;
+		simulationThread = nullptr;
+
+		for (auto &node : nodes)
+		{
+			node->plugin.close();
+			node->state = AddressState::NotStarted;
+		}
+	}
+}
+
+bool CANNodeSimulation::get_is_running() const
+{
+	return running;
+}
+
+std::size_t CANNodeSimulation::get_number_nodes() const
+{
+	return nodes.size();
+}
+
+CANNodeSimulation::AddressState CANNodeSimulation::get_address_state(std::size_t nodeIndex) const
+{
+	AddressState retVal = AddressState::NotStarted;
+
+	if (nodeIndex < nodes.size())
+	{
+		retVal = nodes[nodeIndex]->state;
+	}
+	return retVal;
+}
+
+std::uint8_t CANNodeSimulation::get_address(std::size_t nodeIndex) const
+{
+	std::uint8_t retVal = isobus::CANIdentifier::NULL_ADDRESS;
+
+	if (nodeIndex < nodes.size())
+	{
+		const AddressState state = nodes[nodeIndex]->state;
+
+		if ((AddressState::WaitingForClaim == state) ||
+		    (AddressState::Claimed == state))
+		{
+			retVal = nodes[nodeIndex]->claimedAddress;
+		}
+	}
+	return retVal;
+}
+
+std::uint64_t CANNodeSimulation::get_number_transmitted_frames() const
+{
+	return transmittedFrames.load(std::memory_order_relaxed);
+}
+
+std::uint64_t CANNodeSimulation::get_number_received_frames() const
+{
+	return receivedFrames.load(std::memory_order_relaxed);
+}
+
+void CANNodeSimulation::simulation_thread_function()
+{
+	while (running)
+	{
+		bool anyActivity = false;
+
+		for (auto &node : nodes)
+		{
+			isobus::HardwareInterfaceCANFrame frame;
+
+			while (node->plugin.poll_frame(frame))
+			{
+				receivedFrames.fetch_add(1, std::memory_order_relaxed);
+				process_frame(*node, frame);
+				anyActivity = true;
+			}
+		}
+
+		for (auto &node : nodes)
+		{
+			if (update_node(*node))
+			{
+				anyActivity = true;
+			}
+		}
+
+		if (!anyActivity)
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(IDLE_SLEEP_MS));
+		}
+	}
+}
+
+void CANNodeSimulation::process_frame(Node &node, const isobus::HardwareInterfaceCANFrame &frame)
+{
+	if (frame.isExtendedFrame)
+	{
+		const isobus::CANIdentifier identifier(frame.identifier);
+		const std::uint32_t parameterGroupNumber = identifier.get_parameter_group_number();
+		const AddressState state = node.state;
+
+		if ((static_cast<std::uint32_t>(isobus::CANLibParameterGroupNumber::AddressClaim) == parameterGroupNumber) &&
+		    (8 == frame.dataLength) &&
+		    (identifier.get_source_address() == node.claimedAddress) &&
+		    ((AddressState::WaitingForClaim == state) ||
+		     (AddressState::Claimed == state)))
+		{
+			std::uint64_t claimedNAME = 0;
+
+			for (std::uint8_t i = 0; i < 8; i++)
+			{
+				claimedNAME |= (static_cast<std::uint64_t>(frame.data[i]) << (8 * i));
+			}
+
+			// Another node wants our address, and the lower NAME keeps it
+			if (claimedNAME > node.NAME)
+			{
+				send_address_claim(node);
+			}
+			else if (claimedNAME < node.NAME)
+			{
+				node.state = AddressState::CannotClaim;
+				send_address_claim(node);
+			}
+		}
+		else if ((static_cast<std::uint32_t>(isobus::CANLibParameterGroupNumber::ParameterGroupNumberRequest) == parameterGroupNumber) &&
+		         (frame.dataLength >= 3) &&
+		         ((isobus::CANIdentifier::GLOBAL_ADDRESS == identifier.get_destination_address()) ||
+		          ((AddressState::Claimed == state) &&
+		           (node.claimedAddress == identifier.get_destination_address()))))
+		{
+			const std::uint32_t requestedParameterGroupNumber = (static_cast<std::uint32_t>(frame.data[0]) |
+			                                                     (static_cast<std::uint32_t>(frame.data[1]) << 8) |
+			                                                     (static_cast<std::uint32_t>(frame.data[2]) << 16));
+
+			if (static_cast<std::uint32_t>(isobus::CANLibParameterGroupNumber::AddressClaim) == requestedParameterGroupNumber)
+			{
+				send_address_claim(node);
+			}
+			else if (AddressState::Claimed == state)
+			{
+				for (const PeriodicMessage &message : node.periodicMessages)
+				{
+					if (requestedParameterGroupNumber == message.parameterGroupNumber)
+					{
+						send_message(node, message, identifier.get_source_address());
+					}
+				}
+			}
+		}
+	}
+}
+
+bool CANNodeSimulation::update_node(Node &node)
+{
+	bool retVal = false;
+
+	if ((AddressState::WaitingForClaim == node.state) &&
+	    (isobus::SystemTiming::time_expired_ms(node.claimTimestamp_ms, ADDRESS_CLAIM_WAIT_MS)))
+	{
+		const std::uint32_t currentTimestamp_ms = isobus::SystemTiming::get_timestamp_ms();
+
+		node.state = AddressState::Claimed;
+
+		// Spread the nodes' first messages over the time they take, rather than sending them all at once
+		for (PeriodicMessage &message : node.periodicMessages)
+		{
+			message.lastSentTimestamp_ms = currentTimestamp_ms - message.interval_ms + (node.claimedAddress % message.interval_ms);
+		}
+	}
+
+	if (AddressState::Claimed == node.state)
+	{
+		for (PeriodicMessage &message : node.periodicMessages)
+		{
+			if (isobus::SystemTiming::time_expired_ms(message.lastSentTimestamp_ms, message.interval_ms))
+			{
+				// Keep to the schedule instead of drifting by however late this update is
+				message.lastSentTimestamp_ms += message.interval_ms;
+				if (isobus::SystemTiming::time_expired_ms(message.lastSentTimestamp_ms, message.interval_ms))
+				{
+					message.lastSentTimestamp_ms = isobus::SystemTiming::get_timestamp_ms();
+				}
+				send_message(node, message, isobus::CANIdentifier::GLOBAL_ADDRESS);
+				retVal = true;
+			}
+		}
+	}
+	return retVal;
+}
+
+void CANNodeSimulation::send_address_claim(Node &node)
+{
+	std::uint8_t data[8];
+	std::uint8_t sourceAddress = node.claimedAddress;
+
+	for (std::uint8_t i = 0; i < 8; i++)
+	{
+		data[i] = static_cast<std::uint8_t>(node.NAME >> (8 * i));
+	}
+
+	if (AddressState::CannotClaim == node.state)
+	{
+		sourceAddress = isobus::CANIdentifier::NULL_ADDRESS;
+	}
+	else
+	{
+		node.claimTimestamp_ms = isobus::SystemTiming::get_timestamp_ms();
+	}
+	send_frame(node, build_identifier(6, static_cast<std::uint32_t>(isobus::CANLibParameterGroupNumber::AddressClaim), isobus::CANIdentifier::GLOBAL_ADDRESS, sourceAddress), data, 8);
+}
+
+void CANNodeSimulation::send_message(Node &node, const PeriodicMessage &message, std::uint8_t destinationAddress)
+{
+	send_frame(node, build_identifier(message.priority, message.parameterGroupNumber, destinationAddress, node.claimedAddress), message.data, message.dataLength);
+}
+
+void CANNodeSimulation::send_frame(Node &node, std::uint32_t identifier, const std::uint8_t *data, std::uint8_t dataLength)
+{
+	isobus::HardwareInterfaceCANFrame frame;
+
+	frame.timestamp_us = 0;
+	frame.identifier = identifier;
+	frame.channel = 0;
+	frame.isExtendedFrame = true;
+	frame.dataLength = dataLength;
+	for (std::uint8_t i = 0; i < 8; i++)
+	{
+		frame.data[i] = (i < dataLength) ? data[i] : 0xFF;
+	}
+
+	if (node.plugin.write_frame(frame))
+	{
+		transmittedFrames.fetch_add(1, std::memory_order_relaxed);
+	}
+}
+
+std::uint32_t CANNodeSimulation::build_identifier(std::uint8_t priority, std::uint32_t parameterGroupNumber, std::uint8_t destinationAddress, std::uint8_t sourceAddress)
+{
+	std::uint32_t retVal = ((static_cast<std::uint32_t>(priority & 0x07) << 26) | sourceAddress);
+
+	if (((parameterGroupNumber >> 8) & 0xFF) < 0xF0)
+	{
+		// Destination specific, so the PDU specific byte is the destination
+		retVal |= (((parameterGroupNumber & 0x3FF00) | destinationAddress) << 8);
+	}
+	else
+	{
+		retVal |= ((parameterGroupNumber & 0x3FFFF) << 8);
+	}
+	return retVal;
+}
@@ -26,6 +26,7 @@
 SocketCANInterface::SocketCANInterface(const std::string deviceName) :
   pCANDevice(new sockaddr_can),
   name(deviceName),
+  droppedFrames(0),
   fileDescriptor(-1)
 {
 	if (nullptr != pCANDevice)
@@ -63,6 +64,7 @@ void SocketCANInterface::close()
 
 void SocketCANInterface::open()
 {
+	droppedFrames.store(0, std::memory_order_relaxed);
 	fileDescriptor = socket(PF_CAN, SOCK_RAW, CAN_RAW);
 
 	if (fileDescriptor >= 0)
@@ -120,7 +122,8 @@ bool SocketCANInterface::read_frame(isobus::HardwareInterfaceCANFrame &canFrame)
 		struct msghdr message;
 		struct iovec segment;
 
-		char lControlMessage[CMSG_SPACE(sizeof(struct timeval) + (3 * sizeof(struct timespec)) + sizeof(std::uint32_t))];
+		// Room for a timestamp and the dropped frame count, which each come in their own control message
+		char lControlMessage[CMSG_SPACE(sizeof(struct timeval)) + CMSG_SPACE(3 * sizeof(struct timespec)) + CMSG_SPACE(sizeof(std::uint32_t))];
 
 		segment.iov_base = &txFrame;
 		segment.iov_len = sizeof(struct can_frame);
@@ -171,6 +174,15 @@ bool SocketCANInterface::read_frame(isobus::HardwareInterfaceCANFrame &canFrame)
 							canFrame.timestamp_us = (static_cast<std::uint64_t>(time[2].tv_nsec) / 1000) + (static_cast<std::uint64_t>(time[2].tv_sec) * 1000000);
 						}
 						break;
+
+						case SO_RXQ_OVFL:
+						{
+							// The kernel sends its running total for the socket
+							std::uint32_t droppedFrameCount;
+							memcpy(&droppedFrameCount, CMSG_DATA(pControlMessage), sizeof(droppedFrameCount));
+							droppedFrames.store(droppedFrameCount, std::memory_order_relaxed);
+						}
+						break;
 					}
 				}
 				retVal = true;
@@ -178,7 +190,7 @@ bool SocketCANInterface::read_frame(isobus::HardwareInterfaceCANFrame &canFrame)
 		}
 		else if (errno == ENETDOWN)
 		{
-			isobus::CANStackLogger::CAN_stack_log("[SocketCAN] " + get_device_name() + " interface is down.");
+			isobus::CANStackLogger::error("[SocketCAN] ", get_device_name(), " interface is down.");
 			close();
 		}
 	}
@@ -189,6 +201,11 @@ bool SocketCANInterface::read_frame(isobus::HardwareInterfaceCANFrame &canFrame)
 	return retVal;
 }
 
+std::uint32_t SocketCANInterface::get_number_dropped_frames() const
+{
+	return droppedFrames.load(std::memory_order_relaxed);
+}
+
 bool SocketCANInterface::write_frame(const isobus::HardwareInterfaceCANFrame &canFrame)
 {
 	struct can_frame txFrame;
@@ -209,7 +226,7 @@ bool SocketCANInterface::write_frame(const isobus::HardwareInterfaceCANFrame &ca
 	}
 	else if (errno == ENETDOWN)
 	{
-		isobus::CANStackLogger::CAN_stack_log("[SocketCAN] " + get_device_name() + " interface is down.");
+		isobus::CANStackLogger::error("[SocketCAN] ", get_device_name(), " interface is down.");
 		close();
 	}
 	return retVal;
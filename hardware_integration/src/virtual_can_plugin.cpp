@@ -0,0 +1,347 @@
+//================================================================================================
+/// @file virtual_can_plugin.cpp
+///
+/// @brief A CAN driver for a bus that only exists in memory.
+/// @author Adrian Del Grosso
+///
+/// @copyright 2022 Adrian Del Grosso
+//================================================================================================
+#include "isobus/hardware_integration/virtual_can_plugin.hpp"
+#include "isobus/isobus/can_bus_load.hpp"
+#include "isobus/utility/system_timing.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <random>
+#include <vector>
+
+//================================================================================================
+/// @class VirtualCANPlugin::Bus
+///
+/// @brief The state shared by all nodes on one virtual bus
+/// @details Frames are put on the bus lazily. Whenever a node reads or writes, the bus works out
+/// which frames would have won arbitration and finished sending by then, and delivers them.
+/// Everything here, including each node's frame queues, is protected by the bus mutex.
+//================================================================================================
+class VirtualCANPlugin::Bus
+{
+public:
+	/// @brief Constructor for a bus that delivers frames right away
+	Bus();
+
+	/// @brief Sends every frame whose turn on the bus started by the given time
+	/// @param[in] timestamp_us The current time in microseconds
+	void update(std::uint64_t timestamp_us);
+
+	/// @brief Gives a frame to every node except the sender, after the bus latency
+	/// @param[in] sender The node that sent the frame
+	/// @param[in] frame The frame that was sent
+	/// @param[in] timestamp_us The time the frame finished sending in microseconds
+	void deliver(const VirtualCANPlugin *sender, isobus::HardwareInterfaceCANFrame frame, std::uint64_t timestamp_us);
+
+	/// @brief Returns when the next queued frame can start sending
+	/// @returns A timestamp in microseconds, or the max value if no frames are queued
+	std::uint64_t get_next_transmit_timestamp() const;
+
+	/// @brief Returns how long a frame takes to send at the bus's bit rate
+	/// @details This includes the stuff bits the frame needs, so frames with the same length can take different times.
+	/// @param[in] frame The frame to measure
+	/// @returns The time the frame is on the bus in microseconds
+	std::uint64_t get_frame_time_us(const isobus::HardwareInterfaceCANFrame &frame) const;
+
+	/// @brief Returns the arbitration field of a frame, as a number where lower values win arbitration
+	/// @param[in] frame The frame to get the arbitration field of
+	/// @returns The base identifier, then the IDE bit, then the extended identifier bits
+	static std::uint32_t get_arbitration_field(const isobus::HardwareInterfaceCANFrame &frame);
+
+	std::mutex busMutex; ///< Protects the bus and the frame queues of its nodes
+	std::condition_variable busConditionVariable; ///< Wakes readers when frames are written or delivered
+	std::vector<VirtualCANPlugin *> nodes; ///< The nodes on the bus, in the order they were opened
+	std::mt19937 randomGenerator; ///< Decides which frames are lost
+	std::uint64_t busIdleTimestamp_us; ///< The time the frame on the bus finishes sending
+	std::uint64_t frameLossThreshold; ///< Frames are lost when a random 32 bit number is below this
+	std::uint32_t bitRate; ///< The emulated bit rate in bits per second, or 0 if frames aren't timed
+	std::uint32_t latency_us; ///< The delay between a frame finishing and it being read
+};
+
+VirtualCANPlugin::Bus::Bus() :
+  busIdleTimestamp_us(0),
+  frameLossThreshold(0),
+  bitRate(0),
+  latency_us(0)
+{
+}
+
+void VirtualCANPlugin::Bus::update(std::uint64_t timestamp_us)
+{
+	std::uint64_t startTimestamp_us = get_next_transmit_timestamp();
+
+	while (startTimestamp_us <= timestamp_us)
+	{
+		VirtualCANPlugin *winner = nullptr;
+
+		// Only the oldest frame from each node takes part, as each node sends its frames in order
+		for (auto node : nodes)
+		{
+			if ((!node->transmitFrames.empty()) &&
+			    (node->transmitFrames.front().timestamp_us <= startTimestamp_us) &&
+			    ((nullptr == winner) ||
+			     (get_arbitration_field(node->transmitFrames.front()) < get_arbitration_field(winner->transmitFrames.front()))))
+			{
+				winner = node;
+			}
+		}
+
+		isobus::HardwareInterfaceCANFrame frame = winner->transmitFrames.front();
+		winner->transmitFrames.pop_front();
+		busIdleTimestamp_us = startTimestamp_us + get_frame_time_us(frame);
+		deliver(winner, frame, busIdleTimestamp_us);
+		startTimestamp_us = get_next_transmit_timestamp();
+	}
+}
+
+void VirtualCANPlugin::Bus::deliver(const VirtualCANPlugin *sender, isobus::HardwareInterfaceCANFrame frame, std::uint64_t timestamp_us)
+{
+	frame.timestamp_us = timestamp_us + latency_us;
+
+	for (auto node : nodes)
+	{
+		if (sender != node)
+		{
+			if ((0 == frameLossThreshold) ||
+			    (randomGenerator() >= frameLossThreshold))
+			{
+				node->receivedFrames.push_back(frame);
+			}
+			else
+			{
+				node->droppedFrames.fetch_add(1, std::memory_order_relaxed);
+			}
+		}
+	}
+	busConditionVariable.notify_all();
+}
+
+std::uint64_t VirtualCANPlugin::Bus::get_next_transmit_timestamp() const
+{
+	std::uint64_t retVal = std::numeric_limits<std::uint64_t>::max();
+
+	for (auto node : nodes)
+	{
+		if (!node->transmitFrames.empty())
+		{
+			retVal = std::min(retVal, std::max(node->transmitFrames.front().timestamp_us, busIdleTimestamp_us));
+		}
+	}
+	return retVal;
+}
+
+std::uint64_t VirtualCANPlugin::Bus::get_frame_time_us(const isobus::HardwareInterfaceCANFrame &frame) const
+{
+	return isobus::CANBusLoad::get_bit_time_us(isobus::CANBusLoad::get_frame_bit_length(frame), bitRate);
+}
+
+std::uint32_t VirtualCANPlugin::Bus::get_arbitration_field(const isobus::HardwareInterfaceCANFrame &frame)
+{
+	std::uint32_t retVal;
+
+	// A standard frame beats an extended one with the same base identifier, because its IDE bit is dominant
+	if (frame.isExtendedFrame)
+	{
+		retVal = ((((frame.identifier >> 18) & 0x7FF) << 19) | (1 << 18) | (frame.identifier & 0x3FFFF));
+	}
+	else
+	{
+		retVal = ((frame.identifier & 0x7FF) << 19);
+	}
+	return retVal;
+}
+
+VirtualCANPlugin::VirtualCANPlugin(const std::string busName) :
+  name(busName),
+  bus(get_bus(busName)),
+  droppedFrames(0),
+  connected(false)
+{
+}
+
+VirtualCANPlugin::~VirtualCANPlugin()
+{
+	close();
+}
+
+bool VirtualCANPlugin::get_is_valid() const
+{
+	const std::lock_guard<std::mutex> lock(bus->busMutex);
+	return connected;
+}
+
+std::string VirtualCANPlugin::get_bus_name() const
+{
+	return name;
+}
+
+void VirtualCANPlugin::close()
+{
+	const std::lock_guard<std::mutex> lock(bus->busMutex);
+
+	if (connected)
+	{
+		auto nodeLocation = std::find(bus->nodes.begin(), bus->nodes.end(), this);
+
+		if (bus->nodes.end() != nodeLocation)
+		{
+			bus->nodes.erase(nodeLocation);
+		}
+		transmitFrames.clear();
+		receivedFrames.clear();
+		connected = false;
+
+		// Let a pending read_frame see that we're closed
+		bus->busConditionVariable.notify_all();
+	}
+}
+
+void VirtualCANPlugin::open()
+{
+	const std::lock_guard<std::mutex> lock(bus->busMutex);
+
+	if (!connected)
+	{
+		bus->nodes.push_back(this);
+		droppedFrames.store(0, std::memory_order_relaxed);
+		connected = true;
+	}
+}
+
+bool VirtualCANPlugin::read_frame(isobus::HardwareInterfaceCANFrame &canFrame)
+{
+	return wait_for_frame(canFrame, READ_TIMEOUT_MS * 1000);
+}
+
+bool VirtualCANPlugin::poll_frame(isobus::HardwareInterfaceCANFrame &canFrame)
+{
+	return wait_for_frame(canFrame, 0);
+}
+
+bool VirtualCANPlugin::wait_for_frame(isobus::HardwareInterfaceCANFrame &canFrame, std::uint32_t timeout_us)
+{
+	std::unique_lock<std::mutex> lock(bus->busMutex);
+	const std::uint64_t timeoutTimestamp_us = isobus::SystemTiming::get_timestamp_us() + timeout_us;
+	bool retVal = false;
+	bool waiting = connected;
+
+	while (waiting)
+	{
+		const std::uint64_t currentTimestamp_us = isobus::SystemTiming::get_timestamp_us();
+
+		bus->update(currentTimestamp_us);
+
+		if ((!receivedFrames.empty()) &&
+		    (receivedFrames.front().timestamp_us <= currentTimestamp_us))
+		{
+			canFrame = receivedFrames.front();
+			receivedFrames.pop_front();
+			retVal = true;
+			waiting = false;
+		}
+		else if ((!connected) ||
+		         (currentTimestamp_us >= timeoutTimestamp_us))
+		{
+			waiting = false;
+		}
+		else
+		{
+			// Wake up for whichever comes first: a frame becoming readable, the bus being free for the next frame, or the timeout
+			std::uint64_t wakeTimestamp_us = std::min(timeoutTimestamp_us, bus->get_next_transmit_timestamp());
+
+			if (!receivedFrames.empty())
+			{
+				wakeTimestamp_us = std::min(wakeTimestamp_us, receivedFrames.front().timestamp_us);
+			}
+			bus->busConditionVariable.wait_for(lock, std::chrono::microseconds(wakeTimestamp_us - currentTimestamp_us));
+		}
+	}
+	return retVal;
+}
+
+bool VirtualCANPlugin::write_frame(const isobus::HardwareInterfaceCANFrame &canFrame)
+{
+	const std::lock_guard<std::mutex> lock(bus->busMutex);
+	bool retVal = false;
+
+	if (connected)
+	{
+		const std::uint64_t currentTimestamp_us = isobus::SystemTiming::get_timestamp_us();
+		isobus::HardwareInterfaceCANFrame frame = canFrame;
+
+		frame.timestamp_us = currentTimestamp_us;
+
+		if (0 == bus->bitRate)
+		{
+			bus->deliver(this, frame, currentTimestamp_us);
+		}
+		else
+		{
+			// Frames that were already waiting get their turn first if the bus was free before now
+			bus->update(currentTimestamp_us);
+			transmitFrames.push_back(frame);
+			bus->update(currentTimestamp_us);
+			bus->busConditionVariable.notify_all();
+		}
+		retVal = true;
+	}
+	return retVal;
+}
+
+std::uint32_t VirtualCANPlugin::get_number_dropped_frames() const
+{
+	return droppedFrames.load(std::memory_order_relaxed);
+}
+
+void VirtualCANPlugin::set_bus_bit_rate(const std::string &busName, std::uint32_t bitRate)
+{
+	std::shared_ptr<Bus> bus = get_bus(busName);
+	const std::lock_guard<std::mutex> lock(bus->busMutex);
+
+	// Send anything still queued at the old rate, so no frames are stuck if timing is turned off
+	bus->update(std::numeric_limits<std::uint64_t>::max() - 1);
+	bus->bitRate = bitRate;
+}
+
+void VirtualCANPlugin::set_bus_latency(const std::string &busName, std::uint32_t latency_us)
+{
+	std::shared_ptr<Bus> bus = get_bus(busName);
+	const std::lock_guard<std::mutex> lock(bus->busMutex);
+
+	bus->latency_us = latency_us;
+}
+
+void VirtualCANPlugin::set_bus_frame_loss(const std::string &busName, float lossProbability, std::uint32_t seed)
+{
+	std::shared_ptr<Bus> bus = get_bus(busName);
+	const std::lock_guard<std::mutex> lock(bus->busMutex);
+
+	lossProbability = std::min(std::max(lossProbability, 0.0f), 1.0f);
+	bus->frameLossThreshold = static_cast<std::uint64_t>(static_cast<double>(lossProbability) * 4294967296.0);
+	bus->randomGenerator.seed(seed);
+}
+
+std::shared_ptr<VirtualCANPlugin::Bus> VirtualCANPlugin::get_bus(const std::string &busName)
+{
+	// Created on first use, so that plugins can be static objects too
+	static std::mutex busesMutex;
+	static std::map<std::string, std::shared_ptr<Bus>> buses;
+	const std::lock_guard<std::mutex> lock(busesMutex);
+	std::shared_ptr<Bus> &retVal = buses[busName];
+
+	if (nullptr == retVal)
+	{
+		retVal = std::make_shared<Bus>();
+	}
+	return retVal;
+}
@@ -15,6 +15,7 @@
 namespace isobus
 {
 	class CANMessage; ///< Forward declare CANMessage
+	class CANNetworkManager; ///< Forward declare CANNetworkManager
 
 	//================================================================================================
 	/// @class AddressClaimStateMachine
@@ -46,7 +47,8 @@ namespace isobus
 		/// @param[in] preferredAddressValue The address you prefer to claim
 		/// @param[in] ControlFunctionNAME The NAME you want to claim
 		/// @param[in] portIndex The CAN channel index to claim on
-		AddressClaimStateMachine(std::uint8_t preferredAddressValue, NAME ControlFunctionNAME, std::uint8_t portIndex);
+		/// @param[in] parentNetworkManager The network manager to claim with
+		AddressClaimStateMachine(std::uint8_t preferredAddressValue, NAME ControlFunctionNAME, std::uint8_t portIndex, CANNetworkManager &parentNetworkManager);
 
 		/// @brief The destructor for the address claim state machine
 		~AddressClaimStateMachine();
@@ -86,6 +88,7 @@ namespace isobus
 		/// @param[in] address The address to claim
 		bool send_address_claim(std::uint8_t address);
 
+		CANNetworkManager &m_networkManager; ///< The network manager to claim with
 		NAME m_isoname; ///< The ISO NAME to claim as
 		State m_currentState; ///< The address claim state machine state
 		std::uint32_t m_timestamp_ms; ///< A generic timestamp in milliseconds used to find timeouts
@@ -0,0 +1,131 @@
+//================================================================================================
+/// @file can_bus_load.hpp
+///
+/// @brief Works out exactly how many bits a frame takes on the bus, including stuff bits, and
+/// estimates how busy a bus is and how much room is left on it from the frames seen on it.
+/// @author Adrian Del Grosso
+///
+/// @copyright 2022 Adrian Del Grosso
+//================================================================================================
+#ifndef CAN_BUS_LOAD_HPP
+#define CAN_BUS_LOAD_HPP
+
+#include "isobus/isobus/can_frame.hpp"
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace isobus
+{
+	//================================================================================================
+	/// @class CANBusLoad
+	///
+	/// @brief Estimates the load on one CAN bus from the frames sent and received on it
+	/// @details Each frame is counted with its exact length on the wire, which is the frame itself,
+	/// the stuff bits the CAN controller has to add to it, and the interframe space. The load is
+	/// the bits seen over the last `WINDOW_MS`, which slides in steps of `SLOT_MS`, so it follows
+	/// changes in traffic within a fraction of a second.
+	///
+	/// The headroom is how much more traffic fits before the bus reaches its maximum load, which
+	/// protocols can use to decide whether to speed up or slow down a transfer.
+	///
+	/// Counting a frame doesn't take a lock. Each slot holds which slot it is along with its bits
+	/// in one atomic, so a slot that's reused for a later time starts over, and reads only add up
+	/// the slots that belong to the window.
+	//================================================================================================
+	class CANBusLoad
+	{
+	public:
+		/// @brief Constructor for a bus with no traffic, at the default bit rate
+		CANBusLoad();
+
+		/// @brief Sets the bit rate of the bus
+		/// @param[in] bitRate The bit rate in bits per second, like 250000
+		void set_bit_rate(std::uint32_t bitRate);
+
+		/// @brief Returns the bit rate of the bus
+		/// @returns The bit rate in bits per second
+		std::uint32_t get_bit_rate() const;
+
+		/// @brief Sets the load the bus should be kept under, which the headroom is measured to
+		/// @param[in] percent The maximum load in percent, from 0 to 100
+		void set_maximum_bus_load(float percent);
+
+		/// @brief Returns the load the bus should be kept under
+		/// @returns The maximum load in percent
+		float get_maximum_bus_load() const;
+
+		/// @brief Counts a frame that was sent or received on the bus
+		/// @param[in] frame The frame
+		void add_frame(const HardwareInterfaceCANFrame &frame);
+
+		/// @brief Counts a frame whose length on the bus is already known
+		/// @param[in] frameBits The length of the frame from `get_frame_bit_length`
+		void add_frame_bits(std::uint32_t frameBits);
+
+		/// @brief Returns the load on the bus over the last `WINDOW_MS`
+		/// @returns The time the bus was busy, in percent
+		float get_bus_load() const;
+
+		/// @brief Returns how far the bus is under its maximum load
+		/// @returns The maximum load minus the current load in percent, or 0 if the bus is at or over the maximum
+		float get_headroom() const;
+
+		/// @brief Returns how much more traffic fits on the bus before it reaches its maximum load
+		/// @returns The spare capacity in bits per second
+		std::uint32_t get_headroom_bits_per_second() const;
+
+		/// @brief Forgets all the traffic that's been seen
+		void reset();
+
+		/// @brief Returns the number of bits a frame takes on the bus
+		/// @details This is every bit from the start of frame to the end of frame, the stuff bits
+		/// in the start of frame to CRC that the frame's contents need, and the 3 bit interframe space.
+		/// @param[in] frame The frame to measure
+		/// @returns The length of the frame in bits
+		static std::uint32_t get_frame_bit_length(const HardwareInterfaceCANFrame &frame);
+
+		/// @brief Returns the most bits a frame with a given length could take on the bus
+		/// @details This assumes the most stuff bits the frame could possibly need, which is one
+		/// for every 4 bits after the first in the part of the frame that is stuffed.
+		/// @param[in] isExtendedFrame `true` for an extended identifier, `false` for a standard one
+		/// @param[in] dataLength The number of data bytes, up to 8
+		/// @returns The longest the frame can be in bits
+		static std::uint32_t get_worst_case_frame_bit_length(bool isExtendedFrame, std::uint8_t dataLength);
+
+		/// @brief Returns how long a number of bits takes to send
+		/// @param[in] bitLength The number of bits
+		/// @param[in] bitRate The bit rate in bits per second
+		/// @returns The time in microseconds, rounded up, or 0 if the bit rate is 0
+		static std::uint64_t get_bit_time_us(std::uint64_t bitLength, std::uint32_t bitRate);
+
+		static constexpr std::uint32_t DEFAULT_BIT_RATE = 250000; ///< The ISO 11783 bit rate
+		static constexpr float DEFAULT_MAXIMUM_BUS_LOAD = 80.0f; ///< A common design limit, which leaves time for the lowest priority frames to win arbitration
+		static constexpr std::uint32_t SLOT_MS = 100; ///< How often the load estimate moves forward
+		static constexpr std::uint32_t WINDOW_MS = 1000; ///< How far back the load estimate looks
+		static constexpr std::uint32_t FRAME_UNSTUFFED_BITS = 13; ///< The CRC delimiter, ACK, end of frame and interframe space bits, which are never stuffed
+		static constexpr std::uint32_t STANDARD_FRAME_STUFFED_BITS = 34; ///< The bits from start of frame to CRC in a standard frame with no data
+		static constexpr std::uint32_t EXTENDED_FRAME_STUFFED_BITS = 54; ///< The bits from start of frame to CRC in an extended frame with no data
+
+	private:
+		static constexpr std::uint32_t NUMBER_OF_SLOTS = WINDOW_MS / SLOT_MS; ///< The number of full slots in the window
+		static constexpr std::uint32_t SLOT_NUMBER_SHIFT = 32; ///< Where a slot's number is kept in its atomic, above its bits
+
+		/// @brief Returns the slot the current time falls in
+		/// @returns The time divided by `SLOT_MS`, counted from when the program started
+		static std::uint64_t get_current_slot_number();
+
+		/// @brief Returns the load over the full slots before a slot
+		/// @param[in] currentSlotNumber The slot that's filling, which isn't counted yet
+		/// @returns The load in percent
+		float get_bus_load_before_slot(std::uint64_t currentSlotNumber) const;
+
+		std::array<std::atomic<std::uint64_t>, NUMBER_OF_SLOTS + 1> slots; ///< The number of each slot of the window and the slot that's filling, above the bits seen in it
+		std::atomic<std::uint64_t> firstSlotNumber; ///< The slot the estimator started or was reset in, so a window that isn't full yet isn't diluted
+		std::atomic<std::uint32_t> bitRate; ///< The bit rate in bits per second
+		std::atomic<float> maximumBusLoad; ///< The load in percent that the headroom is measured to
+	};
+} // namespace isobus
+
+#endif // CAN_BUS_LOAD_HPP
@@ -53,6 +53,10 @@ namespace isobus
 	                                                    ControlFunction *requestingControlFunction,
 	                                                    std::uint32_t repetitionRate,
 	                                                    void *parentPointer);
+	/// @brief A callback used by the PGN request protocol's scheduler to transmit a cyclic PGN
+	typedef bool (*PeriodicTransmitCallback)(std::uint32_t parameterGroupNumber,
+	                                         ControlFunction *destinationControlFunction,
+	                                         void *parentPointer);
 
 	//================================================================================================
 	/// @class ParameterGroupNumberCallbackData
@@ -14,6 +14,8 @@
 
 namespace isobus
 {
+	class CANNetworkManager;
+
 	//================================================================================================
 	/// @class ControlFunction
 	///
@@ -30,12 +32,19 @@ namespace isobus
 			Partnered ///< An external control function that you explicitly want to talk to
 		};
 
-		/// @brief The base class constructor for a control function
+		/// @brief The base class constructor for a control function on the default network manager
 		/// @param[in] NAMEValue The NAME of the control function
 		/// @param[in] addressValue The current address of the control function
 		/// @param[in] CANPort The CAN channel index that the control function communicates on
 		ControlFunction(NAME NAMEValue, std::uint8_t addressValue, std::uint8_t CANPort);
 
+		/// @brief The base class constructor for a control function
+		/// @param[in] NAMEValue The NAME of the control function
+		/// @param[in] addressValue The current address of the control function
+		/// @param[in] CANPort The CAN channel index that the control function communicates on
+		/// @param[in] parentNetworkManager The network manager of the stack the control function belongs to
+		ControlFunction(NAME NAMEValue, std::uint8_t addressValue, std::uint8_t CANPort, CANNetworkManager &parentNetworkManager);
+
 		/// @brief The base class destructor for a control function
 		virtual ~ControlFunction();
 
@@ -59,8 +68,13 @@ namespace isobus
 		/// @returns The control function type
 		Type get_type() const;
 
+		/// @brief Returns the network manager of the stack the control function belongs to
+		/// @returns The control function's network manager
+		CANNetworkManager &get_network_manager() const;
+
 	protected:
 		friend class CANNetworkManager;
+		CANNetworkManager &networkManager; ///< The network manager of the stack the control function belongs to
 		NAME controlFunctionNAME; ///< The NAME of the control function
 		Type controlFunctionType; ///< The Type of the control function
 		std::uint8_t address; ///< The address of the control function
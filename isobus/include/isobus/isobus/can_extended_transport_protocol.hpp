@@ -16,6 +16,7 @@
 #include "isobus/isobus/can_managed_message.hpp"
 #include "isobus/isobus/can_network_manager.hpp"
 #include "isobus/isobus/can_protocol.hpp"
+#include "isobus/isobus/can_protocol_statistics.hpp"
 
 namespace isobus
 {
@@ -100,6 +101,7 @@ namespace isobus
 			DataChunkCallback frameChunkCallback; ///< A callback that might be used to get chunks of data to send
 			void *parent; ///< A generic context variable that helps identify what object callbacks are destined for. Can be nullptr
 			std::uint32_t timestamp_ms; ///< A timestamp used to track session timeouts
+			const std::uint32_t sessionStartTimestamp_ms; ///< When the session was created, used to measure how long it takes
 			std::uint32_t lastPacketNumber; ///< The last processed sequence number for this set of packets
 			std::uint32_t packetCount; ///< The total number of packets to receive or send in this session
 			std::uint32_t processedPacketsThisSession; ///< The total processed packet count for the whole session so far
@@ -107,12 +109,13 @@ namespace isobus
 		};
 
 		/// @brief The constructor for the TransportProtocolManager
-		ExtendedTransportProtocolManager();
+		/// @param[in] parentNetworkManager The network manager that owns the protocol
+		explicit ExtendedTransportProtocolManager(CANNetworkManager &parentNetworkManager);
 
 		/// @brief The destructor for the TransportProtocolManager
 		virtual ~ExtendedTransportProtocolManager();
 
-		static ExtendedTransportProtocolManager Protocol; ///< Static instance of the protocol manager
+		static ExtendedTransportProtocolManager &Protocol; ///< The protocol manager of the default network manager
 
 		/// @brief The protocol's initializer function
 		void initialize(CANLibBadge<CANNetworkManager>) override;
@@ -145,10 +148,32 @@ namespace isobus
 		                               void *parentPointer,
 		                               DataChunkCallback frameChunkCallback) override;
 
+		/// @brief The network manager calls this to see if the protocol can accept a long, shared CAN message for processing
+		/// @details The session references the shared payload until it is closed instead of copying it.
+		/// @param[in] parameterGroupNumber The PGN of the message
+		/// @param[in] data The shared payload to be sent
+		/// @param[in] source The source control function
+		/// @param[in] destination The destination control function
+		/// @param[in] transmitCompleteCallback A callback for when the protocol completes its work
+		/// @param[in] parentPointer A generic context object for the tx complete callback
+		/// @returns true if the message was accepted by the protocol for processing
+		bool protocol_transmit_shared_message(std::uint32_t parameterGroupNumber,
+		                                      std::shared_ptr<const std::vector<std::uint8_t>> data,
+		                                      ControlFunction *source,
+		                                      ControlFunction *destination,
+		                                      TransmitCompleteCallback transmitCompleteCallback,
+		                                      void *parentPointer) override;
+
 		/// @brief Updates the protocol cyclically
 		void update(CANLibBadge<CANNetworkManager>) override;
 
+		/// @brief Returns the counters for the sessions, aborts and retransmits of the default network manager's protocol
+		/// @details Aborts are indexed by `ConnectionAbortReason`.
+		/// @returns The statistics for the protocol
+		static const ProtocolStatistics &get_statistics();
+
 	private:
+		static constexpr std::uint32_t MIN_PROTOCOL_DATA_LENGTH = 1786; ///< The min payload this protocol sends, shorter messages use TP
 		static constexpr std::uint32_t MAX_PROTOCOL_DATA_LENGTH = CANMessage::ABSOLUTE_MAX_MESSAGE_LENGTH; ///< The max payload this protocol can support
 		static constexpr std::uint32_t TR_TIMEOUT_MS = 200; ///< The Tr timeout as defined by the standard
 		static constexpr std::uint32_t T1_TIMEOUT_MS = 750; ///< The t1 timeout as defined by the standard
@@ -179,6 +204,24 @@ namespace isobus
 		/// @param[in] session The session to close
 		void close_session(ExtendedTransportProtocolSession *session);
 
+		/// @brief Creates a new transmit session if the message can be sent with this protocol
+		/// @details The caller is responsible for setting the session's data and adding it to the active sessions.
+		/// @param[in] parameterGroupNumber The PGN of the message
+		/// @param[in] messageLength The length of the data to be sent
+		/// @param[in] source The source control function
+		/// @param[in] destination The destination control function
+		/// @param[in] sessionCompleteCallback A callback for when the protocol completes its work
+		/// @param[in] parentPointer A generic context object for the tx complete and chunk callbacks
+		/// @param[in] frameChunkCallback A callback to get some data to send
+		/// @returns The new session, or nullptr if the message can't be sent with this protocol
+		ExtendedTransportProtocolSession *create_transmit_session(std::uint32_t parameterGroupNumber,
+		                                                          std::uint32_t messageLength,
+		                                                          ControlFunction *source,
+		                                                          ControlFunction *destination,
+		                                                          TransmitCompleteCallback sessionCompleteCallback,
+		                                                          void *parentPointer,
+		                                                          DataChunkCallback frameChunkCallback);
+
 		/// @brief Gets an ETP session from the passed in source and destination combination
 		/// @param[in] source The source control function for the session
 		/// @param[in] destination The destination control function for the session
@@ -192,6 +235,15 @@ namespace isobus
 		/// @param[out] session The found session, or nullptr if no session matched the supplied parameters
 		bool get_session(ExtendedTransportProtocolSession *&session, ControlFunction *source, ControlFunction *destination, std::uint32_t parameterGroupNumber);
 
+		/// @brief Returns which direction a session counts as in the protocol's statistics
+		/// @param[in] session The session to check
+		/// @returns The direction of the session
+		static ProtocolStatistics::Direction get_statistics_direction(const ExtendedTransportProtocolSession *session);
+
+		/// @brief Counts a session that finished transferring all its data in the protocol's statistics
+		/// @param[in] session The session that completed
+		void record_session_completed(const ExtendedTransportProtocolSession *session);
+
 		/// @brief Processes end of session callbacks
 		/// @param[in] session The session we've just completed
 		/// @param[in] success Denotes if the session was successful
@@ -227,6 +279,7 @@ namespace isobus
 		void update_state_machine(ExtendedTransportProtocolSession *session);
 
 		std::vector<ExtendedTransportProtocolSession *> activeSessions; ///< A list of all active TP sessions
+		ProtocolStatistics statistics; ///< Counters for the sessions, aborts and retransmits of the protocol
 	};
 
 } // namespace isobus
@@ -32,12 +32,19 @@ namespace isobus
 	class InternalControlFunction : public ControlFunction
 	{
 	public:
-		/// @brief Constructor for an internal control function
+		/// @brief Constructor for an internal control function on the default network manager
 		/// @param[in] desiredName The NAME for this control function to claim as
 		/// @param[in] preferredAddress The preferred NAME for this control function
 		/// @param[in] CANPort The CAN channel index for this control function to use
 		InternalControlFunction(NAME desiredName, std::uint8_t preferredAddress, std::uint8_t CANPort);
 
+		/// @brief Constructor for an internal control function
+		/// @param[in] desiredName The NAME for this control function to claim as
+		/// @param[in] preferredAddress The preferred NAME for this control function
+		/// @param[in] CANPort The CAN channel index for this control function to use
+		/// @param[in] parentNetworkManager The network manager of the stack this control function claims and sends with
+		InternalControlFunction(NAME desiredName, std::uint8_t preferredAddress, std::uint8_t CANPort, CANNetworkManager &parentNetworkManager);
+
 		/// @brief Destructor for an internal control function
 		~InternalControlFunction();
 
@@ -49,27 +56,15 @@ namespace isobus
 		/// @brief Returns the number of internal control functions that exist
 		static std::uint32_t get_number_internal_control_functions();
 
-		/// @brief Lets network manager know a control function changed address recently
-		/// @details These tell the network manager when the address table needs to be explicitly
-		/// updated for an internal control function claiming a new address.
+		/// @brief Updates the address claim state machine, should be called periodically by the network manager
+		/// @details Each network manager only updates the internal control functions that belong to it.
 		/// Other CF types are handled in Rx message processing.
-		static bool get_any_internal_control_function_changed_address(CANLibBadge<CANNetworkManager>);
-
-		/// @brief Used to determine if the internal control function changed address since the last network manager update
-		/// @returns true if the ICF changed address since the last network manager update
-		bool get_changed_address_since_last_update(CANLibBadge<CANNetworkManager>) const;
-
-		/// @brief Updates all address claim state machines
-		static void update_address_claiming(CANLibBadge<CANNetworkManager>);
+		/// @returns true if the ICF changed address, which means the address table needs to be explicitly updated
+		bool update_address_claiming(CANLibBadge<CANNetworkManager>);
 
 	private:
-		/// @brief Updates the internal control function, should be called periodically by the network manager
-		void update();
-
 		static std::list<InternalControlFunction *> internalControlFunctionList; ///< A list of all internal control functions that exist
-		static bool anyChangedAddress; ///< Lets the network manager know if any ICF changed address since the last update
 		AddressClaimStateMachine stateMachine; ///< The address claimer for this ICF
-		bool objectChangedAddressSinceLastUpdate; ///< Tracks if this object has changed address since the last update
 	};
 
 } // namespace isobus
@@ -0,0 +1,132 @@
+//================================================================================================
+/// @file can_latency_profiler.hpp
+///
+/// @brief Measures how long frames and messages spend in each stage between the driver and the
+/// application's callbacks, and between sending and the driver, with a histogram per PGN.
+/// Useful for showing that safety relevant messages meet their latency budgets.
+/// @author Adrian Del Grosso
+///
+/// @copyright 2022 Adrian Del Grosso
+//================================================================================================
+#ifndef CAN_LATENCY_PROFILER_HPP
+#define CAN_LATENCY_PROFILER_HPP
+
+#include "isobus/isobus/can_protocol_statistics.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <ostream>
+#include <vector>
+
+namespace isobus
+{
+	class CANMessage;
+
+	//================================================================================================
+	/// @class CANLatencyProfiler
+	///
+	/// @brief Latency histograms in microseconds for each stage a frame or message passes through
+	/// @details Profiling is off by default, and when it's off each stage costs one atomic load.
+	/// When it's on, each stage stamps the frame or message as it goes in, and adds how long it
+	/// took to the histogram for its PGN when it comes out. Frames with standard identifiers
+	/// have no PGN, so they aren't profiled.
+	///
+	/// The receive path is `ChannelQueue`, then `StackQueue`, then `Callback`, with `Reassembly`
+	/// between them for messages from the transport protocols. Each stage is measured on its own,
+	/// so the sum of the stages' percentiles is an upper bound for the end to end percentile.
+	///
+	/// The first time a PGN is seen, its histograms are allocated under a lock. They're never
+	/// freed, so the pointers from `get_histogram` stay valid.
+	//================================================================================================
+	class CANLatencyProfiler
+	{
+	public:
+		/// @brief The stages that are timed
+		enum class Stage : std::uint8_t
+		{
+			ChannelQueue = 0, ///< From the driver reading a frame to the CAN thread giving it to the Rx callbacks, which is the hardware interface's channel queue
+			StackQueue = 1, ///< From the network manager receiving a frame to it being processed in the next update
+			Reassembly = 2, ///< From the first frame of a transport session being received to the whole message being passed on
+			Callback = 3, ///< From the network manager receiving the frame that completes a message to a global or partnered callback being called with it
+			TransmitQueue = 4, ///< From the stack handing a frame to the hardware interface to the driver writing it
+			NumberOfStages = 5 ///< The number of stages
+		};
+
+		static constexpr std::uint8_t NUMBER_OF_STAGES = static_cast<std::uint8_t>(Stage::NumberOfStages); ///< The number of stages that are timed
+		static constexpr std::uint64_t NO_TIMESTAMP = std::numeric_limits<std::uint64_t>::max(); ///< Returned by `get_timestamp_us` when profiling is off
+
+		/// @brief Turns profiling on or off
+		/// @param[in] enable `true` to start timing stages, `false` to stop
+		static void set_enabled(bool enable);
+
+		/// @brief Returns if profiling is on
+		/// @returns `true` if stages are being timed, otherwise `false`
+		static bool get_enabled()
+		{
+			return enabled.load(std::memory_order_relaxed);
+		}
+
+		/// @brief Returns a timestamp to stamp something with as it enters a stage, but only if profiling is on
+		/// @returns The current time in microseconds, or `NO_TIMESTAMP` if profiling is off
+		static std::uint64_t get_timestamp_us();
+
+		/// @brief Adds the time since a frame or message entered a stage to its PGN's histogram, if profiling is on
+		/// @param[in] stage The stage that's finished
+		/// @param[in] parameterGroupNumber The PGN of the frame or message
+		/// @param[in] startTimestamp_us When it entered the stage, from `SystemTiming::get_timestamp_us`, or `NO_TIMESTAMP` if it wasn't stamped
+		static void record_latency(Stage stage, std::uint32_t parameterGroupNumber, std::uint64_t startTimestamp_us)
+		{
+			if ((get_enabled()) &&
+			    (NO_TIMESTAMP != startTimestamp_us))
+			{
+				add_sample(stage, parameterGroupNumber, startTimestamp_us);
+			}
+		}
+
+		/// @brief Adds the time since a frame entered a stage to the histogram of the frame's PGN, if profiling is on
+		/// @param[in] stage The stage that's finished
+		/// @param[in] identifier The CAN ID of the frame
+		/// @param[in] isExtendedFrame `true` if the identifier is extended, otherwise `false`, in which case nothing is recorded
+		/// @param[in] startTimestamp_us When the frame entered the stage, or `NO_TIMESTAMP` if it wasn't stamped
+		static void record_frame_latency(Stage stage, std::uint32_t identifier, bool isExtendedFrame, std::uint64_t startTimestamp_us);
+
+		/// @brief Adds the time since a received message's timestamp to the histogram of its PGN, if profiling is on
+		/// @param[in] stage The stage that's finished
+		/// @param[in] message The message, which isn't recorded if it has no timestamp
+		static void record_message_latency(Stage stage, const CANMessage &message);
+
+		/// @brief Returns the PGNs that have been profiled
+		/// @returns The PGNs with histograms, in ascending order
+		static std::vector<std::uint32_t> get_parameter_group_numbers();
+
+		/// @brief Returns the histogram of a stage for a PGN
+		/// @param[in] parameterGroupNumber The PGN
+		/// @param[in] stage The stage
+		/// @returns The histogram, or `nullptr` if the PGN hasn't been profiled
+		static const LatencyHistogram *get_histogram(std::uint32_t parameterGroupNumber, Stage stage);
+
+		/// @brief Writes a table of the sample count, median, 99th and 99.9th percentiles and maximum of each stage for each PGN
+		/// @param[in] output The stream to write the table to
+		static void write_report(std::ostream &output);
+
+		/// @brief Returns the name of a stage
+		/// @param[in] stage The stage
+		/// @returns The name of the stage, like "StackQueue"
+		static const char *get_stage_name(Stage stage);
+
+		/// @brief Removes all samples from every histogram
+		static void reset();
+
+	private:
+		/// @brief Adds a sample to a histogram
+		/// @param[in] stage The stage that's finished
+		/// @param[in] parameterGroupNumber The PGN of the frame or message
+		/// @param[in] startTimestamp_us When it entered the stage
+		static void add_sample(Stage stage, std::uint32_t parameterGroupNumber, std::uint64_t startTimestamp_us);
+
+		static std::atomic<bool> enabled; ///< Stores if stages are being timed
+	};
+} // namespace isobus
+
+#endif // CAN_LATENCY_PROFILER_HPP
@@ -13,6 +13,8 @@
 
 #include "isobus/isobus/can_message.hpp"
 
+#include <memory>
+
 namespace isobus
 {
 	//================================================================================================
@@ -33,6 +35,17 @@ namespace isobus
 		/// @param[in] length the length of the data payload in bytes
 		void set_data(const std::uint8_t *dataBuffer, std::uint32_t length);
 
+		/// @brief Makes the message reference a shared, immutable payload instead of copying it
+		/// @details The message keeps the buffer alive for as long as the message exists.
+		/// Read the payload back with get_data_byte, as get_data only covers the internal data vector.
+		/// @param[in] sharedDataBuffer The data payload to reference
+		void set_shared_data(std::shared_ptr<const std::vector<std::uint8_t>> sharedDataBuffer);
+
+		/// @brief Returns one byte of the message payload, whether it is shared or stored in the message
+		/// @param[in] index The position of the byte in the payload
+		/// @returns The data byte at the index, or 0xFF if the index is outside the payload
+		std::uint8_t get_data_byte(std::uint32_t index) const;
+
 		/// @brief Sets one byte of data in the message data payload
 		/// @param[in] dataByte One byte of data
 		/// @param[in] insertPosition The position in the message at which to insert the data byte
@@ -58,10 +71,15 @@ namespace isobus
 		/// @param[in] value The CAN ID for the message
 		void set_identifier(CANIdentifier value);
 
+		/// @brief Sets when the stack received the message
+		/// @param[in] value The time in microseconds from `SystemTiming::get_timestamp_us`
+		void set_timestamp_us(std::uint64_t value);
+
 		/// @brief Gets the size of the message when using callbacks and not the internal data vector
 		std::uint32_t get_callback_message_size() const;
 
 	private:
+		std::shared_ptr<const std::vector<std::uint8_t>> sharedData; ///< A shared payload referenced instead of the internal data vector, if set
 		std::uint32_t callbackMessageSize; ///< The size of the message when using callbacks and not the internal data vector
 	};
 
@@ -69,6 +69,11 @@ namespace isobus
 		/// @returns The CAN channel index associated with the message
 		std::uint8_t get_can_port_index() const;
 
+		/// @brief Returns when the stack received the message
+		/// @details For a message from a transport protocol, this is when its last frame was received.
+		/// @returns The time in microseconds from `SystemTiming::get_timestamp_us`, or 0 if the message wasn't received
+		std::uint64_t get_timestamp_us() const;
+
 		/// @brief ISO11783-3 defines this: The maximum number of packets that can be sent in a single connection
 		/// with extended transport protocol is restricted by the extended data packet offset (3 bytes).
 		/// This yields a maximum message size of (2^24-1 packets) x (7 bytes/packet) = 117440505 bytes
@@ -83,6 +88,7 @@ namespace isobus
 		Type messageType; ///< The internal message type associated with the message
 		const std::uint32_t messageUniqueID; ///< The unique ID of the message, an internal value for tracking and stats
 		const std::uint8_t CANPortIndex; ///< The CAN channel index associated with the message
+		std::uint64_t timestamp_us; ///< When the stack received the message, or 0 if it wasn't received
 
 	private:
 		static std::uint32_t lastGeneratedUniqueID; ///< A unique, sequential ID for this CAN message
@@ -49,11 +49,25 @@ namespace isobus
 		/// @returns The minimum time to wait between sending BAM frames
 		static std::uint32_t get_minimum_time_between_transport_protocol_bam_frames();
 
+		/// @brief Sets the window in which identical responses to PGN requests are collapsed into one
+		/// @details When many requests for the same PGN arrive in a short time, such as requests for address claim
+		/// at key-on, the stack will wait up to this long after the first request before responding, and answer all
+		/// requests received in the meantime with a single response. A pending global response also satisfies
+		/// destination specific requests for the same PGN. The acceptable range is 0 to 150 ms, so that responses stay
+		/// well within the 200 ms Tr response time defined by ISO-11783. A value of 0 disables coalescing.
+		/// @param[in] value The coalescing window in milliseconds
+		static void set_request_coalescing_window(std::uint32_t value);
+
+		/// @brief Returns the window in which identical responses to PGN requests are collapsed into one
+		/// @returns The coalescing window in milliseconds, or 0 if coalescing is disabled
+		static std::uint32_t get_request_coalescing_window();
+
 	private:
 		static constexpr std::uint8_t DEFAULT_BAM_PACKET_DELAY_TIME_MS = 50; ///< The default time between BAM frames, as defined by J1939
 
 		static std::uint32_t maxNumberTransportProtocolSessions; ///< The max number of TP sessions allowed
 		static std::uint32_t minimumTimeBetweenTransportProtocolBAMFrames; ///< The configurable time between BAM frames
+		static std::uint32_t requestCoalescingWindow; ///< The configurable time to collapse identical request responses over
 	};
 } // namespace isobus
 
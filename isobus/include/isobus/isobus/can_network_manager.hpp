@@ -13,6 +13,7 @@
 
 #include "isobus/isobus/can_address_claim_state_machine.hpp"
 #include "isobus/isobus/can_badge.hpp"
+#include "isobus/isobus/can_bus_load.hpp"
 #include "isobus/isobus/can_callbacks.hpp"
 #include "isobus/isobus/can_constants.hpp"
 #include "isobus/isobus/can_frame.hpp"
@@ -21,21 +22,49 @@
 #include "isobus/isobus/can_message.hpp"
 
 #include <array>
+#include <atomic>
+#include <memory>
 #include <mutex>
+#include <vector>
 
 /// @brief This namespace encompases all of the ISO11783 stack's functionality to reduce global namespace pollution
 namespace isobus
 {
+	class CANLibProtocol;
+	class ExtendedTransportProtocolManager;
+	class FastPacketProtocol;
+	class TransportProtocolManager;
+
 	//================================================================================================
 	/// @class CANNetworkManager
 	///
 	/// @brief The main CAN network manager object, handles protocol management and updating other
 	/// stack components. Provides an interface for sending CAN messages.
+	/// @details Each network manager runs a stack of its own, with its own address table, callbacks,
+	/// transport protocols and bus load estimates. Most programs only need the default one, `CANNetwork`.
+	/// Construct more of them to run several independent stacks in one program, like when simulating
+	/// a network of ECUs or making a gateway between buses. Control functions and protocols belong to the
+	/// network manager they were constructed with, and must be destroyed before it.
 	//================================================================================================
 	class CANNetworkManager
 	{
 	public:
-		static CANNetworkManager CANNetwork; ///< Static singleton of the one network manager. Use this to access stack functionality.
+		static CANNetworkManager CANNetwork; ///< The default network manager. Use this to access stack functionality.
+
+		static constexpr std::uint8_t NO_HARDWARE_CHANNEL = 0xFF; ///< The hardware channel of a CAN port that isn't bound to one
+
+		/// @brief Constructor for a network manager that runs a stack of its own
+		/// @details None of its CAN ports are bound to a hardware channel until set_hardware_channel is called.
+		CANNetworkManager();
+
+		/// @brief Destructor for a network manager, which deletes the external control functions it found on the bus
+		~CANNetworkManager();
+
+		/// @brief Deleted copy constructor, as control functions and protocols keep references to their network manager
+		CANNetworkManager(const CANNetworkManager &) = delete;
+
+		/// @brief Deleted assignment operator, as control functions and protocols keep references to their network manager
+		CANNetworkManager &operator=(const CANNetworkManager &) = delete;
 
 		/// @brief Initializer function for the network manager
 		void initialize();
@@ -52,6 +81,10 @@ namespace isobus
 		/// @param[in] CFAddress The new control function's address
 		void add_control_function(std::uint8_t CANPort, ControlFunction *newControlFunction, std::uint8_t CFAddress, CANLibBadge<AddressClaimStateMachine>);
 
+		/// @brief Called only by the stack, forgets a control function that's being destroyed
+		/// @param[in] controlFunction The control function to forget
+		void remove_control_function(ControlFunction *controlFunction, CANLibBadge<ControlFunction>);
+
 		/// @brief This is how you register a callback for any PGN destined for the global address (0xFF)
 		/// @param[in] parameterGroupNumber The PGN you want to register for
 		/// @param[in] callback The callback that will be called when parameterGroupNumber is recieved from the global address (0xFF)
@@ -88,6 +121,26 @@ namespace isobus
 		                      void *parentPointer = nullptr,
 		                      DataChunkCallback frameChunkCallback = nullptr);
 
+		/// @brief Sends a CAN message whose payload is a shared, immutable buffer
+		/// @details Works like the other send_can_message, but transport protocol sessions reference the
+		/// buffer until they end rather than copying it, which suits payloads that are sent over and over.
+		/// The buffer must not be modified after it is passed in. Publish a new buffer instead.
+		/// There is no priority argument, since a transport protocol sends its frames at the priorities it defines.
+		/// Payloads that fit in one frame are sent at the default priority.
+		/// @param[in] parameterGroupNumber The PGN of the message
+		/// @param[in] data The shared payload to send
+		/// @param[in] sourceControlFunction The internal control function to send from
+		/// @param[in] destinationControlFunction The destination, or nullptr to send to the global address
+		/// @param[in] txCompleteCallback A callback for when the message has been sent or has failed
+		/// @param[in] parentPointer A generic context object for the tx complete callback
+		/// @returns `true` if the message was sent, otherwise `false`
+		bool send_can_message(std::uint32_t parameterGroupNumber,
+		                      std::shared_ptr<const std::vector<std::uint8_t>> data,
+		                      InternalControlFunction *sourceControlFunction,
+		                      ControlFunction *destinationControlFunction = nullptr,
+		                      TransmitCompleteCallback txCompleteCallback = nullptr,
+		                      void *parentPointer = nullptr);
+
 		/// @brief This is the main function used by the stack to receive CAN messages and add them to a queue.
 		/// @details This function is called by the stack itself when you call can_lib_process_rx_message.
 		/// @param[in] message The message to be received
@@ -96,9 +149,67 @@ namespace isobus
 		/// @brief The main update function for the network manager. Updates all protocols.
 		void update();
 
+		/// @brief Returns the load estimate of a CAN port, which counts every frame the stack sends and receives on it
+		/// @details Set the port's bit rate on the estimate if it isn't the ISO 11783 default of 250 kbit/s.
+		/// Protocols can use its headroom to decide how fast to send.
+		/// Frames are only counted while `set_bus_load_enabled` is on.
+		/// @param[in] CANPort The CAN channel index
+		/// @returns The load estimate of the port, or nullptr if the port isn't valid
+		CANBusLoad *get_bus_load(std::uint8_t CANPort);
+
+		/// @brief Sets whether frames are counted in the load estimates of the ports
+		/// @details This is off by default, because `CANHardwareInterface` already counts every frame on the
+		/// channels it drives with the same estimate, see its channel statistics. Turn it on if the stack isn't
+		/// run through `CANHardwareInterface`, or if the port's estimate is needed through `get_bus_load`.
+		/// @param[in] enabled `true` to count frames, `false` to stop counting them
+		void set_bus_load_enabled(bool enabled);
+
+		/// @brief Returns whether frames are counted in the load estimates of the ports
+		/// @returns `true` if frames are counted, otherwise `false`
+		bool get_bus_load_enabled() const;
+
+		/// @brief Binds a CAN port to a hardware channel
+		/// @details Frames received on the hardware channel are processed as frames on the port, and frames sent
+		/// on the port are sent on the hardware channel. A hardware channel can only be bound to one port of a
+		/// network manager. The default network manager has each port bound to the hardware channel with the same index.
+		/// @param[in] CANPort The CAN channel index the control functions of this network manager use
+		/// @param[in] hardwareChannel The hardware channel, or `NO_HARDWARE_CHANNEL` to unbind the port
+		/// @returns `true` if the port was bound, `false` if the port isn't valid or the channel is bound to another port
+		bool set_hardware_channel(std::uint8_t CANPort, std::uint8_t hardwareChannel);
+
+		/// @brief Returns the hardware channel a CAN port is bound to
+		/// @param[in] CANPort The CAN channel index
+		/// @returns The hardware channel of the port, or `NO_HARDWARE_CHANNEL` if it isn't bound to one
+		std::uint8_t get_hardware_channel(std::uint8_t CANPort) const;
+
+		/// @brief Returns the fast packet protocol of this network manager
+		/// @details Fast packet messages have to be sent and registered for with the protocol directly.
+		/// @returns The network manager's fast packet protocol
+		FastPacketProtocol &get_fast_packet_protocol();
+
+		/// @brief Returns the number of protocols the network manager updates
+		/// @returns The number of protocols the network manager updates
+		std::uint32_t get_number_protocols() const;
+
+		/// @brief Gets a protocol the network manager updates by index
+		/// @param[in] index The index of the protocol, in the order the protocols were created
+		/// @param[out] returnedProtocol The returned protocol
+		/// @returns true if a protocol was returned, false if index was out of range
+		bool get_protocol(std::uint32_t index, CANLibProtocol *&returnedProtocol) const;
+
+		/// @brief Called only by the stack, adds a protocol for the network manager to update
+		/// @param[in] protocol The protocol to add
+		void add_protocol(CANLibProtocol *protocol, CANLibBadge<CANLibProtocol>);
+
+		/// @brief Called only by the stack, removes a protocol from the ones the network manager updates
+		/// @param[in] protocol The protocol to remove
+		void remove_protocol(CANLibProtocol *protocol, CANLibBadge<CANLibProtocol>);
+
 		/// @brief Process the CAN Rx queue
+		/// @details Register this as a raw Rx callback with the network manager as the parent pointer
+		/// to have a network manager process the frames of the hardware channels bound to it.
 		/// @param[in] rxFrame Frame to process
-		/// @param[in] parentClass A generic context variable
+		/// @param[in] parentClass The network manager to process the frame with, or nullptr for the default network manager
 		static void can_lib_process_rx_message(HardwareInterfaceCANFrame &rxFrame, void *parentClass);
 
 	protected:
@@ -156,6 +267,14 @@ namespace isobus
 			std::uint32_t parameterGroupNumber; ///< The PGN associated with the callback
 		};
 
+		/// @brief Constructor for a network manager
+		/// @param[in] bindPortsToHardwareChannels true to bind each CAN port to the hardware channel with the same index, like the default network manager
+		explicit CANNetworkManager(bool bindPortsToHardwareChannels);
+
+		/// @brief Processes a frame from a hardware channel, if it's bound to one of the network manager's CAN ports
+		/// @param[in] hardwareFrame The frame to process, with its hardware channel
+		void process_rx_frame(const HardwareInterfaceCANFrame &hardwareFrame);
+
 		/// @brief Updates the internal address table based on a received CAN message
 		/// @param[in] message A message being received by the stack
 		void update_address_table(CANMessage &message);
@@ -226,11 +345,18 @@ namespace isobus
 		std::vector<ControlFunction *> inactiveControlFunctions; ///< A list of inactive control functions, used to track disconnected devices
 		std::list<CANLibProtocolPGNCallbackInfo> protocolPGNCallbacks; ///< A list of PGN callback registered by CAN protocols
 		std::list<CANMessage> receiveMessageList; ///< A queue of Rx messages to process
+		std::array<CANBusLoad, CAN_PORT_MAXIMUM> busLoads; ///< The load estimate of each CAN port
+		std::atomic_bool busLoadEnabled; ///< Whether frames are counted in the load estimates
 		std::vector<ParameterGroupNumberCallbackData> globalParameterGroupNumberCallbacks; ///< A list of all global PGN callbacks
 		std::mutex receiveMessageMutex; ///< A mutex for receive messages thread safety
 		std::mutex protocolPGNCallbacksMutex; ///< A mutex for PGN callback thread safety
+		std::vector<CANLibProtocol *> protocols; ///< The protocols the network manager updates, in the order they were created
+		std::array<std::uint8_t, CAN_PORT_MAXIMUM> hardwareChannels; ///< The hardware channel each CAN port is bound to
 		std::uint32_t updateTimestamp_ms; ///< Keeps track of the last time the CAN stack was update in milliseconds
 		bool initialized; ///< True if the network manager has been initialized by the update function
+		std::unique_ptr<TransportProtocolManager> transportProtocol; ///< The network manager's transport protocol, which is destroyed before the lists it's registered in
+		std::unique_ptr<ExtendedTransportProtocolManager> extendedTransportProtocol; ///< The network manager's extended transport protocol
+		std::unique_ptr<FastPacketProtocol> fastPacketProtocol; ///< The network manager's fast packet protocol
 	};
 
 } // namespace isobus
@@ -18,6 +18,9 @@
 #include "isobus/isobus/can_protocol.hpp"
 
 #include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
 
 namespace isobus
 {
@@ -94,6 +97,62 @@ namespace isobus
 		/// @returns true if the callback was registered, false if the callback is nullptr or is already registered for the same PGN
 		bool remove_request_for_repetition_rate_callback(std::uint32_t pgn, PGNRequestForRepetitionRateCallback callback, void *parentPointer);
 
+		/// @brief Publishes a pre-encoded response for a PGN, so that requests for it are answered without calling a handler
+		/// @details Once a response is published, PGN requests for `pgn` are served directly from the cache. The
+		/// response is sent to the global address for global requests, or to the requester otherwise, and the network
+		/// manager selects single frame, TP, BAM, or ETP based on the length and destination as usual.
+		/// Publishing the same version again is ignored, so it is cheap to call this from a periodic task.
+		/// @param[in] pgn The PGN of the response
+		/// @param[in] data The encoded response payload
+		/// @param[in] dataLength The length of the response payload
+		/// @param[in] version An application defined version of the payload. Change it whenever the payload changes.
+		/// @returns true if the cache was updated, false if the data is invalid or this version was already published
+		bool publish_cached_response(std::uint32_t pgn, const std::uint8_t *data, std::uint32_t dataLength, std::uint32_t version);
+
+		/// @brief Removes a cached response, so that requests for the PGN go to the registered callbacks again
+		/// @param[in] pgn The PGN of the response to remove
+		/// @returns true if a cached response was removed
+		bool remove_cached_response(std::uint32_t pgn);
+
+		/// @brief Returns the version of the response currently cached for a PGN
+		/// @param[in] pgn The PGN to check
+		/// @param[out] version The cached version, only written if a response is cached
+		/// @returns true if a response is cached for `pgn`
+		bool get_cached_response_version(std::uint32_t pgn, std::uint32_t &version);
+
+		/// @brief Registers a PGN to be transmitted cyclically by the protocol's scheduler
+		/// @details Once registered, the protocol takes ownership of the timing of this PGN. If `defaultInterval_ms`
+		/// is non-zero, the callback will be called to broadcast the PGN at that interval. Requests for repetition rate
+		/// for this PGN are then honoured automatically, with one schedule entry per requester, and the callback will be
+		/// called with the requester as the destination at the requested rate until the request is cancelled or expires.
+		/// Registered callbacks for repetition rate are not called for PGNs that are scheduled this way.
+		/// @param[in] pgn The PGN to schedule
+		/// @param[in] defaultInterval_ms The default broadcast interval, or 0 to only transmit when a repetition rate is requested
+		/// @param[in] callback The callback that will transmit the PGN. Return false from it to retry on the next update.
+		/// The callback is called from the stack's update, without the scheduler's lock held.
+		/// @param[in] parentPointer Generic context variable, usually the `this` pointer of the class registering the callback
+		/// @returns true if the PGN was scheduled, false if the callback is nullptr or the PGN is already scheduled
+		bool register_periodic_transmission(std::uint32_t pgn, std::uint32_t defaultInterval_ms, PeriodicTransmitCallback callback, void *parentPointer);
+
+		/// @brief Removes a PGN from the protocol's scheduler, including any pending requests for repetition rate for it
+		/// @param[in] pgn The PGN to remove
+		/// @returns true if the PGN was removed, false if it was not scheduled
+		bool remove_periodic_transmission(std::uint32_t pgn);
+
+		/// @brief Returns the number of active schedule entries, including per-requester repetition rate entries
+		/// @returns The number of active schedule entries
+		std::size_t get_number_scheduled_transmissions() const;
+
+		/// @brief Sets how long a request for repetition rate stays in effect without being repeated by the requester
+		/// @details A value of 0 means requests stay in effect until the requester asks for the default rate again,
+		/// or until the requester loses its address.
+		/// @param[in] timeout_ms The timeout for repetition rate requests, or 0 to disable the timeout
+		void set_repetition_rate_request_timeout(std::uint32_t timeout_ms);
+
+		/// @brief Returns how long a request for repetition rate stays in effect without being repeated by the requester
+		/// @returns The timeout for repetition rate requests in milliseconds, or 0 if disabled
+		std::uint32_t get_repetition_rate_request_timeout() const;
+
 		/// @brief Returns the number of PGN request callbacks that have been registered with this protocol instance
 		/// @returns The number of PGN request callbacks that have been registered with this protocol instance
 		std::size_t get_number_registered_pgn_request_callbacks() const;
@@ -106,6 +165,8 @@ namespace isobus
 		void update(CANLibBadge<CANNetworkManager>) override;
 
 		static constexpr std::uint8_t PGN_REQUEST_LENGTH = 3; ///< The CAN data length of a PGN request
+		static constexpr std::uint16_t DEFAULT_REPETITION_RATE = 0x0000; ///< A requested rate that asks for a PGN to return to its default timing
+		static constexpr std::uint16_t MINIMUM_REPETITION_RATE_MS = 10; ///< Requested rates faster than this are clamped to this value
 
 	private:
 		/// @brief A storage class for holding PGN callbacks and their associated PGN
@@ -150,6 +211,47 @@ namespace isobus
 			void *parent; ///< Pointer to the class that registered the callback, or `nullptr`
 		};
 
+		/// @brief A storage class for a PGN that the scheduler owns the transmission of
+		class PeriodicTransmitInfo
+		{
+		public:
+			/// @brief Constructor for PeriodicTransmitInfo
+			/// @param[in] callback The callback that transmits the PGN
+			/// @param[in] parameterGroupNumber The PGN associated with the callback
+			/// @param[in] interval_ms The default broadcast interval, or 0 for none
+			/// @param[in] parentPointer Pointer to the class that registered the callback, or `nullptr`
+			PeriodicTransmitInfo(PeriodicTransmitCallback callback, std::uint32_t parameterGroupNumber, std::uint32_t interval_ms, void *parentPointer);
+
+			PeriodicTransmitCallback callbackFunction; ///< The actual callback
+			std::uint32_t pgn; ///< The PGN associated with the callback
+			std::uint32_t defaultInterval_ms; ///< The default broadcast interval, or 0 for none
+			void *parent; ///< Pointer to the class that registered the callback, or `nullptr`
+		};
+
+		/// @brief One entry in the scheduler's timer heap, keyed by PGN, requester, and rate
+		class ScheduledTransmission
+		{
+		public:
+			/// @brief Constructor for ScheduledTransmission
+			/// @param[in] parameterGroupNumber The PGN to transmit
+			/// @param[in] requester The control function that requested the rate, or `nullptr` for the default broadcast
+			/// @param[in] rate_ms The interval to transmit at
+			/// @param[in] timestamp_ms The time the entry was created, which also counts as the last request time
+			ScheduledTransmission(std::uint32_t parameterGroupNumber, ControlFunction *requester, std::uint32_t rate_ms, std::uint32_t timestamp_ms);
+
+			/// @brief Orders entries so that the heap's front is the next entry due
+			/// @param[in] lhs The left hand side of the comparison
+			/// @param[in] rhs The right hand side of the comparison
+			/// @returns true if `lhs` is due after `rhs`
+			static bool due_after(const ScheduledTransmission &lhs, const ScheduledTransmission &rhs);
+
+			std::uint32_t pgn; ///< The PGN to transmit
+			ControlFunction *destination; ///< The requester, or `nullptr` for the default broadcast
+			std::uint32_t interval_ms; ///< The interval to transmit at
+			std::uint32_t nextTransmitTimestamp_ms; ///< When the entry is next due
+			std::uint32_t lastRequestTimestamp_ms; ///< When the requester last asked for this rate, used for expiry
+		};
+
 		/// @brief Constructor for the PGN request protocol
 		/// @param[in] internalControlFunction The internal control function assigned to the protocol instance
 		ParameterGroupNumberRequestProtocol(std::shared_ptr<InternalControlFunction> internalControlFunction);
@@ -194,12 +296,75 @@ namespace isobus
 		/// @returns true if the message was sent, false otherwise
 		bool send_acknowledgement(AcknowledgementType type, std::uint32_t parameterGroupNumber, InternalControlFunction *source, ControlFunction *destination);
 
+		/// @brief A pre-encoded response to a PGN request
+		class CachedResponse
+		{
+		public:
+			std::shared_ptr<const std::vector<std::uint8_t>> payload; ///< The encoded response, shared so it can be sent without holding the cache lock
+			std::uint32_t version; ///< The application defined version of the payload
+		};
+
+		/// @brief A cached response that is waiting for the request coalescing window to close
+		class PendingResponse
+		{
+		public:
+			std::uint32_t pgn; ///< The PGN to respond with
+			ControlFunction *destination; ///< The control function to respond to, or `nullptr` for a global response
+			std::uint32_t timestamp_ms; ///< When the first request that this response satisfies was received
+		};
+
+		/// @brief Sends a cached response to a PGN request, if one exists
+		/// @param[in] pgn The requested PGN
+		/// @param[in] message The request message
+		/// @returns true if a cached response exists for `pgn` and was handled
+		bool send_cached_response(std::uint32_t pgn, CANMessage *const message);
+
+		/// @brief Queues a cached response, collapsing it into any pending response that already satisfies it
+		/// @param[in] pgn The PGN to respond with
+		/// @param[in] destination The control function to respond to, or `nullptr` for a global response
+		void coalesce_response(std::uint32_t pgn, ControlFunction *destination);
+
+		/// @brief Sends pending cached responses whose coalescing window has closed
+		void process_pending_responses();
+
+		/// @brief Sends the cached response for a PGN
+		/// @param[in] pgn The PGN to respond with
+		/// @param[in] destination The control function to respond to, or `nullptr` for a global response
+		/// @returns true if the response was sent, or if it is no longer cached and should be dropped
+		bool transmit_cached_response(std::uint32_t pgn, ControlFunction *destination);
+
+		/// @brief Handles a request for repetition rate for a PGN owned by the scheduler
+		/// @param[in] pgn The requested PGN
+		/// @param[in] requester The control function that sent the request
+		/// @param[in] rate_ms The requested rate, or `DEFAULT_REPETITION_RATE`
+		/// @returns true if the scheduler owns `pgn` and handled the request
+		bool schedule_repetition_rate_request(std::uint32_t pgn, ControlFunction *requester, std::uint16_t rate_ms);
+
+		/// @brief Removes all schedule entries that match a predicate and restores the heap
+		/// @param[in] pgn The PGN to match
+		/// @param[in] matchAnyDestination If true, entries for any destination match, otherwise only `destination`
+		/// @param[in] destination The destination to match when `matchAnyDestination` is false
+		void unschedule(std::uint32_t pgn, bool matchAnyDestination, ControlFunction *destination);
+
+		/// @brief Drops repetition rate entries whose requester went away or whose request timed out
+		void expire_repetition_rate_requests();
+
+		/// @brief Transmits every schedule entry that is due as one batch
+		void process_transmit_schedule();
+
 		static std::list<ParameterGroupNumberRequestProtocol *> pgnRequestProtocolList; ///< List of all PGN request protocol instances (one per ICF)
 
 		std::shared_ptr<InternalControlFunction> myControlFunction; ///< The internal control function that this protocol will send from
 		std::vector<PGNRequestCallbackInfo> pgnRequestCallbacks; ///< A list of all registered PGN callbacks and the PGN associated with each callback
 		std::vector<PGNRequestForRepetitionRateCallbackInfo> repetitionRateCallbacks; ///< A list of all registered request for repetition rate callbacks and the PGN associated with the callback
+		std::unordered_map<std::uint32_t, CachedResponse> responseCache; ///< Pre-encoded responses to PGN requests, keyed by PGN
+		std::vector<PendingResponse> pendingResponses; ///< Cached responses waiting for the request coalescing window to close
+		std::vector<PeriodicTransmitInfo> periodicTransmissions; ///< A list of all PGNs whose transmission the scheduler owns
+		std::vector<ScheduledTransmission> transmitSchedule; ///< The scheduler's timer heap, the next entry due is at the front
+		std::uint32_t repetitionRateRequestTimeout_ms; ///< How long a request for repetition rate lasts without renewal, or 0 for no timeout
 		std::mutex pgnRequestMutex; ///< A mutex to protect the callback lists
+		mutable std::mutex scheduleMutex; ///< A mutex to protect the scheduler
+		std::mutex responseCacheMutex; ///< A mutex to protect the response cache
 	};
 }
 
@@ -36,11 +36,17 @@ namespace isobus
 	class PartneredControlFunction : public ControlFunction
 	{
 	public:
-		/// @brief the constructor for a PartneredControlFunction
+		/// @brief the constructor for a PartneredControlFunction on the default network manager
 		/// @param[in] CANPort The CAN channel associated with this control function definition
 		/// @param[in] NAMEFilters A list of filters that describe the identity of the CF based on NAME components
 		PartneredControlFunction(std::uint8_t CANPort, const std::vector<NAMEFilter> NAMEFilters);
 
+		/// @brief the constructor for a PartneredControlFunction
+		/// @param[in] CANPort The CAN channel associated with this control function definition
+		/// @param[in] NAMEFilters A list of filters that describe the identity of the CF based on NAME components
+		/// @param[in] parentNetworkManager The network manager of the stack that should find and talk to this control function
+		PartneredControlFunction(std::uint8_t CANPort, const std::vector<NAMEFilter> NAMEFilters, CANNetworkManager &parentNetworkManager);
+
 		/// @brief The destructor for PartneredControlFunction
 		~PartneredControlFunction();
 
@@ -16,6 +16,7 @@
 #include "isobus/isobus/can_control_function.hpp"
 #include "isobus/isobus/can_message.hpp"
 
+#include <memory>
 #include <vector>
 
 namespace isobus
@@ -32,9 +33,13 @@ namespace isobus
 	class CANLibProtocol
 	{
 	public:
-		/// @brief The base class constructor for a CANLibProtocol
+		/// @brief The base class constructor for a CANLibProtocol on the default network manager
 		CANLibProtocol();
 
+		/// @brief The base class constructor for a CANLibProtocol
+		/// @param[in] parentNetworkManager The network manager that updates the protocol, and that it sends and receives with
+		explicit CANLibProtocol(CANNetworkManager &parentNetworkManager);
+
 		/// @brief The base class destructor for a CANLibProtocol
 		virtual ~CANLibProtocol();
 
@@ -42,14 +47,18 @@ namespace isobus
 		/// @returns true if the protocol has been initialized by the network manager
 		bool get_is_initialized() const;
 
-		/// @brief Gets a CAN protocol by index from the list of all protocols
+		/// @brief Returns the network manager the protocol belongs to
+		/// @returns The network manager that updates the protocol
+		CANNetworkManager &get_network_manager() const;
+
+		/// @brief Gets a CAN protocol by index from the protocols of the default network manager
 		/// @param[in] index The index of the protocol to get from the list of protocols
 		/// @param[out] returnedProtocol The returned protocol
 		/// @returns true if a protocol was successfully returned, false if index was out of range
 		static bool get_protocol(std::uint32_t index, CANLibProtocol *&returnedProtocol);
 
-		/// @brief Returns the number of all created protocols
-		/// @returns The number of all created protocols
+		/// @brief Returns the number of protocols of the default network manager
+		/// @returns The number of protocols of the default network manager
 		static std::uint32_t get_number_protocols();
 
 		/// @brief A generic way to initialize a protocol
@@ -80,12 +89,28 @@ namespace isobus
 		                                       void *parentPointer,
 		                                       DataChunkCallback frameChunkCallback) = 0;
 
+		/// @brief The network manager calls this to see if the protocol can accept a message whose payload is a shared, immutable buffer
+		/// @details Protocols that can reference the buffer for the life of their session instead of copying it
+		/// should override this. The default implementation copies the payload through protocol_transmit_message.
+		/// @param[in] parameterGroupNumber The PGN of the message
+		/// @param[in] data The shared payload to be sent, which must not be modified while it is shared
+		/// @param[in] source The source control function
+		/// @param[in] destination The destination control function
+		/// @param[in] transmitCompleteCallback A callback for when the protocol completes its work
+		/// @param[in] parentPointer A generic context object for the tx complete callback
+		/// @returns true if the message was accepted by the protocol for processing
+		virtual bool protocol_transmit_shared_message(std::uint32_t parameterGroupNumber,
+		                                              std::shared_ptr<const std::vector<std::uint8_t>> data,
+		                                              ControlFunction *source,
+		                                              ControlFunction *destination,
+		                                              TransmitCompleteCallback transmitCompleteCallback,
+		                                              void *parentPointer);
+
 		/// @brief This will be called by the network manager on every cyclic update of the stack
 		virtual void update(CANLibBadge<CANNetworkManager>) = 0;
 
 	protected:
-		static std::vector<CANLibProtocol *> protocolList; ///< A list of all created protocol classes
-
+		CANNetworkManager &networkManager; ///< The network manager that updates the protocol
 		bool initialized; ///< Keeps track of if the protocol has been initialized by the network manager
 	};
 
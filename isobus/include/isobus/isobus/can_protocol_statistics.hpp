@@ -0,0 +1,198 @@
+//================================================================================================
+/// @file can_protocol_statistics.hpp
+///
+/// @brief Counters that the transport protocols keep about their sessions, so that an
+/// application can see how its multi-frame traffic is doing at runtime.
+/// @author Adrian Del Grosso
+///
+/// @copyright 2022 Adrian Del Grosso
+//================================================================================================
+
+#ifndef CAN_PROTOCOL_STATISTICS_HPP
+#define CAN_PROTOCOL_STATISTICS_HPP
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace isobus
+{
+	//================================================================================================
+	/// @class LatencyHistogram
+	///
+	/// @brief A histogram of durations with power of two buckets
+	/// @details Bucket 0 counts samples of 0, and each bucket after that counts samples up to twice
+	/// as long as the one before it. The last bucket counts everything that didn't fit in the others.
+	/// The unit of the samples is up to the user, like milliseconds or microseconds.
+	/// Samples can be added from one thread while being read from another without any locking.
+	//================================================================================================
+	class LatencyHistogram
+	{
+	public:
+		static constexpr std::uint8_t NUMBER_OF_BUCKETS = 32; ///< The number of buckets in the histogram, enough to cover every 32 bit sample
+
+		/// @brief Constructor for an empty histogram
+		LatencyHistogram();
+
+		/// @brief Deleted copy constructor, as the counters are atomic
+		LatencyHistogram(const LatencyHistogram &) = delete;
+
+		/// @brief Deleted assignment operator, as the counters are atomic
+		LatencyHistogram &operator=(const LatencyHistogram &) = delete;
+
+		/// @brief Adds a sample to the histogram
+		/// @param[in] value The duration to add
+		void add_sample(std::uint32_t value);
+
+		/// @brief Returns the number of samples in a bucket
+		/// @param[in] bucket The index of the bucket, less than `NUMBER_OF_BUCKETS`
+		/// @returns The number of samples in the bucket, or 0 if the bucket is out of range
+		std::uint32_t get_number_samples(std::uint8_t bucket) const;
+
+		/// @brief Returns the number of samples in all the buckets
+		/// @returns The number of samples in the histogram
+		std::uint32_t get_total_number_samples() const;
+
+		/// @brief Returns the longest sample added to the histogram
+		/// @returns The longest sample, or 0 if there are none
+		std::uint32_t get_maximum() const;
+
+		/// @brief Returns a limit that a percentage of the samples are at or below
+		/// @details The buckets are powers of two, so this is the upper limit of the bucket the
+		/// percentile falls in, or the longest sample if that's lower. It's never below the real percentile.
+		/// @param[in] percentile The percentage of samples, like 99.9
+		/// @returns The limit, or 0 if there are no samples
+		std::uint32_t get_percentile_upper_limit(float percentile) const;
+
+		/// @brief Returns the longest sample that a bucket counts
+		/// @param[in] bucket The index of the bucket
+		/// @returns The longest sample in the bucket, which is the max value for the last bucket
+		static std::uint32_t get_bucket_upper_limit(std::uint8_t bucket);
+
+		/// @brief Returns the bucket a sample is counted in
+		/// @param[in] value The duration to check
+		/// @returns The index of the bucket the sample goes in
+		static std::uint8_t get_bucket(std::uint32_t value);
+
+		/// @brief Removes all samples from the histogram
+		void reset();
+
+	private:
+		std::array<std::atomic<std::uint32_t>, NUMBER_OF_BUCKETS> buckets; ///< The number of samples in each bucket
+		std::atomic<std::uint32_t> maximum; ///< The longest sample so far
+	};
+
+	//================================================================================================
+	/// @class ProtocolStatistics
+	///
+	/// @brief Counts the sessions, bytes, aborts and retransmits of a transport protocol
+	/// @details The protocol updates these as it runs, and they can be read at any time from any
+	/// thread. All the counters are relaxed atomics, so each one is accurate on its own, but a set
+	/// of counters read together might be from slightly different moments.
+	//================================================================================================
+	class ProtocolStatistics
+	{
+	public:
+		/// @brief The direction of a session, from our point of view
+		enum class Direction : std::uint8_t
+		{
+			Transmit = 0, ///< Sessions where we send the message
+			Receive = 1 ///< Sessions where we receive the message
+		};
+
+		static constexpr std::uint16_t NUMBER_OF_ABORT_REASONS = 256; ///< Abort reasons are one byte, so this many can be counted
+
+		/// @brief Constructor for a set of statistics with every counter at 0
+		ProtocolStatistics();
+
+		/// @brief Deleted copy constructor, as the counters are atomic
+		ProtocolStatistics(const ProtocolStatistics &) = delete;
+
+		/// @brief Deleted assignment operator, as the counters are atomic
+		ProtocolStatistics &operator=(const ProtocolStatistics &) = delete;
+
+		/// @brief Counts a session that was started
+		/// @param[in] direction The direction of the session
+		void record_session_started(Direction direction);
+
+		/// @brief Counts a session that finished transferring all its data
+		/// @param[in] direction The direction of the session
+		/// @param[in] numberOfBytes The length of the message the session transferred
+		/// @param[in] duration_ms How long the session took from start to finish
+		void record_session_completed(Direction direction, std::uint32_t numberOfBytes, std::uint32_t duration_ms);
+
+		/// @brief Counts a session that was closed, whether it completed or not
+		/// @param[in] direction The direction of the session
+		void record_session_closed(Direction direction);
+
+		/// @brief Counts an abort that we sent
+		/// @param[in] reason The abort reason from the abort message
+		void record_abort_sent(std::uint8_t reason);
+
+		/// @brief Counts an abort that we received
+		/// @param[in] reason The abort reason from the abort message
+		void record_abort_received(std::uint8_t reason);
+
+		/// @brief Counts packets that a receiver asked us to send again
+		/// @param[in] numberOfPackets The number of packets that will be sent again
+		void record_retransmit_request(std::uint32_t numberOfPackets);
+
+		/// @brief Returns the number of sessions that were started
+		/// @param[in] direction The direction of the sessions to count
+		/// @returns The number of sessions that were started
+		std::uint32_t get_number_sessions_started(Direction direction) const;
+
+		/// @brief Returns the number of sessions that transferred all their data
+		/// @param[in] direction The direction of the sessions to count
+		/// @returns The number of sessions that completed
+		std::uint32_t get_number_sessions_completed(Direction direction) const;
+
+		/// @brief Returns the number of sessions that were closed before they completed
+		/// @details This includes sessions that were aborted, timed out or ran into any other error.
+		/// @param[in] direction The direction of the sessions to count
+		/// @returns The number of sessions that failed
+		std::uint32_t get_number_sessions_failed(Direction direction) const;
+
+		/// @brief Returns the number of payload bytes in sessions that completed
+		/// @param[in] direction The direction of the sessions to count
+		/// @returns The number of bytes that were transferred
+		std::uint64_t get_number_bytes(Direction direction) const;
+
+		/// @brief Returns the number of aborts we sent with a reason
+		/// @param[in] reason The abort reason, like a protocol's `ConnectionAbortReason` cast to a byte
+		/// @returns The number of aborts we sent with that reason
+		std::uint32_t get_number_aborts_sent(std::uint8_t reason) const;
+
+		/// @brief Returns the number of aborts we received with a reason
+		/// @param[in] reason The abort reason, like a protocol's `ConnectionAbortReason` cast to a byte
+		/// @returns The number of aborts we received with that reason
+		std::uint32_t get_number_aborts_received(std::uint8_t reason) const;
+
+		/// @brief Returns the number of packets that receivers asked us to send again
+		/// @returns The number of packets that were requested again
+		std::uint32_t get_number_retransmitted_packets() const;
+
+		/// @brief Returns how long sessions took to complete, in milliseconds
+		/// @param[in] direction The direction of the sessions
+		/// @returns A histogram of the durations of completed sessions
+		const LatencyHistogram &get_completion_latency(Direction direction) const;
+
+		/// @brief Sets every counter back to 0
+		void reset();
+
+	private:
+		static constexpr std::uint8_t NUMBER_OF_DIRECTIONS = 2; ///< Transmit and receive
+
+		std::array<std::atomic<std::uint32_t>, NUMBER_OF_DIRECTIONS> sessionsStarted; ///< Sessions started in each direction
+		std::array<std::atomic<std::uint32_t>, NUMBER_OF_DIRECTIONS> sessionsCompleted; ///< Sessions completed in each direction
+		std::array<std::atomic<std::uint32_t>, NUMBER_OF_DIRECTIONS> sessionsClosed; ///< Sessions closed in each direction, whether they completed or not
+		std::array<std::atomic<std::uint64_t>, NUMBER_OF_DIRECTIONS> bytesTransferred; ///< Payload bytes of completed sessions in each direction
+		std::array<std::atomic<std::uint32_t>, NUMBER_OF_ABORT_REASONS> abortsSent; ///< Aborts we sent, indexed by reason
+		std::array<std::atomic<std::uint32_t>, NUMBER_OF_ABORT_REASONS> abortsReceived; ///< Aborts we received, indexed by reason
+		std::atomic<std::uint32_t> retransmittedPackets; ///< Packets that receivers asked to be sent again
+		std::array<LatencyHistogram, NUMBER_OF_DIRECTIONS> completionLatency; ///< How long completed sessions took in each direction
+	};
+
+} // namespace isobus
+
+#endif // CAN_PROTOCOL_STATISTICS_HPP
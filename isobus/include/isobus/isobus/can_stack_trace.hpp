@@ -0,0 +1,195 @@
+//================================================================================================
+/// @file can_stack_trace.hpp
+///
+/// @brief A compact binary trace of what the CAN stack is doing, like frames going in and out,
+/// transport session state changes, aborts, and how long callbacks take. Records are written
+/// into a lock-free ring per thread without any string formatting, so that tracing can be left
+/// on in the field without changing the timing of the stack very much. The trace can be written
+/// to a file and turned into text later with the trace decoder tool.
+/// @author Adrian Del Grosso
+///
+/// @copyright 2022 Adrian Del Grosso
+//================================================================================================
+#ifndef CAN_STACK_TRACE_HPP
+#define CAN_STACK_TRACE_HPP
+
+#include "isobus/isobus/can_frame.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace isobus
+{
+	class CANMessage;
+
+	//================================================================================================
+	/// @class CANStackTrace
+	///
+	/// @brief A flight recorder for the CAN stack
+	/// @details Tracing is off by default, and when it's off each trace point costs one atomic load.
+	/// When it's on, each thread that records an event gets its own ring of `RECORDS_PER_THREAD`
+	/// records. Only that thread writes into its ring, so recording never takes a lock. When a ring
+	/// is full the oldest records are overwritten, so the trace always holds the most recent history.
+	/// A ring is handed to the next thread that records something once its thread exits, so the
+	/// thread index in the trace identifies a ring, not an OS thread.
+	//================================================================================================
+	class CANStackTrace
+	{
+	public:
+		/// @brief The kinds of events in the trace
+		enum class EventType : std::uint8_t
+		{
+			None = 0, ///< Not a valid event
+			FrameReceived = 1, ///< A frame came in from the hardware layer. The identifier is the CAN ID, the arguments hold the data, and the detail is the data length
+			FrameTransmitted = 2, ///< A frame was given to the hardware layer. Same layout as `FrameReceived`
+			FrameTransmitFailed = 3, ///< The hardware layer didn't take a frame. Same layout as `FrameReceived`
+			SessionStateChanged = 4, ///< A transport session changed state. The identifier is the PGN, argument 0 is the message length, argument 1 is the packets processed so far, and the detail is the new state
+			AbortSent = 5, ///< The stack aborted a transport session. The identifier is the PGN, argument 0 is 1 if the abort was sent, and the detail is the reason
+			AbortReceived = 6, ///< Another control function aborted a transport session. The identifier is the PGN and the detail is the reason
+			CallbackDispatched = 7 ///< A receive callback was called. The identifier is the PGN, argument 0 is how long the callback took in microseconds, argument 1 is the message length, and the detail is the `CallbackType`
+		};
+
+		/// @brief The part of the stack that recorded an event
+		enum class Component : std::uint8_t
+		{
+			NetworkManager = 0, ///< The network manager
+			TransportProtocol = 1, ///< The ISO 11783-3 transport protocol
+			ExtendedTransportProtocol = 2 ///< The ISO 11783-3 extended transport protocol
+		};
+
+		/// @brief The kinds of callbacks timed by `CallbackDispatched` events
+		enum class CallbackType : std::uint8_t
+		{
+			Protocol = 0, ///< A callback that a protocol registered for its PGN
+			Global = 1, ///< A global PGN callback
+			Partnered = 2 ///< A callback on a partnered control function
+		};
+
+		/// @brief One event in the trace
+		struct Record
+		{
+			std::uint64_t timestamp_us; ///< When the event happened, from `SystemTiming::get_timestamp_us`
+			std::uint32_t identifier; ///< A CAN ID or a PGN, depending on the event type
+			std::uint32_t argument0; ///< Depends on the event type
+			std::uint32_t argument1; ///< Depends on the event type
+			std::uint8_t eventType; ///< The `EventType` of the event
+			std::uint8_t component; ///< The `Component` that recorded the event
+			std::uint8_t channel; ///< The CAN channel the event is about
+			std::uint8_t detail; ///< Depends on the event type
+		};
+
+		/// @brief The header at the start of a trace file
+		struct FileHeader
+		{
+			char magic[8]; ///< Always `FILE_MAGIC`
+			std::uint16_t version; ///< The version of the file format, `FILE_VERSION`
+			std::uint16_t recordSize; ///< The size of one `Record` in bytes
+			std::uint32_t byteOrderMark; ///< `BYTE_ORDER_MARK` in the byte order of the machine that wrote the file
+		};
+
+		/// @brief The header in front of the records from one thread in a trace file
+		struct BlockHeader
+		{
+			std::uint32_t threadIndex; ///< The index of the thread's ring
+			std::uint32_t numberOfRecords; ///< The number of records that follow this header
+			std::uint64_t numberOfLostRecords; ///< How many records were overwritten before they could be written
+		};
+
+		static constexpr std::uint32_t RECORDS_PER_THREAD = 4096; ///< The number of records in each thread's ring, a power of two
+		static constexpr std::uint16_t FILE_VERSION = 1; ///< The version of the trace file format
+		static constexpr std::uint32_t BYTE_ORDER_MARK = 0x01020304; ///< Lets a decoder tell the byte order of a file
+		static constexpr char FILE_MAGIC[8] = { 'I', 'S', 'O', 'T', 'R', 'A', 'C', 'E' }; ///< Identifies a trace file
+		static constexpr std::uint64_t NO_TIMESTAMP = std::numeric_limits<std::uint64_t>::max(); ///< Returned by `get_timestamp_us` when tracing is off
+
+		/// @brief Turns tracing on or off
+		/// @param[in] enable `true` to start recording events, `false` to stop
+		static void set_enabled(bool enable);
+
+		/// @brief Returns if tracing is on
+		/// @returns `true` if events are being recorded, otherwise `false`
+		static bool get_enabled()
+		{
+			return enabled.load(std::memory_order_relaxed);
+		}
+
+		/// @brief Returns a timestamp to time something with, but only if tracing is on
+		/// @returns The current time in microseconds, or `NO_TIMESTAMP` if tracing is off
+		static std::uint64_t get_timestamp_us();
+
+		/// @brief Records an event if tracing is on
+		/// @param[in] type The kind of event
+		/// @param[in] component The part of the stack recording the event
+		/// @param[in] channel The CAN channel the event is about
+		/// @param[in] identifier A CAN ID or PGN, depending on the event type
+		/// @param[in] argument0 Depends on the event type
+		/// @param[in] argument1 Depends on the event type
+		/// @param[in] detail Depends on the event type
+		static void record_event(EventType type,
+		                         Component component,
+		                         std::uint8_t channel,
+		                         std::uint32_t identifier,
+		                         std::uint32_t argument0,
+		                         std::uint32_t argument1,
+		                         std::uint8_t detail)
+		{
+			if (get_enabled())
+			{
+				add_record(type, component, channel, identifier, argument0, argument1, detail);
+			}
+		}
+
+		/// @brief Records a frame going in or out if tracing is on
+		/// @param[in] type `FrameReceived`, `FrameTransmitted` or `FrameTransmitFailed`
+		/// @param[in] frame The frame to record
+		static void record_frame(EventType type, const HardwareInterfaceCANFrame &frame);
+
+		/// @brief Records how long a receive callback took if tracing is on
+		/// @param[in] type The kind of callback
+		/// @param[in] message The message that was passed to the callback
+		/// @param[in] dispatchTimestamp_us What `get_timestamp_us` returned just before the callback was called
+		static void record_callback_dispatch(CallbackType type, const CANMessage &message, std::uint64_t dispatchTimestamp_us);
+
+		/// @brief Copies every record that's still in the trace, oldest first
+		/// @param[out] records The records in the trace, ordered by timestamp
+		static void get_records(std::vector<Record> &records);
+
+		/// @brief Writes the trace to a stream in the binary file format
+		/// @details The trace isn't cleared, so it can be written again later with more history
+		/// @param[in] output The stream to write to, which should be opened in binary mode
+		/// @returns `true` if the whole trace was written, otherwise `false`
+		static bool write(std::ostream &output);
+
+		/// @brief Writes the trace to a file in the binary file format
+		/// @param[in] fileName The path of the file to create
+		/// @returns `true` if the file was written, otherwise `false`
+		static bool write_file(const std::string &fileName);
+
+		/// @brief Throws away every record in the trace
+		static void clear();
+
+	private:
+		/// @brief Adds a record to the calling thread's ring
+		/// @param[in] type The kind of event
+		/// @param[in] component The part of the stack recording the event
+		/// @param[in] channel The CAN channel the event is about
+		/// @param[in] identifier A CAN ID or PGN, depending on the event type
+		/// @param[in] argument0 Depends on the event type
+		/// @param[in] argument1 Depends on the event type
+		/// @param[in] detail Depends on the event type
+		static void add_record(EventType type,
+		                       Component component,
+		                       std::uint8_t channel,
+		                       std::uint32_t identifier,
+		                       std::uint32_t argument0,
+		                       std::uint32_t argument1,
+		                       std::uint8_t detail);
+
+		static std::atomic<bool> enabled; ///< Stores if events are being recorded
+	};
+} // namespace isobus
+
+#endif // CAN_STACK_TRACE_HPP
@@ -16,6 +16,7 @@
 #include "isobus/isobus/can_managed_message.hpp"
 #include "isobus/isobus/can_network_manager.hpp"
 #include "isobus/isobus/can_protocol.hpp"
+#include "isobus/isobus/can_protocol_statistics.hpp"
 
 namespace isobus
 {
@@ -82,6 +83,7 @@ namespace isobus
 			DataChunkCallback frameChunkCallback; ///< A callback that might be used to get chunks of data to send
 			void *parent; ///< A generic context variable that helps identify what object callbacks are destined for. Can be nullptr
 			std::uint32_t timestamp_ms; ///< A timestamp used to track session timeouts
+			const std::uint32_t sessionStartTimestamp_ms; ///< When the session was created, used to measure how long it takes
 			std::uint16_t lastPacketNumber; ///< The last processed sequence number for this set of packets
 			std::uint8_t packetCount; ///< The total number of packets to receive or send in this session
 			std::uint8_t processedPacketsThisSession; ///< The total processed packet count for the whole session so far
@@ -89,6 +91,7 @@ namespace isobus
 			const Direction sessionDirection; ///< Represents Tx or Rx session
 		};
 
+	public:
 		///  @brief A list of all defined abort reasons in ISO11783
 		enum class ConnectionAbortReason : std::uint8_t
 		{
@@ -105,6 +108,17 @@ namespace isobus
 			AnyOtherError = 250 ///< Any other error not enumerated above, 0xFE
 		};
 
+		/// @brief The destructor for the TransportProtocolManager
+		virtual ~TransportProtocolManager();
+
+		/// @brief Returns the counters for the sessions, aborts and retransmits of the default network manager's protocol
+		/// @details Aborts are indexed by `ConnectionAbortReason`.
+		/// @returns The statistics for the protocol
+		static const ProtocolStatistics &get_statistics();
+
+	private:
+		friend class CANNetworkManager; ///< Allows each network manager to create its own transport protocol manager
+
 		static constexpr std::uint32_t REQUEST_TO_SEND_MULTIPLEXOR = 0x10; ///< TP.CM_RTS Multiplexor
 		static constexpr std::uint32_t CLEAR_TO_SEND_MULTIPLEXOR = 0x11; ///< TP.CM_CTS Multiplexor
 		static constexpr std::uint32_t END_OF_MESSAGE_ACKNOWLEDGE_MULTIPLEXOR = 0x13; ///< TP.CM_EOM_ACK Multiplexor
@@ -119,12 +133,10 @@ namespace isobus
 		static constexpr std::uint8_t PROTOCOL_BYTES_PER_FRAME = 7; ///< The number of payload bytes per frame minus overhead of sequence number
 
 		/// @brief The constructor for the TransportProtocolManager
-		TransportProtocolManager();
+		/// @param[in] parentNetworkManager The network manager that owns the protocol
+		explicit TransportProtocolManager(CANNetworkManager &parentNetworkManager);
 
-		/// @brief The destructor for the TransportProtocolManager
-		virtual ~TransportProtocolManager();
-
-		static TransportProtocolManager Protocol; ///< Static instance of the protocol manager
+		static TransportProtocolManager &Protocol; ///< The protocol manager of the default network manager
 
 		/// @brief The protocol's initializer function
 		void initialize(CANLibBadge<CANNetworkManager>) override;
@@ -157,6 +169,22 @@ namespace isobus
 		                               void *parentPointer,
 		                               DataChunkCallback frameChunkCallback) override;
 
+		/// @brief The network manager calls this to see if the protocol can accept a long, shared CAN message for processing
+		/// @details The session references the shared payload until it is closed instead of copying it.
+		/// @param[in] parameterGroupNumber The PGN of the message
+		/// @param[in] data The shared payload to be sent
+		/// @param[in] source The source control function
+		/// @param[in] destination The destination control function
+		/// @param[in] transmitCompleteCallback A callback for when the protocol completes its work
+		/// @param[in] parentPointer A generic context object for the tx complete callback
+		/// @returns true if the message was accepted by the protocol for processing
+		bool protocol_transmit_shared_message(std::uint32_t parameterGroupNumber,
+		                                      std::shared_ptr<const std::vector<std::uint8_t>> data,
+		                                      ControlFunction *source,
+		                                      ControlFunction *destination,
+		                                      TransmitCompleteCallback transmitCompleteCallback,
+		                                      void *parentPointer) override;
+
 		/// @brief Updates the protocol cyclically
 		void update(CANLibBadge<CANNetworkManager>) override;
 
@@ -179,6 +207,33 @@ namespace isobus
 		/// @param[in] session The session to close
 		void close_session(TransportProtocolSession *session);
 
+		/// @brief Creates a new transmit session if the message can be sent with this protocol
+		/// @details The caller is responsible for setting the session's data and adding it to the active sessions.
+		/// @param[in] parameterGroupNumber The PGN of the message
+		/// @param[in] messageLength The length of the data to be sent
+		/// @param[in] source The source control function
+		/// @param[in] destination The destination control function
+		/// @param[in] sessionCompleteCallback A callback for when the protocol completes its work
+		/// @param[in] parentPointer A generic context object for the tx complete and chunk callbacks
+		/// @param[in] frameChunkCallback A callback to get some data to send
+		/// @returns The new session, or nullptr if the message can't be sent with this protocol
+		TransportProtocolSession *create_transmit_session(std::uint32_t parameterGroupNumber,
+		                                                  std::uint32_t messageLength,
+		                                                  ControlFunction *source,
+		                                                  ControlFunction *destination,
+		                                                  TransmitCompleteCallback sessionCompleteCallback,
+		                                                  void *parentPointer,
+		                                                  DataChunkCallback frameChunkCallback);
+
+		/// @brief Returns which direction a session counts as in the protocol's statistics
+		/// @param[in] session The session to check
+		/// @returns The direction of the session
+		static ProtocolStatistics::Direction get_statistics_direction(const TransportProtocolSession *session);
+
+		/// @brief Counts a session that finished transferring all its data in the protocol's statistics
+		/// @param[in] session The session that completed
+		void record_session_completed(const TransportProtocolSession *session);
+
 		/// @brief Processes end of session callbacks
 		/// @param[in] session The session we've just completed
 		/// @param[in] success Denotes if the session was successful
@@ -227,6 +282,7 @@ namespace isobus
 		void update_state_machine(TransportProtocolSession *session);
 
 		std::vector<TransportProtocolSession *> activeSessions; ///< A list of all active TP sessions
+		ProtocolStatistics statistics; ///< Counters for the sessions, aborts and retransmits of the protocol
 	};
 
 } // namespace isobus
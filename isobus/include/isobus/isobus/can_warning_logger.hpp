@@ -10,8 +10,18 @@
 #ifndef CAN_WARNING_LOGGER_HPP
 #define CAN_WARNING_LOGGER_HPP
 
+#include <atomic>
+#include <cstdint>
+#include <sstream>
 #include <string>
 
+/// @brief The lowest logging level that gets compiled into the stack, from 0 (debug) to 5 (no logging at all)
+/// @details Log calls below this level are removed by the compiler, so they cost nothing at runtime.
+/// The CMake cache variable `CAN_STACK_MINIMUM_LOG_LEVEL` sets this for the whole build.
+#ifndef CAN_STACK_MINIMUM_LOG_LEVEL
+#define CAN_STACK_MINIMUM_LOG_LEVEL 0
+#endif
+
 namespace isobus
 {
 	//================================================================================================
@@ -21,35 +31,154 @@ namespace isobus
 	/// @details The CAN stack prints helpful text that may inform you of issues in either the stack
 	/// or your application. You can override a function in this class to begin consuming this
 	/// logging text.
+	/// Each message has a level, and the text of a message is only put together when a sink is
+	/// installed and the level passes both the compiled minimum level and the runtime level, so log
+	/// calls that are filtered out don't format anything.
 	//================================================================================================
 	class CANStackLogger
 	{
 	public:
+		/// @brief The levels of log messages, from least to most severe
+		enum class LoggingLevel : std::uint8_t
+		{
+			Debug = 0, ///< Verbose information about what the stack is doing, like sessions opening and closing
+			Info = 1, ///< Things that are good to know about, like new control functions on the bus
+			Warning = 2, ///< Something unexpected that the stack can recover from, like a timeout or a bad frame
+			Error = 3, ///< Something failed and the stack couldn't do what it was asked to do
+			Critical = 4 ///< Something failed that will likely stop the stack from working
+		};
+
+		static constexpr std::uint8_t COMPILED_MINIMUM_LOG_LEVEL = CAN_STACK_MINIMUM_LOG_LEVEL; ///< Messages below this level are compiled out
+
 		/// @brief The constructor for a CANStackLogger
 		CANStackLogger();
 
 		/// @brief The destructor for a CANStackLogger
-		~CANStackLogger();
+		virtual ~CANStackLogger();
 
-		/// @brief Gets called from the CAN stack to log information. Wraps LogCANLibWarning.
+		/// @brief Gets called from the CAN stack to log information. Logs the text at the `Info` level.
 		/// @param[in] warningText The text to be logged
 		static void CAN_stack_log(const std::string &warningText);
 
+		/// @brief Logs a message made from a list of values, if a sink will take the level
+		/// @details The values are written one after the other with `operator<<`, only after the level
+		/// has passed the filters. Cast 8 bit integers to `int`, or they'll be written as characters.
+		/// @param[in] level The level of the message
+		/// @param[in] args The values that make up the message
+		template<typename... Args>
+		static void CAN_stack_log(LoggingLevel level, const Args &...args)
+		{
+			if (get_log_level_enabled(level))
+			{
+				std::ostringstream messageStream;
+
+				append_to_stream(messageStream, args...);
+				log_text(level, messageStream.str());
+			}
+		}
+
+		/// @brief Logs a message at the `Debug` level
+		/// @param[in] args The values that make up the message
+		template<typename... Args>
+		static void debug(const Args &...args)
+		{
+			CAN_stack_log(LoggingLevel::Debug, args...);
+		}
+
+		/// @brief Logs a message at the `Info` level
+		/// @param[in] args The values that make up the message
+		template<typename... Args>
+		static void info(const Args &...args)
+		{
+			CAN_stack_log(LoggingLevel::Info, args...);
+		}
+
+		/// @brief Logs a message at the `Warning` level
+		/// @param[in] args The values that make up the message
+		template<typename... Args>
+		static void warn(const Args &...args)
+		{
+			CAN_stack_log(LoggingLevel::Warning, args...);
+		}
+
+		/// @brief Logs a message at the `Error` level
+		/// @param[in] args The values that make up the message
+		template<typename... Args>
+		static void error(const Args &...args)
+		{
+			CAN_stack_log(LoggingLevel::Error, args...);
+		}
+
+		/// @brief Logs a message at the `Critical` level
+		/// @param[in] args The values that make up the message
+		template<typename... Args>
+		static void critical(const Args &...args)
+		{
+			CAN_stack_log(LoggingLevel::Critical, args...);
+		}
+
+		/// @brief Returns if a message at a level would reach a sink
+		/// @details Use this to skip work that's only needed to build a log message
+		/// @param[in] level The level to check
+		/// @returns `true` if a sink is installed and the level passes the compiled and runtime filters
+		static bool get_log_level_enabled(LoggingLevel level)
+		{
+			return ((static_cast<std::uint8_t>(level) >= COMPILED_MINIMUM_LOG_LEVEL) &&
+			        (static_cast<std::uint8_t>(level) >= logLevel.load(std::memory_order_relaxed)) &&
+			        (nullptr != logger.load(std::memory_order_relaxed)));
+		}
+
+		/// @brief Sets the lowest level of message that gets sent to the sink. The default is `Info`.
+		/// @param[in] level The lowest level to log
+		static void set_log_level(LoggingLevel level);
+
+		/// @brief Returns the lowest level of message that gets sent to the sink
+		/// @returns The lowest level that's logged
+		static LoggingLevel get_log_level();
+
 		/// @brief Assigns a derived logger class to be used as the log sink
-		/// @param[in] logSink A pointer to a derived CANStackLogger class
+		/// @param[in] logSink A pointer to a derived CANStackLogger class, or `nullptr` to stop logging
 		static void set_can_stack_logger_sink(CANStackLogger *logSink);
 
+		/// @brief Override this to make a log sink for your application that knows about levels
+		/// @details By default this passes the text on to `LogCANLibWarning`
+		/// @param[in] level The level of the message
+		/// @param[in] text The information being logged
+		virtual void sink_CAN_stack_log(LoggingLevel level, const std::string &text);
+
 		/// @brief Override this to make a log sink for your application
 		/// @param[in] warningText The information being logged
 		virtual void LogCANLibWarning(const std::string &warningText);
 
 	private:
+		/// @brief Ends the recursion of `append_to_stream`
+		static void append_to_stream(std::ostringstream &)
+		{
+		}
+
+		/// @brief Writes a list of values to a stream, one after the other
+		/// @param[in] stream The stream to write to
+		/// @param[in] value The first value to write
+		/// @param[in] args The rest of the values to write
+		template<typename T, typename... Args>
+		static void append_to_stream(std::ostringstream &stream, const T &value, const Args &...args)
+		{
+			stream << value;
+			append_to_stream(stream, args...);
+		}
+
+		/// @brief Sends text to the sink, if there is one
+		/// @param[in] level The level of the message
+		/// @param[in] text The text to be logged
+		static void log_text(LoggingLevel level, const std::string &text);
+
 		/// @brief Provides a pointer to the static instance of the logger, and returns if the pointer is valid
 		/// @param[out] canStackLogger The static logger instance
 		/// @returns true if the logger is not `nullptr` or false if it is `nullptr`
-		static bool get_can_stack_logger(CANStackLogger *canStackLogger);
+		static bool get_can_stack_logger(CANStackLogger *&canStackLogger);
 
-		static CANStackLogger *logger; ///< A static pointer to an instance of a logger
+		static std::atomic<CANStackLogger *> logger; ///< A static pointer to an instance of a logger
+		static std::atomic<std::uint8_t> logLevel; ///< The lowest level that gets sent to the logger
 	};
 } // namespace isobus
 
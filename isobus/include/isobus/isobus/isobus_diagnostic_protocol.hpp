@@ -40,9 +40,12 @@
 #include "isobus/isobus/can_protocol.hpp"
 #include "isobus/utility/processing_flags.hpp"
 
+#include <array>
 #include <list>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <vector>
 
 namespace isobus
 {
@@ -274,6 +277,13 @@ namespace isobus
 		/// @returns `true` if the DTC was in the active list
 		bool get_diagnostic_trouble_code_active(const DiagnosticTroubleCode &dtc);
 
+		/// @brief Encodes the DM1 message for the currently active DTCs
+		/// @details This is the same payload that the protocol broadcasts. Messages shorter than
+		/// 8 bytes are padded to a full frame.
+		/// @param[out] payload The encoded DM1 message
+		/// @returns `true` if the message was encoded, `false` if there are too many active DTCs to fit in one message
+		bool encode_diagnostic_message_1(std::vector<std::uint8_t> &payload);
+
 		/// @brief Sets the product ID code used in the diagnostic protocol "Product Identification" message (PGN 0xFC8D)
 		/// @details The product identification code, as assigned by the manufacturer, corresponds with the number on the
 		/// type plate of a product. For vehicles, this number can be the same as the VIN. For stand-alone systems, such as VTs,
@@ -364,6 +374,7 @@ namespace isobus
 			std::uint32_t suspectParameterNumber; ///< SPN of the DTC for the DM22
 			std::uint8_t failureModeIdentifier; ///< FMI of the DTC for the DM22
 			std::uint8_t nackIndicator; ///< The NACK reason, if applicable
+			std::uint32_t timestamp_ms; ///< When the response was queued, used to give up on it after DM22_RESPONSE_TIMEOUT_MS
 			bool clearActive; ///< true if the DM22 was for an active DTC, false for previously active
 			bool nack; ///< true if we are sending a NACK instead of PACK. Determines if we use nackIndicator
 		};
@@ -371,6 +382,8 @@ namespace isobus
 		static constexpr std::uint32_t DM_MAX_FREQUENCY_MS = 1000; ///< You are techically allowed to send more than this under limited circumstances, but a hard limit saves 4 RAM bytes per DTC and has BAM benefits
 		static constexpr std::uint32_t DM13_HOLD_SIGNAL_TRANSMIT_INTERVAL_MS = 5000; ///< Defined in 5.7.13.13 SPN 1236
 		static constexpr std::uint32_t DM13_TIMEOUT_MS = 6000; ///< The timout in 5.7.13 after which nodes shall revert back to the normal broadcast state
+		static constexpr std::uint32_t DM22_RESPONSE_TIMEOUT_MS = 1250; ///< How long we keep retrying a queued DM22 response before dropping it, matches the J1939 T3 timeout
+		static constexpr std::uint8_t DM22_RESPONSE_QUEUE_SIZE = 16; ///< The max number of DM22 responses that can be waiting to be sent. Requests beyond this are NACKed right away
 		static constexpr std::uint16_t MAX_PAYLOAD_SIZE_BYTES = 1785; ///< DM 1 and 2 are limited to the BAM message max, becuase ETP does not allow global destinations
 		static constexpr std::uint8_t DM_PAYLOAD_BYTES_PER_DTC = 4; ///< The number of payload bytes per DTC that gets encoded into the messages
 		static constexpr std::uint8_t PRODUCT_IDENTIFICATION_MAX_STRING_LENGTH = 50; ///< The max string length allowed in the fields of product ID, as defined in ISO 11783-12
@@ -462,6 +475,19 @@ namespace isobus
 		/// @returns `true` if the message was sent, otherwise `false`
 		bool send_dm13_announce_suspension(InternalControlFunction *sourceControlFunction, std::uint16_t suspendTime_seconds);
 
+		/// @brief Re-encodes the ECU ID payload from the ECU ID fields
+		void encode_ecu_identification();
+
+		/// @brief Re-encodes the product identification payload from the product ID code, brand, and model
+		void encode_product_identification();
+
+		/// @brief Re-encodes the software ID payload from the software ID fields
+		void encode_software_identification();
+
+		/// @brief Publishes the ECU ID and software ID payloads to the PGN request protocol's response cache,
+		/// so that requests for them are answered without calling back into this protocol
+		void publish_identification_payloads();
+
 		/// @brief Sends the ECU ID message
 		/// @returns true if the message was sent
 		bool send_ecu_identification();
@@ -474,8 +500,14 @@ namespace isobus
 		/// @returns true if the message was sent, otherwise false
 		bool send_software_identification();
 
+		/// @brief Adds a DM22 response to the back of the response queue
+		/// @param[in] data The components of the DM22 response
+		/// @returns true if the response was queued, false if the queue is full
+		bool queue_dm22_response(DM22Data data);
+
 		/// @brief Processes any DM22 responses from the queue
-		/// @details We queue responses so that we can do Tx retries if needed
+		/// @details We queue responses so that we can do Tx retries if needed. All queued responses are sent in
+		/// order in one pass until one fails. The rest are retried next time, unless they are older than DM22_RESPONSE_TIMEOUT_MS.
 		/// @returns true if queue was completely processed, false if messages remain that could not be sent
 		bool process_all_dm22_responses();
 
@@ -522,13 +554,20 @@ namespace isobus
 		std::shared_ptr<InternalControlFunction> myControlFunction; ///< The internal control function that this protocol will send from
 		std::vector<DiagnosticTroubleCode> activeDTCList; ///< Keeps track of all the active DTCs
 		std::vector<DiagnosticTroubleCode> inactiveDTCList; ///< Keeps track of all the previously active DTCs
-		std::vector<DM22Data> dm22ResponseQueue; ///< Maintaining a list of DM22 responses we need to send to allow for retrying in case of Tx failures
+		std::array<DM22Data, DM22_RESPONSE_QUEUE_SIZE> dm22ResponseQueue; ///< A ring of DM22 responses we need to send to allow for retrying in case of Tx failures
+		std::size_t dm22ResponseQueueHead; ///< Index of the oldest response in dm22ResponseQueue
+		std::size_t dm22ResponseQueueSize; ///< Number of responses in dm22ResponseQueue
 		std::vector<std::string> ecuIdentificationFields; ///< Stores the ECU ID fields so we can transmit them when ECUID's PGN is requested
 		std::vector<std::string> softwareIdentificationFields; ///< Stores the Software ID fields so we can transmit them when the PGN is requested
 		ProcessingFlags txFlags; ///< An instance of the processing flags to handle retries of some messages
 		std::string productIdentificationCode; ///< The product identification code for sending the product identification message
 		std::string productIdentificationBrand; ///< The product identification brand for sending the product identification message
 		std::string productIdentificationModel; ///< The product identification model name for sending the product identification message
+		std::shared_ptr<const std::vector<std::uint8_t>> ecuIdentificationPayload; ///< The encoded ECU ID message, shared with any session sending it
+		std::shared_ptr<const std::vector<std::uint8_t>> productIdentificationPayload; ///< The encoded product ID message, shared with any session sending it
+		std::shared_ptr<const std::vector<std::uint8_t>> softwareIdentificationPayload; ///< The encoded software ID message, or nullptr if there are no software ID fields
+		std::mutex identificationPayloadMutex; ///< A mutex to protect the encoded identification payloads
+		std::uint32_t identificationPayloadVersion; ///< Incremented each time an identification payload is re-encoded, used as the cached response version
 		std::uint32_t lastDM1SentTimestamp; ///< A timestamp in milliseconds of the last time a DM1 was sent
 		std::uint32_t stopBroadcastNetworkBitfield; ///< Bitfield for tracking the network broadcast states for DM13
 		std::uint32_t lastDM13ReceivedTimestamp; ///< A timestamp in milliseconds when we last got a DM13 message
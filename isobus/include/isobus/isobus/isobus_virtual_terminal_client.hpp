@@ -9,13 +9,22 @@
 #ifndef ISOBUS_VIRTUAL_TERMINAL_CLIENT_HPP
 #define ISOBUS_VIRTUAL_TERMINAL_CLIENT_HPP
 
+#include "isobus/isobus/can_constants.hpp"
 #include "isobus/isobus/can_internal_control_function.hpp"
 #include "isobus/isobus/can_partnered_control_function.hpp"
+#include "isobus/utility/object_pool_image.hpp"
+#include "isobus/utility/object_pool_index.hpp"
 #include "isobus/utility/processing_flags.hpp"
 
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <thread>
+#include <unordered_map>
 #include <vector>
 
 namespace isobus
@@ -177,9 +186,13 @@ namespace isobus
 			WaitForGetTextFontDataResponse, ///< Client is waiting for a response to the "get text font data" message
 			SendGetHardware, ///< Client is sending the "get hardware" message
 			WaitForGetHardwareResponse, ///< Client is waiting for a response to the "get hardware" message
+			SendLoadVersion, ///< Client is sending the "load version" message to try to use a copy of the pool the VT already has
+			WaitForLoadVersionResponse, ///< Client is waiting for a response to the "load version" message
 			UploadObjectPool, ///< Client is uploading the object pool
 			SendEndOfObjectPool, ///< Client is sending the end of object pool message
 			WaitForEndOfObjectPoolResponse, ///< Client is waiting for the end of object pool response message
+			SendStoreVersion, ///< Client is sending the "store version" message so the VT keeps a copy of the uploaded pool
+			WaitForStoreVersionResponse, ///< Client is waiting for a response to the "store version" message
 			Connected, ///< Client is connected to the VT server and the application layer is in control
 			Failed ///< Client could not connect to the VT due to an error
 		};
@@ -293,6 +306,61 @@ namespace isobus
 		/// @param[in] value The callback to remove
 		void RemoveVTSelectInputObjectEventCallback(VTSelectInputObjectCallback value);
 
+		// Command Queue
+		/// @brief Enables or disables queueing of single frame commands
+		/// @details When enabled, the single frame command functions below add their command to a queue
+		/// and return true if it was queued. The client sends the queue from update at a limited rate.
+		/// A command that sets a value, such as change numeric value, change attribute, or hide/show object,
+		/// replaces a queued command with the same function, object, and attribute, so only the latest
+		/// value is sent. Other commands, like macros and graphics context commands, are always added to the end.
+		/// Commands longer than 8 bytes, such as change string value, are still sent right away.
+		/// The queue is emptied if the connection to the VT is lost. Disabled by default.
+		/// @param[in] value true to queue commands, false to send them right away
+		void set_command_queue_enabled(bool value);
+
+		/// @brief Returns if single frame commands are queued
+		/// @returns true if single frame commands are queued
+		bool get_command_queue_enabled() const;
+
+		/// @brief Sets the minimum average time between commands sent from the queue
+		/// @details After the queue has been idle, up to the maximum number of pending responses may be sent at once.
+		/// @param[in] interval_ms The time between commands in milliseconds, or 0 for no limit
+		void set_command_queue_interval(std::uint32_t interval_ms);
+
+		/// @brief Sets how many commands from the queue may be waiting on a response from the VT at once
+		/// @details While the VT status message reports that the VT is busy, only one command is sent at a time.
+		/// A command that gets no response within a timeout stops counting as pending.
+		/// @param[in] value The maximum number of commands waiting on a response, at least 1
+		void set_command_queue_max_pending_responses(std::uint8_t value);
+
+		/// @brief Returns the number of commands waiting in the queue
+		/// @returns The number of queued commands that have not been sent yet
+		std::uint32_t get_command_queue_size() const;
+
+		// Object Pool Deltas
+		/// @brief Enables or disables restoring runtime changes to the object pool when the client reconnects
+		/// @details A VT loads the base object pool again after it is reset or the connection is lost,
+		/// which undoes every change the application made with commands. When enabled, the client remembers
+		/// the latest command for each object and attribute that a command sets, such as change numeric value,
+		/// change attribute, or hide/show object, plus each object's latest string value. Once the pool is
+		/// loaded after a reconnect, those changes are sent again in the order they were first made.
+		/// A change that couldn't be sent because the bus or the command queue was full is sent again too.
+		/// Commands that don't set a value, like macros and graphics context commands, are not remembered.
+		/// Disabled by default. Disabling it forgets the recorded changes.
+		/// @param[in] value true to record and restore changes, false to not
+		void set_object_pool_delta_replay_enabled(bool value);
+
+		/// @brief Returns if runtime changes to the object pool are restored when the client reconnects
+		/// @returns true if changes are recorded and restored
+		bool get_object_pool_delta_replay_enabled() const;
+
+		/// @brief Returns the number of commands that will be sent again when the client reconnects
+		/// @returns The number of recorded commands, not counting string values
+		std::uint32_t get_number_object_pool_deltas() const;
+
+		/// @brief Forgets all recorded changes to the object pool, for example after assigning a different pool
+		void clear_object_pool_deltas();
+
 		// Command Messages
 		/// @brief Sends a hide/show object command
 		/// @details This command is used to hide or show a Container object.
@@ -407,10 +475,13 @@ namespace isobus
 		/// command is to be changed, variables referenced by the object are not changed.
 		/// The transferred string is allowed to be smaller than the length of the value attribute of the target object and in
 		/// this case the VT shall pad the value attribute with space characters.
+		/// The client remembers the last value sent to each object, and does nothing if the value hasn't changed.
+		/// Changes are sent one at a time in the order they were made, with a newer value for an object replacing
+		/// one that is still waiting, so several long strings don't each have to wait for a free transport session.
 		/// @param[in] objectID The ID of the target object
 		/// @param[in] stringLength The length of the string to be sent
 		/// @param[in] value The string to be sent
-		/// @returns true if the message was sent successfully
+		/// @returns true if the value was sent or queued, or is already the object's value
 		bool send_change_string_value(std::uint16_t objectID, uint16_t stringLength, const char *value);
 
 		/// @brief Sends the change string value command (with a c++ string instead of buffer + length)
@@ -420,7 +491,7 @@ namespace isobus
 		/// this case the VT shall pad the value attribute with space characters.
 		/// @param[in] objectID The ID of the target object
 		/// @param[in] value The string to be sent
-		/// @returns true if the message was sent successfully
+		/// @returns true if the value was sent or queued, or is already the object's value
 		bool send_change_string_value(std::uint16_t objectID, const std::string &value);
 
 		/// @brief Sends the change endpoint command, which changes the end of an output line
@@ -789,6 +860,188 @@ namespace isobus
 		/// @returns true if the message was sent successfully
 		bool send_copy_viewport_to_picture_graphic(std::uint16_t graphicsContextObjectID, std::uint16_t objectID);
 
+		//================================================================================================
+		/// @class GraphicsContextBatch
+		///
+		/// @brief Records drawing operations on a graphics context object so they can be sent in as few messages as possible
+		/// @details ISO 11783-6 only allows one graphics context sub command per message, so instead of
+		/// packing commands together the batch removes the ones that would not change what is drawn.
+		/// Cursor moves are combined until something is drawn, attributes are only sent when they
+		/// differ from the value the VT already has, and runs of lines are merged into open polygons
+		/// when a line attributes object is set, which draws them the same way in a single message.
+		/// The batch remembers the attributes it has sent, so it should be kept and reused for the
+		/// same graphics context. Call clear if something else may have changed the graphics context.
+		//================================================================================================
+		class GraphicsContextBatch
+		{
+		public:
+			/// @brief Constructor for a GraphicsContextBatch
+			/// @param[in] graphicsContextObjectID The ID of the graphics context object to draw on
+			explicit GraphicsContextBatch(std::uint16_t graphicsContextObjectID);
+
+			/// @brief Returns the ID of the graphics context object this batch draws on
+			/// @returns The graphics context object ID
+			std::uint16_t get_object_id() const;
+
+			/// @brief Removes all recorded operations and forgets which attributes the VT has
+			void clear();
+
+			/// @brief Records setting the graphics cursor to a position
+			/// @param[in] xPosition The new X position of the cursor
+			/// @param[in] yPosition The new Y position of the cursor
+			void set_cursor(std::int16_t xPosition, std::int16_t yPosition);
+
+			/// @brief Records moving the graphics cursor relative to its current position
+			/// @param[in] xOffset The X offset to move the cursor by
+			/// @param[in] yOffset The Y offset to move the cursor by
+			void move_cursor(std::int16_t xOffset, std::int16_t yOffset);
+
+			/// @brief Records setting the foreground colour
+			/// @param[in] colour The colour to use for lines, points, and borders
+			void set_foreground_colour(std::uint8_t colour);
+
+			/// @brief Records setting the background colour
+			/// @param[in] colour The colour to use for erasing and opaque text
+			void set_background_colour(std::uint8_t colour);
+
+			/// @brief Records setting the line attributes object
+			/// @param[in] objectID The line attributes object to use, or NULL_OBJECT_ID for none
+			void set_line_attributes(std::uint16_t objectID);
+
+			/// @brief Records setting the fill attributes object
+			/// @param[in] objectID The fill attributes object to use, or NULL_OBJECT_ID for none
+			void set_fill_attributes(std::uint16_t objectID);
+
+			/// @brief Records setting the font attributes object
+			/// @param[in] objectID The font attributes object to use, or NULL_OBJECT_ID for none
+			void set_font_attributes(std::uint16_t objectID);
+
+			/// @brief Records erasing a rectangle at the cursor with the background colour
+			/// @param[in] width The width of the rectangle
+			/// @param[in] height The height of the rectangle
+			void erase_rectangle(std::uint16_t width, std::uint16_t height);
+
+			/// @brief Records drawing a point relative to the cursor
+			/// @param[in] xOffset The X offset of the point
+			/// @param[in] yOffset The Y offset of the point
+			void draw_point(std::int16_t xOffset, std::int16_t yOffset);
+
+			/// @brief Records drawing a line from the cursor to a point relative to it
+			/// @param[in] xOffset The X offset of the end of the line
+			/// @param[in] yOffset The Y offset of the end of the line
+			void draw_line(std::int16_t xOffset, std::int16_t yOffset);
+
+			/// @brief Records drawing a rectangle at the cursor
+			/// @param[in] width The width of the rectangle
+			/// @param[in] height The height of the rectangle
+			void draw_rectangle(std::uint16_t width, std::uint16_t height);
+
+			/// @brief Records drawing a closed ellipse at the cursor
+			/// @param[in] width The width of the ellipse
+			/// @param[in] height The height of the ellipse
+			void draw_closed_ellipse(std::uint16_t width, std::uint16_t height);
+
+			/// @brief Records drawing text at the cursor with the font attributes object
+			/// @param[in] transparent Denotes if the text background is transparent
+			/// @param[in] textLength String length
+			/// @param[in] value A buffer to the text to draw with length `textLength`
+			/// @returns true if the text was recorded, false if there was no text
+			bool draw_text(bool transparent, std::uint8_t textLength, const char *value);
+
+			/// @brief Encodes every recorded operation that is still being combined with the ones after it
+			void flush();
+
+			/// @brief Returns the number of messages the batch has encoded so far
+			/// @returns The number of encoded messages, which is final after calling flush
+			std::uint32_t get_number_messages() const;
+
+			/// @brief Returns a copy of one of the messages the batch has encoded
+			/// @param[in] index The index of the message, in the order they will be sent
+			/// @param[out] message The whole message, starting with the graphics context command function code
+			/// @returns true if the message was copied, false if there is no message at that index
+			bool get_message(std::uint32_t index, std::vector<std::uint8_t> &message) const;
+
+		private:
+			friend class VirtualTerminalClient;
+
+			/// @brief The graphics context attributes that the batch tracks
+			enum class Attribute : std::uint8_t
+			{
+				ForegroundColour, ///< The foreground colour
+				BackgroundColour, ///< The background colour
+				LineAttributes, ///< The line attributes object ID
+				FillAttributes, ///< The fill attributes object ID
+				FontAttributes, ///< The font attributes object ID
+
+				NumberAttributes ///< The number of attributes in this enum
+			};
+
+			/// @brief The cursor operation waiting to be combined with the ones after it
+			enum class CursorOperation : std::uint8_t
+			{
+				None, ///< The cursor has not been set or moved since the last drawing operation
+				Set, ///< The cursor is set to an absolute position
+				Move ///< The cursor is moved relative to where it was
+			};
+
+			static constexpr std::uint32_t UNKNOWN_ATTRIBUTE = 0xFFFFFFFF; ///< An attribute that has not been set or sent
+			static constexpr std::uint8_t MAX_POLYGON_POINTS = 255; ///< The most points a draw polygon command can have
+
+			/// @brief Records an attribute to be set before the next drawing operation
+			/// @param[in] attribute The attribute to set
+			/// @param[in] value The new value of the attribute
+			void set_attribute(Attribute attribute, std::uint32_t value);
+
+			/// @brief Encodes everything that has to come before a drawing operation that isn't a merged line
+			void begin_drawing();
+
+			/// @brief Encodes the pending run of lines as a draw line or draw polygon command
+			void flush_lines();
+
+			/// @brief Encodes the attributes that differ from the ones the VT has
+			void flush_attributes();
+
+			/// @brief Encodes the pending cursor operation
+			void flush_cursor();
+
+			/// @brief Starts encoding a graphics context command, the caller then appends its parameters
+			/// @param[in] subCommand The graphics context sub command ID
+			/// @returns The offset of the new message in messageData
+			std::uint32_t begin_message(std::uint8_t subCommand);
+
+			/// @brief Finishes encoding a graphics context command, padding it to a full CAN frame if it is short
+			/// @param[in] messageOffset The offset of the message in messageData, returned by begin_message
+			void end_message(std::uint32_t messageOffset);
+
+			/// @brief Encodes one graphics context command with two 16 bit parameters
+			/// @param[in] subCommand The graphics context sub command ID
+			/// @param[in] first The first parameter
+			/// @param[in] second The second parameter
+			void add_message(std::uint8_t subCommand, std::uint16_t first, std::uint16_t second);
+
+			/// @brief Removes the encoded messages, but keeps the attributes the VT has
+			void clear_messages();
+
+			std::vector<std::uint8_t> messageData; ///< The encoded messages, back to back
+			std::vector<std::uint16_t> messageLengths; ///< The length of each encoded message
+			std::vector<std::int16_t> lineOffsets; ///< X and Y pairs for the pending run of lines, relative to where the run started
+			std::array<std::uint32_t, static_cast<std::size_t>(Attribute::NumberAttributes)> attributes; ///< The attributes the application asked for
+			std::array<std::uint32_t, static_cast<std::size_t>(Attribute::NumberAttributes)> sentAttributes; ///< The attributes the VT has been sent
+			std::int32_t cursorX; ///< The X position or offset of the pending cursor operation
+			std::int32_t cursorY; ///< The Y position or offset of the pending cursor operation
+			std::uint16_t objectID; ///< The graphics context object ID
+			CursorOperation cursorOperation; ///< The pending cursor operation
+		};
+
+		/// @brief Sends a batch of graphics context operations
+		/// @details The batch is flushed and its messages are queued to be sent in order, after
+		/// any batches that are still being sent. Messages that need the transport layer are sent one
+		/// at a time. Graphics context objects need VT version 4 or later, so the batch is
+		/// not sent to older VTs.
+		/// @param[in] batch The batch to send. Its messages are removed if they were queued
+		/// @returns true if the batch was queued, false if the VT is too old or too many batches are already queued
+		bool send_graphics_context_batch(GraphicsContextBatch &batch);
+
 		// VT Querying
 		/// @brief Sends the get attribute value message
 		/// @param[in] objectID The object ID to query
@@ -889,6 +1142,7 @@ namespace isobus
 
 		/// @brief Assigns an object pool to the client using a buffer and size.
 		/// @details This is good for small pools or pools where you have all the data in memory.
+		/// The pool is parsed and indexed when it is assigned, and the client will not connect if it is invalid.
 		/// @param[in] poolIndex The index of the pool you are assigning
 		/// @param[in] poolSupportedVTVersion The VT version of the object pool
 		/// @param[in] pool A pointer to the object pool. Must remain valid until client is connected!
@@ -897,21 +1151,62 @@ namespace isobus
 
 		/// @brief Assigns an object pool to the client using a vector.
 		/// @details This is good for small pools or pools where you have all the data in memory.
+		/// The pool is parsed and indexed when it is assigned, and the client will not connect if it is invalid.
 		/// @param[in] poolIndex The index of the pool you are assigning
 		/// @param[in] poolSupportedVTVersion The VT version of the object pool
 		/// @param[in] pool A pointer to the object pool. Must remain valid until client is connected!
 		void set_object_pool(std::uint8_t poolIndex, VTVersion poolSupportedVTVersion, const std::vector<std::uint8_t> *pool);
 
+		/// @brief Assigns a shared, immutable object pool image to the client.
+		/// @details This is the best way to drive more than one VT with the same pool. The pool is loaded
+		/// and indexed once when the image is created, and every client assigned the image uploads
+		/// straight from its data, so there is no copy per client. The client keeps the image alive
+		/// for as long as it is assigned, so the application doesn't need to keep its own reference.
+		/// The client will not connect if the image's pool is invalid.
+		/// @param[in] poolIndex The index of the pool you are assigning
+		/// @param[in] poolSupportedVTVersion The VT version of the object pool
+		/// @param[in] image The object pool image
+		void set_object_pool(std::uint8_t poolIndex, VTVersion poolSupportedVTVersion, std::shared_ptr<const ObjectPoolImage> image);
+
 		/// @brief Assigns an object pool to the client where the client will get data in chunks during upload.
 		/// @details This is probably better for huge pools if you are RAM constrained, or if your
 		/// pool is stored on some external device that you need to get data from in pages.
 		/// This is also the best way to load from IOP files, as you can read the data in piece by piece.
+		/// The callback is asked for chunks of the pool as the transport layer needs them, where the
+		/// offset is into the pool itself (not counting the multiplexor), and its parent pointer is this client.
+		/// The same chunk may be asked for more than once if the VT asks for data to be sent again.
+		/// Pools larger than 1785 bytes are sent with ETP, so they can be as large as the VT has memory for.
 		/// @param[in] poolIndex The index of the pool you are assigning
 		/// @param[in] poolSupportedVTVersion The VT version of the object pool
 		/// @param[in] poolTotalSize The object pool size
 		/// @param[in] value The data callback that will be used to get object pool data to upload.
 		void register_object_pool_data_chunk_callback(std::uint8_t poolIndex, VTVersion poolSupportedVTVersion, std::uint32_t poolTotalSize, DataChunkCallback value);
 
+		/// @brief Looks up an object in the assigned object pools by its object ID
+		/// @details Only pools assigned from memory are indexed. Pools supplied through a data chunk callback are not searched.
+		/// @param[in] objectID The object ID to look up
+		/// @param[out] poolIndex The index of the pool the object is in, if it was found
+		/// @param[out] info The type of the object and where it is in its pool, if it was found
+		/// @returns true if the object was found, otherwise false
+		bool get_object_info(std::uint16_t objectID, std::uint8_t &poolIndex, ObjectPoolIndex::ObjectInfo &info) const;
+
+		/// @brief Enables or disables caching the object pool on the VT using version labels
+		/// @details When enabled, the client labels the assigned pools with a hash of their contents.
+		/// At connect, it asks the VT to load that version and only uploads the pool if the VT doesn't have it.
+		/// After an upload, it asks the VT to store the pool under that label. This is disabled by default.
+		/// If you change the contents of a pool, assign it again so that the hash is recalculated.
+		/// @param[in] value true to enable version caching, false to always upload the pool
+		void set_object_pool_version_caching(bool value);
+
+		/// @brief Returns if the client will try to use a version of the pool stored on the VT
+		/// @returns true if object pool version caching is enabled
+		bool get_object_pool_version_caching() const;
+
+		/// @brief Returns how much of the object pool has been uploaded to the VT
+		/// @details Covers all assigned pools. A pool that has to be retried counts from the start again.
+		/// @returns The upload progress, from 0 to 100 percent
+		float get_object_pool_upload_progress_percent() const;
+
 		/// @brief Periodic Update Function (worker thread may call this)
 		/// @details This class can spawn a thread, or you can supply your own to run this function.
 		/// To configure that behavior, see the initialize function.
@@ -1049,9 +1344,119 @@ namespace isobus
 			VTVersion version; ///< The version of the object pool. Must be the same for all pools!
 			bool useDataCallback; ///< Determines if the client will use callbacks to get the data in chunks.
 			bool uploaded; ///< The upload state of this pool
+			ObjectPoolIndex index; ///< Where each object in the pool is, if the pool is in memory
+			std::shared_ptr<const ObjectPoolImage> image; ///< The shared image the pool's data and index come from, if one was assigned
+		};
+
+		/// @brief A single frame command waiting in the command queue
+		struct QueuedCommand
+		{
+			std::array<std::uint8_t, CAN_DATA_LENGTH> data; ///< The encoded command
+			std::uint32_t key; ///< The object and attribute the command changes, if it is replaceable
+			bool replaceable; ///< Tells if a newer command with the same function and key replaces this one
+		};
+
+		/// @brief A command from the queue that is waiting on a response from the VT
+		struct PendingCommand
+		{
+			std::uint32_t timestamp_ms; ///< When the command was sent
+			std::uint8_t function; ///< The function code of the command, which the response will echo
+		};
+
+		/// @brief The latest command that changed an object, kept so it can be sent again after a reconnect
+		struct ObjectPoolDelta
+		{
+			std::array<std::uint8_t, CAN_DATA_LENGTH> data; ///< The encoded command
+			bool replayPending; ///< Tells if the VT hasn't been sent this command since the last reconnect
+		};
+
+		/// @brief The string value of an object, as set with change string value commands
+		struct StringValueState
+		{
+			std::vector<std::uint8_t> value; ///< The latest value requested for the object
+			bool sent; ///< Tells if the value has been sent to the VT
+			bool queued; ///< Tells if the object is waiting in the string value queue
 		};
 
+		// Command Queue
+		/// @brief Sends a single frame command, or adds it to the command queue if the queue is enabled
+		/// @param[in] data The 8 byte command
+		/// @returns true if the command was sent or queued
+		bool send_command(const std::uint8_t *data);
+
+		/// @brief Sends a single frame command, or adds it to the command queue, without recording it as an object pool delta
+		/// @param[in] data The 8 byte command
+		/// @returns true if the command was sent or queued
+		bool transmit_command(const std::uint8_t *data);
+
+		/// @brief Finds the object and attribute that a command changes, if newer commands should replace it
+		/// @param[in] data The 8 byte command
+		/// @param[out] key The object ID in the upper 16 bits and any attribute, index, or mask type in the lower 16 bits
+		/// @returns true if only the latest command with this function and key needs to be sent
+		static bool get_command_key(const std::uint8_t *data, std::uint32_t &key);
+
+		/// @brief Sends as many queued commands as the rate limit, the pending responses, and the VT's busy state allow
+		void process_command_queue();
+
+		/// @brief Stops waiting on a response to the oldest pending command with a function code
+		/// @param[in] function The function code of the response from the VT
+		void process_command_response(std::uint8_t function);
+
+		/// @brief Removes all queued and pending commands
+		void clear_command_queue();
+
+		/// @brief Sends the oldest queued string value, if no other string value is being sent
+		void process_string_value_queue();
+
+		/// @brief Records the result of sending a string value that needed the transport layer
+		/// @param[in] successful true if the transfer completed
+		void process_string_value_transmit_complete(bool successful);
+
+		/// @brief Forgets that the VT has the last value sent for an object, because it was changed on the VT
+		/// @param[in] objectID The object whose value was changed
+		void invalidate_string_value(std::uint16_t objectID);
+
+		/// @brief Forgets all queued and previously sent string values
+		void clear_string_values();
+
+		/// @brief Marks every known string value as unsent and queues it, so the VT gets all of them again
+		void requeue_string_values();
+
+		/// @brief Remembers a command as the latest change to an object, if it sets a value.
+		/// objectPoolDeltaMutex must be held, so that a replay can't send an older value in between.
+		/// @param[in] data The 8 byte command
+		/// @param[in] sent Tells if the command was just sent or queued, so that a replay doesn't need to send it
+		void record_object_pool_delta(const std::uint8_t *data, bool sent);
+
+		/// @brief Sends recorded object pool deltas after a reconnect until the bus or the command queue is full
+		void process_object_pool_delta_replay();
+
+		/// @brief Sends queued graphics context batch messages until one needs to wait on the transport layer
+		void process_graphics_batch_queue();
+
+		/// @brief Records the result of sending a graphics context batch message that needed the transport layer
+		/// @param[in] successful true if the transfer completed
+		void process_graphics_batch_transmit_complete(bool successful);
+
+		/// @brief Removes all queued graphics context batch messages
+		void clear_graphics_batch_queue();
+
 		// Object Pool Managment
+		/// @brief Parses an object pool that was assigned from memory and stores its index
+		/// @param[in] poolIndex The index of the pool being assigned
+		/// @param[in] pool A pointer to the object pool
+		/// @param[in] size The object pool size
+		void index_object_pool(std::uint8_t poolIndex, const std::uint8_t *pool, std::uint32_t size);
+
+		/// @brief Checks that every pool assigned from memory parsed correctly
+		/// @returns true if no assigned pool is invalid, otherwise false
+		bool get_are_object_pools_valid() const;
+
+		/// @brief Returns the index of a pool's objects, which is shared if the pool came from an image
+		/// @param[in] poolIndex The index of the pool
+		/// @returns The pool's object index
+		const ObjectPoolIndex &get_object_pool_index(std::uint32_t poolIndex) const;
+
 		/// @brief Sends the delete object pool message
 		/// @returns true if the message was sent
 		bool send_delete_object_pool();
@@ -1138,6 +1543,10 @@ namespace isobus
 		/// @returns true if the message was sent
 		bool send_working_set_master();
 
+		/// @brief Returns the network manager of the client's internal control function
+		/// @returns The network manager to send with, or the default one if the client has no internal control function
+		CANNetworkManager &get_network_manager() const;
+
 		/// @brief Sets the state machine state and updates the associated timestamp
 		/// @param[in] value The new state for the state machine
 		void set_state(StateMachineState value);
@@ -1182,7 +1591,7 @@ namespace isobus
 		/// @param[in] parentPointer A context variable to find the relevant VT client class
 		static void process_rx_message(CANMessage *message, void *parentPointer);
 
-		/// @brief The callback passed to the network manager's send function to know when a Tx is completed
+		/// @brief The callback passed to the network manager's send function to know when an object pool transfer is completed
 		static void process_callback(std::uint32_t parameterGroupNumber,
 		                             std::uint32_t dataLength,
 		                             InternalControlFunction *sourceControlFunction,
@@ -1190,6 +1599,22 @@ namespace isobus
 		                             bool successful,
 		                             void *parentPointer);
 
+		/// @brief The callback passed to the network manager's send function to know when a string value transfer is completed
+		static void process_string_value_callback(std::uint32_t parameterGroupNumber,
+		                                          std::uint32_t dataLength,
+		                                          InternalControlFunction *sourceControlFunction,
+		                                          ControlFunction *destinationControlFunction,
+		                                          bool successful,
+		                                          void *parentPointer);
+
+		/// @brief The callback passed to the network manager's send function to know when a graphics context batch transfer is completed
+		static void process_graphics_batch_callback(std::uint32_t parameterGroupNumber,
+		                                            std::uint32_t dataLength,
+		                                            InternalControlFunction *sourceControlFunction,
+		                                            ControlFunction *destinationControlFunction,
+		                                            bool successful,
+		                                            void *parentPointer);
+
 		/// @brief The data callback passed to the network manger's send function for the transport layer messages
 		/// @details We upload the data with callbacks to avoid making a complete copy of the pool to
 		/// accommodate the multiplexor that needs to get passed to the transport layer message's first byte.
@@ -1205,11 +1630,47 @@ namespace isobus
 		                                                         std::uint8_t *chunkBuffer,
 		                                                         void *parentPointer);
 
+		/// @brief Calculates the version label used to cache the assigned object pools on the VT
+		/// @details The label is a 64 bit FNV-1a hash of the pools' contents, written as 7 base 36 digits (0-9, A-Z).
+		/// That keeps about 36 bits of the hash, using only characters that any VT can store in a label.
+		/// The result is kept until a pool is assigned again.
+		/// @param[out] versionLabel The version label for the assigned pools
+		/// @returns true if the label was calculated, false if some pool data could not be read
+		bool get_object_pool_version_label(std::array<std::uint8_t, 7> &versionLabel);
+
+		/// @brief Copies a chunk of an object pool, wherever the pool's data comes from
+		/// @param[in] poolIndex The index of the pool to read from
+		/// @param[in] callbackIndex The number of times the transport layer has asked for data, passed on to user callbacks
+		/// @param[in] poolOffset The byte offset into the pool at which to get data
+		/// @param[in] numberOfBytes The number of bytes to get
+		/// @param[out] chunkBuffer Where to copy the data to
+		/// @returns true if the data was copied into chunkBuffer
+		bool get_object_pool_chunk(std::uint32_t poolIndex, std::uint32_t callbackIndex, std::uint32_t poolOffset, std::uint32_t numberOfBytes, std::uint8_t *chunkBuffer);
+
+		/// @brief Returns how long the client can wait before update has something to do
+		/// @details Accounts for the working set maintenance message, the VT status timeout, and the command queue.
+		/// Incoming messages and newly queued work wake the worker thread early, so this only covers timers.
+		/// @returns The time until the next deadline in milliseconds
+		std::uint32_t get_time_until_next_update_ms();
+
+		/// @brief Wakes the worker thread so that it calls update right away
+		void wake_worker_thread();
+
 		/// @brief The worker thread will execute this function when it runs, if applicable
 		void worker_thread_function();
 
 		static constexpr std::uint32_t VT_STATUS_TIMEOUT_MS = 3000; ///< The max allowable time between VT status messages before its considered offline
 		static constexpr std::uint32_t WORKING_SET_MAINTENANCE_TIMEOUT_MS = 1000; ///< The frequency at which we send the working set maintenance message
+		static constexpr std::uint32_t OBJECT_POOL_UPLOAD_RETRY_DELAY_MS = 250; ///< How long to wait before retrying an object pool transfer that was aborted
+		static constexpr std::uint8_t MAX_OBJECT_POOL_UPLOAD_ATTEMPTS = 5; ///< How many times we try to transfer each object pool before giving up
+		static constexpr std::uint32_t OBJECT_POOL_HASH_CHUNK_SIZE = 256; ///< The number of bytes read at a time when hashing pools that use a data chunk callback
+		static constexpr std::uint32_t MAX_UPDATE_WAIT_MS = 1000; ///< The longest the worker thread sleeps when nothing is due
+		static constexpr std::uint32_t CONNECTING_UPDATE_INTERVAL_MS = 50; ///< How often the worker thread updates while connecting, for retries and timeouts
+		static constexpr std::uint32_t UPDATE_RETRY_INTERVAL_MS = 10; ///< How soon the worker thread tries again when a due message could not be sent
+		static constexpr std::uint32_t COMMAND_RESPONSE_TIMEOUT_MS = 1500; ///< How long a queued command counts as pending if the VT doesn't respond to it
+		static constexpr std::uint32_t MAX_COMMAND_QUEUE_SIZE = 256; ///< The most commands that can wait in the command queue
+		static constexpr std::uint32_t MAX_GRAPHICS_BATCH_QUEUE_BYTES = 65536; ///< The most bytes of graphics context messages that can wait to be sent
+		static constexpr std::uint8_t VT_BUSY_CODES_LIMITING_COMMANDS = 0x9D; ///< Busy updating mask, executing a command or macro, parsing a pool, or out of memory
 
 		std::shared_ptr<PartneredControlFunction> partnerControlFunction; ///< The partner control function this client will send to
 		std::shared_ptr<InternalControlFunction> myControlFunction; ///< The internal control function the client uses to send from
@@ -1254,6 +1715,9 @@ namespace isobus
 		std::vector<VTSelectInputObjectCallback> selectInputObjectCallbacks; ///< A list of all select input object callbacks
 		std::vector<ObjectPoolDataStruct> objectPools; ///< A container to hold all object pools that have been assigned to the interface
 		std::thread *workerThread; ///< The worker thread that updates this interface
+		std::mutex workerWakeMutex; ///< Protects workerWakeRequested
+		std::condition_variable workerWakeCondition; ///< Signalled to wake the worker thread before its next deadline
+		bool workerWakeRequested; ///< Tells the worker thread that it has work to do
 		bool initialized; ///< Stores the client initialization state
 		bool sendWorkingSetMaintenenace; ///< Used internally to enable and disable cyclic sending of the maintenance message
 		bool shouldTerminate; ///< Used to determine if the client should exit and join the worker thread
@@ -1261,7 +1725,45 @@ namespace isobus
 		// Object Pool info
 		DataChunkCallback objectPoolDataCallback; ///< The callback to use to get pool data
 		std::uint32_t objectPoolSize_bytes; ///< Total object pool size aggregate
+		std::uint32_t objectPoolUploadedBytes; ///< The number of bytes in pools that have been completely uploaded
+		std::uint32_t currentObjectPoolUploadedBytes; ///< The number of bytes of the pool currently being uploaded that have been handed to the transport layer
+		std::uint32_t objectPoolUploadRetryTimestamp_ms; ///< Timestamp from the last failed object pool transfer
 		std::uint32_t lastObjectPoolIndex; ///< The last object pool index that was processed
+		std::uint8_t objectPoolUploadAttempts; ///< The number of failed transfers of the pool currently being uploaded
+		std::array<std::uint8_t, 7> objectPoolVersionLabel; ///< The cached version label of the assigned pools
+		bool objectPoolVersionLabelValid; ///< Tells if objectPoolVersionLabel matches the currently assigned pools
+		bool objectPoolVersionCaching; ///< Enables trying to load the pool from the VT's stored versions before uploading it
+
+		// Command queue
+		std::deque<QueuedCommand> commandQueue; ///< Single frame commands waiting to be sent
+		std::deque<PendingCommand> pendingCommands; ///< Commands that were sent from the queue and are waiting on a response
+		mutable std::mutex commandQueueMutex; ///< Protects the command queue and pending commands
+		std::uint32_t commandQueueTimestamp_ms; ///< Tracks when the rate limit allows the next queued command to be sent
+		std::uint32_t commandQueueInterval_ms; ///< The minimum average time between commands sent from the queue
+		std::uint8_t commandQueueMaxPendingResponses; ///< How many queued commands may wait on a response at once
+		std::atomic_bool commandQueueEnabled; ///< Tells if single frame commands are queued instead of sent right away
+
+		// String values
+		std::unordered_map<std::uint16_t, StringValueState> stringValues; ///< The string value of each object that has been changed
+		std::vector<std::uint16_t> stringValueQueue; ///< Objects with a string value waiting to be sent, oldest first
+		std::vector<std::uint8_t> stringCommandBuffer; ///< Reused to encode change string value commands, so sending doesn't allocate
+		std::mutex stringValueMutex; ///< Protects the string values, the queue, and the command buffer
+		std::uint16_t stringValueInFlightObjectID; ///< The object whose string value is being sent with the transport layer, or NULL_OBJECT_ID
+
+		// Graphics context batches
+		std::vector<std::uint8_t> graphicsBatchData; ///< Queued graphics context messages, back to back
+		std::vector<std::uint16_t> graphicsBatchLengths; ///< The length of each queued graphics context message
+		std::mutex graphicsBatchMutex; ///< Protects the graphics context batch queue
+		std::uint32_t graphicsBatchDataOffset; ///< The offset in graphicsBatchData of the next message to send
+		std::uint32_t graphicsBatchIndex; ///< The index in graphicsBatchLengths of the next message to send
+		bool graphicsBatchInFlight; ///< Tells if a graphics context message is being sent with the transport layer
+
+		// Object pool deltas
+		std::vector<ObjectPoolDelta> objectPoolDeltas; ///< The latest command for each changed object and attribute, in the order they were first changed
+		std::unordered_map<std::uint64_t, std::size_t> objectPoolDeltaIndices; ///< Maps a command's function and key to its index in objectPoolDeltas
+		mutable std::mutex objectPoolDeltaMutex; ///< Protects the object pool deltas and the replay index
+		std::size_t objectPoolDeltaReplayIndex; ///< The index of the next delta to check for a pending replay
+		std::atomic_bool objectPoolDeltaReplayEnabled; ///< Tells if changes are recorded and restored on reconnect
 	};
 
 } // namespace isobus
@@ -29,6 +29,7 @@
 #include "isobus/isobus/can_internal_control_function.hpp"
 #include "isobus/isobus/can_managed_message.hpp"
 #include "isobus/isobus/can_protocol.hpp"
+#include "isobus/isobus/can_protocol_statistics.hpp"
 
 #include <mutex>
 
@@ -38,7 +39,14 @@ namespace isobus
 	class FastPacketProtocol : public CANLibProtocol
 	{
 	public:
-		static FastPacketProtocol Protocol; ///< Static instance of the protocol
+		static FastPacketProtocol &Protocol; ///< The protocol of the default network manager
+
+		/// @brief The constructor for a FastPacketProtocol
+		/// @param[in] parentNetworkManager The network manager that owns the protocol
+		explicit FastPacketProtocol(CANNetworkManager &parentNetworkManager);
+
+		/// @brief The destructor for a FastPacketProtocol, which ends any sessions still in progress
+		virtual ~FastPacketProtocol();
 
 		/// @brief A generic way to initialize a protocol
 		/// @details The network manager will call a protocol's initialize function
@@ -84,6 +92,11 @@ namespace isobus
 		/// @brief This will be called by the network manager on every cyclic update of the stack
 		void update(CANLibBadge<CANNetworkManager>) override;
 
+		/// @brief Returns the counters for the sessions of the default network manager's protocol
+		/// @details Fast packet has no aborts or retransmits, so only the session counters are used.
+		/// @returns The statistics for the protocol
+		static const ProtocolStatistics &get_statistics();
+
 	private:
 		/// @brief An object for tracking fast packet session state
 		class FastPacketProtocolSession
@@ -115,6 +128,7 @@ namespace isobus
 			DataChunkCallback frameChunkCallback; ///< A callback that might be used to get chunks of data to send
 			void *parent; ///< A generic context variable that helps identify what object callbacks are destined for. Can be nullptr
 			std::uint32_t timestamp_ms; ///< A timestamp used to track session timeouts
+			const std::uint32_t sessionStartTimestamp_ms; ///< When the session was created, used to measure how long it takes
 			std::uint16_t lastPacketNumber; ///< The last processed sequence number for this set of packets
 			std::uint8_t packetCount; ///< The total number of packets to receive or send in this session
 			std::uint8_t processedPacketsThisSession; ///< The total processed packet count for the whole session so far
@@ -160,6 +174,15 @@ namespace isobus
 		/// @param[in] parent Provides the context to the actual FP manager object
 		static void process_message(CANMessage *const message, void *parent);
 
+		/// @brief Returns which direction a session counts as in the protocol's statistics
+		/// @param[in] session The session to check
+		/// @returns The direction of the session
+		static ProtocolStatistics::Direction get_statistics_direction(const FastPacketProtocolSession *session);
+
+		/// @brief Counts a session that finished transferring all its data in the protocol's statistics
+		/// @param[in] session The session that completed
+		void record_session_completed(const FastPacketProtocolSession *session);
+
 		/// @brief Processes end of session callbacks
 		/// @param[in] session The session we've just completed
 		/// @param[in] success Denotes if the session was successful
@@ -201,6 +224,7 @@ namespace isobus
 		std::vector<FastPacketHistory> sessionHistory; ///< Used to keep track of sequence numbers for future sessions
 		std::vector<ParameterGroupNumberCallbackData> parameterGroupNumberCallbacks; ///< A list of all parameter group number callbacks that will be parsed as fast packet messages
 		std::mutex sessionMutex; ///< A mutex to lock the sessions list in case someone starts a Tx while the stack is processing sessions
+		ProtocolStatistics statistics; ///< Counters for the sessions of the protocol
 	};
 
 } // namespace isobus
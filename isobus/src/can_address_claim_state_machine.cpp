@@ -9,6 +9,7 @@
 #include "isobus/isobus/can_address_claim_state_machine.hpp"
 #include "isobus/isobus/can_constants.hpp"
 #include "isobus/isobus/can_general_parameter_group_numbers.hpp"
+#include "isobus/isobus/can_network_configuration.hpp"
 #include "isobus/isobus/can_network_manager.hpp"
 #include "isobus/utility/system_timing.hpp"
 
@@ -18,7 +19,8 @@
 
 namespace isobus
 {
-	AddressClaimStateMachine::AddressClaimStateMachine(std::uint8_t preferredAddressValue, NAME ControlFunctionNAME, std::uint8_t portIndex) :
+	AddressClaimStateMachine::AddressClaimStateMachine(std::uint8_t preferredAddressValue, NAME ControlFunctionNAME, std::uint8_t portIndex, CANNetworkManager &parentNetworkManager) :
+	  m_networkManager(parentNetworkManager),
 	  m_isoname(ControlFunctionNAME),
 	  m_currentState(State::None),
 	  m_timestamp_ms(0),
@@ -33,14 +35,14 @@ namespace isobus
 		std::default_random_engine generator;
 		std::uniform_int_distribution<std::uint8_t> distribution(0, 255);
 		m_randomClaimDelay_ms = distribution(generator) * 0.6f; // Defined by ISO part 5
-		CANNetworkManager::CANNetwork.add_global_parameter_group_number_callback(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ParameterGroupNumberRequest), process_rx_message, this);
-		CANNetworkManager::CANNetwork.add_global_parameter_group_number_callback(static_cast<std::uint32_t>(CANLibParameterGroupNumber::AddressClaim), process_rx_message, this);
+		m_networkManager.add_global_parameter_group_number_callback(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ParameterGroupNumberRequest), process_rx_message, this);
+		m_networkManager.add_global_parameter_group_number_callback(static_cast<std::uint32_t>(CANLibParameterGroupNumber::AddressClaim), process_rx_message, this);
 	}
 
 	AddressClaimStateMachine ::~AddressClaimStateMachine()
 	{
-		CANNetworkManager::CANNetwork.remove_global_parameter_group_number_callback(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ParameterGroupNumberRequest), process_rx_message, this);
-		CANNetworkManager::CANNetwork.remove_global_parameter_group_number_callback(static_cast<std::uint32_t>(CANLibParameterGroupNumber::AddressClaim), process_rx_message, this);
+		m_networkManager.remove_global_parameter_group_number_callback(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ParameterGroupNumberRequest), process_rx_message, this);
+		m_networkManager.remove_global_parameter_group_number_callback(static_cast<std::uint32_t>(CANLibParameterGroupNumber::AddressClaim), process_rx_message, this);
 	}
 
 	AddressClaimStateMachine::State AddressClaimStateMachine::get_current_state() const
@@ -103,7 +105,7 @@ namespace isobus
 
 					if (SystemTiming::time_expired_ms(m_timestamp_ms, addressContentionTime_ms + m_randomClaimDelay_ms))
 					{
-						ControlFunction *deviceAtOurPreferredAddress = CANNetworkManager::CANNetwork.get_control_function(m_portIndex, m_preferredAddress, {});
+						ControlFunction *deviceAtOurPreferredAddress = m_networkManager.get_control_function(m_portIndex, m_preferredAddress, {});
 						// Time to find a free address
 						if (nullptr == deviceAtOurPreferredAddress)
 						{
@@ -157,7 +159,7 @@ namespace isobus
 
 					for (std::uint8_t i = 128; i <= 247; i++)
 					{
-						if ((nullptr == CANNetworkManager::CANNetwork.get_control_function(m_portIndex, i, {})) && (send_address_claim(i)))
+						if ((nullptr == m_networkManager.get_control_function(m_portIndex, i, {})) && (send_address_claim(i)))
 						{
 							addressFound = true;
 							set_current_state(State::AddressClaimingComplete);
@@ -174,7 +176,9 @@ namespace isobus
 
 				case State::SendReclaimAddressOnRequest:
 				{
-					if (send_address_claim(m_claimedAddress))
+					// Wait out the coalescing window so that a burst of requests gets a single claim
+					if ((SystemTiming::time_expired_ms(m_timestamp_ms, CANNetworkConfiguration::get_request_coalescing_window())) &&
+					    (send_address_claim(m_claimedAddress)))
 					{
 						set_current_state(State::AddressClaimingComplete);
 					}
@@ -220,9 +224,13 @@ namespace isobus
 						requestedPGN |= (static_cast<std::uint32_t>(messageData.at(1)) << 8);
 						requestedPGN |= (static_cast<std::uint32_t>(messageData.at(2)) << 16);
 
+						// Requests that arrive while a reclaim is already pending are answered by that same claim
 						if ((static_cast<std::uint32_t>(CANLibParameterGroupNumber::AddressClaim) == requestedPGN) &&
-						    (State::AddressClaimingComplete == parent->get_current_state()))
+						    (State::AddressClaimingComplete == parent->get_current_state()) &&
+						    ((BROADCAST_CAN_ADDRESS == message->get_identifier().get_destination_address()) ||
+						     (parent->m_claimedAddress == message->get_identifier().get_destination_address())))
 						{
+							parent->m_timestamp_ms = SystemTiming::get_timestamp_ms();
 							parent->set_current_state(State::SendReclaimAddressOnRequest);
 						}
 					}
@@ -284,14 +292,14 @@ namespace isobus
 			dataBuffer[1] = ((PGN >> 8) & std::numeric_limits<std::uint8_t>::max());
 			dataBuffer[2] = ((PGN >> 16) & std::numeric_limits<std::uint8_t>::max());
 
-			retVal = CANNetworkManager::CANNetwork.send_can_message_raw(m_portIndex,
-			                                                            NULL_CAN_ADDRESS,
-			                                                            BROADCAST_CAN_ADDRESS,
-			                                                            static_cast<std::uint32_t>(CANLibParameterGroupNumber::ParameterGroupNumberRequest),
-			                                                            static_cast<std::uint8_t>(CANIdentifier::CANPriority::PriorityDefault6),
-			                                                            dataBuffer,
-			                                                            3,
-			                                                            {});
+			retVal = m_networkManager.send_can_message_raw(m_portIndex,
+			                                               NULL_CAN_ADDRESS,
+			                                               BROADCAST_CAN_ADDRESS,
+			                                               static_cast<std::uint32_t>(CANLibParameterGroupNumber::ParameterGroupNumberRequest),
+			                                               static_cast<std::uint8_t>(CANIdentifier::CANPriority::PriorityDefault6),
+			                                               dataBuffer,
+			                                               3,
+			                                               {});
 		}
 		return retVal;
 	}
@@ -315,14 +323,14 @@ namespace isobus
 			dataBuffer[5] = static_cast<uint8_t>(isoNAME >> 40);
 			dataBuffer[6] = static_cast<uint8_t>(isoNAME >> 48);
 			dataBuffer[7] = static_cast<uint8_t>(isoNAME >> 56);
-			retVal = CANNetworkManager::CANNetwork.send_can_message_raw(m_portIndex,
-			                                                            address,
-			                                                            BROADCAST_CAN_ADDRESS,
-			                                                            static_cast<std::uint32_t>(CANLibParameterGroupNumber::AddressClaim),
-			                                                            static_cast<std::uint8_t>(CANIdentifier::CANPriority::PriorityDefault6),
-			                                                            dataBuffer,
-			                                                            CAN_DATA_LENGTH,
-			                                                            {});
+			retVal = m_networkManager.send_can_message_raw(m_portIndex,
+			                                               address,
+			                                               BROADCAST_CAN_ADDRESS,
+			                                               static_cast<std::uint32_t>(CANLibParameterGroupNumber::AddressClaim),
+			                                               static_cast<std::uint8_t>(CANIdentifier::CANPriority::PriorityDefault6),
+			                                               dataBuffer,
+			                                               CAN_DATA_LENGTH,
+			                                               {});
 			if (retVal)
 			{
 				m_claimedAddress = address;
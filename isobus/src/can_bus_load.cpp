@@ -0,0 +1,301 @@
+//================================================================================================
+/// @file can_bus_load.cpp
+///
+/// @brief Works out exactly how many bits a frame takes on the bus, including stuff bits, and
+/// estimates how busy a bus is and how much room is left on it from the frames seen on it.
+/// @author Adrian Del Grosso
+///
+/// @copyright 2022 Adrian Del Grosso
+//================================================================================================
+#include "isobus/isobus/can_bus_load.hpp"
+
+#include "isobus/utility/system_timing.hpp"
+
+#include <algorithm>
+
+namespace isobus
+{
+	namespace
+	{
+		//================================================================================================
+		/// @class StuffBitCounter
+		///
+		/// @brief Runs the stuffed part of a frame through the CRC, and counts the stuff bits it needs
+		/// @details A stuff bit of the opposite value is sent after every 5 bits in a row with the same
+		/// value, and the stuff bit counts towards the next run.
+		//================================================================================================
+		class StuffBitCounter
+		{
+		public:
+			/// @brief Constructor for a frame with no bits yet
+			StuffBitCounter() :
+			  crc(0),
+			  numberOfStuffBits(0),
+			  runLength(0),
+			  lastBit(false)
+			{
+			}
+
+			/// @brief Adds a field of the frame, which is also added to the CRC
+			/// @param[in] value The value of the field
+			/// @param[in] numberOfBits The number of bits in the field, which are sent most significant bit first
+			void add_field(std::uint32_t value, std::uint8_t numberOfBits)
+			{
+				for (std::uint8_t i = numberOfBits; i > 0; i--)
+				{
+					const bool bit = (0 != ((value >> (i - 1)) & 0x01));
+					const bool crcNext = (bit != (0 != ((crc >> 14) & 0x01)));
+
+					crc = ((crc << 1) & 0x7FFF);
+					if (crcNext)
+					{
+						crc ^= CRC_15_POLYNOMIAL;
+					}
+					add_bit(bit);
+				}
+			}
+
+			/// @brief Adds the CRC of all the fields so far, which ends the stuffed part of the frame
+			void add_crc()
+			{
+				const std::uint16_t frameCRC = crc;
+
+				for (std::uint8_t i = 15; i > 0; i--)
+				{
+					add_bit(0 != ((frameCRC >> (i - 1)) & 0x01));
+				}
+			}
+
+			/// @brief Returns the number of stuff bits needed so far
+			/// @returns The number of stuff bits
+			std::uint32_t get_number_stuff_bits() const
+			{
+				return numberOfStuffBits;
+			}
+
+		private:
+			static constexpr std::uint16_t CRC_15_POLYNOMIAL = 0x4599; ///< The CAN CRC polynomial, x^15 + x^14 + x^10 + x^8 + x^7 + x^4 + x^3 + 1
+
+			/// @brief Counts a bit towards the current run, and a stuff bit if the run is long enough
+			/// @param[in] bit The value of the bit, where `true` is recessive
+			void add_bit(bool bit)
+			{
+				if ((0 != runLength) &&
+				    (bit == lastBit))
+				{
+					runLength++;
+				}
+				else
+				{
+					runLength = 1;
+					lastBit = bit;
+				}
+
+				if (5 == runLength)
+				{
+					// The stuff bit starts the next run
+					numberOfStuffBits++;
+					lastBit = !bit;
+					runLength = 1;
+				}
+			}
+
+			std::uint16_t crc; ///< The CRC of the fields so far
+			std::uint32_t numberOfStuffBits; ///< The number of stuff bits needed so far
+			std::uint8_t runLength; ///< The number of bits in a row with the value `lastBit`
+			bool lastBit; ///< The value of the last bit sent, including stuff bits
+		};
+
+		constexpr std::uint16_t StuffBitCounter::CRC_15_POLYNOMIAL;
+	} // namespace
+
+	constexpr std::uint32_t CANBusLoad::DEFAULT_BIT_RATE;
+	constexpr float CANBusLoad::DEFAULT_MAXIMUM_BUS_LOAD;
+	constexpr std::uint32_t CANBusLoad::SLOT_MS;
+	constexpr std::uint32_t CANBusLoad::WINDOW_MS;
+	constexpr std::uint32_t CANBusLoad::FRAME_UNSTUFFED_BITS;
+	constexpr std::uint32_t CANBusLoad::STANDARD_FRAME_STUFFED_BITS;
+	constexpr std::uint32_t CANBusLoad::EXTENDED_FRAME_STUFFED_BITS;
+	constexpr std::uint32_t CANBusLoad::NUMBER_OF_SLOTS;
+	constexpr std::uint32_t CANBusLoad::SLOT_NUMBER_SHIFT;
+
+	CANBusLoad::CANBusLoad() :
+	  firstSlotNumber(get_current_slot_number()),
+	  bitRate(DEFAULT_BIT_RATE),
+	  maximumBusLoad(DEFAULT_MAXIMUM_BUS_LOAD)
+	{
+		for (auto &slot : slots)
+		{
+			slot.store(0, std::memory_order_relaxed);
+		}
+	}
+
+	void CANBusLoad::set_bit_rate(std::uint32_t bitRate)
+	{
+		if (0 != bitRate)
+		{
+			this->bitRate.store(bitRate, std::memory_order_relaxed);
+		}
+	}
+
+	std::uint32_t CANBusLoad::get_bit_rate() const
+	{
+		return bitRate.load(std::memory_order_relaxed);
+	}
+
+	void CANBusLoad::set_maximum_bus_load(float percent)
+	{
+		maximumBusLoad.store(std::min(std::max(percent, 0.0f), 100.0f), std::memory_order_relaxed);
+	}
+
+	float CANBusLoad::get_maximum_bus_load() const
+	{
+		return maximumBusLoad.load(std::memory_order_relaxed);
+	}
+
+	void CANBusLoad::add_frame(const HardwareInterfaceCANFrame &frame)
+	{
+		add_frame_bits(get_frame_bit_length(frame));
+	}
+
+	void CANBusLoad::add_frame_bits(std::uint32_t frameBits)
+	{
+		const std::uint64_t slotNumber = get_current_slot_number();
+		const std::uint32_t slotTag = static_cast<std::uint32_t>(slotNumber);
+		std::atomic<std::uint64_t> &slot = slots[slotNumber % slots.size()];
+		std::uint64_t oldValue = slot.load(std::memory_order_relaxed);
+		std::uint64_t newValue;
+
+		do
+		{
+			const std::uint32_t oldSlotTag = static_cast<std::uint32_t>(oldValue >> SLOT_NUMBER_SHIFT);
+
+			if (slotTag == oldSlotTag)
+			{
+				newValue = oldValue + frameBits;
+			}
+			else if (static_cast<std::int32_t>(slotTag - oldSlotTag) > 0)
+			{
+				// The slot was last used a whole window ago, so it starts over with this frame
+				newValue = ((static_cast<std::uint64_t>(slotTag) << SLOT_NUMBER_SHIFT) | frameBits);
+			}
+			else
+			{
+				// This thread was held up until the slot was reused for a later time, so the frame is too old to count
+				newValue = oldValue;
+			}
+		} while ((newValue != oldValue) &&
+		         (!slot.compare_exchange_weak(oldValue, newValue, std::memory_order_relaxed, std::memory_order_relaxed)));
+	}
+
+	float CANBusLoad::get_bus_load() const
+	{
+		return get_bus_load_before_slot(get_current_slot_number());
+	}
+
+	float CANBusLoad::get_headroom() const
+	{
+		return std::max(maximumBusLoad.load(std::memory_order_relaxed) - get_bus_load(), 0.0f);
+	}
+
+	std::uint32_t CANBusLoad::get_headroom_bits_per_second() const
+	{
+		return static_cast<std::uint32_t>((get_headroom() * static_cast<float>(bitRate.load(std::memory_order_relaxed))) / 100.0f);
+	}
+
+	void CANBusLoad::reset()
+	{
+		for (auto &slot : slots)
+		{
+			slot.store(0, std::memory_order_relaxed);
+		}
+		firstSlotNumber.store(get_current_slot_number(), std::memory_order_relaxed);
+	}
+
+	std::uint32_t CANBusLoad::get_frame_bit_length(const HardwareInterfaceCANFrame &frame)
+	{
+		const std::uint8_t dataLength = std::min<std::uint8_t>(frame.dataLength, 8);
+		StuffBitCounter counter;
+		std::uint32_t retVal;
+
+		// Start of frame, which is dominant
+		counter.add_field(0, 1);
+
+		if (frame.isExtendedFrame)
+		{
+			counter.add_field((frame.identifier >> 18) & 0x7FF, 11);
+			// SRR and IDE, which are recessive
+			counter.add_field(0x03, 2);
+			counter.add_field(frame.identifier & 0x3FFFF, 18);
+			// RTR, r1 and r0, which are dominant for a data frame
+			counter.add_field(0, 3);
+			retVal = EXTENDED_FRAME_STUFFED_BITS;
+		}
+		else
+		{
+			counter.add_field(frame.identifier & 0x7FF, 11);
+			// RTR, IDE and r0, which are dominant for a standard data frame
+			counter.add_field(0, 3);
+			retVal = STANDARD_FRAME_STUFFED_BITS;
+		}
+		counter.add_field(dataLength, 4);
+
+		for (std::uint8_t i = 0; i < dataLength; i++)
+		{
+			counter.add_field(frame.data[i], 8);
+		}
+		counter.add_crc();
+
+		retVal += (8 * dataLength) + counter.get_number_stuff_bits() + FRAME_UNSTUFFED_BITS;
+		return retVal;
+	}
+
+	std::uint32_t CANBusLoad::get_worst_case_frame_bit_length(bool isExtendedFrame, std::uint8_t dataLength)
+	{
+		const std::uint32_t stuffedBits = (isExtendedFrame ? EXTENDED_FRAME_STUFFED_BITS : STANDARD_FRAME_STUFFED_BITS) + (8 * std::min<std::uint32_t>(dataLength, 8));
+
+		return stuffedBits + ((stuffedBits - 1) / 4) + FRAME_UNSTUFFED_BITS;
+	}
+
+	std::uint64_t CANBusLoad::get_bit_time_us(std::uint64_t bitLength, std::uint32_t bitRate)
+	{
+		std::uint64_t retVal = 0;
+
+		if (0 != bitRate)
+		{
+			retVal = (((bitLength * 1000000) + bitRate - 1) / bitRate);
+		}
+		return retVal;
+	}
+
+	std::uint64_t CANBusLoad::get_current_slot_number()
+	{
+		return SystemTiming::get_timestamp_us() / (SLOT_MS * 1000);
+	}
+
+	float CANBusLoad::get_bus_load_before_slot(std::uint64_t currentSlotNumber) const
+	{
+		const std::uint64_t slotsSinceReset = currentSlotNumber - std::min(firstSlotNumber.load(std::memory_order_relaxed), currentSlotNumber);
+		const std::uint64_t numberOfFullSlots = std::min<std::uint64_t>(slotsSinceReset, NUMBER_OF_SLOTS);
+		std::uint64_t windowBits = 0;
+		float retVal = 0.0f;
+
+		for (std::uint64_t i = 1; i <= numberOfFullSlots; i++)
+		{
+			const std::uint64_t slotNumber = currentSlotNumber - i;
+			const std::uint64_t slotValue = slots[slotNumber % slots.size()].load(std::memory_order_relaxed);
+
+			// A slot that hasn't been used since an earlier window had no traffic in this one
+			if (static_cast<std::uint32_t>(slotNumber) == static_cast<std::uint32_t>(slotValue >> SLOT_NUMBER_SHIFT))
+			{
+				windowBits += static_cast<std::uint32_t>(slotValue);
+			}
+		}
+
+		if (0 != numberOfFullSlots)
+		{
+			retVal = static_cast<float>((100.0 * 1000.0 * static_cast<double>(windowBits)) / (static_cast<double>(bitRate.load(std::memory_order_relaxed)) * static_cast<double>(numberOfFullSlots * SLOT_MS)));
+		}
+		return retVal;
+	}
+} // namespace isobus
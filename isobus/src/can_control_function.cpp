@@ -10,20 +10,31 @@
 #include "isobus/isobus/can_control_function.hpp"
 
 #include "isobus/isobus/can_constants.hpp"
+#include "isobus/isobus/can_network_manager.hpp"
 
 namespace isobus
 {
 	ControlFunction::ControlFunction(NAME NAMEValue, std::uint8_t addressValue, std::uint8_t CANPort) :
+	  ControlFunction(NAMEValue, addressValue, CANPort, CANNetworkManager::CANNetwork)
+	{
+	}
+
+	ControlFunction::ControlFunction(NAME NAMEValue, std::uint8_t addressValue, std::uint8_t CANPort, CANNetworkManager &parentNetworkManager) :
+	  networkManager(parentNetworkManager),
 	  controlFunctionNAME(NAMEValue),
 	  controlFunctionType(Type::External),
 	  address(addressValue),
 	  canPortIndex(CANPort)
-
 	{
 	}
 
 	ControlFunction::~ControlFunction()
 	{
+		// External control functions are only destroyed by their network manager, which has already forgotten them
+		if (Type::External != controlFunctionType)
+		{
+			networkManager.remove_control_function(this, {});
+		}
 	}
 
 	std::uint8_t ControlFunction::get_address() const
@@ -51,4 +62,9 @@ namespace isobus
 		return controlFunctionType;
 	}
 
+	CANNetworkManager &ControlFunction::get_network_manager() const
+	{
+		return networkManager;
+	}
+
 } // namespace isobus
@@ -10,23 +10,23 @@
 #include "isobus/isobus/can_extended_transport_protocol.hpp"
 
 #include "isobus/isobus/can_general_parameter_group_numbers.hpp"
+#include "isobus/isobus/can_latency_profiler.hpp"
 #include "isobus/isobus/can_network_configuration.hpp"
+#include "isobus/isobus/can_stack_trace.hpp"
 #include "isobus/isobus/can_warning_logger.hpp"
 #include "isobus/utility/system_timing.hpp"
-#include "isobus/utility/to_string.hpp"
 
 #include <algorithm>
 
 namespace isobus
 {
-	ExtendedTransportProtocolManager ExtendedTransportProtocolManager::Protocol;
-
 	ExtendedTransportProtocolManager::ExtendedTransportProtocolSession::ExtendedTransportProtocolSession(Direction sessionDirection, std::uint8_t canPortIndex) :
 	  state(StateMachineState::None),
 	  sessionMessage(canPortIndex),
 	  sessionCompleteCallback(nullptr),
 	  frameChunkCallback(nullptr),
 	  timestamp_ms(0),
+	  sessionStartTimestamp_ms(SystemTiming::get_timestamp_ms()),
 	  lastPacketNumber(0),
 	  packetCount(0),
 	  processedPacketsThisSession(0),
@@ -45,16 +45,26 @@ namespace isobus
 	{
 	}
 
-	ExtendedTransportProtocolManager::ExtendedTransportProtocolManager()
+	ExtendedTransportProtocolManager::ExtendedTransportProtocolManager(CANNetworkManager &parentNetworkManager) :
+	  CANLibProtocol(parentNetworkManager)
 	{
 	}
 
+	const ProtocolStatistics &ExtendedTransportProtocolManager::get_statistics()
+	{
+		return Protocol.statistics;
+	}
+
 	ExtendedTransportProtocolManager ::~ExtendedTransportProtocolManager()
 	{
 		if (initialized)
 		{
-			CANNetworkManager::CANNetwork.remove_protocol_parameter_group_number_callback(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ExtendedTransportProtocolDataTransfer), process_message, this);
-			CANNetworkManager::CANNetwork.remove_protocol_parameter_group_number_callback(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ExtendedTransportProtocolConnectionManagement), process_message, this);
+			networkManager.remove_protocol_parameter_group_number_callback(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ExtendedTransportProtocolDataTransfer), process_message, this);
+			networkManager.remove_protocol_parameter_group_number_callback(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ExtendedTransportProtocolConnectionManagement), process_message, this);
+		}
+		for (auto session : activeSessions)
+		{
+			delete session;
 		}
 	}
 
@@ -63,8 +73,8 @@ namespace isobus
 		if (!initialized)
 		{
 			initialized = true;
-			CANNetworkManager::CANNetwork.add_protocol_parameter_group_number_callback(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ExtendedTransportProtocolDataTransfer), process_message, this);
-			CANNetworkManager::CANNetwork.add_protocol_parameter_group_number_callback(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ExtendedTransportProtocolConnectionManagement), process_message, this);
+			networkManager.add_protocol_parameter_group_number_callback(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ExtendedTransportProtocolDataTransfer), process_message, this);
+			networkManager.add_protocol_parameter_group_number_callback(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ExtendedTransportProtocolConnectionManagement), process_message, this);
 		}
 	}
 
@@ -99,23 +109,25 @@ namespace isobus
 								newSession->sessionMessage.set_destination_control_function(message->get_destination_control_function());
 								newSession->packetCount = 0xFF;
 								newSession->sessionMessage.set_identifier(tempIdentifierData);
+								newSession->sessionMessage.set_timestamp_us(message->get_timestamp_us());
 								newSession->state = StateMachineState::ClearToSend;
 								newSession->timestamp_ms = SystemTiming::get_timestamp_ms();
 								activeSessions.push_back(newSession);
+								statistics.record_session_started(ProtocolStatistics::Direction::Receive);
 							}
 							else if ((get_session(session, message->get_source_control_function(), message->get_destination_control_function(), pgn)) &&
 							         (nullptr != message->get_destination_control_function()) &&
 							         (ControlFunction::Type::Internal == message->get_destination_control_function()->get_type()))
 							{
 								abort_session(pgn, ConnectionAbortReason::AlreadyInConnectionManagedSessionAndCannotSupportAnother, reinterpret_cast<InternalControlFunction *>(message->get_destination_control_function()), message->get_source_control_function());
-								CANStackLogger::CAN_stack_log("[ETP]: Abort RTS when already in session");
+								CANStackLogger::warn("[ETP]: Abort RTS when already in session");
 							}
 							else if ((activeSessions.size() >= CANNetworkConfiguration::get_max_number_transport_protcol_sessions()) &&
 							         (nullptr != message->get_destination_control_function()) &&
 							         (ControlFunction::Type::Internal == message->get_destination_control_function()->get_type()))
 							{
 								abort_session(pgn, ConnectionAbortReason::SystemResourcesNeededForAnotherTask, reinterpret_cast<InternalControlFunction *>(message->get_destination_control_function()), message->get_source_control_function());
-								CANStackLogger::CAN_stack_log("[ETP]: Abort No Sessions Available");
+								CANStackLogger::warn("[ETP]: Abort No Sessions Available");
 							}
 						}
 						break;
@@ -123,6 +135,7 @@ namespace isobus
 						case EXTENDED_CLEAR_TO_SEND_MULTIPLEXOR:
 						{
 							const std::uint8_t packetsToBeSent = data[1];
+							const std::uint32_t nextPacketNumber = (static_cast<std::uint32_t>(data[2]) | (static_cast<std::uint32_t>(data[3]) << 8) | (static_cast<std::uint32_t>(data[4]) << 16));
 
 							if (get_session(session, message->get_destination_control_function(), message->get_source_control_function(), pgn))
 							{
@@ -134,6 +147,16 @@ namespace isobus
 									// Just sit here in this state until we get a non-zero packet count
 									if (0 != packetsToBeSent)
 									{
+										// The receiver tells us where to continue from, which lets it ask for packets it missed to be sent again
+										if ((0 != nextPacketNumber) &&
+										    (((nextPacketNumber - 1) * PROTOCOL_BYTES_PER_FRAME) < session->sessionMessage.get_data_length()))
+										{
+											if (nextPacketNumber <= session->processedPacketsThisSession)
+											{
+												statistics.record_retransmit_request(session->processedPacketsThisSession - nextPacketNumber + 1);
+											}
+											session->processedPacketsThisSession = (nextPacketNumber - 1);
+										}
 										session->lastPacketNumber = 0;
 										session->state = StateMachineState::TxDataSession;
 									}
@@ -143,7 +166,7 @@ namespace isobus
 									// The session exists, but we're probably already in the TxDataSession state. Need to abort
 									// In the case of Rx'ing a CTS, we're the source in the session
 									abort_session(pgn, ConnectionAbortReason::ClearToSendReceivedWhenDataTransferInProgress, reinterpret_cast<InternalControlFunction *>(message->get_destination_control_function()), message->get_source_control_function());
-									CANStackLogger::CAN_stack_log("[ETP]: Abort CTS while in data session");
+									CANStackLogger::warn("[ETP]: Abort CTS while in data session");
 								}
 							}
 							else
@@ -151,7 +174,7 @@ namespace isobus
 								// We got a CTS but no session exists. Aborting clears up the situation faster than waiting for them to timeout
 								// In the case of Rx'ing a CTS, we're the source in the session
 								abort_session(pgn, ConnectionAbortReason::AnyOtherReason, reinterpret_cast<InternalControlFunction *>(message->get_destination_control_function()), message->get_source_control_function());
-								CANStackLogger::CAN_stack_log("[ETP]: Abort CTS With no matching session");
+								CANStackLogger::warn("[ETP]: Abort CTS With no matching session");
 							}
 						}
 						break;
@@ -168,7 +191,7 @@ namespace isobus
 								{
 									if (packetsToBeSent > session->packetCount)
 									{
-										CANStackLogger::CAN_stack_log("[ETP]: Aborting session, DPO packet count is greater than CTS");
+										CANStackLogger::warn("[ETP]: Aborting session, DPO packet count is greater than CTS");
 										abort_session(session, ConnectionAbortReason::EDPONumberOfPacketsGreaterThanClearToSend);
 										close_session(session);
 									}
@@ -177,7 +200,7 @@ namespace isobus
 										/// @note If byte 2 is less than byte 2 of the ETP.CM_CTS message, then the receiver shall make
 										/// necessary adjustments to its session to accept the data block defined by the
 										/// ETP.CM_DPO message and the subsequent ETP.DT packets.
-										CANStackLogger::CAN_stack_log("[ETP]: DPO packet count disagrees with CTS. Using DPO value.");
+										CANStackLogger::warn("[ETP]: DPO packet count disagrees with CTS. Using DPO value.");
 										session->packetCount = packetsToBeSent;
 									}
 								}
@@ -190,7 +213,7 @@ namespace isobus
 								}
 								else
 								{
-									CANStackLogger::CAN_stack_log("[ETP]: Aborting session, DPO packet offset is not valid");
+									CANStackLogger::warn("[ETP]: Aborting session, DPO packet offset is not valid");
 									abort_session(session, ConnectionAbortReason::BadEDPOOffset);
 									close_session(session);
 								}
@@ -205,7 +228,7 @@ namespace isobus
 									    (currentSession->sessionMessage.get_destination_control_function() == message->get_destination_control_function()))
 									{
 										// Sending EDPO for this session with mismatched PGN is not allowed
-										CANStackLogger::CAN_stack_log("[ETP]: Aborting session, EDPO for this session with mismatched PGN is not allowed");
+										CANStackLogger::warn("[ETP]: Aborting session, EDPO for this session with mismatched PGN is not allowed");
 										abort_session(currentSession, ConnectionAbortReason::UnexpectedEDPOPgn);
 										close_session(currentSession);
 										anySessionMatched = true;
@@ -232,6 +255,7 @@ namespace isobus
 									{
 										// We completed our Tx session!
 										session->state = StateMachineState::None;
+										record_session_completed(session);
 										process_session_complete_callback(session, true);
 										close_session(session);
 									}
@@ -240,32 +264,41 @@ namespace isobus
 										abort_session(pgn, ConnectionAbortReason::AnyOtherReason, reinterpret_cast<InternalControlFunction *>(message->get_destination_control_function()), message->get_source_control_function());
 										process_session_complete_callback(session, false);
 										close_session(session);
-										CANStackLogger::CAN_stack_log("[ETP]: Abort EOM in wrong session state");
+										CANStackLogger::warn("[ETP]: Abort EOM in wrong session state");
 									}
 								}
 								else
 								{
 									abort_session(pgn, ConnectionAbortReason::AnyOtherReason, reinterpret_cast<InternalControlFunction *>(message->get_destination_control_function()), message->get_source_control_function());
-									CANStackLogger::CAN_stack_log("[ETP]: Abort EOM without matching session");
+									CANStackLogger::warn("[ETP]: Abort EOM without matching session");
 								}
 							}
 							else
 							{
-								CANStackLogger::CAN_stack_log("[ETP]: Bad EOM received, sent to or from an invalid control function");
+								CANStackLogger::warn("[ETP]: Bad EOM received, sent to or from an invalid control function");
 							}
 						}
 						break;
 
 						case EXTENDED_CONNECTION_ABORT_MULTIPLEXOR:
 						{
+							statistics.record_abort_received(data[1]);
+							CANStackTrace::record_event(CANStackTrace::EventType::AbortReceived,
+							                            CANStackTrace::Component::ExtendedTransportProtocol,
+							                            message->get_can_port_index(),
+							                            pgn,
+							                            0,
+							                            0,
+							                            data[1]);
+
 							if (get_session(session, message->get_destination_control_function(), message->get_source_control_function(), pgn))
 							{
-								CANStackLogger::CAN_stack_log("[ETP]: Received an abort for an session with PGN: " + isobus::to_string(pgn));
+								CANStackLogger::warn("[ETP]: Received an abort for an session with PGN: ", pgn);
 								close_session(session);
 							}
 							else
 							{
-								CANStackLogger::CAN_stack_log("[ETP]: Received an abort with no matching session with PGN: " + isobus::to_string(pgn));
+								CANStackLogger::warn("[ETP]: Received an abort with no matching session with PGN: ", pgn);
 							}
 						}
 						break;
@@ -278,7 +311,7 @@ namespace isobus
 				}
 				else
 				{
-					CANStackLogger::CAN_stack_log("[ETP]: Received an invalid ETP CM frame");
+					CANStackLogger::warn("[ETP]: Received an invalid ETP CM frame");
 				}
 			}
 			break;
@@ -292,27 +325,32 @@ namespace isobus
 				    (StateMachineState::RxDataSession == tempSession->state) &&
 				    (message->get_data()[SEQUENCE_NUMBER_DATA_INDEX] == (tempSession->lastPacketNumber + 1)))
 				{
-					for (std::uint8_t i = SEQUENCE_NUMBER_DATA_INDEX; i < CAN_DATA_LENGTH; i++)
+					// Sequence numbers restart after each data packet offset, so the position comes from the total packet count
+					for (std::uint8_t i = 0; i < PROTOCOL_BYTES_PER_FRAME; i++)
 					{
-						std::uint32_t currentDataIndex = (CAN_DATA_LENGTH * tempSession->lastPacketNumber) + i;
-						tempSession->sessionMessage.set_data(message->get_data()[SEQUENCE_NUMBER_DATA_INDEX + i], currentDataIndex);
+						std::uint32_t currentDataIndex = (PROTOCOL_BYTES_PER_FRAME * tempSession->processedPacketsThisSession) + i;
+						tempSession->sessionMessage.set_data(message->get_data()[SEQUENCE_NUMBER_DATA_INDEX + 1 + i], currentDataIndex);
 					}
 					tempSession->lastPacketNumber++;
 					tempSession->processedPacketsThisSession++;
+					tempSession->timestamp_ms = SystemTiming::get_timestamp_ms();
 					if ((tempSession->processedPacketsThisSession * PROTOCOL_BYTES_PER_FRAME) >= tempSession->sessionMessage.get_data_length())
 					{
 						if (nullptr != tempSession->sessionMessage.get_destination_control_function())
 						{
 							send_end_of_session_acknowledgement(tempSession);
 						}
-						CANNetworkManager::CANNetwork.protocol_message_callback(&tempSession->sessionMessage);
+						record_session_completed(tempSession);
+						// Reassembly is timed from the session's first frame, and callbacks from its last
+						CANLatencyProfiler::record_message_latency(CANLatencyProfiler::Stage::Reassembly, tempSession->sessionMessage);
+						tempSession->sessionMessage.set_timestamp_us(message->get_timestamp_us());
+						networkManager.protocol_message_callback(&tempSession->sessionMessage);
 						close_session(tempSession);
 					}
-					tempSession->timestamp_ms = SystemTiming::get_timestamp_ms();
 				}
 				else
 				{
-					CANStackLogger::CAN_stack_log("[ETP]: Received an unexpected or invalid data transfer frame");
+					CANStackLogger::warn("[ETP]: Received an unexpected or invalid data transfer frame");
 				}
 			}
 			break;
@@ -336,46 +374,56 @@ namespace isobus
 	                                                                 void *parentPointer,
 	                                                                 DataChunkCallback frameChunkCallback)
 	{
-		ExtendedTransportProtocolSession *session;
 		bool retVal = false;
 
-		if ((messageLength < MAX_PROTOCOL_DATA_LENGTH) &&
-		    (messageLength > CAN_DATA_LENGTH) &&
-		    (nullptr != destination) &&
-		    ((nullptr != dataBuffer) ||
-		     (nullptr != frameChunkCallback)) &&
-		    (nullptr != source) &&
-		    (true == source->get_address_valid()) &&
-		    (destination->get_address_valid()) &&
-		    (!get_session(session, source, destination, parameterGroupNumber)))
+		if ((nullptr != dataBuffer) ||
+		    (nullptr != frameChunkCallback))
 		{
-			ExtendedTransportProtocolSession *newSession = new ExtendedTransportProtocolSession(ExtendedTransportProtocolSession::Direction::Transmit,
-			                                                                                    source->get_can_port());
-
-			newSession->sessionMessage.set_data(dataBuffer, messageLength);
-			newSession->sessionMessage.set_source_control_function(source);
-			newSession->sessionMessage.set_destination_control_function(destination);
-			newSession->packetCount = (messageLength / PROTOCOL_BYTES_PER_FRAME);
-			newSession->lastPacketNumber = 0;
-			newSession->processedPacketsThisSession = 0;
-			newSession->sessionCompleteCallback = sessionCompleteCallback;
-			newSession->frameChunkCallback = frameChunkCallback;
-			newSession->parent = parentPointer;
-			if (0 != (messageLength % PROTOCOL_BYTES_PER_FRAME))
+			ExtendedTransportProtocolSession *newSession = create_transmit_session(parameterGroupNumber,
+			                                                                       messageLength,
+			                                                                       source,
+			                                                                       destination,
+			                                                                       sessionCompleteCallback,
+			                                                                       parentPointer,
+			                                                                       frameChunkCallback);
+
+			if (nullptr != newSession)
 			{
-				newSession->packetCount++;
+				newSession->sessionMessage.set_data(dataBuffer, messageLength);
+				activeSessions.push_back(newSession);
+				CANStackLogger::debug("[ETP]: New ETP Session. Dest: ", static_cast<int>(destination->get_address()));
+				retVal = true;
 			}
-			CANIdentifier messageVirtualID(CANIdentifier::Type::Extended,
-			                               parameterGroupNumber,
-			                               CANIdentifier::CANPriority::PriorityDefault6,
-			                               destination->get_address(),
-			                               source->get_address());
+		}
+		return retVal;
+	}
 
-			newSession->sessionMessage.set_identifier(messageVirtualID);
-			set_state(newSession, StateMachineState::RequestToSend);
-			activeSessions.push_back(newSession);
-			CANStackLogger::CAN_stack_log("[ETP]: New ETP Session. Dest: " + isobus::to_string(static_cast<int>(destination->get_address())));
-			retVal = true;
+	bool ExtendedTransportProtocolManager::protocol_transmit_shared_message(std::uint32_t parameterGroupNumber,
+	                                                                        std::shared_ptr<const std::vector<std::uint8_t>> data,
+	                                                                        ControlFunction *source,
+	                                                                        ControlFunction *destination,
+	                                                                        TransmitCompleteCallback sessionCompleteCallback,
+	                                                                        void *parentPointer)
+	{
+		bool retVal = false;
+
+		if (nullptr != data)
+		{
+			ExtendedTransportProtocolSession *newSession = create_transmit_session(parameterGroupNumber,
+			                                                                       data->size(),
+			                                                                       source,
+			                                                                       destination,
+			                                                                       sessionCompleteCallback,
+			                                                                       parentPointer,
+			                                                                       nullptr);
+
+			if (nullptr != newSession)
+			{
+				newSession->sessionMessage.set_shared_data(data);
+				activeSessions.push_back(newSession);
+				CANStackLogger::debug("[ETP]: New ETP Session. Dest: ", static_cast<int>(destination->get_address()));
+				retVal = true;
+			}
 		}
 		return retVal;
 	}
@@ -401,12 +449,12 @@ namespace isobus
 
 			if (ExtendedTransportProtocolSession::Direction::Transmit == session->sessionDirection)
 			{
-				myControlFunction = CANNetworkManager::CANNetwork.get_internal_control_function(session->sessionMessage.get_source_control_function());
+				myControlFunction = networkManager.get_internal_control_function(session->sessionMessage.get_source_control_function());
 				partnerControlFunction = session->sessionMessage.get_destination_control_function();
 			}
 			else
 			{
-				myControlFunction = CANNetworkManager::CANNetwork.get_internal_control_function(session->sessionMessage.get_destination_control_function());
+				myControlFunction = networkManager.get_internal_control_function(session->sessionMessage.get_destination_control_function());
 				partnerControlFunction = session->sessionMessage.get_source_control_function();
 			}
 
@@ -418,12 +466,24 @@ namespace isobus
 			data[5] = static_cast<std::uint8_t>(pgn & 0xFF);
 			data[6] = static_cast<std::uint8_t>((pgn >> 8) & 0xFF);
 			data[7] = static_cast<std::uint8_t>((pgn >> 16) & 0xFF);
-			retVal = CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ExtendedTransportProtocolConnectionManagement),
-			                                                        data.data(),
-			                                                        CAN_DATA_LENGTH,
-			                                                        myControlFunction,
-			                                                        partnerControlFunction,
-			                                                        CANIdentifier::CANPriority::PriorityLowest7);
+			retVal = networkManager.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ExtendedTransportProtocolConnectionManagement),
+			                                         data.data(),
+			                                         CAN_DATA_LENGTH,
+			                                         myControlFunction,
+			                                         partnerControlFunction,
+			                                         CANIdentifier::CANPriority::PriorityLowest7);
+
+			if (retVal)
+			{
+				statistics.record_abort_sent(data[1]);
+			}
+			CANStackTrace::record_event(CANStackTrace::EventType::AbortSent,
+			                            CANStackTrace::Component::ExtendedTransportProtocol,
+			                            session->sessionMessage.get_can_port_index(),
+			                            pgn,
+			                            retVal ? 1 : 0,
+			                            0,
+			                            data[1]);
 		}
 		return retVal;
 	}
@@ -431,6 +491,7 @@ namespace isobus
 	bool ExtendedTransportProtocolManager::abort_session(std::uint32_t parameterGroupNumber, ConnectionAbortReason reason, InternalControlFunction *source, ControlFunction *destination)
 	{
 		std::array<std::uint8_t, CAN_DATA_LENGTH> data;
+		bool retVal;
 
 		data[0] = EXTENDED_CONNECTION_ABORT_MULTIPLEXOR;
 		data[1] = static_cast<std::uint8_t>(reason);
@@ -440,12 +501,25 @@ namespace isobus
 		data[5] = static_cast<std::uint8_t>(parameterGroupNumber & 0xFF);
 		data[6] = static_cast<std::uint8_t>((parameterGroupNumber >> 8) & 0xFF);
 		data[7] = static_cast<std::uint8_t>((parameterGroupNumber >> 16) & 0xFF);
-		return CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ExtendedTransportProtocolConnectionManagement),
-		                                                      data.data(),
-		                                                      CAN_DATA_LENGTH,
-		                                                      source,
-		                                                      destination,
-		                                                      CANIdentifier::CANPriority::PriorityLowest7);
+		retVal = networkManager.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ExtendedTransportProtocolConnectionManagement),
+		                                         data.data(),
+		                                         CAN_DATA_LENGTH,
+		                                         source,
+		                                         destination,
+		                                         CANIdentifier::CANPriority::PriorityLowest7);
+
+		if (retVal)
+		{
+			statistics.record_abort_sent(data[1]);
+		}
+		CANStackTrace::record_event(CANStackTrace::EventType::AbortSent,
+		                            CANStackTrace::Component::ExtendedTransportProtocol,
+		                            (nullptr != source) ? source->get_can_port() : 0,
+		                            parameterGroupNumber,
+		                            retVal ? 1 : 0,
+		                            0,
+		                            data[1]);
+		return retVal;
 	}
 
 	void ExtendedTransportProtocolManager::close_session(ExtendedTransportProtocolSession *session)
@@ -455,11 +529,78 @@ namespace isobus
 			auto sessionLocation = std::find(activeSessions.begin(), activeSessions.end(), session);
 			if (activeSessions.end() != sessionLocation)
 			{
+				// Let the sender know if their message is being dropped before it could be completed
+				process_session_complete_callback(session, false);
 				activeSessions.erase(sessionLocation);
+				statistics.record_session_closed(get_statistics_direction(session));
 				delete session;
-				CANStackLogger::CAN_stack_log("[ETP]: Session Closed");
+				CANStackLogger::debug("[ETP]: Session Closed");
+			}
+		}
+	}
+
+	ProtocolStatistics::Direction ExtendedTransportProtocolManager::get_statistics_direction(const ExtendedTransportProtocolSession *session)
+	{
+		ProtocolStatistics::Direction retVal = ProtocolStatistics::Direction::Receive;
+
+		if (ExtendedTransportProtocolSession::Direction::Transmit == session->sessionDirection)
+		{
+			retVal = ProtocolStatistics::Direction::Transmit;
+		}
+		return retVal;
+	}
+
+	void ExtendedTransportProtocolManager::record_session_completed(const ExtendedTransportProtocolSession *session)
+	{
+		statistics.record_session_completed(get_statistics_direction(session),
+		                                    session->sessionMessage.get_data_length(),
+		                                    SystemTiming::get_time_elapsed_ms(session->sessionStartTimestamp_ms));
+	}
+
+	ExtendedTransportProtocolManager::ExtendedTransportProtocolSession *ExtendedTransportProtocolManager::create_transmit_session(std::uint32_t parameterGroupNumber,
+	                                                                                                                             std::uint32_t messageLength,
+	                                                                                                                             ControlFunction *source,
+	                                                                                                                             ControlFunction *destination,
+	                                                                                                                             TransmitCompleteCallback sessionCompleteCallback,
+	                                                                                                                             void *parentPointer,
+	                                                                                                                             DataChunkCallback frameChunkCallback)
+	{
+		ExtendedTransportProtocolSession *session;
+		ExtendedTransportProtocolSession *retVal = nullptr;
+
+		// A message that fits in TP must not be sent with ETP, even if TP is busy with the same destination
+		if ((messageLength < MAX_PROTOCOL_DATA_LENGTH) &&
+		    (messageLength >= MIN_PROTOCOL_DATA_LENGTH) &&
+		    (nullptr != destination) &&
+		    (nullptr != source) &&
+		    (true == source->get_address_valid()) &&
+		    (destination->get_address_valid()) &&
+		    (!get_session(session, source, destination, parameterGroupNumber)))
+		{
+			retVal = new ExtendedTransportProtocolSession(ExtendedTransportProtocolSession::Direction::Transmit, source->get_can_port());
+			retVal->sessionMessage.set_source_control_function(source);
+			retVal->sessionMessage.set_destination_control_function(destination);
+			retVal->packetCount = (messageLength / PROTOCOL_BYTES_PER_FRAME);
+			retVal->lastPacketNumber = 0;
+			retVal->processedPacketsThisSession = 0;
+			retVal->sessionCompleteCallback = sessionCompleteCallback;
+			retVal->frameChunkCallback = frameChunkCallback;
+			retVal->parent = parentPointer;
+			if (0 != (messageLength % PROTOCOL_BYTES_PER_FRAME))
+			{
+				retVal->packetCount++;
 			}
+			CANIdentifier messageVirtualID(CANIdentifier::Type::Extended,
+			                               parameterGroupNumber,
+			                               CANIdentifier::CANPriority::PriorityDefault6,
+			                               destination->get_address(),
+			                               source->get_address());
+
+			retVal->sessionMessage.set_identifier(messageVirtualID);
+			set_state(retVal, StateMachineState::RequestToSend);
+			statistics.record_session_started(ProtocolStatistics::Direction::Transmit);
 		}
+		return retVal;
 	}
 
 	bool ExtendedTransportProtocolManager::get_session(ExtendedTransportProtocolSession *&session, ControlFunction *source, ControlFunction *destination)
@@ -504,6 +645,8 @@ namespace isobus
 			                                 session->sessionMessage.get_destination_control_function(),
 			                                 success,
 			                                 session->parent);
+			// Only report the result once
+			session->sessionCompleteCallback = nullptr;
 		}
 	}
 
@@ -522,12 +665,12 @@ namespace isobus
 				                                                 static_cast<std::uint8_t>(session->sessionMessage.get_identifier().get_parameter_group_number() & 0xFF),
 				                                                 static_cast<std::uint8_t>((session->sessionMessage.get_identifier().get_parameter_group_number() >> 8) & 0xFF),
 				                                                 static_cast<std::uint8_t>((session->sessionMessage.get_identifier().get_parameter_group_number() >> 16) & 0xFF) };
-			retVal = CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ExtendedTransportProtocolConnectionManagement),
-			                                                        dataBuffer,
-			                                                        CAN_DATA_LENGTH,
-			                                                        reinterpret_cast<InternalControlFunction *>(session->sessionMessage.get_destination_control_function()),
-			                                                        session->sessionMessage.get_source_control_function(),
-			                                                        CANIdentifier::CANPriority::PriorityDefault6);
+			retVal = networkManager.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ExtendedTransportProtocolConnectionManagement),
+			                                         dataBuffer,
+			                                         CAN_DATA_LENGTH,
+			                                         reinterpret_cast<InternalControlFunction *>(session->sessionMessage.get_destination_control_function()),
+			                                         session->sessionMessage.get_source_control_function(),
+			                                         CANIdentifier::CANPriority::PriorityDefault6);
 		}
 		return retVal;
 	}
@@ -553,12 +696,12 @@ namespace isobus
 				                                                 static_cast<std::uint8_t>(session->sessionMessage.get_identifier().get_parameter_group_number() & 0xFF),
 				                                                 static_cast<std::uint8_t>((session->sessionMessage.get_identifier().get_parameter_group_number() >> 8) & 0xFF),
 				                                                 static_cast<std::uint8_t>((session->sessionMessage.get_identifier().get_parameter_group_number() >> 16) & 0xFF) };
-			retVal = CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ExtendedTransportProtocolConnectionManagement),
-			                                                        dataBuffer,
-			                                                        CAN_DATA_LENGTH,
-			                                                        reinterpret_cast<InternalControlFunction *>(session->sessionMessage.get_destination_control_function()),
-			                                                        session->sessionMessage.get_source_control_function(),
-			                                                        CANIdentifier::CANPriority::PriorityDefault6);
+			retVal = networkManager.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ExtendedTransportProtocolConnectionManagement),
+			                                         dataBuffer,
+			                                         CAN_DATA_LENGTH,
+			                                         reinterpret_cast<InternalControlFunction *>(session->sessionMessage.get_destination_control_function()),
+			                                         session->sessionMessage.get_source_control_function(),
+			                                         CANIdentifier::CANPriority::PriorityDefault6);
 		}
 		return retVal;
 	}
@@ -577,12 +720,12 @@ namespace isobus
 				                                                 static_cast<std::uint8_t>(session->sessionMessage.get_identifier().get_parameter_group_number() & 0xFF),
 				                                                 static_cast<std::uint8_t>((session->sessionMessage.get_identifier().get_parameter_group_number() >> 8) & 0xFF),
 				                                                 static_cast<std::uint8_t>((session->sessionMessage.get_identifier().get_parameter_group_number() >> 16) & 0xFF) };
-			retVal = CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ExtendedTransportProtocolConnectionManagement),
-			                                                        dataBuffer,
-			                                                        CAN_DATA_LENGTH,
-			                                                        reinterpret_cast<InternalControlFunction *>(session->sessionMessage.get_source_control_function()),
-			                                                        session->sessionMessage.get_destination_control_function(),
-			                                                        CANIdentifier::CANPriority::PriorityDefault6);
+			retVal = networkManager.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ExtendedTransportProtocolConnectionManagement),
+			                                         dataBuffer,
+			                                         CAN_DATA_LENGTH,
+			                                         reinterpret_cast<InternalControlFunction *>(session->sessionMessage.get_source_control_function()),
+			                                         session->sessionMessage.get_destination_control_function(),
+			                                         CANIdentifier::CANPriority::PriorityDefault6);
 		}
 		return retVal;
 	}
@@ -601,12 +744,12 @@ namespace isobus
 				                                                 static_cast<std::uint8_t>(session->sessionMessage.get_identifier().get_parameter_group_number() & 0xFF),
 				                                                 static_cast<std::uint8_t>((session->sessionMessage.get_identifier().get_parameter_group_number() >> 8) & 0xFF),
 				                                                 static_cast<std::uint8_t>((session->sessionMessage.get_identifier().get_parameter_group_number() >> 16) & 0xFF) };
-			retVal = CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ExtendedTransportProtocolConnectionManagement),
-			                                                        dataBuffer,
-			                                                        CAN_DATA_LENGTH,
-			                                                        reinterpret_cast<InternalControlFunction *>(session->sessionMessage.get_source_control_function()),
-			                                                        session->sessionMessage.get_destination_control_function(),
-			                                                        CANIdentifier::CANPriority::PriorityDefault6);
+			retVal = networkManager.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ExtendedTransportProtocolConnectionManagement),
+			                                         dataBuffer,
+			                                         CAN_DATA_LENGTH,
+			                                         reinterpret_cast<InternalControlFunction *>(session->sessionMessage.get_source_control_function()),
+			                                         session->sessionMessage.get_destination_control_function(),
+			                                         CANIdentifier::CANPriority::PriorityDefault6);
 		}
 		return retVal;
 	}
@@ -617,6 +760,13 @@ namespace isobus
 		{
 			session->timestamp_ms = SystemTiming::get_timestamp_ms();
 			session->state = value;
+			CANStackTrace::record_event(CANStackTrace::EventType::SessionStateChanged,
+			                            CANStackTrace::Component::ExtendedTransportProtocol,
+			                            session->sessionMessage.get_can_port_index(),
+			                            session->sessionMessage.get_identifier().get_parameter_group_number(),
+			                            session->sessionMessage.get_data_length(),
+			                            session->processedPacketsThisSession,
+			                            static_cast<std::uint8_t>(value));
 		}
 	}
 
@@ -636,7 +786,7 @@ namespace isobus
 					{
 						if (SystemTiming::time_expired_ms(session->timestamp_ms, T2_3_TIMEOUT_MS))
 						{
-							CANStackLogger::CAN_stack_log("[ETP]: Aborting session, T2-3 timeout reached while in RTS state");
+							CANStackLogger::warn("[ETP]: Aborting session, T2-3 timeout reached while in RTS state");
 							abort_session(session, ConnectionAbortReason::Timeout);
 							close_session(session);
 						}
@@ -650,7 +800,7 @@ namespace isobus
 				{
 					if (SystemTiming::time_expired_ms(session->timestamp_ms, T2_3_TIMEOUT_MS))
 					{
-						CANStackLogger::CAN_stack_log("[ETP]: Aborting session, T2-3 timeout reached while waiting for CTS");
+						CANStackLogger::warn("[ETP]: Aborting session, T2-3 timeout reached while waiting for CTS");
 						abort_session(session, ConnectionAbortReason::Timeout);
 						close_session(session);
 					}
@@ -688,7 +838,7 @@ namespace isobus
 										0xFF,
 										0xFF
 									};
-									std::uint16_t numberBytesLeft = (session->sessionMessage.get_data_length() - (PROTOCOL_BYTES_PER_FRAME * session->processedPacketsThisSession));
+									std::uint32_t numberBytesLeft = (session->sessionMessage.get_data_length() - (PROTOCOL_BYTES_PER_FRAME * session->processedPacketsThisSession));
 
 									if (numberBytesLeft > PROTOCOL_BYTES_PER_FRAME)
 									{
@@ -706,7 +856,7 @@ namespace isobus
 									}
 									else
 									{
-										CANStackLogger::CAN_stack_log("[ETP]: Aborting session, unable to transfer chunk of data (numberBytesLeft=" + to_string(numberBytesLeft) + ")");
+										CANStackLogger::error("[ETP]: Aborting session, unable to transfer chunk of data (numberBytesLeft=", numberBytesLeft, ")");
 										abort_session(session, ConnectionAbortReason::AnyOtherReason);
 										close_session(session);
 										break;
@@ -720,7 +870,7 @@ namespace isobus
 										std::uint32_t index = (j + (PROTOCOL_BYTES_PER_FRAME * session->processedPacketsThisSession));
 										if (index < session->sessionMessage.get_data_length())
 										{
-											dataBuffer[1 + j] = session->sessionMessage.get_data()[j + (PROTOCOL_BYTES_PER_FRAME * session->processedPacketsThisSession)];
+											dataBuffer[1 + j] = session->sessionMessage.get_data_byte(index);
 										}
 										else
 										{
@@ -729,12 +879,12 @@ namespace isobus
 									}
 								}
 
-								if (CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ExtendedTransportProtocolDataTransfer),
-								                                                   dataBuffer,
-								                                                   CAN_DATA_LENGTH,
-								                                                   reinterpret_cast<InternalControlFunction *>(session->sessionMessage.get_source_control_function()),
-								                                                   session->sessionMessage.get_destination_control_function(),
-								                                                   CANIdentifier::CANPriority::PriorityLowest7))
+								if (networkManager.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ExtendedTransportProtocolDataTransfer),
+								                                    dataBuffer,
+								                                    CAN_DATA_LENGTH,
+								                                    reinterpret_cast<InternalControlFunction *>(session->sessionMessage.get_source_control_function()),
+								                                    session->sessionMessage.get_destination_control_function(),
+								                                    CANIdentifier::CANPriority::PriorityLowest7))
 								{
 									session->lastPacketNumber++;
 									session->processedPacketsThisSession++;
@@ -771,7 +921,7 @@ namespace isobus
 					}
 					else if (SystemTiming::time_expired_ms(session->timestamp_ms, T1_TIMEOUT_MS))
 					{
-						CANStackLogger::CAN_stack_log("[ETP]: Aborting session, RX T1 timeout reached");
+						CANStackLogger::warn("[ETP]: Aborting session, RX T1 timeout reached");
 						abort_session(session, ConnectionAbortReason::Timeout);
 						close_session(session);
 					}
@@ -786,7 +936,7 @@ namespace isobus
 					}
 					else if (SystemTiming::time_expired_ms(session->timestamp_ms, T2_3_TIMEOUT_MS))
 					{
-						CANStackLogger::CAN_stack_log("[ETP]: Aborting session, T2-3 timeout reached while in CTS state");
+						CANStackLogger::warn("[ETP]: Aborting session, T2-3 timeout reached while in CTS state");
 						abort_session(session, ConnectionAbortReason::Timeout);
 						close_session(session);
 					}
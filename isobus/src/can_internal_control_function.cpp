@@ -10,18 +10,22 @@
 #include "isobus/isobus/can_internal_control_function.hpp"
 
 #include "isobus/isobus/can_constants.hpp"
+#include "isobus/isobus/can_network_manager.hpp"
 
 #include <algorithm>
 
 namespace isobus
 {
 	std::list<InternalControlFunction *> InternalControlFunction::internalControlFunctionList;
-	bool InternalControlFunction::anyChangedAddress = false;
 
 	InternalControlFunction::InternalControlFunction(NAME desiredName, std::uint8_t preferredAddress, std::uint8_t CANPort) :
-	  ControlFunction(desiredName, NULL_CAN_ADDRESS, CANPort),
-	  stateMachine(preferredAddress, desiredName, CANPort),
-	  objectChangedAddressSinceLastUpdate(false)
+	  InternalControlFunction(desiredName, preferredAddress, CANPort, CANNetworkManager::CANNetwork)
+	{
+	}
+
+	InternalControlFunction::InternalControlFunction(NAME desiredName, std::uint8_t preferredAddress, std::uint8_t CANPort, CANNetworkManager &parentNetworkManager) :
+	  ControlFunction(desiredName, NULL_CAN_ADDRESS, CANPort, parentNetworkManager),
+	  stateMachine(preferredAddress, desiredName, CANPort, parentNetworkManager)
 	{
 		controlFunctionType = Type::Internal;
 		internalControlFunctionList.push_back(this);
@@ -52,41 +56,13 @@ namespace isobus
 		return internalControlFunctionList.size();
 	}
 
-	bool InternalControlFunction::get_any_internal_control_function_changed_address(CANLibBadge<CANNetworkManager>)
-	{
-		return anyChangedAddress;
-	}
-
-	bool InternalControlFunction::get_changed_address_since_last_update(CANLibBadge<CANNetworkManager>) const
-	{
-		return objectChangedAddressSinceLastUpdate;
-	}
-
-	void InternalControlFunction::update_address_claiming(CANLibBadge<CANNetworkManager>)
-	{
-		anyChangedAddress = false;
-
-		for (auto currentControlFunction : internalControlFunctionList)
-		{
-			if (nullptr != currentControlFunction)
-			{
-				currentControlFunction->update();
-			}
-		}
-	}
-
-	void InternalControlFunction::update()
+	bool InternalControlFunction::update_address_claiming(CANLibBadge<CANNetworkManager>)
 	{
 		std::uint8_t previousAddress = address;
-		objectChangedAddressSinceLastUpdate = false;
 		stateMachine.update();
 		address = stateMachine.get_claimed_address();
 
-		if (previousAddress != address)
-		{
-			anyChangedAddress = true;
-			objectChangedAddressSinceLastUpdate = true;
-		}
+		return (previousAddress != address);
 	}
 
 } // namespace isobus
@@ -0,0 +1,246 @@
+//================================================================================================
+/// @file can_latency_profiler.cpp
+///
+/// @brief Measures how long frames and messages spend in each stage between the driver and the
+/// application's callbacks, and between sending and the driver, with a histogram per PGN.
+/// Useful for showing that safety relevant messages meet their latency budgets.
+/// @author Adrian Del Grosso
+///
+/// @copyright 2022 Adrian Del Grosso
+//================================================================================================
+#include "isobus/isobus/can_latency_profiler.hpp"
+
+#include "isobus/isobus/can_identifier.hpp"
+#include "isobus/isobus/can_message.hpp"
+#include "isobus/utility/system_timing.hpp"
+
+#include <array>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <mutex>
+
+namespace isobus
+{
+	namespace
+	{
+		/// @brief The histograms of every stage for one PGN
+		using StageHistograms = std::array<LatencyHistogram, CANLatencyProfiler::NUMBER_OF_STAGES>;
+
+		//================================================================================================
+		/// @class ProfileTable
+		///
+		/// @brief Owns the histograms of every PGN that's been profiled
+		//================================================================================================
+		class ProfileTable
+		{
+		public:
+			/// @brief Returns the one table, which is created the first time it's used
+			/// @returns The table
+			static ProfileTable &get_instance()
+			{
+				static ProfileTable instance;
+				return instance;
+			}
+
+			/// @brief Finds the histograms of a PGN
+			/// @param[in] parameterGroupNumber The PGN
+			/// @param[in] create `true` to add histograms for the PGN if it doesn't have any yet
+			/// @returns The histograms, or `nullptr` if the PGN has none and `create` is `false`
+			StageHistograms *get_histograms(std::uint32_t parameterGroupNumber, bool create)
+			{
+				const std::lock_guard<std::mutex> lock(tableMutex);
+				StageHistograms *retVal = nullptr;
+				auto location = histograms.find(parameterGroupNumber);
+
+				if (histograms.end() != location)
+				{
+					retVal = location->second.get();
+				}
+				else if (create)
+				{
+					retVal = new StageHistograms();
+					histograms[parameterGroupNumber].reset(retVal);
+				}
+				return retVal;
+			}
+
+			/// @brief Returns the PGNs that have histograms
+			/// @returns The PGNs in ascending order
+			std::vector<std::uint32_t> get_parameter_group_numbers()
+			{
+				const std::lock_guard<std::mutex> lock(tableMutex);
+				std::vector<std::uint32_t> retVal;
+
+				for (auto &entry : histograms)
+				{
+					retVal.push_back(entry.first);
+				}
+				return retVal;
+			}
+
+			/// @brief Removes the samples from every histogram, but keeps the histograms
+			void reset()
+			{
+				const std::lock_guard<std::mutex> lock(tableMutex);
+
+				for (auto &entry : histograms)
+				{
+					for (auto &histogram : *entry.second)
+					{
+						histogram.reset();
+					}
+				}
+			}
+
+		private:
+			std::mutex tableMutex; ///< Protects `histograms`
+			std::map<std::uint32_t, std::unique_ptr<StageHistograms>> histograms; ///< The histograms of each PGN
+		};
+	} // namespace
+
+	constexpr std::uint8_t CANLatencyProfiler::NUMBER_OF_STAGES;
+	constexpr std::uint64_t CANLatencyProfiler::NO_TIMESTAMP;
+	std::atomic<bool> CANLatencyProfiler::enabled(false);
+
+	void CANLatencyProfiler::set_enabled(bool enable)
+	{
+		// Make sure the table exists before the first sample can be added from another thread
+		ProfileTable::get_instance();
+		enabled.store(enable, std::memory_order_relaxed);
+	}
+
+	std::uint64_t CANLatencyProfiler::get_timestamp_us()
+	{
+		std::uint64_t retVal = NO_TIMESTAMP;
+
+		if (get_enabled())
+		{
+			retVal = SystemTiming::get_timestamp_us();
+		}
+		return retVal;
+	}
+
+	void CANLatencyProfiler::record_frame_latency(Stage stage, std::uint32_t identifier, bool isExtendedFrame, std::uint64_t startTimestamp_us)
+	{
+		if ((isExtendedFrame) &&
+		    (get_enabled()) &&
+		    (NO_TIMESTAMP != startTimestamp_us))
+		{
+			add_sample(stage, CANIdentifier(identifier).get_parameter_group_number(), startTimestamp_us);
+		}
+	}
+
+	void CANLatencyProfiler::record_message_latency(Stage stage, const CANMessage &message)
+	{
+		if ((get_enabled()) &&
+		    (0 != message.get_timestamp_us()))
+		{
+			add_sample(stage, message.get_identifier().get_parameter_group_number(), message.get_timestamp_us());
+		}
+	}
+
+	std::vector<std::uint32_t> CANLatencyProfiler::get_parameter_group_numbers()
+	{
+		return ProfileTable::get_instance().get_parameter_group_numbers();
+	}
+
+	const LatencyHistogram *CANLatencyProfiler::get_histogram(std::uint32_t parameterGroupNumber, Stage stage)
+	{
+		const StageHistograms *histograms = ProfileTable::get_instance().get_histograms(parameterGroupNumber, false);
+		const LatencyHistogram *retVal = nullptr;
+
+		if ((nullptr != histograms) &&
+		    (stage < Stage::NumberOfStages))
+		{
+			retVal = &(*histograms)[static_cast<std::uint8_t>(stage)];
+		}
+		return retVal;
+	}
+
+	void CANLatencyProfiler::write_report(std::ostream &output)
+	{
+		output << std::setw(8) << "PGN" << std::setw(16) << "Stage" << std::setw(12) << "Samples"
+		       << std::setw(12) << "p50 (us)" << std::setw(12) << "p99 (us)" << std::setw(12) << "p99.9 (us)" << std::setw(12) << "Max (us)" << '\n';
+
+		for (std::uint32_t parameterGroupNumber : get_parameter_group_numbers())
+		{
+			for (std::uint8_t i = 0; i < NUMBER_OF_STAGES; i++)
+			{
+				const Stage stage = static_cast<Stage>(i);
+				const LatencyHistogram *histogram = get_histogram(parameterGroupNumber, stage);
+
+				if ((nullptr != histogram) &&
+				    (0 != histogram->get_total_number_samples()))
+				{
+					output << std::setw(8) << std::hex << std::uppercase << parameterGroupNumber << std::dec
+					       << std::setw(16) << get_stage_name(stage)
+					       << std::setw(12) << histogram->get_total_number_samples()
+					       << std::setw(12) << histogram->get_percentile_upper_limit(50.0f)
+					       << std::setw(12) << histogram->get_percentile_upper_limit(99.0f)
+					       << std::setw(12) << histogram->get_percentile_upper_limit(99.9f)
+					       << std::setw(12) << histogram->get_maximum() << '\n';
+				}
+			}
+		}
+	}
+
+	const char *CANLatencyProfiler::get_stage_name(Stage stage)
+	{
+		const char *retVal = "Unknown";
+
+		switch (stage)
+		{
+			case Stage::ChannelQueue:
+			{
+				retVal = "ChannelQueue";
+			}
+			break;
+
+			case Stage::StackQueue:
+			{
+				retVal = "StackQueue";
+			}
+			break;
+
+			case Stage::Reassembly:
+			{
+				retVal = "Reassembly";
+			}
+			break;
+
+			case Stage::Callback:
+			{
+				retVal = "Callback";
+			}
+			break;
+
+			case Stage::TransmitQueue:
+			{
+				retVal = "TransmitQueue";
+			}
+			break;
+
+			default:
+				break;
+		}
+		return retVal;
+	}
+
+	void CANLatencyProfiler::reset()
+	{
+		ProfileTable::get_instance().reset();
+	}
+
+	void CANLatencyProfiler::add_sample(Stage stage, std::uint32_t parameterGroupNumber, std::uint64_t startTimestamp_us)
+	{
+		if (stage < Stage::NumberOfStages)
+		{
+			// Measured before finding the histogram, so waiting for the table's lock isn't counted
+			const std::uint64_t latency_us = SystemTiming::get_time_elapsed_us(startTimestamp_us);
+			StageHistograms *histograms = ProfileTable::get_instance().get_histograms(parameterGroupNumber, true);
+
+			(*histograms)[static_cast<std::uint8_t>(stage)].add_sample((latency_us > std::numeric_limits<std::uint32_t>::max()) ? std::numeric_limits<std::uint32_t>::max() : static_cast<std::uint32_t>(latency_us));
+		}
+	}
+} // namespace isobus
@@ -30,6 +30,29 @@ namespace isobus
 		}
 	}
 
+	void CANLibManagedMessage::set_shared_data(std::shared_ptr<const std::vector<std::uint8_t>> sharedDataBuffer)
+	{
+		sharedData = sharedDataBuffer;
+	}
+
+	std::uint8_t CANLibManagedMessage::get_data_byte(std::uint32_t index) const
+	{
+		std::uint8_t retVal = 0xFF;
+
+		if (nullptr != sharedData)
+		{
+			if (index < sharedData->size())
+			{
+				retVal = (*sharedData)[index];
+			}
+		}
+		else if (index < data.size())
+		{
+			retVal = data[index];
+		}
+		return retVal;
+	}
+
 	void CANLibManagedMessage::set_data(std::uint8_t dataByte, const std::uint32_t insertPosition)
 	{
 		if (insertPosition < data.size())
@@ -47,7 +70,11 @@ namespace isobus
 	{
 		std::uint32_t retVal;
 
-		if (0 != callbackMessageSize)
+		if (nullptr != sharedData)
+		{
+			retVal = sharedData->size();
+		}
+		else if (0 != callbackMessageSize)
 		{
 			retVal = callbackMessageSize;
 		}
@@ -73,6 +100,11 @@ namespace isobus
 		identifier = value;
 	}
 
+	void CANLibManagedMessage::set_timestamp_us(std::uint64_t value)
+	{
+		timestamp_us = value;
+	}
+
 	std::uint32_t CANLibManagedMessage::get_callback_message_size() const
 	{
 		return callbackMessageSize;
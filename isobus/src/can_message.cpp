@@ -18,7 +18,8 @@ namespace isobus
 	  identifier(0),
 	  messageType(Type::Receive),
 	  messageUniqueID(lastGeneratedUniqueID++),
-	  CANPortIndex(CANPort)
+	  CANPortIndex(CANPort),
+	  timestamp_us(0)
 	{
 	}
 
@@ -62,4 +63,9 @@ namespace isobus
 		return CANPortIndex;
 	}
 
+	std::uint64_t CANMessage::get_timestamp_us() const
+	{
+		return timestamp_us;
+	}
+
 } // namespace isobus
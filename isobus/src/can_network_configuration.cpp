@@ -13,6 +13,7 @@ namespace isobus
 {
 	std::uint32_t CANNetworkConfiguration::maxNumberTransportProtocolSessions = 4;
 	std::uint32_t CANNetworkConfiguration::minimumTimeBetweenTransportProtocolBAMFrames = DEFAULT_BAM_PACKET_DELAY_TIME_MS;
+	std::uint32_t CANNetworkConfiguration::requestCoalescingWindow = 0;
 
 	CANNetworkConfiguration::CANNetworkConfiguration()
 	{
@@ -48,4 +49,19 @@ namespace isobus
 	{
 		return minimumTimeBetweenTransportProtocolBAMFrames;
 	}
+
+	void CANNetworkConfiguration::set_request_coalescing_window(std::uint32_t value)
+	{
+		constexpr std::uint32_t MAX_COALESCING_WINDOW_MS = 150;
+
+		if (value <= MAX_COALESCING_WINDOW_MS)
+		{
+			requestCoalescingWindow = value;
+		}
+	}
+
+	std::uint32_t CANNetworkConfiguration::get_request_coalescing_window()
+	{
+		return requestCoalescingWindow;
+	}
 }
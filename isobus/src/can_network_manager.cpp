@@ -10,21 +10,73 @@
 
 #include "isobus/isobus/can_network_manager.hpp"
 #include "isobus/isobus/can_constants.hpp"
+#include "isobus/isobus/can_extended_transport_protocol.hpp"
 #include "isobus/isobus/can_general_parameter_group_numbers.hpp"
 #include "isobus/isobus/can_hardware_abstraction.hpp"
+#include "isobus/isobus/can_latency_profiler.hpp"
 #include "isobus/isobus/can_managed_message.hpp"
 #include "isobus/isobus/can_message.hpp"
 #include "isobus/isobus/can_partnered_control_function.hpp"
 #include "isobus/isobus/can_protocol.hpp"
+#include "isobus/isobus/can_stack_trace.hpp"
+#include "isobus/isobus/can_transport_protocol.hpp"
 #include "isobus/isobus/can_warning_logger.hpp"
+#include "isobus/isobus/nmea2000_fast_packet_protocol.hpp"
 #include "isobus/utility/system_timing.hpp"
-#include "isobus/utility/to_string.hpp"
 
 #include <algorithm>
 #include <cstring>
 namespace isobus
 {
-	CANNetworkManager CANNetworkManager::CANNetwork;
+	constexpr std::uint8_t CANNetworkManager::NO_HARDWARE_CHANNEL;
+
+	CANNetworkManager CANNetworkManager::CANNetwork(true);
+
+	// These have to be defined in the same file as the default network manager, so they're bound after it's constructed
+	TransportProtocolManager &TransportProtocolManager::Protocol = *CANNetworkManager::CANNetwork.transportProtocol;
+	ExtendedTransportProtocolManager &ExtendedTransportProtocolManager::Protocol = *CANNetworkManager::CANNetwork.extendedTransportProtocol;
+	FastPacketProtocol &FastPacketProtocol::Protocol = *CANNetworkManager::CANNetwork.fastPacketProtocol;
+
+	CANNetworkManager::CANNetworkManager() :
+	  CANNetworkManager(false)
+	{
+	}
+
+	CANNetworkManager::CANNetworkManager(bool bindPortsToHardwareChannels) :
+	  busLoadEnabled(false),
+	  updateTimestamp_ms(0),
+	  initialized(false)
+	{
+		for (std::uint8_t i = 0; i < CAN_PORT_MAXIMUM; i++)
+		{
+			controlFunctionTable[i].fill(nullptr);
+			hardwareChannels[i] = bindPortsToHardwareChannels ? i : NO_HARDWARE_CHANNEL;
+		}
+
+		// Each stack gets its own protocols, in the order they're offered messages to send
+		transportProtocol.reset(new TransportProtocolManager(*this));
+		extendedTransportProtocol.reset(new ExtendedTransportProtocolManager(*this));
+		fastPacketProtocol.reset(new FastPacketProtocol(*this));
+	}
+
+	CANNetworkManager::~CANNetworkManager()
+	{
+		// Internal and partnered control functions belong to the application, but the others were found on the bus
+		for (auto currentControlFunction : activeControlFunctions)
+		{
+			if (ControlFunction::Type::External == currentControlFunction->get_type())
+			{
+				delete currentControlFunction;
+			}
+		}
+		for (auto currentControlFunction : inactiveControlFunctions)
+		{
+			if (ControlFunction::Type::External == currentControlFunction->get_type())
+			{
+				delete currentControlFunction;
+			}
+		}
+	}
 
 	void CANNetworkManager::initialize()
 	{
@@ -45,6 +97,17 @@ namespace isobus
 		}
 	}
 
+	void CANNetworkManager::remove_control_function(ControlFunction *controlFunction, CANLibBadge<ControlFunction>)
+	{
+		activeControlFunctions.erase(std::remove(activeControlFunctions.begin(), activeControlFunctions.end(), controlFunction), activeControlFunctions.end());
+		inactiveControlFunctions.erase(std::remove(inactiveControlFunctions.begin(), inactiveControlFunctions.end(), controlFunction), inactiveControlFunctions.end());
+
+		for (std::uint8_t i = 0; i < CAN_PORT_MAXIMUM; i++)
+		{
+			std::replace(controlFunctionTable[i].begin(), controlFunctionTable[i].end(), controlFunction, static_cast<ControlFunction *>(nullptr));
+		}
+	}
+
 	void CANNetworkManager::add_global_parameter_group_number_callback(std::uint32_t parameterGroupNumber, CANLibCallback callback, void *parent)
 	{
 		globalParameterGroupNumberCallbacks.push_back(ParameterGroupNumberCallbackData(parameterGroupNumber, callback, parent));
@@ -97,26 +160,21 @@ namespace isobus
 		    ((parameterGroupNumber == static_cast<std::uint32_t>(CANLibParameterGroupNumber::AddressClaim)) ||
 		     (sourceControlFunction->get_address_valid())))
 		{
-			CANLibProtocol *currentProtocol;
-
 			// See if any transport layer protocol can handle this message
-			for (std::uint32_t i = 0; i < CANLibProtocol::get_number_protocols(); i++)
+			for (auto currentProtocol : protocols)
 			{
-				if (CANLibProtocol::get_protocol(i, currentProtocol))
+				retVal = currentProtocol->protocol_transmit_message(parameterGroupNumber,
+				                                                    dataBuffer,
+				                                                    dataLength,
+				                                                    sourceControlFunction,
+				                                                    destinationControlFunction,
+				                                                    transmitCompleteCallback,
+				                                                    parentPointer,
+				                                                    frameChunkCallback);
+
+				if (retVal)
 				{
-					retVal = currentProtocol->protocol_transmit_message(parameterGroupNumber,
-					                                                    dataBuffer,
-					                                                    dataLength,
-					                                                    sourceControlFunction,
-					                                                    destinationControlFunction,
-					                                                    transmitCompleteCallback,
-					                                                    parentPointer,
-					                                                    frameChunkCallback);
-
-					if (retVal)
-					{
-						break;
-					}
+					break;
 				}
 			}
 
@@ -145,6 +203,51 @@ namespace isobus
 		return retVal;
 	}
 
+	bool CANNetworkManager::send_can_message(std::uint32_t parameterGroupNumber,
+	                                         std::shared_ptr<const std::vector<std::uint8_t>> data,
+	                                         InternalControlFunction *sourceControlFunction,
+	                                         ControlFunction *destinationControlFunction,
+	                                         TransmitCompleteCallback transmitCompleteCallback,
+	                                         void *parentPointer)
+	{
+		bool retVal = false;
+
+		if ((nullptr != data) &&
+		    (!data->empty()) &&
+		    (data->size() > CAN_DATA_LENGTH) &&
+		    (data->size() <= CANMessage::ABSOLUTE_MAX_MESSAGE_LENGTH) &&
+		    (nullptr != sourceControlFunction) &&
+		    (sourceControlFunction->get_address_valid()))
+		{
+			for (auto currentProtocol : protocols)
+			{
+				if (currentProtocol->protocol_transmit_shared_message(parameterGroupNumber,
+				                                                      data,
+				                                                      sourceControlFunction,
+				                                                      destinationControlFunction,
+				                                                      transmitCompleteCallback,
+				                                                      parentPointer))
+				{
+					retVal = true;
+					break;
+				}
+			}
+		}
+		else if (nullptr != data)
+		{
+			// Short messages go out as a single frame, which copies them anyways
+			retVal = send_can_message(parameterGroupNumber,
+			                          data->data(),
+			                          data->size(),
+			                          sourceControlFunction,
+			                          destinationControlFunction,
+			                          CANIdentifier::CANPriority::PriorityDefault6,
+			                          transmitCompleteCallback,
+			                          parentPointer);
+		}
+		return retVal;
+	}
+
 	void CANNetworkManager::receive_can_message(CANMessage message)
 	{
 		if (initialized)
@@ -166,40 +269,127 @@ namespace isobus
 
 		process_rx_messages();
 
-		InternalControlFunction::update_address_claiming({});
-
-		if (InternalControlFunction::get_any_internal_control_function_changed_address({}))
+		for (std::uint32_t i = 0; i < InternalControlFunction::get_number_internal_control_functions(); i++)
 		{
-			for (std::uint32_t i = 0; i < InternalControlFunction::get_number_internal_control_functions(); i++)
-			{
-				InternalControlFunction *currentInternalControlFunction = InternalControlFunction::get_internal_control_function(i);
+			InternalControlFunction *currentInternalControlFunction = InternalControlFunction::get_internal_control_function(i);
 
+			// Only this manager's control functions claim on its ports, the others belong to other stacks
+			if ((nullptr != currentInternalControlFunction) &&
+			    (this == &currentInternalControlFunction->get_network_manager()) &&
+			    (currentInternalControlFunction->update_address_claiming({})))
+			{
 				if (activeControlFunctions.end() == std::find(activeControlFunctions.begin(), activeControlFunctions.end(), currentInternalControlFunction))
 				{
 					activeControlFunctions.push_back(currentInternalControlFunction);
 				}
-				if ((nullptr != currentInternalControlFunction) &&
-				    (currentInternalControlFunction->get_changed_address_since_last_update({})))
-				{
-					update_address_table(currentInternalControlFunction->get_can_port(), currentInternalControlFunction->get_address());
-				}
+				update_address_table(currentInternalControlFunction->get_can_port(), currentInternalControlFunction->get_address());
 			}
 		}
 
-		for (uint32_t i = 0; i < CANLibProtocol::get_number_protocols(); i++)
+		for (auto currentProtocol : protocols)
+		{
+			if (!currentProtocol->get_is_initialized())
+			{
+				currentProtocol->initialize({});
+			}
+			currentProtocol->update({});
+		}
+		updateTimestamp_ms = SystemTiming::get_timestamp_ms();
+	}
+
+	CANBusLoad *CANNetworkManager::get_bus_load(std::uint8_t CANPort)
+	{
+		CANBusLoad *retVal = nullptr;
+
+		if (CANPort < CAN_PORT_MAXIMUM)
+		{
+			retVal = &busLoads[CANPort];
+		}
+		return retVal;
+	}
+
+	void CANNetworkManager::set_bus_load_enabled(bool enabled)
+	{
+		busLoadEnabled.store(enabled, std::memory_order_relaxed);
+	}
+
+	bool CANNetworkManager::get_bus_load_enabled() const
+	{
+		return busLoadEnabled.load(std::memory_order_relaxed);
+	}
+
+	bool CANNetworkManager::set_hardware_channel(std::uint8_t CANPort, std::uint8_t hardwareChannel)
+	{
+		bool retVal = false;
+
+		if (CANPort < CAN_PORT_MAXIMUM)
 		{
-			CANLibProtocol *currentProtocol = nullptr;
+			retVal = true;
 
-			if (CANLibProtocol::get_protocol(i, currentProtocol))
+			for (std::uint8_t i = 0; i < CAN_PORT_MAXIMUM; i++)
 			{
-				if (!currentProtocol->get_is_initialized())
+				if ((i != CANPort) &&
+				    (NO_HARDWARE_CHANNEL != hardwareChannel) &&
+				    (hardwareChannel == hardwareChannels[i]))
 				{
-					currentProtocol->initialize({});
+					retVal = false;
+					break;
 				}
-				currentProtocol->update({});
+			}
+
+			if (retVal)
+			{
+				hardwareChannels[CANPort] = hardwareChannel;
 			}
 		}
-		updateTimestamp_ms = SystemTiming::get_timestamp_ms();
+		return retVal;
+	}
+
+	std::uint8_t CANNetworkManager::get_hardware_channel(std::uint8_t CANPort) const
+	{
+		std::uint8_t retVal = NO_HARDWARE_CHANNEL;
+
+		if (CANPort < CAN_PORT_MAXIMUM)
+		{
+			retVal = hardwareChannels[CANPort];
+		}
+		return retVal;
+	}
+
+	FastPacketProtocol &CANNetworkManager::get_fast_packet_protocol()
+	{
+		return *fastPacketProtocol;
+	}
+
+	std::uint32_t CANNetworkManager::get_number_protocols() const
+	{
+		return protocols.size();
+	}
+
+	bool CANNetworkManager::get_protocol(std::uint32_t index, CANLibProtocol *&returnedProtocol) const
+	{
+		returnedProtocol = nullptr;
+
+		if (index < protocols.size())
+		{
+			returnedProtocol = protocols[index];
+		}
+		return (nullptr != returnedProtocol);
+	}
+
+	void CANNetworkManager::add_protocol(CANLibProtocol *protocol, CANLibBadge<CANLibProtocol>)
+	{
+		protocols.push_back(protocol);
+	}
+
+	void CANNetworkManager::remove_protocol(CANLibProtocol *protocol, CANLibBadge<CANLibProtocol>)
+	{
+		auto protocolLocation = std::find(protocols.begin(), protocols.end(), protocol);
+
+		if (protocols.end() != protocolLocation)
+		{
+			protocols.erase(protocolLocation);
+		}
 	}
 
 	bool CANNetworkManager::send_can_message_raw(std::uint32_t portIndex,
@@ -225,39 +415,72 @@ namespace isobus
 		return retVal;
 	}
 
-	void CANNetworkManager::can_lib_process_rx_message(HardwareInterfaceCANFrame &rxFrame, void *)
+	void CANNetworkManager::can_lib_process_rx_message(HardwareInterfaceCANFrame &rxFrame, void *parentClass)
 	{
-		CANLibManagedMessage tempCANMessage(rxFrame.channel);
+		CANNetworkManager *networkManager = &CANNetwork;
 
-		CANNetworkManager::CANNetwork.update_control_functions(rxFrame);
+		if (nullptr != parentClass)
+		{
+			networkManager = static_cast<CANNetworkManager *>(parentClass);
+		}
+		networkManager->process_rx_frame(rxFrame);
+	}
 
-		tempCANMessage.set_identifier(CANIdentifier(rxFrame.identifier));
+	void CANNetworkManager::process_rx_frame(const HardwareInterfaceCANFrame &hardwareFrame)
+	{
+		std::uint8_t CANPort = 0;
 
-		// Note, if this is an address claim message, the address to CF table might be stale.
-		// We don't want to update that here though, as we're maybe in some other thread in this callback.
-		// So for now, manually search all of them to line up the appropriate CF. A bit unfortunate in that we may have a lot of CFs, but saves pain later so we don't have to
-		// do some gross cast to CANLibManagedMessage to edit the CFs.
-		// At least address claiming should be infrequent, so this should not happen a ton.
-		if (static_cast<std::uint32_t>(CANLibParameterGroupNumber::AddressClaim) == tempCANMessage.get_identifier().get_parameter_group_number())
+		while ((CANPort < CAN_PORT_MAXIMUM) &&
+		       (hardwareFrame.channel != hardwareChannels[CANPort]))
 		{
-			for (std::uint32_t i = 0; i < CANNetworkManager::CANNetwork.activeControlFunctions.size(); i++)
+			CANPort++;
+		}
+
+		// Frames from channels that aren't bound to this network manager belong to other stacks
+		if (CANPort < CAN_PORT_MAXIMUM)
+		{
+			// The rest of the stack only knows about this network manager's ports
+			HardwareInterfaceCANFrame rxFrame = hardwareFrame;
+			rxFrame.channel = CANPort;
+
+			CANLibManagedMessage tempCANMessage(rxFrame.channel);
+
+			CANStackTrace::record_frame(CANStackTrace::EventType::FrameReceived, hardwareFrame);
+			if (busLoadEnabled.load(std::memory_order_relaxed))
 			{
-				if ((CANNetworkManager::CANNetwork.activeControlFunctions[i]->get_can_port() == tempCANMessage.get_can_port_index()) &&
-				    (CANNetworkManager::CANNetwork.activeControlFunctions[i]->get_address() == tempCANMessage.get_identifier().get_source_address()))
+				busLoads[rxFrame.channel].add_frame(rxFrame);
+			}
+			update_control_functions(rxFrame);
+
+			tempCANMessage.set_identifier(CANIdentifier(rxFrame.identifier));
+
+			// Note, if this is an address claim message, the address to CF table might be stale.
+			// We don't want to update that here though, as we're maybe in some other thread in this callback.
+			// So for now, manually search all of them to line up the appropriate CF. A bit unfortunate in that we may have a lot of CFs, but saves pain later so we don't have to
+			// do some gross cast to CANLibManagedMessage to edit the CFs.
+			// At least address claiming should be infrequent, so this should not happen a ton.
+			if (static_cast<std::uint32_t>(CANLibParameterGroupNumber::AddressClaim) == tempCANMessage.get_identifier().get_parameter_group_number())
+			{
+				for (std::uint32_t i = 0; i < activeControlFunctions.size(); i++)
 				{
-					tempCANMessage.set_source_control_function(CANNetworkManager::CANNetwork.activeControlFunctions[i]);
-					break;
+					if ((activeControlFunctions[i]->get_can_port() == tempCANMessage.get_can_port_index()) &&
+					    (activeControlFunctions[i]->get_address() == tempCANMessage.get_identifier().get_source_address()))
+					{
+						tempCANMessage.set_source_control_function(activeControlFunctions[i]);
+						break;
+					}
 				}
 			}
-		}
-		else
-		{
-			tempCANMessage.set_source_control_function(CANNetworkManager::CANNetwork.get_control_function(rxFrame.channel, tempCANMessage.get_identifier().get_source_address()));
-			tempCANMessage.set_destination_control_function(CANNetworkManager::CANNetwork.get_control_function(rxFrame.channel, tempCANMessage.get_identifier().get_destination_address()));
-		}
-		tempCANMessage.set_data(rxFrame.data, rxFrame.dataLength);
+			else
+			{
+				tempCANMessage.set_source_control_function(get_control_function(rxFrame.channel, tempCANMessage.get_identifier().get_source_address()));
+				tempCANMessage.set_destination_control_function(get_control_function(rxFrame.channel, tempCANMessage.get_identifier().get_destination_address()));
+			}
+			tempCANMessage.set_data(rxFrame.data, rxFrame.dataLength);
+			tempCANMessage.set_timestamp_us(SystemTiming::get_timestamp_us());
 
-		CANNetworkManager::CANNetwork.receive_can_message(tempCANMessage);
+			receive_can_message(tempCANMessage);
+		}
 	}
 
 	bool CANNetworkManager::add_protocol_parameter_group_number_callback(std::uint32_t parameterGroupNumber, CANLibCallback callback, void *parentPointer)
@@ -334,7 +557,8 @@ namespace isobus
 				// Look through active CFs, maybe we've heard of this ECU before
 				for (auto currentControlFunction : activeControlFunctions)
 				{
-					if (currentControlFunction->get_address() == messageSourceAddress)
+					if ((currentControlFunction->get_can_port() == CANPort) &&
+					    (currentControlFunction->get_address() == messageSourceAddress))
 					{
 						// ECU has claimed since the last update, add it to the table
 						controlFunctionTable[CANPort][messageSourceAddress] = currentControlFunction;
@@ -365,7 +589,8 @@ namespace isobus
 				// Look through active CFs, maybe we've heard of this ECU before
 				for (auto currentControlFunction : activeControlFunctions)
 				{
-					if (currentControlFunction->get_address() == claimedAddress)
+					if ((currentControlFunction->get_can_port() == CANPort) &&
+					    (currentControlFunction->get_address() == claimedAddress))
 					{
 						// ECU has claimed since the last update, add it to the table
 						controlFunctionTable[CANPort][claimedAddress] = currentControlFunction;
@@ -396,12 +621,15 @@ namespace isobus
 
 			for (std::uint32_t i = 0; i < activeControlFunctions.size(); i++)
 			{
-				if (claimedNAME == activeControlFunctions[i]->controlFunctionNAME.get_full_name())
+				// Each port is its own bus, so only CFs on the port the claim came from are affected by it
+				if ((rxFrame.channel == activeControlFunctions[i]->get_can_port()) &&
+				    (claimedNAME == activeControlFunctions[i]->controlFunctionNAME.get_full_name()))
 				{
 					// Device already in the active list
 					foundControlFunction = activeControlFunctions[i];
 				}
-				else if (activeControlFunctions[i]->address == CANIdentifier(rxFrame.identifier).get_source_address())
+				else if ((rxFrame.channel == activeControlFunctions[i]->get_can_port()) &&
+				         (activeControlFunctions[i]->address == CANIdentifier(rxFrame.identifier).get_source_address()))
 				{
 					// If this CF has the same address as the one claiming, we need set it to 0xFE (null address)
 					activeControlFunctions[i]->address = CANIdentifier::NULL_ADDRESS;
@@ -412,12 +640,13 @@ namespace isobus
 			// Alwas have to iterate the list to check for duplicate addresses
 			for (std::uint32_t i = 0; i < inactiveControlFunctions.size(); i++)
 			{
-				if (claimedNAME == inactiveControlFunctions[i]->controlFunctionNAME.get_full_name())
+				if ((rxFrame.channel == inactiveControlFunctions[i]->get_can_port()) &&
+				    (claimedNAME == inactiveControlFunctions[i]->controlFunctionNAME.get_full_name()))
 				{
 					// Device already in the inactive list
 					foundControlFunction = inactiveControlFunctions[i];
 				}
-				else
+				else if (rxFrame.channel == inactiveControlFunctions[i]->get_can_port())
 				{
 					// If this CF has the same address as the one claiming, we need set it to 0xFE (null address)
 					inactiveControlFunctions[i]->address = CANIdentifier::NULL_ADDRESS;
@@ -429,12 +658,14 @@ namespace isobus
 				// If we still haven't found it, it might be a partner. Check the list of partners.
 				for (auto partner : PartneredControlFunction::partneredControlFunctionList)
 				{
-					if (partner->check_matches_name(NAME(claimedNAME)))
+					if ((this == &partner->get_network_manager()) &&
+					    (rxFrame.channel == partner->get_can_port()) &&
+					    (partner->check_matches_name(NAME(claimedNAME))))
 					{
 						partner->address = CANIdentifier(rxFrame.identifier).get_source_address();
 						activeControlFunctions.push_back(partner);
 						foundControlFunction = partner;
-						CANStackLogger::CAN_stack_log("[NM]: A Partner Has Claimed " + isobus::to_string(static_cast<int>(CANIdentifier(rxFrame.identifier).get_source_address())));
+						CANStackLogger::info("[NM]: A Partner Has Claimed ", static_cast<int>(CANIdentifier(rxFrame.identifier).get_source_address()));
 						break;
 					}
 				}
@@ -442,8 +673,8 @@ namespace isobus
 				if (nullptr == foundControlFunction)
 				{
 					// New device, need to start keeping track of it
-					activeControlFunctions.push_back(new ControlFunction(NAME(claimedNAME), CANIdentifier(rxFrame.identifier).get_source_address(), rxFrame.channel));
-					CANStackLogger::CAN_stack_log("[NM]: New Control function " + isobus::to_string(static_cast<int>(CANIdentifier(rxFrame.identifier).get_source_address())));
+					activeControlFunctions.push_back(new ControlFunction(NAME(claimedNAME), CANIdentifier(rxFrame.identifier).get_source_address(), rxFrame.channel, *this));
+					CANStackLogger::info("[NM]: New Control function ", static_cast<int>(CANIdentifier(rxFrame.identifier).get_source_address()));
 				}
 			}
 
@@ -539,7 +770,10 @@ namespace isobus
 					    (nullptr != get_global_parameter_group_number_callback(i).get_callback()))
 					{
 						// We have a callback that matches this PGN
+						CANLatencyProfiler::record_message_latency(CANLatencyProfiler::Stage::Callback, *message);
+						const std::uint64_t dispatchTimestamp_us = CANStackTrace::get_timestamp_us();
 						get_global_parameter_group_number_callback(i).get_callback()(message, get_global_parameter_group_number_callback(i).get_parent());
+						CANStackTrace::record_callback_dispatch(CANStackTrace::CallbackType::Global, *message, dispatchTimestamp_us);
 					}
 				}
 			}
@@ -556,6 +790,7 @@ namespace isobus
 							PartneredControlFunction *currentControlFunction = PartneredControlFunction::get_partnered_control_function(j);
 
 							if ((nullptr != currentControlFunction) &&
+							    (this == &currentControlFunction->get_network_manager()) &&
 							    (currentControlFunction->get_can_port() == message->get_can_port_index()))
 							{
 								// Message matches CAN port for a partnered control function
@@ -565,7 +800,10 @@ namespace isobus
 									    (nullptr != currentControlFunction->get_parameter_group_number_callback(k).get_callback()))
 									{
 										// We have a callback matching this message
+										CANLatencyProfiler::record_message_latency(CANLatencyProfiler::Stage::Callback, *message);
+										const std::uint64_t dispatchTimestamp_us = CANStackTrace::get_timestamp_us();
 										currentControlFunction->get_parameter_group_number_callback(k).get_callback()(message, currentControlFunction->get_parameter_group_number_callback(k).get_parent());
+										CANStackTrace::record_callback_dispatch(CANStackTrace::CallbackType::Partnered, *message, dispatchTimestamp_us);
 									}
 								}
 							}
@@ -591,6 +829,7 @@ namespace isobus
 			processNextMessage = (!receiveMessageList.empty());
 			receiveMessageMutex.unlock();
 
+			CANLatencyProfiler::record_message_latency(CANLatencyProfiler::Stage::StackQueue, currentMessage);
 			update_address_table(currentMessage);
 
 			// Update Protocols
@@ -599,7 +838,9 @@ namespace isobus
 			{
 				if (currentCallback.parameterGroupNumber == currentMessage.get_identifier().get_parameter_group_number())
 				{
+					const std::uint64_t dispatchTimestamp_us = CANStackTrace::get_timestamp_us();
 					currentCallback.callback(&currentMessage, currentCallback.parent);
+					CANStackTrace::record_callback_dispatch(CANStackTrace::CallbackType::Protocol, currentMessage, dispatchTimestamp_us);
 				}
 			}
 			protocolPGNCallbacksMutex.unlock();
@@ -615,9 +856,18 @@ namespace isobus
 		bool retVal = false;
 
 		if ((DEFAULT_IDENTIFIER != tempFrame.identifier) &&
-		    (portIndex < CAN_PORT_MAXIMUM))
+		    (portIndex < CAN_PORT_MAXIMUM) &&
+		    (NO_HARDWARE_CHANNEL != hardwareChannels[portIndex]))
 		{
+			tempFrame.channel = hardwareChannels[portIndex];
 			retVal = send_can_message_to_hardware(tempFrame);
+			CANStackTrace::record_frame(retVal ? CANStackTrace::EventType::FrameTransmitted : CANStackTrace::EventType::FrameTransmitFailed, tempFrame);
+
+			if ((retVal) &&
+			    (busLoadEnabled.load(std::memory_order_relaxed)))
+			{
+				busLoads[portIndex].add_frame(tempFrame);
+			}
 		}
 		return retVal;
 	}
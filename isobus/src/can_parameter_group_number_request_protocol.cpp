@@ -10,8 +10,9 @@
 //================================================================================================
 #include "isobus/isobus/can_parameter_group_number_request_protocol.hpp"
 #include "isobus/isobus/can_general_parameter_group_numbers.hpp"
+#include "isobus/isobus/can_network_configuration.hpp"
 #include "isobus/isobus/can_warning_logger.hpp"
-#include "isobus/utility/to_string.hpp"
+#include "isobus/utility/system_timing.hpp"
 
 #include <algorithm>
 
@@ -24,14 +25,14 @@ namespace isobus
 		if (!initialized)
 		{
 			initialized = true;
-			CANNetworkManager::CANNetwork.add_protocol_parameter_group_number_callback(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ParameterGroupNumberRequest), process_message, this);
-			CANNetworkManager::CANNetwork.add_protocol_parameter_group_number_callback(static_cast<std::uint32_t>(CANLibParameterGroupNumber::RequestForRepetitionRate), process_message, this);
+			networkManager.add_protocol_parameter_group_number_callback(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ParameterGroupNumberRequest), process_message, this);
+			networkManager.add_protocol_parameter_group_number_callback(static_cast<std::uint32_t>(CANLibParameterGroupNumber::RequestForRepetitionRate), process_message, this);
 		}
 	}
 
 	bool ParameterGroupNumberRequestProtocol::assign_pgn_request_protocol_to_internal_control_function(std::shared_ptr<InternalControlFunction> internalControlFunction)
 	{
-		bool retVal = true;
+		bool retVal = (nullptr != internalControlFunction);
 
 		for (auto protocolLocation : pgnRequestProtocolList)
 		{
@@ -89,11 +90,17 @@ namespace isobus
 		buffer[1] = static_cast<std::uint8_t>((pgn >> 8) & 0xFF);
 		buffer[2] = static_cast<std::uint8_t>((pgn >> 16) & 0xFF);
 
-		return CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ParameterGroupNumberRequest),
-		                                                      buffer.data(),
-		                                                      PGN_REQUEST_LENGTH,
-		                                                      source,
-		                                                      destination);
+		bool retVal = false;
+
+		if (nullptr != source)
+		{
+			retVal = source->get_network_manager().send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ParameterGroupNumberRequest),
+			                                                        buffer.data(),
+			                                                        PGN_REQUEST_LENGTH,
+			                                                        source,
+			                                                        destination);
+		}
+		return retVal;
 	}
 
 	bool ParameterGroupNumberRequestProtocol::request_repetition_rate(std::uint32_t pgn, std::uint16_t repetitionRate_ms, InternalControlFunction *source, ControlFunction *destination)
@@ -109,11 +116,17 @@ namespace isobus
 		buffer[6] = 0xFF;
 		buffer[7] = 0xFF;
 
-		return CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::RequestForRepetitionRate),
-		                                                      buffer.data(),
-		                                                      CAN_DATA_LENGTH,
-		                                                      source,
-		                                                      destination);
+		bool retVal = false;
+
+		if (nullptr != source)
+		{
+			retVal = source->get_network_manager().send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::RequestForRepetitionRate),
+			                                                        buffer.data(),
+			                                                        CAN_DATA_LENGTH,
+			                                                        source,
+			                                                        destination);
+		}
+		return retVal;
 	}
 
 	bool ParameterGroupNumberRequestProtocol::register_pgn_request_callback(std::uint32_t pgn, PGNRequestCallback callback, void *parentPointer)
@@ -176,6 +189,100 @@ namespace isobus
 		return retVal;
 	}
 
+	bool ParameterGroupNumberRequestProtocol::publish_cached_response(std::uint32_t pgn, const std::uint8_t *data, std::uint32_t dataLength, std::uint32_t version)
+	{
+		bool retVal = false;
+
+		if ((nullptr != data) && (0 != dataLength) && (dataLength <= CANMessage::ABSOLUTE_MAX_MESSAGE_LENGTH))
+		{
+			const std::lock_guard<std::mutex> lock(responseCacheMutex);
+			auto cacheLocation = responseCache.find(pgn);
+
+			if ((responseCache.end() == cacheLocation) || (cacheLocation->second.version != version))
+			{
+				CachedResponse &entry = responseCache[pgn];
+				entry.payload = std::make_shared<const std::vector<std::uint8_t>>(data, data + dataLength);
+				entry.version = version;
+				retVal = true;
+			}
+		}
+		return retVal;
+	}
+
+	bool ParameterGroupNumberRequestProtocol::remove_cached_response(std::uint32_t pgn)
+	{
+		const std::lock_guard<std::mutex> lock(responseCacheMutex);
+		return (0 != responseCache.erase(pgn));
+	}
+
+	bool ParameterGroupNumberRequestProtocol::get_cached_response_version(std::uint32_t pgn, std::uint32_t &version)
+	{
+		bool retVal = false;
+		const std::lock_guard<std::mutex> lock(responseCacheMutex);
+		auto cacheLocation = responseCache.find(pgn);
+
+		if (responseCache.end() != cacheLocation)
+		{
+			version = cacheLocation->second.version;
+			retVal = true;
+		}
+		return retVal;
+	}
+
+	bool ParameterGroupNumberRequestProtocol::register_periodic_transmission(std::uint32_t pgn, std::uint32_t defaultInterval_ms, PeriodicTransmitCallback callback, void *parentPointer)
+	{
+		bool retVal = false;
+		const std::lock_guard<std::mutex> lock(scheduleMutex);
+
+		if ((nullptr != callback) &&
+		    (periodicTransmissions.end() == std::find_if(periodicTransmissions.begin(), periodicTransmissions.end(), [pgn](const PeriodicTransmitInfo &info) { return (info.pgn == pgn); })))
+		{
+			periodicTransmissions.push_back(PeriodicTransmitInfo(callback, pgn, defaultInterval_ms, parentPointer));
+
+			if (0 != defaultInterval_ms)
+			{
+				transmitSchedule.push_back(ScheduledTransmission(pgn, nullptr, defaultInterval_ms, SystemTiming::get_timestamp_ms()));
+				std::push_heap(transmitSchedule.begin(), transmitSchedule.end(), ScheduledTransmission::due_after);
+			}
+			retVal = true;
+		}
+		return retVal;
+	}
+
+	bool ParameterGroupNumberRequestProtocol::remove_periodic_transmission(std::uint32_t pgn)
+	{
+		bool retVal = false;
+		const std::lock_guard<std::mutex> lock(scheduleMutex);
+
+		auto transmitLocation = std::find_if(periodicTransmissions.begin(), periodicTransmissions.end(), [pgn](const PeriodicTransmitInfo &info) { return (info.pgn == pgn); });
+
+		if (periodicTransmissions.end() != transmitLocation)
+		{
+			periodicTransmissions.erase(transmitLocation);
+			unschedule(pgn, true, nullptr);
+			retVal = true;
+		}
+		return retVal;
+	}
+
+	std::size_t ParameterGroupNumberRequestProtocol::get_number_scheduled_transmissions() const
+	{
+		const std::lock_guard<std::mutex> lock(scheduleMutex);
+		return transmitSchedule.size();
+	}
+
+	void ParameterGroupNumberRequestProtocol::set_repetition_rate_request_timeout(std::uint32_t timeout_ms)
+	{
+		const std::lock_guard<std::mutex> lock(scheduleMutex);
+		repetitionRateRequestTimeout_ms = timeout_ms;
+	}
+
+	std::uint32_t ParameterGroupNumberRequestProtocol::get_repetition_rate_request_timeout() const
+	{
+		const std::lock_guard<std::mutex> lock(scheduleMutex);
+		return repetitionRateRequestTimeout_ms;
+	}
+
 	std::size_t ParameterGroupNumberRequestProtocol::get_number_registered_pgn_request_callbacks() const
 	{
 		return pgnRequestCallbacks.size();
@@ -188,6 +295,9 @@ namespace isobus
 
 	void ParameterGroupNumberRequestProtocol::update(CANLibBadge<CANNetworkManager>)
 	{
+		process_pending_responses();
+		expire_repetition_rate_requests();
+		process_transmit_schedule();
 	}
 
 	ParameterGroupNumberRequestProtocol::PGNRequestCallbackInfo::PGNRequestCallbackInfo(PGNRequestCallback callback, std::uint32_t parameterGroupNumber, void *parentPointer) :
@@ -204,6 +314,29 @@ namespace isobus
 	{
 	}
 
+	ParameterGroupNumberRequestProtocol::PeriodicTransmitInfo::PeriodicTransmitInfo(PeriodicTransmitCallback callback, std::uint32_t parameterGroupNumber, std::uint32_t interval_ms, void *parentPointer) :
+	  callbackFunction(callback),
+	  pgn(parameterGroupNumber),
+	  defaultInterval_ms(interval_ms),
+	  parent(parentPointer)
+	{
+	}
+
+	ParameterGroupNumberRequestProtocol::ScheduledTransmission::ScheduledTransmission(std::uint32_t parameterGroupNumber, ControlFunction *requester, std::uint32_t rate_ms, std::uint32_t timestamp_ms) :
+	  pgn(parameterGroupNumber),
+	  destination(requester),
+	  interval_ms(rate_ms),
+	  nextTransmitTimestamp_ms(timestamp_ms),
+	  lastRequestTimestamp_ms(timestamp_ms)
+	{
+	}
+
+	bool ParameterGroupNumberRequestProtocol::ScheduledTransmission::due_after(const ScheduledTransmission &lhs, const ScheduledTransmission &rhs)
+	{
+		// Compare through a signed difference so that ordering survives u32 timestamp rollover
+		return (static_cast<std::int32_t>(lhs.nextTransmitTimestamp_ms - rhs.nextTransmitTimestamp_ms) > 0);
+	}
+
 	bool ParameterGroupNumberRequestProtocol::PGNRequestCallbackInfo::operator==(const PGNRequestCallbackInfo &obj)
 	{
 		return ((obj.callbackFunction == this->callbackFunction) && (obj.pgn == this->pgn) && (obj.parent == this->parent));
@@ -231,20 +364,23 @@ namespace isobus
 						auto data = message->get_data();
 						std::uint32_t requestedPGN = data[0];
 						requestedPGN |= (static_cast<std::uint32_t>(data[1]) << 8);
-						requestedPGN |= (static_cast<std::uint32_t>(data[2]) << 8);
+						requestedPGN |= (static_cast<std::uint32_t>(data[2]) << 16);
 
 						std::uint16_t requestedRate = data[3];
 						requestedRate |= (static_cast<std::uint16_t>(data[4]) << 8);
 
-						const std::lock_guard<std::mutex> lock(pgnRequestMutex);
-
-						for (auto repetitionRateCallback : repetitionRateCallbacks)
+						if (!schedule_repetition_rate_request(requestedPGN, message->get_source_control_function(), requestedRate))
 						{
-							if (((repetitionRateCallback.pgn == requestedPGN) ||
-							     (static_cast<std::uint32_t>(isobus::CANLibParameterGroupNumber::Any) == repetitionRateCallback.pgn)) &&
-							    (repetitionRateCallback.callbackFunction(requestedPGN, message->get_source_control_function(), requestedRate, repetitionRateCallback.parent)))
+							const std::lock_guard<std::mutex> lock(pgnRequestMutex);
+
+							for (auto repetitionRateCallback : repetitionRateCallbacks)
 							{
-								break;
+								if (((repetitionRateCallback.pgn == requestedPGN) ||
+								     (static_cast<std::uint32_t>(isobus::CANLibParameterGroupNumber::Any) == repetitionRateCallback.pgn)) &&
+								    (repetitionRateCallback.callbackFunction(requestedPGN, message->get_source_control_function(), requestedRate, repetitionRateCallback.parent)))
+								{
+									break;
+								}
 							}
 						}
 
@@ -255,7 +391,7 @@ namespace isobus
 					}
 					else
 					{
-						CANStackLogger::CAN_stack_log("[PR]: Received a malformed or broadcast request for repetition rate message. The message will not be processed.");
+						CANStackLogger::warn("[PR]: Received a malformed or broadcast request for repetition rate message. The message will not be processed.");
 					}
 				}
 				break;
@@ -270,7 +406,13 @@ namespace isobus
 						auto data = message->get_data();
 						std::uint32_t requestedPGN = data[0];
 						requestedPGN |= (static_cast<std::uint32_t>(data[1]) << 8);
-						requestedPGN |= (static_cast<std::uint32_t>(data[2]) << 8);
+						requestedPGN |= (static_cast<std::uint32_t>(data[2]) << 16);
+
+						if (send_cached_response(requestedPGN, message))
+						{
+							// Served from the response cache, so there's no need to involve any callbacks
+							break;
+						}
 
 						const std::lock_guard<std::mutex> lock(pgnRequestMutex);
 
@@ -304,12 +446,12 @@ namespace isobus
 							                     requestedPGN,
 							                     reinterpret_cast<InternalControlFunction *>(message->get_destination_control_function()),
 							                     message->get_source_control_function());
-							CANStackLogger::CAN_stack_log("[PR]: NACK-ing PGN request for PGN " + isobus::to_string(requestedPGN) + " because no callback could handle it.");
+							CANStackLogger::info("[PR]: NACK-ing PGN request for PGN ", requestedPGN, " because no callback could handle it.");
 						}
 					}
 					else
 					{
-						CANStackLogger::CAN_stack_log("[PR]: Received a malformed PGN request message. The message will not be processed.");
+						CANStackLogger::warn("[PR]: Received a malformed PGN request message. The message will not be processed.");
 					}
 				}
 				break;
@@ -323,7 +465,9 @@ namespace isobus
 	}
 
 	ParameterGroupNumberRequestProtocol::ParameterGroupNumberRequestProtocol(std::shared_ptr<InternalControlFunction> internalControlFunction) :
-	  myControlFunction(internalControlFunction)
+	  CANLibProtocol(internalControlFunction->get_network_manager()),
+	  myControlFunction(internalControlFunction),
+	  repetitionRateRequestTimeout_ms(0)
 	{
 	}
 
@@ -331,8 +475,8 @@ namespace isobus
 	{
 		if (initialized)
 		{
-			CANNetworkManager::CANNetwork.remove_protocol_parameter_group_number_callback(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ParameterGroupNumberRequest), process_message, this);
-			CANNetworkManager::CANNetwork.remove_protocol_parameter_group_number_callback(static_cast<std::uint32_t>(CANLibParameterGroupNumber::RequestForRepetitionRate), process_message, this);
+			networkManager.remove_protocol_parameter_group_number_callback(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ParameterGroupNumberRequest), process_message, this);
+			networkManager.remove_protocol_parameter_group_number_callback(static_cast<std::uint32_t>(CANLibParameterGroupNumber::RequestForRepetitionRate), process_message, this);
 		}
 	}
 
@@ -356,6 +500,286 @@ namespace isobus
 		return false; // This protocol is not a transport layer, so just return false
 	}
 
+	bool ParameterGroupNumberRequestProtocol::send_cached_response(std::uint32_t pgn, CANMessage *const message)
+	{
+		bool retVal = false;
+
+		responseCacheMutex.lock();
+		auto cacheLocation = responseCache.find(pgn);
+		if (responseCache.end() != cacheLocation)
+		{
+			std::size_t payloadLength = cacheLocation->second.payload->size();
+			responseCacheMutex.unlock();
+
+			// Global requests get a global response, otherwise respond only to the requester.
+			// Single frame PDU2 messages have no destination address, so those are always global.
+			ControlFunction *destination = message->get_source_control_function();
+			if ((nullptr == message->get_destination_control_function()) ||
+			    (((pgn & 0xF000) >= 0xF000) && (payloadLength <= CAN_DATA_LENGTH)))
+			{
+				destination = nullptr;
+			}
+
+			retVal = true;
+			if (0 == CANNetworkConfiguration::get_request_coalescing_window())
+			{
+				transmit_cached_response(pgn, destination);
+			}
+			else
+			{
+				coalesce_response(pgn, destination);
+			}
+		}
+		else
+		{
+			responseCacheMutex.unlock();
+		}
+		return retVal;
+	}
+
+	void ParameterGroupNumberRequestProtocol::coalesce_response(std::uint32_t pgn, ControlFunction *destination)
+	{
+		const std::lock_guard<std::mutex> lock(responseCacheMutex);
+		bool alreadyPending = false;
+		std::uint32_t firstRequestTimestamp_ms = SystemTiming::get_timestamp_ms();
+
+		for (auto &pendingResponse : pendingResponses)
+		{
+			// A pending global response, or an identical one, already answers this request
+			if ((pendingResponse.pgn == pgn) &&
+			    ((nullptr == pendingResponse.destination) || (destination == pendingResponse.destination)))
+			{
+				alreadyPending = true;
+				break;
+			}
+		}
+
+		if (!alreadyPending)
+		{
+			if (nullptr == destination)
+			{
+				// A global response satisfies every destination specific response pending for this PGN.
+				// Keep the oldest request's timestamp so that nobody waits longer than the window.
+				auto newEnd = std::remove_if(pendingResponses.begin(), pendingResponses.end(), [pgn, &firstRequestTimestamp_ms](const PendingResponse &pendingResponse) {
+					bool retVal = (pendingResponse.pgn == pgn);
+
+					if ((retVal) && (static_cast<std::int32_t>(firstRequestTimestamp_ms - pendingResponse.timestamp_ms) > 0))
+					{
+						firstRequestTimestamp_ms = pendingResponse.timestamp_ms;
+					}
+					return retVal;
+				});
+				pendingResponses.erase(newEnd, pendingResponses.end());
+			}
+
+			PendingResponse newResponse;
+			newResponse.pgn = pgn;
+			newResponse.destination = destination;
+			newResponse.timestamp_ms = firstRequestTimestamp_ms;
+			pendingResponses.push_back(newResponse);
+		}
+	}
+
+	void ParameterGroupNumberRequestProtocol::process_pending_responses()
+	{
+		std::vector<PendingResponse> dueResponses;
+		const std::uint32_t window_ms = CANNetworkConfiguration::get_request_coalescing_window();
+
+		responseCacheMutex.lock();
+		for (auto pendingResponse = pendingResponses.begin(); pendingResponse != pendingResponses.end();)
+		{
+			if (SystemTiming::time_expired_ms(pendingResponse->timestamp_ms, window_ms))
+			{
+				dueResponses.push_back(*pendingResponse);
+				pendingResponse = pendingResponses.erase(pendingResponse);
+			}
+			else
+			{
+				pendingResponse++;
+			}
+		}
+		responseCacheMutex.unlock();
+
+		for (auto &dueResponse : dueResponses)
+		{
+			if (!transmit_cached_response(dueResponse.pgn, dueResponse.destination))
+			{
+				// Try again next update. The window has closed, so it will go out as soon as it can.
+				const std::lock_guard<std::mutex> lock(responseCacheMutex);
+				pendingResponses.push_back(dueResponse);
+			}
+		}
+	}
+
+	bool ParameterGroupNumberRequestProtocol::transmit_cached_response(std::uint32_t pgn, ControlFunction *destination)
+	{
+		std::shared_ptr<const std::vector<std::uint8_t>> payload;
+		bool retVal = true;
+
+		responseCacheMutex.lock();
+		auto cacheLocation = responseCache.find(pgn);
+		if (responseCache.end() != cacheLocation)
+		{
+			payload = cacheLocation->second.payload;
+		}
+		responseCacheMutex.unlock();
+
+		if ((nullptr != payload) &&
+		    ((nullptr == destination) || (destination->get_address_valid())))
+		{
+			retVal = networkManager.send_can_message(pgn,
+			                                         payload->data(),
+			                                         static_cast<std::uint32_t>(payload->size()),
+			                                         myControlFunction.get(),
+			                                         destination);
+			if (!retVal)
+			{
+				CANStackLogger::warn("[PR]: Failed to send cached response for PGN ", pgn);
+			}
+		}
+		return retVal;
+	}
+
+	bool ParameterGroupNumberRequestProtocol::schedule_repetition_rate_request(std::uint32_t pgn, ControlFunction *requester, std::uint16_t rate_ms)
+	{
+		bool retVal = false;
+		const std::lock_guard<std::mutex> lock(scheduleMutex);
+
+		if ((nullptr != requester) &&
+		    (periodicTransmissions.end() != std::find_if(periodicTransmissions.begin(), periodicTransmissions.end(), [pgn](const PeriodicTransmitInfo &info) { return (info.pgn == pgn); })))
+		{
+			retVal = true;
+
+			if (DEFAULT_REPETITION_RATE == rate_ms)
+			{
+				unschedule(pgn, false, requester);
+			}
+			else
+			{
+				std::uint32_t clampedRate_ms = (rate_ms < MINIMUM_REPETITION_RATE_MS) ? MINIMUM_REPETITION_RATE_MS : rate_ms;
+				auto scheduleLocation = std::find_if(transmitSchedule.begin(), transmitSchedule.end(), [pgn, requester](const ScheduledTransmission &entry) { return ((entry.pgn == pgn) && (entry.destination == requester)); });
+
+				if ((transmitSchedule.end() != scheduleLocation) && (scheduleLocation->interval_ms == clampedRate_ms))
+				{
+					// Same request repeated, so only renew it. Keeps the existing phase.
+					scheduleLocation->lastRequestTimestamp_ms = SystemTiming::get_timestamp_ms();
+				}
+				else
+				{
+					// New requester or new rate. The rate is part of the key, so replace the old entry and send right away.
+					unschedule(pgn, false, requester);
+					transmitSchedule.push_back(ScheduledTransmission(pgn, requester, clampedRate_ms, SystemTiming::get_timestamp_ms()));
+					std::push_heap(transmitSchedule.begin(), transmitSchedule.end(), ScheduledTransmission::due_after);
+					CANStackLogger::debug("[PR]: Scheduled PGN ", pgn, " every ", clampedRate_ms, "ms for address ", static_cast<int>(requester->get_address()));
+				}
+			}
+		}
+		return retVal;
+	}
+
+	void ParameterGroupNumberRequestProtocol::unschedule(std::uint32_t pgn, bool matchAnyDestination, ControlFunction *destination)
+	{
+		auto newEnd = std::remove_if(transmitSchedule.begin(), transmitSchedule.end(), [pgn, matchAnyDestination, destination](const ScheduledTransmission &entry) {
+			return ((entry.pgn == pgn) && ((matchAnyDestination) || (entry.destination == destination)));
+		});
+
+		if (transmitSchedule.end() != newEnd)
+		{
+			transmitSchedule.erase(newEnd, transmitSchedule.end());
+			std::make_heap(transmitSchedule.begin(), transmitSchedule.end(), ScheduledTransmission::due_after);
+		}
+	}
+
+	void ParameterGroupNumberRequestProtocol::expire_repetition_rate_requests()
+	{
+		const std::lock_guard<std::mutex> lock(scheduleMutex);
+		const std::uint32_t timeout_ms = repetitionRateRequestTimeout_ms;
+
+		auto newEnd = std::remove_if(transmitSchedule.begin(), transmitSchedule.end(), [timeout_ms](const ScheduledTransmission &entry) {
+			return ((nullptr != entry.destination) &&
+			        ((!entry.destination->get_address_valid()) ||
+			         ((0 != timeout_ms) && (SystemTiming::time_expired_ms(entry.lastRequestTimestamp_ms, timeout_ms)))));
+		});
+
+		if (transmitSchedule.end() != newEnd)
+		{
+			transmitSchedule.erase(newEnd, transmitSchedule.end());
+			std::make_heap(transmitSchedule.begin(), transmitSchedule.end(), ScheduledTransmission::due_after);
+		}
+	}
+
+	void ParameterGroupNumberRequestProtocol::process_transmit_schedule()
+	{
+		std::vector<ScheduledTransmission> dueTransmissions;
+		std::vector<PeriodicTransmitInfo> transmitters;
+		const std::uint32_t currentTimestamp_ms = SystemTiming::get_timestamp_ms();
+
+		scheduleMutex.lock();
+		// The front of the heap is the next entry due, so most updates stop here
+		if ((!transmitSchedule.empty()) &&
+		    (static_cast<std::int32_t>(currentTimestamp_ms - transmitSchedule.front().nextTransmitTimestamp_ms) >= 0))
+		{
+			for (auto &entry : transmitSchedule)
+			{
+				if (static_cast<std::int32_t>(currentTimestamp_ms - entry.nextTransmitTimestamp_ms) >= 0)
+				{
+					dueTransmissions.push_back(entry);
+				}
+			}
+			transmitters = periodicTransmissions;
+		}
+		scheduleMutex.unlock();
+
+		// The callbacks are called without the lock held, so that they can send, or change the schedule, freely.
+		// Each PGN and destination has at most one entry, so everything due this tick goes out once as one batch.
+		std::vector<bool> sent(dueTransmissions.size(), false);
+		for (std::size_t i = 0; i < dueTransmissions.size(); i++)
+		{
+			for (auto &transmitter : transmitters)
+			{
+				if (transmitter.pgn == dueTransmissions[i].pgn)
+				{
+					sent[i] = transmitter.callbackFunction(transmitter.pgn, dueTransmissions[i].destination, transmitter.parent);
+					break;
+				}
+			}
+		}
+
+		const std::lock_guard<std::mutex> lock(scheduleMutex);
+		bool scheduleChanged = false;
+
+		for (std::size_t i = 0; i < dueTransmissions.size(); i++)
+		{
+			const ScheduledTransmission &dueEntry = dueTransmissions[i];
+
+			// Entries that were removed or replaced while the callbacks ran are left alone.
+			// Entries that weren't sent stay due, and are retried on the next update.
+			auto scheduleLocation = std::find_if(transmitSchedule.begin(), transmitSchedule.end(), [&dueEntry](const ScheduledTransmission &entry) {
+				return ((entry.pgn == dueEntry.pgn) &&
+				        (entry.destination == dueEntry.destination) &&
+				        (entry.interval_ms == dueEntry.interval_ms) &&
+				        (entry.nextTransmitTimestamp_ms == dueEntry.nextTransmitTimestamp_ms));
+			});
+
+			if ((sent[i]) && (transmitSchedule.end() != scheduleLocation))
+			{
+				scheduleLocation->nextTransmitTimestamp_ms += scheduleLocation->interval_ms;
+
+				// If we fell behind by more than a whole period, don't burst to catch up
+				if (static_cast<std::int32_t>(currentTimestamp_ms - scheduleLocation->nextTransmitTimestamp_ms) >= 0)
+				{
+					scheduleLocation->nextTransmitTimestamp_ms = currentTimestamp_ms + scheduleLocation->interval_ms;
+				}
+				scheduleChanged = true;
+			}
+		}
+
+		if (scheduleChanged)
+		{
+			std::make_heap(transmitSchedule.begin(), transmitSchedule.end(), ScheduledTransmission::due_after);
+		}
+	}
+
 	bool ParameterGroupNumberRequestProtocol::send_acknowledgement(AcknowledgementType type, std::uint32_t parameterGroupNumber, InternalControlFunction *source, ControlFunction *destination)
 	{
 		bool retVal = false;
@@ -373,11 +797,11 @@ namespace isobus
 			buffer[6] = static_cast<std::uint8_t>((parameterGroupNumber >> 8) & 0xFF);
 			buffer[7] = static_cast<std::uint8_t>((parameterGroupNumber >> 16) & 0xFF);
 
-			retVal = CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::Acknowledge),
-			                                                        buffer.data(),
-			                                                        CAN_DATA_LENGTH,
-			                                                        source,
-			                                                        nullptr);
+			retVal = networkManager.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::Acknowledge),
+			                                         buffer.data(),
+			                                         CAN_DATA_LENGTH,
+			                                         source,
+			                                         nullptr);
 		}
 		return retVal;
 	}
@@ -10,6 +10,7 @@
 #include "isobus/isobus/can_partnered_control_function.hpp"
 
 #include "isobus/isobus/can_constants.hpp"
+#include "isobus/isobus/can_network_manager.hpp"
 
 #include <algorithm>
 
@@ -18,7 +19,12 @@ namespace isobus
 	std::vector<PartneredControlFunction *> PartneredControlFunction::partneredControlFunctionList;
 
 	PartneredControlFunction::PartneredControlFunction(std::uint8_t CANPort, const std::vector<NAMEFilter> NAMEFilters) :
-	  ControlFunction(NAME(0), NULL_CAN_ADDRESS, CANPort),
+	  PartneredControlFunction(CANPort, NAMEFilters, CANNetworkManager::CANNetwork)
+	{
+	}
+
+	PartneredControlFunction::PartneredControlFunction(std::uint8_t CANPort, const std::vector<NAMEFilter> NAMEFilters, CANNetworkManager &parentNetworkManager) :
+	  ControlFunction(NAME(0), NULL_CAN_ADDRESS, CANPort, parentNetworkManager),
 	  NAMEFilterList(NAMEFilters)
 	{
 		controlFunctionType = Type::Partnered;
@@ -8,27 +8,25 @@
 /// @copyright 2022 Adrian Del Grosso
 //================================================================================================
 #include "isobus/isobus/can_protocol.hpp"
-
-#include <algorithm>
+#include "isobus/isobus/can_network_manager.hpp"
 
 namespace isobus
 {
-	std::vector<CANLibProtocol *> CANLibProtocol::protocolList;
-
 	CANLibProtocol::CANLibProtocol() :
+	  CANLibProtocol(CANNetworkManager::CANNetwork)
+	{
+	}
+
+	CANLibProtocol::CANLibProtocol(CANNetworkManager &parentNetworkManager) :
+	  networkManager(parentNetworkManager),
 	  initialized(false)
 	{
-		protocolList.push_back(this);
+		networkManager.add_protocol(this, {});
 	}
 
 	CANLibProtocol::~CANLibProtocol()
 	{
-		auto protocolLocation = find(protocolList.begin(), protocolList.end(), this);
-
-		if (protocolList.end() != protocolLocation)
-		{
-			protocolList.erase(protocolLocation);
-		}
+		networkManager.remove_protocol(this, {});
 	}
 
 	bool CANLibProtocol::get_is_initialized() const
@@ -36,20 +34,19 @@ namespace isobus
 		return initialized;
 	}
 
-	bool CANLibProtocol::get_protocol(std::uint32_t index, CANLibProtocol *&returnedProtocol)
+	CANNetworkManager &CANLibProtocol::get_network_manager() const
 	{
-		returnedProtocol = nullptr;
+		return networkManager;
+	}
 
-		if (index < protocolList.size())
-		{
-			returnedProtocol = protocolList[index];
-		}
-		return (nullptr != returnedProtocol);
+	bool CANLibProtocol::get_protocol(std::uint32_t index, CANLibProtocol *&returnedProtocol)
+	{
+		return CANNetworkManager::CANNetwork.get_protocol(index, returnedProtocol);
 	}
 
 	std::uint32_t CANLibProtocol::get_number_protocols()
 	{
-		return protocolList.size();
+		return CANNetworkManager::CANNetwork.get_number_protocols();
 	}
 
 	void CANLibProtocol::initialize(CANLibBadge<CANNetworkManager>)
@@ -57,4 +54,28 @@ namespace isobus
 		initialized = true;
 	}
 
+	bool CANLibProtocol::protocol_transmit_shared_message(std::uint32_t parameterGroupNumber,
+	                                                      std::shared_ptr<const std::vector<std::uint8_t>> data,
+	                                                      ControlFunction *source,
+	                                                      ControlFunction *destination,
+	                                                      TransmitCompleteCallback transmitCompleteCallback,
+	                                                      void *parentPointer)
+	{
+		bool retVal = false;
+
+		if ((nullptr != data) &&
+		    (!data->empty()))
+		{
+			retVal = protocol_transmit_message(parameterGroupNumber,
+			                                   data->data(),
+			                                   data->size(),
+			                                   source,
+			                                   destination,
+			                                   transmitCompleteCallback,
+			                                   parentPointer,
+			                                   nullptr);
+		}
+		return retVal;
+	}
+
 } // namespace isobus
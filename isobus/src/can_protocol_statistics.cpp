@@ -0,0 +1,233 @@
+//================================================================================================
+/// @file can_protocol_statistics.cpp
+///
+/// @brief Counters that the transport protocols keep about their sessions, so that an
+/// application can see how its multi-frame traffic is doing at runtime.
+/// @author Adrian Del Grosso
+///
+/// @copyright 2022 Adrian Del Grosso
+//================================================================================================
+
+#include "isobus/isobus/can_protocol_statistics.hpp"
+
+#include <algorithm>
+#include <limits>
+
+namespace isobus
+{
+	LatencyHistogram::LatencyHistogram()
+	{
+		// Atomics aren't initialized by their default constructor in C++11
+		reset();
+	}
+
+	void LatencyHistogram::add_sample(std::uint32_t value)
+	{
+		std::uint32_t currentMaximum = maximum.load(std::memory_order_relaxed);
+
+		buckets[get_bucket(value)].fetch_add(1, std::memory_order_relaxed);
+
+		while ((value > currentMaximum) &&
+		       (!maximum.compare_exchange_weak(currentMaximum, value, std::memory_order_relaxed)))
+		{
+			// currentMaximum was updated by the failed exchange, so just try again
+		}
+	}
+
+	std::uint32_t LatencyHistogram::get_number_samples(std::uint8_t bucket) const
+	{
+		std::uint32_t retVal = 0;
+
+		if (bucket < NUMBER_OF_BUCKETS)
+		{
+			retVal = buckets[bucket].load(std::memory_order_relaxed);
+		}
+		return retVal;
+	}
+
+	std::uint32_t LatencyHistogram::get_total_number_samples() const
+	{
+		std::uint32_t retVal = 0;
+
+		for (auto &bucket : buckets)
+		{
+			retVal += bucket.load(std::memory_order_relaxed);
+		}
+		return retVal;
+	}
+
+	std::uint32_t LatencyHistogram::get_maximum() const
+	{
+		return maximum.load(std::memory_order_relaxed);
+	}
+
+	std::uint32_t LatencyHistogram::get_percentile_upper_limit(float percentile) const
+	{
+		const std::uint32_t totalSamples = get_total_number_samples();
+		std::uint32_t retVal = 0;
+
+		if (0 != totalSamples)
+		{
+			// The number of samples that have to be at or below the limit, less a little so that
+			// percentiles like 99.9, which a float can't hold exactly, don't round up a whole sample
+			const double samplesNeeded = ((static_cast<double>(totalSamples) * percentile) / 100.0) - 0.001;
+			std::uint8_t bucket = 0;
+			std::uint64_t samplesSoFar = get_number_samples(bucket);
+
+			while ((static_cast<double>(samplesSoFar) < samplesNeeded) &&
+			       (bucket < (NUMBER_OF_BUCKETS - 1)))
+			{
+				bucket++;
+				samplesSoFar += get_number_samples(bucket);
+			}
+			retVal = std::min(get_bucket_upper_limit(bucket), get_maximum());
+		}
+		return retVal;
+	}
+
+	std::uint32_t LatencyHistogram::get_bucket_upper_limit(std::uint8_t bucket)
+	{
+		std::uint32_t retVal;
+
+		if (bucket >= (NUMBER_OF_BUCKETS - 1))
+		{
+			retVal = std::numeric_limits<std::uint32_t>::max();
+		}
+		else
+		{
+			retVal = ((static_cast<std::uint32_t>(1) << bucket) - 1);
+		}
+		return retVal;
+	}
+
+	std::uint8_t LatencyHistogram::get_bucket(std::uint32_t value)
+	{
+		std::uint8_t retVal = 0;
+
+		// The bucket is the number of bits needed to hold the value
+		while ((0 != value) &&
+		       (retVal < (NUMBER_OF_BUCKETS - 1)))
+		{
+			value >>= 1;
+			retVal++;
+		}
+		return retVal;
+	}
+
+	void LatencyHistogram::reset()
+	{
+		for (auto &bucket : buckets)
+		{
+			bucket.store(0, std::memory_order_relaxed);
+		}
+		maximum.store(0, std::memory_order_relaxed);
+	}
+
+	ProtocolStatistics::ProtocolStatistics()
+	{
+		// Atomics aren't initialized by their default constructor in C++11
+		reset();
+	}
+
+	void ProtocolStatistics::record_session_started(Direction direction)
+	{
+		sessionsStarted[static_cast<std::uint8_t>(direction)].fetch_add(1, std::memory_order_relaxed);
+	}
+
+	void ProtocolStatistics::record_session_completed(Direction direction, std::uint32_t numberOfBytes, std::uint32_t duration_ms)
+	{
+		sessionsCompleted[static_cast<std::uint8_t>(direction)].fetch_add(1, std::memory_order_relaxed);
+		bytesTransferred[static_cast<std::uint8_t>(direction)].fetch_add(numberOfBytes, std::memory_order_relaxed);
+		completionLatency[static_cast<std::uint8_t>(direction)].add_sample(duration_ms);
+	}
+
+	void ProtocolStatistics::record_session_closed(Direction direction)
+	{
+		// Release, so that anyone who sees this close also sees the session's completion if it had one
+		sessionsClosed[static_cast<std::uint8_t>(direction)].fetch_add(1, std::memory_order_release);
+	}
+
+	void ProtocolStatistics::record_abort_sent(std::uint8_t reason)
+	{
+		abortsSent[reason].fetch_add(1, std::memory_order_relaxed);
+	}
+
+	void ProtocolStatistics::record_abort_received(std::uint8_t reason)
+	{
+		abortsReceived[reason].fetch_add(1, std::memory_order_relaxed);
+	}
+
+	void ProtocolStatistics::record_retransmit_request(std::uint32_t numberOfPackets)
+	{
+		retransmittedPackets.fetch_add(numberOfPackets, std::memory_order_relaxed);
+	}
+
+	std::uint32_t ProtocolStatistics::get_number_sessions_started(Direction direction) const
+	{
+		return sessionsStarted[static_cast<std::uint8_t>(direction)].load(std::memory_order_relaxed);
+	}
+
+	std::uint32_t ProtocolStatistics::get_number_sessions_completed(Direction direction) const
+	{
+		return sessionsCompleted[static_cast<std::uint8_t>(direction)].load(std::memory_order_relaxed);
+	}
+
+	std::uint32_t ProtocolStatistics::get_number_sessions_failed(Direction direction) const
+	{
+		const std::uint32_t closed = sessionsClosed[static_cast<std::uint8_t>(direction)].load(std::memory_order_acquire);
+		const std::uint32_t completed = sessionsCompleted[static_cast<std::uint8_t>(direction)].load(std::memory_order_relaxed);
+		std::uint32_t retVal = 0;
+
+		// A session that just completed might not be closed yet
+		if (closed > completed)
+		{
+			retVal = (closed - completed);
+		}
+		return retVal;
+	}
+
+	std::uint64_t ProtocolStatistics::get_number_bytes(Direction direction) const
+	{
+		return bytesTransferred[static_cast<std::uint8_t>(direction)].load(std::memory_order_relaxed);
+	}
+
+	std::uint32_t ProtocolStatistics::get_number_aborts_sent(std::uint8_t reason) const
+	{
+		return abortsSent[reason].load(std::memory_order_relaxed);
+	}
+
+	std::uint32_t ProtocolStatistics::get_number_aborts_received(std::uint8_t reason) const
+	{
+		return abortsReceived[reason].load(std::memory_order_relaxed);
+	}
+
+	std::uint32_t ProtocolStatistics::get_number_retransmitted_packets() const
+	{
+		return retransmittedPackets.load(std::memory_order_relaxed);
+	}
+
+	const LatencyHistogram &ProtocolStatistics::get_completion_latency(Direction direction) const
+	{
+		return completionLatency[static_cast<std::uint8_t>(direction)];
+	}
+
+	void ProtocolStatistics::reset()
+	{
+		for (std::uint8_t i = 0; i < NUMBER_OF_DIRECTIONS; i++)
+		{
+			sessionsStarted[i].store(0, std::memory_order_relaxed);
+			sessionsCompleted[i].store(0, std::memory_order_relaxed);
+			sessionsClosed[i].store(0, std::memory_order_relaxed);
+			bytesTransferred[i].store(0, std::memory_order_relaxed);
+			completionLatency[i].reset();
+		}
+
+		for (std::uint16_t i = 0; i < NUMBER_OF_ABORT_REASONS; i++)
+		{
+			abortsSent[i].store(0, std::memory_order_relaxed);
+			abortsReceived[i].store(0, std::memory_order_relaxed);
+		}
+		retransmittedPackets.store(0, std::memory_order_relaxed);
+	}
+
+} // namespace isobus
@@ -0,0 +1,357 @@
+//================================================================================================
+/// @file can_stack_trace.cpp
+///
+/// @brief A compact binary trace of what the CAN stack is doing, like frames going in and out,
+/// transport session state changes, aborts, and how long callbacks take. Records are written
+/// into a lock-free ring per thread without any string formatting, so that tracing can be left
+/// on in the field without changing the timing of the stack very much. The trace can be written
+/// to a file and turned into text later with the trace decoder tool.
+/// @author Adrian Del Grosso
+///
+/// @copyright 2022 Adrian Del Grosso
+//================================================================================================
+
+#include "isobus/isobus/can_stack_trace.hpp"
+
+#include "isobus/isobus/can_message.hpp"
+#include "isobus/utility/system_timing.hpp"
+
+#include <algorithm>
+#include <array>
+#include <fstream>
+#include <memory>
+#include <mutex>
+
+namespace isobus
+{
+	namespace
+	{
+		static_assert(24 == sizeof(CANStackTrace::Record), "Trace records must stay 24 bytes, or the file version needs to change");
+		static_assert(16 == sizeof(CANStackTrace::FileHeader), "The trace file header must stay 16 bytes");
+		static_assert(16 == sizeof(CANStackTrace::BlockHeader), "The trace block header must stay 16 bytes");
+		static_assert(0 == (CANStackTrace::RECORDS_PER_THREAD & (CANStackTrace::RECORDS_PER_THREAD - 1)), "The ring size must be a power of two");
+
+		/// @brief The records written by one thread
+		/// @details Only the owning thread writes records. Before it writes a slot it bumps `startedCount`,
+		/// and once the slot is written it bumps `writtenCount`. A reader copies the slots it wants and
+		/// then checks `startedCount` again, throwing away any slot the writer might have been overwriting
+		/// while it was being copied. That way the writer never has to wait for a reader.
+		class TraceRing
+		{
+		public:
+			/// @brief Constructor for a TraceRing
+			/// @param[in] index The thread index to put in the trace file for this ring
+			explicit TraceRing(std::uint32_t index) :
+			  clearedCount(0),
+			  threadIndex(index),
+			  inUse(true)
+			{
+				startedCount.store(0, std::memory_order_relaxed);
+				writtenCount.store(0, std::memory_order_relaxed);
+			}
+
+			/// @brief Adds a record, overwriting the oldest one if the ring is full. Only called by the owning thread.
+			/// @param[in] record The record to add
+			void add(const CANStackTrace::Record &record)
+			{
+				const std::uint64_t index = writtenCount.load(std::memory_order_relaxed);
+
+				startedCount.store(index + 1, std::memory_order_relaxed);
+				std::atomic_thread_fence(std::memory_order_release);
+				records[index & (CANStackTrace::RECORDS_PER_THREAD - 1)] = record;
+				writtenCount.store(index + 1, std::memory_order_release);
+			}
+
+			/// @brief Copies the records that haven't been cleared, oldest first. Called with the ring list locked.
+			/// @param[out] copiedRecords The list to append the records to
+			/// @returns The number of records that were overwritten before they could be copied
+			std::uint64_t copy(std::vector<CANStackTrace::Record> &copiedRecords) const
+			{
+				const std::uint64_t endIndex = writtenCount.load(std::memory_order_acquire);
+				std::uint64_t startIndex = std::max(clearedCount, (endIndex > CANStackTrace::RECORDS_PER_THREAD) ? (endIndex - CANStackTrace::RECORDS_PER_THREAD) : 0);
+				const std::size_t firstCopiedRecord = copiedRecords.size();
+				std::uint64_t overwrittenIndex;
+
+				for (std::uint64_t i = startIndex; i < endIndex; i++)
+				{
+					copiedRecords.push_back(records[i & (CANStackTrace::RECORDS_PER_THREAD - 1)]);
+				}
+				std::atomic_thread_fence(std::memory_order_acquire);
+
+				// Anything the writer started on while we were copying may have replaced a slot we copied
+				overwrittenIndex = startedCount.load(std::memory_order_relaxed);
+				if (overwrittenIndex > CANStackTrace::RECORDS_PER_THREAD)
+				{
+					overwrittenIndex -= CANStackTrace::RECORDS_PER_THREAD;
+
+					if (overwrittenIndex > startIndex)
+					{
+						const std::uint64_t numberOfStaleRecords = std::min(overwrittenIndex, endIndex) - startIndex;
+
+						copiedRecords.erase(copiedRecords.begin() + firstCopiedRecord, copiedRecords.begin() + firstCopiedRecord + static_cast<std::ptrdiff_t>(numberOfStaleRecords));
+						startIndex += numberOfStaleRecords;
+					}
+				}
+				return (startIndex - clearedCount);
+			}
+
+			/// @brief Throws away the records written so far. Called with the ring list locked.
+			void clear()
+			{
+				clearedCount = writtenCount.load(std::memory_order_acquire);
+			}
+
+			/// @brief Returns the index of the ring, to tell the threads apart in a trace file
+			/// @returns The thread index of the ring
+			std::uint32_t get_thread_index() const
+			{
+				return threadIndex;
+			}
+
+			/// @brief Returns if a thread owns the ring. Called with the ring list locked.
+			/// @returns `true` if a thread owns the ring, otherwise `false`
+			bool get_in_use() const
+			{
+				return inUse;
+			}
+
+			/// @brief Sets if a thread owns the ring. Called with the ring list locked.
+			/// @param[in] value `true` if a thread is taking the ring, `false` if its thread exited
+			void set_in_use(bool value)
+			{
+				inUse = value;
+			}
+
+		private:
+			std::array<CANStackTrace::Record, CANStackTrace::RECORDS_PER_THREAD> records; ///< The records, indexed by their count modulo the ring size
+			std::atomic<std::uint64_t> startedCount; ///< The number of records the writer has started writing
+			std::atomic<std::uint64_t> writtenCount; ///< The number of records the writer has finished writing
+			std::uint64_t clearedCount; ///< The record count at the last clear, so older records aren't read
+			const std::uint32_t threadIndex; ///< The index of the ring in the trace file
+			bool inUse; ///< Stores if a thread currently owns the ring
+		};
+
+		/// @brief The rings of every thread that has recorded something
+		class TraceRingList
+		{
+		public:
+			/// @brief Returns the one list of rings
+			/// @returns The list of rings
+			static TraceRingList &get_instance()
+			{
+				// A function local static avoids depending on the order that static objects are constructed in
+				static TraceRingList instance;
+				return instance;
+			}
+
+			/// @brief Gives a ring to a thread, reusing one from a thread that exited if there is one
+			/// @returns The ring the thread should write into
+			TraceRing *acquire()
+			{
+				const std::lock_guard<std::mutex> lock(ringsMutex);
+				TraceRing *retVal = nullptr;
+
+				for (auto &ring : rings)
+				{
+					if ((nullptr == retVal) && (!ring->get_in_use()))
+					{
+						ring->set_in_use(true);
+						retVal = ring.get();
+					}
+				}
+
+				if (nullptr == retVal)
+				{
+					rings.emplace_back(new TraceRing(static_cast<std::uint32_t>(rings.size())));
+					retVal = rings.back().get();
+				}
+				return retVal;
+			}
+
+			/// @brief Marks a ring as free to be used by another thread. Its records are kept.
+			/// @param[in] ring The ring to release
+			void release(TraceRing *ring)
+			{
+				const std::lock_guard<std::mutex> lock(ringsMutex);
+				ring->set_in_use(false);
+			}
+
+			std::mutex ringsMutex; ///< Protects the list of rings, and the reader side of each ring
+			std::vector<std::unique_ptr<TraceRing>> rings; ///< Every ring that has been created
+		};
+
+		/// @brief Holds the calling thread's ring, and gives it back when the thread exits
+		class ThreadTraceRing
+		{
+		public:
+			/// @brief Constructor for a ThreadTraceRing, which gets a ring on first use
+			ThreadTraceRing() :
+			  ring(TraceRingList::get_instance().acquire())
+			{
+			}
+
+			/// @brief Destructor for a ThreadTraceRing, which releases the ring
+			~ThreadTraceRing()
+			{
+				TraceRingList::get_instance().release(ring);
+			}
+
+			TraceRing *const ring; ///< The ring owned by this thread
+		};
+
+		/// @brief Packs four data bytes into a little endian argument
+		/// @param[in] data A pointer to the first of the four bytes
+		/// @returns The packed bytes
+		std::uint32_t pack_data(const std::uint8_t *data)
+		{
+			return (static_cast<std::uint32_t>(data[0]) |
+			        (static_cast<std::uint32_t>(data[1]) << 8) |
+			        (static_cast<std::uint32_t>(data[2]) << 16) |
+			        (static_cast<std::uint32_t>(data[3]) << 24));
+		}
+	}
+
+	constexpr std::uint32_t CANStackTrace::RECORDS_PER_THREAD;
+	constexpr std::uint16_t CANStackTrace::FILE_VERSION;
+	constexpr std::uint32_t CANStackTrace::BYTE_ORDER_MARK;
+	constexpr char CANStackTrace::FILE_MAGIC[8];
+	constexpr std::uint64_t CANStackTrace::NO_TIMESTAMP;
+	std::atomic<bool> CANStackTrace::enabled(false);
+
+	void CANStackTrace::set_enabled(bool enable)
+	{
+		// Make sure the list outlives any thread's ring before the first record can be written
+		TraceRingList::get_instance();
+		enabled.store(enable, std::memory_order_relaxed);
+	}
+
+	std::uint64_t CANStackTrace::get_timestamp_us()
+	{
+		std::uint64_t retVal = NO_TIMESTAMP;
+
+		if (get_enabled())
+		{
+			retVal = SystemTiming::get_timestamp_us();
+		}
+		return retVal;
+	}
+
+	void CANStackTrace::record_frame(EventType type, const HardwareInterfaceCANFrame &frame)
+	{
+		if (get_enabled())
+		{
+			add_record(type,
+			           Component::NetworkManager,
+			           frame.channel,
+			           frame.identifier,
+			           pack_data(&frame.data[0]),
+			           pack_data(&frame.data[4]),
+			           frame.dataLength);
+		}
+	}
+
+	void CANStackTrace::record_callback_dispatch(CallbackType type, const CANMessage &message, std::uint64_t dispatchTimestamp_us)
+	{
+		if ((get_enabled()) && (NO_TIMESTAMP != dispatchTimestamp_us))
+		{
+			const std::uint64_t duration_us = SystemTiming::get_time_elapsed_us(dispatchTimestamp_us);
+
+			add_record(EventType::CallbackDispatched,
+			           Component::NetworkManager,
+			           message.get_can_port_index(),
+			           message.get_identifier().get_parameter_group_number(),
+			           static_cast<std::uint32_t>(std::min<std::uint64_t>(duration_us, std::numeric_limits<std::uint32_t>::max())),
+			           message.get_data_length(),
+			           static_cast<std::uint8_t>(type));
+		}
+	}
+
+	void CANStackTrace::get_records(std::vector<Record> &records)
+	{
+		TraceRingList &ringList = TraceRingList::get_instance();
+		const std::lock_guard<std::mutex> lock(ringList.ringsMutex);
+
+		records.clear();
+		for (auto &ring : ringList.rings)
+		{
+			ring->copy(records);
+		}
+		std::stable_sort(records.begin(), records.end(), [](const Record &first, const Record &second) { return first.timestamp_us < second.timestamp_us; });
+	}
+
+	bool CANStackTrace::write(std::ostream &output)
+	{
+		TraceRingList &ringList = TraceRingList::get_instance();
+		const std::lock_guard<std::mutex> lock(ringList.ringsMutex);
+		std::vector<Record> ringRecords;
+		FileHeader fileHeader;
+
+		std::copy(FILE_MAGIC, FILE_MAGIC + sizeof(FILE_MAGIC), fileHeader.magic);
+		fileHeader.version = FILE_VERSION;
+		fileHeader.recordSize = static_cast<std::uint16_t>(sizeof(Record));
+		fileHeader.byteOrderMark = BYTE_ORDER_MARK;
+		output.write(reinterpret_cast<const char *>(&fileHeader), sizeof(fileHeader));
+
+		for (auto &ring : ringList.rings)
+		{
+			BlockHeader blockHeader;
+
+			ringRecords.clear();
+			blockHeader.numberOfLostRecords = ring->copy(ringRecords);
+			blockHeader.threadIndex = ring->get_thread_index();
+			blockHeader.numberOfRecords = static_cast<std::uint32_t>(ringRecords.size());
+			output.write(reinterpret_cast<const char *>(&blockHeader), sizeof(blockHeader));
+
+			if (!ringRecords.empty())
+			{
+				output.write(reinterpret_cast<const char *>(ringRecords.data()), static_cast<std::streamsize>(ringRecords.size() * sizeof(Record)));
+			}
+		}
+		return output.good();
+	}
+
+	bool CANStackTrace::write_file(const std::string &fileName)
+	{
+		std::ofstream traceFile(fileName, std::ios::out | std::ios::binary | std::ios::trunc);
+		bool retVal = false;
+
+		if (traceFile.is_open())
+		{
+			retVal = write(traceFile);
+		}
+		return retVal;
+	}
+
+	void CANStackTrace::clear()
+	{
+		TraceRingList &ringList = TraceRingList::get_instance();
+		const std::lock_guard<std::mutex> lock(ringList.ringsMutex);
+
+		for (auto &ring : ringList.rings)
+		{
+			ring->clear();
+		}
+	}
+
+	void CANStackTrace::add_record(EventType type,
+	                               Component component,
+	                               std::uint8_t channel,
+	                               std::uint32_t identifier,
+	                               std::uint32_t argument0,
+	                               std::uint32_t argument1,
+	                               std::uint8_t detail)
+	{
+		static thread_local ThreadTraceRing threadRing;
+		Record record;
+
+		record.timestamp_us = SystemTiming::get_timestamp_us();
+		record.identifier = identifier;
+		record.argument0 = argument0;
+		record.argument1 = argument1;
+		record.eventType = static_cast<std::uint8_t>(type);
+		record.component = static_cast<std::uint8_t>(component);
+		record.channel = channel;
+		record.detail = detail;
+		threadRing.ring->add(record);
+	}
+} // namespace isobus
@@ -11,23 +11,23 @@
 #include "isobus/isobus/can_transport_protocol.hpp"
 
 #include "isobus/isobus/can_general_parameter_group_numbers.hpp"
+#include "isobus/isobus/can_latency_profiler.hpp"
 #include "isobus/isobus/can_network_configuration.hpp"
+#include "isobus/isobus/can_stack_trace.hpp"
 #include "isobus/isobus/can_warning_logger.hpp"
 #include "isobus/utility/system_timing.hpp"
-#include "isobus/utility/to_string.hpp"
 
 #include <algorithm>
 
 namespace isobus
 {
-	TransportProtocolManager TransportProtocolManager::Protocol;
-
 	TransportProtocolManager::TransportProtocolSession::TransportProtocolSession(Direction sessionDirection, std::uint8_t canPortIndex) :
 	  state(StateMachineState::None),
 	  sessionMessage(canPortIndex),
 	  sessionCompleteCallback(nullptr),
 	  frameChunkCallback(nullptr),
 	  timestamp_ms(0),
+	  sessionStartTimestamp_ms(SystemTiming::get_timestamp_ms()),
 	  lastPacketNumber(0),
 	  packetCount(0),
 	  processedPacketsThisSession(0),
@@ -47,16 +47,26 @@ namespace isobus
 	{
 	}
 
-	TransportProtocolManager::TransportProtocolManager()
+	TransportProtocolManager::TransportProtocolManager(CANNetworkManager &parentNetworkManager) :
+	  CANLibProtocol(parentNetworkManager)
+	{
+	}
+
+	const ProtocolStatistics &TransportProtocolManager::get_statistics()
 	{
+		return Protocol.statistics;
 	}
 
 	TransportProtocolManager::~TransportProtocolManager()
 	{
 		if (initialized)
 		{
-			CANNetworkManager::CANNetwork.remove_protocol_parameter_group_number_callback(static_cast<std::uint32_t>(CANLibParameterGroupNumber::TransportProtocolCommand), process_message, this);
-			CANNetworkManager::CANNetwork.remove_protocol_parameter_group_number_callback(static_cast<std::uint32_t>(CANLibParameterGroupNumber::TransportProtocolData), process_message, this);
+			networkManager.remove_protocol_parameter_group_number_callback(static_cast<std::uint32_t>(CANLibParameterGroupNumber::TransportProtocolCommand), process_message, this);
+			networkManager.remove_protocol_parameter_group_number_callback(static_cast<std::uint32_t>(CANLibParameterGroupNumber::TransportProtocolData), process_message, this);
+		}
+		for (auto session : activeSessions)
+		{
+			delete session;
 		}
 	}
 
@@ -65,8 +75,8 @@ namespace isobus
 		if (!initialized)
 		{
 			initialized = true;
-			CANNetworkManager::CANNetwork.add_protocol_parameter_group_number_callback(static_cast<std::uint32_t>(CANLibParameterGroupNumber::TransportProtocolCommand), process_message, this);
-			CANNetworkManager::CANNetwork.add_protocol_parameter_group_number_callback(static_cast<std::uint32_t>(CANLibParameterGroupNumber::TransportProtocolData), process_message, this);
+			networkManager.add_protocol_parameter_group_number_callback(static_cast<std::uint32_t>(CANLibParameterGroupNumber::TransportProtocolCommand), process_message, this);
+			networkManager.add_protocol_parameter_group_number_callback(static_cast<std::uint32_t>(CANLibParameterGroupNumber::TransportProtocolData), process_message, this);
 		}
 	}
 
@@ -99,21 +109,23 @@ namespace isobus
 									newSession->sessionMessage.set_destination_control_function(nullptr);
 									newSession->packetCount = data[3];
 									newSession->sessionMessage.set_identifier(tempIdentifierData);
+									newSession->sessionMessage.set_timestamp_us(message->get_timestamp_us());
 									newSession->state = StateMachineState::RxDataSession;
 									newSession->timestamp_ms = SystemTiming::get_timestamp_ms();
 									activeSessions.push_back(newSession);
-									CANStackLogger::CAN_stack_log("[TP]: New BAM Session. Source: " + isobus::to_string(static_cast<int>(newSession->sessionMessage.get_source_control_function()->get_address())));
+									statistics.record_session_started(ProtocolStatistics::Direction::Receive);
+									CANStackLogger::debug("[TP]: New BAM Session. Source: ", static_cast<int>(newSession->sessionMessage.get_source_control_function()->get_address()));
 								}
 								else
 								{
 									// Don't send an abort, they're probably expecting a CTS so it'll timeout
 									// Or maybe if we already had a session they sent a second BAM? Also bad
-									CANStackLogger::CAN_stack_log("[TP]: Can't Create BAM session");
+									CANStackLogger::warn("[TP]: Can't Create BAM session");
 								}
 							}
 							else
 							{
-								CANStackLogger::CAN_stack_log("[TP]: Bad BAM Message Length");
+								CANStackLogger::warn("[TP]: Bad BAM Message Length");
 							}
 						}
 						break;
@@ -138,29 +150,31 @@ namespace isobus
 									newSession->packetCount = data[3];
 									newSession->clearToSendPacketMax = data[4];
 									newSession->sessionMessage.set_identifier(tempIdentifierData);
+									newSession->sessionMessage.set_timestamp_us(message->get_timestamp_us());
 									newSession->state = StateMachineState::ClearToSend;
 									newSession->timestamp_ms = SystemTiming::get_timestamp_ms();
 									activeSessions.push_back(newSession);
+									statistics.record_session_started(ProtocolStatistics::Direction::Receive);
 								}
 								else if ((get_session(session, message->get_source_control_function(), message->get_destination_control_function(), pgn)) &&
 								         (nullptr != message->get_destination_control_function()) &&
 								         (ControlFunction::Type::Internal == message->get_destination_control_function()->get_type()))
 								{
 									abort_session(pgn, ConnectionAbortReason::AlreadyInCMSession, reinterpret_cast<InternalControlFunction *>(message->get_destination_control_function()), message->get_source_control_function());
-									CANStackLogger::CAN_stack_log("[TP]: Abort RTS when already in CM session");
+									CANStackLogger::warn("[TP]: Abort RTS when already in CM session");
 								}
 								else if ((activeSessions.size() >= CANNetworkConfiguration::get_max_number_transport_protcol_sessions()) &&
 								         (nullptr != message->get_destination_control_function()) &&
 								         (ControlFunction::Type::Internal == message->get_destination_control_function()->get_type()))
 								{
 									abort_session(pgn, ConnectionAbortReason::SystemResourcesNeeded, reinterpret_cast<InternalControlFunction *>(message->get_destination_control_function()), message->get_source_control_function());
-									CANStackLogger::CAN_stack_log("[TP]: Abort No Sessions Available");
+									CANStackLogger::warn("[TP]: Abort No Sessions Available");
 								}
 							}
 							else
 							{
 								// Bad RTS message length. Can't really abort? Not sure what the PGN is if length < 8
-								CANStackLogger::CAN_stack_log("[TP]: Bad Message Length");
+								CANStackLogger::warn("[TP]: Bad Message Length");
 							}
 						}
 						break;
@@ -181,12 +195,21 @@ namespace isobus
 								{
 									if (StateMachineState::WaitForClearToSend == session->state)
 									{
+										const std::uint8_t nextPacketNumber = data[2];
+
 										session->packetCount = packetsToBeSent;
 										session->timestamp_ms = SystemTiming::get_timestamp_ms();
 										// If 0 was sent as the packet number, they want us to wait.
 										// Just sit here in this state until we get a non-zero packet count
 										if (0 != packetsToBeSent)
 										{
+											// The receiver tells us where to continue from, which lets it ask for packets it missed to be sent again
+											if ((0 != nextPacketNumber) &&
+											    (nextPacketNumber <= session->processedPacketsThisSession))
+											{
+												statistics.record_retransmit_request(session->processedPacketsThisSession - nextPacketNumber + 1);
+												session->processedPacketsThisSession = (nextPacketNumber - 1);
+											}
 											session->lastPacketNumber = 0;
 											session->state = StateMachineState::TxDataSession;
 										}
@@ -196,7 +219,7 @@ namespace isobus
 										// The session exists, but we're probably already in the TxDataSession state. Need to abort
 										// In the case of Rx'ing a CTS, we're the source in the session
 										abort_session(pgn, ConnectionAbortReason::ClearToSendReceivedWhileTransferInProgress, reinterpret_cast<InternalControlFunction *>(message->get_destination_control_function()), message->get_source_control_function());
-										CANStackLogger::CAN_stack_log("[TP]: Abort CTS while in data session");
+										CANStackLogger::warn("[TP]: Abort CTS while in data session");
 									}
 								}
 								else
@@ -204,12 +227,12 @@ namespace isobus
 									// We got a CTS but no session exists. Aborting clears up the situation faster than waiting for them to timeout
 									// In the case of Rx'ing a CTS, we're the source in the session
 									abort_session(pgn, ConnectionAbortReason::AnyOtherError, reinterpret_cast<InternalControlFunction *>(message->get_destination_control_function()), message->get_source_control_function());
-									CANStackLogger::CAN_stack_log("[TP]: Abort CTS With no matching session");
+									CANStackLogger::warn("[TP]: Abort CTS With no matching session");
 								}
 							}
 							else
 							{
-								CANStackLogger::CAN_stack_log("[TP]: Invalid CTS");
+								CANStackLogger::warn("[TP]: Invalid CTS");
 							}
 						}
 						break;
@@ -231,6 +254,7 @@ namespace isobus
 									{
 										// We completed our Tx session!
 										session->state = StateMachineState::None;
+										record_session_completed(session);
 										process_session_complete_callback(session, true);
 										close_session(session);
 									}
@@ -239,31 +263,59 @@ namespace isobus
 										abort_session(pgn, ConnectionAbortReason::AnyOtherError, reinterpret_cast<InternalControlFunction *>(message->get_destination_control_function()), message->get_source_control_function());
 										process_session_complete_callback(session, false);
 										close_session(session);
-										CANStackLogger::CAN_stack_log("[TP]: Abort EOM in wrong session state");
+										CANStackLogger::warn("[TP]: Abort EOM in wrong session state");
 									}
 								}
 								else
 								{
 									abort_session(pgn, ConnectionAbortReason::AnyOtherError, reinterpret_cast<InternalControlFunction *>(message->get_destination_control_function()), message->get_source_control_function());
-									CANStackLogger::CAN_stack_log("[TP]: Abort EOM without matching session");
+									CANStackLogger::warn("[TP]: Abort EOM without matching session");
 								}
 							}
 							else
 							{
-								CANStackLogger::CAN_stack_log("[TP]: Bad EOM received");
+								CANStackLogger::warn("[TP]: Bad EOM received");
 							}
 						}
 						break;
 
 						case CONNECTION_ABORT_MULTIPLEXOR:
 						{
-							CANStackLogger::CAN_stack_log("[TP]: Received an abort");
+							if (CAN_DATA_LENGTH == message->get_data_length())
+							{
+								auto &data = message->get_data();
+								const std::uint32_t pgn = (static_cast<std::uint32_t>(data[5]) | (static_cast<std::uint32_t>(data[6]) << 8) | (static_cast<std::uint32_t>(data[7]) << 16));
+								TransportProtocolSession *session;
+
+								statistics.record_abort_received(data[1]);
+								CANStackTrace::record_event(CANStackTrace::EventType::AbortReceived,
+								                            CANStackTrace::Component::TransportProtocol,
+								                            message->get_can_port_index(),
+								                            pgn,
+								                            0,
+								                            0,
+								                            data[1]);
+
+								if (get_session(session, message->get_destination_control_function(), message->get_source_control_function(), pgn))
+								{
+									CANStackLogger::warn("[TP]: Received an abort for a session with PGN: ", pgn);
+									close_session(session);
+								}
+								else
+								{
+									CANStackLogger::warn("[TP]: Received an abort with no matching session with PGN: ", pgn);
+								}
+							}
+							else
+							{
+								CANStackLogger::warn("[TP]: Received a malformed abort");
+							}
 						}
 						break;
 
 						default:
 						{
-							CANStackLogger::CAN_stack_log("[TP]: Bad Mux in Transport Protocol Command");
+							CANStackLogger::warn("[TP]: Bad Mux in Transport Protocol Command");
 						}
 						break;
 					}
@@ -281,13 +333,14 @@ namespace isobus
 						// Check for valid sequence number
 						if (message->get_data()[SEQUENCE_NUMBER_DATA_INDEX] == (tempSession->lastPacketNumber + 1))
 						{
-							for (std::uint8_t i = SEQUENCE_NUMBER_DATA_INDEX; i < CAN_DATA_LENGTH; i++)
+							for (std::uint8_t i = 0; i < PROTOCOL_BYTES_PER_FRAME; i++)
 							{
-								std::uint16_t currentDataIndex = (CAN_DATA_LENGTH * tempSession->lastPacketNumber) + i;
-								tempSession->sessionMessage.set_data(message->get_data()[SEQUENCE_NUMBER_DATA_INDEX + i], currentDataIndex);
+								std::uint32_t currentDataIndex = (PROTOCOL_BYTES_PER_FRAME * tempSession->lastPacketNumber) + i;
+								tempSession->sessionMessage.set_data(message->get_data()[SEQUENCE_NUMBER_DATA_INDEX + 1 + i], currentDataIndex);
 							}
 							tempSession->lastPacketNumber++;
 							tempSession->processedPacketsThisSession++;
+							tempSession->timestamp_ms = SystemTiming::get_timestamp_ms();
 							if ((tempSession->lastPacketNumber * PROTOCOL_BYTES_PER_FRAME) >= tempSession->sessionMessage.get_data_length())
 							{
 								// Send EOM Ack for CM sessions only
@@ -295,28 +348,31 @@ namespace isobus
 								{
 									send_end_of_session_acknowledgement(tempSession);
 								}
-								CANNetworkManager::CANNetwork.protocol_message_callback(&tempSession->sessionMessage);
+								record_session_completed(tempSession);
+								// Reassembly is timed from the session's first frame, and callbacks from its last
+								CANLatencyProfiler::record_message_latency(CANLatencyProfiler::Stage::Reassembly, tempSession->sessionMessage);
+								tempSession->sessionMessage.set_timestamp_us(message->get_timestamp_us());
+								networkManager.protocol_message_callback(&tempSession->sessionMessage);
 								close_session(tempSession);
 							}
-							tempSession->timestamp_ms = SystemTiming::get_timestamp_ms();
 						}
 						else if (message->get_data()[SEQUENCE_NUMBER_DATA_INDEX] == (tempSession->lastPacketNumber))
 						{
 							// Sequence number is duplicate of the last one
-							CANStackLogger::CAN_stack_log("[TP]: Aborting session due to duplciate sequence number");
+							CANStackLogger::warn("[TP]: Aborting session due to duplciate sequence number");
 							abort_session(tempSession, ConnectionAbortReason::DuplicateSequenceNumber);
 							close_session(tempSession);
 						}
 						else
 						{
-							CANStackLogger::CAN_stack_log("[TP]: Aborting session due to bad sequence number");
+							CANStackLogger::warn("[TP]: Aborting session due to bad sequence number");
 							abort_session(tempSession, ConnectionAbortReason::BadSequenceNumber);
 							close_session(tempSession);
 						}
 					}
 					else
 					{
-						CANStackLogger::CAN_stack_log("[TP]: Invalid BAM TP Data Received");
+						CANStackLogger::warn("[TP]: Invalid BAM TP Data Received");
 						if (get_session(tempSession, message->get_source_control_function(), message->get_destination_control_function()))
 						{
 							// If a session matches and ther was an error, get rid of the session
@@ -330,7 +386,7 @@ namespace isobus
 				{
 					// This is not a runtime error, should never happen.
 					// Bad PGN passed to protocol. Check PGN registrations.
-					CANStackLogger::CAN_stack_log("[TP]: Received an unexpected PGN");
+					CANStackLogger::warn("[TP]: Received an unexpected PGN");
 				}
 				break;
 			}
@@ -354,60 +410,54 @@ namespace isobus
 	                                                         void *parentPointer,
 	                                                         DataChunkCallback frameChunkCallback)
 	{
-		TransportProtocolSession *session;
 		bool retVal = false;
 
-		if ((messageLength <= MAX_PROTOCOL_DATA_LENGTH) &&
-		    (messageLength > CAN_DATA_LENGTH) &&
-		    ((nullptr != dataBuffer) ||
-		     (nullptr != frameChunkCallback)) &&
-		    (nullptr != source) &&
-		    (true == source->get_address_valid()) &&
-		    ((nullptr == destination) ||
-		     (destination->get_address_valid())) &&
-		    (!get_session(session, source, destination, parameterGroupNumber)))
+		if ((nullptr != dataBuffer) ||
+		    (nullptr != frameChunkCallback))
 		{
-			TransportProtocolSession *newSession = new TransportProtocolSession(TransportProtocolSession::Direction::Transmit,
-			                                                                    source->get_can_port());
-			std::uint8_t destinationAddress;
-
-			newSession->sessionMessage.set_data(dataBuffer, messageLength);
-			newSession->sessionMessage.set_source_control_function(source);
-			newSession->sessionMessage.set_destination_control_function(destination);
-			newSession->packetCount = (messageLength / PROTOCOL_BYTES_PER_FRAME);
-			newSession->lastPacketNumber = 0;
-			newSession->processedPacketsThisSession = 0;
-			newSession->sessionCompleteCallback = sessionCompleteCallback;
-			newSession->frameChunkCallback = frameChunkCallback;
-			newSession->parent = parentPointer;
-			if (0 != (messageLength % PROTOCOL_BYTES_PER_FRAME))
+			TransportProtocolSession *newSession = create_transmit_session(parameterGroupNumber,
+			                                                               messageLength,
+			                                                               source,
+			                                                               destination,
+			                                                               sessionCompleteCallback,
+			                                                               parentPointer,
+			                                                               frameChunkCallback);
+
+			if (nullptr != newSession)
 			{
-				newSession->packetCount++;
+				newSession->sessionMessage.set_data(dataBuffer, messageLength);
+				activeSessions.push_back(newSession);
+				retVal = true;
 			}
+		}
+		return retVal;
+	}
 
-			if (nullptr != destination)
-			{
-				// CM Message
-				destinationAddress = destination->get_address();
-				set_state(newSession, StateMachineState::RequestToSend);
-			}
-			else
+	bool TransportProtocolManager::protocol_transmit_shared_message(std::uint32_t parameterGroupNumber,
+	                                                                std::shared_ptr<const std::vector<std::uint8_t>> data,
+	                                                                ControlFunction *source,
+	                                                                ControlFunction *destination,
+	                                                                TransmitCompleteCallback sessionCompleteCallback,
+	                                                                void *parentPointer)
+	{
+		bool retVal = false;
+
+		if (nullptr != data)
+		{
+			TransportProtocolSession *newSession = create_transmit_session(parameterGroupNumber,
+			                                                               data->size(),
+			                                                               source,
+			                                                               destination,
+			                                                               sessionCompleteCallback,
+			                                                               parentPointer,
+			                                                               nullptr);
+
+			if (nullptr != newSession)
 			{
-				// BAM message
-				destinationAddress = BROADCAST_CAN_ADDRESS;
-				set_state(newSession, StateMachineState::BroadcastAnnounce);
+				newSession->sessionMessage.set_shared_data(data);
+				activeSessions.push_back(newSession);
+				retVal = true;
 			}
-
-			CANIdentifier messageVirtualID(CANIdentifier::Type::Extended,
-			                               parameterGroupNumber,
-			                               CANIdentifier::CANPriority::PriorityDefault6,
-			                               destinationAddress,
-			                               source->get_address());
-
-			newSession->sessionMessage.set_identifier(messageVirtualID);
-
-			activeSessions.push_back(newSession);
-			retVal = true;
 		}
 		return retVal;
 	}
@@ -433,12 +483,12 @@ namespace isobus
 
 			if (TransportProtocolSession::Direction::Transmit == session->sessionDirection)
 			{
-				myControlFunction = CANNetworkManager::CANNetwork.get_internal_control_function(session->sessionMessage.get_source_control_function());
+				myControlFunction = networkManager.get_internal_control_function(session->sessionMessage.get_source_control_function());
 				partnerControlFunction = session->sessionMessage.get_destination_control_function();
 			}
 			else
 			{
-				myControlFunction = CANNetworkManager::CANNetwork.get_internal_control_function(session->sessionMessage.get_destination_control_function());
+				myControlFunction = networkManager.get_internal_control_function(session->sessionMessage.get_destination_control_function());
 				partnerControlFunction = session->sessionMessage.get_source_control_function();
 			}
 
@@ -450,12 +500,24 @@ namespace isobus
 			data[5] = static_cast<std::uint8_t>(pgn & 0xFF);
 			data[6] = static_cast<std::uint8_t>((pgn >> 8) & 0xFF);
 			data[7] = static_cast<std::uint8_t>((pgn >> 16) & 0xFF);
-			retVal = CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::TransportProtocolCommand),
-			                                                        data.data(),
-			                                                        8,
-			                                                        myControlFunction,
-			                                                        partnerControlFunction,
-			                                                        CANIdentifier::CANPriority::PriorityDefault6);
+			retVal = networkManager.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::TransportProtocolCommand),
+			                                         data.data(),
+			                                         8,
+			                                         myControlFunction,
+			                                         partnerControlFunction,
+			                                         CANIdentifier::CANPriority::PriorityDefault6);
+
+			if (retVal)
+			{
+				statistics.record_abort_sent(data[1]);
+			}
+			CANStackTrace::record_event(CANStackTrace::EventType::AbortSent,
+			                            CANStackTrace::Component::TransportProtocol,
+			                            session->sessionMessage.get_can_port_index(),
+			                            pgn,
+			                            retVal ? 1 : 0,
+			                            0,
+			                            data[1]);
 		}
 		return retVal;
 	}
@@ -463,6 +525,7 @@ namespace isobus
 	bool TransportProtocolManager::abort_session(std::uint32_t parameterGroupNumber, ConnectionAbortReason reason, InternalControlFunction *source, ControlFunction *destination)
 	{
 		std::array<std::uint8_t, 8> data;
+		bool retVal;
 
 		data[0] = CONNECTION_ABORT_MULTIPLEXOR;
 		data[1] = static_cast<std::uint8_t>(reason);
@@ -472,12 +535,25 @@ namespace isobus
 		data[5] = static_cast<std::uint8_t>(parameterGroupNumber & 0xFF);
 		data[6] = static_cast<std::uint8_t>((parameterGroupNumber >> 8) & 0xFF);
 		data[7] = static_cast<std::uint8_t>((parameterGroupNumber >> 16) & 0xFF);
-		return CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::TransportProtocolCommand),
-		                                                      data.data(),
-		                                                      8,
-		                                                      source,
-		                                                      destination,
-		                                                      CANIdentifier::CANPriority::PriorityDefault6);
+		retVal = networkManager.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::TransportProtocolCommand),
+		                                         data.data(),
+		                                         8,
+		                                         source,
+		                                         destination,
+		                                         CANIdentifier::CANPriority::PriorityDefault6);
+
+		if (retVal)
+		{
+			statistics.record_abort_sent(data[1]);
+		}
+		CANStackTrace::record_event(CANStackTrace::EventType::AbortSent,
+		                            CANStackTrace::Component::TransportProtocol,
+		                            (nullptr != source) ? source->get_can_port() : 0,
+		                            parameterGroupNumber,
+		                            retVal ? 1 : 0,
+		                            0,
+		                            data[1]);
+		return retVal;
 	}
 
 	void TransportProtocolManager::close_session(TransportProtocolSession *session)
@@ -487,13 +563,94 @@ namespace isobus
 			auto sessionLocation = std::find(activeSessions.begin(), activeSessions.end(), session);
 			if (activeSessions.end() != sessionLocation)
 			{
+				// Let the sender know if their message is being dropped before it could be completed
+				process_session_complete_callback(session, false);
 				activeSessions.erase(sessionLocation);
+				statistics.record_session_closed(get_statistics_direction(session));
 				delete session;
-				CANStackLogger::CAN_stack_log("[TP]: Session Closed");
+				CANStackLogger::debug("[TP]: Session Closed");
 			}
 		}
 	}
 
+	ProtocolStatistics::Direction TransportProtocolManager::get_statistics_direction(const TransportProtocolSession *session)
+	{
+		ProtocolStatistics::Direction retVal = ProtocolStatistics::Direction::Receive;
+
+		if (TransportProtocolSession::Direction::Transmit == session->sessionDirection)
+		{
+			retVal = ProtocolStatistics::Direction::Transmit;
+		}
+		return retVal;
+	}
+
+	void TransportProtocolManager::record_session_completed(const TransportProtocolSession *session)
+	{
+		statistics.record_session_completed(get_statistics_direction(session),
+		                                    session->sessionMessage.get_data_length(),
+		                                    SystemTiming::get_time_elapsed_ms(session->sessionStartTimestamp_ms));
+	}
+
+	TransportProtocolManager::TransportProtocolSession *TransportProtocolManager::create_transmit_session(std::uint32_t parameterGroupNumber,
+	                                                                                                     std::uint32_t messageLength,
+	                                                                                                     ControlFunction *source,
+	                                                                                                     ControlFunction *destination,
+	                                                                                                     TransmitCompleteCallback sessionCompleteCallback,
+	                                                                                                     void *parentPointer,
+	                                                                                                     DataChunkCallback frameChunkCallback)
+	{
+		TransportProtocolSession *session;
+		TransportProtocolSession *retVal = nullptr;
+
+		if ((messageLength <= MAX_PROTOCOL_DATA_LENGTH) &&
+		    (messageLength > CAN_DATA_LENGTH) &&
+		    (nullptr != source) &&
+		    (true == source->get_address_valid()) &&
+		    ((nullptr == destination) ||
+		     (destination->get_address_valid())) &&
+		    (!get_session(session, source, destination, parameterGroupNumber)))
+		{
+			std::uint8_t destinationAddress;
+
+			retVal = new TransportProtocolSession(TransportProtocolSession::Direction::Transmit, source->get_can_port());
+			retVal->sessionMessage.set_source_control_function(source);
+			retVal->sessionMessage.set_destination_control_function(destination);
+			retVal->packetCount = (messageLength / PROTOCOL_BYTES_PER_FRAME);
+			retVal->lastPacketNumber = 0;
+			retVal->processedPacketsThisSession = 0;
+			retVal->sessionCompleteCallback = sessionCompleteCallback;
+			retVal->frameChunkCallback = frameChunkCallback;
+			retVal->parent = parentPointer;
+			if (0 != (messageLength % PROTOCOL_BYTES_PER_FRAME))
+			{
+				retVal->packetCount++;
+			}
+
+			if (nullptr != destination)
+			{
+				// CM Message
+				destinationAddress = destination->get_address();
+				set_state(retVal, StateMachineState::RequestToSend);
+			}
+			else
+			{
+				// BAM message
+				destinationAddress = BROADCAST_CAN_ADDRESS;
+				set_state(retVal, StateMachineState::BroadcastAnnounce);
+			}
+
+			CANIdentifier messageVirtualID(CANIdentifier::Type::Extended,
+			                               parameterGroupNumber,
+			                               CANIdentifier::CANPriority::PriorityDefault6,
+			                               destinationAddress,
+			                               source->get_address());
+
+			retVal->sessionMessage.set_identifier(messageVirtualID);
+			statistics.record_session_started(ProtocolStatistics::Direction::Transmit);
+		}
+		return retVal;
+	}
+
 	void TransportProtocolManager::process_session_complete_callback(TransportProtocolSession *session, bool success)
 	{
 		if ((nullptr != session) &&
@@ -507,6 +664,8 @@ namespace isobus
 			                                 session->sessionMessage.get_destination_control_function(),
 			                                 success,
 			                                 session->parent);
+			// Only report the result once
+			session->sessionCompleteCallback = nullptr;
 		}
 	}
 
@@ -524,12 +683,12 @@ namespace isobus
 				                                                 static_cast<std::uint8_t>(session->sessionMessage.get_identifier().get_parameter_group_number() & 0xFF),
 				                                                 static_cast<std::uint8_t>((session->sessionMessage.get_identifier().get_parameter_group_number() >> 8) & 0xFF),
 				                                                 static_cast<std::uint8_t>((session->sessionMessage.get_identifier().get_parameter_group_number() >> 16) & 0xFF) };
-			retVal = CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::TransportProtocolCommand),
-			                                                        dataBuffer,
-			                                                        CAN_DATA_LENGTH,
-			                                                        reinterpret_cast<InternalControlFunction *>(session->sessionMessage.get_source_control_function()),
-			                                                        nullptr,
-			                                                        CANIdentifier::CANPriority::PriorityDefault6);
+			retVal = networkManager.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::TransportProtocolCommand),
+			                                         dataBuffer,
+			                                         CAN_DATA_LENGTH,
+			                                         reinterpret_cast<InternalControlFunction *>(session->sessionMessage.get_source_control_function()),
+			                                         nullptr,
+			                                         CANIdentifier::CANPriority::PriorityDefault6);
 		}
 		return retVal;
 	}
@@ -560,12 +719,12 @@ namespace isobus
 				                                                 static_cast<std::uint8_t>(session->sessionMessage.get_identifier().get_parameter_group_number() & 0xFF),
 				                                                 static_cast<std::uint8_t>((session->sessionMessage.get_identifier().get_parameter_group_number() >> 8) & 0xFF),
 				                                                 static_cast<std::uint8_t>((session->sessionMessage.get_identifier().get_parameter_group_number() >> 16) & 0xFF) };
-			retVal = CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::TransportProtocolCommand),
-			                                                        dataBuffer,
-			                                                        CAN_DATA_LENGTH,
-			                                                        reinterpret_cast<InternalControlFunction *>(session->sessionMessage.get_destination_control_function()),
-			                                                        session->sessionMessage.get_source_control_function(),
-			                                                        CANIdentifier::CANPriority::PriorityDefault6);
+			retVal = networkManager.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::TransportProtocolCommand),
+			                                         dataBuffer,
+			                                         CAN_DATA_LENGTH,
+			                                         reinterpret_cast<InternalControlFunction *>(session->sessionMessage.get_destination_control_function()),
+			                                         session->sessionMessage.get_source_control_function(),
+			                                         CANIdentifier::CANPriority::PriorityDefault6);
 		}
 		return retVal;
 	}
@@ -584,12 +743,12 @@ namespace isobus
 				                                                 static_cast<std::uint8_t>(session->sessionMessage.get_identifier().get_parameter_group_number() & 0xFF),
 				                                                 static_cast<std::uint8_t>((session->sessionMessage.get_identifier().get_parameter_group_number() >> 8) & 0xFF),
 				                                                 static_cast<std::uint8_t>((session->sessionMessage.get_identifier().get_parameter_group_number() >> 16) & 0xFF) };
-			retVal = CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::TransportProtocolCommand),
-			                                                        dataBuffer,
-			                                                        CAN_DATA_LENGTH,
-			                                                        reinterpret_cast<InternalControlFunction *>(session->sessionMessage.get_source_control_function()),
-			                                                        session->sessionMessage.get_destination_control_function(),
-			                                                        CANIdentifier::CANPriority::PriorityDefault6);
+			retVal = networkManager.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::TransportProtocolCommand),
+			                                         dataBuffer,
+			                                         CAN_DATA_LENGTH,
+			                                         reinterpret_cast<InternalControlFunction *>(session->sessionMessage.get_source_control_function()),
+			                                         session->sessionMessage.get_destination_control_function(),
+			                                         CANIdentifier::CANPriority::PriorityDefault6);
 		}
 		return retVal;
 	}
@@ -616,17 +775,17 @@ namespace isobus
 			// This message only needs to be sent if we're the recipient. Sanity check the destination is us
 			if (ControlFunction::Type::Internal == session->sessionMessage.get_destination_control_function()->get_type())
 			{
-				retVal = CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::TransportProtocolCommand),
-				                                                        dataBuffer,
-				                                                        CAN_DATA_LENGTH,
-				                                                        reinterpret_cast<InternalControlFunction *>(session->sessionMessage.get_destination_control_function()),
-				                                                        session->sessionMessage.get_source_control_function(),
-				                                                        CANIdentifier::CANPriority::PriorityDefault6);
+				retVal = networkManager.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::TransportProtocolCommand),
+				                                         dataBuffer,
+				                                         CAN_DATA_LENGTH,
+				                                         reinterpret_cast<InternalControlFunction *>(session->sessionMessage.get_destination_control_function()),
+				                                         session->sessionMessage.get_source_control_function(),
+				                                         CANIdentifier::CANPriority::PriorityDefault6);
 			}
 		}
 		else
 		{
-			CANStackLogger::CAN_stack_log("[TP]: Attempted to send EOM to null session");
+			CANStackLogger::error("[TP]: Attempted to send EOM to null session");
 		}
 		return retVal;
 	}
@@ -637,6 +796,13 @@ namespace isobus
 		{
 			session->timestamp_ms = SystemTiming::get_timestamp_ms();
 			session->state = value;
+			CANStackTrace::record_event(CANStackTrace::EventType::SessionStateChanged,
+			                            CANStackTrace::Component::TransportProtocol,
+			                            session->sessionMessage.get_can_port_index(),
+			                            session->sessionMessage.get_identifier().get_parameter_group_number(),
+			                            session->sessionMessage.get_data_length(),
+			                            session->processedPacketsThisSession,
+			                            static_cast<std::uint8_t>(value));
 		}
 	}
 
@@ -694,7 +860,7 @@ namespace isobus
 				{
 					if (SystemTiming::time_expired_ms(session->timestamp_ms, T2_T3_TIMEOUT_MS))
 					{
-						CANStackLogger::CAN_stack_log("[TP]: Timeout");
+						CANStackLogger::warn("[TP]: Timeout");
 						abort_session(session, ConnectionAbortReason::Timeout);
 						process_session_complete_callback(session, false);
 						close_session(session);
@@ -774,7 +940,7 @@ namespace isobus
 									std::uint32_t index = (j + (PROTOCOL_BYTES_PER_FRAME * session->processedPacketsThisSession));
 									if (index < session->sessionMessage.get_data_length())
 									{
-										dataBuffer[1 + j] = session->sessionMessage.get_data()[j + (PROTOCOL_BYTES_PER_FRAME * session->processedPacketsThisSession)];
+										dataBuffer[1 + j] = session->sessionMessage.get_data_byte(index);
 									}
 									else
 									{
@@ -783,12 +949,12 @@ namespace isobus
 								}
 							}
 
-							if (CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::TransportProtocolData),
-							                                                   dataBuffer,
-							                                                   CAN_DATA_LENGTH,
-							                                                   reinterpret_cast<InternalControlFunction *>(session->sessionMessage.get_source_control_function()),
-							                                                   session->sessionMessage.get_destination_control_function(),
-							                                                   CANIdentifier::CANPriority::PriorityLowest7))
+							if (networkManager.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::TransportProtocolData),
+							                                    dataBuffer,
+							                                    CAN_DATA_LENGTH,
+							                                    reinterpret_cast<InternalControlFunction *>(session->sessionMessage.get_source_control_function()),
+							                                    session->sessionMessage.get_destination_control_function(),
+							                                    CANIdentifier::CANPriority::PriorityLowest7))
 							{
 								session->lastPacketNumber++;
 								session->processedPacketsThisSession++;
@@ -814,6 +980,8 @@ namespace isobus
 						if (nullptr == session->sessionMessage.get_destination_control_function())
 						{
 							// BAM is complete
+							record_session_completed(session);
+							process_session_complete_callback(session, true);
 							close_session(session);
 						}
 						else
@@ -837,7 +1005,7 @@ namespace isobus
 						// BAM Timeout check
 						if (SystemTiming::time_expired_ms(session->timestamp_ms, T1_TIMEOUT_MS))
 						{
-							CANStackLogger::CAN_stack_log("[TP]: BAM Rx Timeout");
+							CANStackLogger::warn("[TP]: BAM Rx Timeout");
 							close_session(session);
 						}
 					}
@@ -846,7 +1014,7 @@ namespace isobus
 						// CM TP Timeout check
 						if (SystemTiming::time_expired_ms(session->timestamp_ms, MESSAGE_TR_TIMEOUT_MS))
 						{
-							CANStackLogger::CAN_stack_log("[TP]: CM Rx Timeout");
+							CANStackLogger::warn("[TP]: CM Rx Timeout");
 							abort_session(session, ConnectionAbortReason::Timeout);
 							close_session(session);
 						}
@@ -9,11 +9,11 @@
 //================================================================================================
 #include "isobus/isobus/can_warning_logger.hpp"
 
-#include <iostream>
-
 namespace isobus
 {
-	CANStackLogger *CANStackLogger::logger = nullptr;
+	constexpr std::uint8_t CANStackLogger::COMPILED_MINIMUM_LOG_LEVEL;
+	std::atomic<CANStackLogger *> CANStackLogger::logger(nullptr);
+	std::atomic<std::uint8_t> CANStackLogger::logLevel(static_cast<std::uint8_t>(LoggingLevel::Info));
 
 	CANStackLogger::CANStackLogger()
 	{
@@ -25,17 +25,30 @@ namespace isobus
 
 	void CANStackLogger::CAN_stack_log(const std::string &warningText)
 	{
-		CANStackLogger *canStackLogger = nullptr;
-
-		if (get_can_stack_logger(canStackLogger))
+		if (get_log_level_enabled(LoggingLevel::Info))
 		{
-			canStackLogger->LogCANLibWarning(warningText);
+			log_text(LoggingLevel::Info, warningText);
 		}
 	}
 
+	void CANStackLogger::set_log_level(LoggingLevel level)
+	{
+		logLevel.store(static_cast<std::uint8_t>(level), std::memory_order_relaxed);
+	}
+
+	CANStackLogger::LoggingLevel CANStackLogger::get_log_level()
+	{
+		return static_cast<LoggingLevel>(logLevel.load(std::memory_order_relaxed));
+	}
+
 	void CANStackLogger::set_can_stack_logger_sink(CANStackLogger *logSink)
 	{
-		logger = logSink;
+		logger.store(logSink, std::memory_order_release);
+	}
+
+	void CANStackLogger::sink_CAN_stack_log(LoggingLevel, const std::string &text)
+	{
+		LogCANLibWarning(text);
 	}
 
 	void CANStackLogger::LogCANLibWarning(const std::string &)
@@ -43,9 +56,19 @@ namespace isobus
 		// Override this function to use the log sink
 	}
 
-	bool CANStackLogger::get_can_stack_logger(CANStackLogger *canStackLogger)
+	void CANStackLogger::log_text(LoggingLevel level, const std::string &text)
+	{
+		CANStackLogger *canStackLogger = nullptr;
+
+		if (get_can_stack_logger(canStackLogger))
+		{
+			canStackLogger->sink_CAN_stack_log(level, text);
+		}
+	}
+
+	bool CANStackLogger::get_can_stack_logger(CANStackLogger *&canStackLogger)
 	{
-		canStackLogger = logger;
+		canStackLogger = logger.load(std::memory_order_acquire);
 		return (nullptr != canStackLogger);
 	}
 } // namespace isobus
@@ -75,8 +75,12 @@ namespace isobus
 	}
 
 	DiagnosticProtocol::DiagnosticProtocol(std::shared_ptr<InternalControlFunction> internalControlFunction) :
+	  CANLibProtocol(internalControlFunction->get_network_manager()),
 	  myControlFunction(internalControlFunction),
+	  dm22ResponseQueueHead(0),
+	  dm22ResponseQueueSize(0),
 	  txFlags(static_cast<std::uint32_t>(TransmitFlags::NumberOfFlags), process_flags, this),
+	  identificationPayloadVersion(0),
 	  lastDM1SentTimestamp(0),
 	  stopBroadcastNetworkBitfield(0),
 	  lastDM13ReceivedTimestamp(0),
@@ -85,10 +89,12 @@ namespace isobus
 		diagnosticProtocolList.push_back(this);
 		ecuIdentificationFields.resize(static_cast<std::size_t>(ECUIdentificationFields::NumberOfFields));
 
-		for (auto ecuIDField : ecuIdentificationFields)
+		for (auto &ecuIDField : ecuIdentificationFields)
 		{
 			ecuIDField = "*";
 		}
+		encode_ecu_identification();
+		encode_product_identification();
 	}
 
 	DiagnosticProtocol::~DiagnosticProtocol()
@@ -99,7 +105,7 @@ namespace isobus
 		{
 			// If we're being destructed but have not been deassigned, that is not ideal.
 			// So, we'll log it here, and try to clean ourselves up.
-			CANStackLogger::CAN_stack_log("[DP]: DiagnosticProtocol instance is being destroyed without being deassigned first! It is suggested that you deassign the protocol before deleting this object!");
+			CANStackLogger::error("[DP]: DiagnosticProtocol instance is being destroyed without being deassigned first! It is suggested that you deassign the protocol before deleting this object!");
 			deregister_all_pgns();
 		}
 
@@ -111,15 +117,15 @@ namespace isobus
 		if (initialized)
 		{
 			initialized = false;
-			CANNetworkManager::CANNetwork.remove_protocol_parameter_group_number_callback(static_cast<std::uint32_t>(CANLibParameterGroupNumber::DiagnosticMessage22), process_message, this);
-			CANNetworkManager::CANNetwork.remove_protocol_parameter_group_number_callback(static_cast<std::uint32_t>(CANLibParameterGroupNumber::DiagnosticMessage13), process_message, this);
-			CANNetworkManager::CANNetwork.remove_global_parameter_group_number_callback(static_cast<std::uint32_t>(CANLibParameterGroupNumber::DiagnosticMessage13), process_message, this);
+			networkManager.remove_protocol_parameter_group_number_callback(static_cast<std::uint32_t>(CANLibParameterGroupNumber::DiagnosticMessage22), process_message, this);
+			networkManager.remove_protocol_parameter_group_number_callback(static_cast<std::uint32_t>(CANLibParameterGroupNumber::DiagnosticMessage13), process_message, this);
+			networkManager.remove_global_parameter_group_number_callback(static_cast<std::uint32_t>(CANLibParameterGroupNumber::DiagnosticMessage13), process_message, this);
 		}
 	}
 
 	bool DiagnosticProtocol::assign_diagnostic_protocol_to_internal_control_function(std::shared_ptr<InternalControlFunction> internalControlFunction)
 	{
-		bool retVal = true;
+		bool retVal = (nullptr != internalControlFunction);
 
 		for (auto protocolLocation : diagnosticProtocolList)
 		{
@@ -132,8 +138,8 @@ namespace isobus
 
 		if (retVal)
 		{
+			// The constructor adds the new instance to the list of protocols
 			DiagnosticProtocol *newProtocol = new DiagnosticProtocol(internalControlFunction);
-			diagnosticProtocolList.push_back(newProtocol);
 			// PGN protocol will check for duplicates, so no worries if there's already a request protocol registered.
 			ParameterGroupNumberRequestProtocol::assign_pgn_request_protocol_to_internal_control_function(internalControlFunction);
 			ParameterGroupNumberRequestProtocol::get_pgn_request_protocol_by_internal_control_function(internalControlFunction)->register_pgn_request_callback(static_cast<std::uint32_t>(CANLibParameterGroupNumber::DiagnosticMessage2), process_parameter_group_number_request, newProtocol);
@@ -143,6 +149,7 @@ namespace isobus
 			ParameterGroupNumberRequestProtocol::get_pgn_request_protocol_by_internal_control_function(internalControlFunction)->register_pgn_request_callback(static_cast<std::uint32_t>(CANLibParameterGroupNumber::DiagnosticProtocolIdentification), process_parameter_group_number_request, newProtocol);
 			ParameterGroupNumberRequestProtocol::get_pgn_request_protocol_by_internal_control_function(internalControlFunction)->register_pgn_request_callback(static_cast<std::uint32_t>(CANLibParameterGroupNumber::SoftwareIdentification), process_parameter_group_number_request, newProtocol);
 			ParameterGroupNumberRequestProtocol::get_pgn_request_protocol_by_internal_control_function(internalControlFunction)->register_pgn_request_callback(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUIdentificationInformation), process_parameter_group_number_request, newProtocol);
+			newProtocol->publish_identification_payloads();
 		}
 		return retVal;
 	}
@@ -251,9 +258,9 @@ namespace isobus
 		if (!initialized)
 		{
 			initialized = true;
-			CANNetworkManager::CANNetwork.add_protocol_parameter_group_number_callback(static_cast<std::uint32_t>(CANLibParameterGroupNumber::DiagnosticMessage22), process_message, this);
-			CANNetworkManager::CANNetwork.add_protocol_parameter_group_number_callback(static_cast<std::uint32_t>(CANLibParameterGroupNumber::DiagnosticMessage13), process_message, this);
-			CANNetworkManager::CANNetwork.add_global_parameter_group_number_callback(static_cast<std::uint32_t>(CANLibParameterGroupNumber::DiagnosticMessage13), process_message, this);
+			networkManager.add_protocol_parameter_group_number_callback(static_cast<std::uint32_t>(CANLibParameterGroupNumber::DiagnosticMessage22), process_message, this);
+			networkManager.add_protocol_parameter_group_number_callback(static_cast<std::uint32_t>(CANLibParameterGroupNumber::DiagnosticMessage13), process_message, this);
+			networkManager.add_global_parameter_group_number_callback(static_cast<std::uint32_t>(CANLibParameterGroupNumber::DiagnosticMessage13), process_message, this);
 		}
 	}
 
@@ -286,6 +293,7 @@ namespace isobus
 	void DiagnosticProtocol::clear_software_id_fields()
 	{
 		softwareIdentificationFields.clear();
+		encode_software_identification();
 	}
 
 	bool DiagnosticProtocol::get_are_broadcasts_stopped_for_channel(std::uint8_t canChannelIndex) const
@@ -301,9 +309,10 @@ namespace isobus
 
 	void DiagnosticProtocol::set_ecu_id_field(ECUIdentificationFields field, std::string value)
 	{
-		if (field <= ECUIdentificationFields::NumberOfFields)
+		if (field < ECUIdentificationFields::NumberOfFields)
 		{
 			ecuIdentificationFields[static_cast<std::size_t>(field)] = value + "*";
+			encode_ecu_identification();
 		}
 	}
 
@@ -389,6 +398,7 @@ namespace isobus
 		if (value.size() < PRODUCT_IDENTIFICATION_MAX_STRING_LENGTH)
 		{
 			productIdentificationCode = value;
+			encode_product_identification();
 			retVal = true;
 		}
 		return retVal;
@@ -401,6 +411,7 @@ namespace isobus
 		if (value.size() < PRODUCT_IDENTIFICATION_MAX_STRING_LENGTH)
 		{
 			productIdentificationBrand = value;
+			encode_product_identification();
 			retVal = true;
 		}
 		return retVal;
@@ -413,6 +424,7 @@ namespace isobus
 		if (value.size() < PRODUCT_IDENTIFICATION_MAX_STRING_LENGTH)
 		{
 			productIdentificationModel = value;
+			encode_product_identification();
 			retVal = true;
 		}
 		return retVal;
@@ -432,6 +444,7 @@ namespace isobus
 			}
 		}
 		softwareIdentificationFields[index] = value;
+		encode_software_identification();
 	}
 
 	bool DiagnosticProtocol::suspend_broadcasts(std::uint8_t canChannelIndex, InternalControlFunction *sourceControlFunction, std::uint16_t suspendTime_seconds)
@@ -515,6 +528,8 @@ namespace isobus
 			pgnRequestProtocol->remove_pgn_request_callback(static_cast<std::uint32_t>(CANLibParameterGroupNumber::DiagnosticProtocolIdentification), process_parameter_group_number_request, this);
 			pgnRequestProtocol->remove_pgn_request_callback(static_cast<std::uint32_t>(CANLibParameterGroupNumber::SoftwareIdentification), process_parameter_group_number_request, this);
 			pgnRequestProtocol->remove_pgn_request_callback(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUIdentificationInformation), process_parameter_group_number_request, this);
+			pgnRequestProtocol->remove_cached_response(static_cast<std::uint32_t>(CANLibParameterGroupNumber::SoftwareIdentification));
+			pgnRequestProtocol->remove_cached_response(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUIdentificationInformation));
 
 			// Check if that was the last callback being handled and clean up if needed
 			if ((0 == pgnRequestProtocol->get_number_registered_pgn_request_callbacks()) && (0 == pgnRequestProtocol->get_number_registered_request_for_repetition_rate_callbacks()))
@@ -746,90 +761,79 @@ namespace isobus
 		return false;
 	}
 
-	bool DiagnosticProtocol::send_diagnostic_message_1()
+	bool DiagnosticProtocol::encode_diagnostic_message_1(std::vector<std::uint8_t> &payload)
 	{
+		const std::uint16_t payloadSize = (activeDTCList.size() * DM_PAYLOAD_BYTES_PER_DTC) + 2; // 2 Bytes (0 and 1) are reserved
 		bool retVal = false;
 
-		if (nullptr != myControlFunction)
+		if (payloadSize <= MAX_PAYLOAD_SIZE_BYTES)
 		{
-			std::uint16_t payloadSize = (activeDTCList.size() * DM_PAYLOAD_BYTES_PER_DTC) + 2; // 2 Bytes (0 and 1) are reserved
-			std::vector<std::uint8_t> buffer;
+			// Short messages are padded to a full frame
+			payload.assign((payloadSize < CAN_DATA_LENGTH) ? CAN_DATA_LENGTH : payloadSize, 0xFF);
 
-			if (payloadSize <= MAX_PAYLOAD_SIZE_BYTES)
+			if (get_j1939_mode())
 			{
-				buffer.resize(payloadSize);
-
-				if (get_j1939_mode())
-				{
-					bool tempLampState = false;
-					FlashState tempLampFlashState = FlashState::Solid;
-					get_active_list_lamp_state_and_flash_state(Lamps::ProtectLamp, tempLampFlashState, tempLampState);
+				bool tempLampState = false;
+				FlashState tempLampFlashState = FlashState::Solid;
+				get_active_list_lamp_state_and_flash_state(Lamps::ProtectLamp, tempLampFlashState, tempLampState);
 
-					/// Encode Protect state and flash
-					buffer[0] = tempLampState;
-					buffer[1] = convert_flash_state_to_byte(tempLampFlashState);
+				/// Encode Protect state and flash
+				payload[0] = tempLampState;
+				payload[1] = convert_flash_state_to_byte(tempLampFlashState);
 
-					get_active_list_lamp_state_and_flash_state(Lamps::AmberWarningLamp, tempLampFlashState, tempLampState);
+				get_active_list_lamp_state_and_flash_state(Lamps::AmberWarningLamp, tempLampFlashState, tempLampState);
 
-					/// Encode amber warning lamp state and flash
-					buffer[0] |= (tempLampState << 2);
-					buffer[1] |= (convert_flash_state_to_byte(tempLampFlashState) << 2);
+				/// Encode amber warning lamp state and flash
+				payload[0] |= (tempLampState << 2);
+				payload[1] |= (convert_flash_state_to_byte(tempLampFlashState) << 2);
 
-					get_active_list_lamp_state_and_flash_state(Lamps::RedStopLamp, tempLampFlashState, tempLampState);
+				get_active_list_lamp_state_and_flash_state(Lamps::RedStopLamp, tempLampFlashState, tempLampState);
 
-					/// Encode red stop lamp state and flash
-					buffer[0] |= (tempLampState << 4);
-					buffer[1] |= (convert_flash_state_to_byte(tempLampFlashState) << 4);
+				/// Encode red stop lamp state and flash
+				payload[0] |= (tempLampState << 4);
+				payload[1] |= (convert_flash_state_to_byte(tempLampFlashState) << 4);
 
-					get_active_list_lamp_state_and_flash_state(Lamps::MalfunctionIndicatorLamp, tempLampFlashState, tempLampState);
+				get_active_list_lamp_state_and_flash_state(Lamps::MalfunctionIndicatorLamp, tempLampFlashState, tempLampState);
 
-					/// Encode malfunction indicator lamp state and flash
-					buffer[0] |= (tempLampState << 6);
-					buffer[1] |= (convert_flash_state_to_byte(tempLampFlashState) << 6);
-				}
-				else
-				{
-					// ISO 11783 does not use lamp state or lamp flash bytes
-					buffer[0] = 0xFF;
-					buffer[1] = 0xFF;
-				}
+				/// Encode malfunction indicator lamp state and flash
+				payload[0] |= (tempLampState << 6);
+				payload[1] |= (convert_flash_state_to_byte(tempLampFlashState) << 6);
+			}
 
-				if (0 == activeDTCList.size())
+			if (0 == activeDTCList.size())
+			{
+				payload[2] = 0x00;
+				payload[3] = 0x00;
+				payload[4] = 0x00;
+				payload[5] = 0x00;
+			}
+			else
+			{
+				for (std::size_t i = 0; i < activeDTCList.size(); i++)
 				{
-					buffer[2] = 0x00;
-					buffer[3] = 0x00;
-					buffer[4] = 0x00;
-					buffer[5] = 0x00;
-					buffer[6] = 0xFF;
-					buffer[7] = 0xFF;
-					retVal = CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::DiagnosticMessage1),
-					                                                        buffer.data(),
-					                                                        CAN_DATA_LENGTH,
-					                                                        myControlFunction.get());
+					payload[2 + (DM_PAYLOAD_BYTES_PER_DTC * i)] = static_cast<std::uint8_t>(activeDTCList[i].suspectParameterNumber & 0xFF);
+					payload[3 + (DM_PAYLOAD_BYTES_PER_DTC * i)] = static_cast<std::uint8_t>((activeDTCList[i].suspectParameterNumber >> 8) & 0xFF);
+					payload[4 + (DM_PAYLOAD_BYTES_PER_DTC * i)] = ((static_cast<std::uint8_t>((activeDTCList[i].suspectParameterNumber >> 16) & 0xFF) << 5) | static_cast<std::uint8_t>(activeDTCList[i].failureModeIdentifier & 0x1F));
+					payload[5 + (DM_PAYLOAD_BYTES_PER_DTC * i)] = (activeDTCList[i].occuranceCount & 0x7F);
 				}
-				else
-				{
-					for (std::size_t i = 0; i < activeDTCList.size(); i++)
-					{
-						buffer[2 + (DM_PAYLOAD_BYTES_PER_DTC * i)] = static_cast<std::uint8_t>(activeDTCList[i].suspectParameterNumber & 0xFF);
-						buffer[3 + (DM_PAYLOAD_BYTES_PER_DTC * i)] = static_cast<std::uint8_t>((activeDTCList[i].suspectParameterNumber >> 8) & 0xFF);
-						buffer[4 + (DM_PAYLOAD_BYTES_PER_DTC * i)] = ((static_cast<std::uint8_t>((activeDTCList[i].suspectParameterNumber >> 16) & 0xFF) << 5) | static_cast<std::uint8_t>(activeDTCList[i].failureModeIdentifier & 0x1F));
-						buffer[5 + (DM_PAYLOAD_BYTES_PER_DTC * i)] = (activeDTCList[i].occuranceCount & 0x7F);
-					}
+			}
+			retVal = true;
+		}
+		return retVal;
+	}
 
-					if (payloadSize < CAN_DATA_LENGTH)
-					{
-						buffer[6] = 0xFF;
-						buffer[7] = 0xFF;
-						payloadSize = CAN_DATA_LENGTH;
-					}
+	bool DiagnosticProtocol::send_diagnostic_message_1()
+	{
+		std::vector<std::uint8_t> buffer;
+		bool retVal = false;
 
-					retVal = CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::DiagnosticMessage1),
-					                                                        buffer.data(),
-					                                                        payloadSize,
-					                                                        myControlFunction.get());
-				}
-			}
+		if ((nullptr != myControlFunction) &&
+		    (encode_diagnostic_message_1(buffer)))
+		{
+			retVal = networkManager.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::DiagnosticMessage1),
+			                                         buffer.data(),
+			                                         static_cast<std::uint32_t>(buffer.size()),
+			                                         myControlFunction.get());
 		}
 		return retVal;
 	}
@@ -890,10 +894,10 @@ namespace isobus
 					buffer[5] = 0x00;
 					buffer[6] = 0xFF;
 					buffer[7] = 0xFF;
-					retVal = CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::DiagnosticMessage2),
-					                                                        buffer.data(),
-					                                                        CAN_DATA_LENGTH,
-					                                                        myControlFunction.get());
+					retVal = networkManager.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::DiagnosticMessage2),
+					                                         buffer.data(),
+					                                         CAN_DATA_LENGTH,
+					                                         myControlFunction.get());
 				}
 				else
 				{
@@ -912,10 +916,10 @@ namespace isobus
 						payloadSize = CAN_DATA_LENGTH;
 					}
 
-					retVal = CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::DiagnosticMessage2),
-					                                                        buffer.data(),
-					                                                        payloadSize,
-					                                                        myControlFunction.get());
+					retVal = networkManager.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::DiagnosticMessage2),
+					                                         buffer.data(),
+					                                         payloadSize,
+					                                         myControlFunction.get());
 				}
 			}
 		}
@@ -934,10 +938,10 @@ namespace isobus
 
 			buffer.fill(0xFF); // Reserved bytes
 			buffer[0] = SUPPORTED_DIAGNOSTIC_PROTOCOLS_BITFIELD;
-			retVal = CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::DiagnosticProtocolIdentification),
-			                                                        buffer.data(),
-			                                                        CAN_DATA_LENGTH,
-			                                                        myControlFunction.get());
+			retVal = networkManager.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::DiagnosticProtocolIdentification),
+			                                         buffer.data(),
+			                                         CAN_DATA_LENGTH,
+			                                         myControlFunction.get());
 		}
 		return retVal;
 	}
@@ -954,42 +958,42 @@ namespace isobus
 			0xFF,
 			0xFF
 		};
-		return CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::DiagnosticMessage13),
-		                                                      buffer.data(),
-		                                                      8,
-		                                                      sourceControlFunction);
+		return networkManager.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::DiagnosticMessage13),
+		                                       buffer.data(),
+		                                       8,
+		                                       sourceControlFunction);
 	}
 
-	bool DiagnosticProtocol::send_ecu_identification()
+	void DiagnosticProtocol::encode_ecu_identification()
 	{
 		std::string ecuIdString = "";
 
-		for (auto stringComponent : ecuIdentificationFields)
+		for (auto &stringComponent : ecuIdentificationFields)
 		{
 			ecuIdString.append(stringComponent);
 		}
 
-		std::vector<std::uint8_t> buffer(ecuIdString.begin(), ecuIdString.end());
-		return CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUIdentificationInformation),
-		                                                      buffer.data(),
-		                                                      buffer.size(),
-		                                                      myControlFunction.get());
+		auto payload = std::make_shared<const std::vector<std::uint8_t>>(ecuIdString.begin(), ecuIdString.end());
+		{
+			const std::lock_guard<std::mutex> lock(identificationPayloadMutex);
+			ecuIdentificationPayload = payload;
+			identificationPayloadVersion++;
+		}
+		publish_identification_payloads();
 	}
 
-	bool DiagnosticProtocol::send_product_identification()
+	void DiagnosticProtocol::encode_product_identification()
 	{
 		std::string productIdString = productIdentificationCode + "*" + productIdentificationBrand + "*" + productIdentificationModel + "*";
-		std::vector<std::uint8_t> buffer(productIdString.begin(), productIdString.end());
 
-		return CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ProductIdentification),
-		                                                      buffer.data(),
-		                                                      buffer.size(),
-		                                                      myControlFunction.get());
+		auto payload = std::make_shared<const std::vector<std::uint8_t>>(productIdString.begin(), productIdString.end());
+		const std::lock_guard<std::mutex> lock(identificationPayloadMutex);
+		productIdentificationPayload = payload;
 	}
 
-	bool DiagnosticProtocol::send_software_identification()
+	void DiagnosticProtocol::encode_software_identification()
 	{
-		bool retVal = false;
+		std::shared_ptr<const std::vector<std::uint8_t>> payload;
 
 		if (0 != softwareIdentificationFields.size())
 		{
@@ -1000,76 +1004,189 @@ namespace isobus
 				softIDString.append(*softIdString);
 				softIDString.append("*");
 			}
+			payload = std::make_shared<const std::vector<std::uint8_t>>(softIDString.begin(), softIDString.end());
+		}
+
+		{
+			const std::lock_guard<std::mutex> lock(identificationPayloadMutex);
+			softwareIdentificationPayload = payload;
+			identificationPayloadVersion++;
+		}
+		publish_identification_payloads();
+	}
+
+	void DiagnosticProtocol::publish_identification_payloads()
+	{
+		ParameterGroupNumberRequestProtocol *pgnRequestProtocol = ParameterGroupNumberRequestProtocol::get_pgn_request_protocol_by_internal_control_function(myControlFunction);
+
+		if (nullptr != pgnRequestProtocol)
+		{
+			std::shared_ptr<const std::vector<std::uint8_t>> ecuPayload;
+			std::shared_ptr<const std::vector<std::uint8_t>> softwarePayload;
+			std::uint32_t version;
+			{
+				const std::lock_guard<std::mutex> lock(identificationPayloadMutex);
+				ecuPayload = ecuIdentificationPayload;
+				softwarePayload = softwareIdentificationPayload;
+				version = identificationPayloadVersion;
+			}
+
+			// Publishing an unchanged version is ignored by the cache, so both can share one version
+			pgnRequestProtocol->publish_cached_response(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUIdentificationInformation),
+			                                            ecuPayload->data(),
+			                                            static_cast<std::uint32_t>(ecuPayload->size()),
+			                                            version);
+
+			if (nullptr != softwarePayload)
+			{
+				pgnRequestProtocol->publish_cached_response(static_cast<std::uint32_t>(CANLibParameterGroupNumber::SoftwareIdentification),
+				                                            softwarePayload->data(),
+				                                            static_cast<std::uint32_t>(softwarePayload->size()),
+				                                            version);
+			}
+			else
+			{
+				// With no software ID fields, requests go to the callback, which NACKs them
+				pgnRequestProtocol->remove_cached_response(static_cast<std::uint32_t>(CANLibParameterGroupNumber::SoftwareIdentification));
+			}
+		}
+	}
+
+	bool DiagnosticProtocol::send_ecu_identification()
+	{
+		std::shared_ptr<const std::vector<std::uint8_t>> payload;
+		{
+			const std::lock_guard<std::mutex> lock(identificationPayloadMutex);
+			payload = ecuIdentificationPayload;
+		}
+		return networkManager.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUIdentificationInformation),
+		                                       payload,
+		                                       myControlFunction.get());
+	}
+
+	bool DiagnosticProtocol::send_product_identification()
+	{
+		std::shared_ptr<const std::vector<std::uint8_t>> payload;
+		{
+			const std::lock_guard<std::mutex> lock(identificationPayloadMutex);
+			payload = productIdentificationPayload;
+		}
+		return networkManager.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ProductIdentification),
+		                                       payload,
+		                                       myControlFunction.get());
+	}
+
+	bool DiagnosticProtocol::send_software_identification()
+	{
+		bool retVal = false;
+		std::shared_ptr<const std::vector<std::uint8_t>> payload;
+		{
+			const std::lock_guard<std::mutex> lock(identificationPayloadMutex);
+			payload = softwareIdentificationPayload;
+		}
+
+		if (nullptr != payload)
+		{
+			retVal = networkManager.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::SoftwareIdentification),
+			                                         payload,
+			                                         myControlFunction.get());
+		}
+		return retVal;
+	}
+
+	bool DiagnosticProtocol::send_diagnostic_message_22_response(DM22Data data)
+	{
+		std::array<std::uint8_t, CAN_DATA_LENGTH> buffer;
+
+		if (data.nack)
+		{
+			if (data.clearActive)
+			{
+				buffer[0] = static_cast<std::uint8_t>(DM22ControlByte::NegativeAcknowledgeOfActiveDTCClear);
+			}
+			else
+			{
+				buffer[0] = static_cast<std::uint8_t>(DM22ControlByte::NegativeAcknowledgeOfPreviouslyActiveDTCClear);
+			}
+			buffer[1] = data.nackIndicator;
+		}
+		else
+		{
+			if (data.clearActive)
+			{
+				buffer[0] = static_cast<std::uint8_t>(DM22ControlByte::PositiveAcknowledgeOfActiveDTCClear);
+			}
+			else
+			{
+				buffer[0] = static_cast<std::uint8_t>(DM22ControlByte::PositiveAcknowledgeOfPreviouslyActiveDTCClear);
+			}
+			buffer[1] = 0xFF;
+		}
 
-			std::vector<std::uint8_t> buffer(softIDString.begin(), softIDString.end());
-			retVal = CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::SoftwareIdentification),
-			                                                        buffer.data(),
-			                                                        buffer.size(),
-			                                                        myControlFunction.get());
+		buffer[2] = 0xFF;
+		buffer[3] = 0xFF;
+		buffer[4] = 0xFF;
+		buffer[5] = (data.suspectParameterNumber & 0xFF);
+		buffer[6] = ((data.suspectParameterNumber >> 8) & 0xFF);
+		buffer[7] = (((data.suspectParameterNumber >> 16) << 5) & 0xFF);
+		buffer[7] |= (data.failureModeIdentifier & 0x1F);
+
+		return networkManager.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::DiagnosticMessage22),
+		                                       buffer.data(),
+		                                       buffer.size(),
+		                                       myControlFunction.get(),
+		                                       data.destination);
+	}
+
+	bool DiagnosticProtocol::queue_dm22_response(DM22Data data)
+	{
+		bool retVal = false;
+
+		if (dm22ResponseQueueSize < DM22_RESPONSE_QUEUE_SIZE)
+		{
+			data.timestamp_ms = SystemTiming::get_timestamp_ms();
+			dm22ResponseQueue[(dm22ResponseQueueHead + dm22ResponseQueueSize) % DM22_RESPONSE_QUEUE_SIZE] = data;
+			dm22ResponseQueueSize++;
+			txFlags.set_flag(static_cast<std::uint32_t>(TransmitFlags::DM22));
+			retVal = true;
 		}
 		return retVal;
 	}
 
 	bool DiagnosticProtocol::process_all_dm22_responses()
 	{
-		bool retVal = false;
+		std::size_t numberOfMessages = dm22ResponseQueueSize;
+		bool sendFailed = false;
 
-		if (0 != dm22ResponseQueue.size())
+		// Send everything in order in one pass. Anything we can't send goes back on the end of the ring.
+		for (std::size_t i = 0; i < numberOfMessages; i++)
 		{
-			std::size_t numberOfMessage = dm22ResponseQueue.size();
+			DM22Data currentMessageData = dm22ResponseQueue[dm22ResponseQueueHead];
+			dm22ResponseQueueHead = ((dm22ResponseQueueHead + 1) % DM22_RESPONSE_QUEUE_SIZE);
+			dm22ResponseQueueSize--;
+
+			bool messageSent = false;
 
-			for (std::size_t i = 0; i < numberOfMessage; i++)
+			if (!sendFailed)
 			{
-				std::array<std::uint8_t, CAN_DATA_LENGTH> buffer;
-				DM22Data currentMessageData = dm22ResponseQueue.back();
+				messageSent = send_diagnostic_message_22_response(currentMessageData);
+				sendFailed = !messageSent;
+			}
 
-				if (currentMessageData.nack)
+			if (!messageSent)
+			{
+				if (SystemTiming::time_expired_ms(currentMessageData.timestamp_ms, DM22_RESPONSE_TIMEOUT_MS))
 				{
-					if (currentMessageData.clearActive)
-					{
-						buffer[0] = static_cast<std::uint8_t>(DM22ControlByte::NegativeAcknowledgeOfActiveDTCClear);
-						buffer[1] = currentMessageData.nackIndicator;
-					}
-					else
-					{
-						buffer[0] = static_cast<std::uint8_t>(DM22ControlByte::NegativeAcknowledgeOfPreviouslyActiveDTCClear);
-						buffer[1] = currentMessageData.nackIndicator;
-					}
+					CANStackLogger::warn("[DP]: Dropping a DM22 response for SPN ", static_cast<int>(currentMessageData.suspectParameterNumber), " that could not be sent in time");
 				}
 				else
 				{
-					if (currentMessageData.clearActive)
-					{
-						buffer[0] = static_cast<std::uint8_t>(DM22ControlByte::PositiveAcknowledgeOfActiveDTCClear);
-						buffer[1] = 0xFF;
-					}
-					else
-					{
-						buffer[0] = static_cast<std::uint8_t>(DM22ControlByte::PositiveAcknowledgeOfPreviouslyActiveDTCClear);
-						buffer[1] = 0xFF;
-					}
-				}
-
-				buffer[2] = 0xFF;
-				buffer[3] = 0xFF;
-				buffer[4] = 0xFF;
-				buffer[5] = (currentMessageData.suspectParameterNumber & 0xFF);
-				buffer[6] = ((currentMessageData.suspectParameterNumber >> 8) & 0xFF);
-				buffer[7] = (((currentMessageData.suspectParameterNumber >> 16) << 5) & 0xFF);
-				buffer[7] |= (currentMessageData.failureModeIdentifier & 0x07);
-
-				retVal = CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::DiagnosticMessage22),
-				                                                        buffer.data(),
-				                                                        buffer.size(),
-				                                                        myControlFunction.get(),
-				                                                        currentMessageData.destination);
-				if (retVal)
-				{
-					dm22ResponseQueue.pop_back();
+					dm22ResponseQueue[(dm22ResponseQueueHead + dm22ResponseQueueSize) % DM22_RESPONSE_QUEUE_SIZE] = currentMessageData;
+					dm22ResponseQueueSize++;
 				}
 			}
 		}
-		return retVal;
+		return (0 == dm22ResponseQueueSize);
 	}
 
 	void DiagnosticProtocol::process_message(CANMessage *const message)
@@ -1105,105 +1222,116 @@ namespace isobus
 						tempDM22Data.failureModeIdentifier = (messageData.at(7) & 0x1F);
 						tempDM22Data.destination = message->get_source_control_function();
 						tempDM22Data.nackIndicator = 0;
-						tempDM22Data.clearActive = false;
+						tempDM22Data.timestamp_ms = 0;
+						tempDM22Data.clearActive = (static_cast<std::uint8_t>(DM22ControlByte::RequestToClearActiveDTC) == messageData.at(0));
 
-						switch (messageData.at(0))
+						if ((DM22_RESPONSE_QUEUE_SIZE <= dm22ResponseQueueSize) &&
+						    ((static_cast<std::uint8_t>(DM22ControlByte::RequestToClearActiveDTC) == messageData.at(0)) ||
+						     (static_cast<std::uint8_t>(DM22ControlByte::RequestToClearPreviouslyActiveDTC) == messageData.at(0))))
 						{
-							case static_cast<std::uint8_t>(DM22ControlByte::RequestToClearActiveDTC):
-							{
-								tempDM22Data.clearActive = true;
-
-								for (auto dtc = activeDTCList.begin(); dtc != activeDTCList.end(); dtc++)
-								{
-									if ((tempDM22Data.suspectParameterNumber == dtc->suspectParameterNumber) &&
-									    (tempDM22Data.failureModeIdentifier == dtc->failureModeIdentifier))
-									{
-										inactiveDTCList.push_back(*dtc);
-										activeDTCList.erase(dtc);
-										wasDTCCleared = true;
-										tempDM22Data.nack = false;
-
-										dm22ResponseQueue.push_back(tempDM22Data);
-										txFlags.set_flag(static_cast<std::uint32_t>(TransmitFlags::DM22));
-										break;
-									}
-								}
+							// No room to track another response, so refuse the request instead of clearing a DTC we can't acknowledge
+							tempDM22Data.nack = true;
+							tempDM22Data.nackIndicator = static_cast<std::uint8_t>(DM22NegativeAcknowledgeIndicator::General);
 
-								if (!wasDTCCleared)
+							if (!send_diagnostic_message_22_response(tempDM22Data))
+							{
+								CANStackLogger::warn("[DP]: DM22 response queue is full and a NACK could not be sent");
+							}
+						}
+						else
+						{
+							switch (messageData.at(0))
+							{
+								case static_cast<std::uint8_t>(DM22ControlByte::RequestToClearActiveDTC):
 								{
-									tempDM22Data.nack = true;
-
-									// Since we didn't find the DTC in the active list, we check the inactive to determine the proper NACK reason
-									for (auto dtc : inactiveDTCList)
+									for (auto dtc = activeDTCList.begin(); dtc != activeDTCList.end(); dtc++)
 									{
-										if ((tempDM22Data.suspectParameterNumber == dtc.suspectParameterNumber) &&
-										    (tempDM22Data.failureModeIdentifier == dtc.failureModeIdentifier))
+										if ((tempDM22Data.suspectParameterNumber == dtc->suspectParameterNumber) &&
+										    (tempDM22Data.failureModeIdentifier == dtc->failureModeIdentifier))
 										{
-											// The DTC was active, but is inactive now, so we NACK with the proper reason
-											tempDM22Data.nackIndicator = static_cast<std::uint8_t>(DM22NegativeAcknowledgeIndicator::DTCNoLongerActive);
+											inactiveDTCList.push_back(*dtc);
+											activeDTCList.erase(dtc);
+											wasDTCCleared = true;
+											tempDM22Data.nack = false;
+
+											queue_dm22_response(tempDM22Data);
 											break;
 										}
 									}
 
-									if (0 != tempDM22Data.nackIndicator)
+									if (!wasDTCCleared)
 									{
-										// DTC is in neither list. NACK with the reason that we don't know anything about it
-										tempDM22Data.nackIndicator = static_cast<std::uint8_t>(DM22NegativeAcknowledgeIndicator::UnknownOrDoesNotExist);
-									}
-									dm22ResponseQueue.push_back(tempDM22Data);
-									txFlags.set_flag(static_cast<std::uint32_t>(TransmitFlags::DM22));
-								}
-							}
-							break;
+										tempDM22Data.nack = true;
 
-							case static_cast<std::uint8_t>(DM22ControlByte::RequestToClearPreviouslyActiveDTC):
-							{
-								for (auto dtc = inactiveDTCList.begin(); dtc != inactiveDTCList.end(); dtc++)
-								{
-									if ((tempDM22Data.suspectParameterNumber == dtc->suspectParameterNumber) &&
-									    (tempDM22Data.failureModeIdentifier == dtc->failureModeIdentifier))
-									{
-										inactiveDTCList.erase(dtc);
-										wasDTCCleared = true;
-										tempDM22Data.nack = false;
+										// Since we didn't find the DTC in the active list, we check the inactive to determine the proper NACK reason
+										for (auto dtc : inactiveDTCList)
+										{
+											if ((tempDM22Data.suspectParameterNumber == dtc.suspectParameterNumber) &&
+											    (tempDM22Data.failureModeIdentifier == dtc.failureModeIdentifier))
+											{
+												// The DTC was active, but is inactive now, so we NACK with the proper reason
+												tempDM22Data.nackIndicator = static_cast<std::uint8_t>(DM22NegativeAcknowledgeIndicator::DTCNoLongerActive);
+												break;
+											}
+										}
 
-										dm22ResponseQueue.push_back(tempDM22Data);
-										txFlags.set_flag(static_cast<std::uint32_t>(TransmitFlags::DM22));
-										break;
+										if (0 == tempDM22Data.nackIndicator)
+										{
+											// DTC is in neither list. NACK with the reason that we don't know anything about it
+											tempDM22Data.nackIndicator = static_cast<std::uint8_t>(DM22NegativeAcknowledgeIndicator::UnknownOrDoesNotExist);
+										}
+										queue_dm22_response(tempDM22Data);
 									}
 								}
+								break;
 
-								if (!wasDTCCleared)
+								case static_cast<std::uint8_t>(DM22ControlByte::RequestToClearPreviouslyActiveDTC):
 								{
-									tempDM22Data.nack = true;
-
-									// Since we didn't find the DTC in the inactive list, we check the active to determine the proper NACK reason
-									for (auto dtc : activeDTCList)
+									for (auto dtc = inactiveDTCList.begin(); dtc != inactiveDTCList.end(); dtc++)
 									{
-										if ((tempDM22Data.suspectParameterNumber == dtc.suspectParameterNumber) &&
-										    (tempDM22Data.failureModeIdentifier == dtc.failureModeIdentifier))
+										if ((tempDM22Data.suspectParameterNumber == dtc->suspectParameterNumber) &&
+										    (tempDM22Data.failureModeIdentifier == dtc->failureModeIdentifier))
 										{
-											// The DTC was inactive, but is active now, so we NACK with the proper reason
-											tempDM22Data.nackIndicator = static_cast<std::uint8_t>(DM22NegativeAcknowledgeIndicator::DTCUNoLongerPreviouslyActive);
+											inactiveDTCList.erase(dtc);
+											wasDTCCleared = true;
+											tempDM22Data.nack = false;
+
+											queue_dm22_response(tempDM22Data);
 											break;
 										}
 									}
 
-									if (0 != tempDM22Data.nackIndicator)
+									if (!wasDTCCleared)
 									{
-										// DTC is in neither list. NACK with the reason that we don't know anything about it
-										tempDM22Data.nackIndicator = static_cast<std::uint8_t>(DM22NegativeAcknowledgeIndicator::UnknownOrDoesNotExist);
+										tempDM22Data.nack = true;
+
+										// Since we didn't find the DTC in the inactive list, we check the active to determine the proper NACK reason
+										for (auto dtc : activeDTCList)
+										{
+											if ((tempDM22Data.suspectParameterNumber == dtc.suspectParameterNumber) &&
+											    (tempDM22Data.failureModeIdentifier == dtc.failureModeIdentifier))
+											{
+												// The DTC was inactive, but is active now, so we NACK with the proper reason
+												tempDM22Data.nackIndicator = static_cast<std::uint8_t>(DM22NegativeAcknowledgeIndicator::DTCUNoLongerPreviouslyActive);
+												break;
+											}
+										}
+
+										if (0 == tempDM22Data.nackIndicator)
+										{
+											// DTC is in neither list. NACK with the reason that we don't know anything about it
+											tempDM22Data.nackIndicator = static_cast<std::uint8_t>(DM22NegativeAcknowledgeIndicator::UnknownOrDoesNotExist);
+										}
+										queue_dm22_response(tempDM22Data);
 									}
-									dm22ResponseQueue.push_back(tempDM22Data);
-									txFlags.set_flag(static_cast<std::uint32_t>(TransmitFlags::DM22));
 								}
-							}
-							break;
+								break;
 
-							default:
-							{
+								default:
+								{
+								}
+								break;
 							}
-							break;
 						}
 					}
 				}
@@ -12,10 +12,10 @@
 #include "isobus/isobus/can_network_manager.hpp"
 #include "isobus/isobus/can_warning_logger.hpp"
 #include "isobus/utility/system_timing.hpp"
-#include "isobus/utility/to_string.hpp"
 
 #include <algorithm>
 #include <cstring>
+#include <limits>
 
 namespace isobus
 {
@@ -45,16 +45,34 @@ namespace isobus
 	  stateMachineTimestamp_ms(0),
 	  lastWorkingSetMaintenanceTimestamp_ms(0),
 	  workerThread(nullptr),
+	  workerWakeRequested(false),
 	  initialized(false),
 	  sendWorkingSetMaintenenace(false),
 	  shouldTerminate(false),
 	  objectPoolDataCallback(nullptr),
-	  lastObjectPoolIndex(0)
+	  objectPoolSize_bytes(0),
+	  objectPoolUploadedBytes(0),
+	  currentObjectPoolUploadedBytes(0),
+	  objectPoolUploadRetryTimestamp_ms(0),
+	  lastObjectPoolIndex(0),
+	  objectPoolUploadAttempts(0),
+	  objectPoolVersionLabelValid(false),
+	  objectPoolVersionCaching(false),
+	  commandQueueTimestamp_ms(0),
+	  commandQueueInterval_ms(20),
+	  commandQueueMaxPendingResponses(4),
+	  commandQueueEnabled(false),
+	  stringValueInFlightObjectID(NULL_OBJECT_ID),
+	  graphicsBatchDataOffset(0),
+	  graphicsBatchIndex(0),
+	  graphicsBatchInFlight(false),
+	  objectPoolDeltaReplayIndex(0),
+	  objectPoolDeltaReplayEnabled(false)
 	{
 		if (nullptr != partnerControlFunction)
 		{
 			partnerControlFunction->add_parameter_group_number_callback(static_cast<std::uint32_t>(CANLibParameterGroupNumber::VirtualTerminalToECU), process_rx_message, this);
-			CANNetworkManager::CANNetwork.add_global_parameter_group_number_callback(static_cast<std::uint32_t>(CANLibParameterGroupNumber::VirtualTerminalToECU), process_rx_message, this);
+			get_network_manager().add_global_parameter_group_number_callback(static_cast<std::uint32_t>(CANLibParameterGroupNumber::VirtualTerminalToECU), process_rx_message, this);
 		}
 	}
 
@@ -94,6 +112,7 @@ namespace isobus
 
 			if (nullptr != workerThread)
 			{
+				wake_worker_thread();
 				workerThread->join();
 				delete workerThread;
 				workerThread = nullptr;
@@ -161,6 +180,69 @@ namespace isobus
 		}
 	}
 
+	void VirtualTerminalClient::set_command_queue_enabled(bool value)
+	{
+		commandQueueEnabled = value;
+	}
+
+	bool VirtualTerminalClient::get_command_queue_enabled() const
+	{
+		return commandQueueEnabled;
+	}
+
+	void VirtualTerminalClient::set_command_queue_interval(std::uint32_t interval_ms)
+	{
+		const std::lock_guard<std::mutex> lock(commandQueueMutex);
+		commandQueueInterval_ms = interval_ms;
+	}
+
+	void VirtualTerminalClient::set_command_queue_max_pending_responses(std::uint8_t value)
+	{
+		if (0 != value)
+		{
+			const std::lock_guard<std::mutex> lock(commandQueueMutex);
+			commandQueueMaxPendingResponses = value;
+		}
+	}
+
+	std::uint32_t VirtualTerminalClient::get_command_queue_size() const
+	{
+		const std::lock_guard<std::mutex> lock(commandQueueMutex);
+		return static_cast<std::uint32_t>(commandQueue.size());
+	}
+
+	void VirtualTerminalClient::set_object_pool_delta_replay_enabled(bool value)
+	{
+		objectPoolDeltaReplayEnabled = value;
+
+		if (!value)
+		{
+			clear_object_pool_deltas();
+		}
+	}
+
+	bool VirtualTerminalClient::get_object_pool_delta_replay_enabled() const
+	{
+		return objectPoolDeltaReplayEnabled;
+	}
+
+	std::uint32_t VirtualTerminalClient::get_number_object_pool_deltas() const
+	{
+		const std::lock_guard<std::mutex> lock(objectPoolDeltaMutex);
+		return static_cast<std::uint32_t>(objectPoolDeltas.size());
+	}
+
+	void VirtualTerminalClient::clear_object_pool_deltas()
+	{
+		{
+			const std::lock_guard<std::mutex> lock(objectPoolDeltaMutex);
+			objectPoolDeltas.clear();
+			objectPoolDeltaIndices.clear();
+			objectPoolDeltaReplayIndex = 0;
+		}
+		clear_string_values();
+	}
+
 	bool VirtualTerminalClient::send_hide_show_object(std::uint16_t objectID, HideShowObjectCommand command)
 	{
 		const std::uint8_t buffer[CAN_DATA_LENGTH] = { static_cast<std::uint8_t>(Function::HideShowObjectCommand),
@@ -172,12 +254,7 @@ namespace isobus
 			                                             0xFF,
 			                                             0xFF };
 
-		return CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
-		                                                      buffer,
-		                                                      CAN_DATA_LENGTH,
-		                                                      myControlFunction.get(),
-		                                                      partnerControlFunction.get(),
-		                                                      CANIdentifier::PriorityLowest7);
+		return send_command(buffer);
 	}
 
 	bool VirtualTerminalClient::send_enable_disable_object(std::uint16_t objectID, EnableDisableObjectCommand command)
@@ -190,12 +267,7 @@ namespace isobus
 			                                             0xFF,
 			                                             0xFF,
 			                                             0xFF };
-		return CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
-		                                                      buffer,
-		                                                      CAN_DATA_LENGTH,
-		                                                      myControlFunction.get(),
-		                                                      partnerControlFunction.get(),
-		                                                      CANIdentifier::PriorityLowest7);
+		return send_command(buffer);
 	}
 
 	bool VirtualTerminalClient::send_select_input_object(std::uint16_t objectID, SelectInputObjectOptions option)
@@ -208,12 +280,7 @@ namespace isobus
 			                                             0xFF,
 			                                             0xFF,
 			                                             0xFF };
-		return CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
-		                                                      buffer,
-		                                                      CAN_DATA_LENGTH,
-		                                                      myControlFunction.get(),
-		                                                      partnerControlFunction.get(),
-		                                                      CANIdentifier::PriorityLowest7);
+		return send_command(buffer);
 	}
 
 	bool VirtualTerminalClient::send_ESC()
@@ -226,12 +293,7 @@ namespace isobus
 			                                             0xFF,
 			                                             0xFF,
 			                                             0xFF };
-		return CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
-		                                                      buffer,
-		                                                      CAN_DATA_LENGTH,
-		                                                      myControlFunction.get(),
-		                                                      partnerControlFunction.get(),
-		                                                      CANIdentifier::PriorityLowest7);
+		return send_command(buffer);
 	}
 
 	bool VirtualTerminalClient::send_control_audio_signal(std::uint8_t activations, std::uint16_t frequency_hz, std::uint16_t duration_ms, std::uint16_t offTimeDuration_ms)
@@ -244,12 +306,7 @@ namespace isobus
 			                                             static_cast<std::uint8_t>(duration_ms >> 8),
 			                                             static_cast<std::uint8_t>(offTimeDuration_ms & 0xFF),
 			                                             static_cast<std::uint8_t>(offTimeDuration_ms >> 8) };
-		return CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
-		                                                      buffer,
-		                                                      CAN_DATA_LENGTH,
-		                                                      myControlFunction.get(),
-		                                                      partnerControlFunction.get(),
-		                                                      CANIdentifier::PriorityLowest7);
+		return send_command(buffer);
 	}
 
 	bool VirtualTerminalClient::send_set_audio_volume(std::uint8_t volume_percent)
@@ -267,12 +324,7 @@ namespace isobus
 			                                             0xFF,
 			                                             0xFF,
 			                                             0xFF };
-		return CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
-		                                                      buffer,
-		                                                      CAN_DATA_LENGTH,
-		                                                      myControlFunction.get(),
-		                                                      partnerControlFunction.get(),
-		                                                      CANIdentifier::PriorityLowest7);
+		return send_command(buffer);
 	}
 
 	bool VirtualTerminalClient::send_change_child_location(std::uint16_t objectID, std::uint16_t parentObjectID, std::uint8_t relativeXPositionChange, std::uint8_t relativeYPositionChange)
@@ -285,12 +337,7 @@ namespace isobus
 			                                             relativeXPositionChange,
 			                                             relativeYPositionChange,
 			                                             0xFF };
-		return CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
-		                                                      buffer,
-		                                                      CAN_DATA_LENGTH,
-		                                                      myControlFunction.get(),
-		                                                      partnerControlFunction.get(),
-		                                                      CANIdentifier::PriorityLowest7);
+		return send_command(buffer);
 	}
 
 	bool VirtualTerminalClient::send_change_child_position(std::uint16_t objectID, std::uint16_t parentObjectID, std::uint16_t xPosition, std::uint16_t yPosition)
@@ -306,12 +353,12 @@ namespace isobus
 			static_cast<std::uint8_t>(yPosition & 0xFF),
 			static_cast<std::uint8_t>(yPosition >> 8),
 		};
-		return CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
-		                                                      buffer,
-		                                                      9,
-		                                                      myControlFunction.get(),
-		                                                      partnerControlFunction.get(),
-		                                                      CANIdentifier::PriorityLowest7);
+		return get_network_manager().send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
+		                                              buffer,
+		                                              9,
+		                                              myControlFunction.get(),
+		                                              partnerControlFunction.get(),
+		                                              CANIdentifier::PriorityLowest7);
 	}
 
 	bool VirtualTerminalClient::send_change_size_command(std::uint16_t objectID, std::uint16_t newWidth, std::uint16_t newHeight)
@@ -324,12 +371,7 @@ namespace isobus
 			                                             static_cast<std::uint8_t>(newHeight & 0xFF),
 			                                             static_cast<std::uint8_t>(newHeight >> 8),
 			                                             0xFF };
-		return CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
-		                                                      buffer,
-		                                                      CAN_DATA_LENGTH,
-		                                                      myControlFunction.get(),
-		                                                      partnerControlFunction.get(),
-		                                                      CANIdentifier::PriorityLowest7);
+		return send_command(buffer);
 	}
 
 	bool VirtualTerminalClient::send_change_background_colour(std::uint16_t objectID, std::uint8_t color)
@@ -342,12 +384,7 @@ namespace isobus
 			                                             0xFF,
 			                                             0xFF,
 			                                             0xFF };
-		return CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
-		                                                      buffer,
-		                                                      CAN_DATA_LENGTH,
-		                                                      myControlFunction.get(),
-		                                                      partnerControlFunction.get(),
-		                                                      CANIdentifier::PriorityLowest7);
+		return send_command(buffer);
 	}
 
 	bool VirtualTerminalClient::send_change_numeric_value(std::uint16_t objectID, std::uint32_t value)
@@ -362,12 +399,7 @@ namespace isobus
 			static_cast<std::uint8_t>((value >> 16) & 0xFF),
 			static_cast<std::uint8_t>((value >> 24) & 0xFF),
 		};
-		return CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
-		                                                      buffer,
-		                                                      CAN_DATA_LENGTH,
-		                                                      myControlFunction.get(),
-		                                                      partnerControlFunction.get(),
-		                                                      CANIdentifier::PriorityLowest7);
+		return send_command(buffer);
 	}
 
 	bool VirtualTerminalClient::send_change_string_value(std::uint16_t objectID, uint16_t stringLength, const char *value)
@@ -376,23 +408,30 @@ namespace isobus
 
 		if (nullptr != value)
 		{
-			std::uint8_t *buffer = new std::uint8_t[5 + stringLength];
-			buffer[0] = static_cast<std::uint8_t>(Function::ChangeStringValueCommand);
-			buffer[1] = static_cast<std::uint8_t>(objectID & 0xFF);
-			buffer[2] = static_cast<std::uint8_t>(objectID >> 8);
-			buffer[3] = static_cast<std::uint8_t>(stringLength & 0xFF);
-			buffer[4] = static_cast<std::uint8_t>(stringLength >> 8);
-			for (uint16_t i = 0; i < stringLength; i++)
-			{
-				buffer[5 + i] = value[i];
-			}
-			retVal = CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
-			                                                        buffer,
-			                                                        5 + stringLength,
-			                                                        myControlFunction.get(),
-			                                                        partnerControlFunction.get(),
-			                                                        CANIdentifier::PriorityLowest7);
-			delete[] buffer;
+			{
+				const std::lock_guard<std::mutex> lock(stringValueMutex);
+				StringValueState &stringValue = stringValues[objectID];
+				const bool valueMatches = ((stringValue.value.size() == stringLength) &&
+				                           ((0 == stringLength) || (0 == memcmp(stringValue.value.data(), value, stringLength))));
+
+				if ((!valueMatches) ||
+				    ((!stringValue.sent) &&
+				     (!stringValue.queued) &&
+				     (objectID != stringValueInFlightObjectID)))
+				{
+					// Assigning reuses the object's buffer once it has grown to fit its longest value
+					stringValue.value.assign(reinterpret_cast<const std::uint8_t *>(value), reinterpret_cast<const std::uint8_t *>(value) + stringLength);
+					stringValue.sent = false;
+
+					if (!stringValue.queued)
+					{
+						stringValue.queued = true;
+						stringValueQueue.push_back(objectID);
+					}
+				}
+				retVal = true;
+			}
+			process_string_value_queue();
 		}
 		return retVal;
 	}
@@ -412,12 +451,7 @@ namespace isobus
 			                                             static_cast<std::uint8_t>(height_px & 0xFF),
 			                                             static_cast<std::uint8_t>(height_px >> 8),
 			                                             static_cast<std::uint8_t>(direction) };
-		return CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
-		                                                      buffer,
-		                                                      CAN_DATA_LENGTH,
-		                                                      myControlFunction.get(),
-		                                                      partnerControlFunction.get(),
-		                                                      CANIdentifier::PriorityLowest7);
+		return send_command(buffer);
 	}
 
 	bool VirtualTerminalClient::send_change_font_attributes(std::uint16_t objectID, std::uint8_t color, FontSize size, std::uint8_t type, std::uint8_t styleBitfield)
@@ -430,12 +464,7 @@ namespace isobus
 			                                             type,
 			                                             styleBitfield,
 			                                             0xFF };
-		return CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
-		                                                      buffer,
-		                                                      CAN_DATA_LENGTH,
-		                                                      myControlFunction.get(),
-		                                                      partnerControlFunction.get(),
-		                                                      CANIdentifier::PriorityLowest7);
+		return send_command(buffer);
 	}
 
 	bool VirtualTerminalClient::send_change_line_attributes(std::uint16_t objectID, std::uint8_t color, std::uint8_t width, std::uint16_t lineArtBitmask)
@@ -448,12 +477,7 @@ namespace isobus
 			                                             static_cast<std::uint8_t>(lineArtBitmask & 0xFF),
 			                                             static_cast<std::uint8_t>(lineArtBitmask >> 8),
 			                                             0xFF };
-		return CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
-		                                                      buffer,
-		                                                      CAN_DATA_LENGTH,
-		                                                      myControlFunction.get(),
-		                                                      partnerControlFunction.get(),
-		                                                      CANIdentifier::PriorityLowest7);
+		return send_command(buffer);
 	}
 
 	bool VirtualTerminalClient::send_change_fill_attributes(std::uint16_t objectID, FillType fillType, std::uint8_t color, std::uint16_t fillPatternObjectID)
@@ -466,12 +490,7 @@ namespace isobus
 			                                             static_cast<std::uint8_t>(fillPatternObjectID & 0xFF),
 			                                             static_cast<std::uint8_t>(fillPatternObjectID >> 8),
 			                                             0xFF };
-		return CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
-		                                                      buffer,
-		                                                      CAN_DATA_LENGTH,
-		                                                      myControlFunction.get(),
-		                                                      partnerControlFunction.get(),
-		                                                      CANIdentifier::PriorityLowest7);
+		return send_command(buffer);
 	}
 
 	bool VirtualTerminalClient::send_change_active_mask(std::uint16_t workingSetObjectID, std::uint16_t newActiveMaskObjectID)
@@ -484,12 +503,7 @@ namespace isobus
 			                                             0xFF,
 			                                             0xFF,
 			                                             0xFF };
-		return CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
-		                                                      buffer,
-		                                                      CAN_DATA_LENGTH,
-		                                                      myControlFunction.get(),
-		                                                      partnerControlFunction.get(),
-		                                                      CANIdentifier::PriorityLowest7);
+		return send_command(buffer);
 	}
 
 	bool VirtualTerminalClient::send_change_softkey_mask(MaskType type, std::uint16_t dataOrAlarmMaskObjectID, std::uint16_t newSoftKeyMaskObjectID)
@@ -502,12 +516,7 @@ namespace isobus
 			                                             static_cast<std::uint8_t>(newSoftKeyMaskObjectID >> 8),
 			                                             0xFF,
 			                                             0xFF };
-		return CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
-		                                                      buffer,
-		                                                      CAN_DATA_LENGTH,
-		                                                      myControlFunction.get(),
-		                                                      partnerControlFunction.get(),
-		                                                      CANIdentifier::PriorityLowest7);
+		return send_command(buffer);
 	}
 
 	bool VirtualTerminalClient::send_change_attribute(std::uint16_t objectID, std::uint8_t attributeID, std::uint32_t value)
@@ -520,12 +529,7 @@ namespace isobus
 			                                             static_cast<std::uint8_t>((value >> 8) & 0xFF),
 			                                             static_cast<std::uint8_t>((value >> 16) & 0xFF),
 			                                             static_cast<std::uint8_t>((value >> 24) & 0xFF) };
-		return CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
-		                                                      buffer,
-		                                                      CAN_DATA_LENGTH,
-		                                                      myControlFunction.get(),
-		                                                      partnerControlFunction.get(),
-		                                                      CANIdentifier::PriorityLowest7);
+		return send_command(buffer);
 	}
 
 	bool VirtualTerminalClient::send_change_priority(std::uint16_t alarmMaskObjectID, AlarmMaskPriority priority)
@@ -538,12 +542,7 @@ namespace isobus
 			                                             0xFF,
 			                                             0xFF,
 			                                             0xFF };
-		return CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
-		                                                      buffer,
-		                                                      CAN_DATA_LENGTH,
-		                                                      myControlFunction.get(),
-		                                                      partnerControlFunction.get(),
-		                                                      CANIdentifier::PriorityLowest7);
+		return send_command(buffer);
 	}
 
 	bool VirtualTerminalClient::send_change_list_item(std::uint16_t objectID, std::uint8_t listIndex, std::uint16_t newObjectID)
@@ -556,12 +555,7 @@ namespace isobus
 			                                             static_cast<std::uint8_t>(newObjectID >> 8),
 			                                             0xFF,
 			                                             0xFF };
-		return CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
-		                                                      buffer,
-		                                                      CAN_DATA_LENGTH,
-		                                                      myControlFunction.get(),
-		                                                      partnerControlFunction.get(),
-		                                                      CANIdentifier::PriorityLowest7);
+		return send_command(buffer);
 	}
 
 	bool VirtualTerminalClient::send_lock_unlock_mask(MaskLockState state, std::uint16_t objectID, std::uint16_t timeout_ms)
@@ -574,12 +568,7 @@ namespace isobus
 			                                             static_cast<std::uint8_t>(timeout_ms >> 8),
 			                                             0xFF,
 			                                             0xFF };
-		return CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
-		                                                      buffer,
-		                                                      CAN_DATA_LENGTH,
-		                                                      myControlFunction.get(),
-		                                                      partnerControlFunction.get(),
-		                                                      CANIdentifier::PriorityLowest7);
+		return send_command(buffer);
 	}
 
 	bool VirtualTerminalClient::send_execute_macro(std::uint16_t objectID)
@@ -592,12 +581,7 @@ namespace isobus
 			                                             0xFF,
 			                                             0xFF,
 			                                             0xFF };
-		return CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
-		                                                      buffer,
-		                                                      CAN_DATA_LENGTH,
-		                                                      myControlFunction.get(),
-		                                                      partnerControlFunction.get(),
-		                                                      CANIdentifier::PriorityLowest7);
+		return send_command(buffer);
 	}
 
 	bool VirtualTerminalClient::send_change_object_label(std::uint16_t objectID, std::uint16_t labelStringObjectID, std::uint8_t fontType, std::uint16_t graphicalDesignatorObjectID)
@@ -610,12 +594,7 @@ namespace isobus
 			                                             fontType,
 			                                             static_cast<std::uint8_t>(graphicalDesignatorObjectID & 0xFF),
 			                                             static_cast<std::uint8_t>(graphicalDesignatorObjectID >> 8) };
-		return CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
-		                                                      buffer,
-		                                                      CAN_DATA_LENGTH,
-		                                                      myControlFunction.get(),
-		                                                      partnerControlFunction.get(),
-		                                                      CANIdentifier::PriorityLowest7);
+		return send_command(buffer);
 	}
 
 	bool VirtualTerminalClient::send_change_polygon_point(std::uint16_t objectID, std::uint8_t pointIndex, std::uint16_t newXValue, std::uint16_t newYValue)
@@ -628,12 +607,7 @@ namespace isobus
 			                                             static_cast<std::uint8_t>(newXValue >> 8),
 			                                             static_cast<std::uint8_t>(newYValue & 0xFF),
 			                                             static_cast<std::uint8_t>(newYValue >> 8) };
-		return CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
-		                                                      buffer,
-		                                                      CAN_DATA_LENGTH,
-		                                                      myControlFunction.get(),
-		                                                      partnerControlFunction.get(),
-		                                                      CANIdentifier::PriorityLowest7);
+		return send_command(buffer);
 	}
 
 	bool VirtualTerminalClient::send_change_polygon_scale(std::uint16_t objectID, std::uint16_t widthAttribute, std::uint16_t heightAttribute)
@@ -646,12 +620,7 @@ namespace isobus
 			                                             static_cast<std::uint8_t>(heightAttribute & 0xFF),
 			                                             static_cast<std::uint8_t>(heightAttribute >> 8),
 			                                             0xFF };
-		return CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
-		                                                      buffer,
-		                                                      CAN_DATA_LENGTH,
-		                                                      myControlFunction.get(),
-		                                                      partnerControlFunction.get(),
-		                                                      CANIdentifier::PriorityLowest7);
+		return send_command(buffer);
 	}
 
 	bool VirtualTerminalClient::send_select_color_map_or_palette(std::uint16_t objectID)
@@ -664,12 +633,7 @@ namespace isobus
 			                                             0xFF,
 			                                             0xFF,
 			                                             0xFF };
-		return CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
-		                                                      buffer,
-		                                                      CAN_DATA_LENGTH,
-		                                                      myControlFunction.get(),
-		                                                      partnerControlFunction.get(),
-		                                                      CANIdentifier::PriorityLowest7);
+		return send_command(buffer);
 	}
 
 	bool VirtualTerminalClient::send_execute_extended_macro(std::uint16_t objectID)
@@ -682,12 +646,7 @@ namespace isobus
 			                                             0xFF,
 			                                             0xFF,
 			                                             0xFF };
-		return CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
-		                                                      buffer,
-		                                                      CAN_DATA_LENGTH,
-		                                                      myControlFunction.get(),
-		                                                      partnerControlFunction.get(),
-		                                                      CANIdentifier::PriorityLowest7);
+		return send_command(buffer);
 	}
 
 	bool VirtualTerminalClient::send_select_active_working_set(std::uint64_t NAMEofWorkingSetMasterForDesiredWorkingSet)
@@ -701,12 +660,12 @@ namespace isobus
 			                               static_cast<std::uint8_t>((NAMEofWorkingSetMasterForDesiredWorkingSet >> 40) & 0xFF),
 			                               static_cast<std::uint8_t>((NAMEofWorkingSetMasterForDesiredWorkingSet >> 48) & 0xFF),
 			                               static_cast<std::uint8_t>((NAMEofWorkingSetMasterForDesiredWorkingSet >> 56) & 0xFF) };
-		return CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
-		                                                      buffer,
-		                                                      9,
-		                                                      myControlFunction.get(),
-		                                                      partnerControlFunction.get(),
-		                                                      CANIdentifier::PriorityLowest7);
+		return get_network_manager().send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
+		                                              buffer,
+		                                              9,
+		                                              myControlFunction.get(),
+		                                              partnerControlFunction.get(),
+		                                              CANIdentifier::PriorityLowest7);
 	}
 
 	bool VirtualTerminalClient::send_set_graphics_cursor(std::uint16_t objectID, std::int16_t xPosition, std::int16_t yPosition)
@@ -719,12 +678,7 @@ namespace isobus
 			                                             static_cast<std::uint8_t>(xPosition >> 8),
 			                                             static_cast<std::uint8_t>(yPosition & 0xFF),
 			                                             static_cast<std::uint8_t>(yPosition >> 8) };
-		return CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
-		                                                      buffer,
-		                                                      CAN_DATA_LENGTH,
-		                                                      myControlFunction.get(),
-		                                                      partnerControlFunction.get(),
-		                                                      CANIdentifier::PriorityLowest7);
+		return send_command(buffer);
 	}
 
 	bool VirtualTerminalClient::send_move_graphics_cursor(std::uint16_t objectID, std::int16_t xOffset, std::int16_t yOffset)
@@ -737,12 +691,7 @@ namespace isobus
 			                                             static_cast<std::uint8_t>(xOffset >> 8),
 			                                             static_cast<std::uint8_t>(yOffset & 0xFF),
 			                                             static_cast<std::uint8_t>(yOffset >> 8) };
-		return CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
-		                                                      buffer,
-		                                                      CAN_DATA_LENGTH,
-		                                                      myControlFunction.get(),
-		                                                      partnerControlFunction.get(),
-		                                                      CANIdentifier::PriorityLowest7);
+		return send_command(buffer);
 	}
 
 	bool VirtualTerminalClient::send_set_foreground_colour(std::uint16_t objectID, std::uint8_t color)
@@ -755,12 +704,7 @@ namespace isobus
 			                                             0xFF,
 			                                             0xFF,
 			                                             0xFF };
-		return CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
-		                                                      buffer,
-		                                                      CAN_DATA_LENGTH,
-		                                                      myControlFunction.get(),
-		                                                      partnerControlFunction.get(),
-		                                                      CANIdentifier::PriorityLowest7);
+		return send_command(buffer);
 	}
 
 	bool VirtualTerminalClient::send_set_background_colour(std::uint16_t objectID, std::uint8_t color)
@@ -773,12 +717,7 @@ namespace isobus
 			                                             0xFF,
 			                                             0xFF,
 			                                             0xFF };
-		return CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
-		                                                      buffer,
-		                                                      CAN_DATA_LENGTH,
-		                                                      myControlFunction.get(),
-		                                                      partnerControlFunction.get(),
-		                                                      CANIdentifier::PriorityLowest7);
+		return send_command(buffer);
 	}
 
 	bool VirtualTerminalClient::send_set_line_attributes_object_id(std::uint16_t objectID, std::uint16_t lineAttributesObjectID)
@@ -791,12 +730,7 @@ namespace isobus
 			                                             static_cast<std::uint8_t>(lineAttributesObjectID >> 8),
 			                                             0xFF,
 			                                             0xFF };
-		return CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
-		                                                      buffer,
-		                                                      CAN_DATA_LENGTH,
-		                                                      myControlFunction.get(),
-		                                                      partnerControlFunction.get(),
-		                                                      CANIdentifier::PriorityLowest7);
+		return send_command(buffer);
 	}
 
 	bool VirtualTerminalClient::send_set_fill_attributes_object_id(std::uint16_t objectID, std::uint16_t fillAttributesObjectID)
@@ -809,12 +743,7 @@ namespace isobus
 			                                             static_cast<std::uint8_t>(fillAttributesObjectID >> 8),
 			                                             0xFF,
 			                                             0xFF };
-		return CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
-		                                                      buffer,
-		                                                      CAN_DATA_LENGTH,
-		                                                      myControlFunction.get(),
-		                                                      partnerControlFunction.get(),
-		                                                      CANIdentifier::PriorityLowest7);
+		return send_command(buffer);
 	}
 
 	bool VirtualTerminalClient::send_set_font_attributes_object_id(std::uint16_t objectID, std::uint16_t fontAttributesObjectID)
@@ -827,12 +756,7 @@ namespace isobus
 			                                             static_cast<std::uint8_t>(fontAttributesObjectID >> 8),
 			                                             0xFF,
 			                                             0xFF };
-		return CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
-		                                                      buffer,
-		                                                      CAN_DATA_LENGTH,
-		                                                      myControlFunction.get(),
-		                                                      partnerControlFunction.get(),
-		                                                      CANIdentifier::PriorityLowest7);
+		return send_command(buffer);
 	}
 
 	bool VirtualTerminalClient::send_erase_rectangle(std::uint16_t objectID, std::uint16_t width, std::uint16_t height)
@@ -845,12 +769,7 @@ namespace isobus
 			                                             static_cast<std::uint8_t>(width >> 8),
 			                                             static_cast<std::uint8_t>(height & 0xFF),
 			                                             static_cast<std::uint8_t>(height >> 8) };
-		return CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
-		                                                      buffer,
-		                                                      CAN_DATA_LENGTH,
-		                                                      myControlFunction.get(),
-		                                                      partnerControlFunction.get(),
-		                                                      CANIdentifier::PriorityLowest7);
+		return send_command(buffer);
 	}
 
 	bool VirtualTerminalClient::send_draw_point(std::uint16_t objectID, std::int16_t xOffset, std::int16_t yOffset)
@@ -863,12 +782,7 @@ namespace isobus
 			                                             static_cast<std::uint8_t>(xOffset >> 8),
 			                                             static_cast<std::uint8_t>(yOffset & 0xFF),
 			                                             static_cast<std::uint8_t>(yOffset >> 8) };
-		return CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
-		                                                      buffer,
-		                                                      CAN_DATA_LENGTH,
-		                                                      myControlFunction.get(),
-		                                                      partnerControlFunction.get(),
-		                                                      CANIdentifier::PriorityLowest7);
+		return send_command(buffer);
 	}
 
 	bool VirtualTerminalClient::send_draw_line(std::uint16_t objectID, std::int16_t xOffset, std::int16_t yOffset)
@@ -881,12 +795,7 @@ namespace isobus
 			                                             static_cast<std::uint8_t>(xOffset >> 8),
 			                                             static_cast<std::uint8_t>(yOffset & 0xFF),
 			                                             static_cast<std::uint8_t>(yOffset >> 8) };
-		return CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
-		                                                      buffer,
-		                                                      CAN_DATA_LENGTH,
-		                                                      myControlFunction.get(),
-		                                                      partnerControlFunction.get(),
-		                                                      CANIdentifier::PriorityLowest7);
+		return send_command(buffer);
 	}
 
 	bool VirtualTerminalClient::send_draw_rectangle(std::uint16_t objectID, std::uint16_t width, std::uint16_t height)
@@ -899,12 +808,7 @@ namespace isobus
 			                                             static_cast<std::uint8_t>(width >> 8),
 			                                             static_cast<std::uint8_t>(height & 0xFF),
 			                                             static_cast<std::uint8_t>(height >> 8) };
-		return CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
-		                                                      buffer,
-		                                                      CAN_DATA_LENGTH,
-		                                                      myControlFunction.get(),
-		                                                      partnerControlFunction.get(),
-		                                                      CANIdentifier::PriorityLowest7);
+		return send_command(buffer);
 	}
 
 	bool VirtualTerminalClient::send_draw_closed_ellipse(std::uint16_t objectID, std::uint16_t width, std::uint16_t height)
@@ -917,12 +821,7 @@ namespace isobus
 			                                             static_cast<std::uint8_t>(width >> 8),
 			                                             static_cast<std::uint8_t>(height & 0xFF),
 			                                             static_cast<std::uint8_t>(height >> 8) };
-		return CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
-		                                                      buffer,
-		                                                      CAN_DATA_LENGTH,
-		                                                      myControlFunction.get(),
-		                                                      partnerControlFunction.get(),
-		                                                      CANIdentifier::PriorityLowest7);
+		return send_command(buffer);
 	}
 
 	bool VirtualTerminalClient::send_draw_polygon(std::uint16_t objectID, std::uint8_t numberOfPoints, std::int16_t *listOfXOffsetsRelativeToCursor, std::int16_t *listOfYOffsetsRelativeToCursor)
@@ -934,7 +833,7 @@ namespace isobus
 		    (nullptr != listOfYOffsetsRelativeToCursor))
 
 		{
-			const std::uint16_t messageLength = (9 + (4 * numberOfPoints));
+			const std::uint16_t messageLength = (5 + (4 * numberOfPoints));
 			std::uint8_t *buffer = new std::uint8_t[messageLength];
 			buffer[0] = static_cast<std::uint8_t>(Function::GraphicsContextCommand);
 			buffer[1] = static_cast<std::uint8_t>(objectID & 0xFF);
@@ -943,17 +842,17 @@ namespace isobus
 			buffer[4] = numberOfPoints;
 			for (uint8_t i = 0; i < numberOfPoints; i++)
 			{
-				buffer[5 + i] = static_cast<std::uint8_t>(listOfXOffsetsRelativeToCursor[0] & 0xFF);
-				buffer[6 + i] = static_cast<std::uint8_t>((listOfXOffsetsRelativeToCursor[0] >> 8) & 0xFF);
-				buffer[7 + i] = static_cast<std::uint8_t>(listOfYOffsetsRelativeToCursor[0] & 0xFF);
-				buffer[8 + i] = static_cast<std::uint8_t>((listOfYOffsetsRelativeToCursor[0] >> 8) & 0xFF);
-			}
-			retVal = CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
-			                                                        buffer,
-			                                                        messageLength,
-			                                                        myControlFunction.get(),
-			                                                        partnerControlFunction.get(),
-			                                                        CANIdentifier::PriorityLowest7);
+				buffer[5 + (4 * i)] = static_cast<std::uint8_t>(listOfXOffsetsRelativeToCursor[i] & 0xFF);
+				buffer[6 + (4 * i)] = static_cast<std::uint8_t>((listOfXOffsetsRelativeToCursor[i] >> 8) & 0xFF);
+				buffer[7 + (4 * i)] = static_cast<std::uint8_t>(listOfYOffsetsRelativeToCursor[i] & 0xFF);
+				buffer[8 + (4 * i)] = static_cast<std::uint8_t>((listOfYOffsetsRelativeToCursor[i] >> 8) & 0xFF);
+			}
+			retVal = get_network_manager().send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
+			                                                buffer,
+			                                                messageLength,
+			                                                myControlFunction.get(),
+			                                                partnerControlFunction.get(),
+			                                                CANIdentifier::PriorityLowest7);
 			delete[] buffer;
 		}
 		return retVal;
@@ -974,13 +873,13 @@ namespace isobus
 			buffer[3] = static_cast<std::uint8_t>(GraphicsContextSubCommandID::DrawText);
 			buffer[4] = static_cast<std::uint8_t>(transparent);
 			buffer[5] = textLength;
-			memcpy(buffer, value, textLength);
-			retVal = CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
-			                                                        buffer,
-			                                                        messageLength,
-			                                                        myControlFunction.get(),
-			                                                        partnerControlFunction.get(),
-			                                                        CANIdentifier::PriorityLowest7);
+			memcpy(&buffer[6], value, textLength);
+			retVal = get_network_manager().send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
+			                                                buffer,
+			                                                messageLength,
+			                                                myControlFunction.get(),
+			                                                partnerControlFunction.get(),
+			                                                CANIdentifier::PriorityLowest7);
 			delete[] buffer;
 		}
 		return retVal;
@@ -996,12 +895,7 @@ namespace isobus
 			                                             static_cast<std::uint8_t>(xAttribute >> 8),
 			                                             static_cast<std::uint8_t>(yAttribute & 0xFF),
 			                                             static_cast<std::uint8_t>(yAttribute >> 8) };
-		return CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
-		                                                      buffer,
-		                                                      CAN_DATA_LENGTH,
-		                                                      myControlFunction.get(),
-		                                                      partnerControlFunction.get(),
-		                                                      CANIdentifier::PriorityLowest7);
+		return send_command(buffer);
 	}
 
 	bool VirtualTerminalClient::send_zoom_viewport(std::uint16_t objectID, float zoom)
@@ -1021,12 +915,7 @@ namespace isobus
 			                                             floatToBytesBuffer[1],
 			                                             floatToBytesBuffer[2],
 			                                             floatToBytesBuffer[3] };
-		return CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
-		                                                      buffer,
-		                                                      CAN_DATA_LENGTH,
-		                                                      myControlFunction.get(),
-		                                                      partnerControlFunction.get(),
-		                                                      CANIdentifier::PriorityLowest7);
+		return send_command(buffer);
 	}
 
 	bool VirtualTerminalClient::send_pan_and_zoom_viewport(std::uint16_t objectID, std::int16_t xAttribute, std::int16_t yAttribute, float zoom)
@@ -1050,12 +939,12 @@ namespace isobus
 			                                floatToBytesBuffer[1],
 			                                floatToBytesBuffer[2],
 			                                floatToBytesBuffer[3] };
-		return CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
-		                                                      buffer,
-		                                                      12,
-		                                                      myControlFunction.get(),
-		                                                      partnerControlFunction.get(),
-		                                                      CANIdentifier::PriorityLowest7);
+		return get_network_manager().send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
+		                                              buffer,
+		                                              12,
+		                                              myControlFunction.get(),
+		                                              partnerControlFunction.get(),
+		                                              CANIdentifier::PriorityLowest7);
 	}
 
 	bool VirtualTerminalClient::send_change_viewport_size(std::uint16_t objectID, std::uint16_t width, std::uint16_t height)
@@ -1074,12 +963,12 @@ namespace isobus
 				                                             static_cast<std::uint8_t>(width >> 8),
 				                                             static_cast<std::uint8_t>(height & 0xFF),
 				                                             static_cast<std::uint8_t>(height >> 8) };
-			retVal = CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
-			                                                        buffer,
-			                                                        CAN_DATA_LENGTH,
-			                                                        myControlFunction.get(),
-			                                                        partnerControlFunction.get(),
-			                                                        CANIdentifier::PriorityLowest7);
+			retVal = get_network_manager().send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
+			                                                buffer,
+			                                                CAN_DATA_LENGTH,
+			                                                myControlFunction.get(),
+			                                                partnerControlFunction.get(),
+			                                                CANIdentifier::PriorityLowest7);
 		}
 		return retVal;
 	}
@@ -1094,12 +983,7 @@ namespace isobus
 			                                             static_cast<std::uint8_t>(objectID >> 8),
 			                                             0xFF,
 			                                             0xFF };
-		return CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
-		                                                      buffer,
-		                                                      CAN_DATA_LENGTH,
-		                                                      myControlFunction.get(),
-		                                                      partnerControlFunction.get(),
-		                                                      CANIdentifier::PriorityLowest7);
+		return send_command(buffer);
 	}
 
 	bool VirtualTerminalClient::send_copy_canvas_to_picture_graphic(std::uint16_t graphicsContextObjectID, std::uint16_t objectID)
@@ -1112,12 +996,7 @@ namespace isobus
 			                                             static_cast<std::uint8_t>(objectID >> 8),
 			                                             0xFF,
 			                                             0xFF };
-		return CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
-		                                                      buffer,
-		                                                      CAN_DATA_LENGTH,
-		                                                      myControlFunction.get(),
-		                                                      partnerControlFunction.get(),
-		                                                      CANIdentifier::PriorityLowest7);
+		return send_command(buffer);
 	}
 
 	bool VirtualTerminalClient::send_copy_viewport_to_picture_graphic(std::uint16_t graphicsContextObjectID, std::uint16_t objectID)
@@ -1130,12 +1009,360 @@ namespace isobus
 			                                             static_cast<std::uint8_t>(objectID >> 8),
 			                                             0xFF,
 			                                             0xFF };
-		return CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
-		                                                      buffer,
-		                                                      CAN_DATA_LENGTH,
-		                                                      myControlFunction.get(),
-		                                                      partnerControlFunction.get(),
-		                                                      CANIdentifier::PriorityLowest7);
+		return send_command(buffer);
+	}
+
+	VirtualTerminalClient::GraphicsContextBatch::GraphicsContextBatch(std::uint16_t graphicsContextObjectID) :
+	  cursorX(0),
+	  cursorY(0),
+	  objectID(graphicsContextObjectID),
+	  cursorOperation(CursorOperation::None)
+	{
+		attributes.fill(static_cast<std::uint32_t>(UNKNOWN_ATTRIBUTE));
+		sentAttributes.fill(static_cast<std::uint32_t>(UNKNOWN_ATTRIBUTE));
+	}
+
+	std::uint16_t VirtualTerminalClient::GraphicsContextBatch::get_object_id() const
+	{
+		return objectID;
+	}
+
+	void VirtualTerminalClient::GraphicsContextBatch::clear()
+	{
+		clear_messages();
+		lineOffsets.clear();
+		attributes.fill(static_cast<std::uint32_t>(UNKNOWN_ATTRIBUTE));
+		sentAttributes.fill(static_cast<std::uint32_t>(UNKNOWN_ATTRIBUTE));
+		cursorX = 0;
+		cursorY = 0;
+		cursorOperation = CursorOperation::None;
+	}
+
+	void VirtualTerminalClient::GraphicsContextBatch::set_cursor(std::int16_t xPosition, std::int16_t yPosition)
+	{
+		// Nothing was drawn since the last cursor operation, so it can be dropped
+		cursorX = xPosition;
+		cursorY = yPosition;
+		cursorOperation = CursorOperation::Set;
+	}
+
+	void VirtualTerminalClient::GraphicsContextBatch::move_cursor(std::int16_t xOffset, std::int16_t yOffset)
+	{
+		std::int32_t x = xOffset;
+		std::int32_t y = yOffset;
+
+		if (CursorOperation::None == cursorOperation)
+		{
+			cursorOperation = CursorOperation::Move;
+		}
+		else
+		{
+			x += cursorX;
+			y += cursorY;
+
+			if ((x < std::numeric_limits<std::int16_t>::min()) ||
+			    (x > std::numeric_limits<std::int16_t>::max()) ||
+			    (y < std::numeric_limits<std::int16_t>::min()) ||
+			    (y > std::numeric_limits<std::int16_t>::max()))
+			{
+				// The combined operation doesn't fit in one command, so send what there is so far
+				flush_lines();
+				flush_cursor();
+				x = xOffset;
+				y = yOffset;
+				cursorOperation = CursorOperation::Move;
+			}
+		}
+		cursorX = x;
+		cursorY = y;
+	}
+
+	void VirtualTerminalClient::GraphicsContextBatch::set_foreground_colour(std::uint8_t colour)
+	{
+		set_attribute(Attribute::ForegroundColour, colour);
+	}
+
+	void VirtualTerminalClient::GraphicsContextBatch::set_background_colour(std::uint8_t colour)
+	{
+		set_attribute(Attribute::BackgroundColour, colour);
+	}
+
+	void VirtualTerminalClient::GraphicsContextBatch::set_line_attributes(std::uint16_t objectID)
+	{
+		set_attribute(Attribute::LineAttributes, objectID);
+	}
+
+	void VirtualTerminalClient::GraphicsContextBatch::set_fill_attributes(std::uint16_t objectID)
+	{
+		set_attribute(Attribute::FillAttributes, objectID);
+	}
+
+	void VirtualTerminalClient::GraphicsContextBatch::set_font_attributes(std::uint16_t objectID)
+	{
+		set_attribute(Attribute::FontAttributes, objectID);
+	}
+
+	void VirtualTerminalClient::GraphicsContextBatch::erase_rectangle(std::uint16_t width, std::uint16_t height)
+	{
+		begin_drawing();
+		add_message(static_cast<std::uint8_t>(GraphicsContextSubCommandID::EraseRectangle), width, height);
+	}
+
+	void VirtualTerminalClient::GraphicsContextBatch::draw_point(std::int16_t xOffset, std::int16_t yOffset)
+	{
+		begin_drawing();
+		add_message(static_cast<std::uint8_t>(GraphicsContextSubCommandID::DrawPoint), static_cast<std::uint16_t>(xOffset), static_cast<std::uint16_t>(yOffset));
+	}
+
+	void VirtualTerminalClient::GraphicsContextBatch::draw_line(std::int16_t xOffset, std::int16_t yOffset)
+	{
+		const std::uint32_t lineAttributes = sentAttributes[static_cast<std::size_t>(Attribute::LineAttributes)];
+		std::int32_t x = xOffset;
+		std::int32_t y = yOffset;
+		bool canMerge = false;
+
+		// A polygon's border is only drawn when a line attributes object is set, unlike a line
+		if ((!lineOffsets.empty()) &&
+		    (lineOffsets.size() < (2 * MAX_POLYGON_POINTS)) &&
+		    (CursorOperation::None == cursorOperation) &&
+		    (attributes == sentAttributes) &&
+		    (UNKNOWN_ATTRIBUTE != lineAttributes) &&
+		    (NULL_OBJECT_ID != lineAttributes))
+		{
+			// Polygon points are relative to where the first line of the run started
+			x += lineOffsets[lineOffsets.size() - 2];
+			y += lineOffsets[lineOffsets.size() - 1];
+
+			// A polygon that ends where it started is closed and filled, which a run of lines is not
+			canMerge = ((x >= std::numeric_limits<std::int16_t>::min()) &&
+			            (x <= std::numeric_limits<std::int16_t>::max()) &&
+			            (y >= std::numeric_limits<std::int16_t>::min()) &&
+			            (y <= std::numeric_limits<std::int16_t>::max()) &&
+			            ((0 != x) || (0 != y)));
+		}
+
+		if (!canMerge)
+		{
+			begin_drawing();
+			x = xOffset;
+			y = yOffset;
+		}
+		lineOffsets.push_back(static_cast<std::int16_t>(x));
+		lineOffsets.push_back(static_cast<std::int16_t>(y));
+	}
+
+	void VirtualTerminalClient::GraphicsContextBatch::draw_rectangle(std::uint16_t width, std::uint16_t height)
+	{
+		begin_drawing();
+		add_message(static_cast<std::uint8_t>(GraphicsContextSubCommandID::DrawRectangle), width, height);
+	}
+
+	void VirtualTerminalClient::GraphicsContextBatch::draw_closed_ellipse(std::uint16_t width, std::uint16_t height)
+	{
+		begin_drawing();
+		add_message(static_cast<std::uint8_t>(GraphicsContextSubCommandID::DrawClosedEllipse), width, height);
+	}
+
+	bool VirtualTerminalClient::GraphicsContextBatch::draw_text(bool transparent, std::uint8_t textLength, const char *value)
+	{
+		bool retVal = false;
+
+		if ((nullptr != value) &&
+		    (0 != textLength))
+		{
+			begin_drawing();
+			const std::uint32_t messageOffset = begin_message(static_cast<std::uint8_t>(GraphicsContextSubCommandID::DrawText));
+			messageData.push_back(static_cast<std::uint8_t>(transparent));
+			messageData.push_back(textLength);
+			messageData.insert(messageData.end(), reinterpret_cast<const std::uint8_t *>(value), reinterpret_cast<const std::uint8_t *>(value) + textLength);
+			end_message(messageOffset);
+			retVal = true;
+		}
+		return retVal;
+	}
+
+	void VirtualTerminalClient::GraphicsContextBatch::flush()
+	{
+		flush_lines();
+		flush_attributes();
+		flush_cursor();
+	}
+
+	std::uint32_t VirtualTerminalClient::GraphicsContextBatch::get_number_messages() const
+	{
+		return static_cast<std::uint32_t>(messageLengths.size());
+	}
+
+	bool VirtualTerminalClient::GraphicsContextBatch::get_message(std::uint32_t index, std::vector<std::uint8_t> &message) const
+	{
+		bool retVal = false;
+
+		if (index < messageLengths.size())
+		{
+			std::uint32_t messageOffset = 0;
+
+			for (std::uint32_t i = 0; i < index; i++)
+			{
+				messageOffset += messageLengths[i];
+			}
+			message.assign(messageData.begin() + messageOffset, messageData.begin() + messageOffset + messageLengths[index]);
+			retVal = true;
+		}
+		return retVal;
+	}
+
+	void VirtualTerminalClient::GraphicsContextBatch::set_attribute(Attribute attribute, std::uint32_t value)
+	{
+		attributes[static_cast<std::size_t>(attribute)] = value;
+	}
+
+	void VirtualTerminalClient::GraphicsContextBatch::begin_drawing()
+	{
+		// Pending lines were recorded before any pending attribute or cursor changes, so they go first
+		flush_lines();
+		flush_attributes();
+		flush_cursor();
+	}
+
+	void VirtualTerminalClient::GraphicsContextBatch::flush_lines()
+	{
+		if (2 == lineOffsets.size())
+		{
+			add_message(static_cast<std::uint8_t>(GraphicsContextSubCommandID::DrawLine), static_cast<std::uint16_t>(lineOffsets[0]), static_cast<std::uint16_t>(lineOffsets[1]));
+		}
+		else if (!lineOffsets.empty())
+		{
+			const std::uint32_t messageOffset = begin_message(static_cast<std::uint8_t>(GraphicsContextSubCommandID::DrawPolygon));
+
+			messageData.push_back(static_cast<std::uint8_t>(lineOffsets.size() / 2));
+			for (const std::int16_t offset : lineOffsets)
+			{
+				messageData.push_back(static_cast<std::uint8_t>(offset & 0xFF));
+				messageData.push_back(static_cast<std::uint8_t>((offset >> 8) & 0xFF));
+			}
+			end_message(messageOffset);
+		}
+		lineOffsets.clear();
+	}
+
+	void VirtualTerminalClient::GraphicsContextBatch::flush_attributes()
+	{
+		constexpr GraphicsContextSubCommandID SUB_COMMANDS[] = { GraphicsContextSubCommandID::SetForegroundColor,
+			                                                     GraphicsContextSubCommandID::SetBackgroundColor,
+			                                                     GraphicsContextSubCommandID::SetLineAttributesObjectID,
+			                                                     GraphicsContextSubCommandID::SetFillAttributesObjectID,
+			                                                     GraphicsContextSubCommandID::SetFontAttributesObjectID };
+
+		for (std::size_t i = 0; i < attributes.size(); i++)
+		{
+			if (attributes[i] != sentAttributes[i])
+			{
+				const std::uint32_t messageOffset = begin_message(static_cast<std::uint8_t>(SUB_COMMANDS[i]));
+
+				messageData.push_back(static_cast<std::uint8_t>(attributes[i] & 0xFF));
+				if (i >= static_cast<std::size_t>(Attribute::LineAttributes))
+				{
+					messageData.push_back(static_cast<std::uint8_t>((attributes[i] >> 8) & 0xFF));
+				}
+				end_message(messageOffset);
+				sentAttributes[i] = attributes[i];
+			}
+		}
+	}
+
+	void VirtualTerminalClient::GraphicsContextBatch::flush_cursor()
+	{
+		if (CursorOperation::Set == cursorOperation)
+		{
+			add_message(static_cast<std::uint8_t>(GraphicsContextSubCommandID::SetGraphicsCursor), static_cast<std::uint16_t>(cursorX), static_cast<std::uint16_t>(cursorY));
+		}
+		else if ((CursorOperation::Move == cursorOperation) &&
+		         ((0 != cursorX) || (0 != cursorY)))
+		{
+			add_message(static_cast<std::uint8_t>(GraphicsContextSubCommandID::MoveGraphicsCursor), static_cast<std::uint16_t>(cursorX), static_cast<std::uint16_t>(cursorY));
+		}
+		cursorX = 0;
+		cursorY = 0;
+		cursorOperation = CursorOperation::None;
+	}
+
+	std::uint32_t VirtualTerminalClient::GraphicsContextBatch::begin_message(std::uint8_t subCommand)
+	{
+		const std::uint32_t retVal = static_cast<std::uint32_t>(messageData.size());
+
+		messageData.push_back(static_cast<std::uint8_t>(Function::GraphicsContextCommand));
+		messageData.push_back(static_cast<std::uint8_t>(objectID & 0xFF));
+		messageData.push_back(static_cast<std::uint8_t>(objectID >> 8));
+		messageData.push_back(subCommand);
+		return retVal;
+	}
+
+	void VirtualTerminalClient::GraphicsContextBatch::end_message(std::uint32_t messageOffset)
+	{
+		if ((messageData.size() - messageOffset) < CAN_DATA_LENGTH)
+		{
+			messageData.resize(messageOffset + CAN_DATA_LENGTH, 0xFF);
+		}
+		messageLengths.push_back(static_cast<std::uint16_t>(messageData.size() - messageOffset));
+	}
+
+	void VirtualTerminalClient::GraphicsContextBatch::add_message(std::uint8_t subCommand, std::uint16_t first, std::uint16_t second)
+	{
+		const std::uint32_t messageOffset = begin_message(subCommand);
+
+		messageData.push_back(static_cast<std::uint8_t>(first & 0xFF));
+		messageData.push_back(static_cast<std::uint8_t>(first >> 8));
+		messageData.push_back(static_cast<std::uint8_t>(second & 0xFF));
+		messageData.push_back(static_cast<std::uint8_t>(second >> 8));
+		end_message(messageOffset);
+	}
+
+	void VirtualTerminalClient::GraphicsContextBatch::clear_messages()
+	{
+		messageData.clear();
+		messageLengths.clear();
+	}
+
+	bool VirtualTerminalClient::send_graphics_context_batch(GraphicsContextBatch &batch)
+	{
+		const VTVersion version = get_connected_vt_version();
+		bool retVal = false;
+
+		if ((VTVersion::Version4 == version) ||
+		    (VTVersion::Version5 == version) ||
+		    (VTVersion::Version6 == version))
+		{
+			batch.flush();
+
+			if (!batch.messageLengths.empty())
+			{
+				const std::lock_guard<std::mutex> lock(graphicsBatchMutex);
+
+				// Drop the messages that were already sent so the queue doesn't keep growing
+				graphicsBatchData.erase(graphicsBatchData.begin(), graphicsBatchData.begin() + graphicsBatchDataOffset);
+				graphicsBatchLengths.erase(graphicsBatchLengths.begin(), graphicsBatchLengths.begin() + graphicsBatchIndex);
+				graphicsBatchDataOffset = 0;
+				graphicsBatchIndex = 0;
+
+				if ((graphicsBatchData.size() + batch.messageData.size()) <= MAX_GRAPHICS_BATCH_QUEUE_BYTES)
+				{
+					graphicsBatchData.insert(graphicsBatchData.end(), batch.messageData.begin(), batch.messageData.end());
+					graphicsBatchLengths.insert(graphicsBatchLengths.end(), batch.messageLengths.begin(), batch.messageLengths.end());
+					batch.clear_messages();
+					retVal = true;
+				}
+			}
+			else
+			{
+				retVal = true;
+			}
+		}
+
+		if (retVal)
+		{
+			process_graphics_batch_queue();
+		}
+		return retVal;
 	}
 
 	bool VirtualTerminalClient::send_get_attribute_value(std::uint16_t objectID, std::uint8_t attributeID)
@@ -1148,12 +1375,7 @@ namespace isobus
 			                                             0xFF,
 			                                             0xFF,
 			                                             0xFF };
-		return CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
-		                                                      buffer,
-		                                                      CAN_DATA_LENGTH,
-		                                                      myControlFunction.get(),
-		                                                      partnerControlFunction.get(),
-		                                                      CANIdentifier::PriorityLowest7);
+		return send_command(buffer);
 	}
 
 	std::uint8_t VirtualTerminalClient::get_softkey_x_axis_pixels() const
@@ -1339,6 +1561,9 @@ namespace isobus
 				objectPools.resize(poolIndex + 1);
 				objectPools[poolIndex] = tempData;
 			}
+			objectPoolVersionLabelValid = false;
+			index_object_pool(poolIndex, pool, size);
+			wake_worker_thread();
 		}
 	}
 
@@ -1366,6 +1591,44 @@ namespace isobus
 				objectPools.resize(poolIndex + 1);
 				objectPools[poolIndex] = tempData;
 			}
+			objectPoolVersionLabelValid = false;
+			index_object_pool(poolIndex, pool->data(), static_cast<std::uint32_t>(pool->size()));
+			wake_worker_thread();
+		}
+	}
+
+	void VirtualTerminalClient::set_object_pool(std::uint8_t poolIndex, VTVersion poolSupportedVTVersion, std::shared_ptr<const ObjectPoolImage> image)
+	{
+		if ((nullptr != image) &&
+		    (0 != image->get_size()))
+		{
+			ObjectPoolDataStruct tempData;
+
+			tempData.objectPoolDataPointer = image->get_data();
+			tempData.objectPoolVectorPointer = nullptr;
+			tempData.dataCallback = nullptr;
+			tempData.objectPoolSize = image->get_size();
+			tempData.version = poolSupportedVTVersion;
+			tempData.useDataCallback = false;
+			tempData.uploaded = false;
+			tempData.image = image;
+
+			if (poolIndex < objectPools.size())
+			{
+				objectPools[poolIndex] = tempData;
+			}
+			else
+			{
+				objectPools.resize(poolIndex + 1);
+				objectPools[poolIndex] = tempData;
+			}
+			objectPoolVersionLabelValid = false;
+
+			if (!image->get_is_valid())
+			{
+				CANStackLogger::error("[VT]: Object pool ", static_cast<int>(poolIndex), " is invalid at offset ", image->get_index().get_error_offset(), ", error ", static_cast<int>(image->get_index().get_parse_result()));
+			}
+			wake_worker_thread();
 		}
 	}
 
@@ -1393,31 +1656,79 @@ namespace isobus
 				objectPools.resize(poolIndex + 1);
 				objectPools[poolIndex] = tempData;
 			}
+			objectPoolVersionLabelValid = false;
+			wake_worker_thread();
 		}
 	}
 
-	void VirtualTerminalClient::update()
+	bool VirtualTerminalClient::get_object_info(std::uint16_t objectID, std::uint8_t &poolIndex, ObjectPoolIndex::ObjectInfo &info) const
 	{
-		if (nullptr != partnerControlFunction)
+		bool retVal = false;
+
+		for (std::uint32_t i = 0; (i < objectPools.size()) && (!retVal); i++)
 		{
-			switch (state)
+			if (get_object_pool_index(i).get_object_info(objectID, info))
 			{
-				case StateMachineState::Disconnected:
-				{
-					sendWorkingSetMaintenenace = false;
-					if (partnerControlFunction->get_address_valid())
-					{
-						set_state(StateMachineState::WaitForPartnerVTStatusMessage);
-					}
-				}
-				break;
+				poolIndex = static_cast<std::uint8_t>(i);
+				retVal = true;
+			}
+		}
+		return retVal;
+	}
 
-				case StateMachineState::WaitForPartnerVTStatusMessage:
-				{
-					if (0 != lastVTStatusTimestamp_ms)
-					{
-						set_state(StateMachineState::SendWorkingSetMasterMessage);
-					}
+	void VirtualTerminalClient::set_object_pool_version_caching(bool value)
+	{
+		objectPoolVersionCaching = value;
+	}
+
+	bool VirtualTerminalClient::get_object_pool_version_caching() const
+	{
+		return objectPoolVersionCaching;
+	}
+
+	float VirtualTerminalClient::get_object_pool_upload_progress_percent() const
+	{
+		float retVal = 0.0f;
+
+		if (StateMachineState::Connected == state)
+		{
+			retVal = 100.0f;
+		}
+		else if ((0 != objectPoolSize_bytes) &&
+		         (StateMachineState::UploadObjectPool <= state))
+		{
+			retVal = ((100.0f * (objectPoolUploadedBytes + currentObjectPoolUploadedBytes)) / objectPoolSize_bytes);
+
+			if (retVal > 100.0f)
+			{
+				retVal = 100.0f;
+			}
+		}
+		return retVal;
+	}
+
+	void VirtualTerminalClient::update()
+	{
+		if (nullptr != partnerControlFunction)
+		{
+			switch (state)
+			{
+				case StateMachineState::Disconnected:
+				{
+					sendWorkingSetMaintenenace = false;
+					if (partnerControlFunction->get_address_valid())
+					{
+						set_state(StateMachineState::WaitForPartnerVTStatusMessage);
+					}
+				}
+				break;
+
+				case StateMachineState::WaitForPartnerVTStatusMessage:
+				{
+					if (0 != lastVTStatusTimestamp_ms)
+					{
+						set_state(StateMachineState::SendWorkingSetMasterMessage);
+					}
 				}
 				break;
 
@@ -1454,13 +1765,19 @@ namespace isobus
 				{
 					std::uint32_t totalPoolSize = 0;
 
-					for (auto pool : objectPools)
+					for (const auto &pool : objectPools)
 					{
 						totalPoolSize += pool.objectPoolSize;
 					}
 
-					if (send_get_memory(totalPoolSize))
+					if (!get_are_object_pools_valid())
+					{
+						set_state(StateMachineState::Failed);
+						CANStackLogger::error("[VT]: Not uploading the object pool because it is invalid");
+					}
+					else if (send_get_memory(totalPoolSize))
 					{
+						objectPoolSize_bytes = totalPoolSize;
 						set_state(StateMachineState::WaitForGetMemoryResponse);
 					}
 				}
@@ -1471,7 +1788,7 @@ namespace isobus
 					if (SystemTiming::time_expired_ms(stateMachineTimestamp_ms, VT_STATUS_TIMEOUT_MS))
 					{
 						set_state(StateMachineState::Failed);
-						CANStackLogger::CAN_stack_log("[VT]: Get Memory Response Timout");
+						CANStackLogger::warn("[VT]: Get Memory Response Timout");
 					}
 				}
 				break;
@@ -1490,7 +1807,7 @@ namespace isobus
 					if (SystemTiming::time_expired_ms(stateMachineTimestamp_ms, VT_STATUS_TIMEOUT_MS))
 					{
 						set_state(StateMachineState::Failed);
-						CANStackLogger::CAN_stack_log("[VT]: Get Number Softkeys Response Timout");
+						CANStackLogger::warn("[VT]: Get Number Softkeys Response Timout");
 					}
 				}
 				break;
@@ -1509,7 +1826,7 @@ namespace isobus
 					if (SystemTiming::time_expired_ms(stateMachineTimestamp_ms, VT_STATUS_TIMEOUT_MS))
 					{
 						set_state(StateMachineState::Failed);
-						CANStackLogger::CAN_stack_log("[VT]: Get Text Font Data Response Timout");
+						CANStackLogger::warn("[VT]: Get Text Font Data Response Timout");
 					}
 				}
 				break;
@@ -1528,44 +1845,93 @@ namespace isobus
 					if (SystemTiming::time_expired_ms(stateMachineTimestamp_ms, VT_STATUS_TIMEOUT_MS))
 					{
 						set_state(StateMachineState::Failed);
-						CANStackLogger::CAN_stack_log("[VT]: Get Hardware Response Timout");
+						CANStackLogger::warn("[VT]: Get Hardware Response Timout");
 					}
 				}
 				break;
 
-				case StateMachineState::UploadObjectPool:
+				case StateMachineState::SendLoadVersion:
 				{
-					//! @todo Support callback method with ETP
-					//! Right now only full TP sends are supported until I finish ETP
-					//! So this will fail if you have a pool > 1785 bytes unless you
-					//! split it up into subpools
+					std::array<std::uint8_t, 7> versionLabel;
 
+					if (!get_object_pool_version_label(versionLabel))
+					{
+						CANStackLogger::warn("[VT]: Unable to hash the object pool, uploading it instead");
+						set_state(StateMachineState::UploadObjectPool);
+					}
+					else if (send_load_version(versionLabel))
+					{
+						set_state(StateMachineState::WaitForLoadVersionResponse);
+					}
+				}
+				break;
+
+				case StateMachineState::WaitForLoadVersionResponse:
+				{
+					if (SystemTiming::time_expired_ms(stateMachineTimestamp_ms, VT_STATUS_TIMEOUT_MS))
+					{
+						CANStackLogger::warn("[VT]: Load Version Response Timeout, uploading the object pool instead");
+						set_state(StateMachineState::UploadObjectPool);
+					}
+				}
+				break;
+
+				case StateMachineState::UploadObjectPool:
+				{
 					bool allPoolsProcessed = true;
 
+					// Pools are sent one at a time, each in its own object pool transfer message.
+					// Pools that are already on the VT stay there if a later one has to be retried.
 					for (std::uint32_t i = 0; i < objectPools.size(); i++)
 					{
-						if ((nullptr != objectPools[i].objectPoolDataPointer) &&
-						    (objectPools[i].objectPoolSize > 0) &&
-						    (!objectPools[i].useDataCallback))
+						if ((objectPools[i].objectPoolSize > 0) &&
+						    (!objectPools[i].uploaded))
 						{
-							if (!objectPools[i].uploaded)
+							if (CurrentObjectPoolUploadState::Success == currentObjectPoolState)
 							{
-								allPoolsProcessed = false;
+								objectPools[i].uploaded = true;
+								objectPoolUploadedBytes += objectPools[i].objectPoolSize;
+								currentObjectPoolUploadedBytes = 0;
+								objectPoolUploadAttempts = 0;
+								currentObjectPoolState = CurrentObjectPoolUploadState::Uninitialized;
+								// Move on to the next pool
 							}
-
-							if (CurrentObjectPoolUploadState::Uninitialized == currentObjectPoolState)
+							else
 							{
-								if (!objectPools[i].uploaded)
+								allPoolsProcessed = false;
+
+								if (CurrentObjectPoolUploadState::Failed == currentObjectPoolState)
+								{
+									objectPoolUploadAttempts++;
+									currentObjectPoolState = CurrentObjectPoolUploadState::Uninitialized;
+									objectPoolUploadRetryTimestamp_ms = SystemTiming::get_timestamp_ms();
+
+									if (objectPoolUploadAttempts >= MAX_OBJECT_POOL_UPLOAD_ATTEMPTS)
+									{
+										CANStackLogger::error("[VT]: Object pool ", i, " upload failed too many times");
+										set_state(StateMachineState::Failed);
+									}
+									else
+									{
+										CANStackLogger::warn("[VT]: Object pool ", i, " upload was aborted, retrying");
+									}
+								}
+								else if ((CurrentObjectPoolUploadState::Uninitialized == currentObjectPoolState) &&
+								         ((0 == objectPoolUploadAttempts) ||
+								          (SystemTiming::time_expired_ms(objectPoolUploadRetryTimestamp_ms, OBJECT_POOL_UPLOAD_RETRY_DELAY_MS))))
 								{
-									bool transmitSuccessful = CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
-									                                                                         nullptr,
-									                                                                         objectPools[i].objectPoolSize + 1, // Account for Mux byte
-									                                                                         myControlFunction.get(),
-									                                                                         partnerControlFunction.get(),
-									                                                                         CANIdentifier::CANPriority::PriorityLowest7,
-									                                                                         process_callback,
-									                                                                         this,
-									                                                                         process_internal_object_pool_upload_callback);
+									lastObjectPoolIndex = i;
+									currentObjectPoolUploadedBytes = 0;
+
+									bool transmitSuccessful = get_network_manager().send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
+									                                                                 nullptr,
+									                                                                 objectPools[i].objectPoolSize + 1, // Account for Mux byte
+									                                                                 myControlFunction.get(),
+									                                                                 partnerControlFunction.get(),
+									                                                                 CANIdentifier::CANPriority::PriorityLowest7,
+									                                                                 process_callback,
+									                                                                 this,
+									                                                                 process_internal_object_pool_upload_callback);
 									if (transmitSuccessful)
 									{
 										currentObjectPoolState = CurrentObjectPoolUploadState::InProgress;
@@ -1573,23 +1939,8 @@ namespace isobus
 								}
 								else
 								{
-									// Pool already uploaded, move on to the next one
+									// Transfer is in progress, or waiting to be retried. Nothing to do now.
 								}
-							}
-							else if (CurrentObjectPoolUploadState::Success == currentObjectPoolState)
-							{
-								objectPools[i].uploaded = true;
-								currentObjectPoolState = CurrentObjectPoolUploadState::Uninitialized;
-							}
-							else if (CurrentObjectPoolUploadState::Failed == currentObjectPoolState)
-							{
-								currentObjectPoolState = CurrentObjectPoolUploadState::Uninitialized;
-								// Retry this pool
-								//! @todo add a max number of retries
-							}
-							else
-							{
-								// Transfer is in progress. Nothing to do now.
 								break;
 							}
 						}
@@ -1616,7 +1967,33 @@ namespace isobus
 					if (SystemTiming::time_expired_ms(stateMachineTimestamp_ms, VT_STATUS_TIMEOUT_MS))
 					{
 						set_state(StateMachineState::Failed);
-						CANStackLogger::CAN_stack_log("[VT]: Get End of Object Pool Response Timout");
+						CANStackLogger::warn("[VT]: Get End of Object Pool Response Timout");
+					}
+				}
+				break;
+
+				case StateMachineState::SendStoreVersion:
+				{
+					std::array<std::uint8_t, 7> versionLabel;
+
+					if (!get_object_pool_version_label(versionLabel))
+					{
+						set_state(StateMachineState::Connected);
+					}
+					else if (send_store_version(versionLabel))
+					{
+						set_state(StateMachineState::WaitForStoreVersionResponse);
+					}
+				}
+				break;
+
+				case StateMachineState::WaitForStoreVersionResponse:
+				{
+					if (SystemTiming::time_expired_ms(stateMachineTimestamp_ms, VT_STATUS_TIMEOUT_MS))
+					{
+						// The pool is already active, so the worst case is that we upload it again next time
+						CANStackLogger::warn("[VT]: Store Version Response Timeout");
+						set_state(StateMachineState::Connected);
 					}
 				}
 				break;
@@ -1627,7 +2004,14 @@ namespace isobus
 					if (SystemTiming::time_expired_ms(lastVTStatusTimestamp_ms, VT_STATUS_TIMEOUT_MS))
 					{
 						set_state(StateMachineState::Disconnected);
-						CANStackLogger::CAN_stack_log("[VT]: Status Timout");
+						CANStackLogger::warn("[VT]: Status Timout");
+					}
+					else
+					{
+						process_object_pool_delta_replay();
+						process_command_queue();
+						process_string_value_queue();
+						process_graphics_batch_queue();
 					}
 				}
 				break;
@@ -1667,12 +2051,12 @@ namespace isobus
 			                                                 0xFF,
 			                                                 0xFF,
 			                                                 0xFF };
-		return CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
-		                                                      buffer,
-		                                                      CAN_DATA_LENGTH,
-		                                                      myControlFunction.get(),
-		                                                      partnerControlFunction.get(),
-		                                                      CANIdentifier::PriorityLowest7);
+		return get_network_manager().send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
+		                                              buffer,
+		                                              CAN_DATA_LENGTH,
+		                                              myControlFunction.get(),
+		                                              partnerControlFunction.get(),
+		                                              CANIdentifier::PriorityLowest7);
 	}
 
 	bool VirtualTerminalClient::send_working_set_maintenance(bool initializing, VTVersion workingSetVersion)
@@ -1721,12 +2105,12 @@ namespace isobus
 			                                             0xFF,
 			                                             0xFF,
 			                                             0xFF };
-		return CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
-		                                                      buffer,
-		                                                      CAN_DATA_LENGTH,
-		                                                      myControlFunction.get(),
-		                                                      partnerControlFunction.get(),
-		                                                      CANIdentifier::PriorityLowest7);
+		return get_network_manager().send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
+		                                              buffer,
+		                                              CAN_DATA_LENGTH,
+		                                              myControlFunction.get(),
+		                                              partnerControlFunction.get(),
+		                                              CANIdentifier::PriorityLowest7);
 	}
 
 	bool VirtualTerminalClient::send_get_memory(std::uint32_t requiredMemory)
@@ -1739,12 +2123,12 @@ namespace isobus
 			                                             static_cast<std::uint8_t>((requiredMemory >> 24) & 0xFF),
 			                                             0xFF,
 			                                             0xFF };
-		return CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
-		                                                      buffer,
-		                                                      CAN_DATA_LENGTH,
-		                                                      myControlFunction.get(),
-		                                                      partnerControlFunction.get(),
-		                                                      CANIdentifier::PriorityLowest7);
+		return get_network_manager().send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
+		                                              buffer,
+		                                              CAN_DATA_LENGTH,
+		                                              myControlFunction.get(),
+		                                              partnerControlFunction.get(),
+		                                              CANIdentifier::PriorityLowest7);
 	}
 
 	bool VirtualTerminalClient::send_get_number_of_softkeys()
@@ -1757,12 +2141,12 @@ namespace isobus
 			                                                 0xFF,
 			                                                 0xFF,
 			                                                 0xFF };
-		return CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
-		                                                      buffer,
-		                                                      CAN_DATA_LENGTH,
-		                                                      myControlFunction.get(),
-		                                                      partnerControlFunction.get(),
-		                                                      CANIdentifier::PriorityLowest7);
+		return get_network_manager().send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
+		                                              buffer,
+		                                              CAN_DATA_LENGTH,
+		                                              myControlFunction.get(),
+		                                              partnerControlFunction.get(),
+		                                              CANIdentifier::PriorityLowest7);
 	}
 
 	bool VirtualTerminalClient::send_get_text_font_data()
@@ -1775,12 +2159,12 @@ namespace isobus
 			                                                 0xFF,
 			                                                 0xFF,
 			                                                 0xFF };
-		return CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
-		                                                      buffer,
-		                                                      CAN_DATA_LENGTH,
-		                                                      myControlFunction.get(),
-		                                                      partnerControlFunction.get(),
-		                                                      CANIdentifier::PriorityLowest7);
+		return get_network_manager().send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
+		                                              buffer,
+		                                              CAN_DATA_LENGTH,
+		                                              myControlFunction.get(),
+		                                              partnerControlFunction.get(),
+		                                              CANIdentifier::PriorityLowest7);
 	}
 
 	bool VirtualTerminalClient::send_get_hardware()
@@ -1793,12 +2177,12 @@ namespace isobus
 			                                                 0xFF,
 			                                                 0xFF,
 			                                                 0xFF };
-		return CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
-		                                                      buffer,
-		                                                      CAN_DATA_LENGTH,
-		                                                      myControlFunction.get(),
-		                                                      partnerControlFunction.get(),
-		                                                      CANIdentifier::PriorityLowest7);
+		return get_network_manager().send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
+		                                              buffer,
+		                                              CAN_DATA_LENGTH,
+		                                              myControlFunction.get(),
+		                                              partnerControlFunction.get(),
+		                                              CANIdentifier::PriorityLowest7);
 	}
 
 	bool VirtualTerminalClient::send_get_supported_widechars()
@@ -1811,12 +2195,12 @@ namespace isobus
 			                                                 0xFF,
 			                                                 0xFF,
 			                                                 0xFF };
-		return CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
-		                                                      buffer,
-		                                                      CAN_DATA_LENGTH,
-		                                                      myControlFunction.get(),
-		                                                      partnerControlFunction.get(),
-		                                                      CANIdentifier::PriorityLowest7);
+		return get_network_manager().send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
+		                                              buffer,
+		                                              CAN_DATA_LENGTH,
+		                                              myControlFunction.get(),
+		                                              partnerControlFunction.get(),
+		                                              CANIdentifier::PriorityLowest7);
 	}
 
 	bool VirtualTerminalClient::send_get_window_mask_data()
@@ -1829,12 +2213,12 @@ namespace isobus
 			                                                 0xFF,
 			                                                 0xFF,
 			                                                 0xFF };
-		return CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
-		                                                      buffer,
-		                                                      CAN_DATA_LENGTH,
-		                                                      myControlFunction.get(),
-		                                                      partnerControlFunction.get(),
-		                                                      CANIdentifier::PriorityLowest7);
+		return get_network_manager().send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
+		                                              buffer,
+		                                              CAN_DATA_LENGTH,
+		                                              myControlFunction.get(),
+		                                              partnerControlFunction.get(),
+		                                              CANIdentifier::PriorityLowest7);
 	}
 
 	bool VirtualTerminalClient::send_get_supported_objects()
@@ -1847,12 +2231,12 @@ namespace isobus
 			                                                 0xFF,
 			                                                 0xFF,
 			                                                 0xFF };
-		return CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
-		                                                      buffer,
-		                                                      CAN_DATA_LENGTH,
-		                                                      myControlFunction.get(),
-		                                                      partnerControlFunction.get(),
-		                                                      CANIdentifier::PriorityLowest7);
+		return get_network_manager().send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
+		                                              buffer,
+		                                              CAN_DATA_LENGTH,
+		                                              myControlFunction.get(),
+		                                              partnerControlFunction.get(),
+		                                              CANIdentifier::PriorityLowest7);
 	}
 
 	bool VirtualTerminalClient::send_get_versions()
@@ -1865,12 +2249,12 @@ namespace isobus
 			                                                 0xFF,
 			                                                 0xFF,
 			                                                 0xFF };
-		return CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
-		                                                      buffer,
-		                                                      CAN_DATA_LENGTH,
-		                                                      myControlFunction.get(),
-		                                                      partnerControlFunction.get(),
-		                                                      CANIdentifier::PriorityLowest7);
+		return get_network_manager().send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
+		                                              buffer,
+		                                              CAN_DATA_LENGTH,
+		                                              myControlFunction.get(),
+		                                              partnerControlFunction.get(),
+		                                              CANIdentifier::PriorityLowest7);
 	}
 
 	bool VirtualTerminalClient::send_store_version(std::array<std::uint8_t, 7> versionLabel)
@@ -1883,12 +2267,12 @@ namespace isobus
 			                                             versionLabel[4],
 			                                             versionLabel[5],
 			                                             versionLabel[6] };
-		return CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
-		                                                      buffer,
-		                                                      CAN_DATA_LENGTH,
-		                                                      myControlFunction.get(),
-		                                                      partnerControlFunction.get(),
-		                                                      CANIdentifier::PriorityLowest7);
+		return get_network_manager().send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
+		                                              buffer,
+		                                              CAN_DATA_LENGTH,
+		                                              myControlFunction.get(),
+		                                              partnerControlFunction.get(),
+		                                              CANIdentifier::PriorityLowest7);
 	}
 
 	bool VirtualTerminalClient::send_load_version(std::array<std::uint8_t, 7> versionLabel)
@@ -1901,12 +2285,12 @@ namespace isobus
 			                                             versionLabel[4],
 			                                             versionLabel[5],
 			                                             versionLabel[6] };
-		return CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
-		                                                      buffer,
-		                                                      CAN_DATA_LENGTH,
-		                                                      myControlFunction.get(),
-		                                                      partnerControlFunction.get(),
-		                                                      CANIdentifier::PriorityLowest7);
+		return get_network_manager().send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
+		                                              buffer,
+		                                              CAN_DATA_LENGTH,
+		                                              myControlFunction.get(),
+		                                              partnerControlFunction.get(),
+		                                              CANIdentifier::PriorityLowest7);
 	}
 
 	bool VirtualTerminalClient::send_delete_version(std::array<std::uint8_t, 7> versionLabel)
@@ -1919,17 +2303,17 @@ namespace isobus
 			                                             versionLabel[4],
 			                                             versionLabel[5],
 			                                             versionLabel[6] };
-		return CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
-		                                                      buffer,
-		                                                      CAN_DATA_LENGTH,
-		                                                      myControlFunction.get(),
-		                                                      partnerControlFunction.get(),
-		                                                      CANIdentifier::PriorityLowest7);
+		return get_network_manager().send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
+		                                              buffer,
+		                                              CAN_DATA_LENGTH,
+		                                              myControlFunction.get(),
+		                                              partnerControlFunction.get(),
+		                                              CANIdentifier::PriorityLowest7);
 	}
 
 	bool VirtualTerminalClient::send_extended_get_versions()
 	{
-		const std::uint8_t buffer[CAN_DATA_LENGTH] = { static_cast<std::uint8_t>(Function::ExtendedDeleteVersionCommand),
+		const std::uint8_t buffer[CAN_DATA_LENGTH] = { static_cast<std::uint8_t>(Function::ExtendedGetVersionsMessage),
 			                                             0xFF,
 			                                             0xFF,
 			                                             0xFF,
@@ -1937,12 +2321,12 @@ namespace isobus
 			                                             0xFF,
 			                                             0xFF,
 			                                             0xFF };
-		return CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
-		                                                      buffer,
-		                                                      CAN_DATA_LENGTH,
-		                                                      myControlFunction.get(),
-		                                                      partnerControlFunction.get(),
-		                                                      CANIdentifier::PriorityLowest7);
+		return get_network_manager().send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
+		                                              buffer,
+		                                              CAN_DATA_LENGTH,
+		                                              myControlFunction.get(),
+		                                              partnerControlFunction.get(),
+		                                              CANIdentifier::PriorityLowest7);
 	}
 
 	bool VirtualTerminalClient::send_extended_store_version(std::array<std::uint8_t, 32> versionLabel)
@@ -1952,12 +2336,12 @@ namespace isobus
 		std::uint8_t *buffer = new std::uint8_t[33];
 		buffer[0] = static_cast<std::uint8_t>(Function::ExtendedStoreVersionCommand);
 		memcpy(&buffer[1], versionLabel.data(), 32);
-		retVal = CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
-		                                                        buffer,
-		                                                        33,
-		                                                        myControlFunction.get(),
-		                                                        partnerControlFunction.get(),
-		                                                        CANIdentifier::PriorityLowest7);
+		retVal = get_network_manager().send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
+		                                                buffer,
+		                                                33,
+		                                                myControlFunction.get(),
+		                                                partnerControlFunction.get(),
+		                                                CANIdentifier::PriorityLowest7);
 		delete[] buffer;
 		return retVal;
 	}
@@ -1969,12 +2353,12 @@ namespace isobus
 		std::uint8_t *buffer = new std::uint8_t[33];
 		buffer[0] = static_cast<std::uint8_t>(Function::ExtendedLoadVersionCommand);
 		memcpy(&buffer[1], versionLabel.data(), 32);
-		retVal = CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
-		                                                        buffer,
-		                                                        33,
-		                                                        myControlFunction.get(),
-		                                                        partnerControlFunction.get(),
-		                                                        CANIdentifier::PriorityLowest7);
+		retVal = get_network_manager().send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
+		                                                buffer,
+		                                                33,
+		                                                myControlFunction.get(),
+		                                                partnerControlFunction.get(),
+		                                                CANIdentifier::PriorityLowest7);
 		delete[] buffer;
 		return retVal;
 	}
@@ -1986,12 +2370,12 @@ namespace isobus
 		std::uint8_t *buffer = new std::uint8_t[33];
 		buffer[0] = static_cast<std::uint8_t>(Function::ExtendedDeleteVersionCommand);
 		memcpy(&buffer[1], versionLabel.data(), 32);
-		retVal = CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
-		                                                        buffer,
-		                                                        33,
-		                                                        myControlFunction.get(),
-		                                                        partnerControlFunction.get(),
-		                                                        CANIdentifier::PriorityLowest7);
+		retVal = get_network_manager().send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
+		                                                buffer,
+		                                                33,
+		                                                myControlFunction.get(),
+		                                                partnerControlFunction.get(),
+		                                                CANIdentifier::PriorityLowest7);
 		delete[] buffer;
 		return retVal;
 	}
@@ -2006,12 +2390,12 @@ namespace isobus
 			                                             0xFF,
 			                                             0xFF,
 			                                             0xFF };
-		return CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
-		                                                      buffer,
-		                                                      CAN_DATA_LENGTH,
-		                                                      myControlFunction.get(),
-		                                                      partnerControlFunction.get(),
-		                                                      CANIdentifier::PriorityLowest7);
+		return get_network_manager().send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
+		                                              buffer,
+		                                              CAN_DATA_LENGTH,
+		                                              myControlFunction.get(),
+		                                              partnerControlFunction.get(),
+		                                              CANIdentifier::PriorityLowest7);
 	}
 
 	bool VirtualTerminalClient::send_working_set_master()
@@ -2024,18 +2408,61 @@ namespace isobus
 			                                                 0xFF,
 			                                                 0xFF,
 			                                                 0xFF };
-		return CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::WorkingSetMaster),
-		                                                      buffer,
-		                                                      CAN_DATA_LENGTH,
-		                                                      myControlFunction.get(),
-		                                                      nullptr,
-		                                                      CANIdentifier::PriorityLowest7);
+		return get_network_manager().send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::WorkingSetMaster),
+		                                              buffer,
+		                                              CAN_DATA_LENGTH,
+		                                              myControlFunction.get(),
+		                                              nullptr,
+		                                              CANIdentifier::PriorityLowest7);
+	}
+
+	CANNetworkManager &VirtualTerminalClient::get_network_manager() const
+	{
+		CANNetworkManager *retVal = &CANNetworkManager::CANNetwork;
+
+		if (nullptr != myControlFunction)
+		{
+			retVal = &myControlFunction->get_network_manager();
+		}
+		return *retVal;
 	}
 
 	void VirtualTerminalClient::set_state(StateMachineState value)
 	{
+		const bool connecting = ((StateMachineState::Connected == value) && (StateMachineState::Connected != state));
+
 		stateMachineTimestamp_ms = SystemTiming::get_timestamp_ms();
 		state = value;
+
+		if (StateMachineState::Disconnected == value)
+		{
+			clear_command_queue();
+			clear_graphics_batch_queue();
+
+			if (objectPoolDeltaReplayEnabled)
+			{
+				requeue_string_values();
+			}
+			else
+			{
+				clear_string_values();
+			}
+		}
+		else if (connecting)
+		{
+			const std::lock_guard<std::mutex> lock(objectPoolDeltaMutex);
+
+			// The VT has just loaded the base pool, so every recorded change has to be made again
+			for (auto &delta : objectPoolDeltas)
+			{
+				delta.replayPending = true;
+			}
+			objectPoolDeltaReplayIndex = 0;
+			if (!objectPoolDeltas.empty())
+			{
+				CANStackLogger::info("[VT]: Restoring ", objectPoolDeltas.size(), " object pool changes");
+			}
+		}
 	}
 
 	void VirtualTerminalClient::process_button_event_callback(KeyActivationCode keyEvent, std::uint8_t keyNumber, std::uint16_t objectID, std::uint16_t parentObjectID, VirtualTerminalClient *parentPointer)
@@ -2123,9 +2550,10 @@ namespace isobus
 
 	void VirtualTerminalClient::process_rx_message(CANMessage *message, void *parentPointer)
 	{
+		// Change string value messages from the VT may be longer than a frame
 		if ((nullptr != message) &&
 		    (nullptr != parentPointer) &&
-		    (CAN_DATA_LENGTH == message->get_data_length()))
+		    (CAN_DATA_LENGTH <= message->get_data_length()))
 		{
 			VirtualTerminalClient *parentVT = reinterpret_cast<VirtualTerminalClient *>(parentPointer);
 
@@ -2135,6 +2563,9 @@ namespace isobus
 
 				case static_cast<std::uint32_t>(CANLibParameterGroupNumber::VirtualTerminalToECU):
 				{
+					parentVT->process_command_response(message->get_data().at(0));
+					parentVT->wake_worker_thread();
+
 					switch (message->get_data().at(0))
 					{
 						case static_cast<std::uint8_t>(Function::SoftKeyActivationMessage):
@@ -2207,6 +2638,15 @@ namespace isobus
 						}
 						break;
 
+						case static_cast<std::uint8_t>(Function::VTChangeStringValueMessage):
+						{
+							// The operator changed the value on the VT, so what we last sent is no longer what the VT shows
+							std::uint16_t objectID = (static_cast<std::uint16_t>(message->get_data()[1]) |
+							                          (static_cast<std::uint16_t>(message->get_data()[2]) << 8));
+							parentVT->invalidate_string_value(objectID);
+						}
+						break;
+
 						case static_cast<std::uint8_t>(Function::VTStatusMessage):
 						{
 							parentVT->lastVTStatusTimestamp_ms = SystemTiming::get_timestamp_ms();
@@ -2234,7 +2674,7 @@ namespace isobus
 								else
 								{
 									parentVT->set_state(StateMachineState::Failed);
-									CANStackLogger::CAN_stack_log("[VT]: Connection Failed Not Enough Memory");
+									CANStackLogger::error("[VT]: Connection Failed Not Enough Memory");
 								}
 							}
 						}
@@ -2279,7 +2719,62 @@ namespace isobus
 								parentVT->yPixels = (static_cast<std::uint16_t>(message->get_data()[6]) &
 								                     ((static_cast<std::uint16_t>(message->get_data()[7])) << 8));
 								parentVT->lastObjectPoolIndex = 0;
-								parentVT->set_state(StateMachineState::UploadObjectPool);
+								parentVT->objectPoolUploadedBytes = 0;
+								parentVT->currentObjectPoolUploadedBytes = 0;
+								parentVT->objectPoolUploadAttempts = 0;
+								parentVT->currentObjectPoolState = CurrentObjectPoolUploadState::Uninitialized;
+
+								for (auto &pool : parentVT->objectPools)
+								{
+									pool.uploaded = false;
+								}
+
+								if ((parentVT->objectPoolVersionCaching) &&
+								    (VTVersion::Version3 <= parentVT->get_connected_vt_version()) &&
+								    (VTVersion::ReservedOrUnknown != parentVT->get_connected_vt_version()))
+								{
+									parentVT->set_state(StateMachineState::SendLoadVersion);
+								}
+								else
+								{
+									parentVT->set_state(StateMachineState::UploadObjectPool);
+								}
+							}
+						}
+						break;
+
+						case static_cast<std::uint8_t>(Function::LoadVersionCommand):
+						{
+							if (StateMachineState::WaitForLoadVersionResponse == parentVT->state)
+							{
+								const std::uint8_t errorCodes = message->get_data()[5];
+
+								if (0 == errorCodes)
+								{
+									CANStackLogger::info("[VT]: Loaded object pool version stored on the VT");
+									parentVT->set_state(StateMachineState::Connected);
+								}
+								else
+								{
+									// Most likely the VT doesn't have this version, or it was lost
+									CANStackLogger::warn("[VT]: Load version failed with error code ", static_cast<int>(errorCodes), ", uploading the object pool");
+									parentVT->set_state(StateMachineState::UploadObjectPool);
+								}
+							}
+						}
+						break;
+
+						case static_cast<std::uint8_t>(Function::StoreVersionCommand):
+						{
+							if (StateMachineState::WaitForStoreVersionResponse == parentVT->state)
+							{
+								const std::uint8_t errorCodes = message->get_data()[5];
+
+								if (0 != errorCodes)
+								{
+									CANStackLogger::warn("[VT]: Store version failed with error code ", static_cast<int>(errorCodes));
+								}
+								parentVT->set_state(StateMachineState::Connected);
 							}
 						}
 						break;
@@ -2300,25 +2795,28 @@ namespace isobus
 								if ((!anyErrorInPool) &&
 								    (0 == objectPoolErrorBitmask))
 								{
-									parentVT->set_state(StateMachineState::Connected);
+									if ((parentVT->objectPoolVersionCaching) &&
+									    (VTVersion::Version3 <= parentVT->get_connected_vt_version()) &&
+									    (VTVersion::ReservedOrUnknown != parentVT->get_connected_vt_version()))
+									{
+										parentVT->set_state(StateMachineState::SendStoreVersion);
+									}
+									else
+									{
+										parentVT->set_state(StateMachineState::Connected);
+									}
 								}
 								else
 								{
 									parentVT->set_state(StateMachineState::Failed);
-									CANStackLogger::CAN_stack_log("[VT]: Error in end of object pool message." +
-									                              std::string("Faulty Object ") +
-									                              isobus::to_string(static_cast<int>(objectIDOfFaultyObject)) +
-									                              std::string(" Faulty Object Parent ") +
-									                              isobus::to_string(static_cast<int>(parentObjectIDOfFaultyObject)) +
-									                              std::string(" Pool error bitmask value ") +
-									                              isobus::to_string(static_cast<int>(objectPoolErrorBitmask)));
+									CANStackLogger::error("[VT]: Error in end of object pool message.Faulty Object ", static_cast<int>(objectIDOfFaultyObject), " Faulty Object Parent ", static_cast<int>(parentObjectIDOfFaultyObject), " Pool error bitmask value ", static_cast<int>(objectPoolErrorBitmask));
 									if (vtRanOutOfMemory)
 									{
-										CANStackLogger::CAN_stack_log("[VT]: Ran out of memory");
+										CANStackLogger::error("[VT]: Ran out of memory");
 									}
 									if (otherErrors)
 									{
-										CANStackLogger::CAN_stack_log("[VT]: Reported other errors in EOM response");
+										CANStackLogger::error("[VT]: Reported other errors in EOM response");
 									}
 								}
 							}
@@ -2330,14 +2828,14 @@ namespace isobus
 
 				default:
 				{
-					CANStackLogger::CAN_stack_log("[VT]: Client unknown message");
+					CANStackLogger::warn("[VT]: Client unknown message");
 				}
 				break;
 			}
 		}
 		else
 		{
-			CANStackLogger::CAN_stack_log("[VT]: VT-ECU Client message invalid");
+			CANStackLogger::warn("[VT]: VT-ECU Client message invalid");
 		}
 	}
 
@@ -2365,10 +2863,47 @@ namespace isobus
 					parent->currentObjectPoolState = CurrentObjectPoolUploadState::Failed;
 				}
 			}
+			parent->wake_worker_thread();
 		}
 	}
 
-	bool VirtualTerminalClient::process_internal_object_pool_upload_callback(std::uint32_t,
+	void VirtualTerminalClient::process_string_value_callback(std::uint32_t parameterGroupNumber,
+	                                                          std::uint32_t,
+	                                                          InternalControlFunction *,
+	                                                          ControlFunction *destinationControlFunction,
+	                                                          bool successful,
+	                                                          void *parentPointer)
+	{
+		if ((nullptr != parentPointer) &&
+		    (static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal) == parameterGroupNumber) &&
+		    (nullptr != destinationControlFunction))
+		{
+			VirtualTerminalClient *parent = reinterpret_cast<VirtualTerminalClient *>(parentPointer);
+
+			parent->process_string_value_transmit_complete(successful);
+			parent->wake_worker_thread();
+		}
+	}
+
+	void VirtualTerminalClient::process_graphics_batch_callback(std::uint32_t parameterGroupNumber,
+	                                                            std::uint32_t,
+	                                                            InternalControlFunction *,
+	                                                            ControlFunction *destinationControlFunction,
+	                                                            bool successful,
+	                                                            void *parentPointer)
+	{
+		if ((nullptr != parentPointer) &&
+		    (static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal) == parameterGroupNumber) &&
+		    (nullptr != destinationControlFunction))
+		{
+			VirtualTerminalClient *parent = reinterpret_cast<VirtualTerminalClient *>(parentPointer);
+
+			parent->process_graphics_batch_transmit_complete(successful);
+			parent->wake_worker_thread();
+		}
+	}
+
+	bool VirtualTerminalClient::process_internal_object_pool_upload_callback(std::uint32_t callbackIndex,
 	                                                                         std::uint32_t bytesOffset,
 	                                                                         std::uint32_t numberOfBytesNeeded,
 	                                                                         std::uint8_t *chunkBuffer,
@@ -2381,37 +2916,670 @@ namespace isobus
 		    (0 != numberOfBytesNeeded))
 		{
 			VirtualTerminalClient *parentVTClient = reinterpret_cast<VirtualTerminalClient *>(parentPointer);
-			std::uint32_t poolIndex;
+			std::uint32_t poolIndex = parentVTClient->lastObjectPoolIndex;
 
-			// Need to figure out which pool we're currently uploading
-			for (std::uint32_t i = 0; i < parentVTClient->objectPools.size(); i++)
+			if ((poolIndex < parentVTClient->objectPools.size()) &&
+			    ((bytesOffset + numberOfBytesNeeded) <= parentVTClient->objectPools[poolIndex].objectPoolSize + 1))
 			{
-				if (!parentVTClient->objectPools[i].uploaded)
+				// We've got more data to transfer
+				if (0 == bytesOffset)
+				{
+					chunkBuffer[0] = static_cast<std::uint8_t>(Function::ObjectPoolTransferMessage);
+					retVal = parentVTClient->get_object_pool_chunk(poolIndex, callbackIndex, 0, numberOfBytesNeeded - 1, &chunkBuffer[1]);
+				}
+				else
+				{
+					// Subtract off 1 to account for the mux in the first byte of the message
+					retVal = parentVTClient->get_object_pool_chunk(poolIndex, callbackIndex, bytesOffset - 1, numberOfBytesNeeded, chunkBuffer);
+				}
+
+				if (retVal)
 				{
-					poolIndex = i;
-					break;
+					parentVTClient->currentObjectPoolUploadedBytes = (bytesOffset + numberOfBytesNeeded - 1);
 				}
 			}
+		}
+		return retVal;
+	}
+
+	bool VirtualTerminalClient::send_command(const std::uint8_t *data)
+	{
+		bool retVal = false;
+
+		if (objectPoolDeltaReplayEnabled)
+		{
+			const std::lock_guard<std::mutex> lock(objectPoolDeltaMutex);
+			retVal = transmit_command(data);
+			record_object_pool_delta(data, retVal);
+		}
+		else
+		{
+			retVal = transmit_command(data);
+		}
+		return retVal;
+	}
+
+	bool VirtualTerminalClient::transmit_command(const std::uint8_t *data)
+	{
+		bool retVal = false;
+
+		if (commandQueueEnabled)
+		{
+			const std::lock_guard<std::mutex> lock(commandQueueMutex);
+			QueuedCommand command;
+
+			std::copy(data, data + CAN_DATA_LENGTH, command.data.begin());
+			command.key = 0;
+			command.replaceable = get_command_key(data, command.key);
 
-			if ((bytesOffset + numberOfBytesNeeded) <= parentVTClient->objectPools[poolIndex].objectPoolSize + 1)
+			if (command.replaceable)
 			{
-				// We've got more data to transfer
+				for (auto &queuedCommand : commandQueue)
+				{
+					if ((!retVal) &&
+					    (queuedCommand.replaceable) &&
+					    (queuedCommand.data[0] == command.data[0]) &&
+					    (queuedCommand.key == command.key))
+					{
+						// Keep the command's place in the queue, but send the latest value
+						queuedCommand.data = command.data;
+						retVal = true;
+					}
+				}
+			}
+
+			if ((!retVal) &&
+			    (commandQueue.size() < MAX_COMMAND_QUEUE_SIZE))
+			{
+				commandQueue.push_back(command);
 				retVal = true;
-				if (0 == bytesOffset)
+				wake_worker_thread();
+			}
+		}
+		else
+		{
+			retVal = get_network_manager().send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
+			                                                data,
+			                                                CAN_DATA_LENGTH,
+			                                                myControlFunction.get(),
+			                                                partnerControlFunction.get(),
+			                                                CANIdentifier::PriorityLowest7);
+		}
+		return retVal;
+	}
+
+	bool VirtualTerminalClient::get_command_key(const std::uint8_t *data, std::uint32_t &key)
+	{
+		bool retVal = true;
+		const std::uint32_t objectID = (static_cast<std::uint32_t>(data[1]) | (static_cast<std::uint32_t>(data[2]) << 8));
+
+		switch (data[0])
+		{
+			case static_cast<std::uint8_t>(Function::HideShowObjectCommand):
+			case static_cast<std::uint8_t>(Function::EnableDisableObjectCommand):
+			case static_cast<std::uint8_t>(Function::ChangeSizeCommand):
+			case static_cast<std::uint8_t>(Function::ChangeBackgroundColourCommand):
+			case static_cast<std::uint8_t>(Function::ChangeNumericValueCommand):
+			case static_cast<std::uint8_t>(Function::ChangeEndPointCommand):
+			case static_cast<std::uint8_t>(Function::ChangeFontAttributesCommand):
+			case static_cast<std::uint8_t>(Function::ChangeLineAttributesCommand):
+			case static_cast<std::uint8_t>(Function::ChangeFillAttributesCommand):
+			case static_cast<std::uint8_t>(Function::ChangeActiveMaskCommand):
+			case static_cast<std::uint8_t>(Function::ChangePriorityCommand):
+			case static_cast<std::uint8_t>(Function::ChangeObjectLabelCommand):
+			case static_cast<std::uint8_t>(Function::ChangePolygonScaleCommand):
+			{
+				key = (objectID << 16);
+			}
+			break;
+
+			case static_cast<std::uint8_t>(Function::ChangeAttributeCommand):
+			case static_cast<std::uint8_t>(Function::ChangeListItemCommand):
+			case static_cast<std::uint8_t>(Function::ChangePolygonPointCommand):
+			{
+				// Byte 3 is the attribute ID, list index, or point index
+				key = ((objectID << 16) | data[3]);
+			}
+			break;
+
+			case static_cast<std::uint8_t>(Function::ChangeSoftKeyMaskCommand):
+			{
+				// Byte 1 is the mask type, followed by the mask's object ID
+				key = ((static_cast<std::uint32_t>(data[2]) << 16) | (static_cast<std::uint32_t>(data[3]) << 24) | data[1]);
+			}
+			break;
+
+			default:
+			{
+				retVal = false;
+			}
+			break;
+		}
+		return retVal;
+	}
+
+	void VirtualTerminalClient::process_command_queue()
+	{
+		const std::lock_guard<std::mutex> lock(commandQueueMutex);
+		const std::uint32_t currentTime = SystemTiming::get_timestamp_ms();
+		std::uint8_t maxPendingResponses = commandQueueMaxPendingResponses;
+		bool transmitSuccessful = true;
+
+		while ((!pendingCommands.empty()) &&
+		       (SystemTiming::time_expired_ms(pendingCommands.front().timestamp_ms, COMMAND_RESPONSE_TIMEOUT_MS)))
+		{
+			CANStackLogger::warn("[VT]: No response to command ", static_cast<int>(pendingCommands.front().function));
+			pendingCommands.pop_front();
+		}
+
+		if (0 != (busyCodesBitfield & VT_BUSY_CODES_LIMITING_COMMANDS))
+		{
+			maxPendingResponses = 1;
+		}
+
+		// Don't let an idle queue build up more than one burst of pipelined commands
+		if ((0 != commandQueueInterval_ms) &&
+		    ((currentTime - commandQueueTimestamp_ms) > (commandQueueInterval_ms * maxPendingResponses)))
+		{
+			commandQueueTimestamp_ms = currentTime - (commandQueueInterval_ms * maxPendingResponses);
+		}
+
+		while ((transmitSuccessful) &&
+		       (!commandQueue.empty()) &&
+		       (pendingCommands.size() < maxPendingResponses) &&
+		       ((currentTime - commandQueueTimestamp_ms) >= commandQueueInterval_ms))
+		{
+			transmitSuccessful = get_network_manager().send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
+			                                                            commandQueue.front().data.data(),
+			                                                            CAN_DATA_LENGTH,
+			                                                            myControlFunction.get(),
+			                                                            partnerControlFunction.get(),
+			                                                            CANIdentifier::PriorityLowest7);
+
+			if (transmitSuccessful)
+			{
+				PendingCommand pending;
+
+				pending.timestamp_ms = currentTime;
+				pending.function = commandQueue.front().data[0];
+				pendingCommands.push_back(pending);
+				commandQueue.pop_front();
+				commandQueueTimestamp_ms += commandQueueInterval_ms;
+			}
+		}
+	}
+
+	void VirtualTerminalClient::process_command_response(std::uint8_t function)
+	{
+		const std::lock_guard<std::mutex> lock(commandQueueMutex);
+		auto pendingCommand = std::find_if(pendingCommands.begin(), pendingCommands.end(), [function](const PendingCommand &command) { return (command.function == function); });
+
+		if (pendingCommands.end() != pendingCommand)
+		{
+			pendingCommands.erase(pendingCommand);
+		}
+	}
+
+	void VirtualTerminalClient::clear_command_queue()
+	{
+		const std::lock_guard<std::mutex> lock(commandQueueMutex);
+		commandQueue.clear();
+		pendingCommands.clear();
+	}
+
+	void VirtualTerminalClient::process_string_value_queue()
+	{
+		const std::lock_guard<std::mutex> lock(stringValueMutex);
+
+		if ((StateMachineState::Connected == state) &&
+		    (NULL_OBJECT_ID == stringValueInFlightObjectID) &&
+		    (!stringValueQueue.empty()))
+		{
+			const std::uint16_t objectID = stringValueQueue.front();
+			StringValueState &stringValue = stringValues[objectID];
+			const std::uint16_t stringLength = static_cast<std::uint16_t>(stringValue.value.size());
+			bool transmitSuccessful;
+
+			stringCommandBuffer.resize(5 + stringLength);
+			stringCommandBuffer[0] = static_cast<std::uint8_t>(Function::ChangeStringValueCommand);
+			stringCommandBuffer[1] = static_cast<std::uint8_t>(objectID & 0xFF);
+			stringCommandBuffer[2] = static_cast<std::uint8_t>(objectID >> 8);
+			stringCommandBuffer[3] = static_cast<std::uint8_t>(stringLength & 0xFF);
+			stringCommandBuffer[4] = static_cast<std::uint8_t>(stringLength >> 8);
+			std::copy(stringValue.value.begin(), stringValue.value.end(), stringCommandBuffer.begin() + 5);
+
+			if (stringCommandBuffer.size() <= CAN_DATA_LENGTH)
+			{
+				transmitSuccessful = get_network_manager().send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
+				                                                            stringCommandBuffer.data(),
+				                                                            static_cast<std::uint32_t>(stringCommandBuffer.size()),
+				                                                            myControlFunction.get(),
+				                                                            partnerControlFunction.get(),
+				                                                            CANIdentifier::PriorityLowest7);
+				stringValue.sent = transmitSuccessful;
+			}
+			else
+			{
+				// Only one transport session can be open to the VT, so the next value waits for this one to finish
+				transmitSuccessful = get_network_manager().send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
+				                                                            stringCommandBuffer.data(),
+				                                                            static_cast<std::uint32_t>(stringCommandBuffer.size()),
+				                                                            myControlFunction.get(),
+				                                                            partnerControlFunction.get(),
+				                                                            CANIdentifier::PriorityLowest7,
+				                                                            process_string_value_callback,
+				                                                            this);
+
+				if (transmitSuccessful)
 				{
-					chunkBuffer[0] = static_cast<std::uint8_t>(Function::ObjectPoolTransferMessage);
-					memcpy(&chunkBuffer[1], &parentVTClient->objectPools[poolIndex].objectPoolDataPointer[bytesOffset], numberOfBytesNeeded - 1);
+					stringValueInFlightObjectID = objectID;
 				}
-				else
+			}
+
+			if (transmitSuccessful)
+			{
+				stringValue.queued = false;
+				stringValueQueue.erase(stringValueQueue.begin());
+			}
+		}
+	}
+
+	void VirtualTerminalClient::process_string_value_transmit_complete(bool successful)
+	{
+		const std::lock_guard<std::mutex> lock(stringValueMutex);
+
+		if (NULL_OBJECT_ID != stringValueInFlightObjectID)
+		{
+			StringValueState &stringValue = stringValues[stringValueInFlightObjectID];
+
+			if (!successful)
+			{
+				CANStackLogger::warn("[VT]: Failed to send string value of object ", static_cast<int>(stringValueInFlightObjectID));
+			}
+			else if (!stringValue.queued)
+			{
+				// If a newer value was queued while this one was sent, that one still needs to go out
+				stringValue.sent = true;
+			}
+			stringValueInFlightObjectID = NULL_OBJECT_ID;
+		}
+	}
+
+	void VirtualTerminalClient::invalidate_string_value(std::uint16_t objectID)
+	{
+		const std::lock_guard<std::mutex> lock(stringValueMutex);
+		auto stringValue = stringValues.find(objectID);
+
+		if (stringValues.end() != stringValue)
+		{
+			// The next value for this object has to be sent, even if it is the same as the last one we sent
+			stringValue->second.sent = false;
+		}
+	}
+
+	void VirtualTerminalClient::clear_string_values()
+	{
+		const std::lock_guard<std::mutex> lock(stringValueMutex);
+		stringValues.clear();
+		stringValueQueue.clear();
+		stringValueInFlightObjectID = NULL_OBJECT_ID;
+	}
+
+	void VirtualTerminalClient::requeue_string_values()
+	{
+		const std::lock_guard<std::mutex> lock(stringValueMutex);
+
+		for (auto &stringValue : stringValues)
+		{
+			stringValue.second.sent = false;
+
+			if (!stringValue.second.queued)
+			{
+				stringValue.second.queued = true;
+				stringValueQueue.push_back(stringValue.first);
+			}
+		}
+		stringValueInFlightObjectID = NULL_OBJECT_ID;
+	}
+
+	void VirtualTerminalClient::record_object_pool_delta(const std::uint8_t *data, bool sent)
+	{
+		std::uint32_t key = 0;
+
+		if (get_command_key(data, key))
+		{
+			const std::uint64_t deltaKey = ((static_cast<std::uint64_t>(data[0]) << 32) | key);
+			auto existingDelta = objectPoolDeltaIndices.find(deltaKey);
+			ObjectPoolDelta delta;
+
+			std::copy(data, data + CAN_DATA_LENGTH, delta.data.begin());
+
+			// A command that went out now doesn't need to be sent again by a replay that is in progress,
+			// but one that couldn't be sent is left for the replay to retry
+			delta.replayPending = !sent;
+
+			if (objectPoolDeltaIndices.end() != existingDelta)
+			{
+				objectPoolDeltas[existingDelta->second] = delta;
+
+				if ((!sent) &&
+				    (existingDelta->second < objectPoolDeltaReplayIndex))
 				{
-					// Subtract off 1 to account for the mux in the first byte of the message
-					memcpy(chunkBuffer, &parentVTClient->objectPools[poolIndex].objectPoolDataPointer[bytesOffset - 1], numberOfBytesNeeded);
+					objectPoolDeltaReplayIndex = existingDelta->second;
+				}
+			}
+			else
+			{
+				objectPoolDeltaIndices[deltaKey] = objectPoolDeltas.size();
+				objectPoolDeltas.push_back(delta);
+			}
+		}
+	}
+
+	void VirtualTerminalClient::process_object_pool_delta_replay()
+	{
+		const std::lock_guard<std::mutex> lock(objectPoolDeltaMutex);
+		bool transmitSuccessful = true;
+
+		while ((transmitSuccessful) &&
+		       (objectPoolDeltaReplayIndex < objectPoolDeltas.size()))
+		{
+			ObjectPoolDelta &delta = objectPoolDeltas[objectPoolDeltaReplayIndex];
+
+			if (delta.replayPending)
+			{
+				transmitSuccessful = transmit_command(delta.data.data());
+			}
+
+			if (transmitSuccessful)
+			{
+				delta.replayPending = false;
+				objectPoolDeltaReplayIndex++;
+			}
+		}
+	}
+
+	void VirtualTerminalClient::process_graphics_batch_queue()
+	{
+		const std::lock_guard<std::mutex> lock(graphicsBatchMutex);
+		bool transmitSuccessful = true;
+
+		while ((transmitSuccessful) &&
+		       (!graphicsBatchInFlight) &&
+		       (graphicsBatchIndex < graphicsBatchLengths.size()))
+		{
+			const std::uint16_t messageLength = graphicsBatchLengths[graphicsBatchIndex];
+
+			if (messageLength <= CAN_DATA_LENGTH)
+			{
+				transmitSuccessful = get_network_manager().send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
+				                                                            &graphicsBatchData[graphicsBatchDataOffset],
+				                                                            messageLength,
+				                                                            myControlFunction.get(),
+				                                                            partnerControlFunction.get(),
+				                                                            CANIdentifier::PriorityLowest7);
+			}
+			else
+			{
+				// Only one transport session can be open to the VT, and the messages have to stay in order
+				transmitSuccessful = get_network_manager().send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
+				                                                            &graphicsBatchData[graphicsBatchDataOffset],
+				                                                            messageLength,
+				                                                            myControlFunction.get(),
+				                                                            partnerControlFunction.get(),
+				                                                            CANIdentifier::PriorityLowest7,
+				                                                            process_graphics_batch_callback,
+				                                                            this);
+				graphicsBatchInFlight = transmitSuccessful;
+			}
+
+			if (transmitSuccessful)
+			{
+				graphicsBatchDataOffset += messageLength;
+				graphicsBatchIndex++;
+			}
+		}
+
+		if (graphicsBatchIndex == graphicsBatchLengths.size())
+		{
+			graphicsBatchData.clear();
+			graphicsBatchLengths.clear();
+			graphicsBatchDataOffset = 0;
+			graphicsBatchIndex = 0;
+		}
+	}
+
+	void VirtualTerminalClient::process_graphics_batch_transmit_complete(bool successful)
+	{
+		const std::lock_guard<std::mutex> lock(graphicsBatchMutex);
+
+		if (graphicsBatchInFlight)
+		{
+			if (!successful)
+			{
+				CANStackLogger::warn("[VT]: Failed to send a graphics context command");
+			}
+			graphicsBatchInFlight = false;
+		}
+	}
+
+	void VirtualTerminalClient::clear_graphics_batch_queue()
+	{
+		const std::lock_guard<std::mutex> lock(graphicsBatchMutex);
+		graphicsBatchData.clear();
+		graphicsBatchLengths.clear();
+		graphicsBatchDataOffset = 0;
+		graphicsBatchIndex = 0;
+		graphicsBatchInFlight = false;
+	}
+
+	void VirtualTerminalClient::index_object_pool(std::uint8_t poolIndex, const std::uint8_t *pool, std::uint32_t size)
+	{
+		ObjectPoolIndex::ParseResult result = objectPools[poolIndex].index.parse(pool, size);
+
+		if (ObjectPoolIndex::ParseResult::Success != result)
+		{
+			CANStackLogger::error("[VT]: Object pool ", static_cast<int>(poolIndex), " is invalid at offset ", objectPools[poolIndex].index.get_error_offset(), ", error ", static_cast<int>(result));
+		}
+	}
+
+	bool VirtualTerminalClient::get_are_object_pools_valid() const
+	{
+		bool retVal = true;
+
+		for (std::uint32_t i = 0; (i < objectPools.size()) && (retVal); i++)
+		{
+			if ((!objectPools[i].useDataCallback) &&
+			    (0 != objectPools[i].objectPoolSize) &&
+			    (!get_object_pool_index(i).get_is_valid()))
+			{
+				retVal = false;
+			}
+		}
+		return retVal;
+	}
+
+	const ObjectPoolIndex &VirtualTerminalClient::get_object_pool_index(std::uint32_t poolIndex) const
+	{
+		const ObjectPoolDataStruct &pool = objectPools[poolIndex];
+
+		return (nullptr != pool.image) ? pool.image->get_index() : pool.index;
+	}
+
+	bool VirtualTerminalClient::get_object_pool_version_label(std::array<std::uint8_t, 7> &versionLabel)
+	{
+		constexpr std::uint64_t FNV_OFFSET_BASIS = 0xCBF29CE484222325;
+		constexpr std::uint64_t FNV_PRIME = 0x00000100000001B3;
+		constexpr char LABEL_DIGITS[] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+		constexpr std::uint8_t LABEL_BASE = 36;
+		bool retVal = true;
+
+		if (!objectPoolVersionLabelValid)
+		{
+			std::uint64_t hash = FNV_OFFSET_BASIS;
+			std::array<std::uint8_t, OBJECT_POOL_HASH_CHUNK_SIZE> chunk;
+
+			for (std::uint32_t i = 0; (i < objectPools.size()) && (retVal); i++)
+			{
+				// Hash the size too so that pools split differently get different labels
+				for (std::uint8_t j = 0; j < 4; j++)
+				{
+					hash = ((hash ^ ((objectPools[i].objectPoolSize >> (8 * j)) & 0xFF)) * FNV_PRIME);
+				}
+
+				for (std::uint32_t offset = 0; (offset < objectPools[i].objectPoolSize) && (retVal); offset += OBJECT_POOL_HASH_CHUNK_SIZE)
+				{
+					std::uint32_t numberOfBytes = (objectPools[i].objectPoolSize - offset);
+
+					if (numberOfBytes > OBJECT_POOL_HASH_CHUNK_SIZE)
+					{
+						numberOfBytes = OBJECT_POOL_HASH_CHUNK_SIZE;
+					}
+					retVal = get_object_pool_chunk(i, 0, offset, numberOfBytes, chunk.data());
+
+					for (std::uint32_t j = 0; (j < numberOfBytes) && (retVal); j++)
+					{
+						hash = ((hash ^ chunk[j]) * FNV_PRIME);
+					}
 				}
 			}
+
+			if (retVal)
+			{
+				// Fill in from the least significant digit, the bits that don't fit are dropped
+				for (std::size_t i = objectPoolVersionLabel.size(); i > 0; i--)
+				{
+					objectPoolVersionLabel[i - 1] = static_cast<std::uint8_t>(LABEL_DIGITS[hash % LABEL_BASE]);
+					hash /= LABEL_BASE;
+				}
+				objectPoolVersionLabelValid = true;
+			}
 		}
+		versionLabel = objectPoolVersionLabel;
 		return retVal;
 	}
 
+	bool VirtualTerminalClient::get_object_pool_chunk(std::uint32_t poolIndex, std::uint32_t callbackIndex, std::uint32_t poolOffset, std::uint32_t numberOfBytes, std::uint8_t *chunkBuffer)
+	{
+		bool retVal = false;
+
+		if ((poolIndex < objectPools.size()) &&
+		    (nullptr != chunkBuffer) &&
+		    ((poolOffset + numberOfBytes) <= objectPools[poolIndex].objectPoolSize))
+		{
+			const ObjectPoolDataStruct &pool = objectPools[poolIndex];
+
+			if (0 == numberOfBytes)
+			{
+				retVal = true;
+			}
+			else if ((pool.useDataCallback) &&
+			         (nullptr != pool.dataCallback))
+			{
+				retVal = pool.dataCallback(callbackIndex, poolOffset, numberOfBytes, chunkBuffer, this);
+			}
+			else if (nullptr != pool.objectPoolDataPointer)
+			{
+				memcpy(chunkBuffer, &pool.objectPoolDataPointer[poolOffset], numberOfBytes);
+				retVal = true;
+			}
+			else if ((nullptr != pool.objectPoolVectorPointer) &&
+			         ((poolOffset + numberOfBytes) <= pool.objectPoolVectorPointer->size()))
+			{
+				memcpy(chunkBuffer, &(*pool.objectPoolVectorPointer)[poolOffset], numberOfBytes);
+				retVal = true;
+			}
+		}
+		return retVal;
+	}
+
+	std::uint32_t VirtualTerminalClient::get_time_until_next_update_ms()
+	{
+		std::uint32_t retVal = MAX_UPDATE_WAIT_MS;
+		std::uint32_t elapsed_ms;
+
+		if (sendWorkingSetMaintenenace)
+		{
+			elapsed_ms = SystemTiming::get_time_elapsed_ms(lastWorkingSetMaintenanceTimestamp_ms);
+			retVal = std::min(retVal, (elapsed_ms < WORKING_SET_MAINTENANCE_TIMEOUT_MS) ? (WORKING_SET_MAINTENANCE_TIMEOUT_MS - elapsed_ms) : 0);
+		}
+
+		if (StateMachineState::Connected == state)
+		{
+			elapsed_ms = SystemTiming::get_time_elapsed_ms(lastVTStatusTimestamp_ms);
+			retVal = std::min(retVal, (elapsed_ms < VT_STATUS_TIMEOUT_MS) ? (VT_STATUS_TIMEOUT_MS - elapsed_ms) : 0);
+
+			{
+				const std::lock_guard<std::mutex> lock(commandQueueMutex);
+
+				if (!pendingCommands.empty())
+				{
+					elapsed_ms = SystemTiming::get_time_elapsed_ms(pendingCommands.front().timestamp_ms);
+					retVal = std::min(retVal, (elapsed_ms < COMMAND_RESPONSE_TIMEOUT_MS) ? (COMMAND_RESPONSE_TIMEOUT_MS - elapsed_ms) : 0);
+				}
+
+				if ((!commandQueue.empty()) &&
+				    (pendingCommands.size() < commandQueueMaxPendingResponses))
+				{
+					// If a response is what's holding the queue up, its arrival will wake us instead
+					elapsed_ms = SystemTiming::get_time_elapsed_ms(commandQueueTimestamp_ms);
+					retVal = std::min(retVal, (elapsed_ms < commandQueueInterval_ms) ? (commandQueueInterval_ms - elapsed_ms) : 0);
+				}
+			}
+
+			{
+				const std::lock_guard<std::mutex> lock(stringValueMutex);
+
+				if ((!stringValueQueue.empty()) &&
+				    (NULL_OBJECT_ID == stringValueInFlightObjectID))
+				{
+					// The last attempt to send a string value failed
+					retVal = 0;
+				}
+			}
+
+			{
+				const std::lock_guard<std::mutex> lock(objectPoolDeltaMutex);
+
+				if (objectPoolDeltaReplayIndex < objectPoolDeltas.size())
+				{
+					// The bus or the command queue was full
+					retVal = 0;
+				}
+			}
+
+			{
+				const std::lock_guard<std::mutex> lock(graphicsBatchMutex);
+
+				if ((graphicsBatchIndex < graphicsBatchLengths.size()) &&
+				    (!graphicsBatchInFlight))
+				{
+					// The last attempt to send a graphics context message failed
+					retVal = 0;
+				}
+			}
+		}
+		else if ((StateMachineState::Failed != state) &&
+		         (retVal > CONNECTING_UPDATE_INTERVAL_MS))
+		{
+			retVal = CONNECTING_UPDATE_INTERVAL_MS;
+		}
+
+		if (0 == retVal)
+		{
+			// Update just ran, so anything still due is waiting on the bus to accept a message
+			retVal = UPDATE_RETRY_INTERVAL_MS;
+		}
+		return retVal;
+	}
+
+	void VirtualTerminalClient::wake_worker_thread()
+	{
+		const std::lock_guard<std::mutex> lock(workerWakeMutex);
+		workerWakeRequested = true;
+		workerWakeCondition.notify_one();
+	}
+
 	void VirtualTerminalClient::worker_thread_function()
 	{
 		for (;;)
@@ -2421,7 +3589,11 @@ namespace isobus
 				break;
 			}
 			update();
-			std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+			std::uint32_t timeUntilNextUpdate_ms = get_time_until_next_update_ms();
+			std::unique_lock<std::mutex> lock(workerWakeMutex);
+			workerWakeCondition.wait_for(lock, std::chrono::milliseconds(timeUntilNextUpdate_ms), [this]() { return workerWakeRequested; });
+			workerWakeRequested = false;
 		}
 	}
 
@@ -19,13 +19,12 @@
 
 namespace isobus
 {
-	FastPacketProtocol FastPacketProtocol::Protocol;
-
 	FastPacketProtocol::FastPacketProtocolSession::FastPacketProtocolSession(Direction sessionDirection, std::uint8_t canPortIndex) :
 	  sessionMessage(canPortIndex),
 	  sessionCompleteCallback(nullptr),
 	  frameChunkCallback(nullptr),
 	  timestamp_ms(0),
+	  sessionStartTimestamp_ms(SystemTiming::get_timestamp_ms()),
 	  lastPacketNumber(0),
 	  packetCount(0),
 	  processedPacketsThisSession(0),
@@ -45,6 +44,24 @@ namespace isobus
 	{
 	}
 
+	FastPacketProtocol::FastPacketProtocol(CANNetworkManager &parentNetworkManager) :
+	  CANLibProtocol(parentNetworkManager)
+	{
+	}
+
+	FastPacketProtocol::~FastPacketProtocol()
+	{
+		for (auto session : activeSessions)
+		{
+			delete session;
+		}
+	}
+
+	const ProtocolStatistics &FastPacketProtocol::get_statistics()
+	{
+		return Protocol.statistics;
+	}
+
 	void FastPacketProtocol::initialize(CANLibBadge<CANNetworkManager>)
 	{
 		if (!initialized)
@@ -56,7 +73,7 @@ namespace isobus
 	void FastPacketProtocol::register_multipacket_message_callback(std::uint32_t parameterGroupNumber, CANLibCallback callback, void *parent)
 	{
 		parameterGroupNumberCallbacks.push_back(ParameterGroupNumberCallbackData(parameterGroupNumber, callback, parent));
-		CANNetworkManager::CANNetwork.add_protocol_parameter_group_number_callback(parameterGroupNumber, process_message, this);
+		networkManager.add_protocol_parameter_group_number_callback(parameterGroupNumber, process_message, this);
 	}
 
 	void FastPacketProtocol::remove_multipacket_message_callback(std::uint32_t parameterGroupNumber, CANLibCallback callback, void *parent)
@@ -67,7 +84,7 @@ namespace isobus
 		{
 			parameterGroupNumberCallbacks.erase(callbackLocation);
 		}
-		CANNetworkManager::CANNetwork.remove_protocol_parameter_group_number_callback(parameterGroupNumber, process_message, this);
+		networkManager.remove_protocol_parameter_group_number_callback(parameterGroupNumber, process_message, this);
 	}
 
 	bool FastPacketProtocol::send_multipacket_message(std::uint32_t parameterGroupNumber,
@@ -106,7 +123,8 @@ namespace isobus
 				tempSession->sessionCompleteCallback = txCompleteCallback;
 				tempSession->sequenceNumber = get_new_sequence_number(tempSession);
 
-				if (0 != (messageLength % PROTOCOL_BYTES_PER_FRAME))
+				// The first frame holds 6 bytes, and each one after it holds 7
+				if (0 != ((messageLength - 6) % PROTOCOL_BYTES_PER_FRAME))
 				{
 					tempSession->packetCount++;
 				}
@@ -114,17 +132,18 @@ namespace isobus
 				std::unique_lock<std::mutex> lock(sessionMutex);
 
 				activeSessions.push_back(tempSession);
+				statistics.record_session_started(ProtocolStatistics::Direction::Transmit);
 				retVal = true;
 			}
 			else
 			{
 				// Already in a matching session, can't start another.
-				CANStackLogger::CAN_stack_log("[FP]: Can't send fast packet message, already in matching session.");
+				CANStackLogger::warn("[FP]: Can't send fast packet message, already in matching session.");
 			}
 		}
 		else
 		{
-			CANStackLogger::CAN_stack_log("[FP]: Can't send fast packet message, bad parameters or ICF is invalid");
+			CANStackLogger::error("[FP]: Can't send fast packet message, bad parameters or ICF is invalid");
 		}
 		return retVal;
 	}
@@ -178,6 +197,7 @@ namespace isobus
 				if (session == *currentSession)
 				{
 					activeSessions.erase(currentSession);
+					statistics.record_session_closed(get_statistics_direction(session));
 					delete session;
 					break;
 				}
@@ -185,6 +205,24 @@ namespace isobus
 		}
 	}
 
+	ProtocolStatistics::Direction FastPacketProtocol::get_statistics_direction(const FastPacketProtocolSession *session)
+	{
+		ProtocolStatistics::Direction retVal = ProtocolStatistics::Direction::Receive;
+
+		if (FastPacketProtocolSession::Direction::Transmit == session->sessionDirection)
+		{
+			retVal = ProtocolStatistics::Direction::Transmit;
+		}
+		return retVal;
+	}
+
+	void FastPacketProtocol::record_session_completed(const FastPacketProtocolSession *session)
+	{
+		statistics.record_session_completed(get_statistics_direction(session),
+		                                    session->sessionMessage.get_data_length(),
+		                                    SystemTiming::get_time_elapsed_ms(session->sessionStartTimestamp_ms));
+	}
+
 	std::uint8_t FastPacketProtocol::get_new_sequence_number(FastPacketProtocolSession *session)
 	{
 		std::uint8_t retVal = 0;
@@ -274,6 +312,8 @@ namespace isobus
 							if (currentSession->processedPacketsThisSession >= currentSession->packetCount + 1)
 							{
 								// Complete
+								record_session_completed(currentSession);
+
 								// Find the appropriate callback and let them know
 								for (auto callback : parameterGroupNumberCallbacks)
 								{
@@ -287,7 +327,7 @@ namespace isobus
 						}
 						else
 						{
-							CANStackLogger::CAN_stack_log("[FP]: Existing session matched new frame counter, aborting the matching session.");
+							CANStackLogger::warn("[FP]: Existing session matched new frame counter, aborting the matching session.");
 							close_session(currentSession);
 						}
 					}
@@ -303,7 +343,13 @@ namespace isobus
 								currentSession->frameChunkCallback = nullptr;
 								if (messageData[1] >= PROTOCOL_BYTES_PER_FRAME - 1)
 								{
+									// The first frame holds 6 bytes, and each one after it holds 7
 									currentSession->packetCount = ((messageData[1] - 6) / PROTOCOL_BYTES_PER_FRAME);
+
+									if (0 != ((messageData[1] - 6) % PROTOCOL_BYTES_PER_FRAME))
+									{
+										currentSession->packetCount++;
+									}
 								}
 								else
 								{
@@ -317,11 +363,6 @@ namespace isobus
 								currentSession->sessionMessage.set_destination_control_function(message->get_destination_control_function());
 								currentSession->timestamp_ms = SystemTiming::get_timestamp_ms();
 
-								if (0 != (messageData[1] % PROTOCOL_BYTES_PER_FRAME))
-								{
-									currentSession->packetCount++;
-								}
-
 								// Save the 6 bytes of payload in this first message
 								for (std::uint8_t i = 0; i < (PROTOCOL_BYTES_PER_FRAME - 1); i++)
 								{
@@ -331,17 +372,18 @@ namespace isobus
 								std::unique_lock<std::mutex> lock(sessionMutex);
 
 								activeSessions.push_back(currentSession);
+								statistics.record_session_started(ProtocolStatistics::Direction::Receive);
 							}
 							else
 							{
-								CANStackLogger::CAN_stack_log("[FP]: Ignoring possible new FP session with advertised length > 233.");
+								CANStackLogger::warn("[FP]: Ignoring possible new FP session with advertised length > 233.");
 							}
 						}
 						else
 						{
 							// This is the middle of some message that we have no context for.
 							// Ignore the message.
-							CANStackLogger::CAN_stack_log("[FP]: Ignoring FP message, no context available.");
+							CANStackLogger::warn("[FP]: Ignoring FP message, no context available.");
 						}
 					}
 				}
@@ -387,7 +429,7 @@ namespace isobus
 				{
 					if (SystemTiming::time_expired_ms(session->timestamp_ms, FP_TIMEOUT_MS))
 					{
-						CANStackLogger::CAN_stack_log("[FP]: Rx session timed out.");
+						CANStackLogger::warn("[FP]: Rx session timed out.");
 						close_session(session);
 					}
 				}
@@ -431,6 +473,7 @@ namespace isobus
 							{
 								process_session_complete_callback(session, false);
 								close_session(session);
+								txSessionCancelled = true;
 								break;
 							}
 						}
@@ -471,14 +514,14 @@ namespace isobus
 								}
 							}
 						}
-						if (CANNetworkManager::CANNetwork.send_can_message(session->sessionMessage.get_identifier().get_parameter_group_number(),
-						                                                   dataBuffer.data(),
-						                                                   CAN_DATA_LENGTH,
-						                                                   reinterpret_cast<InternalControlFunction *>(session->sessionMessage.get_source_control_function()),
-						                                                   session->sessionMessage.get_destination_control_function(),
-						                                                   session->sessionMessage.get_identifier().get_priority(),
-						                                                   nullptr,
-						                                                   nullptr))
+						if (networkManager.send_can_message(session->sessionMessage.get_identifier().get_parameter_group_number(),
+						                                    dataBuffer.data(),
+						                                    CAN_DATA_LENGTH,
+						                                    reinterpret_cast<InternalControlFunction *>(session->sessionMessage.get_source_control_function()),
+						                                    session->sessionMessage.get_destination_control_function(),
+						                                    session->sessionMessage.get_identifier().get_priority(),
+						                                    nullptr,
+						                                    nullptr))
 						{
 							session->processedPacketsThisSession++;
 							session->timestamp_ms = SystemTiming::get_timestamp_ms();
@@ -487,7 +530,7 @@ namespace isobus
 						{
 							if (SystemTiming::time_expired_ms(session->timestamp_ms, FP_TIMEOUT_MS))
 							{
-								CANStackLogger::CAN_stack_log("[FP]: Tx session timed out.");
+								CANStackLogger::warn("[FP]: Tx session timed out.");
 								process_session_complete_callback(session, false);
 								close_session(session);
 								txSessionCancelled = true;
@@ -500,6 +543,7 @@ namespace isobus
 					    (session->processedPacketsThisSession >= session->packetCount))
 					{
 						add_session_history(session);
+						record_session_completed(session);
 						process_session_complete_callback(session, true);
 						close_session(session); // Session is done!
 					}
@@ -5,6 +5,7 @@
 #include "isobus/isobus/can_constants.hpp"
 #include "isobus/isobus/can_internal_control_function.hpp"
 #include "isobus/isobus/can_network_manager.hpp"
+#include "isobus/isobus/can_partnered_control_function.hpp"
 
 #include "test_CAN_glue.hpp"
 
@@ -64,3 +65,83 @@ TEST(ADDRESS_CLAIM_TESTS, AddressClaiming)
 
 	CANHardwareInterface::stop();
 }
+
+static isobus::HardwareInterfaceCANFrame make_address_claim_frame(std::uint8_t channel, std::uint8_t address, std::uint64_t NAMEValue)
+{
+	isobus::HardwareInterfaceCANFrame frame;
+
+	frame.timestamp_us = 0;
+	frame.identifier = (0x18EEFF00 | address);
+	frame.channel = channel;
+	frame.isExtendedFrame = true;
+	frame.dataLength = 8;
+	for (std::uint8_t i = 0; i < 8; i++)
+	{
+		frame.data[i] = static_cast<std::uint8_t>(NAMEValue >> (8 * i));
+	}
+	return frame;
+}
+
+static isobus::ControlFunction *portTestSources[2] = { nullptr, nullptr };
+
+static void record_port_test_source(isobus::CANMessage *message, void *)
+{
+	if (message->get_can_port_index() < 2)
+	{
+		portTestSources[message->get_can_port_index()] = message->get_source_control_function();
+	}
+}
+
+TEST(ADDRESS_CLAIM_TESTS, ClaimsAreMatchedPerPort)
+{
+	constexpr std::uint64_t PARTNER_NAME = 0xA000000000001F0A;
+	constexpr std::uint64_t OTHER_NAME = 0xA000000000001F0B;
+	constexpr std::uint64_t TWO_PORT_NAME = 0xA000000000001F0C;
+	constexpr std::uint32_t TEST_PGN = 0xFF7A;
+	// Never deleted, because the network manager keeps a pointer to it once it's claimed
+	isobus::PartneredControlFunction *partner = new isobus::PartneredControlFunction(1, { isobus::NAMEFilter(isobus::NAME::NAMEParameters::IdentityNumber, 0x1F0A) });
+	isobus::HardwareInterfaceCANFrame frame;
+
+	// The network manager drops messages until its first update
+	update_CAN_network();
+
+	// The partner is on port 1, so a claim with its NAME on port 0 is some other device
+	frame = make_address_claim_frame(0, 0x51, PARTNER_NAME);
+	raw_can_glue(frame, nullptr);
+	EXPECT_EQ(isobus::NULL_CAN_ADDRESS, partner->get_address());
+
+	frame = make_address_claim_frame(1, 0x52, PARTNER_NAME);
+	raw_can_glue(frame, nullptr);
+	EXPECT_EQ(0x52, partner->get_address());
+
+	// Another device taking the same address on port 0 doesn't take it from the partner on port 1
+	frame = make_address_claim_frame(0, 0x52, OTHER_NAME);
+	raw_can_glue(frame, nullptr);
+	EXPECT_EQ(0x52, partner->get_address());
+	EXPECT_EQ(1, partner->get_can_port());
+
+	// The same NAME on two ports is two control functions, one on each port
+	isobus::CANNetworkManager::CANNetwork.add_global_parameter_group_number_callback(TEST_PGN, record_port_test_source, nullptr);
+	frame = make_address_claim_frame(0, 0x53, TWO_PORT_NAME);
+	raw_can_glue(frame, nullptr);
+	frame = make_address_claim_frame(1, 0x54, TWO_PORT_NAME);
+	raw_can_glue(frame, nullptr);
+	update_CAN_network();
+
+	frame.identifier = (0x18000000 | (TEST_PGN << 8) | 0x53);
+	frame.channel = 0;
+	raw_can_glue(frame, nullptr);
+	frame.identifier = (0x18000000 | (TEST_PGN << 8) | 0x54);
+	frame.channel = 1;
+	raw_can_glue(frame, nullptr);
+	update_CAN_network();
+	isobus::CANNetworkManager::CANNetwork.remove_global_parameter_group_number_callback(TEST_PGN, record_port_test_source, nullptr);
+
+	ASSERT_NE(nullptr, portTestSources[0]);
+	ASSERT_NE(nullptr, portTestSources[1]);
+	EXPECT_NE(portTestSources[0], portTestSources[1]);
+	EXPECT_EQ(0, portTestSources[0]->get_can_port());
+	EXPECT_EQ(0x53, portTestSources[0]->get_address());
+	EXPECT_EQ(1, portTestSources[1]->get_can_port());
+	EXPECT_EQ(0x54, portTestSources[1]->get_address());
+}
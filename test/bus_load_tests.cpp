@@ -0,0 +1,152 @@
+#include <gtest/gtest.h>
+
+#include "isobus/isobus/can_bus_load.hpp"
+#include "isobus/isobus/can_network_manager.hpp"
+#include "test_CAN_glue.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <thread>
+
+using namespace isobus;
+
+static HardwareInterfaceCANFrame make_bus_load_test_frame(std::uint32_t identifier, bool isExtendedFrame, std::uint8_t dataLength, std::uint8_t value)
+{
+	HardwareInterfaceCANFrame frame;
+
+	frame.timestamp_us = 0;
+	frame.identifier = identifier;
+	frame.channel = 0;
+	frame.isExtendedFrame = isExtendedFrame;
+	frame.dataLength = dataLength;
+	for (std::uint8_t i = 0; i < 8; i++)
+	{
+		frame.data[i] = value;
+	}
+	return frame;
+}
+
+TEST(BUS_LOAD_TESTS, FrameBitLengths)
+{
+	HardwareInterfaceCANFrame request = make_bus_load_test_frame(0x18EAFFFE, true, 3, 0);
+
+	request.data[1] = 0xEE;
+
+	// Worked out bit by bit, with the CRC and every stuff bit
+	EXPECT_EQ(146u, CANBusLoad::get_frame_bit_length(make_bus_load_test_frame(0x18FEF100, true, 8, 0xFF)));
+	EXPECT_EQ(147u, CANBusLoad::get_frame_bit_length(make_bus_load_test_frame(0x1CFF0000, true, 8, 0x01)));
+	EXPECT_EQ(98u, CANBusLoad::get_frame_bit_length(request));
+	EXPECT_EQ(53u, CANBusLoad::get_frame_bit_length(make_bus_load_test_frame(0x000, false, 0, 0)));
+	EXPECT_EQ(127u, CANBusLoad::get_frame_bit_length(make_bus_load_test_frame(0x000, false, 8, 0)));
+
+	EXPECT_EQ(55u, CANBusLoad::get_worst_case_frame_bit_length(false, 0));
+	EXPECT_EQ(135u, CANBusLoad::get_worst_case_frame_bit_length(false, 8));
+	EXPECT_EQ(160u, CANBusLoad::get_worst_case_frame_bit_length(true, 8));
+	EXPECT_EQ(160u, CANBusLoad::get_worst_case_frame_bit_length(true, 15));
+
+	// Every frame is between its length with no stuff bits and its worst case
+	for (std::uint32_t i = 0; i < 2000; i++)
+	{
+		const bool isExtendedFrame = (0 != (i % 2));
+		const std::uint8_t dataLength = static_cast<std::uint8_t>(i % 9);
+		const HardwareInterfaceCANFrame frame = make_bus_load_test_frame((i * 2654435761u) & (isExtendedFrame ? 0x1FFFFFFF : 0x7FF), isExtendedFrame, dataLength, static_cast<std::uint8_t>(i * 37));
+		const std::uint32_t bitLength = CANBusLoad::get_frame_bit_length(frame);
+
+		ASSERT_LE((isExtendedFrame ? CANBusLoad::EXTENDED_FRAME_STUFFED_BITS : CANBusLoad::STANDARD_FRAME_STUFFED_BITS) + (8u * dataLength) + CANBusLoad::FRAME_UNSTUFFED_BITS, bitLength);
+		ASSERT_GE(CANBusLoad::get_worst_case_frame_bit_length(isExtendedFrame, dataLength), bitLength);
+	}
+
+	EXPECT_EQ(640u, CANBusLoad::get_bit_time_us(160, 250000));
+	EXPECT_EQ(487u, CANBusLoad::get_bit_time_us(146, 300000));
+	EXPECT_EQ(0u, CANBusLoad::get_bit_time_us(146, 0));
+}
+
+TEST(BUS_LOAD_TESTS, LoadAndHeadroom)
+{
+	constexpr std::uint32_t NUMBER_OF_FRAMES = 100;
+	const HardwareInterfaceCANFrame frame = make_bus_load_test_frame(0x18FEF100, true, 8, 0xFF);
+	CANBusLoad busLoad;
+
+	EXPECT_EQ(CANBusLoad::DEFAULT_BIT_RATE, busLoad.get_bit_rate());
+	busLoad.set_bit_rate(0);
+	EXPECT_EQ(CANBusLoad::DEFAULT_BIT_RATE, busLoad.get_bit_rate());
+	busLoad.set_maximum_bus_load(150.0f);
+	EXPECT_EQ(100.0f, busLoad.get_maximum_bus_load());
+	busLoad.set_maximum_bus_load(70.0f);
+
+	busLoad.reset();
+	for (std::uint32_t i = 0; i < NUMBER_OF_FRAMES; i++)
+	{
+		busLoad.add_frame(frame);
+	}
+	// The slot that's still filling isn't counted yet
+	EXPECT_EQ(0.0f, busLoad.get_bus_load());
+	EXPECT_EQ(70.0f, busLoad.get_headroom());
+
+	// Depending on when in a slot it was reset, the frames are spread over 1 or 2 full slots
+	std::this_thread::sleep_for(std::chrono::milliseconds(CANBusLoad::SLOT_MS + (CANBusLoad::SLOT_MS / 2)));
+	const float busLoadPercent = busLoad.get_bus_load();
+	const float oneSlotBusLoad = (100.0f * 146 * NUMBER_OF_FRAMES) / (CANBusLoad::DEFAULT_BIT_RATE * (CANBusLoad::SLOT_MS / 1000.0f));
+	EXPECT_TRUE((std::abs(busLoadPercent - oneSlotBusLoad) < 0.01f) ||
+	            (std::abs(busLoadPercent - (oneSlotBusLoad / 2)) < 0.01f));
+	EXPECT_NEAR(std::max(70.0f - busLoadPercent, 0.0f), busLoad.get_headroom(), 0.01f);
+	EXPECT_NEAR(static_cast<float>(busLoad.get_headroom_bits_per_second()), busLoad.get_headroom() * CANBusLoad::DEFAULT_BIT_RATE / 100.0f, 1.0f);
+
+	// Once the frames are older than the window, the bus is idle again
+	std::this_thread::sleep_for(std::chrono::milliseconds(CANBusLoad::WINDOW_MS + CANBusLoad::SLOT_MS));
+	EXPECT_EQ(0.0f, busLoad.get_bus_load());
+	EXPECT_EQ(175000u, busLoad.get_headroom_bits_per_second());
+}
+
+TEST(BUS_LOAD_TESTS, SlotsAreReusedEachWindow)
+{
+	constexpr std::uint32_t NUMBER_OF_WINDOWS = 3;
+	CANBusLoad busLoad;
+
+	// Slots that come around again start over rather than adding to what they had a window ago
+	busLoad.reset();
+	for (std::uint32_t i = 0; i < NUMBER_OF_WINDOWS * (CANBusLoad::WINDOW_MS / CANBusLoad::SLOT_MS); i++)
+	{
+		busLoad.add_frame_bits(25000);
+		std::this_thread::sleep_for(std::chrono::milliseconds(CANBusLoad::SLOT_MS));
+	}
+
+	// A slot has at most 25000 bits, which is 100% of a 250 kbit/s bus for 100 ms, and one
+	// that was skipped because the thread slept a little longer has none
+	EXPECT_GE(100.0f, busLoad.get_bus_load());
+	EXPECT_LT(0.0f, busLoad.get_bus_load());
+}
+
+TEST(BUS_LOAD_TESTS, NetworkManagerCountsFramesWhenEnabled)
+{
+	HardwareInterfaceCANFrame frame = make_bus_load_test_frame(0x18FEF11C, true, 8, 0xFF);
+
+	EXPECT_EQ(nullptr, CANNetworkManager::CANNetwork.get_bus_load(CAN_PORT_MAXIMUM));
+	ASSERT_NE(nullptr, CANNetworkManager::CANNetwork.get_bus_load(0));
+	EXPECT_FALSE(CANNetworkManager::CANNetwork.get_bus_load_enabled());
+	CANNetworkManager::CANNetwork.get_bus_load(0)->reset();
+	CANNetworkManager::CANNetwork.get_bus_load(1)->reset();
+
+	// The hardware interface counts frames by default, so the network manager doesn't count them again
+	for (std::uint8_t i = 0; i < 10; i++)
+	{
+		raw_can_glue(frame, nullptr);
+	}
+	std::this_thread::sleep_for(std::chrono::milliseconds(CANBusLoad::SLOT_MS + (CANBusLoad::SLOT_MS / 2)));
+	update_CAN_network();
+	EXPECT_EQ(0.0f, CANNetworkManager::CANNetwork.get_bus_load(0)->get_bus_load());
+
+	CANNetworkManager::CANNetwork.set_bus_load_enabled(true);
+	CANNetworkManager::CANNetwork.get_bus_load(0)->reset();
+	for (std::uint8_t i = 0; i < 10; i++)
+	{
+		raw_can_glue(frame, nullptr);
+	}
+	std::this_thread::sleep_for(std::chrono::milliseconds(CANBusLoad::SLOT_MS + (CANBusLoad::SLOT_MS / 2)));
+	update_CAN_network();
+	CANNetworkManager::CANNetwork.set_bus_load_enabled(false);
+
+	EXPECT_LT(0.0f, CANNetworkManager::CANNetwork.get_bus_load(0)->get_bus_load());
+	EXPECT_EQ(0.0f, CANNetworkManager::CANNetwork.get_bus_load(1)->get_bus_load());
+}
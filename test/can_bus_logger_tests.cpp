@@ -0,0 +1,170 @@
+#include <gtest/gtest.h>
+
+#include "isobus/hardware_integration/can_bus_log_file.hpp"
+#include "isobus/hardware_integration/can_bus_logger.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace isobus;
+
+static HardwareInterfaceCANFrame make_test_frame(std::uint32_t frameNumber)
+{
+	HardwareInterfaceCANFrame frame;
+
+	// Mostly periodic broadcasts from a few sources, with a counter in the first byte
+	frame.timestamp_us = 1000000 + (frameNumber * 500);
+	frame.channel = frameNumber % 2;
+	frame.isExtendedFrame = (0 != (frameNumber % 10));
+	frame.identifier = frame.isExtendedFrame ? (0x18FE0000 | ((frameNumber % 4) << 8) | (0x80 + (frameNumber % 3))) : 0x123;
+	frame.dataLength = 8;
+	for (std::uint8_t i = 0; i < 8; i++)
+	{
+		frame.data[i] = 0xFF;
+	}
+	frame.data[0] = static_cast<std::uint8_t>(frameNumber / 120);
+	return frame;
+}
+
+TEST(CAN_BUS_LOGGER_TESTS, WriteSeekAndFilter)
+{
+	constexpr std::uint32_t NUMBER_OF_FRAMES = 10000;
+	CANBusLogger logger;
+	CANBusLogFile logFile;
+	HardwareInterfaceCANFrame frame;
+	std::uint32_t numberOfFrames = 0;
+	std::uint32_t numberOfMatchingFrames = 0;
+	bool transmitted = false;
+
+	ASSERT_TRUE(logger.start("can_bus_logger_test"));
+	EXPECT_FALSE(logger.start("can_bus_logger_test"));
+	for (std::uint32_t i = 0; i < NUMBER_OF_FRAMES; i++)
+	{
+		while (!logger.log_frame(make_test_frame(i), (0 == (i % 7))))
+		{
+			// The queue is full, so give the writer thread a chance to catch up
+			std::this_thread::yield();
+		}
+	}
+	logger.stop();
+	EXPECT_FALSE(logger.get_is_running());
+	EXPECT_EQ(NUMBER_OF_FRAMES, logger.get_number_logged_frames());
+	EXPECT_EQ(0u, logger.get_number_write_errors());
+	ASSERT_EQ(1u, logger.get_file_names().size());
+
+	ASSERT_TRUE(logFile.open(logger.get_file_names()[0]));
+	EXPECT_TRUE(logFile.get_was_closed());
+	EXPECT_LT(1u, logFile.get_blocks().size());
+
+	while (logFile.read_frame(frame, transmitted))
+	{
+		const HardwareInterfaceCANFrame expected = make_test_frame(numberOfFrames);
+
+		ASSERT_EQ(expected.timestamp_us, frame.timestamp_us);
+		ASSERT_EQ(expected.identifier, frame.identifier);
+		ASSERT_EQ(expected.isExtendedFrame, frame.isExtendedFrame);
+		ASSERT_EQ(expected.channel, frame.channel);
+		ASSERT_EQ(expected.dataLength, frame.dataLength);
+		ASSERT_EQ(0, memcmp(expected.data, frame.data, sizeof(frame.data)));
+		ASSERT_EQ((0 == (numberOfFrames % 7)), transmitted);
+		numberOfFrames++;
+	}
+	EXPECT_EQ(NUMBER_OF_FRAMES, numberOfFrames);
+
+	// The repeated data compresses to much less than the 8 data bytes of each frame
+	std::ifstream rawFile(logger.get_file_names()[0], std::ios::binary | std::ios::ate);
+	EXPECT_GT(NUMBER_OF_FRAMES * 6u, static_cast<std::uint32_t>(rawFile.tellg()));
+
+	ASSERT_TRUE(logFile.seek_to_time(make_test_frame(7777).timestamp_us));
+	ASSERT_TRUE(logFile.read_frame(frame, transmitted));
+	EXPECT_EQ(make_test_frame(7777).timestamp_us, frame.timestamp_us);
+	EXPECT_FALSE(logFile.seek_to_time(make_test_frame(NUMBER_OF_FRAMES).timestamp_us));
+
+	logFile.rewind();
+	logFile.set_parameter_group_number_filter(0xFE01);
+	while (logFile.read_frame(frame, transmitted))
+	{
+		EXPECT_EQ(0x18FE0100u, (frame.identifier & 0xFFFFFF00));
+		numberOfMatchingFrames++;
+	}
+	// Every fourth frame, which are all odd so none of them are the standard frames
+	EXPECT_EQ(NUMBER_OF_FRAMES / 4, numberOfMatchingFrames);
+
+	logFile.close();
+	std::remove(logger.get_file_names()[0].c_str());
+}
+
+TEST(CAN_BUS_LOGGER_TESTS, RotateAndRecoverUnclosedFile)
+{
+	constexpr std::uint32_t NUMBER_OF_FRAMES = 20000;
+	CANBusLogger logger;
+	CANBusLogFile logFile;
+	HardwareInterfaceCANFrame frame;
+	std::vector<std::string> fileNames;
+	std::uint32_t numberOfFrames = 0;
+	bool transmitted = false;
+
+	logger.set_maximum_file_size(50000);
+	ASSERT_TRUE(logger.start("can_bus_logger_rotation_test"));
+	for (std::uint32_t i = 0; i < NUMBER_OF_FRAMES; i++)
+	{
+		while (!logger.log_frame(make_test_frame(i), false))
+		{
+			std::this_thread::yield();
+		}
+	}
+	logger.stop();
+	fileNames = logger.get_file_names();
+	ASSERT_LT(1u, fileNames.size());
+	EXPECT_EQ("can_bus_logger_rotation_test_0001.canlog", fileNames[1]);
+
+	for (std::size_t i = 0; i < fileNames.size(); i++)
+	{
+		ASSERT_TRUE(logFile.open(fileNames[i]));
+		EXPECT_EQ(i, logFile.get_sequence_number());
+		EXPECT_TRUE(logFile.get_was_closed());
+
+		while (logFile.read_frame(frame, transmitted))
+		{
+			ASSERT_EQ(make_test_frame(numberOfFrames).timestamp_us, frame.timestamp_us);
+			numberOfFrames++;
+		}
+	}
+	EXPECT_EQ(NUMBER_OF_FRAMES, numberOfFrames);
+
+	// Cut the index and half of the last block off, like the logger stopped mid-write
+	std::ifstream closedFile(fileNames[0], std::ios::binary);
+	std::vector<char> contents((std::istreambuf_iterator<char>(closedFile)), std::istreambuf_iterator<char>());
+	ASSERT_TRUE(logFile.open(fileNames[0]));
+	const CANBusLogFormat::BlockInfo lastBlock = logFile.get_blocks().back();
+	const std::size_t numberOfCompleteBlocks = logFile.get_blocks().size() - 1;
+	std::uint32_t numberOfRecoveredFrames = 0;
+	logFile.close();
+	contents.resize(static_cast<std::size_t>(lastBlock.fileOffset + CANBusLogFormat::BLOCK_HEADER_SIZE + (lastBlock.payloadSize / 2)));
+	std::ofstream unclosedFile("can_bus_logger_unclosed_test.canlog", std::ios::binary | std::ios::trunc);
+	unclosedFile.write(contents.data(), static_cast<std::streamsize>(contents.size()));
+	unclosedFile.close();
+
+	ASSERT_TRUE(logFile.open("can_bus_logger_unclosed_test.canlog"));
+	EXPECT_FALSE(logFile.get_was_closed());
+	ASSERT_EQ(numberOfCompleteBlocks, logFile.get_blocks().size());
+	while (logFile.read_frame(frame, transmitted))
+	{
+		ASSERT_EQ(make_test_frame(numberOfRecoveredFrames).timestamp_us, frame.timestamp_us);
+		numberOfRecoveredFrames++;
+	}
+	EXPECT_EQ(lastBlock.fileOffset, logFile.get_blocks().back().fileOffset + CANBusLogFormat::BLOCK_HEADER_SIZE + logFile.get_blocks().back().payloadSize);
+	EXPECT_LT(0u, numberOfRecoveredFrames);
+	logFile.close();
+
+	std::remove("can_bus_logger_unclosed_test.canlog");
+	for (const std::string &fileName : fileNames)
+	{
+		std::remove(fileName.c_str());
+	}
+}
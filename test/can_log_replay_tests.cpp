@@ -0,0 +1,138 @@
+#include <gtest/gtest.h>
+
+#include "isobus/hardware_integration/can_log_reader.hpp"
+#include "isobus/hardware_integration/can_log_replay.hpp"
+#include "isobus/isobus/can_network_manager.hpp"
+
+#include <sstream>
+
+using namespace isobus;
+
+TEST(CAN_LOG_REPLAY_TESTS, ReadCandumpLog)
+{
+	std::istringstream log("(1436509052.249713) can0 18EF1C1D#0102030405060708\n"
+	                       "(1436509052.250000) can1 123#\n"
+	                       "(1436509052.251000) can0 123##1112233\n"
+	                       "(1436509052.252000) can0 18EF1C1D#R\n"
+	                       "this line is not a frame\n"
+	                       "  can1  0CFE6CEE   [3]  AA BB CC\n");
+	CANLogReader reader;
+	HardwareInterfaceCANFrame frame;
+
+	reader.open(log);
+	ASSERT_TRUE(reader.read_frame(frame));
+	EXPECT_EQ(CANLogReader::Format::Candump, reader.get_format());
+	EXPECT_EQ(1436509052249713u, frame.timestamp_us);
+	EXPECT_EQ(0x18EF1C1Du, frame.identifier);
+	EXPECT_TRUE(frame.isExtendedFrame);
+	EXPECT_EQ(0, frame.channel);
+	ASSERT_EQ(8, frame.dataLength);
+	EXPECT_EQ(0x01, frame.data[0]);
+	EXPECT_EQ(0x08, frame.data[7]);
+
+	ASSERT_TRUE(reader.read_frame(frame));
+	EXPECT_EQ(0x123u, frame.identifier);
+	EXPECT_FALSE(frame.isExtendedFrame);
+	EXPECT_EQ(1, frame.channel);
+	EXPECT_EQ(0, frame.dataLength);
+
+	// The CAN FD frame, remote frame and text are skipped
+	ASSERT_TRUE(reader.read_frame(frame));
+	EXPECT_EQ(0x0CFE6CEEu, frame.identifier);
+	EXPECT_EQ(1, frame.channel);
+	ASSERT_EQ(3, frame.dataLength);
+	EXPECT_EQ(0xCC, frame.data[2]);
+	EXPECT_EQ(3u, reader.get_number_skipped_lines());
+
+	EXPECT_FALSE(reader.read_frame(frame));
+	ASSERT_EQ(2u, reader.get_channel_names().size());
+	EXPECT_EQ("can1", reader.get_channel_names()[1]);
+}
+
+TEST(CAN_LOG_REPLAY_TESTS, ReadVectorASCLog)
+{
+	std::istringstream log("date Tue Sep 13 10:00:00.000 am 2022\r\n"
+	                       "base hex  timestamps absolute\r\n"
+	                       "internal events logged\r\n"
+	                       "Begin Triggerblock Tue Sep 13 10:00:00.000 am 2022\r\n"
+	                       "   0.001500 1  18EF1C1Dx       Rx   d 8 01 02 03 04 05 06 07 08  Length = 272000 BitCount = 139 ID = 418323485x\r\n"
+	                       "   0.002000 1  ErrorFrame\r\n"
+	                       "   0.010000 2  7DF             Tx   d 2 3E 80\r\n"
+	                       "End TriggerBlock\r\n");
+	std::istringstream decimalLog("base dec  timestamps relative\n"
+	                              "   1.5 1  418323485x  Rx   d 2 10 255\n"
+	                              "   0.25 3  100  Rx   d 0\n");
+	CANLogReader reader;
+	HardwareInterfaceCANFrame frame;
+
+	reader.open(log);
+	ASSERT_TRUE(reader.read_frame(frame));
+	EXPECT_EQ(CANLogReader::Format::VectorASC, reader.get_format());
+	EXPECT_EQ(1500u, frame.timestamp_us);
+	EXPECT_EQ(0x18EF1C1Du, frame.identifier);
+	EXPECT_TRUE(frame.isExtendedFrame);
+	EXPECT_EQ(0, frame.channel);
+	ASSERT_EQ(8, frame.dataLength);
+	EXPECT_EQ(0x08, frame.data[7]);
+
+	ASSERT_TRUE(reader.read_frame(frame));
+	EXPECT_EQ(10000u, frame.timestamp_us);
+	EXPECT_EQ(0x7DFu, frame.identifier);
+	EXPECT_FALSE(frame.isExtendedFrame);
+	EXPECT_EQ(1, frame.channel);
+	ASSERT_EQ(2, frame.dataLength);
+	EXPECT_EQ(0x80, frame.data[1]);
+	EXPECT_FALSE(reader.read_frame(frame));
+	EXPECT_EQ(6u, reader.get_number_skipped_lines());
+
+	reader.open(decimalLog);
+	ASSERT_TRUE(reader.read_frame(frame));
+	EXPECT_EQ(1500000u, frame.timestamp_us);
+	EXPECT_EQ(0x18EF1C1Du, frame.identifier);
+	EXPECT_EQ(10, frame.data[0]);
+	EXPECT_EQ(255, frame.data[1]);
+	ASSERT_TRUE(reader.read_frame(frame));
+	EXPECT_EQ(1750000u, frame.timestamp_us);
+	EXPECT_EQ(100u, frame.identifier);
+	EXPECT_EQ(2, frame.channel);
+	EXPECT_EQ(0, frame.dataLength);
+}
+
+static std::uint32_t numberOfReplayedMessages = 0;
+
+static void count_replayed_message(CANMessage *message, void *)
+{
+	if ((nullptr != message) && (0x1C == message->get_identifier().get_source_address()))
+	{
+		numberOfReplayedMessages++;
+	}
+}
+
+TEST(CAN_LOG_REPLAY_TESTS, ReplayThroughNetworkManager)
+{
+	// An address claim, so the stack knows about 0x1C, then some broadcasts from it
+	std::istringstream log("(10.000000) can0 18EEFF1C#0000A0000A8000A0\n"
+	                       "(10.001000) can0 18FEF11C#FFFFFFFFFFFFFFFF\n"
+	                       "(10.002000) can0 18FEF11C#FFFFFFFFFFFFFFFF\n"
+	                       "(10.003000) can0 18FEF11C#FFFFFFFFFFFFFFFF\n"
+	                       "(10.004000) can7 18FEF11C#FFFFFFFFFFFFFFFF\n"
+	                       "(10.020000) can0 18FEF11C#FFFFFFFFFFFFFFFF\n");
+	CANLogReader reader;
+	CANLogReplay::Statistics statistics;
+
+	numberOfReplayedMessages = 0;
+	CANNetworkManager::CANNetwork.add_global_parameter_group_number_callback(0xFEF1, count_replayed_message, nullptr);
+
+	reader.open(log);
+	ASSERT_TRUE(CANLogReplay::replay(reader, CANLogReplay::Timing::Recorded, statistics));
+
+	EXPECT_EQ(6u, statistics.numberOfFrames);
+	EXPECT_EQ(0u, statistics.numberSkippedFrames);
+	EXPECT_EQ(20000u, statistics.logDuration_us);
+	EXPECT_LE(20000u, statistics.elapsedTime_us);
+
+	// 0x1C only claimed an address on can0, so its broadcast on can7 has no source control function
+	EXPECT_EQ(4u, numberOfReplayedMessages);
+
+	CANNetworkManager::CANNetwork.remove_global_parameter_group_number_callback(0xFEF1, count_replayed_message, nullptr);
+}
@@ -0,0 +1,192 @@
+#include <gtest/gtest.h>
+
+#include "isobus/isobus/can_general_parameter_group_numbers.hpp"
+#include "isobus/isobus/can_internal_control_function.hpp"
+#include "isobus/isobus/can_parameter_group_number_request_protocol.hpp"
+#include "isobus/hardware_integration/can_hardware_interface.hpp"
+#include "isobus/isobus/isobus_diagnostic_protocol.hpp"
+#include "isobus/utility/system_timing.hpp"
+#include "test_CAN_glue.hpp"
+
+#include <chrono>
+#include <memory>
+#include <thread>
+
+using namespace isobus;
+
+static std::shared_ptr<InternalControlFunction> make_diagnostic_test_control_function(std::uint8_t address)
+{
+	NAME testNAME(0);
+
+	testNAME.set_arbitrary_address_capable(true);
+	testNAME.set_industry_group(1);
+	testNAME.set_function_code(130);
+	testNAME.set_identity_number(0x3D00 + address);
+	testNAME.set_manufacturer_code(69);
+	// Port 1, and never updated, so it doesn't claim an address on the bus other tests use
+	return std::make_shared<InternalControlFunction>(testNAME, address, 1);
+}
+
+// Hands a DM22 request for the SPN straight to the stack on port 1, and lets the stack process it
+static void receive_dm22_request(std::uint8_t address, std::uint8_t partnerAddress, std::uint32_t suspectParameterNumber)
+{
+	HardwareInterfaceCANFrame frame = make_test_can_frame((0x18C30000 | (address << 8) | partnerAddress),
+	                                                      { 0x11, 0xFF, 0xFF, 0xFF, 0xFF, 0x00, 0x00, 0x00 });
+
+	frame.channel = 1;
+	frame.data[5] = static_cast<std::uint8_t>(suspectParameterNumber & 0xFF);
+	frame.data[6] = static_cast<std::uint8_t>((suspectParameterNumber >> 8) & 0xFF);
+	frame.data[7] = static_cast<std::uint8_t>(((suspectParameterNumber >> 16) << 5) | 0x01);
+	raw_can_glue(frame, nullptr);
+	update_CAN_network();
+}
+
+// Gets the stack's channel going again, without the update thread, so the test decides when the stack sends
+static void resume_test_bus_transmit(VirtualCANPlugin &stackNode)
+{
+	CANHardwareInterface::set_number_of_can_channels(2);
+	CANHardwareInterface::assign_can_channel_frame_handler(1, &stackNode);
+	CANHardwareInterface::start();
+}
+
+TEST(DIAGNOSTIC_PROTOCOL_TESTS, AssignAndDeassign)
+{
+	std::shared_ptr<InternalControlFunction> testControlFunction = make_diagnostic_test_control_function(0x3D);
+
+	EXPECT_EQ(nullptr, DiagnosticProtocol::get_diagnostic_protocol_by_internal_control_function(testControlFunction));
+	EXPECT_TRUE(DiagnosticProtocol::assign_diagnostic_protocol_to_internal_control_function(testControlFunction));
+	EXPECT_FALSE(DiagnosticProtocol::assign_diagnostic_protocol_to_internal_control_function(testControlFunction));
+	EXPECT_NE(nullptr, DiagnosticProtocol::get_diagnostic_protocol_by_internal_control_function(testControlFunction));
+
+	// The protocol is only listed once, so nothing is left of it once it's deassigned
+	EXPECT_TRUE(DiagnosticProtocol::deassign_diagnostic_protocol_to_internal_control_function(testControlFunction));
+	EXPECT_EQ(nullptr, DiagnosticProtocol::get_diagnostic_protocol_by_internal_control_function(testControlFunction));
+	EXPECT_FALSE(DiagnosticProtocol::deassign_diagnostic_protocol_to_internal_control_function(testControlFunction));
+	EXPECT_EQ(nullptr, ParameterGroupNumberRequestProtocol::get_pgn_request_protocol_by_internal_control_function(testControlFunction));
+}
+
+TEST(DIAGNOSTIC_PROTOCOL_TESTS, EncodeDM1)
+{
+	std::shared_ptr<InternalControlFunction> testControlFunction = make_diagnostic_test_control_function(0x3E);
+	const DiagnosticProtocol::DiagnosticTroubleCode firstDTC(0x5ABCD, DiagnosticProtocol::FailureModeIdentifier::VoltageAboveNormal, DiagnosticProtocol::LampStatus::None);
+	const DiagnosticProtocol::DiagnosticTroubleCode secondDTC(0x00102, DiagnosticProtocol::FailureModeIdentifier::DataErratic, DiagnosticProtocol::LampStatus::None);
+	std::vector<std::uint8_t> payload;
+
+	ASSERT_TRUE(DiagnosticProtocol::assign_diagnostic_protocol_to_internal_control_function(testControlFunction));
+	DiagnosticProtocol *protocol = DiagnosticProtocol::get_diagnostic_protocol_by_internal_control_function(testControlFunction);
+	ASSERT_NE(nullptr, protocol);
+
+	// No DTCs is a full frame, with the unused bytes padded
+	ASSERT_TRUE(protocol->encode_diagnostic_message_1(payload));
+	EXPECT_EQ((std::vector<std::uint8_t>{ 0xFF, 0xFF, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF }), payload);
+
+	// So is one DTC
+	protocol->set_diagnostic_trouble_code_active(firstDTC, true);
+	ASSERT_TRUE(protocol->encode_diagnostic_message_1(payload));
+	EXPECT_EQ((std::vector<std::uint8_t>{ 0xFF, 0xFF, 0xCD, 0xAB, 0xA3, 0x01, 0xFF, 0xFF }), payload);
+
+	// More DTCs than fit in one frame need no padding
+	protocol->set_diagnostic_trouble_code_active(secondDTC, true);
+	ASSERT_TRUE(protocol->encode_diagnostic_message_1(payload));
+	EXPECT_EQ((std::vector<std::uint8_t>{ 0xFF, 0xFF, 0xCD, 0xAB, 0xA3, 0x01, 0x02, 0x01, 0x02, 0x01 }), payload);
+
+	EXPECT_TRUE(DiagnosticProtocol::deassign_diagnostic_protocol_to_internal_control_function(testControlFunction));
+}
+
+TEST(DIAGNOSTIC_PROTOCOL_TESTS, IdentificationIsCached)
+{
+	std::shared_ptr<InternalControlFunction> testControlFunction = make_diagnostic_test_control_function(0x3F);
+	const std::uint32_t ecuIdentificationPGN = static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUIdentificationInformation);
+	const std::uint32_t softwareIdentificationPGN = static_cast<std::uint32_t>(CANLibParameterGroupNumber::SoftwareIdentification);
+	std::uint32_t ecuVersion = 0;
+	std::uint32_t softwareVersion = 0;
+
+	ASSERT_TRUE(DiagnosticProtocol::assign_diagnostic_protocol_to_internal_control_function(testControlFunction));
+	DiagnosticProtocol *protocol = DiagnosticProtocol::get_diagnostic_protocol_by_internal_control_function(testControlFunction);
+	ParameterGroupNumberRequestProtocol *pgnRequestProtocol = ParameterGroupNumberRequestProtocol::get_pgn_request_protocol_by_internal_control_function(testControlFunction);
+	ASSERT_NE(nullptr, protocol);
+	ASSERT_NE(nullptr, pgnRequestProtocol);
+
+	// The ECU ID always has something to say, but there's no software ID until a field is set
+	EXPECT_TRUE(pgnRequestProtocol->get_cached_response_version(ecuIdentificationPGN, ecuVersion));
+	EXPECT_FALSE(pgnRequestProtocol->get_cached_response_version(softwareIdentificationPGN, softwareVersion));
+
+	protocol->set_software_id_field(0, "1.2.3");
+	EXPECT_TRUE(pgnRequestProtocol->get_cached_response_version(softwareIdentificationPGN, softwareVersion));
+
+	// Changing a field publishes a new version
+	std::uint32_t newVersion = ecuVersion;
+	protocol->set_ecu_id_field(DiagnosticProtocol::ECUIdentificationFields::SerialNumber, "1234");
+	EXPECT_TRUE(pgnRequestProtocol->get_cached_response_version(ecuIdentificationPGN, newVersion));
+	EXPECT_NE(ecuVersion, newVersion);
+
+	// With no software ID fields left, requests for it are NACKed by the callback again
+	protocol->clear_software_id_fields();
+	EXPECT_FALSE(pgnRequestProtocol->get_cached_response_version(softwareIdentificationPGN, softwareVersion));
+
+	EXPECT_TRUE(DiagnosticProtocol::deassign_diagnostic_protocol_to_internal_control_function(testControlFunction));
+}
+
+TEST(DIAGNOSTIC_PROTOCOL_TESTS, DM22ResponseQueue)
+{
+	constexpr std::uint8_t ADDRESS = 0x65;
+	constexpr std::uint8_t PARTNER_ADDRESS = 0x66;
+	constexpr std::uint32_t RESPONSE_IDENTIFIER = (0x18C30000 | (PARTNER_ADDRESS << 8) | ADDRESS);
+	constexpr std::uint32_t QUEUE_SIZE = 16;
+	VirtualCANPlugin stackNode("dm22_queue_test");
+	VirtualCANPlugin peerNode("dm22_queue_test");
+	PartneredControlFunction *partner = nullptr;
+	HardwareInterfaceCANFrame frame;
+
+	std::shared_ptr<InternalControlFunction> testControlFunction = start_virtual_test_bus(stackNode, peerNode, ADDRESS, partner, PARTNER_ADDRESS);
+	ASSERT_TRUE(testControlFunction->get_address_valid());
+	ASSERT_TRUE(partner->get_address_valid());
+	ASSERT_TRUE(DiagnosticProtocol::assign_diagnostic_protocol_to_internal_control_function(testControlFunction));
+	DiagnosticProtocol *protocol = DiagnosticProtocol::get_diagnostic_protocol_by_internal_control_function(testControlFunction);
+	ASSERT_NE(nullptr, protocol);
+	ASSERT_TRUE(wait_for_test_condition([protocol]() { return protocol->get_is_initialized(); }));
+
+	// With the hardware stopped every send fails, so the responses stay queued
+	stop_virtual_test_bus();
+	for (std::uint32_t i = 1; i <= QUEUE_SIZE; i++)
+	{
+		receive_dm22_request(ADDRESS, PARTNER_ADDRESS, i);
+	}
+	update_CAN_network();
+	resume_test_bus_transmit(stackNode);
+
+	// A request that arrives when the queue is full is NACKed right away, ahead of everything queued
+	receive_dm22_request(ADDRESS, PARTNER_ADDRESS, QUEUE_SIZE + 1);
+	ASSERT_TRUE(read_test_can_frame(peerNode, RESPONSE_IDENTIFIER, frame));
+	EXPECT_EQ(0x13, frame.data[0]);
+	EXPECT_EQ(0x00, frame.data[1]); // General NACK
+	EXPECT_EQ(QUEUE_SIZE + 1, frame.data[5]);
+
+	// The queued responses went out in the order the requests came in, despite the failed sends
+	for (std::uint32_t i = 1; i <= QUEUE_SIZE; i++)
+	{
+		ASSERT_TRUE(read_test_can_frame(peerNode, RESPONSE_IDENTIFIER, frame));
+		EXPECT_EQ(0x13, frame.data[0]);
+		EXPECT_EQ(0x02, frame.data[1]); // Unknown or does not exist
+		EXPECT_EQ(i, frame.data[5]);
+	}
+
+	// A response that can't be sent within 1250ms is dropped
+	CANHardwareInterface::stop();
+	CANHardwareInterface::set_number_of_can_channels(0);
+	receive_dm22_request(ADDRESS, PARTNER_ADDRESS, 0x20);
+	const std::uint32_t queuedTimestamp_ms = SystemTiming::get_timestamp_ms();
+	while (!SystemTiming::time_expired_ms(queuedTimestamp_ms, 1300))
+	{
+		update_CAN_network();
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	}
+	resume_test_bus_transmit(stackNode);
+	receive_dm22_request(ADDRESS, PARTNER_ADDRESS, 0x21);
+	ASSERT_TRUE(read_test_can_frame(peerNode, RESPONSE_IDENTIFIER, frame));
+	EXPECT_EQ(0x21, frame.data[5]);
+
+	CANHardwareInterface::stop();
+	CANHardwareInterface::set_number_of_can_channels(0);
+	EXPECT_TRUE(DiagnosticProtocol::deassign_diagnostic_protocol_to_internal_control_function(testControlFunction));
+}
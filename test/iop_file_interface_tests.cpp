@@ -0,0 +1,103 @@
+#include <gtest/gtest.h>
+
+#include "isobus/utility/iop_file_interface.hpp"
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace isobus;
+
+// Writes a file with the given contents, replacing any file that was there before
+static void write_test_file(const std::string &fileName, const std::vector<std::uint8_t> &contents)
+{
+	std::ofstream file(fileName, std::ios::binary | std::ios::trunc);
+
+	file.write(reinterpret_cast<const char *>(contents.data()), static_cast<std::streamsize>(contents.size()));
+}
+
+// Makes a pool sized file with a pattern that doesn't repeat on any power of two boundary
+static std::vector<std::uint8_t> make_test_file_contents(std::uint32_t size)
+{
+	std::vector<std::uint8_t> retVal(size);
+
+	for (std::uint32_t i = 0; i < size; i++)
+	{
+		retVal[i] = static_cast<std::uint8_t>(i % 251);
+	}
+	return retVal;
+}
+
+TEST(IOP_FILE_INTERFACE_TESTS, ReadReturnsTheFileContents)
+{
+	const std::vector<std::uint8_t> contents = make_test_file_contents(70000);
+
+	write_test_file("iop_file_interface_test.iop", contents);
+	EXPECT_EQ(contents, IOPFileInterface::read_iop_file("iop_file_interface_test.iop"));
+
+	// Empty and missing files have no pool in them
+	write_test_file("iop_file_interface_test.iop", std::vector<std::uint8_t>());
+	EXPECT_TRUE(IOPFileInterface::read_iop_file("iop_file_interface_test.iop").empty());
+	std::remove("iop_file_interface_test.iop");
+	EXPECT_TRUE(IOPFileInterface::read_iop_file("iop_file_interface_test.iop").empty());
+}
+
+TEST(IOP_FILE_INTERFACE_TESTS, MappedFileMatchesTheFile)
+{
+	const std::vector<std::uint8_t> contents = make_test_file_contents(70000);
+	MappedIOPFile mappedFile;
+
+	EXPECT_FALSE(mappedFile.get_is_open());
+	EXPECT_EQ(nullptr, mappedFile.get_data());
+	EXPECT_EQ(0u, mappedFile.get_size());
+
+	write_test_file("iop_file_interface_mapped_test.iop", contents);
+	ASSERT_TRUE(mappedFile.open("iop_file_interface_mapped_test.iop"));
+	EXPECT_TRUE(mappedFile.get_is_open());
+	ASSERT_EQ(contents.size(), mappedFile.get_size());
+	EXPECT_EQ(contents, std::vector<std::uint8_t>(mappedFile.get_data(), mappedFile.get_data() + mappedFile.get_size()));
+
+	// Reopening replaces the old mapping with the new file
+	const std::vector<std::uint8_t> otherContents = make_test_file_contents(100);
+	write_test_file("iop_file_interface_mapped_other_test.iop", otherContents);
+	ASSERT_TRUE(mappedFile.open("iop_file_interface_mapped_other_test.iop"));
+	ASSERT_EQ(otherContents.size(), mappedFile.get_size());
+	EXPECT_EQ(otherContents, std::vector<std::uint8_t>(mappedFile.get_data(), mappedFile.get_data() + mappedFile.get_size()));
+
+	mappedFile.close();
+	EXPECT_FALSE(mappedFile.get_is_open());
+	EXPECT_EQ(nullptr, mappedFile.get_data());
+	EXPECT_EQ(0u, mappedFile.get_size());
+
+	// Closing again does nothing
+	mappedFile.close();
+	EXPECT_FALSE(mappedFile.get_is_open());
+
+	std::remove("iop_file_interface_mapped_test.iop");
+	std::remove("iop_file_interface_mapped_other_test.iop");
+}
+
+TEST(IOP_FILE_INTERFACE_TESTS, MappedFileRejectsEmptyAndMissingFiles)
+{
+	MappedIOPFile mappedFile;
+
+	write_test_file("iop_file_interface_empty_test.iop", std::vector<std::uint8_t>());
+	EXPECT_FALSE(mappedFile.open("iop_file_interface_empty_test.iop"));
+	EXPECT_FALSE(mappedFile.get_is_open());
+	EXPECT_EQ(nullptr, mappedFile.get_data());
+	EXPECT_EQ(0u, mappedFile.get_size());
+	std::remove("iop_file_interface_empty_test.iop");
+
+	EXPECT_FALSE(mappedFile.open("iop_file_interface_missing_test.iop"));
+	EXPECT_FALSE(mappedFile.get_is_open());
+
+	// A failed open also closes the file that was open before it
+	write_test_file("iop_file_interface_empty_test.iop", make_test_file_contents(10));
+	ASSERT_TRUE(mappedFile.open("iop_file_interface_empty_test.iop"));
+	EXPECT_FALSE(mappedFile.open("iop_file_interface_missing_test.iop"));
+	EXPECT_FALSE(mappedFile.get_is_open());
+	EXPECT_EQ(nullptr, mappedFile.get_data());
+	EXPECT_EQ(0u, mappedFile.get_size());
+	std::remove("iop_file_interface_empty_test.iop");
+}
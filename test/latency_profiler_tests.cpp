@@ -0,0 +1,121 @@
+#include <gtest/gtest.h>
+
+#include "isobus/isobus/can_latency_profiler.hpp"
+#include "isobus/isobus/can_network_manager.hpp"
+#include "test_CAN_glue.hpp"
+
+#include <sstream>
+
+using namespace isobus;
+
+static std::uint32_t numberOfProfiledMessages = 0;
+
+static void count_profiled_message(CANMessage *, void *)
+{
+	numberOfProfiledMessages++;
+}
+
+static HardwareInterfaceCANFrame make_profiler_test_frame(std::uint32_t identifier, std::uint8_t firstByte)
+{
+	HardwareInterfaceCANFrame frame;
+
+	frame.timestamp_us = 0;
+	frame.identifier = identifier;
+	frame.channel = 0;
+	frame.isExtendedFrame = true;
+	frame.dataLength = 8;
+	for (std::uint8_t i = 0; i < 8; i++)
+	{
+		frame.data[i] = 0xFF;
+	}
+	frame.data[0] = firstByte;
+	return frame;
+}
+
+TEST(LATENCY_PROFILER_TESTS, PercentileUpperLimit)
+{
+	LatencyHistogram histogram;
+
+	EXPECT_EQ(0u, histogram.get_percentile_upper_limit(50.0f));
+
+	for (std::uint32_t i = 0; i < 990; i++)
+	{
+		histogram.add_sample(10);
+	}
+	for (std::uint32_t i = 0; i < 9; i++)
+	{
+		histogram.add_sample(1000);
+	}
+	histogram.add_sample(100000);
+
+	// 10 is in the 8 to 15 bucket, and 1000 in the 512 to 1023 bucket
+	EXPECT_EQ(15u, histogram.get_percentile_upper_limit(50.0f));
+	EXPECT_EQ(15u, histogram.get_percentile_upper_limit(99.0f));
+	EXPECT_EQ(1023u, histogram.get_percentile_upper_limit(99.9f));
+	EXPECT_EQ(100000u, histogram.get_percentile_upper_limit(100.0f));
+}
+
+TEST(LATENCY_PROFILER_TESTS, RecordsOnlyWhenEnabled)
+{
+	CANLatencyProfiler::set_enabled(false);
+	CANLatencyProfiler::reset();
+	EXPECT_EQ(CANLatencyProfiler::NO_TIMESTAMP, CANLatencyProfiler::get_timestamp_us());
+	CANLatencyProfiler::record_frame_latency(CANLatencyProfiler::Stage::ChannelQueue, 0x18FEE31C, true, 0);
+	EXPECT_EQ(nullptr, CANLatencyProfiler::get_histogram(0xFEE3, CANLatencyProfiler::Stage::ChannelQueue));
+
+	CANLatencyProfiler::set_enabled(true);
+	const std::uint64_t startTimestamp_us = CANLatencyProfiler::get_timestamp_us();
+	EXPECT_NE(CANLatencyProfiler::NO_TIMESTAMP, startTimestamp_us);
+	CANLatencyProfiler::record_frame_latency(CANLatencyProfiler::Stage::ChannelQueue, 0x18FEE31C, true, startTimestamp_us);
+	CANLatencyProfiler::record_frame_latency(CANLatencyProfiler::Stage::ChannelQueue, 0x123, false, startTimestamp_us);
+	CANLatencyProfiler::record_frame_latency(CANLatencyProfiler::Stage::ChannelQueue, 0x18FEE31C, true, CANLatencyProfiler::NO_TIMESTAMP);
+	CANLatencyProfiler::set_enabled(false);
+
+	const LatencyHistogram *histogram = CANLatencyProfiler::get_histogram(0xFEE3, CANLatencyProfiler::Stage::ChannelQueue);
+	ASSERT_NE(nullptr, histogram);
+	EXPECT_EQ(1u, histogram->get_total_number_samples());
+	EXPECT_EQ(0u, CANLatencyProfiler::get_histogram(0xFEE3, CANLatencyProfiler::Stage::Callback)->get_total_number_samples());
+	EXPECT_EQ(nullptr, CANLatencyProfiler::get_histogram(0xFEE3, CANLatencyProfiler::Stage::NumberOfStages));
+
+	CANLatencyProfiler::reset();
+	EXPECT_EQ(0u, histogram->get_total_number_samples());
+}
+
+TEST(LATENCY_PROFILER_TESTS, ProfilesReceivedMessages)
+{
+	HardwareInterfaceCANFrame addressClaim = make_profiler_test_frame(0x18EEFF1D, 0x00);
+	std::ostringstream report;
+
+	CANLatencyProfiler::reset();
+	CANLatencyProfiler::set_enabled(true);
+	numberOfProfiledMessages = 0;
+	CANNetworkManager::CANNetwork.add_global_parameter_group_number_callback(0xFEF2, count_profiled_message, nullptr);
+
+	// The stack needs to be initialized and know about 0x1D for its broadcasts to reach global callbacks
+	update_CAN_network();
+	raw_can_glue(addressClaim, nullptr);
+	update_CAN_network();
+	for (std::uint8_t i = 0; i < 5; i++)
+	{
+		HardwareInterfaceCANFrame frame = make_profiler_test_frame(0x18FEF21D, i);
+
+		raw_can_glue(frame, nullptr);
+	}
+	update_CAN_network();
+	CANLatencyProfiler::set_enabled(false);
+	CANNetworkManager::CANNetwork.remove_global_parameter_group_number_callback(0xFEF2, count_profiled_message, nullptr);
+
+	EXPECT_EQ(5u, numberOfProfiledMessages);
+	const LatencyHistogram *stackQueue = CANLatencyProfiler::get_histogram(0xFEF2, CANLatencyProfiler::Stage::StackQueue);
+	const LatencyHistogram *callback = CANLatencyProfiler::get_histogram(0xFEF2, CANLatencyProfiler::Stage::Callback);
+	ASSERT_NE(nullptr, stackQueue);
+	ASSERT_NE(nullptr, callback);
+	EXPECT_EQ(5u, stackQueue->get_total_number_samples());
+	EXPECT_EQ(5u, callback->get_total_number_samples());
+	EXPECT_LE(stackQueue->get_maximum(), callback->get_maximum());
+
+	CANLatencyProfiler::write_report(report);
+	EXPECT_NE(std::string::npos, report.str().find("FEF2"));
+	EXPECT_NE(std::string::npos, report.str().find("StackQueue"));
+	CANLatencyProfiler::reset();
+}
@@ -0,0 +1,91 @@
+#include <gtest/gtest.h>
+
+#include "isobus/isobus/can_warning_logger.hpp"
+
+#include <ostream>
+#include <vector>
+
+using namespace isobus;
+
+class TestLogSink : public CANStackLogger
+{
+public:
+	void sink_CAN_stack_log(LoggingLevel level, const std::string &text) override
+	{
+		levels.push_back(level);
+		messages.push_back(text);
+	}
+
+	std::vector<LoggingLevel> levels;
+	std::vector<std::string> messages;
+};
+
+class LegacyLogSink : public CANStackLogger
+{
+public:
+	void LogCANLibWarning(const std::string &warningText) override
+	{
+		messages.push_back(warningText);
+	}
+
+	std::vector<std::string> messages;
+};
+
+struct CountedValue
+{
+	int *numberOfFormats;
+};
+
+std::ostream &operator<<(std::ostream &stream, const CountedValue &value)
+{
+	(*value.numberOfFormats)++;
+	return stream << "counted";
+}
+
+TEST(LOGGER_TESTS, FiltersByLevelBeforeFormatting)
+{
+	TestLogSink sink;
+	int numberOfFormats = 0;
+	CountedValue value = { &numberOfFormats };
+
+	// Without a sink nothing is formatted
+	CANStackLogger::set_can_stack_logger_sink(nullptr);
+	CANStackLogger::error("[Test]: ", value);
+	EXPECT_EQ(0, numberOfFormats);
+	EXPECT_FALSE(CANStackLogger::get_log_level_enabled(CANStackLogger::LoggingLevel::Critical));
+
+	CANStackLogger::set_can_stack_logger_sink(&sink);
+	CANStackLogger::set_log_level(CANStackLogger::LoggingLevel::Warning);
+	EXPECT_EQ(CANStackLogger::LoggingLevel::Warning, CANStackLogger::get_log_level());
+
+	CANStackLogger::debug("[Test]: ", value);
+	CANStackLogger::info("[Test]: ", value);
+	EXPECT_EQ(0, numberOfFormats);
+	EXPECT_TRUE(sink.messages.empty());
+
+	CANStackLogger::warn("[Test]: Address ", static_cast<int>(0x81), " value ", value);
+	CANStackLogger::critical("[Test]: Critical");
+	EXPECT_EQ(1, numberOfFormats);
+	ASSERT_EQ(2u, sink.messages.size());
+	EXPECT_EQ("[Test]: Address 129 value counted", sink.messages[0]);
+	EXPECT_EQ(CANStackLogger::LoggingLevel::Warning, sink.levels[0]);
+	EXPECT_EQ("[Test]: Critical", sink.messages[1]);
+	EXPECT_EQ(CANStackLogger::LoggingLevel::Critical, sink.levels[1]);
+
+	CANStackLogger::set_log_level(CANStackLogger::LoggingLevel::Info);
+	CANStackLogger::set_can_stack_logger_sink(nullptr);
+}
+
+TEST(LOGGER_TESTS, LegacySinkReceivesMessages)
+{
+	LegacyLogSink sink;
+
+	CANStackLogger::set_can_stack_logger_sink(&sink);
+	CANStackLogger::CAN_stack_log("[Test]: Plain text");
+	CANStackLogger::error("[Test]: PGN ", 0xEF00);
+	CANStackLogger::set_can_stack_logger_sink(nullptr);
+
+	ASSERT_EQ(2u, sink.messages.size());
+	EXPECT_EQ("[Test]: Plain text", sink.messages[0]);
+	EXPECT_EQ("[Test]: PGN 61184", sink.messages[1]);
+}
@@ -0,0 +1,218 @@
+#include <gtest/gtest.h>
+
+#include "isobus/hardware_integration/can_hardware_interface.hpp"
+#include "isobus/hardware_integration/virtual_can_plugin.hpp"
+#include "isobus/isobus/can_network_manager.hpp"
+#include "isobus/isobus/can_partnered_control_function.hpp"
+#include "isobus/isobus/can_protocol.hpp"
+#include "isobus/isobus/can_transport_protocol.hpp"
+#include "isobus/isobus/nmea2000_fast_packet_protocol.hpp"
+#include "test_CAN_glue.hpp"
+
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace isobus;
+
+static std::vector<CANNetworkManager *> testStacks;
+static std::mutex receivedDataMutex;
+static std::vector<std::uint8_t> receivedData;
+static std::uint8_t receivedSourceAddress = NULL_CAN_ADDRESS;
+
+static void update_test_stacks()
+{
+	for (auto stack : testStacks)
+	{
+		stack->update();
+	}
+}
+
+// Runs each stack on the channel with the same index, and each node is the driver for that channel
+static void start_test_stacks(const std::vector<CANNetworkManager *> &stacks, const std::vector<VirtualCANPlugin *> &nodes)
+{
+	CANHardwareInterface::set_number_of_can_channels(0);
+	CANHardwareInterface::set_number_of_can_channels(static_cast<std::uint8_t>(nodes.size()));
+	for (std::uint8_t i = 0; i < nodes.size(); i++)
+	{
+		CANHardwareInterface::assign_can_channel_frame_handler(i, nodes[i]);
+	}
+	for (auto stack : stacks)
+	{
+		CANHardwareInterface::add_raw_can_message_rx_callback(CANNetworkManager::can_lib_process_rx_message, stack);
+	}
+	testStacks = stacks;
+	CANHardwareInterface::add_can_lib_update_callback(update_test_stacks, nullptr);
+	CANHardwareInterface::start();
+}
+
+static void stop_test_stacks()
+{
+	CANHardwareInterface::stop();
+	CANHardwareInterface::remove_can_lib_update_callback(update_test_stacks, nullptr);
+	for (auto stack : testStacks)
+	{
+		CANHardwareInterface::remove_raw_can_message_rx_callback(CANNetworkManager::can_lib_process_rx_message, stack);
+	}
+	testStacks.clear();
+	CANHardwareInterface::set_number_of_can_channels(0);
+}
+
+static NAME make_test_NAME(std::uint8_t address)
+{
+	NAME retVal(0);
+
+	retVal.set_arbitrary_address_capable(true);
+	retVal.set_industry_group(1);
+	retVal.set_function_code(130);
+	retVal.set_identity_number(0x3000 + address);
+	retVal.set_manufacturer_code(69);
+	return retVal;
+}
+
+static void record_received_data(CANMessage *message, void *)
+{
+	const std::lock_guard<std::mutex> lock(receivedDataMutex);
+
+	receivedData = message->get_data();
+	receivedSourceAddress = message->get_identifier().get_source_address();
+}
+
+static std::vector<std::uint8_t> get_received_data()
+{
+	const std::lock_guard<std::mutex> lock(receivedDataMutex);
+	return receivedData;
+}
+
+// Sends messages from the gateway's first port out of its second port
+static void forward_test_message(CANMessage *message, void *parentPointer)
+{
+	if (0 == message->get_can_port_index())
+	{
+		std::vector<std::uint8_t> data = message->get_data();
+
+		static_cast<InternalControlFunction *>(parentPointer)->get_network_manager().send_can_message(message->get_identifier().get_parameter_group_number(), data.data(), data.size(), static_cast<InternalControlFunction *>(parentPointer));
+	}
+}
+
+TEST(NETWORK_MANAGER_TESTS, StacksHaveTheirOwnProtocols)
+{
+	CANNetworkManager stack;
+	std::uint32_t numberOfTransportProtocols = 0;
+	CANLibProtocol *protocol = nullptr;
+
+	ASSERT_EQ(3u, stack.get_number_protocols());
+	for (std::uint32_t i = 0; i < stack.get_number_protocols(); i++)
+	{
+		ASSERT_TRUE(stack.get_protocol(i, protocol));
+		EXPECT_EQ(&stack, &protocol->get_network_manager());
+		if (nullptr != dynamic_cast<TransportProtocolManager *>(protocol))
+		{
+			numberOfTransportProtocols++;
+		}
+	}
+	EXPECT_EQ(1u, numberOfTransportProtocols);
+	EXPECT_NE(&FastPacketProtocol::Protocol, &stack.get_fast_packet_protocol());
+	EXPECT_EQ(&CANNetworkManager::CANNetwork, &FastPacketProtocol::Protocol.get_network_manager());
+
+	// Only the default network manager has its ports bound to begin with
+	EXPECT_EQ(CANNetworkManager::NO_HARDWARE_CHANNEL, stack.get_hardware_channel(0));
+	EXPECT_EQ(1, CANNetworkManager::CANNetwork.get_hardware_channel(1));
+	EXPECT_TRUE(stack.set_hardware_channel(0, 7));
+	EXPECT_FALSE(stack.set_hardware_channel(1, 7));
+	EXPECT_FALSE(stack.set_hardware_channel(CAN_PORT_MAXIMUM, 8));
+	EXPECT_EQ(7, stack.get_hardware_channel(0));
+	EXPECT_TRUE(stack.set_hardware_channel(0, CANNetworkManager::NO_HARDWARE_CHANNEL));
+	EXPECT_TRUE(stack.set_hardware_channel(1, 7));
+}
+
+TEST(NETWORK_MANAGER_TESTS, IndependentStacksShareABus)
+{
+	constexpr std::uint32_t TEST_PGN = 0xEF00;
+	CANNetworkManager firstStack;
+	CANNetworkManager secondStack;
+	VirtualCANPlugin firstNode("network_manager_test_bus");
+	VirtualCANPlugin secondNode("network_manager_test_bus");
+
+	firstStack.set_hardware_channel(0, 0);
+	secondStack.set_hardware_channel(0, 1);
+	start_test_stacks({ &firstStack, &secondStack }, { &firstNode, &secondNode });
+
+	{
+		InternalControlFunction firstControlFunction(make_test_NAME(0x92), 0x92, 0, firstStack);
+		InternalControlFunction secondControlFunction(make_test_NAME(0x93), 0x93, 0, secondStack);
+		PartneredControlFunction firstPartner(0, { NAMEFilter(NAME::NAMEParameters::IdentityNumber, 0x3000 + 0x93) }, firstStack);
+		PartneredControlFunction secondPartner(0, { NAMEFilter(NAME::NAMEParameters::IdentityNumber, 0x3000 + 0x92) }, secondStack);
+		std::vector<std::uint8_t> payload(100);
+
+		for (std::uint8_t i = 0; i < payload.size(); i++)
+		{
+			payload[i] = i;
+		}
+		secondPartner.add_parameter_group_number_callback(TEST_PGN, record_received_data, nullptr);
+		receivedData.clear();
+
+		// Each stack claims on its own, and finds the other one on the bus
+		EXPECT_TRUE(wait_for_test_condition([&]() { return firstControlFunction.get_address_valid() && secondControlFunction.get_address_valid(); }));
+		EXPECT_TRUE(wait_for_test_condition([&]() { return firstPartner.get_address_valid() && secondPartner.get_address_valid(); }));
+		EXPECT_EQ(0x93, firstPartner.get_address());
+		EXPECT_EQ(0x92, secondPartner.get_address());
+
+		// A destination specific transport protocol session runs between the two stacks' protocols
+		std::this_thread::sleep_for(std::chrono::milliseconds(50));
+		ASSERT_TRUE(firstStack.send_can_message(TEST_PGN, payload.data(), payload.size(), &firstControlFunction, &firstPartner));
+		EXPECT_TRUE(wait_for_test_condition([]() { return !get_received_data().empty(); }));
+		EXPECT_EQ(payload, get_received_data());
+		EXPECT_EQ(0x92, receivedSourceAddress);
+
+		stop_test_stacks();
+	}
+}
+
+TEST(NETWORK_MANAGER_TESTS, GatewayForwardsBetweenStacks)
+{
+	constexpr std::uint32_t TEST_PGN = 0xFF10;
+	CANNetworkManager senderStack;
+	CANNetworkManager gatewayStack;
+	CANNetworkManager receiverStack;
+	VirtualCANPlugin senderNode("network_manager_gateway_bus_a");
+	VirtualCANPlugin gatewayNodeA("network_manager_gateway_bus_a");
+	VirtualCANPlugin gatewayNodeB("network_manager_gateway_bus_b");
+	VirtualCANPlugin receiverNode("network_manager_gateway_bus_b");
+
+	// The gateway is one stack with a port on each bus
+	senderStack.set_hardware_channel(0, 0);
+	gatewayStack.set_hardware_channel(0, 1);
+	gatewayStack.set_hardware_channel(1, 2);
+	receiverStack.set_hardware_channel(0, 3);
+	start_test_stacks({ &senderStack, &gatewayStack, &receiverStack }, { &senderNode, &gatewayNodeA, &gatewayNodeB, &receiverNode });
+
+	{
+		InternalControlFunction senderControlFunction(make_test_NAME(0x94), 0x94, 0, senderStack);
+		InternalControlFunction gatewayControlFunctionA(make_test_NAME(0x95), 0x95, 0, gatewayStack);
+		InternalControlFunction gatewayControlFunctionB(make_test_NAME(0x96), 0x96, 1, gatewayStack);
+		InternalControlFunction receiverControlFunction(make_test_NAME(0x97), 0x97, 0, receiverStack);
+		const std::vector<std::uint8_t> payload = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20 };
+
+		gatewayStack.add_global_parameter_group_number_callback(TEST_PGN, forward_test_message, &gatewayControlFunctionB);
+		receiverStack.add_global_parameter_group_number_callback(TEST_PGN, record_received_data, nullptr);
+		receivedData.clear();
+
+		EXPECT_TRUE(wait_for_test_condition([&]() { return senderControlFunction.get_address_valid() &&
+			                                                   gatewayControlFunctionA.get_address_valid() &&
+			                                                   gatewayControlFunctionB.get_address_valid() &&
+			                                                   receiverControlFunction.get_address_valid(); }));
+
+		// The broadcast is reassembled by the gateway's protocol on one bus, and sent again by it on the other
+		std::this_thread::sleep_for(std::chrono::milliseconds(50));
+		ASSERT_TRUE(senderStack.send_can_message(TEST_PGN, payload.data(), payload.size(), &senderControlFunction));
+		EXPECT_TRUE(wait_for_test_condition([]() { return !get_received_data().empty(); }));
+		EXPECT_EQ(payload, get_received_data());
+		EXPECT_EQ(0x96, receivedSourceAddress);
+
+		stop_test_stacks();
+		gatewayStack.remove_global_parameter_group_number_callback(TEST_PGN, forward_test_message, &gatewayControlFunctionB);
+		receiverStack.remove_global_parameter_group_number_callback(TEST_PGN, record_received_data, nullptr);
+	}
+}
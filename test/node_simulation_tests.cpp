@@ -0,0 +1,115 @@
+#include <gtest/gtest.h>
+
+#include "isobus/hardware_integration/can_hardware_interface.hpp"
+#include "isobus/hardware_integration/can_node_simulation.hpp"
+#include "isobus/isobus/can_constants.hpp"
+#include "isobus/isobus/can_network_manager.hpp"
+#include "isobus/utility/system_timing.hpp"
+#include "test_CAN_glue.hpp"
+
+#include <chrono>
+#include <mutex>
+#include <set>
+#include <thread>
+
+using namespace isobus;
+
+static std::mutex simulatedSourcesMutex;
+static std::set<std::uint8_t> simulatedSources;
+
+static void record_simulated_source(CANMessage *message, void *)
+{
+	const std::lock_guard<std::mutex> lock(simulatedSourcesMutex);
+	simulatedSources.insert(message->get_identifier().get_source_address());
+}
+
+TEST(NODE_SIMULATION_TESTS, StackSeesManySimulatedNodes)
+{
+	constexpr std::uint8_t NUMBER_OF_NODES = 30;
+	constexpr std::uint64_t BASE_NAME = 0xA00000000A800000;
+	CANNodeSimulation simulation("node_simulation_test");
+	VirtualCANPlugin stackNode("node_simulation_test");
+	VirtualCANPlugin requester("node_simulation_test");
+	HardwareInterfaceCANFrame frame;
+	std::uint32_t numberOfClaims = 0;
+	std::uint32_t numberOfCannotClaims = 0;
+
+	for (std::uint8_t i = 0; i < NUMBER_OF_NODES; i++)
+	{
+		ASSERT_TRUE(simulation.add_node(BASE_NAME + i, 0x80 + i));
+		ASSERT_TRUE(simulation.add_periodic_message(i, 0xFEF3, 6, { i, 1, 2, 3, 4, 5, 6, 7 }, 50));
+	}
+	// Wants the first node's address, but has a higher NAME so it loses
+	ASSERT_TRUE(simulation.add_node(BASE_NAME + 0x1000, 0x80));
+	EXPECT_FALSE(simulation.add_node(BASE_NAME, NULL_CAN_ADDRESS));
+	EXPECT_FALSE(simulation.add_periodic_message(NUMBER_OF_NODES + 1, 0xFEF3, 6, {}, 50));
+	EXPECT_FALSE(simulation.add_periodic_message(0, 0xFEF3, 6, std::vector<std::uint8_t>(9), 50));
+
+	simulatedSources.clear();
+	CANHardwareInterface::set_number_of_can_channels(0);
+	CANHardwareInterface::set_number_of_can_channels(1);
+	ASSERT_TRUE(CANHardwareInterface::assign_can_channel_frame_handler(0, &stackNode));
+	CANHardwareInterface::add_can_lib_update_callback(update_CAN_network, nullptr);
+	CANHardwareInterface::add_raw_can_message_rx_callback(raw_can_glue, nullptr);
+	CANNetworkManager::CANNetwork.add_global_parameter_group_number_callback(0xFEF3, record_simulated_source, nullptr);
+	ASSERT_TRUE(CANHardwareInterface::start());
+	// The network manager drops frames until its first update
+	std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+	ASSERT_TRUE(simulation.start());
+	EXPECT_FALSE(simulation.start());
+	EXPECT_FALSE(simulation.add_node(BASE_NAME + 0x2000, 0x10));
+	std::this_thread::sleep_for(std::chrono::milliseconds(CANNodeSimulation::ADDRESS_CLAIM_WAIT_MS + 200));
+
+	for (std::uint8_t i = 0; i < NUMBER_OF_NODES; i++)
+	{
+		EXPECT_EQ(CANNodeSimulation::AddressState::Claimed, simulation.get_address_state(i));
+		EXPECT_EQ(0x80 + i, simulation.get_address(i));
+	}
+	EXPECT_EQ(CANNodeSimulation::AddressState::CannotClaim, simulation.get_address_state(NUMBER_OF_NODES));
+	EXPECT_EQ(NULL_CAN_ADDRESS, simulation.get_address(NUMBER_OF_NODES));
+
+	// Every node answers a global request for the address claim
+	frame.timestamp_us = 0;
+	frame.identifier = 0x18EAFFF0;
+	frame.channel = 0;
+	frame.isExtendedFrame = true;
+	frame.dataLength = 3;
+	frame.data[0] = 0x00;
+	frame.data[1] = 0xEE;
+	frame.data[2] = 0x00;
+	requester.open();
+	ASSERT_TRUE(requester.write_frame(frame));
+	const std::uint32_t requestTimestamp_ms = SystemTiming::get_timestamp_ms();
+	while (((numberOfClaims + numberOfCannotClaims) < (NUMBER_OF_NODES + 1)) &&
+	       (!SystemTiming::time_expired_ms(requestTimestamp_ms, 1000)) &&
+	       (requester.read_frame(frame)))
+	{
+		if (0x18EEFF00 == (frame.identifier & 0x1FFFFF00))
+		{
+			if (NULL_CAN_ADDRESS == (frame.identifier & 0xFF))
+			{
+				numberOfCannotClaims++;
+			}
+			else
+			{
+				numberOfClaims++;
+			}
+		}
+	}
+	EXPECT_EQ(NUMBER_OF_NODES, numberOfClaims);
+	EXPECT_EQ(1u, numberOfCannotClaims);
+	requester.close();
+
+	CANHardwareInterface::stop();
+	simulation.stop();
+	EXPECT_FALSE(simulation.get_is_running());
+	EXPECT_EQ(CANNodeSimulation::AddressState::NotStarted, simulation.get_address_state(0));
+	EXPECT_LT(0u, simulation.get_number_transmitted_frames());
+	EXPECT_LT(simulation.get_number_transmitted_frames(), simulation.get_number_received_frames());
+	CANNetworkManager::CANNetwork.remove_global_parameter_group_number_callback(0xFEF3, record_simulated_source, nullptr);
+	CANHardwareInterface::set_number_of_can_channels(0);
+
+	// The stack learned every node's address from its claim, and got messages from all of them
+	EXPECT_EQ(NUMBER_OF_NODES, simulatedSources.size());
+}
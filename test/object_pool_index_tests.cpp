@@ -0,0 +1,97 @@
+#include <gtest/gtest.h>
+
+#include "isobus/utility/object_pool_image.hpp"
+#include "isobus/utility/object_pool_index.hpp"
+
+#include <vector>
+
+using namespace isobus;
+
+static std::vector<std::uint8_t> make_test_pool()
+{
+	return {
+		// Working set 0, with one child object (3000 at 0,0), no macros, no languages
+		0x00, 0x00, 0x00, 0x01, 0x01, 0xE8, 0x03, 0x01, 0x00, 0x00, 0xB8, 0x0B, 0x00, 0x00, 0x00, 0x00,
+		// Output string 11000 with a 3 byte value and one macro
+		0xF8, 0x2A, 0x0B, 0x32, 0x00, 0x10, 0x00, 0x00, 0xD8, 0x59, 0x00, 0xFF, 0xFF, 0x00, 0x03, 0x00, 'a', 'b', 'c', 0x01, 0x0A, 0x01,
+		// Number variable 21000
+		0x08, 0x52, 0x15, 0x04, 0x03, 0x02, 0x01
+	};
+}
+
+TEST(OBJECT_POOL_INDEX_TESTS, ParseValidPool)
+{
+	std::vector<std::uint8_t> pool = make_test_pool();
+	ObjectPoolIndex index;
+	ObjectPoolIndex::ObjectInfo info;
+
+	EXPECT_EQ(ObjectPoolIndex::ParseResult::Success, index.parse(pool.data(), pool.size()));
+	EXPECT_TRUE(index.get_is_valid());
+	EXPECT_EQ(3, index.get_number_objects());
+
+	ASSERT_TRUE(index.get_object_info(0, info));
+	EXPECT_EQ(ObjectPoolIndex::ObjectType::WorkingSet, info.type);
+	EXPECT_EQ(0, info.offset);
+	EXPECT_EQ(16, info.length);
+
+	ASSERT_TRUE(index.get_object_info(11000, info));
+	EXPECT_EQ(ObjectPoolIndex::ObjectType::OutputString, info.type);
+	EXPECT_EQ(16, info.offset);
+	EXPECT_EQ(22, info.length);
+
+	ASSERT_TRUE(index.get_object_info(21000, info));
+	EXPECT_EQ(ObjectPoolIndex::ObjectType::NumberVariable, info.type);
+	EXPECT_EQ(38, info.offset);
+	EXPECT_EQ(7, info.length);
+
+	EXPECT_FALSE(index.get_has_object(3000));
+}
+
+TEST(OBJECT_POOL_INDEX_TESTS, RejectInvalidPools)
+{
+	std::vector<std::uint8_t> pool = make_test_pool();
+	ObjectPoolIndex index;
+
+	EXPECT_EQ(ObjectPoolIndex::ParseResult::EmptyPool, index.parse(nullptr, 0));
+
+	EXPECT_EQ(ObjectPoolIndex::ParseResult::TruncatedObject, index.parse(pool.data(), pool.size() - 1));
+	EXPECT_EQ(38, index.get_error_offset());
+	EXPECT_EQ(0, index.get_number_objects());
+
+	// Cut the output string's value short
+	EXPECT_EQ(ObjectPoolIndex::ParseResult::TruncatedObject, index.parse(pool.data(), 33));
+	EXPECT_EQ(16, index.get_error_offset());
+
+	std::vector<std::uint8_t> duplicatePool = pool;
+	duplicatePool.insert(duplicatePool.end(), pool.end() - 7, pool.end());
+	EXPECT_EQ(ObjectPoolIndex::ParseResult::DuplicateObjectID, index.parse(duplicatePool.data(), duplicatePool.size()));
+	EXPECT_EQ(45, index.get_error_offset());
+
+	std::vector<std::uint8_t> unknownTypePool = pool;
+	unknownTypePool[40] = 0xF0;
+	EXPECT_EQ(ObjectPoolIndex::ParseResult::UnknownObjectType, index.parse(unknownTypePool.data(), unknownTypePool.size()));
+
+	std::vector<std::uint8_t> nullIDPool = pool;
+	nullIDPool[38] = 0xFF;
+	nullIDPool[39] = 0xFF;
+	EXPECT_EQ(ObjectPoolIndex::ParseResult::InvalidObjectID, index.parse(nullIDPool.data(), nullIDPool.size()));
+	EXPECT_FALSE(index.get_is_valid());
+}
+
+TEST(OBJECT_POOL_INDEX_TESTS, SharedPoolImage)
+{
+	std::vector<std::uint8_t> pool = make_test_pool();
+	const std::uint32_t poolSize = static_cast<std::uint32_t>(pool.size());
+	std::shared_ptr<const ObjectPoolImage> image = ObjectPoolImage::create_from_data(std::move(pool));
+	ObjectPoolIndex::ObjectInfo info;
+
+	ASSERT_NE(nullptr, image);
+	EXPECT_TRUE(image->get_is_valid());
+	EXPECT_EQ(poolSize, image->get_size());
+	EXPECT_EQ(0xF8, image->get_data()[16]);
+	ASSERT_TRUE(image->get_index().get_object_info(21000, info));
+	EXPECT_EQ(38, info.offset);
+
+	EXPECT_EQ(nullptr, ObjectPoolImage::create_from_data(std::vector<std::uint8_t>()));
+	EXPECT_EQ(nullptr, ObjectPoolImage::create_from_iop_file("this_file_does_not_exist.iop"));
+}
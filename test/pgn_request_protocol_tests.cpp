@@ -0,0 +1,324 @@
+#include <gtest/gtest.h>
+
+#include "isobus/isobus/can_general_parameter_group_numbers.hpp"
+#include "isobus/isobus/can_network_configuration.hpp"
+#include "isobus/isobus/can_parameter_group_number_request_protocol.hpp"
+#include "isobus/utility/system_timing.hpp"
+#include "test_CAN_glue.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace isobus;
+
+static std::mutex periodicTransmitMutex;
+static std::vector<std::uint32_t> periodicTransmitTimestamps;
+static std::vector<ControlFunction *> periodicTransmitDestinations;
+
+static bool record_periodic_transmit(std::uint32_t, ControlFunction *destination, void *)
+{
+	const std::lock_guard<std::mutex> lock(periodicTransmitMutex);
+	periodicTransmitTimestamps.push_back(SystemTiming::get_timestamp_ms());
+	periodicTransmitDestinations.push_back(destination);
+	return true;
+}
+
+static std::size_t get_number_periodic_transmits()
+{
+	const std::lock_guard<std::mutex> lock(periodicTransmitMutex);
+	return periodicTransmitTimestamps.size();
+}
+
+static bool stop_after_three_transmits(std::uint32_t parameterGroupNumber, ControlFunction *destination, void *parent)
+{
+	record_periodic_transmit(parameterGroupNumber, destination, parent);
+
+	// The scheduler's lock isn't held during the callback, so it can change the schedule
+	if (3 == get_number_periodic_transmits())
+	{
+		static_cast<ParameterGroupNumberRequestProtocol *>(parent)->remove_periodic_transmission(parameterGroupNumber);
+	}
+	return true;
+}
+
+static std::atomic<std::size_t> pgnRequestCallbackCount(0);
+
+static bool count_pgn_request(std::uint32_t, ControlFunction *, bool &acknowledge, AcknowledgementType &, void *)
+{
+	pgnRequestCallbackCount++;
+	acknowledge = false;
+	return true;
+}
+
+static void clear_periodic_transmits()
+{
+	const std::lock_guard<std::mutex> lock(periodicTransmitMutex);
+	periodicTransmitTimestamps.clear();
+	periodicTransmitDestinations.clear();
+}
+
+// Updates the stack from this thread, so that the scheduler's timing isn't up to another thread
+static void update_CAN_network_for(std::uint32_t duration_ms)
+{
+	const std::uint32_t startTimestamp_ms = SystemTiming::get_timestamp_ms();
+
+	while (!SystemTiming::time_expired_ms(startTimestamp_ms, duration_ms))
+	{
+		update_CAN_network();
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+}
+
+// Reads every frame that turns up on the bus within the duration
+static std::vector<HardwareInterfaceCANFrame> read_test_can_frames(VirtualCANPlugin &node, std::uint32_t duration_ms)
+{
+	const std::uint32_t startTimestamp_ms = SystemTiming::get_timestamp_ms();
+	std::vector<HardwareInterfaceCANFrame> retVal;
+	HardwareInterfaceCANFrame frame;
+
+	while (!SystemTiming::time_expired_ms(startTimestamp_ms, duration_ms))
+	{
+		if (node.read_frame(frame))
+		{
+			retVal.push_back(frame);
+		}
+	}
+	return retVal;
+}
+
+// Counts the frames with the identifier, ignoring their priority
+static std::size_t count_test_can_frames(const std::vector<HardwareInterfaceCANFrame> &frames, std::uint32_t identifier)
+{
+	return static_cast<std::size_t>(std::count_if(frames.begin(), frames.end(), [identifier](const HardwareInterfaceCANFrame &frame) {
+		return ((0x03FFFFFF & identifier) == (0x03FFFFFF & frame.identifier));
+	}));
+}
+
+TEST(PGN_REQUEST_PROTOCOL_TESTS, PeriodicTransmissionTiming)
+{
+	constexpr std::uint32_t TEST_PGN = 0xFF30;
+	constexpr std::uint32_t INTERVAL_MS = 50;
+	std::shared_ptr<InternalControlFunction> testControlFunction = make_test_internal_control_function(0x76);
+
+	ASSERT_TRUE(ParameterGroupNumberRequestProtocol::assign_pgn_request_protocol_to_internal_control_function(testControlFunction));
+	ParameterGroupNumberRequestProtocol *protocol = ParameterGroupNumberRequestProtocol::get_pgn_request_protocol_by_internal_control_function(testControlFunction);
+	ASSERT_NE(nullptr, protocol);
+	clear_periodic_transmits();
+
+	const std::uint32_t startTimestamp_ms = SystemTiming::get_timestamp_ms();
+	ASSERT_TRUE(protocol->register_periodic_transmission(TEST_PGN, INTERVAL_MS, record_periodic_transmit, nullptr));
+	EXPECT_FALSE(protocol->register_periodic_transmission(TEST_PGN, INTERVAL_MS, record_periodic_transmit, nullptr));
+	EXPECT_EQ(1u, protocol->get_number_scheduled_transmissions());
+	update_CAN_network_for(5 * INTERVAL_MS + (INTERVAL_MS / 2));
+
+	// The first transmit is right away, and the rest keep to the interval without drifting
+	ASSERT_EQ(6u, get_number_periodic_transmits());
+	for (std::size_t i = 0; i < periodicTransmitTimestamps.size(); i++)
+	{
+		EXPECT_LE(startTimestamp_ms + (i * INTERVAL_MS), periodicTransmitTimestamps[i]);
+		EXPECT_GT(startTimestamp_ms + (i * INTERVAL_MS) + 15, periodicTransmitTimestamps[i]);
+		EXPECT_EQ(nullptr, periodicTransmitDestinations[i]);
+	}
+
+	// Once it's removed, it isn't sent any more
+	EXPECT_TRUE(protocol->remove_periodic_transmission(TEST_PGN));
+	EXPECT_FALSE(protocol->remove_periodic_transmission(TEST_PGN));
+	EXPECT_EQ(0u, protocol->get_number_scheduled_transmissions());
+	clear_periodic_transmits();
+	update_CAN_network_for(2 * INTERVAL_MS);
+	EXPECT_EQ(0u, get_number_periodic_transmits());
+
+	EXPECT_TRUE(ParameterGroupNumberRequestProtocol::deassign_pgn_request_protocol_to_internal_control_function(testControlFunction));
+}
+
+TEST(PGN_REQUEST_PROTOCOL_TESTS, CallbackCanStopItsTransmission)
+{
+	constexpr std::uint32_t TEST_PGN = 0xFF32;
+	std::shared_ptr<InternalControlFunction> testControlFunction = make_test_internal_control_function(0x79);
+
+	ASSERT_TRUE(ParameterGroupNumberRequestProtocol::assign_pgn_request_protocol_to_internal_control_function(testControlFunction));
+	ParameterGroupNumberRequestProtocol *protocol = ParameterGroupNumberRequestProtocol::get_pgn_request_protocol_by_internal_control_function(testControlFunction);
+	ASSERT_NE(nullptr, protocol);
+	clear_periodic_transmits();
+
+	ASSERT_TRUE(protocol->register_periodic_transmission(TEST_PGN, 20, stop_after_three_transmits, protocol));
+	update_CAN_network_for(150);
+	EXPECT_EQ(3u, get_number_periodic_transmits());
+	EXPECT_EQ(0u, protocol->get_number_scheduled_transmissions());
+
+	EXPECT_TRUE(ParameterGroupNumberRequestProtocol::deassign_pgn_request_protocol_to_internal_control_function(testControlFunction));
+}
+
+TEST(PGN_REQUEST_PROTOCOL_TESTS, RepetitionRateRequest)
+{
+	constexpr std::uint32_t TEST_PGN = 0xFF31;
+	constexpr std::uint8_t ADDRESS = 0x77;
+	constexpr std::uint8_t PARTNER_ADDRESS = 0x78;
+	constexpr std::uint32_t REQUEST_IDENTIFIER = (0x18CC0000 | (ADDRESS << 8) | PARTNER_ADDRESS);
+	VirtualCANPlugin stackNode("pgn_repetition_rate_test");
+	VirtualCANPlugin peerNode("pgn_repetition_rate_test");
+	PartneredControlFunction *partner = nullptr;
+
+	std::shared_ptr<InternalControlFunction> testControlFunction = start_virtual_test_bus(stackNode, peerNode, ADDRESS, partner, PARTNER_ADDRESS);
+	ASSERT_TRUE(testControlFunction->get_address_valid());
+	ASSERT_TRUE(partner->get_address_valid());
+	ASSERT_TRUE(ParameterGroupNumberRequestProtocol::assign_pgn_request_protocol_to_internal_control_function(testControlFunction));
+	ParameterGroupNumberRequestProtocol *protocol = ParameterGroupNumberRequestProtocol::get_pgn_request_protocol_by_internal_control_function(testControlFunction);
+	ASSERT_NE(nullptr, protocol);
+	ASSERT_TRUE(wait_for_test_condition([protocol]() { return protocol->get_is_initialized(); }));
+	clear_periodic_transmits();
+
+	// With no default interval, it's only sent when someone asks for it
+	ASSERT_TRUE(protocol->register_periodic_transmission(TEST_PGN, 0, record_periodic_transmit, nullptr));
+	EXPECT_EQ(0u, protocol->get_number_scheduled_transmissions());
+
+	// Ask for it every 100ms
+	ASSERT_TRUE(peerNode.write_frame(make_test_can_frame(REQUEST_IDENTIFIER, { 0x31, 0xFF, 0x00, 100, 0x00, 0xFF, 0xFF, 0xFF })));
+	EXPECT_TRUE(wait_for_test_condition([]() { return (3 <= get_number_periodic_transmits()); }));
+	EXPECT_EQ(1u, protocol->get_number_scheduled_transmissions());
+	{
+		const std::lock_guard<std::mutex> lock(periodicTransmitMutex);
+		ASSERT_LE(3u, periodicTransmitTimestamps.size());
+		for (std::size_t i = 0; i < periodicTransmitTimestamps.size(); i++)
+		{
+			EXPECT_EQ(partner, periodicTransmitDestinations[i]);
+		}
+		for (std::size_t i = 1; i < periodicTransmitTimestamps.size(); i++)
+		{
+			EXPECT_LE(90u, periodicTransmitTimestamps[i] - periodicTransmitTimestamps[i - 1]);
+			EXPECT_GE(110u, periodicTransmitTimestamps[i] - periodicTransmitTimestamps[i - 1]);
+		}
+	}
+
+	// Asking for the default rate stops it again
+	ASSERT_TRUE(peerNode.write_frame(make_test_can_frame(REQUEST_IDENTIFIER, { 0x31, 0xFF, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0xFF })));
+	EXPECT_TRUE(wait_for_test_condition([protocol]() { return (0 == protocol->get_number_scheduled_transmissions()); }));
+	clear_periodic_transmits();
+	std::this_thread::sleep_for(std::chrono::milliseconds(250));
+	EXPECT_EQ(0u, get_number_periodic_transmits());
+
+	stop_virtual_test_bus();
+	EXPECT_TRUE(ParameterGroupNumberRequestProtocol::deassign_pgn_request_protocol_to_internal_control_function(testControlFunction));
+}
+
+TEST(PGN_REQUEST_PROTOCOL_TESTS, CachedResponses)
+{
+	constexpr std::uint32_t TEST_PGN = 0xFF33;
+	constexpr std::uint8_t ADDRESS = 0x7A;
+	constexpr std::uint8_t PARTNER_ADDRESS = 0x7B;
+	constexpr std::uint32_t SPECIFIC_REQUEST_IDENTIFIER = (0x18EA0000 | (ADDRESS << 8) | PARTNER_ADDRESS);
+	constexpr std::uint32_t GLOBAL_REQUEST_IDENTIFIER = (0x18EAFF00 | PARTNER_ADDRESS);
+	const std::uint32_t proprietaryAPGN = static_cast<std::uint32_t>(CANLibParameterGroupNumber::ProprietaryA);
+	const std::uint8_t firstPayload[] = { 0x01, 0x02, 0x03 };
+	const std::uint8_t secondPayload[] = { 0x04, 0x05, 0x06 };
+	VirtualCANPlugin stackNode("pgn_response_cache_test");
+	VirtualCANPlugin peerNode("pgn_response_cache_test");
+	PartneredControlFunction *partner = nullptr;
+	HardwareInterfaceCANFrame frame;
+	std::uint32_t version = 0;
+
+	ASSERT_EQ(0u, CANNetworkConfiguration::get_request_coalescing_window());
+	std::shared_ptr<InternalControlFunction> testControlFunction = start_virtual_test_bus(stackNode, peerNode, ADDRESS, partner, PARTNER_ADDRESS);
+	ASSERT_TRUE(testControlFunction->get_address_valid());
+	ASSERT_TRUE(partner->get_address_valid());
+	ASSERT_TRUE(ParameterGroupNumberRequestProtocol::assign_pgn_request_protocol_to_internal_control_function(testControlFunction));
+	ParameterGroupNumberRequestProtocol *protocol = ParameterGroupNumberRequestProtocol::get_pgn_request_protocol_by_internal_control_function(testControlFunction);
+	ASSERT_NE(nullptr, protocol);
+	ASSERT_TRUE(wait_for_test_condition([protocol]() { return protocol->get_is_initialized(); }));
+	ASSERT_TRUE(protocol->register_pgn_request_callback(TEST_PGN, count_pgn_request, nullptr));
+	pgnRequestCallbackCount = 0;
+
+	// Publishing the same version twice only updates the cache once
+	EXPECT_FALSE(protocol->get_cached_response_version(TEST_PGN, version));
+	EXPECT_TRUE(protocol->publish_cached_response(TEST_PGN, firstPayload, sizeof(firstPayload), 1));
+	EXPECT_FALSE(protocol->publish_cached_response(TEST_PGN, secondPayload, sizeof(secondPayload), 1));
+	EXPECT_TRUE(protocol->get_cached_response_version(TEST_PGN, version));
+	EXPECT_EQ(1u, version);
+
+	// A cache hit is answered without the callback. Single frame PDU2 responses are always global.
+	ASSERT_TRUE(peerNode.write_frame(make_test_can_frame(SPECIFIC_REQUEST_IDENTIFIER, { 0x33, 0xFF, 0x00 })));
+	ASSERT_TRUE(read_test_can_frame(peerNode, (0x18FF3300 | ADDRESS), frame));
+	EXPECT_EQ(0x01, frame.data[0]);
+	EXPECT_EQ(0x02, frame.data[1]);
+	EXPECT_EQ(0x03, frame.data[2]);
+	EXPECT_EQ(0u, pgnRequestCallbackCount);
+
+	// A new version replaces the payload
+	EXPECT_TRUE(protocol->publish_cached_response(TEST_PGN, secondPayload, sizeof(secondPayload), 2));
+	ASSERT_TRUE(peerNode.write_frame(make_test_can_frame(GLOBAL_REQUEST_IDENTIFIER, { 0x33, 0xFF, 0x00 })));
+	ASSERT_TRUE(read_test_can_frame(peerNode, (0x18FF3300 | ADDRESS), frame));
+	EXPECT_EQ(0x04, frame.data[0]);
+	EXPECT_EQ(0x05, frame.data[1]);
+	EXPECT_EQ(0x06, frame.data[2]);
+	EXPECT_EQ(0u, pgnRequestCallbackCount);
+
+	// A PDU1 response goes to the requester, or to everyone if the request was global
+	EXPECT_TRUE(protocol->publish_cached_response(proprietaryAPGN, firstPayload, sizeof(firstPayload), 1));
+	ASSERT_TRUE(peerNode.write_frame(make_test_can_frame(SPECIFIC_REQUEST_IDENTIFIER, { 0x00, 0xEF, 0x00 })));
+	ASSERT_TRUE(read_test_can_frame(peerNode, (0x18EF0000 | (PARTNER_ADDRESS << 8) | ADDRESS), frame));
+	EXPECT_EQ(0x01, frame.data[0]);
+	ASSERT_TRUE(peerNode.write_frame(make_test_can_frame(GLOBAL_REQUEST_IDENTIFIER, { 0x00, 0xEF, 0x00 })));
+	ASSERT_TRUE(read_test_can_frame(peerNode, (0x18EFFF00 | ADDRESS), frame));
+	EXPECT_EQ(0x01, frame.data[0]);
+
+	// Once it's removed, requests go back to the callback
+	EXPECT_TRUE(protocol->remove_cached_response(TEST_PGN));
+	EXPECT_FALSE(protocol->remove_cached_response(TEST_PGN));
+	ASSERT_TRUE(peerNode.write_frame(make_test_can_frame(SPECIFIC_REQUEST_IDENTIFIER, { 0x33, 0xFF, 0x00 })));
+	EXPECT_TRUE(wait_for_test_condition([]() { return (1 == pgnRequestCallbackCount); }));
+
+	EXPECT_TRUE(protocol->remove_cached_response(proprietaryAPGN));
+	EXPECT_TRUE(protocol->remove_pgn_request_callback(TEST_PGN, count_pgn_request, nullptr));
+	stop_virtual_test_bus();
+	EXPECT_TRUE(ParameterGroupNumberRequestProtocol::deassign_pgn_request_protocol_to_internal_control_function(testControlFunction));
+}
+
+TEST(PGN_REQUEST_PROTOCOL_TESTS, IdenticalRequestsAreCoalesced)
+{
+	constexpr std::uint8_t ADDRESS = 0x7C;
+	constexpr std::uint8_t PARTNER_ADDRESS = 0x7D;
+	constexpr std::uint32_t SPECIFIC_REQUEST_IDENTIFIER = (0x18EA0000 | (ADDRESS << 8) | PARTNER_ADDRESS);
+	constexpr std::uint32_t GLOBAL_REQUEST_IDENTIFIER = (0x18EAFF00 | PARTNER_ADDRESS);
+	constexpr std::uint32_t SPECIFIC_RESPONSE_IDENTIFIER = (0x18EF0000 | (PARTNER_ADDRESS << 8) | ADDRESS);
+	constexpr std::uint32_t GLOBAL_RESPONSE_IDENTIFIER = (0x18EFFF00 | ADDRESS);
+	const std::uint32_t proprietaryAPGN = static_cast<std::uint32_t>(CANLibParameterGroupNumber::ProprietaryA);
+	const std::uint8_t payload[] = { 0x01, 0x02, 0x03 };
+	VirtualCANPlugin stackNode("pgn_request_coalescing_test");
+	VirtualCANPlugin peerNode("pgn_request_coalescing_test");
+	PartneredControlFunction *partner = nullptr;
+
+	std::shared_ptr<InternalControlFunction> testControlFunction = start_virtual_test_bus(stackNode, peerNode, ADDRESS, partner, PARTNER_ADDRESS);
+	ASSERT_TRUE(testControlFunction->get_address_valid());
+	ASSERT_TRUE(partner->get_address_valid());
+	ASSERT_TRUE(ParameterGroupNumberRequestProtocol::assign_pgn_request_protocol_to_internal_control_function(testControlFunction));
+	ParameterGroupNumberRequestProtocol *protocol = ParameterGroupNumberRequestProtocol::get_pgn_request_protocol_by_internal_control_function(testControlFunction);
+	ASSERT_NE(nullptr, protocol);
+	ASSERT_TRUE(wait_for_test_condition([protocol]() { return protocol->get_is_initialized(); }));
+	ASSERT_TRUE(protocol->publish_cached_response(proprietaryAPGN, payload, sizeof(payload), 1));
+	CANNetworkConfiguration::set_request_coalescing_window(50);
+
+	// Identical requests within the window get one response
+	for (std::uint8_t i = 0; i < 3; i++)
+	{
+		ASSERT_TRUE(peerNode.write_frame(make_test_can_frame(SPECIFIC_REQUEST_IDENTIFIER, { 0x00, 0xEF, 0x00 })));
+	}
+	std::vector<HardwareInterfaceCANFrame> frames = read_test_can_frames(peerNode, 250);
+	EXPECT_EQ(1u, count_test_can_frames(frames, SPECIFIC_RESPONSE_IDENTIFIER));
+
+	// A global request within the window also answers the destination specific one, so only the global response is sent
+	ASSERT_TRUE(peerNode.write_frame(make_test_can_frame(SPECIFIC_REQUEST_IDENTIFIER, { 0x00, 0xEF, 0x00 })));
+	ASSERT_TRUE(peerNode.write_frame(make_test_can_frame(GLOBAL_REQUEST_IDENTIFIER, { 0x00, 0xEF, 0x00 })));
+	ASSERT_TRUE(peerNode.write_frame(make_test_can_frame(SPECIFIC_REQUEST_IDENTIFIER, { 0x00, 0xEF, 0x00 })));
+	frames = read_test_can_frames(peerNode, 250);
+	EXPECT_EQ(1u, count_test_can_frames(frames, GLOBAL_RESPONSE_IDENTIFIER));
+	EXPECT_EQ(0u, count_test_can_frames(frames, SPECIFIC_RESPONSE_IDENTIFIER));
+
+	CANNetworkConfiguration::set_request_coalescing_window(0);
+	EXPECT_TRUE(protocol->remove_cached_response(proprietaryAPGN));
+	stop_virtual_test_bus();
+	EXPECT_TRUE(ParameterGroupNumberRequestProtocol::deassign_pgn_request_protocol_to_internal_control_function(testControlFunction));
+}
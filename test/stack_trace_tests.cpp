@@ -0,0 +1,104 @@
+#include <gtest/gtest.h>
+
+#include "isobus/isobus/can_stack_trace.hpp"
+
+#include <cstring>
+#include <sstream>
+#include <thread>
+
+using namespace isobus;
+
+TEST(STACK_TRACE_TESTS, RecordsOnlyWhenEnabled)
+{
+	HardwareInterfaceCANFrame frame;
+	std::vector<CANStackTrace::Record> records;
+
+	frame.identifier = 0x18EF1C1D;
+	frame.channel = 1;
+	frame.dataLength = 6;
+	for (std::uint8_t i = 0; i < 8; i++)
+	{
+		frame.data[i] = i + 1;
+	}
+
+	CANStackTrace::clear();
+	CANStackTrace::set_enabled(false);
+	CANStackTrace::record_frame(CANStackTrace::EventType::FrameReceived, frame);
+	EXPECT_EQ(CANStackTrace::NO_TIMESTAMP, CANStackTrace::get_timestamp_us());
+	CANStackTrace::get_records(records);
+	EXPECT_TRUE(records.empty());
+
+	CANStackTrace::set_enabled(true);
+	CANStackTrace::record_frame(CANStackTrace::EventType::FrameReceived, frame);
+	CANStackTrace::record_event(CANStackTrace::EventType::AbortSent, CANStackTrace::Component::TransportProtocol, 0, 0xEF00, 1, 0, 3);
+	CANStackTrace::set_enabled(false);
+	CANStackTrace::get_records(records);
+
+	ASSERT_EQ(2u, records.size());
+	EXPECT_EQ(static_cast<std::uint8_t>(CANStackTrace::EventType::FrameReceived), records[0].eventType);
+	EXPECT_EQ(0x18EF1C1Du, records[0].identifier);
+	EXPECT_EQ(0x04030201u, records[0].argument0);
+	EXPECT_EQ(0x08070605u, records[0].argument1);
+	EXPECT_EQ(1, records[0].channel);
+	EXPECT_EQ(6, records[0].detail);
+	EXPECT_EQ(static_cast<std::uint8_t>(CANStackTrace::EventType::AbortSent), records[1].eventType);
+	EXPECT_EQ(static_cast<std::uint8_t>(CANStackTrace::Component::TransportProtocol), records[1].component);
+	EXPECT_EQ(3, records[1].detail);
+	EXPECT_LE(records[0].timestamp_us, records[1].timestamp_us);
+
+	CANStackTrace::clear();
+	CANStackTrace::get_records(records);
+	EXPECT_TRUE(records.empty());
+}
+
+TEST(STACK_TRACE_TESTS, KeepsMostRecentRecordsPerThread)
+{
+	constexpr std::uint32_t EXTRA_RECORDS = 10;
+	std::vector<CANStackTrace::Record> records;
+	std::stringstream traceStream;
+	CANStackTrace::FileHeader fileHeader;
+	CANStackTrace::BlockHeader blockHeader;
+	std::uint64_t numberOfLostRecords = 0;
+	std::uint32_t numberOfRecords = 0;
+
+	CANStackTrace::clear();
+	CANStackTrace::set_enabled(true);
+	CANStackTrace::record_event(CANStackTrace::EventType::CallbackDispatched, CANStackTrace::Component::NetworkManager, 0, 0xFEF1, 5, 8, 1);
+
+	std::thread writer([]() {
+		for (std::uint32_t i = 0; i < (CANStackTrace::RECORDS_PER_THREAD + EXTRA_RECORDS); i++)
+		{
+			CANStackTrace::record_event(CANStackTrace::EventType::SessionStateChanged, CANStackTrace::Component::ExtendedTransportProtocol, 0, 0xEB00, i, 0, 2);
+		}
+	});
+	writer.join();
+	CANStackTrace::set_enabled(false);
+
+	CANStackTrace::get_records(records);
+	ASSERT_EQ(CANStackTrace::RECORDS_PER_THREAD + 1, records.size());
+	for (auto &record : records)
+	{
+		if (0xEB00 == record.identifier)
+		{
+			// The oldest records from the writer thread were overwritten
+			EXPECT_LE(EXTRA_RECORDS, record.argument0);
+		}
+	}
+
+	ASSERT_TRUE(CANStackTrace::write(traceStream));
+	ASSERT_TRUE(traceStream.read(reinterpret_cast<char *>(&fileHeader), sizeof(fileHeader)));
+	EXPECT_EQ(0, std::memcmp(CANStackTrace::FILE_MAGIC, fileHeader.magic, sizeof(fileHeader.magic)));
+	EXPECT_EQ(CANStackTrace::FILE_VERSION, fileHeader.version);
+	EXPECT_EQ(sizeof(CANStackTrace::Record), fileHeader.recordSize);
+	EXPECT_EQ(CANStackTrace::BYTE_ORDER_MARK, fileHeader.byteOrderMark);
+
+	while (traceStream.read(reinterpret_cast<char *>(&blockHeader), sizeof(blockHeader)))
+	{
+		numberOfLostRecords += blockHeader.numberOfLostRecords;
+		numberOfRecords += blockHeader.numberOfRecords;
+		traceStream.seekg(blockHeader.numberOfRecords * sizeof(CANStackTrace::Record), std::ios::cur);
+	}
+	EXPECT_EQ(EXTRA_RECORDS, numberOfLostRecords);
+	EXPECT_EQ(CANStackTrace::RECORDS_PER_THREAD + 1, numberOfRecords);
+	CANStackTrace::clear();
+}
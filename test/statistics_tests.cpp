@@ -0,0 +1,140 @@
+#include <gtest/gtest.h>
+
+#include "isobus/hardware_integration/can_hardware_interface.hpp"
+#include "isobus/hardware_integration/virtual_can_plugin.hpp"
+#include "isobus/isobus/can_bus_load.hpp"
+#include "isobus/isobus/can_protocol_statistics.hpp"
+#include "isobus/utility/system_timing.hpp"
+
+#include <chrono>
+#include <limits>
+#include <thread>
+
+using namespace isobus;
+
+TEST(STATISTICS_TESTS, LatencyHistogramBuckets)
+{
+	LatencyHistogram histogram;
+
+	EXPECT_EQ(0, LatencyHistogram::get_bucket(0));
+	EXPECT_EQ(1, LatencyHistogram::get_bucket(1));
+	EXPECT_EQ(2, LatencyHistogram::get_bucket(2));
+	EXPECT_EQ(2, LatencyHistogram::get_bucket(3));
+	EXPECT_EQ(11, LatencyHistogram::get_bucket(1024));
+	EXPECT_EQ(LatencyHistogram::NUMBER_OF_BUCKETS - 1, LatencyHistogram::get_bucket(std::numeric_limits<std::uint32_t>::max()));
+
+	for (std::uint8_t i = 0; i < (LatencyHistogram::NUMBER_OF_BUCKETS - 1); i++)
+	{
+		EXPECT_EQ(i, LatencyHistogram::get_bucket(LatencyHistogram::get_bucket_upper_limit(i)));
+	}
+	EXPECT_EQ(std::numeric_limits<std::uint32_t>::max(), LatencyHistogram::get_bucket_upper_limit(LatencyHistogram::NUMBER_OF_BUCKETS - 1));
+
+	histogram.add_sample(3);
+	histogram.add_sample(2);
+	histogram.add_sample(700);
+	EXPECT_EQ(2u, histogram.get_number_samples(2));
+	EXPECT_EQ(1u, histogram.get_number_samples(10));
+	EXPECT_EQ(0u, histogram.get_number_samples(LatencyHistogram::NUMBER_OF_BUCKETS));
+	EXPECT_EQ(3u, histogram.get_total_number_samples());
+	EXPECT_EQ(700u, histogram.get_maximum());
+
+	histogram.reset();
+	EXPECT_EQ(0u, histogram.get_total_number_samples());
+	EXPECT_EQ(0u, histogram.get_maximum());
+}
+
+TEST(STATISTICS_TESTS, ProtocolSessionCounts)
+{
+	ProtocolStatistics statistics;
+
+	statistics.record_session_started(ProtocolStatistics::Direction::Transmit);
+	statistics.record_session_started(ProtocolStatistics::Direction::Transmit);
+	statistics.record_session_completed(ProtocolStatistics::Direction::Transmit, 100, 12);
+	statistics.record_session_closed(ProtocolStatistics::Direction::Transmit);
+	statistics.record_session_closed(ProtocolStatistics::Direction::Transmit);
+	statistics.record_abort_sent(3);
+	statistics.record_abort_received(250);
+	statistics.record_retransmit_request(4);
+
+	EXPECT_EQ(2u, statistics.get_number_sessions_started(ProtocolStatistics::Direction::Transmit));
+	EXPECT_EQ(1u, statistics.get_number_sessions_completed(ProtocolStatistics::Direction::Transmit));
+	EXPECT_EQ(1u, statistics.get_number_sessions_failed(ProtocolStatistics::Direction::Transmit));
+	EXPECT_EQ(0u, statistics.get_number_sessions_started(ProtocolStatistics::Direction::Receive));
+	EXPECT_EQ(100u, statistics.get_number_bytes(ProtocolStatistics::Direction::Transmit));
+	EXPECT_EQ(1u, statistics.get_number_aborts_sent(3));
+	EXPECT_EQ(0u, statistics.get_number_aborts_received(3));
+	EXPECT_EQ(1u, statistics.get_number_aborts_received(250));
+	EXPECT_EQ(4u, statistics.get_number_retransmitted_packets());
+	EXPECT_EQ(1u, statistics.get_completion_latency(ProtocolStatistics::Direction::Transmit).get_number_samples(LatencyHistogram::get_bucket(12)));
+
+	statistics.reset();
+	EXPECT_EQ(0u, statistics.get_number_sessions_started(ProtocolStatistics::Direction::Transmit));
+	EXPECT_EQ(0u, statistics.get_number_aborts_sent(3));
+	EXPECT_EQ(0u, statistics.get_completion_latency(ProtocolStatistics::Direction::Transmit).get_total_number_samples());
+}
+
+TEST(STATISTICS_TESTS, ChannelCounters)
+{
+	constexpr std::uint8_t NUMBER_OF_FRAMES = 40;
+	VirtualCANPlugin channelNode("channel_statistics_test");
+	VirtualCANPlugin otherNode("channel_statistics_test");
+	CANHardwareInterface::ChannelStatistics statistics;
+	HardwareInterfaceCANFrame frame;
+
+	frame.timestamp_us = 0;
+	frame.identifier = 0x18EF1C1D;
+	frame.channel = 0;
+	frame.dataLength = 8;
+	frame.isExtendedFrame = true;
+
+	CANHardwareInterface::set_number_of_can_channels(0);
+	CANHardwareInterface::set_number_of_can_channels(1);
+	ASSERT_TRUE(CANHardwareInterface::assign_can_channel_frame_handler(0, &channelNode));
+	EXPECT_FALSE(CANHardwareInterface::get_channel_statistics(1, statistics));
+	VirtualCANPlugin::set_bus_frame_loss("channel_statistics_test", 0.25f, 42);
+	otherNode.open();
+	CANHardwareInterface::start();
+
+	for (std::uint8_t i = 0; i < NUMBER_OF_FRAMES; i++)
+	{
+		EXPECT_TRUE(otherNode.write_frame(frame));
+	}
+	EXPECT_TRUE(CANHardwareInterface::transmit_can_message(frame));
+	EXPECT_TRUE(otherNode.read_frame(frame));
+
+	// Give the receive thread a moment to read everything that wasn't lost
+	const std::uint32_t startTimestamp_ms = SystemTiming::get_timestamp_ms();
+	do
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(5));
+		ASSERT_TRUE(CANHardwareInterface::get_channel_statistics(0, statistics));
+	} while ((NUMBER_OF_FRAMES != (statistics.receivedFrames + statistics.droppedFrames)) &&
+	         (!SystemTiming::time_expired_ms(startTimestamp_ms, 1000)));
+
+	EXPECT_EQ(NUMBER_OF_FRAMES, statistics.receivedFrames + statistics.droppedFrames);
+	EXPECT_NE(0u, statistics.droppedFrames);
+	EXPECT_EQ(8 * statistics.receivedFrames, statistics.receivedBytes);
+	EXPECT_EQ(1u, statistics.transmittedFrames);
+	EXPECT_EQ(8u, statistics.transmittedBytes);
+	EXPECT_EQ(0u, statistics.transmitFailures);
+	EXPECT_LE(1u, statistics.receiveQueueHighWaterMark);
+	EXPECT_EQ(1u, statistics.transmitQueueHighWaterMark);
+
+	// The bus load counts the same frames, and follows the estimate's sliding window
+	std::this_thread::sleep_for(std::chrono::milliseconds(CANBusLoad::SLOT_MS + (CANBusLoad::SLOT_MS / 2)));
+	ASSERT_TRUE(CANHardwareInterface::get_channel_statistics(0, statistics));
+	EXPECT_LT(0.0f, statistics.busLoadPercent);
+	EXPECT_TRUE(CANHardwareInterface::set_channel_bit_rate(0, 500000));
+	const float busLoadPercent = statistics.busLoadPercent;
+	ASSERT_TRUE(CANHardwareInterface::get_channel_statistics(0, statistics));
+	EXPECT_GT(busLoadPercent, statistics.busLoadPercent);
+
+	CANHardwareInterface::stop();
+	EXPECT_TRUE(CANHardwareInterface::reset_channel_statistics(0));
+	ASSERT_TRUE(CANHardwareInterface::get_channel_statistics(0, statistics));
+	EXPECT_EQ(0u, statistics.receivedFrames);
+	EXPECT_EQ(0u, statistics.droppedFrames);
+	EXPECT_EQ(0u, statistics.transmittedFrames);
+	EXPECT_EQ(0.0f, statistics.busLoadPercent);
+	CANHardwareInterface::set_number_of_can_channels(0);
+}
@@ -1,6 +1,11 @@
 #include "test_CAN_glue.hpp"
 
+#include "isobus/hardware_integration/can_hardware_interface.hpp"
 #include "isobus/isobus/can_network_manager.hpp"
+#include "isobus/utility/system_timing.hpp"
+
+#include <chrono>
+#include <thread>
 
 void update_CAN_network()
 {
@@ -10,4 +15,99 @@ void update_CAN_network()
 void raw_can_glue(isobus::HardwareInterfaceCANFrame &rawFrame, void *parentPointer)
 {
 	isobus::CANNetworkManager::CANNetwork.can_lib_process_rx_message(rawFrame, parentPointer);
-}
\ No newline at end of file
+}
+
+isobus::HardwareInterfaceCANFrame make_test_can_frame(std::uint32_t identifier, std::initializer_list<std::uint8_t> data)
+{
+	isobus::HardwareInterfaceCANFrame frame;
+	std::uint8_t i = 0;
+
+	frame.timestamp_us = 0;
+	frame.identifier = identifier;
+	frame.channel = 0;
+	frame.isExtendedFrame = true;
+	frame.dataLength = static_cast<std::uint8_t>(data.size());
+	for (std::uint8_t value : data)
+	{
+		frame.data[i] = value;
+		i++;
+	}
+	return frame;
+}
+
+bool wait_for_test_condition(std::function<bool()> condition)
+{
+	const std::uint32_t startTimestamp_ms = isobus::SystemTiming::get_timestamp_ms();
+	bool retVal = condition();
+
+	while ((!retVal) && (!isobus::SystemTiming::time_expired_ms(startTimestamp_ms, 2000)))
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(5));
+		retVal = condition();
+	}
+	return retVal;
+}
+
+bool read_test_can_frame(VirtualCANPlugin &node, std::uint32_t identifier, isobus::HardwareInterfaceCANFrame &frame)
+{
+	const std::uint32_t startTimestamp_ms = isobus::SystemTiming::get_timestamp_ms();
+	bool retVal = false;
+
+	while ((!retVal) && (!isobus::SystemTiming::time_expired_ms(startTimestamp_ms, 2000)))
+	{
+		retVal = ((node.read_frame(frame)) &&
+		          ((0x03FFFFFF & identifier) == (0x03FFFFFF & frame.identifier)));
+	}
+	return retVal;
+}
+
+std::shared_ptr<isobus::InternalControlFunction> make_test_internal_control_function(std::uint8_t address)
+{
+	isobus::NAME testNAME(0);
+
+	testNAME.set_arbitrary_address_capable(true);
+	testNAME.set_industry_group(1);
+	testNAME.set_function_code(130);
+	testNAME.set_identity_number(0x2F00 + address);
+	testNAME.set_manufacturer_code(69);
+	return std::shared_ptr<isobus::InternalControlFunction>(new isobus::InternalControlFunction(testNAME, address, 1), [](isobus::InternalControlFunction *) {});
+}
+
+std::shared_ptr<isobus::InternalControlFunction> start_virtual_test_bus(VirtualCANPlugin &stackNode,
+                                                                        VirtualCANPlugin &peerNode,
+                                                                        std::uint8_t address,
+                                                                        isobus::PartneredControlFunction *&partner,
+                                                                        std::uint8_t partnerAddress)
+{
+	isobus::HardwareInterfaceCANFrame frame = make_test_can_frame((0x18EEFF00 | partnerAddress), { 0, 0, 0, 0, 0, 0, 0, 0xA0 });
+
+	CANHardwareInterface::set_number_of_can_channels(0);
+	CANHardwareInterface::set_number_of_can_channels(2);
+	CANHardwareInterface::assign_can_channel_frame_handler(1, &stackNode);
+	CANHardwareInterface::add_can_lib_update_callback(update_CAN_network, nullptr);
+	CANHardwareInterface::add_raw_can_message_rx_callback(raw_can_glue, nullptr);
+	peerNode.open();
+	CANHardwareInterface::start();
+
+	std::shared_ptr<isobus::InternalControlFunction> retVal = make_test_internal_control_function(address);
+	isobus::PartneredControlFunction *newPartner = new isobus::PartneredControlFunction(1, { isobus::NAMEFilter(isobus::NAME::NAMEParameters::IdentityNumber, 0x2F00 + partnerAddress) });
+	partner = newPartner;
+	wait_for_test_condition([retVal]() { return retVal->get_address_valid(); });
+
+	frame.data[0] = static_cast<std::uint8_t>(0x2F00 + partnerAddress);
+	frame.data[1] = static_cast<std::uint8_t>((0x2F00 + partnerAddress) >> 8);
+	peerNode.write_frame(frame);
+	wait_for_test_condition([newPartner]() { return newPartner->get_address_valid(); });
+
+	// Messages from the partner are only matched to it once the network manager's next update adds it to the address table
+	std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	return retVal;
+}
+
+void stop_virtual_test_bus()
+{
+	CANHardwareInterface::remove_can_lib_update_callback(update_CAN_network, nullptr);
+	CANHardwareInterface::remove_raw_can_message_rx_callback(raw_can_glue, nullptr);
+	CANHardwareInterface::stop();
+	CANHardwareInterface::set_number_of_can_channels(0);
+}
@@ -1,6 +1,35 @@
 #pragma once
 
+#include "isobus/hardware_integration/virtual_can_plugin.hpp"
 #include "isobus/isobus/can_frame.hpp"
+#include "isobus/isobus/can_internal_control_function.hpp"
+#include "isobus/isobus/can_partnered_control_function.hpp"
+
+#include <functional>
+#include <initializer_list>
+#include <memory>
 
 void update_CAN_network();
-void raw_can_glue(isobus::HardwareInterfaceCANFrame &rawFrame, void *parentPointer);
\ No newline at end of file
+void raw_can_glue(isobus::HardwareInterfaceCANFrame &rawFrame, void *parentPointer);
+
+// Builds an extended frame on channel 0
+isobus::HardwareInterfaceCANFrame make_test_can_frame(std::uint32_t identifier, std::initializer_list<std::uint8_t> data);
+
+// Polls the condition for up to 2 seconds, and returns its last value
+bool wait_for_test_condition(std::function<bool()> condition);
+
+// Reads frames from the bus until one with the identifier turns up, ignoring its priority
+bool read_test_can_frame(VirtualCANPlugin &node, std::uint32_t identifier, isobus::HardwareInterfaceCANFrame &frame);
+
+// Makes an internal control function on port 1, which is never deleted, because the network manager keeps pointers to it
+std::shared_ptr<isobus::InternalControlFunction> make_test_internal_control_function(std::uint8_t address);
+
+// Runs the stack on channel 1 of a virtual bus, so the peer node can talk to it like another ECU would.
+// The internal control function claims `address`, and the peer claims `partnerAddress` for the partner.
+std::shared_ptr<isobus::InternalControlFunction> start_virtual_test_bus(VirtualCANPlugin &stackNode,
+                                                                        VirtualCANPlugin &peerNode,
+                                                                        std::uint8_t address,
+                                                                        isobus::PartneredControlFunction *&partner,
+                                                                        std::uint8_t partnerAddress);
+
+void stop_virtual_test_bus();
@@ -0,0 +1,524 @@
+#include <gtest/gtest.h>
+
+#include "isobus/isobus/can_extended_transport_protocol.hpp"
+#include "isobus/isobus/can_protocol.hpp"
+#include "isobus/isobus/can_transport_protocol.hpp"
+#include "isobus/isobus/nmea2000_fast_packet_protocol.hpp"
+#include "test_CAN_glue.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using namespace isobus;
+
+static std::vector<std::uint8_t> receivedPayload;
+static std::atomic<std::uint32_t> numberOfCompletedTransmits(0);
+static std::atomic<std::uint32_t> numberOfSuccessfulTransmits(0);
+static std::atomic<std::uint32_t> receivedPayloadLength(0);
+
+static void claim_test_address(std::uint8_t address, std::uint64_t NAMEValue)
+{
+	HardwareInterfaceCANFrame frame = make_test_can_frame((0x18EEFF00 | address), { 0, 0, 0, 0, 0, 0, 0, 0 });
+
+	for (std::uint8_t i = 0; i < 8; i++)
+	{
+		frame.data[i] = static_cast<std::uint8_t>(NAMEValue >> (8 * i));
+	}
+	// The network manager drops messages until its first update
+	update_CAN_network();
+	raw_can_glue(frame, nullptr);
+	update_CAN_network();
+}
+
+static void record_received_payload(CANMessage *message, void *)
+{
+	receivedPayload = message->get_data();
+}
+
+static void record_received_payload_length(CANMessage *message, void *)
+{
+	receivedPayloadLength = message->get_data_length();
+}
+
+static void record_transmit_complete(std::uint32_t, std::uint32_t, InternalControlFunction *, ControlFunction *, bool successful, void *)
+{
+	if (successful)
+	{
+		numberOfSuccessfulTransmits++;
+	}
+	numberOfCompletedTransmits++;
+}
+
+static bool fail_data_chunk(std::uint32_t, std::uint32_t, std::uint32_t, std::uint8_t *, void *)
+{
+	return false;
+}
+
+static bool get_transmit_completed()
+{
+	return (0 != numberOfCompletedTransmits);
+}
+
+static bool get_payload_received()
+{
+	return (0 != receivedPayloadLength);
+}
+
+TEST(TRANSPORT_PROTOCOL_TESTS, StaticProtocolsAreRegistered)
+{
+	std::uint32_t numberOfTransportProtocols = 0;
+	std::uint32_t numberOfExtendedTransportProtocols = 0;
+	std::uint32_t numberOfFastPacketProtocols = 0;
+
+	// The transport protocols are static objects, so they must register themselves whatever order they're constructed in
+	for (std::uint32_t i = 0; i < CANLibProtocol::get_number_protocols(); i++)
+	{
+		CANLibProtocol *protocol = nullptr;
+
+		ASSERT_TRUE(CANLibProtocol::get_protocol(i, protocol));
+		if (nullptr != dynamic_cast<TransportProtocolManager *>(protocol))
+		{
+			numberOfTransportProtocols++;
+		}
+		else if (nullptr != dynamic_cast<ExtendedTransportProtocolManager *>(protocol))
+		{
+			numberOfExtendedTransportProtocols++;
+		}
+		else if (&FastPacketProtocol::Protocol == protocol)
+		{
+			numberOfFastPacketProtocols++;
+		}
+	}
+	EXPECT_EQ(1u, numberOfTransportProtocols);
+	EXPECT_EQ(1u, numberOfExtendedTransportProtocols);
+	EXPECT_EQ(1u, numberOfFastPacketProtocols);
+}
+
+TEST(TRANSPORT_PROTOCOL_TESTS, BroadcastPayloadIsReassembled)
+{
+	constexpr std::uint32_t TEST_PGN = 0xFF7B;
+	constexpr std::uint8_t SOURCE_ADDRESS = 0x61;
+	HardwareInterfaceCANFrame frame;
+
+	claim_test_address(SOURCE_ADDRESS, 0xA000000000002F01);
+	CANNetworkManager::CANNetwork.add_global_parameter_group_number_callback(TEST_PGN, record_received_payload, nullptr);
+	receivedPayload.clear();
+
+	// A BAM of 20 bytes, in 3 packets
+	frame = make_test_can_frame(0x1CECFF00 | SOURCE_ADDRESS, { 0x20, 20, 0, 3, 0xFF, 0x7B, 0xFF, 0x00 });
+	raw_can_glue(frame, nullptr);
+	frame = make_test_can_frame(0x1CEBFF00 | SOURCE_ADDRESS, { 1, 0, 1, 2, 3, 4, 5, 6 });
+	raw_can_glue(frame, nullptr);
+	frame = make_test_can_frame(0x1CEBFF00 | SOURCE_ADDRESS, { 2, 7, 8, 9, 10, 11, 12, 13 });
+	raw_can_glue(frame, nullptr);
+	frame = make_test_can_frame(0x1CEBFF00 | SOURCE_ADDRESS, { 3, 14, 15, 16, 17, 18, 19, 0xFF });
+	raw_can_glue(frame, nullptr);
+	update_CAN_network();
+	CANNetworkManager::CANNetwork.remove_global_parameter_group_number_callback(TEST_PGN, record_received_payload, nullptr);
+
+	ASSERT_EQ(20u, receivedPayload.size());
+	for (std::uint8_t i = 0; i < 20; i++)
+	{
+		EXPECT_EQ(i, receivedPayload[i]);
+	}
+}
+
+TEST(TRANSPORT_PROTOCOL_TESTS, FastPacketLengthsAreReassembled)
+{
+	constexpr std::uint32_t TEST_PGN = 0x1F7F0;
+	constexpr std::uint8_t SOURCE_ADDRESS = 0x62;
+	constexpr std::uint32_t IDENTIFIER = (0x19F7F000 | SOURCE_ADDRESS);
+	HardwareInterfaceCANFrame frame;
+
+	claim_test_address(SOURCE_ADDRESS, 0xA000000000002F02);
+	FastPacketProtocol::Protocol.register_multipacket_message_callback(TEST_PGN, record_received_payload, nullptr);
+
+	// 13 bytes is the 6 in the first frame and 7 in one more, so it takes 2 frames
+	receivedPayload.clear();
+	frame = make_test_can_frame(IDENTIFIER, { 0x20, 13, 0, 1, 2, 3, 4, 5 });
+	raw_can_glue(frame, nullptr);
+	frame = make_test_can_frame(IDENTIFIER, { 0x21, 6, 7, 8, 9, 10, 11, 12 });
+	raw_can_glue(frame, nullptr);
+	update_CAN_network();
+
+	ASSERT_EQ(13u, receivedPayload.size());
+	for (std::uint8_t i = 0; i < 13; i++)
+	{
+		EXPECT_EQ(i, receivedPayload[i]);
+	}
+
+	// 20 bytes takes 3 frames, with the last one padded
+	receivedPayload.clear();
+	frame = make_test_can_frame(IDENTIFIER, { 0x40, 20, 0, 1, 2, 3, 4, 5 });
+	raw_can_glue(frame, nullptr);
+	frame = make_test_can_frame(IDENTIFIER, { 0x41, 6, 7, 8, 9, 10, 11, 12 });
+	raw_can_glue(frame, nullptr);
+	frame = make_test_can_frame(IDENTIFIER, { 0x42, 13, 14, 15, 16, 17, 18, 19 });
+	raw_can_glue(frame, nullptr);
+	update_CAN_network();
+	FastPacketProtocol::Protocol.remove_multipacket_message_callback(TEST_PGN, record_received_payload, nullptr);
+
+	ASSERT_EQ(20u, receivedPayload.size());
+	for (std::uint8_t i = 0; i < 20; i++)
+	{
+		EXPECT_EQ(i, receivedPayload[i]);
+	}
+}
+
+TEST(TRANSPORT_PROTOCOL_TESTS, ClearToSendCanAskForEarlierPackets)
+{
+	constexpr std::uint8_t SOURCE_ADDRESS = 0x71;
+	constexpr std::uint8_t PARTNER_ADDRESS = 0x72;
+	constexpr std::uint32_t CONNECTION_MANAGEMENT_IDENTIFIER = (0x1CEC0000 | (PARTNER_ADDRESS << 8) | SOURCE_ADDRESS);
+	constexpr std::uint32_t DATA_TRANSFER_IDENTIFIER = (0x1CEB0000 | (PARTNER_ADDRESS << 8) | SOURCE_ADDRESS);
+	constexpr std::uint32_t PEER_IDENTIFIER = (0x1CEC0000 | (SOURCE_ADDRESS << 8) | PARTNER_ADDRESS);
+	VirtualCANPlugin stackNode("tp_clear_to_send_test");
+	VirtualCANPlugin peerNode("tp_clear_to_send_test");
+	PartneredControlFunction *partner = nullptr;
+	HardwareInterfaceCANFrame frame;
+	std::uint8_t payload[20];
+
+	std::shared_ptr<InternalControlFunction> testControlFunction = start_virtual_test_bus(stackNode, peerNode, SOURCE_ADDRESS, partner, PARTNER_ADDRESS);
+	ASSERT_TRUE(testControlFunction->get_address_valid());
+	ASSERT_TRUE(partner->get_address_valid());
+	for (std::uint8_t i = 0; i < sizeof(payload); i++)
+	{
+		payload[i] = i;
+	}
+	numberOfCompletedTransmits = 0;
+	numberOfSuccessfulTransmits = 0;
+	const std::uint32_t numberOfRetransmittedPackets = TransportProtocolManager::get_statistics().get_number_retransmitted_packets();
+
+	ASSERT_TRUE(CANNetworkManager::CANNetwork.send_can_message(0xEF00, payload, sizeof(payload), testControlFunction.get(), partner, CANIdentifier::CANPriority::PriorityDefault6, record_transmit_complete));
+	ASSERT_TRUE(read_test_can_frame(peerNode, CONNECTION_MANAGEMENT_IDENTIFIER, frame));
+	EXPECT_EQ(0x10, frame.data[0]);
+	EXPECT_EQ(20, frame.data[1]);
+	EXPECT_EQ(3, frame.data[3]);
+
+	ASSERT_TRUE(peerNode.write_frame(make_test_can_frame(PEER_IDENTIFIER, { 0x11, 2, 1, 0xFF, 0xFF, 0x00, 0xEF, 0x00 })));
+	for (std::uint8_t i = 1; i <= 2; i++)
+	{
+		ASSERT_TRUE(read_test_can_frame(peerNode, DATA_TRANSFER_IDENTIFIER, frame));
+		EXPECT_EQ(i, frame.data[0]);
+	}
+
+	// Asking for the first packet again gets both packets again
+	ASSERT_TRUE(peerNode.write_frame(make_test_can_frame(PEER_IDENTIFIER, { 0x11, 2, 1, 0xFF, 0xFF, 0x00, 0xEF, 0x00 })));
+	for (std::uint8_t i = 1; i <= 2; i++)
+	{
+		ASSERT_TRUE(read_test_can_frame(peerNode, DATA_TRANSFER_IDENTIFIER, frame));
+		EXPECT_EQ(i, frame.data[0]);
+		EXPECT_EQ((i - 1) * 7, frame.data[1]);
+	}
+	EXPECT_EQ(numberOfRetransmittedPackets + 2, TransportProtocolManager::get_statistics().get_number_retransmitted_packets());
+
+	ASSERT_TRUE(peerNode.write_frame(make_test_can_frame(PEER_IDENTIFIER, { 0x11, 1, 3, 0xFF, 0xFF, 0x00, 0xEF, 0x00 })));
+	ASSERT_TRUE(read_test_can_frame(peerNode, DATA_TRANSFER_IDENTIFIER, frame));
+	EXPECT_EQ(3, frame.data[0]);
+	for (std::uint8_t i = 1; i < 7; i++)
+	{
+		EXPECT_EQ(13 + i, frame.data[i]);
+	}
+	EXPECT_EQ(0xFF, frame.data[7]);
+
+	ASSERT_TRUE(peerNode.write_frame(make_test_can_frame(PEER_IDENTIFIER, { 0x13, 20, 0, 3, 0xFF, 0x00, 0xEF, 0x00 })));
+	EXPECT_TRUE(wait_for_test_condition(get_transmit_completed));
+	EXPECT_EQ(1u, numberOfCompletedTransmits);
+	EXPECT_EQ(1u, numberOfSuccessfulTransmits);
+	stop_virtual_test_bus();
+}
+
+TEST(TRANSPORT_PROTOCOL_TESTS, ExtendedReceiveSessionsClose)
+{
+	constexpr std::uint8_t DESTINATION_ADDRESS = 0x73;
+	constexpr std::uint8_t PARTNER_ADDRESS = 0x74;
+	constexpr std::uint32_t PAYLOAD_LENGTH = 1800;
+	constexpr std::uint32_t CONNECTION_MANAGEMENT_IDENTIFIER = (0x1CC80000 | (PARTNER_ADDRESS << 8) | DESTINATION_ADDRESS);
+	constexpr std::uint32_t PEER_CONNECTION_MANAGEMENT_IDENTIFIER = (0x1CC80000 | (DESTINATION_ADDRESS << 8) | PARTNER_ADDRESS);
+	constexpr std::uint32_t PEER_DATA_TRANSFER_IDENTIFIER = (0x1CC70000 | (DESTINATION_ADDRESS << 8) | PARTNER_ADDRESS);
+	const HardwareInterfaceCANFrame requestToSend = make_test_can_frame(PEER_CONNECTION_MANAGEMENT_IDENTIFIER, { 0x14, 0x08, 0x07, 0x00, 0x00, 0x00, 0xEF, 0x00 });
+	VirtualCANPlugin stackNode("etp_receive_test");
+	VirtualCANPlugin peerNode("etp_receive_test");
+	PartneredControlFunction *partner = nullptr;
+	HardwareInterfaceCANFrame frame;
+
+	ASSERT_TRUE(start_virtual_test_bus(stackNode, peerNode, DESTINATION_ADDRESS, partner, PARTNER_ADDRESS)->get_address_valid());
+	ASSERT_TRUE(partner->get_address_valid());
+	partner->add_parameter_group_number_callback(0xEF00, record_received_payload_length, nullptr);
+	receivedPayloadLength = 0;
+	const std::uint32_t numberOfCompletedSessions = ExtendedTransportProtocolManager::get_statistics().get_number_sessions_completed(ProtocolStatistics::Direction::Receive);
+	const std::uint32_t numberOfFailedSessions = ExtendedTransportProtocolManager::get_statistics().get_number_sessions_failed(ProtocolStatistics::Direction::Receive);
+
+	// A session that's closed part way through, because the sender gave a bad offset
+	ASSERT_TRUE(peerNode.write_frame(requestToSend));
+	ASSERT_TRUE(read_test_can_frame(peerNode, CONNECTION_MANAGEMENT_IDENTIFIER, frame));
+	EXPECT_EQ(0x15, frame.data[0]);
+	ASSERT_TRUE(peerNode.write_frame(make_test_can_frame(PEER_CONNECTION_MANAGEMENT_IDENTIFIER, { 0x16, 0xFF, 0x00, 0x00, 0x00, 0x00, 0xEF, 0x00 })));
+	ASSERT_TRUE(peerNode.write_frame(make_test_can_frame(PEER_DATA_TRANSFER_IDENTIFIER, { 1, 0, 0, 0, 0, 0, 0, 0 })));
+	ASSERT_TRUE(peerNode.write_frame(make_test_can_frame(PEER_CONNECTION_MANAGEMENT_IDENTIFIER, { 0x16, 0xFF, 0x05, 0x00, 0x00, 0x00, 0xEF, 0x00 })));
+	ASSERT_TRUE(read_test_can_frame(peerNode, CONNECTION_MANAGEMENT_IDENTIFIER, frame));
+	EXPECT_EQ(0xFF, frame.data[0]);
+
+	// Data for the closed session is ignored
+	ASSERT_TRUE(peerNode.write_frame(make_test_can_frame(PEER_DATA_TRANSFER_IDENTIFIER, { 2, 0, 0, 0, 0, 0, 0, 0 })));
+
+	// So the next request starts a new session, which runs to the end and closes itself when the last packet comes in
+	ASSERT_TRUE(peerNode.write_frame(requestToSend));
+	ASSERT_TRUE(read_test_can_frame(peerNode, CONNECTION_MANAGEMENT_IDENTIFIER, frame));
+	EXPECT_EQ(0x15, frame.data[0]);
+	EXPECT_EQ(0xFF, frame.data[1]);
+	EXPECT_EQ(1, frame.data[2]);
+	ASSERT_TRUE(peerNode.write_frame(make_test_can_frame(PEER_CONNECTION_MANAGEMENT_IDENTIFIER, { 0x16, 0xFF, 0x00, 0x00, 0x00, 0x00, 0xEF, 0x00 })));
+	for (std::uint32_t i = 1; i <= 0xFF; i++)
+	{
+		ASSERT_TRUE(peerNode.write_frame(make_test_can_frame(PEER_DATA_TRANSFER_IDENTIFIER, { static_cast<std::uint8_t>(i), 0, 0, 0, 0, 0, 0, 0 })));
+	}
+	ASSERT_TRUE(read_test_can_frame(peerNode, CONNECTION_MANAGEMENT_IDENTIFIER, frame));
+	EXPECT_EQ(0x15, frame.data[0]);
+	EXPECT_EQ(3, frame.data[1]);
+	EXPECT_EQ(0x00, frame.data[2]);
+	EXPECT_EQ(0x01, frame.data[3]);
+	ASSERT_TRUE(peerNode.write_frame(make_test_can_frame(PEER_CONNECTION_MANAGEMENT_IDENTIFIER, { 0x16, 3, 0xFF, 0x00, 0x00, 0x00, 0xEF, 0x00 })));
+	for (std::uint8_t i = 1; i <= 3; i++)
+	{
+		ASSERT_TRUE(peerNode.write_frame(make_test_can_frame(PEER_DATA_TRANSFER_IDENTIFIER, { i, 0, 0, 0, 0, 0, 0, 0 })));
+	}
+	ASSERT_TRUE(read_test_can_frame(peerNode, CONNECTION_MANAGEMENT_IDENTIFIER, frame));
+	EXPECT_EQ(0x17, frame.data[0]);
+	EXPECT_TRUE(wait_for_test_condition(get_payload_received));
+	EXPECT_EQ(PAYLOAD_LENGTH, receivedPayloadLength);
+
+	// A packet after the last one doesn't belong to any session
+	ASSERT_TRUE(peerNode.write_frame(make_test_can_frame(PEER_DATA_TRANSFER_IDENTIFIER, { 4, 0, 0, 0, 0, 0, 0, 0 })));
+	std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	EXPECT_EQ(numberOfCompletedSessions + 1, ExtendedTransportProtocolManager::get_statistics().get_number_sessions_completed(ProtocolStatistics::Direction::Receive));
+	EXPECT_EQ(numberOfFailedSessions + 1, ExtendedTransportProtocolManager::get_statistics().get_number_sessions_failed(ProtocolStatistics::Direction::Receive));
+	stop_virtual_test_bus();
+}
+
+TEST(TRANSPORT_PROTOCOL_TESTS, ExtendedPayloadIsReassembled)
+{
+	constexpr std::uint8_t DESTINATION_ADDRESS = 0x90;
+	constexpr std::uint8_t PARTNER_ADDRESS = 0x91;
+	constexpr std::uint32_t PAYLOAD_LENGTH = 1800;
+	constexpr std::uint32_t NUMBER_OF_PACKETS = ((PAYLOAD_LENGTH + 6) / 7);
+	constexpr std::uint32_t CONNECTION_MANAGEMENT_IDENTIFIER = (0x1CC80000 | (PARTNER_ADDRESS << 8) | DESTINATION_ADDRESS);
+	constexpr std::uint32_t PEER_CONNECTION_MANAGEMENT_IDENTIFIER = (0x1CC80000 | (DESTINATION_ADDRESS << 8) | PARTNER_ADDRESS);
+	constexpr std::uint32_t PEER_DATA_TRANSFER_IDENTIFIER = (0x1CC70000 | (DESTINATION_ADDRESS << 8) | PARTNER_ADDRESS);
+	VirtualCANPlugin stackNode("etp_reassembly_test");
+	VirtualCANPlugin peerNode("etp_reassembly_test");
+	PartneredControlFunction *partner = nullptr;
+	HardwareInterfaceCANFrame frame;
+	std::vector<std::uint8_t> payload(PAYLOAD_LENGTH);
+	std::uint32_t packetNumber = 0;
+
+	ASSERT_TRUE(start_virtual_test_bus(stackNode, peerNode, DESTINATION_ADDRESS, partner, PARTNER_ADDRESS)->get_address_valid());
+	ASSERT_TRUE(partner->get_address_valid());
+	for (std::uint32_t i = 0; i < PAYLOAD_LENGTH; i++)
+	{
+		payload[i] = static_cast<std::uint8_t>(i % 251);
+	}
+	// The payload is recorded before its length, which is what the test waits on
+	partner->add_parameter_group_number_callback(0xEF00, record_received_payload, nullptr);
+	partner->add_parameter_group_number_callback(0xEF00, record_received_payload_length, nullptr);
+	receivedPayload.clear();
+	receivedPayloadLength = 0;
+
+	ASSERT_TRUE(peerNode.write_frame(make_test_can_frame(PEER_CONNECTION_MANAGEMENT_IDENTIFIER, { 0x14, 0x08, 0x07, 0x00, 0x00, 0x00, 0xEF, 0x00 })));
+
+	// Sequence numbers start over after each data packet offset, so the second window lands after the first
+	while (packetNumber < NUMBER_OF_PACKETS)
+	{
+		ASSERT_TRUE(read_test_can_frame(peerNode, CONNECTION_MANAGEMENT_IDENTIFIER, frame));
+		ASSERT_EQ(0x15, frame.data[0]);
+		const std::uint8_t packetsInWindow = frame.data[1];
+		ASSERT_EQ(packetNumber + 1, static_cast<std::uint32_t>(frame.data[2] | (frame.data[3] << 8) | (frame.data[4] << 16)));
+		ASSERT_TRUE(peerNode.write_frame(make_test_can_frame(PEER_CONNECTION_MANAGEMENT_IDENTIFIER,
+		                                                     { 0x16, packetsInWindow, static_cast<std::uint8_t>(packetNumber), static_cast<std::uint8_t>(packetNumber >> 8), static_cast<std::uint8_t>(packetNumber >> 16), 0x00, 0xEF, 0x00 })));
+
+		for (std::uint32_t i = 1; i <= packetsInWindow; i++)
+		{
+			HardwareInterfaceCANFrame dataFrame = make_test_can_frame(PEER_DATA_TRANSFER_IDENTIFIER, { static_cast<std::uint8_t>(i), 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF });
+
+			for (std::uint32_t j = 0; (j < 7) && (((packetNumber * 7) + j) < PAYLOAD_LENGTH); j++)
+			{
+				dataFrame.data[1 + j] = payload[(packetNumber * 7) + j];
+			}
+			ASSERT_TRUE(peerNode.write_frame(dataFrame));
+			packetNumber++;
+		}
+	}
+	ASSERT_TRUE(read_test_can_frame(peerNode, CONNECTION_MANAGEMENT_IDENTIFIER, frame));
+	EXPECT_EQ(0x17, frame.data[0]);
+	ASSERT_TRUE(wait_for_test_condition(get_payload_received));
+	partner->remove_parameter_group_number_callback(0xEF00, record_received_payload, nullptr);
+	partner->remove_parameter_group_number_callback(0xEF00, record_received_payload_length, nullptr);
+	EXPECT_EQ(payload, receivedPayload);
+	stop_virtual_test_bus();
+}
+
+TEST(TRANSPORT_PROTOCOL_TESTS, FastPacketChunkFailureEndsSession)
+{
+	constexpr std::uint32_t TEST_PGN = 0x1F7F1;
+	std::shared_ptr<InternalControlFunction> testControlFunction = make_test_internal_control_function(0x75);
+
+	numberOfCompletedTransmits = 0;
+	numberOfSuccessfulTransmits = 0;
+	const std::uint32_t numberOfFailedSessions = FastPacketProtocol::get_statistics().get_number_sessions_failed(ProtocolStatistics::Direction::Transmit);
+
+	// The session ends as soon as it can't get data for its first frame, and reports that once
+	ASSERT_TRUE(FastPacketProtocol::Protocol.send_multipacket_message(TEST_PGN, nullptr, 20, testControlFunction.get(), nullptr, CANIdentifier::CANPriority::PriorityDefault6, record_transmit_complete, nullptr, fail_data_chunk));
+	update_CAN_network();
+	update_CAN_network();
+	EXPECT_EQ(1u, numberOfCompletedTransmits);
+	EXPECT_EQ(0u, numberOfSuccessfulTransmits);
+	EXPECT_EQ(numberOfFailedSessions + 1, FastPacketProtocol::get_statistics().get_number_sessions_failed(ProtocolStatistics::Direction::Transmit));
+}
+
+TEST(TRANSPORT_PROTOCOL_TESTS, SharedPayloadIsSentWithoutCopying)
+{
+	constexpr std::uint8_t SOURCE_ADDRESS = 0x63;
+	constexpr std::uint8_t PARTNER_ADDRESS = 0x64;
+	constexpr std::uint32_t CONNECTION_MANAGEMENT_IDENTIFIER = (0x1CEC0000 | (PARTNER_ADDRESS << 8) | SOURCE_ADDRESS);
+	constexpr std::uint32_t DATA_TRANSFER_IDENTIFIER = (0x1CEB0000 | (PARTNER_ADDRESS << 8) | SOURCE_ADDRESS);
+	constexpr std::uint32_t PEER_IDENTIFIER = (0x1CEC0000 | (SOURCE_ADDRESS << 8) | PARTNER_ADDRESS);
+	VirtualCANPlugin stackNode("tp_shared_payload_test");
+	VirtualCANPlugin peerNode("tp_shared_payload_test");
+	PartneredControlFunction *partner = nullptr;
+	HardwareInterfaceCANFrame frame;
+	std::vector<std::uint8_t> buffer(20);
+
+	std::shared_ptr<InternalControlFunction> testControlFunction = start_virtual_test_bus(stackNode, peerNode, SOURCE_ADDRESS, partner, PARTNER_ADDRESS);
+	ASSERT_TRUE(testControlFunction->get_address_valid());
+	ASSERT_TRUE(partner->get_address_valid());
+	for (std::uint8_t i = 0; i < buffer.size(); i++)
+	{
+		buffer[i] = i;
+	}
+	auto payload = std::make_shared<const std::vector<std::uint8_t>>(buffer);
+	numberOfCompletedTransmits = 0;
+	numberOfSuccessfulTransmits = 0;
+
+	// The session keeps a reference to the payload until it ends, rather than a copy of it
+	ASSERT_TRUE(CANNetworkManager::CANNetwork.send_can_message(0xEF00, payload, testControlFunction.get(), partner, record_transmit_complete));
+	EXPECT_EQ(2, payload.use_count());
+	ASSERT_TRUE(read_test_can_frame(peerNode, CONNECTION_MANAGEMENT_IDENTIFIER, frame));
+	EXPECT_EQ(0x10, frame.data[0]);
+	EXPECT_EQ(20, frame.data[1]);
+	EXPECT_EQ(3, frame.data[3]);
+
+	ASSERT_TRUE(peerNode.write_frame(make_test_can_frame(PEER_IDENTIFIER, { 0x11, 3, 1, 0xFF, 0xFF, 0x00, 0xEF, 0x00 })));
+	for (std::uint8_t i = 1; i <= 3; i++)
+	{
+		ASSERT_TRUE(read_test_can_frame(peerNode, DATA_TRANSFER_IDENTIFIER, frame));
+		EXPECT_EQ(i, frame.data[0]);
+		for (std::uint8_t j = 1; (j < 8) && (static_cast<std::size_t>(((i - 1) * 7) + j - 1) < buffer.size()); j++)
+		{
+			EXPECT_EQ(buffer[((i - 1) * 7) + j - 1], frame.data[j]);
+		}
+	}
+	ASSERT_TRUE(peerNode.write_frame(make_test_can_frame(PEER_IDENTIFIER, { 0x13, 20, 0, 3, 0xFF, 0x00, 0xEF, 0x00 })));
+	EXPECT_TRUE(wait_for_test_condition(get_transmit_completed));
+	EXPECT_EQ(1u, numberOfSuccessfulTransmits);
+	EXPECT_TRUE(wait_for_test_condition([&payload]() { return (1 == payload.use_count()); }));
+
+	// A payload that fits in one frame goes out as a single frame
+	numberOfCompletedTransmits = 0;
+	auto shortPayload = std::make_shared<const std::vector<std::uint8_t>>(std::vector<std::uint8_t>{ 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08 });
+	ASSERT_TRUE(CANNetworkManager::CANNetwork.send_can_message(0xEF00, shortPayload, testControlFunction.get(), partner, record_transmit_complete));
+	ASSERT_TRUE(read_test_can_frame(peerNode, (0x18EF0000 | (PARTNER_ADDRESS << 8) | SOURCE_ADDRESS), frame));
+	EXPECT_EQ(8u, frame.dataLength);
+	EXPECT_EQ(0x01, frame.data[0]);
+	EXPECT_EQ(0x08, frame.data[7]);
+	EXPECT_EQ(1u, numberOfCompletedTransmits);
+	stop_virtual_test_bus();
+}
+
+TEST(TRANSPORT_PROTOCOL_TESTS, CompletionCallbackFiresOnce)
+{
+	constexpr std::uint8_t SOURCE_ADDRESS = 0x67;
+	constexpr std::uint8_t PARTNER_ADDRESS = 0x68;
+	constexpr std::uint32_t TP_CONNECTION_MANAGEMENT_IDENTIFIER = (0x1CEC0000 | (PARTNER_ADDRESS << 8) | SOURCE_ADDRESS);
+	constexpr std::uint32_t TP_DATA_TRANSFER_IDENTIFIER = (0x1CEB0000 | (PARTNER_ADDRESS << 8) | SOURCE_ADDRESS);
+	constexpr std::uint32_t TP_PEER_IDENTIFIER = (0x1CEC0000 | (SOURCE_ADDRESS << 8) | PARTNER_ADDRESS);
+	constexpr std::uint32_t ETP_CONNECTION_MANAGEMENT_IDENTIFIER = (0x1CC80000 | (PARTNER_ADDRESS << 8) | SOURCE_ADDRESS);
+	constexpr std::uint32_t ETP_DATA_TRANSFER_IDENTIFIER = (0x1CC70000 | (PARTNER_ADDRESS << 8) | SOURCE_ADDRESS);
+	constexpr std::uint32_t ETP_PEER_IDENTIFIER = (0x1CC80000 | (SOURCE_ADDRESS << 8) | PARTNER_ADDRESS);
+	constexpr std::uint32_t ETP_PAYLOAD_LENGTH = 1800;
+	VirtualCANPlugin stackNode("tp_completion_callback_test");
+	VirtualCANPlugin peerNode("tp_completion_callback_test");
+	PartneredControlFunction *partner = nullptr;
+	HardwareInterfaceCANFrame frame;
+	std::vector<std::uint8_t> payload(ETP_PAYLOAD_LENGTH, 0xA5);
+
+	std::shared_ptr<InternalControlFunction> testControlFunction = start_virtual_test_bus(stackNode, peerNode, SOURCE_ADDRESS, partner, PARTNER_ADDRESS);
+	ASSERT_TRUE(testControlFunction->get_address_valid());
+	ASSERT_TRUE(partner->get_address_valid());
+
+	// TP, aborted by the receiver
+	numberOfCompletedTransmits = 0;
+	numberOfSuccessfulTransmits = 0;
+	ASSERT_TRUE(CANNetworkManager::CANNetwork.send_can_message(0xEF00, payload.data(), 20, testControlFunction.get(), partner, CANIdentifier::CANPriority::PriorityDefault6, record_transmit_complete));
+	ASSERT_TRUE(read_test_can_frame(peerNode, TP_CONNECTION_MANAGEMENT_IDENTIFIER, frame));
+	EXPECT_EQ(0x10, frame.data[0]);
+	ASSERT_TRUE(peerNode.write_frame(make_test_can_frame(TP_PEER_IDENTIFIER, { 0xFF, 0x01, 0xFF, 0xFF, 0xFF, 0x00, 0xEF, 0x00 })));
+	EXPECT_TRUE(wait_for_test_condition(get_transmit_completed));
+	std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	EXPECT_EQ(1u, numberOfCompletedTransmits);
+	EXPECT_EQ(0u, numberOfSuccessfulTransmits);
+
+	// TP, completed
+	numberOfCompletedTransmits = 0;
+	ASSERT_TRUE(CANNetworkManager::CANNetwork.send_can_message(0xEF00, payload.data(), 20, testControlFunction.get(), partner, CANIdentifier::CANPriority::PriorityDefault6, record_transmit_complete));
+	ASSERT_TRUE(read_test_can_frame(peerNode, TP_CONNECTION_MANAGEMENT_IDENTIFIER, frame));
+	ASSERT_TRUE(peerNode.write_frame(make_test_can_frame(TP_PEER_IDENTIFIER, { 0x11, 3, 1, 0xFF, 0xFF, 0x00, 0xEF, 0x00 })));
+	for (std::uint8_t i = 1; i <= 3; i++)
+	{
+		ASSERT_TRUE(read_test_can_frame(peerNode, TP_DATA_TRANSFER_IDENTIFIER, frame));
+	}
+	ASSERT_TRUE(peerNode.write_frame(make_test_can_frame(TP_PEER_IDENTIFIER, { 0x13, 20, 0, 3, 0xFF, 0x00, 0xEF, 0x00 })));
+	EXPECT_TRUE(wait_for_test_condition(get_transmit_completed));
+	std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	EXPECT_EQ(1u, numberOfCompletedTransmits);
+	EXPECT_EQ(1u, numberOfSuccessfulTransmits);
+
+	// ETP, aborted by the receiver
+	numberOfCompletedTransmits = 0;
+	numberOfSuccessfulTransmits = 0;
+	ASSERT_TRUE(CANNetworkManager::CANNetwork.send_can_message(0xEF00, payload.data(), ETP_PAYLOAD_LENGTH, testControlFunction.get(), partner, CANIdentifier::CANPriority::PriorityDefault6, record_transmit_complete));
+	ASSERT_TRUE(read_test_can_frame(peerNode, ETP_CONNECTION_MANAGEMENT_IDENTIFIER, frame));
+	EXPECT_EQ(0x14, frame.data[0]);
+	ASSERT_TRUE(peerNode.write_frame(make_test_can_frame(ETP_PEER_IDENTIFIER, { 0xFF, 0x01, 0xFF, 0xFF, 0xFF, 0x00, 0xEF, 0x00 })));
+	EXPECT_TRUE(wait_for_test_condition(get_transmit_completed));
+	std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	EXPECT_EQ(1u, numberOfCompletedTransmits);
+	EXPECT_EQ(0u, numberOfSuccessfulTransmits);
+
+	// ETP, completed over two rounds of CTS
+	numberOfCompletedTransmits = 0;
+	ASSERT_TRUE(CANNetworkManager::CANNetwork.send_can_message(0xEF00, payload.data(), ETP_PAYLOAD_LENGTH, testControlFunction.get(), partner, CANIdentifier::CANPriority::PriorityDefault6, record_transmit_complete));
+	ASSERT_TRUE(read_test_can_frame(peerNode, ETP_CONNECTION_MANAGEMENT_IDENTIFIER, frame));
+	ASSERT_TRUE(peerNode.write_frame(make_test_can_frame(ETP_PEER_IDENTIFIER, { 0x15, 255, 1, 0, 0, 0x00, 0xEF, 0x00 })));
+	ASSERT_TRUE(read_test_can_frame(peerNode, ETP_CONNECTION_MANAGEMENT_IDENTIFIER, frame));
+	EXPECT_EQ(0x16, frame.data[0]);
+	for (std::uint32_t i = 1; i <= 255; i++)
+	{
+		ASSERT_TRUE(read_test_can_frame(peerNode, ETP_DATA_TRANSFER_IDENTIFIER, frame));
+	}
+	ASSERT_TRUE(peerNode.write_frame(make_test_can_frame(ETP_PEER_IDENTIFIER, { 0x15, 3, 0x00, 0x01, 0, 0x00, 0xEF, 0x00 })));
+	ASSERT_TRUE(read_test_can_frame(peerNode, ETP_CONNECTION_MANAGEMENT_IDENTIFIER, frame));
+	EXPECT_EQ(0x16, frame.data[0]);
+	for (std::uint32_t i = 1; i <= 3; i++)
+	{
+		ASSERT_TRUE(read_test_can_frame(peerNode, ETP_DATA_TRANSFER_IDENTIFIER, frame));
+	}
+	EXPECT_EQ(0u, numberOfCompletedTransmits);
+	ASSERT_TRUE(peerNode.write_frame(make_test_can_frame(ETP_PEER_IDENTIFIER, { 0x17, 0x08, 0x07, 0x00, 0x00, 0x00, 0xEF, 0x00 })));
+	EXPECT_TRUE(wait_for_test_condition(get_transmit_completed));
+	std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	EXPECT_EQ(1u, numberOfCompletedTransmits);
+	EXPECT_EQ(1u, numberOfSuccessfulTransmits);
+	stop_virtual_test_bus();
+}
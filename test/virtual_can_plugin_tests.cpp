@@ -0,0 +1,124 @@
+#include <gtest/gtest.h>
+
+#include "isobus/hardware_integration/virtual_can_plugin.hpp"
+#include "isobus/isobus/can_bus_load.hpp"
+
+#include <vector>
+
+static isobus::HardwareInterfaceCANFrame make_test_frame(std::uint32_t identifier, std::uint8_t value)
+{
+	isobus::HardwareInterfaceCANFrame retVal;
+
+	retVal.timestamp_us = 0;
+	retVal.identifier = identifier;
+	retVal.channel = 0;
+	retVal.dataLength = 8;
+	retVal.isExtendedFrame = true;
+
+	for (std::uint8_t i = 0; i < 8; i++)
+	{
+		retVal.data[i] = value;
+	}
+	return retVal;
+}
+
+TEST(VIRTUAL_CAN_PLUGIN_TESTS, FramesReachOtherNodes)
+{
+	VirtualCANPlugin sender("delivery_test");
+	VirtualCANPlugin receiver("delivery_test");
+	VirtualCANPlugin otherBus("delivery_test_other");
+	isobus::HardwareInterfaceCANFrame frame;
+
+	EXPECT_FALSE(sender.write_frame(make_test_frame(0x18EF1C1D, 1)));
+
+	sender.open();
+	receiver.open();
+	otherBus.open();
+	EXPECT_TRUE(sender.get_is_valid());
+	EXPECT_TRUE(sender.write_frame(make_test_frame(0x18EF1C1D, 2)));
+
+	ASSERT_TRUE(receiver.read_frame(frame));
+	EXPECT_EQ(0x18EF1C1Du, frame.identifier);
+	EXPECT_EQ(2, frame.data[7]);
+
+	// Nodes don't receive their own frames, or frames from other buses
+	EXPECT_FALSE(sender.read_frame(frame));
+	EXPECT_FALSE(otherBus.read_frame(frame));
+
+	receiver.close();
+	EXPECT_FALSE(receiver.get_is_valid());
+	EXPECT_FALSE(receiver.read_frame(frame));
+}
+
+TEST(VIRTUAL_CAN_PLUGIN_TESTS, ArbitrationAndBitRate)
+{
+	constexpr std::uint32_t BIT_RATE = 10000;
+	VirtualCANPlugin::set_bus_bit_rate("arbitration_test", BIT_RATE);
+	VirtualCANPlugin firstNode("arbitration_test");
+	VirtualCANPlugin lowPriorityNode("arbitration_test");
+	VirtualCANPlugin highPriorityNode("arbitration_test");
+	VirtualCANPlugin receiver("arbitration_test");
+	std::vector<isobus::HardwareInterfaceCANFrame> frames(4);
+
+	firstNode.open();
+	lowPriorityNode.open();
+	highPriorityNode.open();
+	receiver.open();
+
+	// The first frame takes the bus, and the others wait for it. The lowest identifier goes next,
+	// but each node still sends its own frames in order.
+	EXPECT_TRUE(firstNode.write_frame(make_test_frame(0x1CFF0000, 1)));
+	EXPECT_TRUE(lowPriorityNode.write_frame(make_test_frame(0x18FF0000, 2)));
+	EXPECT_TRUE(lowPriorityNode.write_frame(make_test_frame(0x08FF0000, 3)));
+	EXPECT_TRUE(highPriorityNode.write_frame(make_test_frame(0x0CFF0000, 4)));
+
+	for (auto &frame : frames)
+	{
+		ASSERT_TRUE(receiver.read_frame(frame));
+	}
+	EXPECT_EQ(1, frames[0].data[0]);
+	EXPECT_EQ(4, frames[1].data[0]);
+	EXPECT_EQ(2, frames[2].data[0]);
+	EXPECT_EQ(3, frames[3].data[0]);
+
+	// Each frame starts as soon as the one before it finishes, and takes its exact length with stuff bits
+	for (std::size_t i = 1; i < frames.size(); i++)
+	{
+		EXPECT_EQ(isobus::CANBusLoad::get_bit_time_us(isobus::CANBusLoad::get_frame_bit_length(frames[i]), BIT_RATE), frames[i].timestamp_us - frames[i - 1].timestamp_us);
+	}
+	VirtualCANPlugin::set_bus_bit_rate("arbitration_test", 0);
+}
+
+TEST(VIRTUAL_CAN_PLUGIN_TESTS, RepeatableFrameLoss)
+{
+	constexpr std::uint8_t NUMBER_OF_FRAMES = 100;
+	VirtualCANPlugin sender("loss_test");
+	VirtualCANPlugin receiver("loss_test");
+	std::vector<std::uint8_t> receivedValues[2];
+	isobus::HardwareInterfaceCANFrame frame;
+
+	sender.open();
+	receiver.open();
+
+	for (auto &values : receivedValues)
+	{
+		VirtualCANPlugin::set_bus_frame_loss("loss_test", 0.25f, 1234);
+
+		for (std::uint8_t i = 0; i < NUMBER_OF_FRAMES; i++)
+		{
+			EXPECT_TRUE(sender.write_frame(make_test_frame(0x18FF0000, i)));
+		}
+
+		while (receiver.read_frame(frame))
+		{
+			values.push_back(frame.data[0]);
+		}
+	}
+	EXPECT_LT(receivedValues[0].size(), NUMBER_OF_FRAMES);
+	EXPECT_GT(receivedValues[0].size(), NUMBER_OF_FRAMES / 2);
+	EXPECT_EQ(receivedValues[0], receivedValues[1]);
+
+	VirtualCANPlugin::set_bus_frame_loss("loss_test", 1.0f, 0);
+	EXPECT_TRUE(sender.write_frame(make_test_frame(0x18FF0000, 0)));
+	EXPECT_FALSE(receiver.read_frame(frame));
+}
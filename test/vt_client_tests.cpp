@@ -0,0 +1,698 @@
+#include <gtest/gtest.h>
+
+#include "isobus/hardware_integration/virtual_can_plugin.hpp"
+#include "isobus/isobus/isobus_virtual_terminal_client.hpp"
+#include "isobus/utility/system_timing.hpp"
+
+#include "test_CAN_glue.hpp"
+
+#include <array>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using namespace isobus;
+
+static std::vector<std::uint8_t> make_test_pool()
+{
+	return {
+		// Working set 0, with one child object (3000 at 0,0), no macros, no languages
+		0x00, 0x00, 0x00, 0x01, 0x01, 0xE8, 0x03, 0x01, 0x00, 0x00, 0xB8, 0x0B, 0x00, 0x00, 0x00, 0x00,
+		// Output string 11000 with a 3 byte value and one macro
+		0xF8, 0x2A, 0x0B, 0x32, 0x00, 0x10, 0x00, 0x00, 0xD8, 0x59, 0x00, 0xFF, 0xFF, 0x00, 0x03, 0x00, 'a', 'b', 'c', 0x01, 0x0A, 0x01,
+		// Number variable 21000
+		0x08, 0x52, 0x15, 0x04, 0x03, 0x02, 0x01
+	};
+}
+
+// Reads frames until one with the identifier and first data byte turns up, so that maintenance messages are skipped
+static bool read_test_vt_frame(VirtualCANPlugin &node, std::uint32_t identifier, std::uint8_t firstByte, std::uint32_t timeout_ms, HardwareInterfaceCANFrame &frame)
+{
+	const std::uint32_t startTimestamp_ms = SystemTiming::get_timestamp_ms();
+	bool retVal = false;
+
+	while ((!retVal) && (!SystemTiming::time_expired_ms(startTimestamp_ms, timeout_ms)))
+	{
+		retVal = ((node.read_frame(frame)) &&
+		          ((0x03FFFFFF & identifier) == (0x03FFFFFF & frame.identifier)) &&
+		          (firstByte == frame.data[0]));
+	}
+	return retVal;
+}
+
+// Reads the next command the client sends to the VT, skipping working set maintenance messages
+static bool read_next_test_vt_command(VirtualCANPlugin &node, std::uint32_t identifier, std::uint32_t timeout_ms, HardwareInterfaceCANFrame &frame)
+{
+	const std::uint32_t startTimestamp_ms = SystemTiming::get_timestamp_ms();
+	bool retVal = false;
+
+	while ((!retVal) && (!SystemTiming::time_expired_ms(startTimestamp_ms, timeout_ms)))
+	{
+		retVal = ((node.read_frame(frame)) &&
+		          ((0x03FFFFFF & identifier) == (0x03FFFFFF & frame.identifier)) &&
+		          (0xFF != frame.data[0]));
+	}
+	return retVal;
+}
+
+// Sends a VT status message with the given busy codes
+static bool send_test_vt_status(VirtualCANPlugin &peerNode, std::uint8_t vtAddress, std::uint8_t busyCodes)
+{
+	return peerNode.write_frame(make_test_can_frame((0x1CE6FF00 | vtAddress), { 0xFE, 0xFE, 0xFF, 0xFF, 0xFF, 0xFF, busyCodes, 0xFF }));
+}
+
+// Plays the VT's side of a transport protocol session to the client, once its request to send has been read
+static void receive_test_vt_transfer(VirtualCANPlugin &peerNode, std::uint8_t clientAddress, std::uint8_t vtAddress, const HardwareInterfaceCANFrame &requestToSend)
+{
+	const std::uint32_t dataTransferIdentifier = (0x1CEB0000 | (vtAddress << 8) | clientAddress);
+	const std::uint32_t peerIdentifier = (0x1CEC0000 | (clientAddress << 8) | vtAddress);
+	const std::uint8_t numberOfPackets = requestToSend.data[3];
+	HardwareInterfaceCANFrame frame;
+
+	EXPECT_TRUE(peerNode.write_frame(make_test_can_frame(peerIdentifier, { 0x11, numberOfPackets, 1, 0xFF, 0xFF, 0x00, 0xE7, 0x00 })));
+	for (std::uint8_t i = 1; i <= numberOfPackets; i++)
+	{
+		EXPECT_TRUE(read_test_vt_frame(peerNode, dataTransferIdentifier, i, 2000, frame));
+	}
+	EXPECT_TRUE(peerNode.write_frame(make_test_can_frame(peerIdentifier, { 0x13, requestToSend.data[1], requestToSend.data[2], numberOfPackets, 0xFF, 0x00, 0xE7, 0x00 })));
+}
+
+// Answers the client's requests for the VT's capabilities, once it has asked for the memory, until it asks the VT to load a version
+static void answer_test_vt_capability_requests(VirtualCANPlugin &peerNode, std::uint8_t clientAddress, std::uint8_t vtAddress, HardwareInterfaceCANFrame &frame)
+{
+	const std::uint32_t clientIdentifier = (0x1CE70000 | (vtAddress << 8) | clientAddress);
+	const std::uint32_t vtIdentifier = (0x1CE60000 | (clientAddress << 8) | vtAddress);
+
+	EXPECT_TRUE(peerNode.write_frame(make_test_can_frame(vtIdentifier, { 0xC0, 0x04, 0x00, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF })));
+	EXPECT_TRUE(read_test_vt_frame(peerNode, clientIdentifier, 0xC2, 2000, frame));
+	EXPECT_TRUE(peerNode.write_frame(make_test_can_frame(vtIdentifier, { 0xC2, 0xFF, 0xFF, 0xFF, 60, 60, 64, 6 })));
+	EXPECT_TRUE(read_test_vt_frame(peerNode, clientIdentifier, 0xC3, 2000, frame));
+	EXPECT_TRUE(peerNode.write_frame(make_test_can_frame(vtIdentifier, { 0xC3, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x00 })));
+	EXPECT_TRUE(read_test_vt_frame(peerNode, clientIdentifier, 0xC7, 2000, frame));
+	EXPECT_TRUE(peerNode.write_frame(make_test_can_frame(vtIdentifier, { 0xC7, 0xFF, 0x02, 0x0F, 0xE0, 0x01, 0xE0, 0x01 })));
+	EXPECT_TRUE(read_test_vt_frame(peerNode, clientIdentifier, 0xD1, 2000, frame));
+}
+
+// Creates a client with the test pool and caching enabled, and plays the VT up to the point where the client asks it to load a version
+static VirtualTerminalClient *connect_test_vt_client(VirtualCANPlugin &peerNode,
+                                                     std::shared_ptr<InternalControlFunction> internalControlFunction,
+                                                     PartneredControlFunction *partner,
+                                                     const std::vector<std::uint8_t> &pool,
+                                                     std::array<std::uint8_t, 7> &versionLabel)
+{
+	const std::uint8_t clientAddress = internalControlFunction->get_address();
+	const std::uint8_t vtAddress = partner->get_address();
+	const std::uint32_t clientIdentifier = (0x1CE70000 | (vtAddress << 8) | clientAddress);
+	// The client's callbacks stay registered with the network manager, so it is never deleted
+	VirtualTerminalClient *retVal = new VirtualTerminalClient(std::shared_ptr<PartneredControlFunction>(partner, [](PartneredControlFunction *) {}), internalControlFunction);
+	HardwareInterfaceCANFrame frame;
+
+	retVal->set_object_pool(0, VirtualTerminalClient::VTVersion::Version4, pool.data(), static_cast<std::uint32_t>(pool.size()));
+	retVal->set_object_pool_version_caching(true);
+	// Queued commands are only sent once the client is connected, which makes them a good way to tell when it is
+	retVal->set_command_queue_enabled(true);
+	retVal->initialize(true);
+
+	EXPECT_TRUE(send_test_vt_status(peerNode, vtAddress, 0x00));
+	EXPECT_TRUE(read_test_vt_frame(peerNode, clientIdentifier, 0xC0, 2000, frame));
+	answer_test_vt_capability_requests(peerNode, clientAddress, vtAddress, frame);
+
+	for (std::uint8_t i = 0; i < versionLabel.size(); i++)
+	{
+		versionLabel[i] = frame.data[i + 1];
+	}
+	return retVal;
+}
+
+// Stops sending VT status messages until the client disconnects, then plays the VT up to the point where the client asks it to load a version again
+static void restart_test_vt_connection(VirtualCANPlugin &peerNode, std::uint8_t clientAddress, std::uint8_t vtAddress)
+{
+	const std::uint32_t clientIdentifier = (0x1CE70000 | (vtAddress << 8) | clientAddress);
+	HardwareInterfaceCANFrame frame;
+
+	EXPECT_TRUE(read_test_vt_frame(peerNode, clientIdentifier, 0xC0, 5000, frame));
+	EXPECT_TRUE(send_test_vt_status(peerNode, vtAddress, 0x00));
+	answer_test_vt_capability_requests(peerNode, clientAddress, vtAddress, frame);
+}
+
+// Connects a client by answering its Load Version command, with the queue sending as fast as the pending response limit allows
+static VirtualTerminalClient *start_connected_test_vt_client(VirtualCANPlugin &peerNode,
+                                                             std::shared_ptr<InternalControlFunction> internalControlFunction,
+                                                             PartneredControlFunction *partner,
+                                                             const std::vector<std::uint8_t> &pool)
+{
+	const std::uint8_t clientAddress = internalControlFunction->get_address();
+	const std::uint8_t vtAddress = partner->get_address();
+	std::array<std::uint8_t, 7> versionLabel;
+	VirtualTerminalClient *retVal = connect_test_vt_client(peerNode, internalControlFunction, partner, pool, versionLabel);
+
+	retVal->set_command_queue_interval(0);
+	EXPECT_TRUE(peerNode.write_frame(make_test_can_frame((0x1CE60000 | (clientAddress << 8) | vtAddress), { 0xD1, 0xFF, 0xFF, 0xFF, 0xFF, 0x00, 0xFF, 0xFF })));
+	EXPECT_TRUE(wait_for_test_condition([retVal]() { return (100.0f == retVal->get_object_pool_upload_progress_percent()); }));
+	return retVal;
+}
+
+TEST(VIRTUAL_TERMINAL_CLIENT_TESTS, LoadVersionSuccess)
+{
+	constexpr std::uint8_t CLIENT_ADDRESS = 0x69;
+	constexpr std::uint8_t VT_ADDRESS = 0x6A;
+	constexpr std::uint32_t CLIENT_IDENTIFIER = (0x1CE70000 | (VT_ADDRESS << 8) | CLIENT_ADDRESS);
+	constexpr std::uint32_t VT_IDENTIFIER = (0x1CE60000 | (CLIENT_ADDRESS << 8) | VT_ADDRESS);
+	VirtualCANPlugin stackNode("vt_load_version_success_test");
+	VirtualCANPlugin peerNode("vt_load_version_success_test");
+	PartneredControlFunction *partner = nullptr;
+	HardwareInterfaceCANFrame frame;
+	std::vector<std::uint8_t> pool = make_test_pool();
+	std::array<std::uint8_t, 7> versionLabel;
+
+	std::shared_ptr<InternalControlFunction> testControlFunction = start_virtual_test_bus(stackNode, peerNode, CLIENT_ADDRESS, partner, VT_ADDRESS);
+	ASSERT_TRUE(testControlFunction->get_address_valid());
+	ASSERT_TRUE(partner->get_address_valid());
+
+	VirtualTerminalClient *client = connect_test_vt_client(peerNode, testControlFunction, partner, pool, versionLabel);
+	EXPECT_EQ(0.0f, client->get_object_pool_upload_progress_percent());
+
+	// The label only uses characters that any VT can store
+	for (std::uint8_t character : versionLabel)
+	{
+		EXPECT_TRUE(((character >= '0') && (character <= '9')) || ((character >= 'A') && (character <= 'Z')));
+	}
+
+	// The VT has this version, so the client connects without uploading the pool
+	EXPECT_TRUE(client->send_change_numeric_value(21000, 5));
+	ASSERT_TRUE(peerNode.write_frame(make_test_can_frame(VT_IDENTIFIER, { 0xD1, 0xFF, 0xFF, 0xFF, 0xFF, 0x00, 0xFF, 0xFF })));
+	ASSERT_TRUE(read_test_vt_frame(peerNode, CLIENT_IDENTIFIER, 0xA8, 2000, frame));
+	EXPECT_EQ(100.0f, client->get_object_pool_upload_progress_percent());
+
+	client->terminate();
+	stop_virtual_test_bus();
+}
+
+TEST(VIRTUAL_TERMINAL_CLIENT_TESTS, LoadVersionFailure)
+{
+	constexpr std::uint8_t CLIENT_ADDRESS = 0x6B;
+	constexpr std::uint8_t VT_ADDRESS = 0x6C;
+	constexpr std::uint32_t CLIENT_IDENTIFIER = (0x1CE70000 | (VT_ADDRESS << 8) | CLIENT_ADDRESS);
+	constexpr std::uint32_t VT_IDENTIFIER = (0x1CE60000 | (CLIENT_ADDRESS << 8) | VT_ADDRESS);
+	constexpr std::uint32_t TP_CONNECTION_MANAGEMENT_IDENTIFIER = (0x1CEC0000 | (VT_ADDRESS << 8) | CLIENT_ADDRESS);
+	constexpr std::uint32_t TP_DATA_TRANSFER_IDENTIFIER = (0x1CEB0000 | (VT_ADDRESS << 8) | CLIENT_ADDRESS);
+	constexpr std::uint32_t TP_PEER_IDENTIFIER = (0x1CEC0000 | (CLIENT_ADDRESS << 8) | VT_ADDRESS);
+	VirtualCANPlugin stackNode("vt_load_version_failure_test");
+	VirtualCANPlugin peerNode("vt_load_version_failure_test");
+	PartneredControlFunction *partner = nullptr;
+	HardwareInterfaceCANFrame frame;
+	std::vector<std::uint8_t> pool = make_test_pool();
+	std::array<std::uint8_t, 7> versionLabel;
+
+	std::shared_ptr<InternalControlFunction> testControlFunction = start_virtual_test_bus(stackNode, peerNode, CLIENT_ADDRESS, partner, VT_ADDRESS);
+	ASSERT_TRUE(testControlFunction->get_address_valid());
+	ASSERT_TRUE(partner->get_address_valid());
+
+	VirtualTerminalClient *client = connect_test_vt_client(peerNode, testControlFunction, partner, pool, versionLabel);
+
+	// The VT doesn't have this version, so the client uploads the pool, with the object pool transfer mux in front
+	const std::uint32_t transferSize = static_cast<std::uint32_t>(pool.size() + 1);
+	const std::uint8_t numberOfPackets = static_cast<std::uint8_t>((transferSize + 6) / 7);
+	ASSERT_TRUE(peerNode.write_frame(make_test_can_frame(VT_IDENTIFIER, { 0xD1, 0xFF, 0xFF, 0xFF, 0xFF, 0x01, 0xFF, 0xFF })));
+	ASSERT_TRUE(read_test_vt_frame(peerNode, TP_CONNECTION_MANAGEMENT_IDENTIFIER, 0x10, 2000, frame));
+	EXPECT_EQ(transferSize, static_cast<std::uint32_t>(frame.data[1] | (frame.data[2] << 8)));
+	EXPECT_EQ(numberOfPackets, frame.data[3]);
+	ASSERT_TRUE(peerNode.write_frame(make_test_can_frame(TP_PEER_IDENTIFIER, { 0x11, numberOfPackets, 1, 0xFF, 0xFF, 0x00, 0xE7, 0x00 })));
+
+	for (std::uint8_t i = 1; i <= numberOfPackets; i++)
+	{
+		ASSERT_TRUE(read_test_vt_frame(peerNode, TP_DATA_TRANSFER_IDENTIFIER, i, 2000, frame));
+
+		if (1 == i)
+		{
+			EXPECT_EQ(0x11, frame.data[1]);
+			EXPECT_EQ(pool[0], frame.data[2]);
+		}
+	}
+	ASSERT_TRUE(peerNode.write_frame(make_test_can_frame(TP_PEER_IDENTIFIER, { 0x13, static_cast<std::uint8_t>(transferSize), 0, numberOfPackets, 0xFF, 0x00, 0xE7, 0x00 })));
+
+	// After the pool is accepted, the client asks the VT to store it under the same label, and only connects after that
+	ASSERT_TRUE(read_test_vt_frame(peerNode, CLIENT_IDENTIFIER, 0x12, 2000, frame));
+	EXPECT_TRUE(client->send_change_numeric_value(21000, 5));
+	ASSERT_TRUE(peerNode.write_frame(make_test_can_frame(VT_IDENTIFIER, { 0x12, 0x00, 0xFF, 0xFF, 0xFF, 0xFF, 0x00, 0xFF })));
+	ASSERT_TRUE(read_test_vt_frame(peerNode, CLIENT_IDENTIFIER, 0xD0, 2000, frame));
+
+	for (std::uint8_t i = 0; i < versionLabel.size(); i++)
+	{
+		EXPECT_EQ(versionLabel[i], frame.data[i + 1]);
+	}
+	ASSERT_TRUE(peerNode.write_frame(make_test_can_frame(VT_IDENTIFIER, { 0xD0, 0xFF, 0xFF, 0xFF, 0xFF, 0x00, 0xFF, 0xFF })));
+	ASSERT_TRUE(read_test_vt_frame(peerNode, CLIENT_IDENTIFIER, 0xA8, 2000, frame));
+
+	client->terminate();
+	stop_virtual_test_bus();
+}
+
+TEST(VIRTUAL_TERMINAL_CLIENT_TESTS, LoadVersionTimeout)
+{
+	constexpr std::uint8_t CLIENT_ADDRESS = 0x6D;
+	constexpr std::uint8_t VT_ADDRESS = 0x6E;
+	constexpr std::uint32_t TP_CONNECTION_MANAGEMENT_IDENTIFIER = (0x1CEC0000 | (VT_ADDRESS << 8) | CLIENT_ADDRESS);
+	constexpr std::uint32_t TP_PEER_IDENTIFIER = (0x1CEC0000 | (CLIENT_ADDRESS << 8) | VT_ADDRESS);
+	VirtualCANPlugin stackNode("vt_load_version_timeout_test");
+	VirtualCANPlugin peerNode("vt_load_version_timeout_test");
+	PartneredControlFunction *partner = nullptr;
+	HardwareInterfaceCANFrame frame;
+	std::vector<std::uint8_t> pool = make_test_pool();
+	std::array<std::uint8_t, 7> versionLabel;
+
+	std::shared_ptr<InternalControlFunction> testControlFunction = start_virtual_test_bus(stackNode, peerNode, CLIENT_ADDRESS, partner, VT_ADDRESS);
+	ASSERT_TRUE(testControlFunction->get_address_valid());
+	ASSERT_TRUE(partner->get_address_valid());
+
+	VirtualTerminalClient *client = connect_test_vt_client(peerNode, testControlFunction, partner, pool, versionLabel);
+	const std::uint32_t loadVersionTimestamp_ms = SystemTiming::get_timestamp_ms();
+
+	// Without a response, the client gives up after the normal VT response timeout and uploads the pool
+	ASSERT_TRUE(read_test_vt_frame(peerNode, TP_CONNECTION_MANAGEMENT_IDENTIFIER, 0x10, 5000, frame));
+	EXPECT_GE(SystemTiming::get_time_elapsed_ms(loadVersionTimestamp_ms), 2900u);
+
+	client->terminate();
+	ASSERT_TRUE(peerNode.write_frame(make_test_can_frame(TP_PEER_IDENTIFIER, { 0xFF, 0x01, 0xFF, 0xFF, 0xFF, 0x00, 0xE7, 0x00 })));
+	std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	stop_virtual_test_bus();
+}
+
+TEST(VIRTUAL_TERMINAL_CLIENT_TESTS, QueuedCommandIsReplaced)
+{
+	constexpr std::uint8_t CLIENT_ADDRESS = 0x6F;
+	constexpr std::uint8_t VT_ADDRESS = 0x70;
+	constexpr std::uint32_t CLIENT_IDENTIFIER = (0x1CE70000 | (VT_ADDRESS << 8) | CLIENT_ADDRESS);
+	constexpr std::uint32_t VT_IDENTIFIER = (0x1CE60000 | (CLIENT_ADDRESS << 8) | VT_ADDRESS);
+	VirtualCANPlugin stackNode("vt_command_queue_replace_test");
+	VirtualCANPlugin peerNode("vt_command_queue_replace_test");
+	PartneredControlFunction *partner = nullptr;
+	HardwareInterfaceCANFrame frame;
+	std::vector<std::uint8_t> pool = make_test_pool();
+	std::array<std::uint8_t, 7> versionLabel;
+
+	std::shared_ptr<InternalControlFunction> testControlFunction = start_virtual_test_bus(stackNode, peerNode, CLIENT_ADDRESS, partner, VT_ADDRESS);
+	ASSERT_TRUE(testControlFunction->get_address_valid());
+	ASSERT_TRUE(partner->get_address_valid());
+
+	// Nothing is sent from the queue until the client connects
+	VirtualTerminalClient *client = connect_test_vt_client(peerNode, testControlFunction, partner, pool, versionLabel);
+	EXPECT_TRUE(client->send_change_numeric_value(21000, 1));
+	EXPECT_TRUE(client->send_hide_show_object(11000, VirtualTerminalClient::HideShowObjectCommand::HideObject));
+	EXPECT_TRUE(client->send_change_numeric_value(21000, 2));
+	EXPECT_EQ(2u, client->get_command_queue_size());
+
+	// The newer value takes the place of the queued one, ahead of the command queued after it
+	ASSERT_TRUE(peerNode.write_frame(make_test_can_frame(VT_IDENTIFIER, { 0xD1, 0xFF, 0xFF, 0xFF, 0xFF, 0x00, 0xFF, 0xFF })));
+	ASSERT_TRUE(read_next_test_vt_command(peerNode, CLIENT_IDENTIFIER, 2000, frame));
+	EXPECT_EQ(0xA8, frame.data[0]);
+	EXPECT_EQ(0x08, frame.data[1]);
+	EXPECT_EQ(0x52, frame.data[2]);
+	EXPECT_EQ(2, frame.data[4]);
+	ASSERT_TRUE(read_next_test_vt_command(peerNode, CLIENT_IDENTIFIER, 2000, frame));
+	EXPECT_EQ(0xA0, frame.data[0]);
+	EXPECT_FALSE(read_next_test_vt_command(peerNode, CLIENT_IDENTIFIER, 200, frame));
+	EXPECT_EQ(0u, client->get_command_queue_size());
+
+	client->terminate();
+	stop_virtual_test_bus();
+}
+
+TEST(VIRTUAL_TERMINAL_CLIENT_TESTS, BusyVTLimitsPipelining)
+{
+	constexpr std::uint8_t CLIENT_ADDRESS = 0x7E;
+	constexpr std::uint8_t VT_ADDRESS = 0x7F;
+	constexpr std::uint32_t CLIENT_IDENTIFIER = (0x1CE70000 | (VT_ADDRESS << 8) | CLIENT_ADDRESS);
+	constexpr std::uint32_t VT_IDENTIFIER = (0x1CE60000 | (CLIENT_ADDRESS << 8) | VT_ADDRESS);
+	VirtualCANPlugin stackNode("vt_command_queue_busy_test");
+	VirtualCANPlugin peerNode("vt_command_queue_busy_test");
+	PartneredControlFunction *partner = nullptr;
+	HardwareInterfaceCANFrame frame;
+	std::vector<std::uint8_t> pool = make_test_pool();
+
+	std::shared_ptr<InternalControlFunction> testControlFunction = start_virtual_test_bus(stackNode, peerNode, CLIENT_ADDRESS, partner, VT_ADDRESS);
+	ASSERT_TRUE(testControlFunction->get_address_valid());
+	ASSERT_TRUE(partner->get_address_valid());
+
+	VirtualTerminalClient *client = start_connected_test_vt_client(peerNode, testControlFunction, partner, pool);
+	client->set_command_queue_max_pending_responses(3);
+
+	// While the VT is busy executing a command, only one command at a time waits on a response
+	ASSERT_TRUE(send_test_vt_status(peerNode, VT_ADDRESS, 0x04));
+	std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	for (std::uint16_t i = 0; i < 5; i++)
+	{
+		EXPECT_TRUE(client->send_change_numeric_value(21000 + i, i));
+	}
+	ASSERT_TRUE(read_next_test_vt_command(peerNode, CLIENT_IDENTIFIER, 2000, frame));
+	EXPECT_EQ(0, frame.data[4]);
+	EXPECT_FALSE(read_next_test_vt_command(peerNode, CLIENT_IDENTIFIER, 200, frame));
+
+	ASSERT_TRUE(peerNode.write_frame(make_test_can_frame(VT_IDENTIFIER, { 0xA8, 0x08, 0x52, 0xFF, 0x00, 0x00, 0x00, 0x00 })));
+	ASSERT_TRUE(read_next_test_vt_command(peerNode, CLIENT_IDENTIFIER, 2000, frame));
+	EXPECT_EQ(1, frame.data[4]);
+	EXPECT_FALSE(read_next_test_vt_command(peerNode, CLIENT_IDENTIFIER, 200, frame));
+
+	// Once it isn't busy, commands are pipelined up to the pending response limit
+	ASSERT_TRUE(send_test_vt_status(peerNode, VT_ADDRESS, 0x00));
+	ASSERT_TRUE(read_next_test_vt_command(peerNode, CLIENT_IDENTIFIER, 2000, frame));
+	EXPECT_EQ(2, frame.data[4]);
+	ASSERT_TRUE(read_next_test_vt_command(peerNode, CLIENT_IDENTIFIER, 2000, frame));
+	EXPECT_EQ(3, frame.data[4]);
+	EXPECT_FALSE(read_next_test_vt_command(peerNode, CLIENT_IDENTIFIER, 200, frame));
+	EXPECT_EQ(1u, client->get_command_queue_size());
+
+	client->terminate();
+	stop_virtual_test_bus();
+}
+
+TEST(VIRTUAL_TERMINAL_CLIENT_TESTS, CommandResponseTimeout)
+{
+	constexpr std::uint8_t CLIENT_ADDRESS = 0x80;
+	constexpr std::uint8_t VT_ADDRESS = 0x81;
+	constexpr std::uint32_t CLIENT_IDENTIFIER = (0x1CE70000 | (VT_ADDRESS << 8) | CLIENT_ADDRESS);
+	VirtualCANPlugin stackNode("vt_command_queue_timeout_test");
+	VirtualCANPlugin peerNode("vt_command_queue_timeout_test");
+	PartneredControlFunction *partner = nullptr;
+	HardwareInterfaceCANFrame frame;
+	std::vector<std::uint8_t> pool = make_test_pool();
+
+	std::shared_ptr<InternalControlFunction> testControlFunction = start_virtual_test_bus(stackNode, peerNode, CLIENT_ADDRESS, partner, VT_ADDRESS);
+	ASSERT_TRUE(testControlFunction->get_address_valid());
+	ASSERT_TRUE(partner->get_address_valid());
+
+	VirtualTerminalClient *client = start_connected_test_vt_client(peerNode, testControlFunction, partner, pool);
+	client->set_command_queue_max_pending_responses(1);
+
+	EXPECT_TRUE(client->send_change_numeric_value(21000, 0));
+	EXPECT_TRUE(client->send_change_numeric_value(21001, 1));
+	ASSERT_TRUE(read_next_test_vt_command(peerNode, CLIENT_IDENTIFIER, 2000, frame));
+	EXPECT_EQ(0, frame.data[4]);
+	const std::uint32_t firstCommandTimestamp_ms = SystemTiming::get_timestamp_ms();
+
+	// The VT never responds, so the first command stops counting as pending after the response timeout
+	ASSERT_TRUE(read_next_test_vt_command(peerNode, CLIENT_IDENTIFIER, 2500, frame));
+	EXPECT_EQ(1, frame.data[4]);
+	EXPECT_GE(SystemTiming::get_time_elapsed_ms(firstCommandTimestamp_ms), 1400u);
+
+	client->terminate();
+	stop_virtual_test_bus();
+}
+
+TEST(VIRTUAL_TERMINAL_CLIENT_TESTS, StringValueIsOnlySentWhenChanged)
+{
+	constexpr std::uint8_t CLIENT_ADDRESS = 0x82;
+	constexpr std::uint8_t VT_ADDRESS = 0x83;
+	constexpr std::uint32_t CLIENT_IDENTIFIER = (0x1CE70000 | (VT_ADDRESS << 8) | CLIENT_ADDRESS);
+	constexpr std::uint32_t VT_IDENTIFIER = (0x1CE60000 | (CLIENT_ADDRESS << 8) | VT_ADDRESS);
+	VirtualCANPlugin stackNode("vt_string_value_dedup_test");
+	VirtualCANPlugin peerNode("vt_string_value_dedup_test");
+	PartneredControlFunction *partner = nullptr;
+	HardwareInterfaceCANFrame frame;
+	std::vector<std::uint8_t> pool = make_test_pool();
+
+	std::shared_ptr<InternalControlFunction> testControlFunction = start_virtual_test_bus(stackNode, peerNode, CLIENT_ADDRESS, partner, VT_ADDRESS);
+	ASSERT_TRUE(testControlFunction->get_address_valid());
+	ASSERT_TRUE(partner->get_address_valid());
+
+	VirtualTerminalClient *client = start_connected_test_vt_client(peerNode, testControlFunction, partner, pool);
+
+	EXPECT_TRUE(client->send_change_string_value(11000, "abc"));
+	ASSERT_TRUE(read_next_test_vt_command(peerNode, CLIENT_IDENTIFIER, 2000, frame));
+	EXPECT_EQ(0xB3, frame.data[0]);
+	EXPECT_EQ(3, frame.data[3]);
+	EXPECT_EQ('a', frame.data[5]);
+
+	// The VT already shows this value
+	EXPECT_TRUE(client->send_change_string_value(11000, "abc"));
+	EXPECT_FALSE(read_next_test_vt_command(peerNode, CLIENT_IDENTIFIER, 200, frame));
+
+	// Once the operator changes the value on the VT, the same value has to be sent again
+	ASSERT_TRUE(peerNode.write_frame(make_test_can_frame(VT_IDENTIFIER, { 0x08, 0xF8, 0x2A, 0x03, 0x00, 'x', 'y', 'z' })));
+	std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	EXPECT_TRUE(client->send_change_string_value(11000, "abc"));
+	ASSERT_TRUE(read_next_test_vt_command(peerNode, CLIENT_IDENTIFIER, 2000, frame));
+	EXPECT_EQ(0xB3, frame.data[0]);
+	EXPECT_EQ('a', frame.data[5]);
+
+	client->terminate();
+	stop_virtual_test_bus();
+}
+
+TEST(VIRTUAL_TERMINAL_CLIENT_TESTS, NewerStringValueReplacesQueuedOne)
+{
+	constexpr std::uint8_t CLIENT_ADDRESS = 0x84;
+	constexpr std::uint8_t VT_ADDRESS = 0x85;
+	constexpr std::uint32_t CLIENT_IDENTIFIER = (0x1CE70000 | (VT_ADDRESS << 8) | CLIENT_ADDRESS);
+	constexpr std::uint32_t TP_CONNECTION_MANAGEMENT_IDENTIFIER = (0x1CEC0000 | (VT_ADDRESS << 8) | CLIENT_ADDRESS);
+	VirtualCANPlugin stackNode("vt_string_value_replace_test");
+	VirtualCANPlugin peerNode("vt_string_value_replace_test");
+	PartneredControlFunction *partner = nullptr;
+	HardwareInterfaceCANFrame frame;
+	std::vector<std::uint8_t> pool = make_test_pool();
+
+	std::shared_ptr<InternalControlFunction> testControlFunction = start_virtual_test_bus(stackNode, peerNode, CLIENT_ADDRESS, partner, VT_ADDRESS);
+	ASSERT_TRUE(testControlFunction->get_address_valid());
+	ASSERT_TRUE(partner->get_address_valid());
+
+	VirtualTerminalClient *client = start_connected_test_vt_client(peerNode, testControlFunction, partner, pool);
+
+	// Hold up the string value queue with a value that needs the transport layer
+	EXPECT_TRUE(client->send_change_string_value(11000, "long value"));
+	ASSERT_TRUE(read_test_vt_frame(peerNode, TP_CONNECTION_MANAGEMENT_IDENTIFIER, 0x10, 2000, frame));
+
+	EXPECT_TRUE(client->send_change_string_value(11001, "x"));
+	EXPECT_TRUE(client->send_change_string_value(11001, "y"));
+	receive_test_vt_transfer(peerNode, CLIENT_ADDRESS, VT_ADDRESS, frame);
+
+	// Only the latest value is sent
+	ASSERT_TRUE(read_next_test_vt_command(peerNode, CLIENT_IDENTIFIER, 2000, frame));
+	EXPECT_EQ(0xB3, frame.data[0]);
+	EXPECT_EQ(0xF9, frame.data[1]);
+	EXPECT_EQ('y', frame.data[5]);
+	EXPECT_FALSE(read_next_test_vt_command(peerNode, CLIENT_IDENTIFIER, 200, frame));
+
+	client->terminate();
+	stop_virtual_test_bus();
+}
+
+TEST(VIRTUAL_TERMINAL_CLIENT_TESTS, StringValuesWaitForTheTransportLayer)
+{
+	constexpr std::uint8_t CLIENT_ADDRESS = 0x86;
+	constexpr std::uint8_t VT_ADDRESS = 0x87;
+	constexpr std::uint32_t TP_CONNECTION_MANAGEMENT_IDENTIFIER = (0x1CEC0000 | (VT_ADDRESS << 8) | CLIENT_ADDRESS);
+	VirtualCANPlugin stackNode("vt_string_value_transport_test");
+	VirtualCANPlugin peerNode("vt_string_value_transport_test");
+	PartneredControlFunction *partner = nullptr;
+	HardwareInterfaceCANFrame firstRequest;
+	HardwareInterfaceCANFrame frame;
+	std::vector<std::uint8_t> pool = make_test_pool();
+
+	std::shared_ptr<InternalControlFunction> testControlFunction = start_virtual_test_bus(stackNode, peerNode, CLIENT_ADDRESS, partner, VT_ADDRESS);
+	ASSERT_TRUE(testControlFunction->get_address_valid());
+	ASSERT_TRUE(partner->get_address_valid());
+
+	VirtualTerminalClient *client = start_connected_test_vt_client(peerNode, testControlFunction, partner, pool);
+
+	EXPECT_TRUE(client->send_change_string_value(11000, "first value"));
+	EXPECT_TRUE(client->send_change_string_value(11001, "second value"));
+	ASSERT_TRUE(read_test_vt_frame(peerNode, TP_CONNECTION_MANAGEMENT_IDENTIFIER, 0x10, 2000, firstRequest));
+	EXPECT_EQ(16, firstRequest.data[1]);
+
+	// The second value waits until the first transfer is done
+	EXPECT_FALSE(read_test_vt_frame(peerNode, TP_CONNECTION_MANAGEMENT_IDENTIFIER, 0x10, 200, frame));
+	receive_test_vt_transfer(peerNode, CLIENT_ADDRESS, VT_ADDRESS, firstRequest);
+
+	ASSERT_TRUE(read_test_vt_frame(peerNode, TP_CONNECTION_MANAGEMENT_IDENTIFIER, 0x10, 2000, frame));
+	EXPECT_EQ(17, frame.data[1]);
+	receive_test_vt_transfer(peerNode, CLIENT_ADDRESS, VT_ADDRESS, frame);
+	std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+	client->terminate();
+	stop_virtual_test_bus();
+}
+
+TEST(VIRTUAL_TERMINAL_CLIENT_TESTS, ObjectPoolDeltaKeepsLatestChange)
+{
+	constexpr std::uint8_t CLIENT_ADDRESS = 0x88;
+	constexpr std::uint8_t VT_ADDRESS = 0x89;
+	VirtualCANPlugin stackNode("vt_object_pool_delta_record_test");
+	VirtualCANPlugin peerNode("vt_object_pool_delta_record_test");
+	PartneredControlFunction *partner = nullptr;
+	std::vector<std::uint8_t> pool = make_test_pool();
+
+	std::shared_ptr<InternalControlFunction> testControlFunction = start_virtual_test_bus(stackNode, peerNode, CLIENT_ADDRESS, partner, VT_ADDRESS);
+	ASSERT_TRUE(testControlFunction->get_address_valid());
+	ASSERT_TRUE(partner->get_address_valid());
+
+	VirtualTerminalClient *client = start_connected_test_vt_client(peerNode, testControlFunction, partner, pool);
+
+	// Nothing is recorded until replay is enabled
+	EXPECT_FALSE(client->get_object_pool_delta_replay_enabled());
+	EXPECT_TRUE(client->send_change_numeric_value(21000, 1));
+	EXPECT_EQ(0u, client->get_number_object_pool_deltas());
+
+	// One entry per function, object, and attribute
+	client->set_object_pool_delta_replay_enabled(true);
+	EXPECT_TRUE(client->get_object_pool_delta_replay_enabled());
+	EXPECT_TRUE(client->send_change_numeric_value(21000, 2));
+	EXPECT_TRUE(client->send_change_numeric_value(21000, 3));
+	EXPECT_TRUE(client->send_hide_show_object(21000, VirtualTerminalClient::HideShowObjectCommand::HideObject));
+	EXPECT_TRUE(client->send_change_attribute(11000, 1, 5));
+	EXPECT_TRUE(client->send_change_attribute(11000, 2, 6));
+	EXPECT_TRUE(client->send_change_attribute(11000, 2, 7));
+	EXPECT_EQ(4u, client->get_number_object_pool_deltas());
+
+	// Commands that don't set a value aren't recorded
+	EXPECT_TRUE(client->send_select_input_object(11000, VirtualTerminalClient::SelectInputObjectOptions::ActivateObjectForDataInput));
+	EXPECT_EQ(4u, client->get_number_object_pool_deltas());
+
+	// Disabling replay forgets the recorded changes
+	client->set_object_pool_delta_replay_enabled(false);
+	EXPECT_FALSE(client->get_object_pool_delta_replay_enabled());
+	EXPECT_EQ(0u, client->get_number_object_pool_deltas());
+
+	client->terminate();
+	stop_virtual_test_bus();
+}
+
+TEST(VIRTUAL_TERMINAL_CLIENT_TESTS, ObjectPoolDeltasAreReplayedOnReconnect)
+{
+	constexpr std::uint8_t CLIENT_ADDRESS = 0x8A;
+	constexpr std::uint8_t VT_ADDRESS = 0x8B;
+	constexpr std::uint32_t CLIENT_IDENTIFIER = (0x1CE70000 | (VT_ADDRESS << 8) | CLIENT_ADDRESS);
+	constexpr std::uint32_t VT_IDENTIFIER = (0x1CE60000 | (CLIENT_ADDRESS << 8) | VT_ADDRESS);
+	VirtualCANPlugin stackNode("vt_object_pool_delta_replay_test");
+	VirtualCANPlugin peerNode("vt_object_pool_delta_replay_test");
+	PartneredControlFunction *partner = nullptr;
+	HardwareInterfaceCANFrame frame;
+	std::vector<std::uint8_t> pool = make_test_pool();
+
+	std::shared_ptr<InternalControlFunction> testControlFunction = start_virtual_test_bus(stackNode, peerNode, CLIENT_ADDRESS, partner, VT_ADDRESS);
+	ASSERT_TRUE(testControlFunction->get_address_valid());
+	ASSERT_TRUE(partner->get_address_valid());
+
+	VirtualTerminalClient *client = start_connected_test_vt_client(peerNode, testControlFunction, partner, pool);
+	client->set_object_pool_delta_replay_enabled(true);
+	EXPECT_TRUE(client->send_change_numeric_value(21000, 1));
+	EXPECT_TRUE(client->send_hide_show_object(11000, VirtualTerminalClient::HideShowObjectCommand::HideObject));
+	EXPECT_TRUE(client->send_change_attribute(11000, 1, 5));
+	EXPECT_TRUE(client->send_change_numeric_value(21000, 2));
+	EXPECT_TRUE(client->send_change_string_value(11000, "xyz"));
+	while (read_next_test_vt_command(peerNode, CLIENT_IDENTIFIER, 200, frame))
+	{
+	}
+
+	// Once the VT has loaded the pool again, each change is sent once with its latest value, in the order the changes were first made
+	restart_test_vt_connection(peerNode, CLIENT_ADDRESS, VT_ADDRESS);
+	ASSERT_TRUE(peerNode.write_frame(make_test_can_frame(VT_IDENTIFIER, { 0xD1, 0xFF, 0xFF, 0xFF, 0xFF, 0x00, 0xFF, 0xFF })));
+	ASSERT_TRUE(read_next_test_vt_command(peerNode, CLIENT_IDENTIFIER, 2000, frame));
+	EXPECT_EQ(0xA8, frame.data[0]);
+	EXPECT_EQ(0x08, frame.data[1]);
+	EXPECT_EQ(0x52, frame.data[2]);
+	EXPECT_EQ(2, frame.data[4]);
+	ASSERT_TRUE(read_next_test_vt_command(peerNode, CLIENT_IDENTIFIER, 2000, frame));
+	EXPECT_EQ(0xA0, frame.data[0]);
+	EXPECT_EQ(0xF8, frame.data[1]);
+	EXPECT_EQ(0x2A, frame.data[2]);
+	ASSERT_TRUE(read_next_test_vt_command(peerNode, CLIENT_IDENTIFIER, 2000, frame));
+	EXPECT_EQ(0xAF, frame.data[0]);
+	EXPECT_EQ(1, frame.data[3]);
+	EXPECT_EQ(5, frame.data[4]);
+
+	// String values are sent again as well
+	ASSERT_TRUE(read_next_test_vt_command(peerNode, CLIENT_IDENTIFIER, 2000, frame));
+	EXPECT_EQ(0xB3, frame.data[0]);
+	EXPECT_EQ(0xF8, frame.data[1]);
+	EXPECT_EQ('x', frame.data[5]);
+	EXPECT_FALSE(read_next_test_vt_command(peerNode, CLIENT_IDENTIFIER, 200, frame));
+
+	client->terminate();
+	stop_virtual_test_bus();
+}
+
+TEST(VIRTUAL_TERMINAL_CLIENT_TESTS, CommandSentBeforeReplayIsSentOnce)
+{
+	constexpr std::uint8_t CLIENT_ADDRESS = 0x8C;
+	constexpr std::uint8_t VT_ADDRESS = 0x8D;
+	constexpr std::uint32_t CLIENT_IDENTIFIER = (0x1CE70000 | (VT_ADDRESS << 8) | CLIENT_ADDRESS);
+	constexpr std::uint32_t VT_IDENTIFIER = (0x1CE60000 | (CLIENT_ADDRESS << 8) | VT_ADDRESS);
+	VirtualCANPlugin stackNode("vt_object_pool_delta_live_test");
+	VirtualCANPlugin peerNode("vt_object_pool_delta_live_test");
+	PartneredControlFunction *partner = nullptr;
+	HardwareInterfaceCANFrame frame;
+	std::vector<std::uint8_t> pool = make_test_pool();
+
+	std::shared_ptr<InternalControlFunction> testControlFunction = start_virtual_test_bus(stackNode, peerNode, CLIENT_ADDRESS, partner, VT_ADDRESS);
+	ASSERT_TRUE(testControlFunction->get_address_valid());
+	ASSERT_TRUE(partner->get_address_valid());
+
+	VirtualTerminalClient *client = start_connected_test_vt_client(peerNode, testControlFunction, partner, pool);
+	client->set_object_pool_delta_replay_enabled(true);
+	EXPECT_TRUE(client->send_change_numeric_value(21000, 1));
+	EXPECT_TRUE(client->send_hide_show_object(11000, VirtualTerminalClient::HideShowObjectCommand::HideObject));
+	while (read_next_test_vt_command(peerNode, CLIENT_IDENTIFIER, 200, frame))
+	{
+	}
+
+	// A change made while the VT loads the pool goes out with the replay, not in addition to it
+	restart_test_vt_connection(peerNode, CLIENT_ADDRESS, VT_ADDRESS);
+	EXPECT_TRUE(client->send_change_numeric_value(21000, 7));
+	ASSERT_TRUE(peerNode.write_frame(make_test_can_frame(VT_IDENTIFIER, { 0xD1, 0xFF, 0xFF, 0xFF, 0xFF, 0x00, 0xFF, 0xFF })));
+	ASSERT_TRUE(read_next_test_vt_command(peerNode, CLIENT_IDENTIFIER, 2000, frame));
+	EXPECT_EQ(0xA8, frame.data[0]);
+	EXPECT_EQ(7, frame.data[4]);
+	ASSERT_TRUE(read_next_test_vt_command(peerNode, CLIENT_IDENTIFIER, 2000, frame));
+	EXPECT_EQ(0xA0, frame.data[0]);
+
+	// Changes made after the replay are only sent live
+	EXPECT_TRUE(client->send_change_numeric_value(21000, 8));
+	EXPECT_TRUE(client->send_change_attribute(11000, 1, 5));
+	ASSERT_TRUE(read_next_test_vt_command(peerNode, CLIENT_IDENTIFIER, 2000, frame));
+	EXPECT_EQ(0xA8, frame.data[0]);
+	EXPECT_EQ(8, frame.data[4]);
+	ASSERT_TRUE(read_next_test_vt_command(peerNode, CLIENT_IDENTIFIER, 2000, frame));
+	EXPECT_EQ(0xAF, frame.data[0]);
+	EXPECT_FALSE(read_next_test_vt_command(peerNode, CLIENT_IDENTIFIER, 200, frame));
+	EXPECT_EQ(3u, client->get_number_object_pool_deltas());
+
+	client->terminate();
+	stop_virtual_test_bus();
+}
+
+TEST(VIRTUAL_TERMINAL_CLIENT_TESTS, DisabledReplayForgetsChanges)
+{
+	constexpr std::uint8_t CLIENT_ADDRESS = 0x8E;
+	constexpr std::uint8_t VT_ADDRESS = 0x8F;
+	constexpr std::uint32_t CLIENT_IDENTIFIER = (0x1CE70000 | (VT_ADDRESS << 8) | CLIENT_ADDRESS);
+	constexpr std::uint32_t VT_IDENTIFIER = (0x1CE60000 | (CLIENT_ADDRESS << 8) | VT_ADDRESS);
+	VirtualCANPlugin stackNode("vt_object_pool_delta_disable_test");
+	VirtualCANPlugin peerNode("vt_object_pool_delta_disable_test");
+	PartneredControlFunction *partner = nullptr;
+	HardwareInterfaceCANFrame frame;
+	std::vector<std::uint8_t> pool = make_test_pool();
+
+	std::shared_ptr<InternalControlFunction> testControlFunction = start_virtual_test_bus(stackNode, peerNode, CLIENT_ADDRESS, partner, VT_ADDRESS);
+	ASSERT_TRUE(testControlFunction->get_address_valid());
+	ASSERT_TRUE(partner->get_address_valid());
+
+	VirtualTerminalClient *client = start_connected_test_vt_client(peerNode, testControlFunction, partner, pool);
+	client->set_object_pool_delta_replay_enabled(true);
+	EXPECT_TRUE(client->send_change_numeric_value(21000, 1));
+	EXPECT_TRUE(client->send_change_string_value(11000, "xyz"));
+	while (read_next_test_vt_command(peerNode, CLIENT_IDENTIFIER, 200, frame))
+	{
+	}
+	client->set_object_pool_delta_replay_enabled(false);
+
+	// Only the command that tells the test the client connected is sent
+	restart_test_vt_connection(peerNode, CLIENT_ADDRESS, VT_ADDRESS);
+	EXPECT_TRUE(client->send_hide_show_object(11000, VirtualTerminalClient::HideShowObjectCommand::HideObject));
+	ASSERT_TRUE(peerNode.write_frame(make_test_can_frame(VT_IDENTIFIER, { 0xD1, 0xFF, 0xFF, 0xFF, 0xFF, 0x00, 0xFF, 0xFF })));
+	ASSERT_TRUE(read_next_test_vt_command(peerNode, CLIENT_IDENTIFIER, 2000, frame));
+	EXPECT_EQ(0xA0, frame.data[0]);
+	EXPECT_FALSE(read_next_test_vt_command(peerNode, CLIENT_IDENTIFIER, 200, frame));
+
+	client->terminate();
+	stop_virtual_test_bus();
+}
@@ -0,0 +1,121 @@
+#include <gtest/gtest.h>
+
+#include "isobus/isobus/isobus_virtual_terminal_client.hpp"
+
+#include <vector>
+
+using namespace isobus;
+
+// Returns an encoded message, or an empty one if the batch doesn't have it
+static std::vector<std::uint8_t> get_test_message(const VirtualTerminalClient::GraphicsContextBatch &batch, std::uint32_t index)
+{
+	std::vector<std::uint8_t> retVal;
+
+	EXPECT_TRUE(batch.get_message(index, retVal));
+	return retVal;
+}
+
+TEST(VT_GRAPHICS_CONTEXT_BATCH_TESTS, RemovesRedundantOperations)
+{
+	VirtualTerminalClient::GraphicsContextBatch batch(100);
+	std::vector<std::uint8_t> message;
+
+	// Cursor moves that cancel out don't need to be sent
+	batch.move_cursor(1, 1);
+	batch.move_cursor(-1, -1);
+	batch.flush();
+	EXPECT_EQ(0, batch.get_number_messages());
+	EXPECT_FALSE(batch.get_message(0, message));
+
+	// Colour, line attributes, one combined cursor operation, and one polygon
+	batch.set_foreground_colour(3);
+	batch.set_line_attributes(200);
+	batch.set_cursor(10, 10);
+	batch.move_cursor(5, 5);
+	batch.draw_line(10, 0);
+	batch.draw_line(0, 10);
+	batch.draw_line(-10, 0);
+	batch.flush();
+	ASSERT_EQ(4, batch.get_number_messages());
+	EXPECT_EQ(std::vector<std::uint8_t>({ 0xB8, 0x64, 0x00, 0x02, 0x03, 0xFF, 0xFF, 0xFF }), get_test_message(batch, 0));
+	EXPECT_EQ(std::vector<std::uint8_t>({ 0xB8, 0x64, 0x00, 0x04, 0xC8, 0x00, 0xFF, 0xFF }), get_test_message(batch, 1));
+	EXPECT_EQ(std::vector<std::uint8_t>({ 0xB8, 0x64, 0x00, 0x00, 0x0F, 0x00, 0x0F, 0x00 }), get_test_message(batch, 2));
+
+	// Polygon points are relative to where the first line started
+	EXPECT_EQ(std::vector<std::uint8_t>({ 0xB8, 0x64, 0x00, 0x0C, 3, 0x0A, 0x00, 0x00, 0x00, 0x0A, 0x00, 0x0A, 0x00, 0x00, 0x00, 0x0A, 0x00 }), get_test_message(batch, 3));
+
+	// Attributes the VT already has are not sent again
+	batch.set_foreground_colour(3);
+	batch.draw_line(5, 5);
+	batch.flush();
+	ASSERT_EQ(5, batch.get_number_messages());
+	EXPECT_EQ(std::vector<std::uint8_t>({ 0xB8, 0x64, 0x00, 0x09, 0x05, 0x00, 0x05, 0x00 }), get_test_message(batch, 4));
+
+	batch.clear();
+	EXPECT_EQ(0, batch.get_number_messages());
+}
+
+TEST(VT_GRAPHICS_CONTEXT_BATCH_TESTS, OnlyMergesLinesThatDrawTheSame)
+{
+	VirtualTerminalClient::GraphicsContextBatch batch(100);
+
+	// Without a line attributes object a polygon has no border, so each line is sent on its own
+	batch.draw_line(10, 0);
+	batch.draw_line(0, 10);
+	batch.draw_line(-10, 0);
+	batch.flush();
+	ASSERT_EQ(3, batch.get_number_messages());
+	EXPECT_EQ(std::vector<std::uint8_t>({ 0xB8, 0x64, 0x00, 0x09, 0x0A, 0x00, 0x00, 0x00 }), get_test_message(batch, 0));
+	EXPECT_EQ(std::vector<std::uint8_t>({ 0xB8, 0x64, 0x00, 0x09, 0x00, 0x00, 0x0A, 0x00 }), get_test_message(batch, 1));
+	EXPECT_EQ(std::vector<std::uint8_t>({ 0xB8, 0x64, 0x00, 0x09, 0xF6, 0xFF, 0x00, 0x00 }), get_test_message(batch, 2));
+
+	// A run of lines that returns to its start would be a closed, filled polygon,
+	// so the last line is split off and sent as a line of its own
+	batch.clear();
+	batch.set_line_attributes(200);
+	batch.draw_line(10, 0);
+	batch.draw_line(0, 10);
+	batch.draw_line(-10, 0);
+	batch.draw_line(0, -10);
+	batch.flush();
+	ASSERT_EQ(3, batch.get_number_messages());
+	EXPECT_EQ(std::vector<std::uint8_t>({ 0xB8, 0x64, 0x00, 0x04, 0xC8, 0x00, 0xFF, 0xFF }), get_test_message(batch, 0));
+	EXPECT_EQ(std::vector<std::uint8_t>({ 0xB8, 0x64, 0x00, 0x0C, 3, 0x0A, 0x00, 0x00, 0x00, 0x0A, 0x00, 0x0A, 0x00, 0x00, 0x00, 0x0A, 0x00 }), get_test_message(batch, 1));
+	EXPECT_EQ(std::vector<std::uint8_t>({ 0xB8, 0x64, 0x00, 0x09, 0x00, 0x00, 0xF6, 0xFF }), get_test_message(batch, 2));
+
+	// The draw text header is the transparency flag and the text length, and only short text is padded
+	EXPECT_FALSE(batch.draw_text(false, 0, "abc"));
+	EXPECT_TRUE(batch.draw_text(false, 3, "abc"));
+	EXPECT_TRUE(batch.draw_text(true, 1, "d"));
+	batch.flush();
+	ASSERT_EQ(5, batch.get_number_messages());
+	EXPECT_EQ(std::vector<std::uint8_t>({ 0xB8, 0x64, 0x00, 0x0D, 0x00, 0x03, 'a', 'b', 'c' }), get_test_message(batch, 3));
+	EXPECT_EQ(std::vector<std::uint8_t>({ 0xB8, 0x64, 0x00, 0x0D, 0x01, 0x01, 'd', 0xFF }), get_test_message(batch, 4));
+}
+
+TEST(VT_GRAPHICS_CONTEXT_BATCH_TESTS, EncodesAttributeWidths)
+{
+	VirtualTerminalClient::GraphicsContextBatch batch(0x1234);
+
+	// Colours are one byte, attribute objects are two byte object IDs
+	batch.set_foreground_colour(0xE1);
+	batch.set_background_colour(0xE2);
+	batch.set_line_attributes(0x0102);
+	batch.set_fill_attributes(0x0304);
+	batch.set_font_attributes(0x0506);
+	batch.draw_point(-1, 2);
+	ASSERT_EQ(6, batch.get_number_messages());
+	EXPECT_EQ(std::vector<std::uint8_t>({ 0xB8, 0x34, 0x12, 0x02, 0xE1, 0xFF, 0xFF, 0xFF }), get_test_message(batch, 0));
+	EXPECT_EQ(std::vector<std::uint8_t>({ 0xB8, 0x34, 0x12, 0x03, 0xE2, 0xFF, 0xFF, 0xFF }), get_test_message(batch, 1));
+	EXPECT_EQ(std::vector<std::uint8_t>({ 0xB8, 0x34, 0x12, 0x04, 0x02, 0x01, 0xFF, 0xFF }), get_test_message(batch, 2));
+	EXPECT_EQ(std::vector<std::uint8_t>({ 0xB8, 0x34, 0x12, 0x05, 0x04, 0x03, 0xFF, 0xFF }), get_test_message(batch, 3));
+	EXPECT_EQ(std::vector<std::uint8_t>({ 0xB8, 0x34, 0x12, 0x06, 0x06, 0x05, 0xFF, 0xFF }), get_test_message(batch, 4));
+	EXPECT_EQ(std::vector<std::uint8_t>({ 0xB8, 0x34, 0x12, 0x08, 0xFF, 0xFF, 0x02, 0x00 }), get_test_message(batch, 5));
+
+	// Clearing an attribute object sends the null object ID
+	batch.set_fill_attributes(VirtualTerminalClient::NULL_OBJECT_ID);
+	batch.draw_rectangle(20, 30);
+	ASSERT_EQ(8, batch.get_number_messages());
+	EXPECT_EQ(std::vector<std::uint8_t>({ 0xB8, 0x34, 0x12, 0x05, 0xFF, 0xFF, 0xFF, 0xFF }), get_test_message(batch, 6));
+	EXPECT_EQ(std::vector<std::uint8_t>({ 0xB8, 0x34, 0x12, 0x0A, 0x14, 0x00, 0x1E, 0x00 }), get_test_message(batch, 7));
+}
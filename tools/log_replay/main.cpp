@@ -0,0 +1,92 @@
+#include "isobus/hardware_integration/can_log_reader.hpp"
+#include "isobus/hardware_integration/can_log_replay.hpp"
+
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+
+using namespace std;
+
+void print_stage(const char *name, std::uint64_t stageTime_us, std::uint64_t numberOfFrames)
+{
+	cout << left << setw(10) << name << right
+	     << setw(12) << fixed << setprecision(3) << (stageTime_us / 1000.0)
+	     << setw(14) << setprecision(0) << ((0 != stageTime_us) ? ((numberOfFrames * 1000000.0) / stageTime_us) : 0.0)
+	     << setw(12) << setprecision(3) << ((0 != numberOfFrames) ? (static_cast<double>(stageTime_us) / numberOfFrames) : 0.0)
+	     << endl;
+}
+
+const char *get_format_name(CANLogReader::Format format)
+{
+	const char *retVal = "unknown";
+
+	switch (format)
+	{
+		case CANLogReader::Format::Candump:
+		{
+			retVal = "candump";
+		}
+		break;
+
+		case CANLogReader::Format::VectorASC:
+		{
+			retVal = "Vector ASC";
+		}
+		break;
+
+		default:
+			break;
+	}
+	return retVal;
+}
+
+int main(int argc, char **argv)
+{
+	CANLogReplay::Timing timing = CANLogReplay::Timing::AsFastAsPossible;
+	CANLogReplay::Statistics statistics;
+	CANLogReader reader;
+	const char *fileName = nullptr;
+
+	for (int i = 1; i < argc; i++)
+	{
+		if (0 == strcmp(argv[i], "--realtime"))
+		{
+			timing = CANLogReplay::Timing::Recorded;
+		}
+		else
+		{
+			fileName = argv[i];
+		}
+	}
+
+	if (nullptr == fileName)
+	{
+		cout << "Usage: " << argv[0] << " [--realtime] <candump or ASC log>" << endl;
+		cout << "Feeds the frames in the log through the CAN stack and reports how long each stage took." << endl;
+		cout << "Frames are replayed as fast as possible unless --realtime is given." << endl;
+		return 1;
+	}
+
+	if (!reader.open(fileName))
+	{
+		cout << "Could not open " << fileName << endl;
+		return 1;
+	}
+
+	if (!CANLogReplay::replay(reader, timing, statistics))
+	{
+		cout << "No frames were found in " << fileName << endl;
+		return 1;
+	}
+
+	cout << "Replayed " << statistics.numberOfFrames << " frames from a " << get_format_name(reader.get_format()) << " log" << endl;
+	cout << "Skipped " << reader.get_number_skipped_lines() << " lines that weren't frames and " << statistics.numberSkippedFrames << " frames on unsupported channels" << endl;
+	cout << fixed << setprecision(3) << "The log covers " << (statistics.logDuration_us / 1000000.0) << " s and the replay took " << (statistics.elapsedTime_us / 1000000.0) << " s" << endl;
+	cout << endl;
+	cout << "Stage        Time (ms)      Frames/s    us/frame" << endl;
+	print_stage("Read", statistics.readTime_us, statistics.numberOfFrames);
+	print_stage("Receive", statistics.receiveTime_us, statistics.numberOfFrames);
+	print_stage("Update", statistics.updateTime_us, statistics.numberOfFrames);
+	print_stage("Total", statistics.readTime_us + statistics.receiveTime_us + statistics.updateTime_us, statistics.numberOfFrames);
+	return 0;
+}
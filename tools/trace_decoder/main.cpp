@@ -0,0 +1,261 @@
+#include "isobus/isobus/can_stack_trace.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+using namespace std;
+using isobus::CANStackTrace;
+
+struct DecodedRecord
+{
+	std::uint32_t threadIndex;
+	CANStackTrace::Record record;
+};
+
+const char *get_event_name(std::uint8_t eventType)
+{
+	const char *retVal = "Unknown";
+
+	switch (static_cast<CANStackTrace::EventType>(eventType))
+	{
+		case CANStackTrace::EventType::FrameReceived:
+		{
+			retVal = "Rx frame";
+		}
+		break;
+
+		case CANStackTrace::EventType::FrameTransmitted:
+		{
+			retVal = "Tx frame";
+		}
+		break;
+
+		case CANStackTrace::EventType::FrameTransmitFailed:
+		{
+			retVal = "Tx failed";
+		}
+		break;
+
+		case CANStackTrace::EventType::SessionStateChanged:
+		{
+			retVal = "State";
+		}
+		break;
+
+		case CANStackTrace::EventType::AbortSent:
+		{
+			retVal = "Abort sent";
+		}
+		break;
+
+		case CANStackTrace::EventType::AbortReceived:
+		{
+			retVal = "Abort rx";
+		}
+		break;
+
+		case CANStackTrace::EventType::CallbackDispatched:
+		{
+			retVal = "Callback";
+		}
+		break;
+
+		default:
+			break;
+	}
+	return retVal;
+}
+
+const char *get_component_name(std::uint8_t component)
+{
+	const char *retVal = "Unknown";
+
+	switch (static_cast<CANStackTrace::Component>(component))
+	{
+		case CANStackTrace::Component::NetworkManager:
+		{
+			retVal = "Network";
+		}
+		break;
+
+		case CANStackTrace::Component::TransportProtocol:
+		{
+			retVal = "TP";
+		}
+		break;
+
+		case CANStackTrace::Component::ExtendedTransportProtocol:
+		{
+			retVal = "ETP";
+		}
+		break;
+
+		default:
+			break;
+	}
+	return retVal;
+}
+
+const char *get_callback_type_name(std::uint8_t callbackType)
+{
+	const char *retVal = "Unknown";
+
+	switch (static_cast<CANStackTrace::CallbackType>(callbackType))
+	{
+		case CANStackTrace::CallbackType::Protocol:
+		{
+			retVal = "protocol";
+		}
+		break;
+
+		case CANStackTrace::CallbackType::Global:
+		{
+			retVal = "global";
+		}
+		break;
+
+		case CANStackTrace::CallbackType::Partnered:
+		{
+			retVal = "partnered";
+		}
+		break;
+
+		default:
+			break;
+	}
+	return retVal;
+}
+
+void print_details(const CANStackTrace::Record &record)
+{
+	switch (static_cast<CANStackTrace::EventType>(record.eventType))
+	{
+		case CANStackTrace::EventType::FrameReceived:
+		case CANStackTrace::EventType::FrameTransmitted:
+		case CANStackTrace::EventType::FrameTransmitFailed:
+		{
+			cout << "ID " << hex << setfill('0') << setw(8) << record.identifier << " [" << dec << static_cast<int>(record.detail) << "]";
+			for (std::uint8_t i = 0; (i < record.detail) && (i < 8); i++)
+			{
+				const std::uint32_t argument = (i < 4) ? record.argument0 : record.argument1;
+				cout << ' ' << hex << setw(2) << ((argument >> (8 * (i % 4))) & 0xFF);
+			}
+			cout << dec << setfill(' ');
+		}
+		break;
+
+		case CANStackTrace::EventType::SessionStateChanged:
+		{
+			cout << "PGN " << hex << record.identifier << dec << " state " << static_cast<int>(record.detail) << ", " << record.argument0 << " bytes, " << record.argument1 << " packets done";
+		}
+		break;
+
+		case CANStackTrace::EventType::AbortSent:
+		{
+			cout << "PGN " << hex << record.identifier << dec << " reason " << static_cast<int>(record.detail) << ((0 != record.argument0) ? "" : " (not sent)");
+		}
+		break;
+
+		case CANStackTrace::EventType::AbortReceived:
+		{
+			cout << "PGN " << hex << record.identifier << dec << " reason " << static_cast<int>(record.detail);
+		}
+		break;
+
+		case CANStackTrace::EventType::CallbackDispatched:
+		{
+			cout << "PGN " << hex << record.identifier << dec << " " << get_callback_type_name(record.detail) << " took " << record.argument0 << " us, " << record.argument1 << " bytes";
+		}
+		break;
+
+		default:
+		{
+			cout << hex << record.identifier << ' ' << record.argument0 << ' ' << record.argument1 << ' ' << static_cast<int>(record.detail) << dec;
+		}
+		break;
+	}
+}
+
+int main(int argc, char **argv)
+{
+	int retVal = 0;
+	std::ifstream traceFile;
+	CANStackTrace::FileHeader fileHeader;
+	std::vector<DecodedRecord> records;
+
+	if (2 != argc)
+	{
+		cout << "Usage: " << argv[0] << " <trace file>" << endl;
+		return 1;
+	}
+
+	traceFile.open(argv[1], ios::in | ios::binary);
+	if (!traceFile.is_open())
+	{
+		cout << "Could not open " << argv[1] << endl;
+		return 1;
+	}
+
+	if ((!traceFile.read(reinterpret_cast<char *>(&fileHeader), sizeof(fileHeader))) ||
+	    (0 != memcmp(fileHeader.magic, CANStackTrace::FILE_MAGIC, sizeof(fileHeader.magic))))
+	{
+		cout << argv[1] << " is not a CAN stack trace file" << endl;
+		return 1;
+	}
+
+	if ((CANStackTrace::FILE_VERSION != fileHeader.version) ||
+	    (sizeof(CANStackTrace::Record) != fileHeader.recordSize) ||
+	    (CANStackTrace::BYTE_ORDER_MARK != fileHeader.byteOrderMark))
+	{
+		cout << "The trace was written with format version " << fileHeader.version << " or on a machine with a different byte order, which this decoder doesn't support" << endl;
+		return 1;
+	}
+
+	CANStackTrace::BlockHeader blockHeader;
+	while (traceFile.read(reinterpret_cast<char *>(&blockHeader), sizeof(blockHeader)))
+	{
+		if (0 != blockHeader.numberOfLostRecords)
+		{
+			cout << "Thread " << blockHeader.threadIndex << " lost " << blockHeader.numberOfLostRecords << " older records" << endl;
+		}
+
+		for (std::uint32_t i = 0; i < blockHeader.numberOfRecords; i++)
+		{
+			DecodedRecord decodedRecord;
+
+			decodedRecord.threadIndex = blockHeader.threadIndex;
+			if (traceFile.read(reinterpret_cast<char *>(&decodedRecord.record), sizeof(decodedRecord.record)))
+			{
+				records.push_back(decodedRecord);
+			}
+			else
+			{
+				cout << "The trace file is truncated" << endl;
+				retVal = 1;
+				break;
+			}
+		}
+	}
+
+	std::stable_sort(records.begin(), records.end(), [](const DecodedRecord &first, const DecodedRecord &second) { return first.record.timestamp_us < second.record.timestamp_us; });
+
+	cout << "Time (s)      Thread Ch Component Event       Details" << endl;
+	for (auto &decodedRecord : records)
+	{
+		const CANStackTrace::Record &record = decodedRecord.record;
+
+		cout << setw(6) << (record.timestamp_us / 1000000) << '.' << setfill('0') << setw(6) << (record.timestamp_us % 1000000) << setfill(' ')
+		     << ' ' << setw(6) << decodedRecord.threadIndex
+		     << ' ' << setw(2) << static_cast<int>(record.channel)
+		     << ' ' << left << setw(9) << get_component_name(record.component)
+		     << ' ' << setw(11) << get_event_name(record.eventType) << right << ' ';
+		print_details(record);
+		cout << endl;
+	}
+	cout << records.size() << " records" << endl;
+	return retVal;
+}
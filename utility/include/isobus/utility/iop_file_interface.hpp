@@ -31,6 +31,58 @@ namespace isobus
 		/// @returns A vector with an object pool in it, or an empty vector if reading failed
 		static std::vector<std::uint8_t> read_iop_file(const std::string &filename);
 	};
+
+	//================================================================================================
+	/// @class MappedIOPFile
+	///
+	/// @brief A read-only view of an IOP file that is mapped into memory instead of copied
+	/// @details Opening a file only maps it, so even very large pools are available right away, and the
+	/// operating system pages the data in as it gets uploaded. The data can be passed directly to
+	/// VirtualTerminalClient::set_object_pool, which uploads from it without making a copy.
+	/// The object must outlive any use of its data, including the upload of the pool.
+	/// On platforms without mmap, the file is read into memory in one block instead.
+	//================================================================================================
+	class MappedIOPFile
+	{
+	public:
+		/// @brief Constructor for a MappedIOPFile that has no file open
+		MappedIOPFile();
+
+		/// @brief Destructor for a MappedIOPFile, which unmaps the file
+		~MappedIOPFile();
+
+		/// @brief Deleted copy constructor, as the mapping can only have one owner
+		MappedIOPFile(const MappedIOPFile &) = delete;
+
+		/// @brief Deleted assignment operator, as the mapping can only have one owner
+		MappedIOPFile &operator=(const MappedIOPFile &) = delete;
+
+		/// @brief Maps an IOP file given a file name/path. Closes any file that was already open.
+		/// @param[in] filename A string filepath for the IOP file to map
+		/// @returns true if the file was mapped and is not empty, otherwise false
+		bool open(const std::string &filename);
+
+		/// @brief Unmaps the file, if one is open
+		void close();
+
+		/// @brief Returns if a file is currently mapped
+		/// @returns true if a file is mapped
+		bool get_is_open() const;
+
+		/// @brief Returns a pointer to the object pool in the file
+		/// @returns A pointer to the file's data, or nullptr if no file is open
+		const std::uint8_t *get_data() const;
+
+		/// @brief Returns the size of the object pool in the file
+		/// @returns The size of the file's data in bytes, or 0 if no file is open
+		std::uint32_t get_size() const;
+
+	private:
+		std::vector<std::uint8_t> fallbackData; ///< Stores the file on platforms where it can't be mapped
+		const std::uint8_t *data; ///< The start of the mapped file
+		std::uint32_t size; ///< The size of the mapped file in bytes
+		bool mapped; ///< Tells if data points to a memory mapping rather than to fallbackData
+	};
 }
 
 #endif // IOP_FILE_INTERFACE_HPP
@@ -0,0 +1,80 @@
+//================================================================================================
+/// @file object_pool_image.hpp
+///
+/// @brief An immutable object pool that can be shared by several VT clients
+/// @author Adrian Del Grosso
+///
+/// @copyright 2022 Adrian Del Grosso
+//================================================================================================
+
+#ifndef OBJECT_POOL_IMAGE_HPP
+#define OBJECT_POOL_IMAGE_HPP
+
+#include "isobus/utility/iop_file_interface.hpp"
+#include "isobus/utility/object_pool_index.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace isobus
+{
+	//================================================================================================
+	/// @class ObjectPoolImage
+	///
+	/// @brief An object pool that is loaded and indexed once, then shared read-only
+	/// @details An image is created with one of the factory functions and is only ever handed out
+	/// as a shared pointer to a const image, so it can't change after it is created. Any number of VT
+	/// clients can be assigned the same image, each talking to its own VT from its own thread, without
+	/// copying the pool or parsing it again. The image is freed when the last client and the
+	/// application release it. Images created from an IOP file map the file instead of reading it.
+	//================================================================================================
+	class ObjectPoolImage
+	{
+	public:
+		/// @brief Creates an image by mapping an IOP file
+		/// @param[in] filename A string filepath for the IOP file to map
+		/// @returns The new image, or nullptr if the file could not be opened or is empty
+		static std::shared_ptr<const ObjectPoolImage> create_from_iop_file(const std::string &filename);
+
+		/// @brief Creates an image that takes ownership of a pool already in memory
+		/// @param[in] pool The object pool, which is moved into the image
+		/// @returns The new image, or nullptr if the pool is empty
+		static std::shared_ptr<const ObjectPoolImage> create_from_data(std::vector<std::uint8_t> &&pool);
+
+		/// @brief Deleted copy constructor, as images are only shared through pointers
+		ObjectPoolImage(const ObjectPoolImage &) = delete;
+
+		/// @brief Deleted assignment operator, as images can't change
+		ObjectPoolImage &operator=(const ObjectPoolImage &) = delete;
+
+		/// @brief Returns a pointer to the object pool
+		/// @returns A pointer to the pool's data, valid for as long as the image exists
+		const std::uint8_t *get_data() const;
+
+		/// @brief Returns the size of the object pool
+		/// @returns The size of the pool in bytes
+		std::uint32_t get_size() const;
+
+		/// @brief Returns the index of the objects in the pool, which was built when the image was created
+		/// @returns The pool's index
+		const ObjectPoolIndex &get_index() const;
+
+		/// @brief Returns if the pool was parsed without errors
+		/// @returns true if the pool is valid
+		bool get_is_valid() const;
+
+	private:
+		/// @brief Constructor for an empty ObjectPoolImage, only used by the factory functions
+		ObjectPoolImage();
+
+		MappedIOPFile mappedFile; ///< The mapped IOP file, if the image was created from one
+		std::vector<std::uint8_t> ownedData; ///< The pool, if the image was created from data in memory
+		const std::uint8_t *data; ///< The start of the pool, in either mappedFile or ownedData
+		std::uint32_t size; ///< The size of the pool in bytes
+		ObjectPoolIndex index; ///< Where each object in the pool is
+	};
+} // namespace isobus
+
+#endif // OBJECT_POOL_IMAGE_HPP
@@ -0,0 +1,162 @@
+//================================================================================================
+/// @file object_pool_index.hpp
+///
+/// @brief A class that parses ISO 11783-6 object pools and indexes the objects in them
+/// @author Adrian Del Grosso
+///
+/// @copyright 2022 Adrian Del Grosso
+//================================================================================================
+
+#ifndef OBJECT_POOL_INDEX_HPP
+#define OBJECT_POOL_INDEX_HPP
+
+#include <cstdint>
+#include <unordered_map>
+
+namespace isobus
+{
+	//================================================================================================
+	/// @class ObjectPoolIndex
+	///
+	/// @brief Parses an object pool and builds an index of the objects in it
+	/// @details Object pools, such as the contents of an IOP file, are a packed list of objects
+	/// where the length of each object depends on its type and on the lists and strings inside it.
+	/// This class walks a pool once from start to end, validating that every object is
+	/// complete, has a known type, and has a unique ID, and records where each object is so that
+	/// it can be looked up by its object ID without parsing the pool again.
+	/// The index only stores offsets, so the pool's data is not needed after parsing.
+	//================================================================================================
+	class ObjectPoolIndex
+	{
+	public:
+		/// @brief The outcome of parsing an object pool
+		enum class ParseResult : std::uint8_t
+		{
+			Success, ///< The pool was parsed and every object in it was indexed
+			EmptyPool, ///< No data was supplied
+			TruncatedObject, ///< An object's encoding runs past the end of the pool
+			UnknownObjectType, ///< An object has a type that is not defined by ISO 11783-6
+			InvalidObjectID, ///< An object has the NULL object ID, 0xFFFF
+			DuplicateObjectID ///< More than one object in the pool has the same object ID
+		};
+
+		/// @brief The object types defined by ISO 11783-6
+		enum class ObjectType : std::uint8_t
+		{
+			WorkingSet = 0,
+			DataMask = 1,
+			AlarmMask = 2,
+			Container = 3,
+			SoftKeyMask = 4,
+			Key = 5,
+			Button = 6,
+			InputBoolean = 7,
+			InputString = 8,
+			InputNumber = 9,
+			InputList = 10,
+			OutputString = 11,
+			OutputNumber = 12,
+			OutputLine = 13,
+			OutputRectangle = 14,
+			OutputEllipse = 15,
+			OutputPolygon = 16,
+			OutputMeter = 17,
+			OutputLinearBarGraph = 18,
+			OutputArchedBarGraph = 19,
+			PictureGraphic = 20,
+			NumberVariable = 21,
+			StringVariable = 22,
+			FontAttributes = 23,
+			LineAttributes = 24,
+			FillAttributes = 25,
+			InputAttributes = 26,
+			ObjectPointer = 27,
+			Macro = 28,
+			AuxiliaryFunctionType1 = 29,
+			AuxiliaryInputType1 = 30,
+			AuxiliaryFunctionType2 = 31,
+			AuxiliaryInputType2 = 32,
+			AuxiliaryControlDesignatorObjectPointer = 33,
+			WindowMask = 34,
+			KeyGroup = 35,
+			GraphicsContext = 36,
+			OutputList = 37,
+			ExtendedInputAttributes = 38,
+			ColourMap = 39,
+			ObjectLabelReferenceList = 40,
+			ExternalObjectDefinition = 41,
+			ExternalReferenceNAME = 42,
+			ExternalObjectPointer = 43,
+			Animation = 44,
+			ColourPalette = 45,
+			GraphicData = 46,
+			WorkingSetSpecialControls = 47,
+			ScaledGraphic = 48
+		};
+
+		/// @brief Describes where an object is in the pool
+		struct ObjectInfo
+		{
+			std::uint32_t offset; ///< The offset of the object's first byte (its ID) from the start of the pool
+			std::uint32_t length; ///< The number of bytes the object's encoding takes up
+			ObjectType type; ///< The type of the object
+		};
+
+		static constexpr std::uint16_t NULL_OBJECT_ID = 0xFFFF; ///< The reserved object ID that means "no object"
+
+		/// @brief Constructor for an empty ObjectPoolIndex
+		ObjectPoolIndex();
+
+		/// @brief Parses an object pool, replacing anything that was indexed before
+		/// @details If the pool is invalid, the index is left empty and the offset of the object
+		/// that could not be parsed is available from get_error_offset.
+		/// @param[in] pool A pointer to the object pool's data
+		/// @param[in] size The size of the object pool in bytes
+		/// @returns ParseResult::Success if the whole pool is valid, otherwise the reason it is not
+		ParseResult parse(const std::uint8_t *pool, std::uint32_t size);
+
+		/// @brief Removes all objects from the index
+		void clear();
+
+		/// @brief Returns the result of the last call to parse
+		/// @returns The result of the last parse, or ParseResult::EmptyPool if nothing has been parsed
+		ParseResult get_parse_result() const;
+
+		/// @brief Returns if the last parsed pool was valid
+		/// @returns true if the last parsed pool was valid and is indexed
+		bool get_is_valid() const;
+
+		/// @brief Returns the offset in the pool where parsing failed
+		/// @returns The offset of the object that made the last parse fail, or 0 if it succeeded
+		std::uint32_t get_error_offset() const;
+
+		/// @brief Returns the number of objects in the index
+		/// @returns The number of indexed objects
+		std::uint32_t get_number_objects() const;
+
+		/// @brief Looks up an object by its object ID
+		/// @param[in] objectID The object ID to look up
+		/// @param[out] info Where the object is in the pool, if it was found
+		/// @returns true if the object is in the index, otherwise false
+		bool get_object_info(std::uint16_t objectID, ObjectInfo &info) const;
+
+		/// @brief Returns if an object ID is in the index
+		/// @param[in] objectID The object ID to look up
+		/// @returns true if the object is in the index, otherwise false
+		bool get_has_object(std::uint16_t objectID) const;
+
+		/// @brief Returns the length of a single encoded object
+		/// @param[in] object A pointer to the first byte of the object
+		/// @param[in] bytesAvailable The number of bytes from the start of the object to the end of the pool
+		/// @param[out] objectLength The number of bytes the object takes up, if it is valid
+		/// @returns ParseResult::Success if the object is complete, otherwise the reason it is not
+		static ParseResult get_object_length(const std::uint8_t *object, std::uint32_t bytesAvailable, std::uint32_t &objectLength);
+
+	private:
+		std::unordered_map<std::uint16_t, ObjectInfo> objects; ///< Maps object IDs to where those objects are in the pool
+		std::uint32_t errorOffset; ///< The offset of the object that made the last parse fail
+		ParseResult parseResult; ///< The result of the last parse
+	};
+} // namespace isobus
+
+#endif // OBJECT_POOL_INDEX_HPP
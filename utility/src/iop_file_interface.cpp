@@ -9,7 +9,15 @@
 #include "isobus/utility/iop_file_interface.hpp"
 
 #include <fstream>
-#include <iterator>
+#include <limits>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define IOP_FILE_INTERFACE_USE_MMAP
+#endif
 
 namespace isobus
 {
@@ -22,18 +30,104 @@ namespace isobus
 
 		if (file.is_open())
 		{
-			// Ignore newlines
-			file.unsetf(std::ios::skipws);
-
 			file.seekg(0, std::ios::end);
 			fileSize = file.tellg();
 			file.seekg(0, std::ios::beg);
 
-			retVal.reserve(fileSize);
+			if (fileSize > 0)
+			{
+				// Read in the data in one go
+				retVal.resize(static_cast<std::size_t>(fileSize));
 
-			// Read in the data
-			retVal.insert(retVal.begin(), std::istream_iterator<std::uint8_t>(file), std::istream_iterator<std::uint8_t>());
+				if (!file.read(reinterpret_cast<char *>(retVal.data()), fileSize))
+				{
+					retVal.clear();
+				}
+			}
 		}
 		return retVal;
 	}
+
+	MappedIOPFile::MappedIOPFile() :
+	  data(nullptr),
+	  size(0),
+	  mapped(false)
+	{
+	}
+
+	MappedIOPFile::~MappedIOPFile()
+	{
+		close();
+	}
+
+	bool MappedIOPFile::open(const std::string &filename)
+	{
+		close();
+
+#ifdef IOP_FILE_INTERFACE_USE_MMAP
+		int fileDescriptor = ::open(filename.c_str(), O_RDONLY);
+
+		if (fileDescriptor >= 0)
+		{
+			struct stat fileStatus;
+
+			if ((0 == fstat(fileDescriptor, &fileStatus)) &&
+			    (fileStatus.st_size > 0) &&
+			    (static_cast<std::uint64_t>(fileStatus.st_size) <= std::numeric_limits<std::uint32_t>::max()))
+			{
+				void *mapping = mmap(nullptr, static_cast<std::size_t>(fileStatus.st_size), PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+
+				if (MAP_FAILED != mapping)
+				{
+					// Pools are uploaded front to back, so let the OS read ahead
+					madvise(mapping, static_cast<std::size_t>(fileStatus.st_size), MADV_SEQUENTIAL);
+					data = static_cast<const std::uint8_t *>(mapping);
+					size = static_cast<std::uint32_t>(fileStatus.st_size);
+					mapped = true;
+				}
+			}
+			// The mapping stays valid after the file is closed
+			::close(fileDescriptor);
+		}
+#else
+		fallbackData = IOPFileInterface::read_iop_file(filename);
+
+		if (!fallbackData.empty())
+		{
+			data = fallbackData.data();
+			size = static_cast<std::uint32_t>(fallbackData.size());
+		}
+#endif
+		return get_is_open();
+	}
+
+	void MappedIOPFile::close()
+	{
+#ifdef IOP_FILE_INTERFACE_USE_MMAP
+		if (mapped)
+		{
+			munmap(const_cast<std::uint8_t *>(data), size);
+		}
+#endif
+		fallbackData.clear();
+		fallbackData.shrink_to_fit();
+		data = nullptr;
+		size = 0;
+		mapped = false;
+	}
+
+	bool MappedIOPFile::get_is_open() const
+	{
+		return (nullptr != data);
+	}
+
+	const std::uint8_t *MappedIOPFile::get_data() const
+	{
+		return data;
+	}
+
+	std::uint32_t MappedIOPFile::get_size() const
+	{
+		return size;
+	}
 }
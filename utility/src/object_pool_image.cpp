@@ -0,0 +1,73 @@
+//================================================================================================
+/// @file object_pool_image.cpp
+///
+/// @brief Implementation of an immutable object pool that can be shared by several VT clients
+/// @author Adrian Del Grosso
+///
+/// @copyright 2022 Adrian Del Grosso
+//================================================================================================
+#include "isobus/utility/object_pool_image.hpp"
+
+#include <utility>
+
+namespace isobus
+{
+	std::shared_ptr<const ObjectPoolImage> ObjectPoolImage::create_from_iop_file(const std::string &filename)
+	{
+		// The constructor is private, so make_shared can't be used
+		std::shared_ptr<ObjectPoolImage> retVal(new ObjectPoolImage());
+
+		if (retVal->mappedFile.open(filename))
+		{
+			retVal->data = retVal->mappedFile.get_data();
+			retVal->size = retVal->mappedFile.get_size();
+			retVal->index.parse(retVal->data, retVal->size);
+		}
+		else
+		{
+			retVal.reset();
+		}
+		return retVal;
+	}
+
+	std::shared_ptr<const ObjectPoolImage> ObjectPoolImage::create_from_data(std::vector<std::uint8_t> &&pool)
+	{
+		std::shared_ptr<ObjectPoolImage> retVal;
+
+		if (!pool.empty())
+		{
+			retVal.reset(new ObjectPoolImage());
+			retVal->ownedData = std::move(pool);
+			retVal->data = retVal->ownedData.data();
+			retVal->size = static_cast<std::uint32_t>(retVal->ownedData.size());
+			retVal->index.parse(retVal->data, retVal->size);
+		}
+		return retVal;
+	}
+
+	ObjectPoolImage::ObjectPoolImage() :
+	  data(nullptr),
+	  size(0)
+	{
+	}
+
+	const std::uint8_t *ObjectPoolImage::get_data() const
+	{
+		return data;
+	}
+
+	std::uint32_t ObjectPoolImage::get_size() const
+	{
+		return size;
+	}
+
+	const ObjectPoolIndex &ObjectPoolImage::get_index() const
+	{
+		return index;
+	}
+
+	bool ObjectPoolImage::get_is_valid() const
+	{
+		return index.get_is_valid();
+	}
+} // namespace isobus
@@ -0,0 +1,555 @@
+//================================================================================================
+/// @file object_pool_index.cpp
+///
+/// @brief Implementation of a class that parses ISO 11783-6 object pools and indexes the objects in them
+/// @author Adrian Del Grosso
+///
+/// @copyright 2022 Adrian Del Grosso
+//================================================================================================
+#include "isobus/utility/object_pool_index.hpp"
+
+namespace isobus
+{
+	namespace
+	{
+		constexpr std::uint8_t OBJECT_HEADER_LENGTH = 3; ///< Object ID (2 bytes) and object type (1 byte)
+		constexpr std::uint32_t CHILD_OBJECT_LENGTH = 6; ///< Object ID, X location, and Y location of a child object
+		constexpr std::uint32_t OBJECT_REFERENCE_LENGTH = 2; ///< An object ID with no location
+		constexpr std::uint32_t MACRO_REFERENCE_LENGTH = 2; ///< Event ID and macro ID
+		constexpr std::uint32_t POLYGON_POINT_LENGTH = 4; ///< X and Y value of a polygon point
+		constexpr std::uint32_t CHARACTER_RANGE_LENGTH = 4; ///< First and last character of an extended input attributes range
+		constexpr std::uint32_t OBJECT_LABEL_REFERENCE_LENGTH = 7; ///< Object ID, string variable, font type, and graphic of a label
+		constexpr std::uint32_t PALETTE_COLOUR_LENGTH = 4; ///< Blue, green, red, and alpha of a colour palette entry
+		constexpr std::uint32_t LANGUAGE_PAIR_LENGTH = 4; ///< Language code and country code of a language pair
+
+		/// @brief Walks through the fields of one object, tracking if they fit in the pool
+		class ObjectReader
+		{
+		public:
+			/// @brief Constructor for an ObjectReader
+			/// @param[in] objectData A pointer to the first byte of the object
+			/// @param[in] bytesAvailable The number of bytes from the start of the object to the end of the pool
+			ObjectReader(const std::uint8_t *objectData, std::uint32_t bytesAvailable) :
+			  data(objectData),
+			  available(bytesAvailable),
+			  position(0),
+			  valid(true)
+			{
+			}
+
+			/// @brief Moves past a number of bytes that don't need to be decoded
+			/// @param[in] numberOfBytes The number of bytes to move past
+			void skip(std::uint64_t numberOfBytes)
+			{
+				if ((valid) && (numberOfBytes <= (available - position)))
+				{
+					position += static_cast<std::uint32_t>(numberOfBytes);
+				}
+				else
+				{
+					valid = false;
+				}
+			}
+
+			/// @brief Reads a little endian count, such as a number of child objects or a string length
+			/// @param[in] numberOfBytes The width of the count in bytes, from 1 to 4
+			/// @returns The value of the count, or 0 if it doesn't fit in the pool
+			std::uint32_t read(std::uint8_t numberOfBytes)
+			{
+				std::uint32_t retVal = 0;
+
+				if ((valid) && (numberOfBytes <= (available - position)))
+				{
+					for (std::uint8_t i = 0; i < numberOfBytes; i++)
+					{
+						retVal |= (static_cast<std::uint32_t>(data[position + i]) << (8 * i));
+					}
+					position += numberOfBytes;
+				}
+				else
+				{
+					valid = false;
+				}
+				return retVal;
+			}
+
+			/// @brief Returns if every field so far fit in the pool
+			/// @returns true if the object has not run past the end of the pool
+			bool get_is_valid() const
+			{
+				return valid;
+			}
+
+			/// @brief Returns the number of bytes read or skipped so far
+			/// @returns The offset of the next field from the start of the object
+			std::uint32_t get_position() const
+			{
+				return position;
+			}
+
+		private:
+			const std::uint8_t *data; ///< The first byte of the object
+			const std::uint32_t available; ///< Bytes from the start of the object to the end of the pool
+			std::uint32_t position; ///< The offset of the next field from the start of the object
+			bool valid; ///< Tells if every field so far fit in the pool
+		};
+
+		/// @brief Moves past a number of attribute bytes followed by a number of macros and the macro list
+		/// @param[in] reader The reader for the object, positioned after the object's header
+		/// @param[in] attributesLength The number of attribute bytes before the number of macros
+		void skip_attributes_and_macros(ObjectReader &reader, std::uint32_t attributesLength)
+		{
+			reader.skip(attributesLength);
+			std::uint32_t numberOfMacros = reader.read(1);
+			reader.skip(static_cast<std::uint64_t>(numberOfMacros) * MACRO_REFERENCE_LENGTH);
+		}
+
+		/// @brief Moves past a number of attribute bytes followed by a list of objects and a list of macros
+		/// @details The number of objects and number of macros are the last two attributes, and the
+		/// object list comes before the macro list.
+		/// @param[in] reader The reader for the object, positioned after the object's header
+		/// @param[in] attributesLength The number of attribute bytes before the number of objects
+		/// @param[in] objectLength The length of each entry in the object list
+		void skip_objects_and_macros(ObjectReader &reader, std::uint32_t attributesLength, std::uint32_t objectLength)
+		{
+			reader.skip(attributesLength);
+			std::uint32_t numberOfObjects = reader.read(1);
+			std::uint32_t numberOfMacros = reader.read(1);
+			reader.skip((static_cast<std::uint64_t>(numberOfObjects) * objectLength) + (static_cast<std::uint64_t>(numberOfMacros) * MACRO_REFERENCE_LENGTH));
+		}
+	}
+
+	ObjectPoolIndex::ObjectPoolIndex() :
+	  errorOffset(0),
+	  parseResult(ParseResult::EmptyPool)
+	{
+	}
+
+	ObjectPoolIndex::ParseResult ObjectPoolIndex::parse(const std::uint8_t *pool, std::uint32_t size)
+	{
+		std::uint32_t offset = 0;
+
+		objects.clear();
+		errorOffset = 0;
+
+		if ((nullptr == pool) || (0 == size))
+		{
+			parseResult = ParseResult::EmptyPool;
+		}
+		else
+		{
+			parseResult = ParseResult::Success;
+
+			while ((ParseResult::Success == parseResult) && (offset < size))
+			{
+				std::uint32_t objectLength = 0;
+
+				parseResult = get_object_length(&pool[offset], size - offset, objectLength);
+
+				if (ParseResult::Success == parseResult)
+				{
+					std::uint16_t objectID = static_cast<std::uint16_t>(pool[offset] | (static_cast<std::uint16_t>(pool[offset + 1]) << 8));
+					ObjectInfo info = { offset, objectLength, static_cast<ObjectType>(pool[offset + 2]) };
+
+					if (NULL_OBJECT_ID == objectID)
+					{
+						parseResult = ParseResult::InvalidObjectID;
+					}
+					else if (!objects.insert({ objectID, info }).second)
+					{
+						parseResult = ParseResult::DuplicateObjectID;
+					}
+					else
+					{
+						offset += objectLength;
+					}
+				}
+			}
+
+			if (ParseResult::Success != parseResult)
+			{
+				errorOffset = offset;
+				objects.clear();
+			}
+		}
+		return parseResult;
+	}
+
+	void ObjectPoolIndex::clear()
+	{
+		objects.clear();
+		errorOffset = 0;
+		parseResult = ParseResult::EmptyPool;
+	}
+
+	ObjectPoolIndex::ParseResult ObjectPoolIndex::get_parse_result() const
+	{
+		return parseResult;
+	}
+
+	bool ObjectPoolIndex::get_is_valid() const
+	{
+		return (ParseResult::Success == parseResult);
+	}
+
+	std::uint32_t ObjectPoolIndex::get_error_offset() const
+	{
+		return errorOffset;
+	}
+
+	std::uint32_t ObjectPoolIndex::get_number_objects() const
+	{
+		return static_cast<std::uint32_t>(objects.size());
+	}
+
+	bool ObjectPoolIndex::get_object_info(std::uint16_t objectID, ObjectInfo &info) const
+	{
+		bool retVal = false;
+		auto result = objects.find(objectID);
+
+		if (objects.end() != result)
+		{
+			info = result->second;
+			retVal = true;
+		}
+		return retVal;
+	}
+
+	bool ObjectPoolIndex::get_has_object(std::uint16_t objectID) const
+	{
+		return (objects.end() != objects.find(objectID));
+	}
+
+	ObjectPoolIndex::ParseResult ObjectPoolIndex::get_object_length(const std::uint8_t *object, std::uint32_t bytesAvailable, std::uint32_t &objectLength)
+	{
+		ParseResult retVal = ParseResult::Success;
+		ObjectReader reader(object, bytesAvailable);
+		std::uint64_t listLength = 0;
+
+		reader.skip(OBJECT_HEADER_LENGTH);
+
+		if (!reader.get_is_valid())
+		{
+			retVal = ParseResult::TruncatedObject;
+		}
+		else
+		{
+			// Each case moves past the attributes that follow the object ID and type, reading the
+			// counts of any lists or strings, then moves past those lists in the order they're encoded.
+			switch (static_cast<ObjectType>(object[2]))
+			{
+				case ObjectType::WorkingSet:
+				{
+					reader.skip(4);
+					std::uint32_t numberOfObjects = reader.read(1);
+					std::uint32_t numberOfMacros = reader.read(1);
+					std::uint32_t numberOfLanguages = reader.read(1);
+					listLength = (static_cast<std::uint64_t>(numberOfObjects) * CHILD_OBJECT_LENGTH) + (numberOfMacros * MACRO_REFERENCE_LENGTH) + (numberOfLanguages * 2);
+					reader.skip(listLength);
+				}
+				break;
+
+				case ObjectType::DataMask:
+				{
+					skip_objects_and_macros(reader, 3, CHILD_OBJECT_LENGTH);
+				}
+				break;
+
+				case ObjectType::AlarmMask:
+				case ObjectType::Container:
+				{
+					skip_objects_and_macros(reader, 5, CHILD_OBJECT_LENGTH);
+				}
+				break;
+
+				case ObjectType::SoftKeyMask:
+				{
+					skip_objects_and_macros(reader, 1, OBJECT_REFERENCE_LENGTH);
+				}
+				break;
+
+				case ObjectType::Key:
+				{
+					skip_objects_and_macros(reader, 2, CHILD_OBJECT_LENGTH);
+				}
+				break;
+
+				case ObjectType::Button:
+				{
+					skip_objects_and_macros(reader, 8, CHILD_OBJECT_LENGTH);
+				}
+				break;
+
+				case ObjectType::InputBoolean:
+				case ObjectType::FontAttributes:
+				case ObjectType::LineAttributes:
+				case ObjectType::FillAttributes:
+				{
+					skip_attributes_and_macros(reader, (ObjectType::InputBoolean == static_cast<ObjectType>(object[2])) ? 9 : 4);
+				}
+				break;
+
+				case ObjectType::InputString:
+				{
+					reader.skip(13);
+					std::uint32_t stringLength = reader.read(1);
+					reader.skip(stringLength);
+					skip_attributes_and_macros(reader, 1);
+				}
+				break;
+
+				case ObjectType::InputNumber:
+				{
+					skip_attributes_and_macros(reader, 34);
+				}
+				break;
+
+				case ObjectType::InputList:
+				{
+					reader.skip(7);
+					std::uint32_t numberOfItems = reader.read(1);
+					reader.skip(1);
+					std::uint32_t numberOfMacros = reader.read(1);
+					listLength = (static_cast<std::uint64_t>(numberOfItems) * OBJECT_REFERENCE_LENGTH) + (numberOfMacros * MACRO_REFERENCE_LENGTH);
+					reader.skip(listLength);
+				}
+				break;
+
+				case ObjectType::OutputString:
+				{
+					reader.skip(11);
+					std::uint32_t stringLength = reader.read(2);
+					reader.skip(stringLength);
+					skip_attributes_and_macros(reader, 0);
+				}
+				break;
+
+				case ObjectType::OutputNumber:
+				{
+					skip_attributes_and_macros(reader, 25);
+				}
+				break;
+
+				case ObjectType::OutputLine:
+				{
+					skip_attributes_and_macros(reader, 7);
+				}
+				break;
+
+				case ObjectType::OutputRectangle:
+				{
+					skip_attributes_and_macros(reader, 9);
+				}
+				break;
+
+				case ObjectType::OutputEllipse:
+				{
+					skip_attributes_and_macros(reader, 11);
+				}
+				break;
+
+				case ObjectType::OutputPolygon:
+				{
+					skip_objects_and_macros(reader, 9, POLYGON_POINT_LENGTH);
+				}
+				break;
+
+				case ObjectType::OutputMeter:
+				{
+					skip_attributes_and_macros(reader, 17);
+				}
+				break;
+
+				case ObjectType::OutputLinearBarGraph:
+				{
+					skip_attributes_and_macros(reader, 20);
+				}
+				break;
+
+				case ObjectType::OutputArchedBarGraph:
+				{
+					skip_attributes_and_macros(reader, 23);
+				}
+				break;
+
+				case ObjectType::PictureGraphic:
+				{
+					reader.skip(9);
+					std::uint32_t numberOfRawBytes = reader.read(4);
+					std::uint32_t numberOfMacros = reader.read(1);
+					listLength = static_cast<std::uint64_t>(numberOfRawBytes) + (numberOfMacros * MACRO_REFERENCE_LENGTH);
+					reader.skip(listLength);
+				}
+				break;
+
+				case ObjectType::NumberVariable:
+				{
+					reader.skip(4);
+				}
+				break;
+
+				case ObjectType::StringVariable:
+				case ObjectType::Macro:
+				case ObjectType::ColourMap:
+				{
+					reader.skip(reader.read(2));
+				}
+				break;
+
+				case ObjectType::InputAttributes:
+				{
+					reader.skip(1);
+					std::uint32_t stringLength = reader.read(1);
+					reader.skip(stringLength);
+					skip_attributes_and_macros(reader, 0);
+				}
+				break;
+
+				case ObjectType::ObjectPointer:
+				{
+					reader.skip(2);
+				}
+				break;
+
+				case ObjectType::AuxiliaryFunctionType1:
+				case ObjectType::AuxiliaryInputType1:
+				case ObjectType::AuxiliaryFunctionType2:
+				case ObjectType::AuxiliaryInputType2:
+				{
+					reader.skip((ObjectType::AuxiliaryInputType1 == static_cast<ObjectType>(object[2])) ? 3 : 2);
+					std::uint32_t numberOfObjects = reader.read(1);
+					reader.skip(static_cast<std::uint64_t>(numberOfObjects) * CHILD_OBJECT_LENGTH);
+				}
+				break;
+
+				case ObjectType::AuxiliaryControlDesignatorObjectPointer:
+				{
+					reader.skip(3);
+				}
+				break;
+
+				case ObjectType::WindowMask:
+				{
+					reader.skip(11);
+					std::uint32_t numberOfReferences = reader.read(1);
+					std::uint32_t numberOfObjects = reader.read(1);
+					std::uint32_t numberOfMacros = reader.read(1);
+					listLength = (static_cast<std::uint64_t>(numberOfReferences) * OBJECT_REFERENCE_LENGTH) + (numberOfObjects * CHILD_OBJECT_LENGTH) + (numberOfMacros * MACRO_REFERENCE_LENGTH);
+					reader.skip(listLength);
+				}
+				break;
+
+				case ObjectType::KeyGroup:
+				{
+					skip_objects_and_macros(reader, 5, OBJECT_REFERENCE_LENGTH);
+				}
+				break;
+
+				case ObjectType::GraphicsContext:
+				{
+					reader.skip(31);
+				}
+				break;
+
+				case ObjectType::OutputList:
+				{
+					skip_objects_and_macros(reader, 7, OBJECT_REFERENCE_LENGTH);
+				}
+				break;
+
+				case ObjectType::ExtendedInputAttributes:
+				{
+					reader.skip(1);
+					std::uint32_t numberOfCodePlanes = reader.read(1);
+
+					for (std::uint32_t i = 0; (i < numberOfCodePlanes) && (reader.get_is_valid()); i++)
+					{
+						reader.skip(1);
+						std::uint32_t numberOfRanges = reader.read(1);
+						reader.skip(static_cast<std::uint64_t>(numberOfRanges) * CHARACTER_RANGE_LENGTH);
+					}
+				}
+				break;
+
+				case ObjectType::ObjectLabelReferenceList:
+				{
+					std::uint32_t numberOfLabels = reader.read(2);
+					reader.skip(static_cast<std::uint64_t>(numberOfLabels) * OBJECT_LABEL_REFERENCE_LENGTH);
+				}
+				break;
+
+				case ObjectType::ExternalObjectDefinition:
+				{
+					reader.skip(9);
+					std::uint32_t numberOfObjects = reader.read(1);
+					reader.skip(static_cast<std::uint64_t>(numberOfObjects) * OBJECT_REFERENCE_LENGTH);
+				}
+				break;
+
+				case ObjectType::ExternalReferenceNAME:
+				{
+					reader.skip(9);
+				}
+				break;
+
+				case ObjectType::ExternalObjectPointer:
+				{
+					reader.skip(6);
+				}
+				break;
+
+				case ObjectType::Animation:
+				{
+					skip_objects_and_macros(reader, 12, CHILD_OBJECT_LENGTH);
+				}
+				break;
+
+				case ObjectType::ColourPalette:
+				{
+					reader.skip(2);
+					std::uint32_t numberOfColours = reader.read(2);
+					reader.skip(static_cast<std::uint64_t>(numberOfColours) * PALETTE_COLOUR_LENGTH);
+				}
+				break;
+
+				case ObjectType::GraphicData:
+				{
+					reader.skip(1);
+					reader.skip(reader.read(4));
+				}
+				break;
+
+				case ObjectType::WorkingSetSpecialControls:
+				{
+					reader.skip(4);
+					std::uint32_t numberOfLanguagePairs = reader.read(1);
+					reader.skip(static_cast<std::uint64_t>(numberOfLanguagePairs) * LANGUAGE_PAIR_LENGTH);
+				}
+				break;
+
+				case ObjectType::ScaledGraphic:
+				{
+					skip_attributes_and_macros(reader, 8);
+				}
+				break;
+
+				default:
+				{
+					retVal = ParseResult::UnknownObjectType;
+				}
+				break;
+			}
+
+			if ((ParseResult::Success == retVal) && (!reader.get_is_valid()))
+			{
+				retVal = ParseResult::TruncatedObject;
+			}
+		}
+
+		if (ParseResult::Success == retVal)
+		{
+			objectLength = reader.get_position();
+		}
+		return retVal;
+	}
+} // namespace isobus